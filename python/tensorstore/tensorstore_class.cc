@@ -39,6 +39,7 @@
 #include "python/tensorstore/result_type_caster.h"
 #include "python/tensorstore/serialization.h"
 #include "python/tensorstore/spec.h"
+#include "python/tensorstore/status.h"
 #include "python/tensorstore/tensorstore_module_components.h"
 #include "python/tensorstore/tensorstore_class.h"
 #include "python/tensorstore/transaction.h"
@@ -49,12 +50,14 @@
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/array/array.h"
+#include "tensorstore/driver/read.h"
 #include "tensorstore/index_space/index_transform.h"
 #include "tensorstore/internal/global_initializer.h"
 #include "tensorstore/internal/json/pprint_python.h"
 #include "tensorstore/open.h"
 #include "tensorstore/open_mode.h"
 #include "tensorstore/progress.h"
+#include "tensorstore/read_write_options.h"
 #include "tensorstore/rank.h"
 #include "tensorstore/resize_options.h"
 #include "tensorstore/spec.h"
@@ -85,6 +88,15 @@ WriteFutures IssueCopyOrWrite(
   }
 }
 
+/// Python object returned by `TensorStore.read_chunks`.
+struct PythonReadChunksIterator {
+  internal::ReadChunksStream stream;
+  /// Holds references to the Python objects referenced by the TensorStore.
+  PythonObjectReferenceManager reference_manager;
+};
+
+using ReadChunksIteratorResult = std::pair<IndexTransform<>, SharedArray<void>>;
+
 namespace open_setters {
 
 struct SetRead : public spec_setters::SetModeBase<ReadWriteMode::read> {
@@ -557,6 +569,127 @@ Group:
 )",
       py::arg("order") = "C");
 
+  cls.def(
+      "prefetch",
+      [](Self& self) -> PythonFutureWrapper<void> {
+        return PythonFutureWrapper<void>(tensorstore::Prefetch(self.value),
+                                         self.reference_manager());
+      },
+      R"(
+Reads the data within the current domain into the cache, without returning it.
+
+This may be used to reduce the latency of a subsequent :py:obj:`.read` of the
+same region, for example to read the next region to be processed while
+processing the current one.
+
+Example:
+
+    >>> dataset = await ts.open(
+    ...     {
+    ...         'driver': 'zarr',
+    ...         'kvstore': {
+    ...             'driver': 'memory'
+    ...         },
+    ...         'context': {
+    ...             'cache_pool': {
+    ...                 'total_bytes_limit': 100000000
+    ...             }
+    ...         },
+    ...         'recheck_cached_data': False,
+    ...     },
+    ...     dtype=ts.uint32,
+    ...     shape=[70, 80],
+    ...     create=True)
+    >>> await dataset[5:10, 8:12].prefetch()
+    >>> await dataset[5:10, 8:12].read()
+    array([[0, 0, 0, 0],
+           [0, 0, 0, 0],
+           [0, 0, 0, 0],
+           [0, 0, 0, 0],
+           [0, 0, 0, 0]], dtype=uint32)
+
+.. note::
+
+   The prefetched data remains cached subject to the limits of the
+   :json:schema:`Context.cache_pool`.  With the default ``total_bytes_limit`` of
+   0, prefetching has no effect other than validating that the data can be
+   read.
+
+Returns:
+  A future that becomes ready once all chunks intersecting the current domain
+  have been read.
+
+Group:
+  I/O
+
+)");
+
+  cls.def(
+      "read_chunks",
+      [](Self& self, ContiguousLayoutOrder order,
+         size_t max_in_flight_chunks) -> PythonReadChunksIterator {
+        if (max_in_flight_chunks == 0) {
+          throw py::value_error("max_in_flight_chunks must be positive");
+        }
+        ReadChunksOptions options(order);
+        options.max_in_flight_chunks = max_in_flight_chunks;
+        return PythonReadChunksIterator{
+            ValueOrThrow(internal::DriverReadChunks(
+                internal::TensorStoreAccess::handle(self.value), options)),
+            self.reference_manager()};
+      },
+      R"(
+Reads the data within the current domain one chunk at a time.
+
+The current domain is partitioned according to the read chunk grid given by
+:py:obj:`.chunk_layout`, and each grid cell is read into a separate array.
+Dimensions without a read chunk constraint are not partitioned.
+
+Returns an asynchronous iterator that yields :python:`(transform, array)` pairs
+in the order in which the reads complete, where :python:`transform` is an
+identity :py:obj:`IndexTransform` over the domain of the cell and
+:python:`array` holds its data.  At most :python:`max_in_flight_chunks` cells
+are being read or have been read but not yet consumed, so that the memory used
+does not depend on the size of the domain.
+
+Example:
+
+    >>> dataset = await ts.open(
+    ...     {
+    ...         'driver': 'zarr',
+    ...         'kvstore': {
+    ...             'driver': 'memory'
+    ...         }
+    ...     },
+    ...     dtype=ts.uint32,
+    ...     shape=[4, 6],
+    ...     chunk_layout=ts.ChunkLayout(read_chunk_shape=[4, 3]),
+    ...     create=True)
+    >>> await dataset[1:3, 2:4].write(42)
+    >>> chunks = [(tuple(t.domain.origin), a.tolist())
+    ...           async for t, a in dataset.read_chunks()]
+    >>> sorted(chunks)
+    [((0, 0), [[0, 0, 0], [0, 0, 42], [0, 0, 42], [0, 0, 0]]), ((0, 3), [[0, 0, 0], [42, 0, 0], [42, 0, 0], [0, 0, 0]])]
+
+Args:
+  order: Contiguous layout order of each returned array:
+
+    :python:`'C'`
+      Specifies C order, i.e. lexicographic/row-major order.
+
+    :python:`'F'`
+      Specifies Fortran order, i.e. colexicographic/column-major order.
+
+  max_in_flight_chunks: Maximum number of chunks that are being read or have
+    been read but not yet consumed.
+
+Group:
+  I/O
+
+)",
+      py::arg("order") = "C", py::kw_only(),
+      py::arg("max_in_flight_chunks") = 16);
+
   cls.def(
       "write",
       [](Self& self,
@@ -2525,8 +2658,51 @@ Group:
   });
 }
 
+using ReadChunksIteratorCls = py::class_<PythonReadChunksIterator>;
+
+auto MakeReadChunksIteratorClass(TensorStoreCls& cls_tensorstore) {
+  return ReadChunksIteratorCls(cls_tensorstore, "ReadChunksIterator", R"(
+Asynchronous iterator over the chunks of a :py:obj:`TensorStore`, returned by
+:py:obj:`TensorStore.read_chunks`.
+
+Group:
+  I/O
+)");
+}
+
+void DefineReadChunksIteratorAttributes(ReadChunksIteratorCls& cls) {
+  using Self = PythonReadChunksIterator;
+  cls.def("__aiter__", [](py::object self) { return self; });
+  cls.def(
+      "__anext__",
+      [](Self& self) -> PythonFutureWrapper<ReadChunksIteratorResult> {
+        // Raised by the returned future to end an `async for` loop.
+        auto end_status = GetStatusFromPythonException(
+            py::handle(PyExc_StopAsyncIteration)());
+        return PythonFutureWrapper<ReadChunksIteratorResult>(
+            MapFutureValue(
+                InlineExecutor{},
+                [end_status = std::move(end_status)](
+                    std::optional<internal::ReadChunksItem>& item)
+                    -> Result<ReadChunksIteratorResult> {
+                  if (!item) return end_status;
+                  TENSORSTORE_ASSIGN_OR_RETURN(
+                      auto array, (ArrayOriginCast<zero_origin, container>(
+                                      std::move(item->array))));
+                  return ReadChunksIteratorResult(std::move(item->transform),
+                                                  std::move(array));
+                },
+                self.stream.Next()),
+            self.reference_manager);
+      });
+}
+
 void RegisterTensorStoreBindings(pybind11::module m, Executor defer) {
-  defer([cls = MakeTensorStoreClass(m), m]() mutable {
+  auto cls = MakeTensorStoreClass(m);
+  defer([cls_iterator = MakeReadChunksIteratorClass(cls)]() mutable {
+    DefineReadChunksIteratorAttributes(cls_iterator);
+  });
+  defer([cls, m]() mutable {
     DefineTensorStoreAttributes(cls);
     DefineTensorStoreFunctions(m);
   });
@@ -184,6 +184,59 @@ async def test_memory_n5_cache_open():
   }).result()
 
 
+async def test_prefetch():
+  t = await ts.open(
+      {
+          "driver": "zarr",
+          "kvstore": {
+              "driver": "memory",
+          },
+          "context": {
+              "cache_pool": {
+                  "total_bytes_limit": 1000000
+              }
+          },
+          "recheck_cached_data": False,
+      },
+      dtype=ts.uint32,
+      shape=[70, 80],
+      chunk_layout=ts.ChunkLayout(read_chunk_shape=[10, 10]),
+      create=True,
+  )
+  await t[5:10, 6:8].write(42)
+  assert await t[0:20, 0:20].prefetch() is None
+  np.testing.assert_equal(await t[5:10, 6:8].read(), np.full([5, 2], 42))
+
+
+async def test_read_chunks():
+  t = await ts.open(
+      {
+          "driver": "zarr",
+          "kvstore": {
+              "driver": "memory",
+          },
+      },
+      dtype=ts.uint32,
+      shape=[70, 80],
+      chunk_layout=ts.ChunkLayout(read_chunk_shape=[10, 20]),
+      create=True,
+  )
+  await t[5:10, 6:8].write(42)
+  region = t[5:25, 10:50]
+  expected = await region.read()
+  origins = []
+  async for transform, array in region.read_chunks(max_in_flight_chunks=2):
+    origin = transform.domain.origin
+    origins.append(tuple(origin))
+    np.testing.assert_equal(
+        array,
+        expected[tuple(
+            slice(o - r, o - r + s) for o, r, s in zip(
+                origin, region.domain.origin, transform.domain.shape))])
+  assert sorted(origins) == [(5, 10), (5, 20), (5, 40), (10, 10), (10, 20),
+                             (10, 40), (20, 10), (20, 20), (20, 40)]
+
+
 async def test_open_error_message():
   with pytest.raises(ValueError,
                      match=".*Error parsing object member \"driver\": .*"):
@@ -146,12 +146,25 @@ Operations
 }
 
 void DefineTransactionAttributes(TransactionCls& cls) {
-  cls.def(py::init([](bool atomic) {
+  cls.def(py::init([](bool atomic, std::size_t staging_limit_bytes) {
             return TransactionState::ToCommitPtr(Transaction(
-                atomic ? tensorstore::atomic_isolated : tensorstore::isolated));
+                atomic ? tensorstore::atomic_isolated : tensorstore::isolated,
+                staging_limit_bytes));
           }),
-          py::arg("atomic") = false, R"(
+          py::arg("atomic") = false, py::kw_only(),
+          py::arg("staging_limit_bytes") = 0, R"(
 Creates a new transaction.
+
+Args:
+  atomic: Requires that the transaction be committed atomically.
+  staging_limit_bytes: If non-zero, and :py:param:`.atomic` is :python:`False`,
+    fully-written chunks are written to the underlying key-value store in
+    uncommitted (staged) form once the total size of the in-memory
+    modifications exceeds this limit, and their in-memory copies are released.
+    The staged writes become visible only when the transaction is committed.
+    Currently only the :ref:`file<file-kvstore-driver>` key-value store
+    supports staging; with other key-value stores, modifications remain in
+    memory until commit.
 )");
   cls.def(
       "commit_async",
@@ -0,0 +1,83 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/batch.h"
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+
+namespace tensorstore {
+
+class Batch::Impl {
+ public:
+  using EntryKey = std::pair<const void*, std::string>;
+
+  std::atomic<size_t> reference_count_{0};
+  absl::Mutex mutex_;
+  // Deferred operations, in the order they were added.
+  std::vector<std::unique_ptr<Entry>> entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<EntryKey, Entry*> entry_map_ ABSL_GUARDED_BY(mutex_);
+};
+
+Batch::Entry::~Entry() = default;
+
+void intrusive_ptr_increment(Batch::Impl* impl) {
+  impl->reference_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void intrusive_ptr_decrement(Batch::Impl* impl) {
+  if (impl->reference_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // Last handle released: no further requests can be added, so submit the
+    // batch.
+    std::vector<std::unique_ptr<Batch::Entry>> entries;
+    {
+      absl::MutexLock lock(&impl->mutex_);
+      entries = std::move(impl->entries_);
+    }
+    delete impl;
+    for (auto& entry : entries) {
+      entry->Submit();
+      entry.reset();
+    }
+  }
+}
+
+Batch Batch::New() { return Batch(internal::IntrusivePtr<Impl>(new Impl)); }
+
+void Batch::AddRequest(const void* owner, std::string_view key,
+                       absl::FunctionRef<std::unique_ptr<Entry>()> make_entry,
+                       absl::FunctionRef<void(Entry&)> add) const {
+  assert(impl_);
+  absl::MutexLock lock(&impl_->mutex_);
+  auto [it, inserted] =
+      impl_->entry_map_.try_emplace(Impl::EntryKey(owner, key), nullptr);
+  if (inserted) {
+    impl_->entries_.push_back(make_entry());
+    it->second = impl_->entries_.back().get();
+  }
+  add(*it->second);
+}
+
+}  // namespace tensorstore
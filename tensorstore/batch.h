@@ -0,0 +1,137 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_BATCH_H_
+#define TENSORSTORE_BATCH_H_
+
+/// \file
+///
+/// Defines `Batch`, which groups read operations so that the I/O they require
+/// may be deferred and coalesced.
+
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+
+namespace tensorstore {
+
+/// Shared handle to a batch of read operations.
+///
+/// Read operations that specify a batch may defer the I/O they require until
+/// the batch is submitted, so that requests for the same underlying data may be
+/// merged, and requests for nearby byte ranges of the same key-value store
+/// entry may be coalesced into fewer, larger requests.
+///
+/// The batch is submitted when the last `Batch` handle referencing it is
+/// released.  In addition to the handles held by the caller, an operation in
+/// progress may hold a handle in order to add further requests to the batch
+/// (e.g. a sharded read that must first read an index).  Therefore, the caller
+/// must release its handle(s) before waiting on any operation associated with
+/// the batch; otherwise, the operation may never complete.
+///
+/// Example::
+///
+///     auto batch = tensorstore::Batch::New();
+///     std::vector<Future<SharedArray<int32_t>>> futures;
+///     for (const auto& box : boxes) {
+///       tensorstore::ReadIntoNewArrayOptions options;
+///       options.batch = batch;
+///       futures.push_back(tensorstore::Read(store | box, std::move(options)));
+///     }
+///     // Submit the batch.
+///     batch.Release();
+///
+/// \ingroup core
+class Batch {
+ public:
+  /// Special type that indicates a null batch.
+  ///
+  /// This is used via the `tensorstore::no_batch` constant.
+  struct no_batch_t {
+    explicit constexpr no_batch_t() = default;
+  };
+
+  class Impl;
+
+  /// Deferred operation associated with a batch.
+  ///
+  /// Derived classes accumulate requests until `Submit` is called.
+  class Entry {
+   public:
+    virtual ~Entry();
+
+    /// Issues the accumulated requests.  Called exactly once, without any locks
+    /// held, when the batch is submitted.  The entry is destroyed after this
+    /// returns.
+    virtual void Submit() = 0;
+  };
+
+  /// Creates a null batch.
+  ///
+  /// Operations that specify a null batch are performed immediately.
+  ///
+  /// \id no_batch
+  constexpr Batch(no_batch_t) {}
+
+  /// Creates a new batch.
+  static Batch New();
+
+  /// Returns `true` if this is not a null batch.
+  explicit operator bool() const { return static_cast<bool>(impl_); }
+
+  /// Releases this handle, and submits the batch if it was the last handle.
+  ///
+  /// \post `!*this`
+  void Release() { impl_.reset(); }
+
+  /// Adds a request to the deferred operation identified by `owner` and `key`.
+  ///
+  /// If there is no such operation in the batch, one is first created by
+  /// calling `make_entry`.  Then `add` is called with the operation.  Both
+  /// functions are called with the batch locked, and must not access the
+  /// batch.
+  ///
+  /// \param owner Typically a pointer to the object that performs the
+  ///     operation, e.g. a key-value store driver.
+  /// \param key Identifies the operation within `owner`, e.g. a key.
+  /// \pre `*this` is not a null batch.
+  void AddRequest(const void* owner, std::string_view key,
+                  absl::FunctionRef<std::unique_ptr<Entry>()> make_entry,
+                  absl::FunctionRef<void(Entry&)> add) const;
+
+  friend bool operator==(const Batch& a, const Batch& b) {
+    return a.impl_ == b.impl_;
+  }
+  friend bool operator!=(const Batch& a, const Batch& b) { return !(a == b); }
+
+ private:
+  friend void intrusive_ptr_increment(Impl* impl);
+  friend void intrusive_ptr_decrement(Impl* impl);
+
+  explicit Batch(internal::IntrusivePtr<Impl> impl) : impl_(std::move(impl)) {}
+
+  internal::IntrusivePtr<Impl> impl_;
+};
+
+/// Special value that indicates a null batch.
+///
+/// \relates Batch
+constexpr inline Batch::no_batch_t no_batch{};
+
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_BATCH_H_
@@ -0,0 +1,90 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/batch.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+using ::tensorstore::Batch;
+using ::tensorstore::no_batch;
+
+struct TestEntry : public Batch::Entry {
+  TestEntry(std::string name, std::vector<std::string>* log)
+      : name(std::move(name)), log(log) {}
+  void Submit() override {
+    std::string s = name + ":";
+    for (int x : requests) s += " " + std::to_string(x);
+    log->push_back(s);
+  }
+  std::string name;
+  std::vector<int> requests;
+  std::vector<std::string>* log;
+};
+
+void AddTestRequest(const Batch& batch, const void* owner, std::string key,
+                    int request, std::vector<std::string>* log) {
+  batch.AddRequest(
+      owner, key, [&] { return std::make_unique<TestEntry>(key, log); },
+      [&](Batch::Entry& entry) {
+        static_cast<TestEntry&>(entry).requests.push_back(request);
+      });
+}
+
+TEST(BatchTest, NoBatch) {
+  Batch batch = no_batch;
+  EXPECT_FALSE(batch);
+  EXPECT_EQ(batch, Batch(no_batch));
+}
+
+TEST(BatchTest, SubmitOnLastRelease) {
+  std::vector<std::string> log;
+  int owner1, owner2;
+  auto batch = Batch::New();
+  EXPECT_TRUE(batch);
+  AddTestRequest(batch, &owner1, "a", 1, &log);
+  AddTestRequest(batch, &owner1, "b", 2, &log);
+  AddTestRequest(batch, &owner1, "a", 3, &log);
+  AddTestRequest(batch, &owner2, "a", 4, &log);
+  auto batch_copy = batch;
+  EXPECT_EQ(batch, batch_copy);
+  batch.Release();
+  EXPECT_FALSE(batch);
+  EXPECT_THAT(log, ::testing::ElementsAre());
+  AddTestRequest(batch_copy, &owner2, "a", 5, &log);
+  batch_copy.Release();
+  EXPECT_THAT(log, ::testing::ElementsAre("a: 1 3", "b: 2", "a: 4 5"));
+}
+
+TEST(BatchTest, DistinctBatches) {
+  std::vector<std::string> log;
+  int owner;
+  auto batch1 = Batch::New();
+  auto batch2 = Batch::New();
+  EXPECT_NE(batch1, batch2);
+  AddTestRequest(batch1, &owner, "a", 1, &log);
+  AddTestRequest(batch2, &owner, "a", 2, &log);
+  batch2.Release();
+  EXPECT_THAT(log, ::testing::ElementsAre("a: 2"));
+  batch1.Release();
+  EXPECT_THAT(log, ::testing::ElementsAre("a: 2", "a: 1"));
+}
+
+}  // namespace
@@ -15,6 +15,7 @@
 #include "tensorstore/driver/cast/cast.h"
 
 #include "absl/status/status.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/driver/driver_handle.h"
 #include "tensorstore/driver/registry.h"
 #include "tensorstore/internal/intrusive_ptr.h"
@@ -208,6 +209,11 @@ class CastDriver
             AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
       override;
 
+  void ReadInBatch(
+      OpenTransactionPtr transaction, IndexTransform<> transform, Batch batch,
+      AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
+      override;
+
   void Write(OpenTransactionPtr transaction, IndexTransform<> transform,
              AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>
                  receiver) override;
@@ -323,6 +329,15 @@ void CastDriver::Read(
                          IntrusivePtr<CastDriver>(this), std::move(receiver)});
 }
 
+void CastDriver::ReadInBatch(
+    OpenTransactionPtr transaction, IndexTransform<> transform, Batch batch,
+    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
+  base_driver_->ReadInBatch(
+      std::move(transaction), std::move(transform), std::move(batch),
+      ChunkReceiverAdapter<ReadChunk, ReadChunkImpl>{
+          IntrusivePtr<CastDriver>(this), std::move(receiver)});
+}
+
 void CastDriver::Write(
     OpenTransactionPtr transaction, IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
@@ -24,10 +24,13 @@
 /// provided along with the ReadChunk/WriteChunk object.
 
 #include <mutex>
+#include <optional>
+#include <type_traits>
 
 #include "absl/status/status.h"
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/index_transform.h"
+#include "tensorstore/index_space/transformed_array.h"
 #include "tensorstore/internal/arena.h"
 #include "tensorstore/internal/lock_collection.h"
 #include "tensorstore/internal/nditerable.h"
@@ -41,6 +44,7 @@ namespace internal {
 
 struct ReadChunk {
   struct BeginRead {};
+  struct ReadInto {};
   using Impl = poly::Poly<
       sizeof(void*) * 2,
       /*Copyable=*/true,  //
@@ -66,7 +70,23 @@ struct ReadChunk {
       /// \returns An NDIterable with a shape of
       ///     `chunk_transform.input_shape()`.
       Result<NDIterable::Ptr>(BeginRead, IndexTransform<> chunk_transform,
-                              Arena* arena)>;
+                              Arena* arena),
+
+      /// Optionally reads the data directly into `target`, without an
+      /// intermediate copy.
+      ///
+      /// This is called without any locks held.  Chunk implementations that
+      /// do not define this overload use the default `PolyApply` overload
+      /// defined below, which always returns `false`.
+      ///
+      /// \param chunk_transform Transform with a range that is a subset of
+      ///     `transform`.
+      /// \param target Target array with a shape of
+      ///     `chunk_transform.input_shape()` and the data type of the chunk.
+      /// \returns `true` if `target` was filled, or `false` if the data must
+      ///     instead be read using the `BeginRead` overload.
+      Result<bool>(ReadInto, IndexTransform<> chunk_transform,
+                   TransformedArray<void, dynamic_rank, view> target)>;
 
   /// Type-erased chunk implementation.  In the case of the chunks produced by
   /// `ChunkCache::Read`, for example, the contained object holds a
@@ -78,9 +98,22 @@ struct ReadChunk {
   IndexTransform<> transform;
 };
 
+/// Default implementation of the `ReadChunk::ReadInto` operation for chunk
+/// implementations that do not support it.
+template <typename Self>
+std::enable_if_t<!std::is_invocable_v<Self&&, ReadChunk::ReadInto,
+                                      IndexTransform<>,
+                                      TransformedArray<void, dynamic_rank, view>>,
+                 Result<bool>>
+PolyApply(Self&& self, ReadChunk::ReadInto, IndexTransform<> chunk_transform,
+          TransformedArray<void, dynamic_rank, view> target) {
+  return false;
+}
+
 struct WriteChunk {
   struct BeginWrite {};
   struct EndWrite {};
+  struct WriteArray {};
 
   struct [[nodiscard]] EndWriteResult {
     /// Indicates an error recording write operation in memory.  Errors
@@ -156,7 +189,28 @@ struct WriteChunk {
       ///     used for allocating memory.
       EndWriteResult(EndWrite, IndexTransformView<> chunk_transform,
                      NDIterable::IterationLayoutView layout,
-                     span<const Index> write_end_position, Arena* arena)>;
+                     span<const Index> write_end_position, Arena* arena),
+
+      /// Optionally writes `source` to the chunk by retaining a reference to
+      /// it, rather than copying it, in lieu of `BeginWrite` and `EndWrite`.
+      ///
+      /// The caller guarantees that `source` is not modified until the write
+      /// is committed.  The locks registered by the `LockCollection` overload
+      /// above will be held when this function is called.  Chunk
+      /// implementations that do not define this overload use the default
+      /// `PolyApply` overload defined below, which always returns
+      /// `std::nullopt`.
+      ///
+      /// \param chunk_transform Transform with a range that is a subset of
+      ///     `transform`.
+      /// \param source Source array with a domain equal to
+      ///     `chunk_transform.domain()` and the data type of the chunk.
+      /// \returns The result of the write, or `std::nullopt` if the data must
+      ///     instead be written using the `BeginWrite` and `EndWrite`
+      ///     overloads.
+      std::optional<EndWriteResult>(
+          WriteArray, IndexTransformView<> chunk_transform,
+          TransformedSharedArray<const void> source)>;
 
   /// Type-erased chunk implementation.  In the case of the chunks produced by
   /// `ChunkCache::Write`, for example, the contained object holds a
@@ -168,6 +222,19 @@ struct WriteChunk {
   IndexTransform<> transform;
 };
 
+/// Default implementation of the `WriteChunk::WriteArray` operation for chunk
+/// implementations that do not support it.
+template <typename Self>
+std::enable_if_t<!std::is_invocable_v<Self&&, WriteChunk::WriteArray,
+                                      IndexTransformView<>,
+                                      TransformedSharedArray<const void>>,
+                 std::optional<WriteChunk::EndWriteResult>>
+PolyApply(Self&& self, WriteChunk::WriteArray,
+          IndexTransformView<> chunk_transform,
+          TransformedSharedArray<const void> source) {
+  return std::nullopt;
+}
+
 /// Attempts to lock one or more `ReadChunk`/`WriteChunk` objects.
 ///
 /// If registering a chunk with the lock collection fails, the error propagates
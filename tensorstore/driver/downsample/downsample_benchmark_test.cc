@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <utility>
 #include <vector>
 
 #include "absl/log/absl_check.h"
@@ -21,6 +22,7 @@
 #include "tensorstore/box.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/downsample/downsample_array.h"
+#include "tensorstore/driver/downsample/downsample_kernels.h"
 #include "tensorstore/driver/downsample/downsample_nditerable.h"
 #include "tensorstore/driver/downsample/downsample_util.h"
 #include "tensorstore/index.h"
@@ -41,9 +43,9 @@ using ::tensorstore::internal_downsample::DownsampleBounds;
 
 void BenchmarkDownsample(::benchmark::State& state, DataType dtype,
                          DownsampleMethod downsample_method,
-                         DimensionIndex rank, Index downsample_factor,
+                         std::vector<Index> downsample_factors,
                          Index block_size) {
-  std::vector<Index> downsample_factors(rank, downsample_factor);
+  const DimensionIndex rank = downsample_factors.size();
   std::vector<Index> block_shape(rank, block_size);
   absl::BitGen gen;
   BoxView<> base_domain(block_shape);
@@ -87,14 +89,44 @@ TENSORSTORE_GLOBAL_INITIALIZER {
                                     downsample_factor, "_BlockSize", block_size)
                     .c_str(),
                 [=](auto& state) {
-                  BenchmarkDownsample(state, dtype, downsample_method, rank,
-                                      downsample_factor, block_size);
+                  BenchmarkDownsample(
+                      state, dtype, downsample_method,
+                      std::vector<Index>(rank, downsample_factor), block_size);
                 });
           }
         }
       }
     }
   }
+
+  // Cases handled by the vectorized kernels in `downsample_kernels.h`.  The
+  // factors are specified in C order, i.e. `{1, 2, 2}` is 2x2x1 in xyz order,
+  // such that the inner dimension is always downsampled by 2.
+  for (const DataType dtype : {DataType(tensorstore::dtype_v<uint8_t>),
+                               DataType(tensorstore::dtype_v<uint16_t>),
+                               DataType(tensorstore::dtype_v<float>)}) {
+    for (const DownsampleMethod downsample_method :
+         {DownsampleMethod::kMean, DownsampleMethod::kMin,
+          DownsampleMethod::kMax}) {
+      for (const auto& [name, downsample_factors] :
+           {std::pair{"2x2x1", std::vector<Index>{1, 2, 2}},
+            std::pair{"2x2x2", std::vector<Index>{2, 2, 2}}}) {
+        for (const Index block_size : {64, 128, 256}) {
+          ::benchmark::RegisterBenchmark(
+              tensorstore::StrCat("DownsampleKernel_", dtype, "_",
+                                  downsample_method, "_", name, "_BlockSize",
+                                  block_size)
+                  .c_str(),
+              [=, downsample_factors = downsample_factors](auto& state) {
+                state.SetLabel(tensorstore::internal_downsample::
+                                   GetDownsampleKernelImplementationName());
+                BenchmarkDownsample(state, dtype, downsample_method,
+                                    downsample_factors, block_size);
+              });
+        }
+      }
+    }
+  }
 }
 
 }  // namespace
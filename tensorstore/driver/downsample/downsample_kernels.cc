@@ -0,0 +1,327 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/driver/downsample/downsample_kernels.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <type_traits>
+
+#include "tensorstore/index.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define TENSORSTORE_INTERNAL_DOWNSAMPLE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace tensorstore {
+namespace internal_downsample {
+namespace {
+
+enum class DownsampleKernelImplementation {
+  kPortable,
+  kAvx2,
+};
+
+DownsampleKernelImplementation ChooseImplementation() {
+#ifdef TENSORSTORE_INTERNAL_DOWNSAMPLE_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return DownsampleKernelImplementation::kAvx2;
+  }
+#endif
+  return DownsampleKernelImplementation::kPortable;
+}
+
+DownsampleKernelImplementation GetImplementation() {
+  static const DownsampleKernelImplementation implementation =
+      ChooseImplementation();
+  return implementation;
+}
+
+// The accumulate operations must match the corresponding `ReductionTraits` in
+// `downsample_nditerable.cc` exactly, including for NaN and signed zero inputs.
+
+struct SumOp {
+  template <typename AccumulateElement, typename Element>
+  static void Apply(AccumulateElement& acc, Element x) {
+    acc += x;
+  }
+};
+
+struct MinOp {
+  template <typename Element>
+  static void Apply(Element& acc, Element x) {
+    acc = std::min(acc, x);
+  }
+};
+
+struct MaxOp {
+  template <typename Element>
+  static void Apply(Element& acc, Element x) {
+    acc = std::max(acc, x);
+  }
+};
+
+template <typename Op, typename Element, typename AccumulateElement>
+void AccumulatePortable(const Element* source, AccumulateElement* acc,
+                        Index count) {
+  for (Index i = 0; i < count; ++i) {
+    AccumulateElement a = acc[i];
+    Op::Apply(a, source[2 * i]);
+    Op::Apply(a, source[2 * i + 1]);
+    acc[i] = a;
+  }
+}
+
+#ifdef TENSORSTORE_INTERNAL_DOWNSAMPLE_KERNELS_X86
+
+/// Adds four zero-extended 64-bit values to `acc[0, 4)`.
+__attribute__((target("avx2"))) inline void AddToAccumulator(uint64_t* acc,
+                                                             __m256i v) {
+  __m256i* p = reinterpret_cast<__m256i*>(acc);
+  _mm256_storeu_si256(p, _mm256_add_epi64(_mm256_loadu_si256(p), v));
+}
+
+/// Reorders the 64-bit chunks `[a0, b0, a1, b1]`, as produced by the per-lane
+/// pack and shuffle instructions from inputs `a` and `b`, into `[a0, a1, b0,
+/// b1]`.
+__attribute__((target("avx2"))) inline __m256i InterleaveLanes(__m256i v) {
+  return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+__attribute__((target("avx2"))) inline __m256 InterleaveLanes(__m256 v) {
+  return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+/// Deinterleaves 16 consecutive floats at `source` into the 8 even-indexed and
+/// 8 odd-indexed elements.
+__attribute__((target("avx2"))) inline void LoadEvenOdd(const float* source,
+                                                        __m256& even,
+                                                        __m256& odd) {
+  const __m256 a = _mm256_loadu_ps(source);
+  const __m256 b = _mm256_loadu_ps(source + 8);
+  even = InterleaveLanes(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+  odd = InterleaveLanes(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+/// Computes the minimum (if `kMin`) or maximum of each pair of adjacent
+/// elements of the 32 bytes at `p`, zero-extended to 16 bits.
+template <bool kMin>
+__attribute__((target("avx2"))) inline __m256i ReducePairs(const uint8_t* p) {
+  const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i shifted = _mm256_srli_epi16(v, 8);
+  const __m256i r =
+      kMin ? _mm256_min_epu8(v, shifted) : _mm256_max_epu8(v, shifted);
+  return _mm256_and_si256(r, _mm256_set1_epi16(0xff));
+}
+
+/// Computes the minimum (if `kMin`) or maximum of each pair of adjacent
+/// elements of the 32 bytes at `p`, zero-extended to 32 bits.
+template <bool kMin>
+__attribute__((target("avx2"))) inline __m256i ReducePairs(const uint16_t* p) {
+  const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i shifted = _mm256_srli_epi32(v, 16);
+  const __m256i r =
+      kMin ? _mm256_min_epu16(v, shifted) : _mm256_max_epu16(v, shifted);
+  return _mm256_and_si256(r, _mm256_set1_epi32(0xffff));
+}
+
+__attribute__((target("avx2"))) void AccumulateAvx2(SumOp,
+                                                    const uint8_t* source,
+                                                    uint64_t* acc,
+                                                    Index count) {
+  const __m256i ones = _mm256_set1_epi8(1);
+  Index i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + 2 * i));
+    // Sum of each pair of adjacent bytes, as 16 16-bit values in order.
+    const __m256i sums = _mm256_maddubs_epi16(v, ones);
+    const __m128i lo = _mm256_castsi256_si128(sums);
+    const __m128i hi = _mm256_extracti128_si256(sums, 1);
+    AddToAccumulator(acc + i, _mm256_cvtepu16_epi64(lo));
+    AddToAccumulator(acc + i + 4,
+                     _mm256_cvtepu16_epi64(_mm_srli_si128(lo, 8)));
+    AddToAccumulator(acc + i + 8, _mm256_cvtepu16_epi64(hi));
+    AddToAccumulator(acc + i + 12,
+                     _mm256_cvtepu16_epi64(_mm_srli_si128(hi, 8)));
+  }
+  AccumulatePortable<SumOp>(source + 2 * i, acc + i, count - i);
+}
+
+__attribute__((target("avx2"))) void AccumulateAvx2(SumOp,
+                                                    const uint16_t* source,
+                                                    uint64_t* acc,
+                                                    Index count) {
+  const __m256i low_mask = _mm256_set1_epi32(0xffff);
+  Index i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + 2 * i));
+    // Sum of each pair of adjacent elements, as 8 32-bit values in order.
+    const __m256i sums = _mm256_add_epi32(_mm256_and_si256(v, low_mask),
+                                          _mm256_srli_epi32(v, 16));
+    AddToAccumulator(acc + i,
+                     _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sums)));
+    AddToAccumulator(acc + i + 4,
+                     _mm256_cvtepu32_epi64(_mm256_extracti128_si256(sums, 1)));
+  }
+  AccumulatePortable<SumOp>(source + 2 * i, acc + i, count - i);
+}
+
+__attribute__((target("avx2"))) void AccumulateAvx2(SumOp, const float* source,
+                                                    float* acc, Index count) {
+  Index i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 even, odd;
+    LoadEvenOdd(source + 2 * i, even, odd);
+    // Add the even and odd elements separately, rather than adding them to
+    // each other first, to match the rounding of the scalar implementation.
+    __m256 a = _mm256_loadu_ps(acc + i);
+    a = _mm256_add_ps(a, even);
+    a = _mm256_add_ps(a, odd);
+    _mm256_storeu_ps(acc + i, a);
+  }
+  AccumulatePortable<SumOp>(source + 2 * i, acc + i, count - i);
+}
+
+template <typename Op>
+__attribute__((target("avx2"))) void AccumulateAvx2(Op, const uint8_t* source,
+                                                    uint8_t* acc,
+                                                    Index count) {
+  constexpr bool kMin = std::is_same_v<Op, MinOp>;
+  Index i = 0;
+  for (; i + 32 <= count; i += 32) {
+    const __m256i r = InterleaveLanes(_mm256_packus_epi16(
+        ReducePairs<kMin>(source + 2 * i),
+        ReducePairs<kMin>(source + 2 * i + 32)));
+    __m256i* p = reinterpret_cast<__m256i*>(acc + i);
+    const __m256i a = _mm256_loadu_si256(p);
+    _mm256_storeu_si256(p,
+                        kMin ? _mm256_min_epu8(a, r) : _mm256_max_epu8(a, r));
+  }
+  AccumulatePortable<Op>(source + 2 * i, acc + i, count - i);
+}
+
+template <typename Op>
+__attribute__((target("avx2"))) void AccumulateAvx2(Op, const uint16_t* source,
+                                                    uint16_t* acc,
+                                                    Index count) {
+  constexpr bool kMin = std::is_same_v<Op, MinOp>;
+  Index i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m256i r = InterleaveLanes(_mm256_packus_epi32(
+        ReducePairs<kMin>(source + 2 * i),
+        ReducePairs<kMin>(source + 2 * i + 16)));
+    __m256i* p = reinterpret_cast<__m256i*>(acc + i);
+    const __m256i a = _mm256_loadu_si256(p);
+    _mm256_storeu_si256(
+        p, kMin ? _mm256_min_epu16(a, r) : _mm256_max_epu16(a, r));
+  }
+  AccumulatePortable<Op>(source + 2 * i, acc + i, count - i);
+}
+
+template <typename Op>
+__attribute__((target("avx2"))) void AccumulateAvx2(Op, const float* source,
+                                                    float* acc, Index count) {
+  constexpr bool kMin = std::is_same_v<Op, MinOp>;
+  Index i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 even, odd;
+    LoadEvenOdd(source + 2 * i, even, odd);
+    // `_mm256_{min,max}_ps(x, a)` returns `a` if either operand is NaN or if
+    // they compare equal, which matches `std::{min,max}(a, x)`.
+    __m256 a = _mm256_loadu_ps(acc + i);
+    if constexpr (kMin) {
+      a = _mm256_min_ps(even, a);
+      a = _mm256_min_ps(odd, a);
+    } else {
+      a = _mm256_max_ps(even, a);
+      a = _mm256_max_ps(odd, a);
+    }
+    _mm256_storeu_ps(acc + i, a);
+  }
+  AccumulatePortable<Op>(source + 2 * i, acc + i, count - i);
+}
+
+#endif  // TENSORSTORE_INTERNAL_DOWNSAMPLE_KERNELS_X86
+
+template <typename Op, typename Element, typename AccumulateElement>
+void AccumulateDispatch(const Element* source, AccumulateElement* acc,
+                        Index count) {
+  switch (GetImplementation()) {
+#ifdef TENSORSTORE_INTERNAL_DOWNSAMPLE_KERNELS_X86
+    case DownsampleKernelImplementation::kAvx2:
+      AccumulateAvx2(Op{}, source, acc, count);
+      return;
+#endif
+    default:
+      AccumulatePortable<Op>(source, acc, count);
+      return;
+  }
+}
+
+}  // namespace
+
+void AccumulateSumFactor2(const uint8_t* source, uint64_t* acc, Index count) {
+  AccumulateDispatch<SumOp>(source, acc, count);
+}
+
+void AccumulateSumFactor2(const uint16_t* source, uint64_t* acc, Index count) {
+  AccumulateDispatch<SumOp>(source, acc, count);
+}
+
+void AccumulateSumFactor2(const float* source, float* acc, Index count) {
+  AccumulateDispatch<SumOp>(source, acc, count);
+}
+
+void AccumulateMinFactor2(const uint8_t* source, uint8_t* acc, Index count) {
+  AccumulateDispatch<MinOp>(source, acc, count);
+}
+
+void AccumulateMinFactor2(const uint16_t* source, uint16_t* acc, Index count) {
+  AccumulateDispatch<MinOp>(source, acc, count);
+}
+
+void AccumulateMinFactor2(const float* source, float* acc, Index count) {
+  AccumulateDispatch<MinOp>(source, acc, count);
+}
+
+void AccumulateMaxFactor2(const uint8_t* source, uint8_t* acc, Index count) {
+  AccumulateDispatch<MaxOp>(source, acc, count);
+}
+
+void AccumulateMaxFactor2(const uint16_t* source, uint16_t* acc, Index count) {
+  AccumulateDispatch<MaxOp>(source, acc, count);
+}
+
+void AccumulateMaxFactor2(const float* source, float* acc, Index count) {
+  AccumulateDispatch<MaxOp>(source, acc, count);
+}
+
+const char* GetDownsampleKernelImplementationName() {
+  switch (GetImplementation()) {
+    case DownsampleKernelImplementation::kAvx2:
+      return "avx2";
+    default:
+      return "portable";
+  }
+}
+
+}  // namespace internal_downsample
+}  // namespace tensorstore
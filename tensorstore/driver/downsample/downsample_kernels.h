@@ -0,0 +1,66 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_DRIVER_DOWNSAMPLE_DOWNSAMPLE_KERNELS_H_
+#define TENSORSTORE_DRIVER_DOWNSAMPLE_DOWNSAMPLE_KERNELS_H_
+
+/// \file
+///
+/// Vectorized kernels for accumulating a contiguous input block that is
+/// downsampled by a factor of 2 along its inner dimension, as used by
+/// `DownsampledNDIterable` for `DownsampleMethod::kMean`, `kMin`, and `kMax`.
+///
+/// Each kernel combines source elements `2*i` and `2*i+1` into the accumulator
+/// `acc[i]`, for `0 <= i < count`, with results identical to accumulating each
+/// source element in turn (first the even element, then the odd element).
+/// Outer downsample factors (e.g. the 2x2x1 and 2x2x2 cases) are handled by the
+/// caller by invoking the kernel once per position within the outer downsample
+/// block.
+///
+/// On x86 with GCC or Clang, an AVX2 implementation is selected at run time
+/// based on the capabilities of the CPU.  Otherwise, a portable implementation
+/// is used.
+
+#include <stdint.h>
+
+#include "tensorstore/index.h"
+
+namespace tensorstore {
+namespace internal_downsample {
+
+/// Adds `source[2*i] + source[2*i+1]` to `acc[i]` for `0 <= i < count`.
+void AccumulateSumFactor2(const uint8_t* source, uint64_t* acc, Index count);
+void AccumulateSumFactor2(const uint16_t* source, uint64_t* acc, Index count);
+void AccumulateSumFactor2(const float* source, float* acc, Index count);
+
+/// Sets `acc[i] = std::min(std::min(acc[i], source[2*i]), source[2*i+1])` for
+/// `0 <= i < count`.
+void AccumulateMinFactor2(const uint8_t* source, uint8_t* acc, Index count);
+void AccumulateMinFactor2(const uint16_t* source, uint16_t* acc, Index count);
+void AccumulateMinFactor2(const float* source, float* acc, Index count);
+
+/// Sets `acc[i] = std::max(std::max(acc[i], source[2*i]), source[2*i+1])` for
+/// `0 <= i < count`.
+void AccumulateMaxFactor2(const uint8_t* source, uint8_t* acc, Index count);
+void AccumulateMaxFactor2(const uint16_t* source, uint16_t* acc, Index count);
+void AccumulateMaxFactor2(const float* source, float* acc, Index count);
+
+/// Returns the name of the implementation used by the kernels above: `"avx2"`
+/// or `"portable"`.
+const char* GetDownsampleKernelImplementationName();
+
+}  // namespace internal_downsample
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_DRIVER_DOWNSAMPLE_DOWNSAMPLE_KERNELS_H_
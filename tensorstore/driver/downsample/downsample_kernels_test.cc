@@ -0,0 +1,179 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/driver/downsample/downsample_kernels.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorstore/index.h"
+
+namespace {
+
+using ::tensorstore::Index;
+using ::tensorstore::internal_downsample::AccumulateMaxFactor2;
+using ::tensorstore::internal_downsample::AccumulateMinFactor2;
+using ::tensorstore::internal_downsample::AccumulateSumFactor2;
+using ::tensorstore::internal_downsample::
+    GetDownsampleKernelImplementationName;
+
+/// Returns the `i`th element of a deterministic sequence that covers the full
+/// range of `T`, and for floating-point types also includes NaN, infinities,
+/// and signed zeros.
+template <typename T>
+T GetTestValue(Index i) {
+  const uint32_t x = static_cast<uint32_t>(i) * 2654435761u;
+  if constexpr (std::is_same_v<T, float>) {
+    switch (x % 16) {
+      case 0:
+        return std::numeric_limits<float>::quiet_NaN();
+      case 1:
+        return std::numeric_limits<float>::infinity();
+      case 2:
+        return -std::numeric_limits<float>::infinity();
+      case 3:
+        return 0.0f;
+      case 4:
+        return -0.0f;
+      default:
+        return static_cast<float>(static_cast<int32_t>(x)) / 3.0f;
+    }
+  } else {
+    return static_cast<T>(x >> 8);
+  }
+}
+
+/// Returns `true` if `a` and `b` have the same bit representation.
+template <typename T>
+bool BitwiseEqual(const std::vector<T>& a, const std::vector<T>& b) {
+  return a.size() == b.size() &&
+         std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// Tests that the kernel selected at run time matches a scalar computation
+// for counts that exercise both the vector loop and the remainder, and for
+// unaligned pointers.
+template <typename Element, typename AccumulateElement, typename Kernel,
+          typename ScalarOp>
+void TestMatchesScalar(Kernel kernel, ScalarOp scalar_op) {
+  SCOPED_TRACE(GetDownsampleKernelImplementationName());
+  for (const Index count : {0, 1, 3, 7, 8, 15, 16, 17, 31, 32, 33, 64, 100}) {
+    for (const Index offset : {0, 1, 3}) {
+      SCOPED_TRACE(::testing::Message() << "count=" << count
+                                        << ", offset=" << offset);
+      std::vector<Element> source(2 * count + offset);
+      for (Index i = 0; i < static_cast<Index>(source.size()); ++i) {
+        source[i] = GetTestValue<Element>(i);
+      }
+      std::vector<AccumulateElement> acc(count + offset);
+      for (Index i = 0; i < static_cast<Index>(acc.size()); ++i) {
+        acc[i] = static_cast<AccumulateElement>(
+            GetTestValue<Element>(i + 12345));
+      }
+      std::vector<AccumulateElement> expected = acc;
+      for (Index i = 0; i < count; ++i) {
+        scalar_op(expected[offset + i], source[offset + 2 * i]);
+        scalar_op(expected[offset + i], source[offset + 2 * i + 1]);
+      }
+      kernel(source.data() + offset, acc.data() + offset, count);
+      EXPECT_TRUE(BitwiseEqual(expected, acc));
+    }
+  }
+}
+
+constexpr auto kSum = [](auto& acc, auto x) { acc += x; };
+constexpr auto kMin = [](auto& acc, auto x) { acc = std::min(acc, x); };
+constexpr auto kMax = [](auto& acc, auto x) { acc = std::max(acc, x); };
+
+TEST(DownsampleKernelsTest, SumUint8) {
+  TestMatchesScalar<uint8_t, uint64_t>(
+      [](const uint8_t* s, uint64_t* a, Index n) {
+        AccumulateSumFactor2(s, a, n);
+      },
+      kSum);
+}
+
+TEST(DownsampleKernelsTest, SumUint16) {
+  TestMatchesScalar<uint16_t, uint64_t>(
+      [](const uint16_t* s, uint64_t* a, Index n) {
+        AccumulateSumFactor2(s, a, n);
+      },
+      kSum);
+}
+
+TEST(DownsampleKernelsTest, SumFloat32) {
+  TestMatchesScalar<float, float>(
+      [](const float* s, float* a, Index n) { AccumulateSumFactor2(s, a, n); },
+      kSum);
+}
+
+TEST(DownsampleKernelsTest, MinUint8) {
+  TestMatchesScalar<uint8_t, uint8_t>(
+      [](const uint8_t* s, uint8_t* a, Index n) {
+        AccumulateMinFactor2(s, a, n);
+      },
+      kMin);
+}
+
+TEST(DownsampleKernelsTest, MinUint16) {
+  TestMatchesScalar<uint16_t, uint16_t>(
+      [](const uint16_t* s, uint16_t* a, Index n) {
+        AccumulateMinFactor2(s, a, n);
+      },
+      kMin);
+}
+
+TEST(DownsampleKernelsTest, MinFloat32) {
+  TestMatchesScalar<float, float>(
+      [](const float* s, float* a, Index n) { AccumulateMinFactor2(s, a, n); },
+      kMin);
+}
+
+TEST(DownsampleKernelsTest, MaxUint8) {
+  TestMatchesScalar<uint8_t, uint8_t>(
+      [](const uint8_t* s, uint8_t* a, Index n) {
+        AccumulateMaxFactor2(s, a, n);
+      },
+      kMax);
+}
+
+TEST(DownsampleKernelsTest, MaxUint16) {
+  TestMatchesScalar<uint16_t, uint16_t>(
+      [](const uint16_t* s, uint16_t* a, Index n) {
+        AccumulateMaxFactor2(s, a, n);
+      },
+      kMax);
+}
+
+TEST(DownsampleKernelsTest, MaxFloat32) {
+  TestMatchesScalar<float, float>(
+      [](const float* s, float* a, Index n) { AccumulateMaxFactor2(s, a, n); },
+      kMax);
+}
+
+TEST(DownsampleKernelsTest, SumUint8Example) {
+  const uint8_t source[6] = {1, 2, 3, 4, 255, 255};
+  uint64_t acc[3] = {10, 20, 30};
+  AccumulateSumFactor2(source, acc, 3);
+  EXPECT_THAT(acc, ::testing::ElementsAre(13, 27, 540));
+}
+
+}  // namespace
@@ -28,6 +28,7 @@
 #include "tensorstore/box.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/downsample_method.h"
+#include "tensorstore/driver/downsample/downsample_kernels.h"
 #include "tensorstore/index.h"
 #include "tensorstore/internal/arena.h"
 #include "tensorstore/internal/nditerable.h"
@@ -440,6 +441,32 @@ template <>
 struct ReductionTraits<DownsampleMethod::kMode, bool>
     : public ReductionTraits<DownsampleMethod::kMean, bool> {};
 
+/// Indicates whether a vectorized kernel from `downsample_kernels.h` is
+/// available for accumulating a contiguous input block with an inner downsample
+/// factor of 2.
+template <DownsampleMethod Method, typename Element>
+constexpr bool kHasFactor2Kernel =
+    (Method == DownsampleMethod::kMean || Method == DownsampleMethod::kMin ||
+     Method == DownsampleMethod::kMax) &&
+    (std::is_same_v<Element, uint8_t> || std::is_same_v<Element, uint16_t> ||
+     std::is_same_v<Element, float32_t>);
+
+/// Accumulates `source[2*i]` and `source[2*i+1]` into `acc[i]`, for
+/// `0 <= i < count`, using the vectorized kernels.
+///
+/// Only valid if `kHasFactor2Kernel<Method, Element>` is `true`.
+template <DownsampleMethod Method, typename Element, typename AccumulateElement>
+void AccumulateFactor2(const Element* source, AccumulateElement* acc,
+                       Index count) {
+  if constexpr (Method == DownsampleMethod::kMean) {
+    AccumulateSumFactor2(source, acc, count);
+  } else if constexpr (Method == DownsampleMethod::kMin) {
+    AccumulateMinFactor2(source, acc, count);
+  } else {
+    AccumulateMaxFactor2(source, acc, count);
+  }
+}
+
 /// Template class that generates the type-specific and method-specific
 /// implementation for performing the downsample computation.
 ///
@@ -493,6 +520,30 @@ struct DownsampleImpl {
               /*max_total_elements=*/outer_divisor * inner_downsample_factor,
               /*element_offset=*/prior_calls + offset * outer_divisor);
         }
+        if constexpr (kHasFactor2Kernel<Method, Element> &&
+                      ArrayAccessor::buffer_kind ==
+                          IterationBufferKind::kContiguous) {
+          if (inner_downsample_factor == 2) {
+            // Handle `output_index>0` using the vectorized kernel for all
+            // complete pairs of input elements, followed by the final
+            // incomplete pair, if any.
+            if (base_block_size + base_block_offset > 2) {
+              const Element* source =
+                  ArrayAccessor::template GetPointerAtOffset<Element>(
+                      source_pointer, 2 - base_block_offset);
+              const Index num_complete =
+                  (base_block_size + base_block_offset) / 2 - 1;
+              AccumulateFactor2<Method>(source, acc + 1, num_complete);
+              if ((base_block_size + base_block_offset) % 2 != 0) {
+                Traits::ProcessInput(
+                    acc, num_complete + 1, source[2 * num_complete],
+                    /*max_total_elements=*/outer_divisor * 2,
+                    /*element_offset=*/prior_calls);
+              }
+            }
+            return output_block_size;
+          }
+        }
         // Handle `output_index>0`.
         for (Index offset = 0; offset < inner_downsample_factor; ++offset) {
           for (Index output_index = 1, source_i = offset - base_block_offset +
@@ -166,6 +166,12 @@ void Driver::Read(internal::OpenTransactionPtr transaction,
                        absl::UnimplementedError("Reading not supported"));
 }
 
+void Driver::ReadInBatch(internal::OpenTransactionPtr transaction,
+                         IndexTransform<> transform, Batch batch,
+                         ReadChunkReceiver receiver) {
+  Read(std::move(transaction), std::move(transform), std::move(receiver));
+}
+
 void Driver::Write(internal::OpenTransactionPtr transaction,
                    IndexTransform<> transform, WriteChunkReceiver receiver) {
   execution::set_error(FlowSingleReceiver{std::move(receiver)},
@@ -44,6 +44,7 @@
 
 #include "absl/status/status.h"
 #include "tensorstore/array.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/chunk_layout.h"
 #include "tensorstore/codec_spec.h"
 #include "tensorstore/data_type.h"
@@ -178,6 +179,15 @@ class Driver : public AtomicReferenceCount<Driver> {
   virtual void Read(internal::OpenTransactionPtr transaction,
                     IndexTransform<> transform, ReadChunkReceiver receiver);
 
+  /// Same as `Read`, except that any I/O required to obtain the chunks may be
+  /// deferred until `batch` is submitted, and coalesced with other requests in
+  /// the same batch.
+  ///
+  /// The default implementation ignores `batch` and simply calls `Read`.
+  virtual void ReadInBatch(internal::OpenTransactionPtr transaction,
+                           IndexTransform<> transform, Batch batch,
+                           ReadChunkReceiver receiver);
+
   using WriteChunkReceiver =
       AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>;
 
@@ -23,9 +23,12 @@
 #include "tensorstore/internal/cache/cache_pool_resource.h"
 #include "tensorstore/internal/cache_key/cache_key.h"
 #include "tensorstore/internal/data_copy_concurrency_resource.h"
+#include "tensorstore/internal/data_type_endian_conversion.h"
 #include "tensorstore/internal/json_binding/staleness_bound.h"
 #include "tensorstore/internal/path.h"
 #include "tensorstore/internal/unowned_to_shared.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/key_range.h"
 #include "tensorstore/tensorstore.h"
 #include "tensorstore/util/iterate_over_index_range.h"
 #include "tensorstore/util/str_cat.h"
@@ -720,6 +723,19 @@ Result<std::size_t> ValidateOpenRequest(OpenState* state,
   return state->GetComponentIndex(metadata, base.spec_->open_mode());
 }
 
+/// Enables the key existence index of `cache`, if the chunks are stored
+/// directly in the base kvstore under `GetBaseKvstorePath()`.
+///
+/// Chunks stored in a different kvstore (e.g. a sharded kvstore adapter) may
+/// not be listed efficiently, so the index is not used for them.
+void EnableChunkExistenceIndex(DataCache& cache) {
+  if (cache.key_existence_index()) return;
+  if (cache.kvstore_driver() != cache.metadata_cache()->base_store()) {
+    return;
+  }
+  cache.EnableKeyExistenceIndex(KeyRange::Prefix(cache.GetBaseKvstorePath()));
+}
+
 /// \pre `component_index` is the result of a previous call to
 ///     `state->GetComponentIndex` with the same `metadata`.
 /// \pre `metadata != nullptr`
@@ -768,6 +784,16 @@ Result<internal::Driver::Handle> CreateTensorStoreFromMetadata(
       auto new_transform,
       GetInitialTransform(chunk_cache.get(), metadata.get(), component_index));
 
+  if (base.spec_->chunk_existence_index) {
+    EnableChunkExistenceIndex(*chunk_cache);
+  }
+  if (auto* index = chunk_cache->key_existence_index()) {
+    // The index is revalidated like the metadata, since both describe the
+    // extent of the stored array rather than its contents.
+    index->Invalidate(
+        base.spec_->staleness.metadata.BoundAtOpen(base.request_time_).time);
+  }
+
   if (base.transaction_ && !base.spec_->assume_metadata) {
     // Add consistency check.
     chunk_cache->metadata_cache_entry_
@@ -1147,6 +1173,306 @@ void DataCache::Entry::DoDecode(std::optional<absl::Cord> value,
   });
 }
 
+absl::Status DataCache::DecodeChunkInto(const void* metadata,
+                                        span<const Index> chunk_indices,
+                                        absl::Cord data,
+                                        std::size_t component_index,
+                                        ArrayView<void> output) {
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto components, DecodeChunk(metadata, chunk_indices, std::move(data)));
+  CopyArray(components[component_index], output);
+  return absl::OkStatus();
+}
+
+Future<std::optional<absl::Cord>> DataCache::ReadEncodedChunk(
+    internal::ChunkCache::Entry& entry,
+    internal::AsyncCacheReadRequest request) {
+  if (auto* index = key_existence_index()) {
+    auto ready = index->Ready();
+    if (!ready.ready()) {
+      return PromiseFuturePair<std::optional<absl::Cord>>::LinkValue(
+                 [this, entry = internal::PinnedCacheEntry<DataCache>(
+                            &static_cast<Entry&>(entry)),
+                  request = std::move(request)](
+                     Promise<std::optional<absl::Cord>> promise,
+                     ReadyFuture<const void>) mutable {
+                   LinkResult(std::move(promise),
+                              ReadEncodedChunk(*entry, std::move(request)));
+                 },
+                 std::move(ready))
+          .future;
+    }
+    if (index->GetMissingTime(
+            static_cast<Entry&>(entry).GetKeyValueStoreKey())) {
+      internal::KvsBackedCache_IncrementReadKeyExistenceIndexMetric();
+      return std::optional<absl::Cord>();
+    }
+  }
+  kvstore::ReadOptions options;
+  options.staleness_bound = request.staleness_bound;
+  options.batch = std::move(request.batch);
+  return MapFutureValue(
+      InlineExecutor{},
+      [](kvstore::ReadResult& read_result) -> std::optional<absl::Cord> {
+        if (!read_result.has_value()) return std::nullopt;
+        return std::move(read_result.value);
+      },
+      kvstore_driver()->Read(static_cast<Entry&>(entry).GetKeyValueStoreKey(),
+                             std::move(options)));
+}
+
+absl::Status DataCache::DecodeEncodedChunk(internal::ChunkCache::Entry& entry,
+                                           const absl::Cord& encoded,
+                                           std::size_t component_index,
+                                           ArrayView<void> output) {
+  return internal::ConvertInvalidArgumentToFailedPrecondition(
+      DecodeChunkInto(initial_metadata_.get(), entry.cell_indices(), encoded,
+                      component_index, output));
+}
+
+std::optional<RawChunkEncoding> DataCache::GetRawChunkEncoding(
+    const void* metadata, span<const Index> chunk_indices,
+    std::size_t component_index) {
+  return std::nullopt;
+}
+
+namespace {
+
+/// Maximum number of byte range requests used to read a region of a chunk.
+constexpr Index kMaxPartialReadRanges = 8;
+
+/// Byte range of an encoded chunk that holds a sub-region of the region being
+/// read.
+struct PartialReadRange {
+  Box<> region;
+  ByteRange byte_range;
+};
+
+/// Returns the smallest byte range of the encoded chunk that contains all
+/// elements within `region`.
+ByteRange GetEncodedByteRange(const RawChunkEncoding& encoding,
+                              BoxView<> region, Index element_size) {
+  Index inclusive_min = encoding.byte_offset;
+  Index exclusive_max = encoding.byte_offset + element_size;
+  const auto byte_strides = encoding.layout.byte_strides();
+  for (DimensionIndex i = 0; i < region.rank(); ++i) {
+    inclusive_min += region.origin()[i] * byte_strides[i];
+    exclusive_max += (region.origin()[i] + region.shape()[i] - 1) *
+                     byte_strides[i];
+  }
+  return ByteRange{static_cast<uint64_t>(inclusive_min),
+                   static_cast<uint64_t>(exclusive_max)};
+}
+
+/// Partitions `region` into byte ranges of the encoded chunk.
+///
+/// A single byte range is used if it spans at most half of the chunk.
+/// Otherwise, `region` is split along the dimension with the largest byte
+/// stride into at most `kMaxPartialReadRanges` byte ranges.
+///
+/// \returns The byte ranges, or an empty vector if the region is better read
+///     by reading the entire chunk.
+std::vector<PartialReadRange> GetPartialReadRanges(
+    const RawChunkEncoding& encoding, BoxView<> region, Index element_size) {
+  std::vector<PartialReadRange> ranges;
+  const auto byte_strides = encoding.layout.byte_strides();
+  DimensionIndex split_dim = -1;
+  for (DimensionIndex i = 0; i < region.rank(); ++i) {
+    if (byte_strides[i] <= 0) return ranges;
+    if (region.shape()[i] > 1 &&
+        (split_dim == -1 || byte_strides[i] > byte_strides[split_dim])) {
+      split_dim = i;
+    }
+  }
+  const Index max_bytes = encoding.layout.num_elements() * element_size / 2;
+  auto byte_range = GetEncodedByteRange(encoding, region, element_size);
+  if (static_cast<Index>(byte_range.size()) <= max_bytes) {
+    ranges.push_back({Box<>(region), byte_range});
+    return ranges;
+  }
+  if (split_dim == -1 || region.shape()[split_dim] > kMaxPartialReadRanges) {
+    return ranges;
+  }
+  Index total_bytes = 0;
+  for (Index i = 0; i < region.shape()[split_dim]; ++i) {
+    Box<> sub_region(region);
+    sub_region[split_dim] =
+        IndexInterval::UncheckedSized(region.origin()[split_dim] + i, 1);
+    byte_range = GetEncodedByteRange(encoding, sub_region, element_size);
+    total_bytes += byte_range.size();
+    ranges.push_back({std::move(sub_region), byte_range});
+  }
+  if (total_bytes > max_bytes) ranges.clear();
+  return ranges;
+}
+
+/// State of a `DataCache::ReadPartialChunk` operation.
+struct PartialChunkRead {
+  internal::PinnedCacheEntry<DataCache> entry;
+  std::size_t component_index;
+  Box<> region;
+  RawChunkEncoding encoding;
+  std::vector<PartialReadRange> ranges;
+  internal::AsyncCacheReadRequest request;
+
+  /// Read result for each element of `ranges`, followed by the read result
+  /// for `encoding.expected_prefix`, if non-empty.
+  std::vector<Future<kvstore::ReadResult>> futures;
+
+  /// Decodes `region` from the byte range read results.
+  ///
+  /// \returns The decoded region, or a null array if the chunk is not present,
+  ///     or `std::nullopt` if the entire chunk must be read instead, because
+  ///     the read results are inconsistent or do not match `encoding`.
+  std::optional<SharedOffsetArray<const void>> Decode() {
+    const auto& first = futures.front().value();
+    for (auto& future : futures) {
+      const auto& read_result = future.value();
+      if (read_result.aborted() ||
+          read_result.stamp.generation != first.stamp.generation) {
+        // The chunk was modified concurrently.
+        return std::nullopt;
+      }
+    }
+    if (!first.has_value()) return SharedOffsetArray<const void>();
+    if (!encoding.expected_prefix.empty() &&
+        futures.back().value().value != encoding.expected_prefix) {
+      return std::nullopt;
+    }
+    const auto& component_spec =
+        GetOwningCache(*entry).grid().components[component_index];
+    const DataType dtype = component_spec.dtype();
+    auto output = AllocateArray(region, c_order, default_init, dtype);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      const auto& range = ranges[i];
+      auto& value = futures[i].value().value;
+      if (value.size() != range.byte_range.size()) return std::nullopt;
+      const std::string_view data = value.Flatten();
+      Index output_byte_offset = 0;
+      for (DimensionIndex j = 0; j < range.region.rank(); ++j) {
+        output_byte_offset +=
+            range.region.origin()[j] * output.byte_strides()[j];
+      }
+      internal::DecodeArray(
+          ArrayView<const void>(
+              ElementPointer<const void>(
+                  static_cast<const void*>(data.data()), dtype),
+              StridedLayoutView<>(range.region.shape(),
+                                  encoding.layout.byte_strides())),
+          encoding.endianness,
+          ArrayView<void>(
+              ElementPointer<void>(
+                  static_cast<void*>(static_cast<char*>(output.data()) +
+                                     output_byte_offset),
+                  dtype),
+              StridedLayoutView<>(range.region.shape(),
+                                  output.byte_strides())));
+    }
+    return SharedOffsetArray<const void>(std::move(output));
+  }
+};
+
+/// Reads and decodes the entire chunk, as a fallback for
+/// `DataCache::ReadPartialChunk`.
+Future<SharedOffsetArray<const void>> ReadEntireChunk(
+    internal::PinnedCacheEntry<DataCache> entry, std::size_t component_index,
+    internal::AsyncCacheReadRequest request) {
+  auto& cache = GetOwningCache(*entry);
+  auto encoded_future = cache.ReadEncodedChunk(*entry, std::move(request));
+  return MapFutureValue(
+      cache.executor(),
+      [entry = std::move(entry), component_index](
+          std::optional<absl::Cord>& encoded)
+          -> Result<SharedOffsetArray<const void>> {
+        if (!encoded) return SharedOffsetArray<const void>();
+        auto& cache = GetOwningCache(*entry);
+        const auto& component_spec = cache.grid().components[component_index];
+        auto array = AllocateArray(component_spec.shape(), c_order,
+                                   default_init, component_spec.dtype());
+        TENSORSTORE_RETURN_IF_ERROR(cache.DecodeEncodedChunk(
+            *entry, *encoded, component_index, array));
+        return SharedOffsetArray<const void>(std::move(array));
+      },
+      std::move(encoded_future));
+}
+
+}  // namespace
+
+Future<SharedOffsetArray<const void>> DataCache::ReadPartialChunk(
+    internal::ChunkCache::Entry& entry, std::size_t component_index,
+    BoxView<> region, internal::AsyncCacheReadRequest request) {
+  auto encoding = GetRawChunkEncoding(initial_metadata_.get(),
+                                      entry.cell_indices(), component_index);
+  if (!encoding) return {};
+  auto ranges = GetPartialReadRanges(
+      *encoding, region, grid().components[component_index].dtype().size());
+  if (ranges.empty()) return {};
+  auto key = static_cast<Entry&>(entry).GetKeyValueStoreKey();
+  if (auto* index = key_existence_index()) {
+    // Until the index is ready, the regular read path waits for it.
+    if (!index->Ready().ready()) return {};
+    if (index->GetMissingTime(key)) {
+      internal::KvsBackedCache_IncrementReadKeyExistenceIndexMetric();
+      return MakeReadyFuture<SharedOffsetArray<const void>>();
+    }
+  }
+  auto state = std::make_shared<PartialChunkRead>();
+  state->entry.reset(&static_cast<Entry&>(entry));
+  state->component_index = component_index;
+  state->region = region;
+  state->encoding = *std::move(encoding);
+  state->ranges = std::move(ranges);
+  std::vector<OptionalByteRangeRequest> byte_ranges;
+  for (const auto& range : state->ranges) {
+    byte_ranges.push_back(range.byte_range);
+  }
+  if (!state->encoding.expected_prefix.empty()) {
+    byte_ranges.push_back(
+        OptionalByteRangeRequest(0, state->encoding.expected_prefix.size()));
+  }
+  // The batch is handed off to the byte range reads: `state` must not retain
+  // a handle, since the batch is not submitted until all handles are released
+  // and `state` lives until those reads complete.  For the same reason, the
+  // fallback read of the entire chunk is not batched.
+  for (size_t i = 0; i < byte_ranges.size(); ++i) {
+    kvstore::ReadOptions options;
+    options.staleness_bound = request.staleness_bound;
+    options.batch = (i + 1 == byte_ranges.size())
+                        ? std::exchange(request.batch, no_batch)
+                        : request.batch;
+    options.byte_range = byte_ranges[i];
+    state->futures.push_back(kvstore_driver()->Read(key, std::move(options)));
+  }
+  state->request = std::move(request);
+  assert(!state->request.batch);
+  std::vector<AnyFuture> futures(state->futures.begin(),
+                                 state->futures.end());
+  auto [promise, future] =
+      PromiseFuturePair<SharedOffsetArray<const void>>::Make();
+  WaitAllFuture(futures).ExecuteWhenReady(WithExecutor(
+      executor(), [state = std::move(state), promise = std::move(promise)](
+                      ReadyFuture<void> future) {
+        auto& result = future.result();
+        if (!result.ok() && !absl::IsOutOfRange(result.status())) {
+          promise.SetResult(result.status());
+          return;
+        }
+        // A byte range beyond the end of the chunk indicates that the chunk
+        // does not match `encoding`.
+        if (result.ok()) {
+          if (auto decoded = state->Decode()) {
+            promise.SetResult(*std::move(decoded));
+            return;
+          }
+        }
+        LinkResult(promise,
+                   ReadEntireChunk(std::move(state->entry),
+                                   state->component_index,
+                                   std::move(state->request)));
+      }));
+  return std::move(future);
+}
+
 void DataCache::Entry::DoEncode(std::shared_ptr<const ReadData> data,
                                 EncodeReceiver receiver) {
   if (!data) {
@@ -1432,6 +1758,10 @@ TENSORSTORE_DEFINE_JSON_BINDER(
             jb::Member("recheck_cached_data",
                        jb::Projection(&StalenessBounds::data,
                                       jb::DefaultInitializedValue())))),
+        jb::Member("chunk_existence_index",
+                   jb::Projection<&KvsDriverSpec::chunk_existence_index>(
+                       jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                           [](auto* v) { *v = false; }))),
         internal::OpenModeSpecJsonBinder));
 
 }  // namespace internal_kvs_backed_chunk_driver
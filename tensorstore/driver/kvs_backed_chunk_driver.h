@@ -22,6 +22,8 @@
 /// chunk.
 
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 
 #include "absl/container/inlined_vector.h"
@@ -47,6 +49,8 @@
 #include "tensorstore/open_mode.h"
 #include "tensorstore/serialization/absl_time.h"
 #include "tensorstore/spec.h"
+#include "tensorstore/strided_layout.h"
+#include "tensorstore/util/endian.h"
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/result.h"
 
@@ -65,10 +69,15 @@ struct KvsDriverSpec : public internal::DriverSpec,
   Context::Resource<internal::CachePoolResource> cache_pool;
   StalenessBounds staleness;
 
+  /// Enables an index of the existing chunks, built by listing the kvstore,
+  /// that avoids reading chunks known not to exist.
+  bool chunk_existence_index = false;
+
   static constexpr auto ApplyMembers = [](auto& x, auto f) {
     return f(internal::BaseCast<internal::DriverSpec>(x),
              internal::BaseCast<internal::OpenModeSpec>(x), x.store,
-             x.data_copy_concurrency, x.cache_pool, x.staleness);
+             x.data_copy_concurrency, x.cache_pool, x.staleness,
+             x.chunk_existence_index);
   };
 
   kvstore::Spec GetKvstore() const override;
@@ -266,6 +275,26 @@ class MetadataCache
   Context::Resource<internal::CachePoolResource> cache_pool_;
 };
 
+/// Describes how a component of an uncompressed chunk is stored within the
+/// encoded chunk, which allows a region of the component to be read using
+/// byte range requests.
+struct RawChunkEncoding {
+  /// Byte offset within the encoded chunk of the element at the origin of the
+  /// component.
+  Index byte_offset = 0;
+
+  /// Shape of the component, and byte strides of the encoded elements.  All
+  /// byte strides must be positive.
+  StridedLayout<> layout;
+
+  /// Byte order of the encoded elements.
+  endian endianness = endian::native;
+
+  /// If non-empty, the layout applies only if the encoded chunk starts with
+  /// these bytes (e.g. a chunk header).  Otherwise, the entire chunk is read.
+  std::string expected_prefix;
+};
+
 /// Inherits from `ChunkCache` and represents one or more chunked arrays that
 /// are stored within the same set of chunks.
 ///
@@ -414,6 +443,37 @@ class DataCache
   DecodeChunk(const void* metadata, span<const Index> chunk_indices,
               absl::Cord data) = 0;
 
+  /// Decodes component `component_index` of a data chunk directly into
+  /// `output`.
+  ///
+  /// The default implementation calls `DecodeChunk` and copies the decoded
+  /// component to `output`.  Drivers may override this to avoid the
+  /// intermediate array.
+  ///
+  /// \param metadata The metadata (which may determine the decoding).
+  /// \param data The encoded chunk data.
+  /// \param output The output array, with a shape equal to
+  ///     `grid.components[component_index].shape()`.
+  virtual absl::Status DecodeChunkInto(const void* metadata,
+                                       span<const Index> chunk_indices,
+                                       absl::Cord data,
+                                       std::size_t component_index,
+                                       ArrayView<void> output);
+
+  /// Returns the encoding of component `component_index` of a data chunk if
+  /// it is stored uncompressed, or `std::nullopt` otherwise.
+  ///
+  /// If specified, reads of small regions of a chunk that bypass the cache are
+  /// performed using byte range requests.  The default implementation returns
+  /// `std::nullopt`.
+  ///
+  /// \param metadata The metadata (which may determine the encoding).
+  /// \param chunk_indices Grid cell indices of the chunk.
+  /// \param component_index The ChunkCache component index.
+  virtual std::optional<RawChunkEncoding> GetRawChunkEncoding(
+      const void* metadata, span<const Index> chunk_indices,
+      std::size_t component_index);
+
   /// Encodes a data chunk.
   ///
   /// \param metadata The metadata (which may determine the encoding).
@@ -443,6 +503,17 @@ class DataCache
     return new TransactionNode(static_cast<Entry&>(entry));
   }
 
+  Future<std::optional<absl::Cord>> ReadEncodedChunk(
+      internal::ChunkCache::Entry& entry,
+      internal::AsyncCacheReadRequest request) final;
+  absl::Status DecodeEncodedChunk(internal::ChunkCache::Entry& entry,
+                                  const absl::Cord& encoded,
+                                  std::size_t component_index,
+                                  ArrayView<void> output) final;
+  Future<SharedOffsetArray<const void>> ReadPartialChunk(
+      internal::ChunkCache::Entry& entry, std::size_t component_index,
+      BoxView<> region, internal::AsyncCacheReadRequest request) final;
+
   /// Returns the kvstore path to include in the spec.
   virtual std::string GetBaseKvstorePath() = 0;
 
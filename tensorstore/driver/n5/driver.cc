@@ -230,6 +230,22 @@ class DataCache : public internal_kvs_backed_chunk_driver::DataCache {
         std::move(array)};
   }
 
+  std::optional<internal_kvs_backed_chunk_driver::RawChunkEncoding>
+  GetRawChunkEncoding(const void* metadata, span<const Index> chunk_indices,
+                      std::size_t component_index) override {
+    const auto& n5_metadata = *static_cast<const N5Metadata*>(metadata);
+    if (n5_metadata.compressor) return std::nullopt;
+    internal_kvs_backed_chunk_driver::RawChunkEncoding encoding;
+    // Chunks written by other implementations may be truncated at the upper
+    // bound of the array, in which case the header does not match and the
+    // entire chunk is read.
+    encoding.expected_prefix = internal_n5::EncodeChunkHeader(n5_metadata);
+    encoding.byte_offset = encoding.expected_prefix.size();
+    encoding.layout = n5_metadata.chunk_layout;
+    encoding.endianness = endian::big;
+    return encoding;
+  }
+
   Result<absl::Cord> EncodeChunk(
       const void* metadata, span<const Index> chunk_indices,
       span<const SharedArrayView<const void>> component_arrays) override {
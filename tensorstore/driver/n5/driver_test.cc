@@ -14,14 +14,24 @@
 
 /// End-to-end tests of the n5 driver.
 
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "tensorstore/context.h"
 #include "tensorstore/driver/driver_testutil.h"
 #include "tensorstore/index_space/dim_expression.h"
 #include "tensorstore/index_space/index_domain_builder.h"
 #include "tensorstore/internal/global_initializer.h"
 #include "tensorstore/internal/parse_json_matches.h"
+#include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/memory/memory_key_value_store.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
 #include "tensorstore/kvstore/operations.h"
 #include "tensorstore/kvstore/test_util.h"
 #include "tensorstore/open.h"
@@ -1780,4 +1790,92 @@ TEST(DriverTest, ResolutionOnlyMetadataMismatch) {
       MatchesStatus(absl::StatusCode::kFailedPrecondition, ".*\"units\".*"));
 }
 
+// Returns an uncompressed n5 block of `int16` with the specified `shape`, in
+// which element `(i, j)` equals `10 * (i + origin0) + j`.
+std::string MakeRawBlock(Index origin0, Index shape0, Index shape1) {
+  std::string block = {0, 0, 0, 2, 0, 0, 0, static_cast<char>(shape0),
+                       0, 0, 0, static_cast<char>(shape1)};
+  for (Index j = 0; j < shape1; ++j) {
+    for (Index i = 0; i < shape0; ++i) {
+      const int16_t value = static_cast<int16_t>(10 * (i + origin0) + j);
+      block += static_cast<char>(value >> 8);
+      block += static_cast<char>(value & 0xff);
+    }
+  }
+  return block;
+}
+
+// Tests that reading a small region of an uncompressed block reads only the
+// corresponding byte range and verifies the block header, and that a
+// truncated block falls back to reading the entire block.
+TEST(N5DriverTest, PartialChunkRead) {
+  auto context = Context::Default();
+  auto mock_key_value_store =
+      *context.GetResource<tensorstore::internal::MockKeyValueStoreResource>()
+           .value();
+  auto memory_store = tensorstore::GetMemoryKeyValueStore();
+  auto store_future = tensorstore::Open(
+      {
+          {"driver", "n5"},
+          {"kvstore",
+           {
+               {"driver", "mock_key_value_store"},
+               {"path", "prefix/"},
+           }},
+          {"metadata",
+           {
+               {"compression", {{"type", "raw"}}},
+               {"dataType", "int16"},
+               {"dimensions", {15, 10}},
+               {"blockSize", {10, 10}},
+           }},
+          {"create", true},
+      },
+      context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  TENSORSTORE_ASSERT_OK(kvstore::Write(memory_store, "prefix/0/0",
+                                       absl::Cord(MakeRawBlock(0, 10, 10))));
+  // Block `1/0` is truncated to the bounds of the array.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(memory_store, "prefix/1/0",
+                                       absl::Cord(MakeRawBlock(10, 5, 10))));
+
+  const auto handle_read_request =
+      [&](std::string_view key,
+          tensorstore::OptionalByteRangeRequest byte_range) {
+        auto read_request = mock_key_value_store->read_requests.pop();
+        EXPECT_EQ(key, read_request.key);
+        EXPECT_EQ(byte_range, read_request.options.byte_range);
+        read_request(memory_store);
+      };
+
+  // The byte range follows the 12-byte header, and the header is read to
+  // verify that the block has the full shape.
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({3, 2}, {2, 2}));
+  read_future.Force();
+  handle_read_request("prefix/0/0", {58, 82});
+  handle_read_request("prefix/0/0", {0, 12});
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<int16_t>(
+                  {3, 2}, {{32, 33}, {42, 43}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+
+  // The header of the truncated block does not match, and the entire block is
+  // read instead.
+  read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({11, 2}, {2, 2}));
+  read_future.Force();
+  handle_read_request("prefix/1/0", {54, 78});
+  handle_read_request("prefix/1/0", {0, 12});
+  handle_read_request("prefix/1/0", {});
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<int16_t>(
+                  {11, 2}, {{112, 113}, {122, 123}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
 }  // namespace
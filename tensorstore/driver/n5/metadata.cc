@@ -15,6 +15,7 @@
 #include "tensorstore/driver/n5/metadata.h"
 
 #include <optional>
+#include <string>
 
 #include "absl/algorithm/container.h"
 #include "absl/base/internal/endian.h"
@@ -286,6 +287,18 @@ Result<SharedArrayView<const void>> DecodeChunk(const N5Metadata& metadata,
   return full_decoded_array;
 }
 
+std::string EncodeChunkHeader(const N5Metadata& metadata) {
+  std::string header(GetChunkHeaderSize(metadata), '\0');
+  absl::big_endian::Store16(header.data(), 0);  // mode: 0x0 = default
+  const DimensionIndex rank = metadata.rank;
+  absl::big_endian::Store16(header.data() + 2, rank);
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    absl::big_endian::Store32(header.data() + 4 + i * 4,
+                              metadata.chunk_layout.shape()[i]);
+  }
+  return header;
+}
+
 Result<absl::Cord> EncodeChunk(span<const Index> chunk_indices,
                                const N5Metadata& metadata,
                                ArrayView<const void> array) {
@@ -310,16 +323,7 @@ Result<absl::Cord> EncodeChunk(span<const Index> chunk_indices,
         riegeli::Write(std::move(encoded_cord), std::move(writer)));
     encoded_cord = std::move(compressed);
   }
-  internal::FlatCordBuilder header(GetChunkHeaderSize(metadata));
-  // Write header
-  absl::big_endian::Store16(header.data(), 0);  // mode: 0x0 = default
-  const DimensionIndex rank = metadata.rank;
-  absl::big_endian::Store16(header.data() + 2, rank);
-  for (DimensionIndex i = 0; i < rank; ++i) {
-    absl::big_endian::Store32(header.data() + 4 + i * 4,
-                              encoded_array.shape()[i]);
-  }
-  auto full_cord = std::move(header).Build();
+  absl::Cord full_cord(EncodeChunkHeader(metadata));
   full_cord.Append(std::move(encoded_cord));
   return full_cord;
 }
@@ -225,6 +225,10 @@ Result<DimensionUnitsVector> GetEffectiveDimensionUnits(
 Result<SharedArrayView<const void>> DecodeChunk(const N5Metadata& metadata,
                                                 absl::Cord buffer);
 
+/// Returns the header written by `EncodeChunk`, which specifies the default
+/// mode and the full chunk shape.
+std::string EncodeChunkHeader(const N5Metadata& metadata);
+
 /// Encodes a chunk.
 Result<absl::Cord> EncodeChunk(span<const Index> chunk_indices,
                                const N5Metadata& metadata,
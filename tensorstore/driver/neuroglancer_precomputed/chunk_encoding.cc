@@ -262,7 +262,7 @@ Result<absl::Cord> EncodeJpegChunk(DataType dtype, int quality,
 
 Result<absl::Cord> EncodeCompressedSegmentationChunk(
     DataType dtype, span<const Index, 4> shape, ArrayView<const void> array,
-    std::array<Index, 3> block_size) {
+    std::array<Index, 3> block_size, const Executor& executor) {
   std::ptrdiff_t input_shape_ptrdiff_t[4] = {shape[0], shape[1], shape[2],
                                              shape[3]};
   std::ptrdiff_t block_shape_ptrdiff_t[3] = {block_size[2], block_size[1],
@@ -276,13 +276,13 @@ Result<absl::Cord> EncodeCompressedSegmentationChunk(
       neuroglancer_compressed_segmentation::EncodeChannels(
           static_cast<const std::uint32_t*>(array.data()),
           input_shape_ptrdiff_t, input_byte_strides, block_shape_ptrdiff_t,
-          &out);
+          &out, executor);
       break;
     case DataTypeId::uint64_t:
       neuroglancer_compressed_segmentation::EncodeChannels(
           static_cast<const std::uint64_t*>(array.data()),
           input_shape_ptrdiff_t, input_byte_strides, block_shape_ptrdiff_t,
-          &out);
+          &out, executor);
       break;
     default:
       ABSL_UNREACHABLE();  // COV_NF_LINE
@@ -293,7 +293,8 @@ Result<absl::Cord> EncodeCompressedSegmentationChunk(
 Result<absl::Cord> EncodeChunk(span<const Index> chunk_indices,
                                const MultiscaleMetadata& metadata,
                                std::size_t scale_index,
-                               const SharedArrayView<const void>& array) {
+                               const SharedArrayView<const void>& array,
+                               const Executor& executor) {
   const auto& scale_metadata = metadata.scales[scale_index];
   std::array<Index, 4> partial_chunk_shape;
   GetChunkShape(chunk_indices, metadata, scale_index,
@@ -308,7 +309,7 @@ Result<absl::Cord> EncodeChunk(span<const Index> chunk_indices,
     case ScaleMetadata::Encoding::compressed_segmentation:
       return EncodeCompressedSegmentationChunk(
           metadata.dtype, partial_chunk_shape, array,
-          scale_metadata.compressed_segmentation_block_size);
+          scale_metadata.compressed_segmentation_block_size, executor);
   }
   ABSL_UNREACHABLE();  // COV_NF_LINE
 }
@@ -21,6 +21,7 @@
 #include "tensorstore/array.h"
 #include "tensorstore/driver/neuroglancer_precomputed/metadata.h"
 #include "tensorstore/index.h"
+#include "tensorstore/util/executor.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/span.h"
 
@@ -49,11 +50,13 @@ Result<SharedArrayView<const void>> DecodeChunk(
 /// \param metadata Metadata (determines chunk format and volume bounds).
 /// \param scale_index Scale index, in range `[0, metadata.scales.size())`.
 /// \param array Chunk data, in "czyx" order.
+/// \param executor If non-null, may be used to parallelize encoding.
 /// \returns The encoded chunk.
 Result<absl::Cord> EncodeChunk(span<const Index> chunk_indices,
                                const MultiscaleMetadata& metadata,
                                std::size_t scale_index,
-                               const SharedArrayView<const void>& array);
+                               const SharedArrayView<const void>& array,
+                               const Executor& executor = {});
 
 }  // namespace internal_neuroglancer_precomputed
 }  // namespace tensorstore
@@ -23,6 +23,7 @@
 #include "tensorstore/driver/registry.h"
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/index_transform_builder.h"
+#include "tensorstore/internal/cache/cache_pool_resource.h"
 #include "tensorstore/internal/cache/chunk_cache.h"
 #include "tensorstore/internal/cache_key/cache_key.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
@@ -53,12 +54,19 @@ class NeuroglancerPrecomputedDriverSpec
 
   OpenConstraints open_constraints;
 
+  /// Cache pool for the shard and minishard indices of sharded scales.
+  Context::Resource<internal::CachePoolResource> index_cache_pool;
+
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(internal::BaseCast<KvsDriverSpec>(x), x.open_constraints);
+    return f(internal::BaseCast<KvsDriverSpec>(x), x.open_constraints,
+             x.index_cache_pool);
   };
 
   static inline const auto default_json_binder = jb::Sequence(
       internal_kvs_backed_chunk_driver::SpecJsonBinder,
+      jb::Member("index_cache_pool",
+                 jb::Projection<
+                     &NeuroglancerPrecomputedDriverSpec::index_cache_pool>()),
       [](auto is_loading, auto options, auto* obj, auto* j) {
         options.Set(obj->schema.dtype());
         return jb::DefaultBinder<>(is_loading, options, &obj->open_constraints,
@@ -162,14 +170,16 @@ class DataCacheBase : public internal_kvs_backed_chunk_driver::DataCache {
   using Base = internal_kvs_backed_chunk_driver::DataCache;
 
  public:
-  explicit DataCacheBase(Initializer initializer, std::string_view key_prefix,
-                         const MultiscaleMetadata& metadata,
-                         std::size_t scale_index,
-                         std::array<Index, 3> chunk_size_xyz)
+  explicit DataCacheBase(
+      Initializer initializer, std::string_view key_prefix,
+      const MultiscaleMetadata& metadata, std::size_t scale_index,
+      std::array<Index, 3> chunk_size_xyz,
+      Context::Resource<internal::CachePoolResource> index_cache_pool)
       : Base(std::move(initializer),
              GetChunkGridSpecification(metadata, scale_index, chunk_size_xyz)),
         key_prefix_(key_prefix),
-        scale_index_(scale_index) {
+        scale_index_(scale_index),
+        index_cache_pool_(std::move(index_cache_pool)) {
     chunk_layout_czyx_.shape()[0] = metadata.num_channels;
     for (int i = 0; i < 3; ++i) {
       chunk_layout_czyx_.shape()[1 + i] = chunk_size_xyz[2 - i];
@@ -268,7 +278,7 @@ class DataCacheBase : public internal_kvs_backed_chunk_driver::DataCache {
     assert(component_arrays.size() == 1);
     return internal_neuroglancer_precomputed::EncodeChunk(
         chunk_indices, *static_cast<const MultiscaleMetadata*>(metadata),
-        scale_index_, component_arrays[0]);
+        scale_index_, component_arrays[0], executor());
   }
 
   Result<IndexTransform<>> GetExternalToInternalTransform(
@@ -316,6 +326,7 @@ class DataCacheBase : public internal_kvs_backed_chunk_driver::DataCache {
     auto& multiscale_constraints = spec.open_constraints.multiscale;
     multiscale_constraints.num_channels = metadata.num_channels;
     multiscale_constraints.type = metadata.type;
+    spec.index_cache_pool = index_cache_pool_;
     return absl::OkStatus();
   }
 
@@ -355,17 +366,18 @@ class DataCacheBase : public internal_kvs_backed_chunk_driver::DataCache {
   std::size_t scale_index_;
   // channel, z, y, x
   StridedLayout<4> chunk_layout_czyx_;
+  Context::Resource<internal::CachePoolResource> index_cache_pool_;
 };
 
 class UnshardedDataCache : public DataCacheBase {
  public:
-  explicit UnshardedDataCache(Initializer initializer,
-                              std::string_view key_prefix,
-                              const MultiscaleMetadata& metadata,
-                              std::size_t scale_index,
-                              std::array<Index, 3> chunk_size_xyz)
+  explicit UnshardedDataCache(
+      Initializer initializer, std::string_view key_prefix,
+      const MultiscaleMetadata& metadata, std::size_t scale_index,
+      std::array<Index, 3> chunk_size_xyz,
+      Context::Resource<internal::CachePoolResource> index_cache_pool)
       : DataCacheBase(std::move(initializer), key_prefix, metadata, scale_index,
-                      chunk_size_xyz) {
+                      chunk_size_xyz, std::move(index_cache_pool)) {
     const auto& scale = metadata.scales[scale_index];
     scale_key_prefix_ = ResolveScaleKey(key_prefix, scale.key);
   }
@@ -405,13 +417,13 @@ class UnshardedDataCache : public DataCacheBase {
 
 class ShardedDataCache : public DataCacheBase {
  public:
-  explicit ShardedDataCache(Initializer initializer,
-                            std::string_view key_prefix,
-                            const MultiscaleMetadata& metadata,
-                            std::size_t scale_index,
-                            std::array<Index, 3> chunk_size_xyz)
+  explicit ShardedDataCache(
+      Initializer initializer, std::string_view key_prefix,
+      const MultiscaleMetadata& metadata, std::size_t scale_index,
+      std::array<Index, 3> chunk_size_xyz,
+      Context::Resource<internal::CachePoolResource> index_cache_pool)
       : DataCacheBase(std::move(initializer), key_prefix, metadata, scale_index,
-                      chunk_size_xyz) {
+                      chunk_size_xyz, std::move(index_cache_pool)) {
     const auto& scale = metadata.scales[scale_index];
     compressed_z_index_bits_ =
         GetCompressedZIndexBits(scale.box.shape(), chunk_size_xyz);
@@ -517,7 +529,8 @@ class NeuroglancerPrecomputedDriver::OpenState
         GetMetadataCompatibilityKey(
             *static_cast<const MultiscaleMetadata*>(metadata),
             scale_index_ ? *scale_index_ : *spec.open_constraints.scale_index,
-            chunk_size_xyz_));
+            chunk_size_xyz_),
+        spec.index_cache_pool);
     return result;
   }
 
@@ -552,11 +565,11 @@ class NeuroglancerPrecomputedDriver::OpenState
     if (std::holds_alternative<ShardingSpec>(scale.sharding)) {
       return std::make_unique<ShardedDataCache>(
           std::move(initializer), spec().store.path, metadata,
-          scale_index_.value(), chunk_size_xyz_);
+          scale_index_.value(), chunk_size_xyz_, spec().index_cache_pool);
     } else {
       return std::make_unique<UnshardedDataCache>(
           std::move(initializer), spec().store.path, metadata,
-          scale_index_.value(), chunk_size_xyz_);
+          scale_index_.value(), chunk_size_xyz_, spec().index_cache_pool);
     }
   }
 
@@ -608,7 +621,8 @@ class NeuroglancerPrecomputedDriver::OpenState
           ResolveScaleKey(spec().store.path, scale.key), *sharding_spec,
           *cache_pool(),
           GetChunksPerVolumeShardFunction(*sharding_spec, scale.box.shape(),
-                                          scale.chunk_sizes[0]));
+                                          scale.chunk_sizes[0]),
+          *spec().index_cache_pool);
     }
     return base_kv_store;
   }
@@ -1471,6 +1471,57 @@ TEST(ShardedWriteTest, Basic) {
   EXPECT_THAT(tensorstore::Read(store).result(), ::testing::Optional(array));
 }
 
+// Tests that a separate `index_cache_pool` is used for the shard indices and
+// is preserved in the spec.
+TEST(ShardedWriteTest, IndexCachePool) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(
+          {
+              {"context",
+               {{"cache_pool#index", {{"total_bytes_limit", 10'000'000}}}}},
+              {"driver", "neuroglancer_precomputed"},
+              {"kvstore",
+               {
+                   {"driver", "memory"},
+                   {"path", "prefix/"},
+               }},
+              {"index_cache_pool", "cache_pool#index"},
+              {"multiscale_metadata",
+               {
+                   {"data_type", "uint16"},
+                   {"num_channels", 1},
+                   {"type", "image"},
+               }},
+              {"scale_metadata",
+               {
+                   {"resolution", {1, 1, 1}},
+                   {"encoding", "raw"},
+                   {"chunk_size", {2, 2, 1}},
+                   {"size", {4, 4, 1}},
+                   {"voxel_offset", {0, 0, 0}},
+                   {"sharding",
+                    {{"@type", "neuroglancer_uint64_sharded_v1"},
+                     {"preshift_bits", 0},
+                     {"minishard_bits", 1},
+                     {"shard_bits", 0},
+                     {"hash", "identity"}}},
+               }},
+              {"create", true},
+          })
+          .result());
+  auto array = tensorstore::MakeArray<std::uint16_t>(
+      {{{{1}}, {{2}}, {{3}}, {{4}}},
+       {{{5}}, {{6}}, {{7}}, {{8}}},
+       {{{9}}, {{10}}, {{11}}, {{12}}},
+       {{{13}}, {{14}}, {{15}}, {{16}}}});
+  TENSORSTORE_ASSERT_OK(tensorstore::Write(array, store).result());
+  EXPECT_THAT(tensorstore::Read(store).result(), ::testing::Optional(array));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto spec, store.spec());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto spec_json, spec.ToJson());
+  EXPECT_TRUE(spec_json.contains("index_cache_pool")) << spec_json.dump();
+}
+
 // Disable due to race condition whereby writeback of a shard may start while
 // some chunks that have been modified are still being written back to it.
 TEST(FullShardWriteTest, Basic) {
@@ -14,13 +14,21 @@
 
 #include "tensorstore/driver/read.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cassert>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorstore/array.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/box.h"
 #include "tensorstore/container_kind.h"
 #include "tensorstore/contiguous_layout.h"
@@ -31,10 +39,12 @@
 #include "tensorstore/driver/driver_handle.h"
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/alignment.h"
+#include "tensorstore/index_space/index_domain_builder.h"
 #include "tensorstore/index_space/index_transform.h"
 #include "tensorstore/index_space/transformed_array.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/lock_collection.h"
+#include "tensorstore/internal/mutex.h"
 #include "tensorstore/internal/nditerable.h"
 #include "tensorstore/internal/nditerable_copy.h"
 #include "tensorstore/internal/nditerable_data_type_conversion.h"
@@ -49,10 +59,15 @@
 #include "tensorstore/resize_options.h"
 #include "tensorstore/transaction.h"
 #include "tensorstore/util/element_pointer.h"
+#include "tensorstore/util/division.h"
+#include "tensorstore/util/execution/any_receiver.h"
+#include "tensorstore/util/execution/any_sender.h"
+#include "tensorstore/util/execution/execution.h"
 #include "tensorstore/util/execution/sender.h"
 #include "tensorstore/util/executor.h"
 #include "tensorstore/util/extents.h"
 #include "tensorstore/util/future.h"
+#include "tensorstore/util/iterate.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 
@@ -103,6 +118,9 @@ struct ReadState
   TransformedArray<Shared<void>> target;
   DomainAlignmentOptions alignment_options;
   ReadProgressFunction read_progress_function;
+  // Batch with which to issue the read.  Released once the read has been
+  // issued so that the batch is not held open by the in-progress read.
+  Batch batch{no_batch};
   Promise<PromiseValue> promise;
   std::atomic<Index> copied_elements{0};
   Index total_elements;
@@ -185,9 +203,10 @@ struct DriverReadIntoExistingInitiateOp {
     // Initiate the read on the driver.
     auto source_driver = std::move(state->source_driver);
     auto source_transaction = std::move(state->source_transaction);
-    source_driver->Read(std::move(source_transaction),
-                        std::move(source_transform),
-                        ReadChunkReceiver<void>{std::move(state)});
+    auto batch = std::exchange(state->batch, no_batch);
+    source_driver->ReadInBatch(std::move(source_transaction),
+                               std::move(source_transform), std::move(batch),
+                               ReadChunkReceiver<void>{std::move(state)});
   }
 };
 
@@ -219,12 +238,84 @@ struct DriverReadIntoNewInitiateOp {
     // Initiate the read on the driver.
     auto source_driver = std::move(state->source_driver);
     auto source_transaction = std::move(state->source_transaction);
-    source_driver->Read(
+    auto batch = std::exchange(state->batch, no_batch);
+    source_driver->ReadInBatch(
         std::move(source_transaction), std::move(source_transform),
+        std::move(batch),
         ReadChunkReceiver<SharedOffsetArray<void>>{std::move(state)});
   }
 };
 
+/// Local state for the asynchronous operation initiated by `DriverPrefetch`.
+///
+/// `DriverPrefetch` is similar to `DriverRead`, except that the `ReadChunk`
+/// objects are discarded as they are received.  Drivers only send a
+/// `ReadChunk` once the chunk has been read, so no further work is needed.
+struct PrefetchState : public internal::AtomicReferenceCount<PrefetchState> {
+  DriverPtr source_driver;
+  internal::OpenTransactionPtr source_transaction;
+  ReadProgressFunction read_progress_function;
+  Batch batch{no_batch};
+  Promise<void> promise;
+  std::atomic<Index> prefetched_elements{0};
+  Index total_elements;
+
+  void SetError(absl::Status error) {
+    SetDeferredResult(promise, std::move(error));
+  }
+
+  void UpdateProgress(Index num_elements) {
+    if (!read_progress_function) return;
+    read_progress_function(
+        ReadProgress{total_elements, prefetched_elements += num_elements});
+  }
+};
+
+/// FlowReceiver used by `DriverPrefetch`.
+struct PrefetchChunkReceiver {
+  IntrusivePtr<PrefetchState> state;
+  FutureCallbackRegistration cancel_registration;
+  void set_starting(AnyCancelReceiver cancel) {
+    cancel_registration =
+        state->promise.ExecuteWhenNotNeeded(std::move(cancel));
+  }
+  void set_stopping() { cancel_registration(); }
+  void set_done() {}
+  void set_error(absl::Status error) { state->SetError(std::move(error)); }
+  void set_value(ReadChunk chunk, IndexTransform<> cell_transform) {
+    state->UpdateProgress(cell_transform.domain().num_elements());
+  }
+};
+
+/// Callback used by `DriverPrefetch` to initiate the read once the source
+/// transform bounds have been resolved.
+struct DriverPrefetchInitiateOp {
+  IntrusivePtr<PrefetchState> state;
+  void operator()(Promise<void> promise,
+                  ReadyFuture<IndexTransform<>> source_transform_future) {
+    IndexTransform<> source_transform =
+        std::move(source_transform_future.value());
+
+    if (!IsFinite(source_transform.domain())) {
+      promise.SetResult(absl::InvalidArgumentError(
+          tensorstore::StrCat("Prefetch requires a finite domain, got ",
+                              source_transform.domain())));
+      return;
+    }
+
+    state->promise = std::move(promise);
+    state->total_elements = source_transform.domain().num_elements();
+
+    // Initiate the read on the driver.
+    auto source_driver = std::move(state->source_driver);
+    auto source_transaction = std::move(state->source_transaction);
+    auto batch = std::exchange(state->batch, no_batch);
+    source_driver->ReadInBatch(std::move(source_transaction),
+                               std::move(source_transform), std::move(batch),
+                               PrefetchChunkReceiver{std::move(state)});
+  }
+};
+
 }  // namespace
 
 Future<void> DriverRead(Executor executor, DriverHandle source,
@@ -246,6 +337,7 @@ Future<void> DriverRead(Executor executor, DriverHandle source,
   state->target = std::move(target);
   state->alignment_options = options.alignment_options;
   state->read_progress_function = std::move(options.progress_function);
+  state->batch = std::move(options.batch);
   auto pair = PromiseFuturePair<void>::Make(MakeResult());
 
   // Resolve the bounds for `source.transform`.
@@ -267,7 +359,10 @@ Future<void> DriverRead(DriverHandle source,
   return internal::DriverRead(
       std::move(executor), std::move(source), std::move(target), /*options=*/
       {/*.progress_function=*/std::move(options.progress_function),
-       /*.alignment_options=*/options.alignment_options});
+       /*.alignment_options=*/options.alignment_options,
+       /*.data_type_conversion_flags=*/
+       DataTypeConversionFlags::kSafeAndImplicit,
+       /*.batch=*/std::move(options.batch)});
 }
 
 Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
@@ -287,6 +382,7 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
       state->source_transaction,
       internal::AcquireOpenTransactionPtrOrError(source.transaction));
   state->read_progress_function = std::move(options.progress_function);
+  state->batch = std::move(options.batch);
   auto pair = PromiseFuturePair<SharedOffsetArray<void>>::Make();
 
   // Resolve the bounds for `source.transform`.
@@ -310,13 +406,369 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
   return internal::DriverReadIntoNewArray(
       std::move(executor), std::move(source), dtype, options.layout_order,
       /*options=*/
-      {/*.progress_function=*/std::move(options.progress_function)});
+      {/*.progress_function=*/std::move(options.progress_function),
+       /*.batch=*/std::move(options.batch)});
+}
+
+Future<void> DriverPrefetch(DriverHandle source, PrefetchOptions options) {
+  TENSORSTORE_RETURN_IF_ERROR(
+      internal::ValidateSupportsRead(source.driver.read_write_mode()));
+  IntrusivePtr<PrefetchState> state(new PrefetchState);
+  state->source_driver = std::move(source.driver);
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      state->source_transaction,
+      internal::AcquireOpenTransactionPtrOrError(source.transaction));
+  state->read_progress_function = std::move(options.progress_function);
+  state->batch = std::move(options.batch);
+  auto pair = PromiseFuturePair<void>::Make(MakeResult());
+
+  // Resolve the bounds for `source.transform`.
+  auto transform_future = state->source_driver->ResolveBounds(
+      state->source_transaction, std::move(source.transform),
+      fix_resizable_bounds);
+
+  // Initiate the read once the bounds have been resolved.
+  LinkValue(DriverPrefetchInitiateOp{std::move(state)},
+            std::move(pair.promise), std::move(transform_future));
+  return std::move(pair.future);
+}
+
+class ReadChunksStream::Impl
+    : public internal::AtomicReferenceCount<ReadChunksStream::Impl> {
+ public:
+  using Item = ReadChunksItem;
+  using NextResult = std::optional<Item>;
+
+  Executor executor;
+  DriverPtr driver;
+  internal::OpenTransactionPtr transaction;
+  DataType dtype;
+  ReadChunksOptions options;
+
+  /// Computes the grid cells once the bounds of `transform` have been
+  /// resolved, and issues the initial reads.
+  void Initialize(Result<IndexTransform<>> transform_result) {
+    absl::Status status = [&]() -> absl::Status {
+      TENSORSTORE_RETURN_IF_ERROR(transform_result);
+      auto& transform = *transform_result;
+      if (!IsFinite(transform.domain().box())) {
+        return absl::InvalidArgumentError(tensorstore::StrCat(
+            "Read requires a finite domain, got ", transform.domain()));
+      }
+      TENSORSTORE_ASSIGN_OR_RETURN(auto chunk_layout,
+                                   driver->GetChunkLayout(transform));
+      const DimensionIndex rank = transform.input_rank();
+      Box<> chunk_template(rank);
+      TENSORSTORE_RETURN_IF_ERROR(
+          chunk_layout.GetReadChunkTemplate(chunk_template));
+      absl::MutexLock lock(&mutex_);
+      transform_ = std::move(transform);
+      const auto domain = transform_.domain().box();
+      chunk_template_ = std::move(chunk_template);
+      cell_min_.resize(rank);
+      cell_max_.resize(rank);
+      next_cell_.resize(rank);
+      cells_remaining_ = !domain.is_empty();
+      for (DimensionIndex i = 0; i < rank; ++i) {
+        const auto interval = chunk_template_[i];
+        if (!IsFinite(interval)) {
+          // Unconstrained dimension: a single cell spans the full domain.
+          chunk_template_[i] = domain[i];
+          cell_min_[i] = 0;
+          cell_max_[i] = 1;
+        } else {
+          cell_min_[i] = FloorOfRatio(domain[i].inclusive_min() -
+                                          interval.inclusive_min(),
+                                      interval.size());
+          cell_max_[i] = FloorOfRatio(domain[i].inclusive_max() -
+                                          interval.inclusive_min(),
+                                      interval.size()) +
+                         1;
+        }
+        next_cell_[i] = cell_min_[i];
+      }
+      initialized_ = true;
+      return absl::OkStatus();
+    }();
+    if (!status.ok()) {
+      Fail(std::move(status));
+      return;
+    }
+    ProcessAndUnlock(AcquireLock());
+  }
+
+  Future<NextResult> Next() {
+    auto lock = AcquireLock();
+    if (!ready_.empty()) {
+      auto item = std::move(ready_.front());
+      ready_.pop_front();
+      ProcessAndUnlock(std::move(lock));
+      return NextResult(std::move(item));
+    }
+    if (!error_.ok()) return error_;
+    if (initialized_ && !cells_remaining_ && in_flight_ == 0) {
+      return NextResult();
+    }
+    auto [promise, future] = PromiseFuturePair<NextResult>::Make();
+    waiters_.push_back(std::move(promise));
+    return std::move(future);
+  }
+
+ private:
+  using Lock = UniqueWriterLock<absl::Mutex>;
+
+  Lock AcquireLock() { return Lock(mutex_); }
+
+  /// Returns the transform for the next grid cell, and advances to the next
+  /// cell.
+  ///
+  /// \pre `cells_remaining_`
+  IndexTransform<> NextCellTransform() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    const DimensionIndex rank = transform_.input_rank();
+    const auto domain = transform_.domain();
+    IndexDomainBuilder builder(rank);
+    builder.labels(domain.labels());
+    for (DimensionIndex i = 0; i < rank; ++i) {
+      const auto interval = chunk_template_[i];
+      const Index origin =
+          interval.inclusive_min() + next_cell_[i] * interval.size();
+      builder.bounds()[i] =
+          Intersect(IndexInterval::UncheckedSized(origin, interval.size()),
+                    domain[i].interval());
+    }
+    cells_remaining_ = AdvanceIndices(rank, next_cell_.data(), cell_min_.data(),
+                                      cell_max_.data());
+    return IdentityTransform(builder.Finalize().value());
+  }
+
+  /// Issues reads for as many cells as permitted by
+  /// `options.max_in_flight_chunks`, delivers completed chunks to waiting
+  /// `Next` calls, and releases `lock`.
+  void ProcessAndUnlock(Lock lock) {
+    std::vector<IndexTransform<>> cells_to_read;
+    std::vector<std::pair<Promise<NextResult>, Result<NextResult>>> to_resolve;
+    while (!waiters_.empty() && !ready_.empty()) {
+      to_resolve.emplace_back(std::move(waiters_.front()),
+                              std::move(ready_.front()));
+      waiters_.pop_front();
+      ready_.pop_front();
+    }
+    if (error_.ok() && initialized_) {
+      while (cells_remaining_ &&
+             in_flight_ + ready_.size() <
+                 std::max(options.max_in_flight_chunks, size_t(1))) {
+        ++in_flight_;
+        cells_to_read.push_back(NextCellTransform());
+      }
+      if (!cells_remaining_ && in_flight_ == 0) {
+        for (auto& promise : waiters_) {
+          to_resolve.emplace_back(std::move(promise), NextResult());
+        }
+        waiters_.clear();
+      }
+    }
+    auto transform = transform_;
+    lock.unlock();
+    for (auto& [promise, result] : to_resolve) {
+      promise.SetResult(std::move(result));
+    }
+    for (auto& cell_transform : cells_to_read) {
+      auto read_transform = ComposeTransforms(transform, cell_transform);
+      if (!read_transform.ok()) {
+        OnCellRead({}, read_transform.status());
+        continue;
+      }
+      auto future = DriverReadIntoNewArray(
+          executor,
+          DriverHandle{driver, *std::move(read_transform),
+                       internal::TransactionState::ToTransaction(transaction)},
+          dtype, options.layout_order, /*options=*/{});
+      future.Force();
+      std::move(future).ExecuteWhenReady(
+          [self = IntrusivePtr<Impl>(this),
+           cell_transform = std::move(cell_transform)](
+              ReadyFuture<SharedOffsetArray<void>> future) mutable {
+            self->OnCellRead(std::move(cell_transform),
+                             std::move(future.result()));
+          });
+    }
+  }
+
+  void OnCellRead(IndexTransform<> cell_transform,
+                  Result<SharedOffsetArray<void>> result) {
+    if (!result.ok()) {
+      Fail(std::move(result).status());
+      return;
+    }
+    auto lock = AcquireLock();
+    --in_flight_;
+    if (error_.ok()) {
+      ready_.push_back(Item{std::move(cell_transform), *std::move(result)});
+    }
+    ProcessAndUnlock(std::move(lock));
+  }
+
+  void Fail(absl::Status error) {
+    std::deque<Promise<NextResult>> waiters;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (error_.ok()) error_ = error;
+      ready_.clear();
+      waiters = std::move(waiters_);
+      waiters_.clear();
+    }
+    for (auto& promise : waiters) {
+      promise.SetResult(error);
+    }
+  }
+
+  absl::Mutex mutex_;
+  bool initialized_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status error_ ABSL_GUARDED_BY(mutex_);
+  IndexTransform<> transform_ ABSL_GUARDED_BY(mutex_);
+  // Grid cell with index vector `0`.  Unconstrained dimensions are set to the
+  // full domain.
+  Box<> chunk_template_ ABSL_GUARDED_BY(mutex_);
+  // Range of grid cell indices that intersect the domain.
+  std::vector<Index> cell_min_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Index> cell_max_ ABSL_GUARDED_BY(mutex_);
+  // Next grid cell to read, valid if `cells_remaining_`.
+  std::vector<Index> next_cell_ ABSL_GUARDED_BY(mutex_);
+  bool cells_remaining_ ABSL_GUARDED_BY(mutex_) = false;
+  // Number of grid cells being read.
+  size_t in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Chunks that have been read but not yet returned by `Next`.
+  std::deque<Item> ready_ ABSL_GUARDED_BY(mutex_);
+  // Pending `Next` calls.
+  std::deque<Promise<NextResult>> waiters_ ABSL_GUARDED_BY(mutex_);
+};
+
+void intrusive_ptr_increment(ReadChunksStream::Impl* impl) {
+  intrusive_ptr_increment(
+      static_cast<internal::AtomicReferenceCount<ReadChunksStream::Impl>*>(
+          impl));
+}
+
+void intrusive_ptr_decrement(ReadChunksStream::Impl* impl) {
+  intrusive_ptr_decrement(
+      static_cast<internal::AtomicReferenceCount<ReadChunksStream::Impl>*>(
+          impl));
+}
+
+Future<std::optional<ReadChunksItem>> ReadChunksStream::Next() const {
+  assert(impl_);
+  return impl_->Next();
+}
+
+Result<ReadChunksStream> DriverReadChunks(DriverHandle source,
+                                          ReadChunksOptions options) {
+  TENSORSTORE_RETURN_IF_ERROR(
+      internal::ValidateSupportsRead(source.driver.read_write_mode()));
+  IntrusivePtr<ReadChunksStream::Impl> impl(new ReadChunksStream::Impl);
+  impl->executor = source.driver->data_copy_executor();
+  impl->dtype = source.driver->dtype();
+  impl->options = options;
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      impl->transaction,
+      internal::AcquireOpenTransactionPtrOrError(source.transaction));
+  impl->driver = std::move(source.driver);
+  auto transform_future = impl->driver->ResolveBounds(
+      impl->transaction, std::move(source.transform), fix_resizable_bounds);
+  transform_future.Force();
+  std::move(transform_future)
+      .ExecuteWhenReady(
+          [impl](ReadyFuture<IndexTransform<>> future) {
+            impl->Initialize(std::move(future.result()));
+          });
+  return ReadChunksStream(std::move(impl));
+}
+
+namespace {
+
+/// Delivers the chunks of a `ReadChunksStream` to a flow receiver, one at a
+/// time.
+struct ReadChunksSenderState
+    : public internal::AtomicReferenceCount<ReadChunksSenderState> {
+  ReadChunksStream stream;
+  AnyFlowReceiver<absl::Status, IndexTransform<>, SharedOffsetArray<void>>
+      receiver;
+  std::atomic<bool> cancelled{false};
+
+  /// Requests chunks until one is not immediately available.
+  void Pull() {
+    while (true) {
+      auto future = stream.Next();
+      if (!future.ready()) {
+        std::move(future).ExecuteWhenReady(
+            [self = IntrusivePtr<ReadChunksSenderState>(this)](
+                ReadyFuture<std::optional<ReadChunksItem>> future) {
+              if (self->Deliver(future.result())) self->Pull();
+            });
+        return;
+      }
+      if (!Deliver(future.result())) return;
+    }
+  }
+
+  /// Delivers the result of `ReadChunksStream::Next`.  Returns `true` if more
+  /// chunks should be requested.
+  bool Deliver(Result<std::optional<ReadChunksItem>>& result) {
+    if (!result.ok()) {
+      execution::set_error(receiver, std::move(result).status());
+    } else if (*result && !cancelled.load(std::memory_order_relaxed)) {
+      auto& item = **result;
+      execution::set_value(receiver, std::move(item.transform),
+                           std::move(item.array));
+      return true;
+    } else {
+      execution::set_done(receiver);
+    }
+    execution::set_stopping(receiver);
+    return false;
+  }
+};
+
+struct ReadChunksSender {
+  DriverHandle source;
+  ReadChunksOptions options;
+  void submit(AnyFlowReceiver<absl::Status, IndexTransform<>,
+                              SharedOffsetArray<void>>
+                  receiver) {
+    IntrusivePtr<ReadChunksSenderState> state(new ReadChunksSenderState);
+    state->receiver = std::move(receiver);
+    execution::set_starting(state->receiver, [state = state.get()] {
+      state->cancelled.store(true, std::memory_order_relaxed);
+    });
+    auto stream = DriverReadChunks(std::move(source), options);
+    if (!stream.ok()) {
+      execution::set_error(state->receiver, std::move(stream).status());
+      execution::set_stopping(state->receiver);
+      return;
+    }
+    state->stream = *std::move(stream);
+    state->Pull();
+  }
+};
+
+}  // namespace
+
+AnyFlowSender<absl::Status, IndexTransform<>, SharedOffsetArray<void>>
+DriverReadChunksSender(DriverHandle source, ReadChunksOptions options) {
+  return ReadChunksSender{std::move(source), options};
 }
 
 absl::Status CopyReadChunk(
     ReadChunk::Impl& chunk, IndexTransform<> chunk_transform,
     const DataTypeConversionLookupResult& chunk_conversion,
     TransformedArray<void, dynamic_rank, view> target) {
+  if (!!(chunk_conversion.flags & DataTypeConversionFlags::kIdentity)) {
+    // Allow the chunk to decode its data directly into `target`.
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        bool read_directly,
+        chunk(ReadChunk::ReadInto{}, chunk_transform, target));
+    if (read_directly) return absl::OkStatus();
+  }
+
   DefaultNDIterableArena arena;
 
   TENSORSTORE_ASSIGN_OR_RETURN(
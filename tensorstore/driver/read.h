@@ -15,8 +15,11 @@
 #ifndef TENSORSTORE_DRIVER_READ_H_
 #define TENSORSTORE_DRIVER_READ_H_
 
+#include <optional>
+
 #include "absl/status/status.h"
 #include "tensorstore/array.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/container_kind.h"
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
@@ -25,9 +28,11 @@
 #include "tensorstore/index_space/alignment.h"
 #include "tensorstore/index_space/index_transform.h"
 #include "tensorstore/index_space/transformed_array.h"
+#include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/progress.h"
 #include "tensorstore/rank.h"
 #include "tensorstore/read_write_options.h"
+#include "tensorstore/util/execution/any_sender.h"
 #include "tensorstore/util/executor.h"
 #include "tensorstore/util/future.h"
 
@@ -48,6 +53,9 @@ struct DriverReadOptions {
 
   DataTypeConversionFlags data_type_conversion_flags =
       DataTypeConversionFlags::kSafeAndImplicit;
+
+  /// Optional batch with which to issue the read.
+  Batch batch{no_batch};
 };
 
 struct DriverReadIntoNewOptions {
@@ -58,6 +66,9 @@ struct DriverReadIntoNewOptions {
   /// monotonically increasing.  The `total_elements` value does not change
   /// after the first call.
   ReadProgressFunction progress_function;
+
+  /// Optional batch with which to issue the read.
+  Batch batch{no_batch};
 };
 
 /// Copies data from a TensorStore driver to an array.
@@ -105,6 +116,84 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
 Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
     DriverHandle source, ReadIntoNewArrayOptions options);
 
+/// Reads the chunks of a TensorStore driver that intersect the domain of
+/// `source`, without copying the data.
+///
+/// For drivers backed by a `ChunkCache`, this populates the cache entries for
+/// the chunks.  The entries remain cached subject to the limits of the cache
+/// pool.
+///
+/// \param source Source TensorStore.
+/// \param options Specifies optional progress function.
+/// \returns A future that becomes ready when all chunks have been read or an
+///     error occurs.
+/// \error `absl::StatusCode::kInvalidArgument` if the resolved domain of
+///     `source.transform` is not finite.
+Future<void> DriverPrefetch(DriverHandle source, PrefetchOptions options);
+
+/// Decoded chunk produced by `ReadChunksStream`.
+struct ReadChunksItem {
+  /// Identity transform over the domain of the chunk, with the dimension
+  /// labels of the source.
+  IndexTransform<> transform;
+
+  /// Newly-allocated array containing the data of the chunk.  The domain of
+  /// the array is equal to `transform.domain()`.
+  SharedOffsetArray<void> array;
+};
+
+/// Pull-based stream of the chunks of a TensorStore driver.
+///
+/// The domain of the source is partitioned according to the read chunk grid
+/// (as determined by `Driver::GetChunkLayout`), and each grid cell is read into
+/// a newly-allocated array.  Cells are returned in the order in which their
+/// reads complete.  At most `ReadChunksOptions::max_in_flight_chunks` cells are
+/// being read or buffered at any time; a new read is issued only as buffered
+/// cells are consumed by `Next`.
+class ReadChunksStream {
+ public:
+  class Impl;
+
+  /// Constructs a null stream.
+  ReadChunksStream() = default;
+
+  explicit ReadChunksStream(IntrusivePtr<Impl> impl) : impl_(std::move(impl)) {}
+
+  /// Returns the next chunk, or `std::nullopt` once all chunks have been
+  /// returned.
+  ///
+  /// Once an error has been returned, all subsequent calls return the same
+  /// error.
+  ///
+  /// \dchecks `valid()`
+  Future<std::optional<ReadChunksItem>> Next() const;
+
+  bool valid() const { return static_cast<bool>(impl_); }
+
+  friend void intrusive_ptr_increment(Impl* impl);
+  friend void intrusive_ptr_decrement(Impl* impl);
+
+ private:
+  IntrusivePtr<Impl> impl_;
+};
+
+/// Returns a stream of the chunks of `source`.
+///
+/// \error `absl::StatusCode::kInvalidArgument` if `source` does not support
+///     reading.
+/// \error `absl::StatusCode::kInvalidArgument` if the resolved domain of
+///     `source.transform` is not finite (returned by `Next`).
+Result<ReadChunksStream> DriverReadChunks(DriverHandle source,
+                                          ReadChunksOptions options);
+
+/// Returns a flow sender that streams the chunks of `source` as
+/// `(transform, array)` pairs, as described by `ReadChunksStream`.
+///
+/// `set_value` is never called concurrently, and the next chunk is not
+/// requested until the previous call to `set_value` returns.
+AnyFlowSender<absl::Status, IndexTransform<>, SharedOffsetArray<void>>
+DriverReadChunksSender(DriverHandle source, ReadChunksOptions options);
+
 /// Copies `chunk` transformed by `chunk_transform` to `target`.
 absl::Status CopyReadChunk(
     ReadChunk::Impl& chunk, IndexTransform<> chunk_transform,
@@ -16,6 +16,7 @@
 
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "absl/status/status.h"
@@ -121,6 +122,7 @@ struct WriteState : public internal::AtomicReferenceCount<WriteState> {
   DriverPtr target_driver;
   internal::OpenTransactionPtr target_transaction;
   DomainAlignmentOptions alignment_options;
+  bool can_reference_source_data_until_commit;
   Promise<void> copy_promise;
   Promise<void> commit_promise;
   IntrusivePtr<CommitState> commit_state{new CommitState};
@@ -146,11 +148,6 @@ struct WriteChunkOp {
 
     DefaultNDIterableArena arena;
 
-    TENSORSTORE_ASSIGN_OR_RETURN(
-        auto source_iterable,
-        GetTransformedArrayNDIterable(std::move(source), arena),
-        state->SetError(_));
-
     LockCollection lock_collection;
 
     absl::Status copy_status;
@@ -161,26 +158,45 @@ struct WriteChunkOp {
                                    LockChunks(lock_collection, chunk.impl),
                                    state->SetError(_));
 
-      TENSORSTORE_ASSIGN_OR_RETURN(
-          auto target_iterable,
-          chunk.impl(WriteChunk::BeginWrite{}, chunk.transform, arena),
-          state->SetError(_));
+      // If permitted, let the chunk reference `source` directly rather than
+      // copying it.
+      std::optional<WriteChunk::EndWriteResult> end_write_result;
+      if (state->can_reference_source_data_until_commit &&
+          !!(state->data_type_conversion.flags &
+             DataTypeConversionFlags::kIdentity)) {
+        end_write_result =
+            chunk.impl(WriteChunk::WriteArray{}, chunk.transform, source);
+      }
+
+      if (end_write_result) {
+        copy_status = std::move(end_write_result->copy_status);
+      } else {
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            auto source_iterable,
+            GetTransformedArrayNDIterable(std::move(source), arena),
+            state->SetError(_));
+
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            auto target_iterable,
+            chunk.impl(WriteChunk::BeginWrite{}, chunk.transform, arena),
+            state->SetError(_));
 
-      source_iterable = GetConvertedInputNDIterable(
-          std::move(source_iterable), target_iterable->dtype(),
-          state->data_type_conversion);
+        source_iterable = GetConvertedInputNDIterable(
+            std::move(source_iterable), target_iterable->dtype(),
+            state->data_type_conversion);
 
-      NDIterableCopier copier(*source_iterable, *target_iterable,
-                              chunk.transform.input_shape(), arena);
-      copy_status = copier.Copy();
-      auto end_write_result =
-          chunk.impl(WriteChunk::EndWrite{}, chunk.transform,
-                     copier.layout_info().layout_view(),
-                     copier.stepper().position(), arena);
-      commit_future = std::move(end_write_result.commit_future);
-      if (copy_status.ok()) {
-        copy_status = std::move(end_write_result.copy_status);
+        NDIterableCopier copier(*source_iterable, *target_iterable,
+                                chunk.transform.input_shape(), arena);
+        copy_status = copier.Copy();
+        end_write_result =
+            chunk.impl(WriteChunk::EndWrite{}, chunk.transform,
+                       copier.layout_info().layout_view(),
+                       copier.stepper().position(), arena);
+        if (copy_status.ok()) {
+          copy_status = std::move(end_write_result->copy_status);
+        }
       }
+      commit_future = std::move(end_write_result->commit_future);
     }
 
     if (copy_status.ok()) {
@@ -274,6 +290,8 @@ WriteFutures DriverWrite(Executor executor,
       internal::AcquireOpenTransactionPtrOrError(target.transaction));
   state->source = std::move(source);
   state->alignment_options = options.alignment_options;
+  state->can_reference_source_data_until_commit =
+      options.can_reference_source_data_until_commit;
   state->commit_state->write_progress_function =
       std::move(options.progress_function);
   auto copy_pair = PromiseFuturePair<void>::Make(MakeResult());
@@ -305,7 +323,11 @@ WriteFutures DriverWrite(TransformedSharedArray<const void> source,
       std::move(executor), std::move(source), std::move(target),
       /*options=*/
       {/*.progress_function=*/std::move(options.progress_function),
-       /*.alignment_options=*/options.alignment_options});
+       /*.alignment_options=*/options.alignment_options,
+       /*.data_type_conversion_flags=*/
+       DataTypeConversionFlags::kSafeAndImplicit,
+       /*.can_reference_source_data_until_commit=*/
+       options.can_reference_source_data_until_commit});
 }
 
 }  // namespace internal
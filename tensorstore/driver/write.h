@@ -40,6 +40,10 @@ struct DriverWriteOptions {
 
   DataTypeConversionFlags data_type_conversion_flags =
       DataTypeConversionFlags::kSafeAndImplicit;
+
+  /// Indicates that `source` is not modified until the write is committed.
+  /// See `WriteOptions::can_reference_source_data_until_commit`.
+  bool can_reference_source_data_until_commit = false;
 };
 
 /// Copies data from an array to a TensorStore driver.
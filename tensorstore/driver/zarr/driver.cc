@@ -373,6 +373,29 @@ class DataCache : public internal_kvs_backed_chunk_driver::DataCache {
         *static_cast<const ZarrMetadata*>(metadata), std::move(data));
   }
 
+  absl::Status DecodeChunkInto(const void* metadata,
+                               span<const Index> chunk_indices,
+                               absl::Cord data, std::size_t component_index,
+                               ArrayView<void> output) override {
+    return internal_zarr::DecodeChunkInto(
+        *static_cast<const ZarrMetadata*>(metadata), std::move(data),
+        component_index, output);
+  }
+
+  std::optional<internal_kvs_backed_chunk_driver::RawChunkEncoding>
+  GetRawChunkEncoding(const void* metadata, span<const Index> chunk_indices,
+                      std::size_t component_index) override {
+    const auto& zarr_metadata = *static_cast<const ZarrMetadata*>(metadata);
+    if (zarr_metadata.compressor) return std::nullopt;
+    const auto& field = zarr_metadata.dtype.fields[component_index];
+    internal_kvs_backed_chunk_driver::RawChunkEncoding encoding;
+    encoding.byte_offset = field.byte_offset;
+    encoding.layout = zarr_metadata.chunk_layout.fields[component_index]
+                          .encoded_chunk_layout;
+    encoding.endianness = field.endian;
+    return encoding;
+  }
+
   Result<absl::Cord> EncodeChunk(
       const void* metadata, span<const Index> chunk_indices,
       span<const SharedArrayView<const void>> component_arrays) override {
@@ -17,6 +17,11 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/base/optimization.h"
+#include "absl/strings/match.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/context.h"
 #include "tensorstore/driver/driver_testutil.h"
 #include "tensorstore/index_space/dim_expression.h"
@@ -29,12 +34,19 @@
 #include "tensorstore/internal/json_binding/gtest.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/internal/metrics/registry.h"
 #include "tensorstore/internal/parse_json_matches.h"
+#include "tensorstore/internal/test_util.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/key_range.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/memory/memory_key_value_store.h"
 #include "tensorstore/kvstore/mock_kvstore.h"
 #include "tensorstore/kvstore/test_util.h"
 #include "tensorstore/open.h"
+#include "tensorstore/tensorstore.h"
+#include "tensorstore/util/execution/execution.h"
+#include "tensorstore/util/execution/sender_testutil.h"
 #include "tensorstore/util/status_testutil.h"
 #include "tensorstore/util/str_cat.h"
 
@@ -485,6 +497,82 @@ TEST_F(MockKeyValueStoreTest, CreateMetadataError) {
                             "create error"));
 }
 
+/// Flow receiver that logs the domains of the chunks received from
+/// `tensorstore::ReadChunks`.
+struct ReadChunksLoggingReceiver {
+  std::vector<std::string>* log;
+  void set_starting(tensorstore::AnyCancelReceiver cancel) {
+    log->push_back("set_starting");
+  }
+  void set_value(tensorstore::IndexTransform<> transform,
+                 tensorstore::SharedOffsetArray<void> array) {
+    EXPECT_EQ(transform.domain().box(), array.domain());
+    log->push_back(StrCat("set_value: ", transform.domain().box()));
+  }
+  void set_done() { log->push_back("set_done"); }
+  void set_error(absl::Status error) {
+    log->push_back(StrCat("set_error: ", error));
+  }
+  void set_stopping() { log->push_back("set_stopping"); }
+};
+
+// Tests that `ReadChunks` streams the chunks with a bounded number of reads in
+// flight.
+TEST_F(MockKeyValueStoreTest, ReadChunks) {
+  auto store_future = tensorstore::Open(
+      {
+          {"driver", "zarr"},
+          {"kvstore",
+           {
+               {"driver", "mock_key_value_store"},
+               {"path", "prefix/"},
+           }},
+          {"metadata",
+           {
+               {"compressor", nullptr},
+               {"dtype", "<i2"},
+               {"shape", {100, 100}},
+               {"chunks", {3, 2}},
+           }},
+          {"create", true},
+      },
+      context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto region,
+      store | tensorstore::Dims(0, 1).SizedInterval({1, 0}, {2, 6}));
+  std::vector<std::string> log;
+  absl::Notification notification;
+  tensorstore::ReadChunksOptions options;
+  options.max_in_flight_chunks = 2;
+  tensorstore::execution::submit(
+      tensorstore::ReadChunks(region, options),
+      tensorstore::CompletionNotifyingReceiver{
+          &notification, ReadChunksLoggingReceiver{&log}});
+  auto req1 = mock_key_value_store->read_requests.pop();
+  auto req2 = mock_key_value_store->read_requests.pop();
+  // The third chunk is not read until one of the first two is delivered.
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+  req1(memory_store);
+  auto req3 = mock_key_value_store->read_requests.pop();
+  req2(memory_store);
+  req3(memory_store);
+  notification.WaitForNotification();
+  ASSERT_EQ(6, log.size());
+  EXPECT_EQ("set_starting", log[0]);
+  EXPECT_THAT(std::vector<std::string>(log.begin() + 1, log.begin() + 4),
+              ::testing::UnorderedElementsAre(
+                  "set_value: {origin={1, 0}, shape={2, 2}}",
+                  "set_value: {origin={1, 2}, shape={2, 2}}",
+                  "set_value: {origin={1, 4}, shape={2, 2}}"));
+  EXPECT_EQ("set_done", log[4]);
+  EXPECT_EQ("set_stopping", log[5]);
+}
+
 // Tests concurrently creating a zarr array with `create=true` and `open=false`,
 // using independent cache pools.
 TEST_F(MockKeyValueStoreTest,
@@ -527,6 +615,311 @@ TEST_F(MockKeyValueStoreTest,
                                           "Error writing \"prefix/.zarray\"")));
 }
 
+// Tests that `Prefetch` reads the chunks into the cache.
+TEST_F(MockKeyValueStoreTest, Prefetch) {
+  auto store_future = tensorstore::Open(
+      {
+          {"driver", "zarr"},
+          {"kvstore",
+           {
+               {"driver", "mock_key_value_store"},
+               {"path", "prefix/"},
+           }},
+          {"metadata",
+           {
+               {"compressor", nullptr},
+               {"dtype", "<i2"},
+               {"shape", {100, 100}},
+               {"chunks", {3, 2}},
+           }},
+          {"context", {{"cache_pool", {{"total_bytes_limit", 1000000}}}}},
+          {"recheck_cached_data", false},
+          {"create", true},
+      },
+      context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  auto prefetch_future = tensorstore::Prefetch(
+      store | tensorstore::Dims(0, 1).SizedInterval({0, 0}, {3, 4}));
+  prefetch_future.Force();
+  EXPECT_EQ(2, mock_key_value_store->read_requests.size());
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->read_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK(prefetch_future.result());
+
+  // Reading the prefetched region does not require any further requests.
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({0, 0}, {3, 4}));
+  TENSORSTORE_ASSERT_OK(read_future.result());
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
+class PartialChunkReadTest : public MockKeyValueStoreTest {
+ protected:
+  // Opens an uncompressed array with 10x10 chunks of little endian `int16`.
+  tensorstore::TensorStore<> OpenStore() {
+    auto store_future = tensorstore::Open(
+        {
+            {"driver", "zarr"},
+            {"kvstore",
+             {
+                 {"driver", "mock_key_value_store"},
+                 {"path", "prefix/"},
+             }},
+            {"metadata",
+             {
+                 {"compressor", nullptr},
+                 {"dtype", "<i2"},
+                 {"shape", {100, 100}},
+                 {"chunks", {10, 10}},
+             }},
+            {"create", true},
+        },
+        context);
+    store_future.Force();
+    mock_key_value_store->read_requests.pop()(memory_store);
+    mock_key_value_store->write_requests.pop()(memory_store);
+    return store_future.value();
+  }
+
+  // Writes chunk `0.0` directly, with element `(i, j)` equal to
+  // `10 * i + j + value_offset`, truncated to `num_elements` elements.
+  void WriteChunk(int value_offset, int num_elements = 100) {
+    std::string chunk(2 * num_elements, '\0');
+    for (int i = 0; i < num_elements; ++i) {
+      chunk[2 * i] = static_cast<char>(i + value_offset);
+    }
+    TENSORSTORE_ASSERT_OK(tensorstore::kvstore::Write(memory_store,
+                                                      "prefix/0.0",
+                                                      absl::Cord(chunk))
+                              .result());
+  }
+
+  // Pops the next read request, which must be for `key` and `byte_range`,
+  // and satisfies it from `memory_store`.
+  void HandleReadRequest(std::string_view key,
+                         tensorstore::OptionalByteRangeRequest byte_range) {
+    auto read_request = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ(key, read_request.key);
+    EXPECT_EQ(byte_range, read_request.options.byte_range);
+    read_request(memory_store);
+  }
+};
+
+// Tests that reading a small region of an uncompressed chunk reads only the
+// corresponding byte range.
+TEST_F(PartialChunkReadTest, SingleRange) {
+  auto store = OpenStore();
+  WriteChunk(0);
+
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({2, 3}, {2, 2}));
+  read_future.Force();
+  HandleReadRequest("prefix/0.0", {46, 70});
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<std::int16_t>(
+                  {2, 3}, {{23, 24}, {33, 34}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+
+  // A missing chunk is filled with the fill value.
+  read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({12, 3}, {1, 2}));
+  read_future.Force();
+  {
+    auto read_request = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/1.0", read_request.key);
+    EXPECT_EQ(tensorstore::OptionalByteRangeRequest(46, 50),
+              read_request.options.byte_range);
+    read_request(memory_store);
+  }
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<std::int16_t>(
+                  {12, 3}, {{0, 0}})));
+}
+
+// Tests that a region whose single enclosing byte range would exceed half of
+// the chunk is read as one byte range per position along the outer dimension.
+TEST_F(PartialChunkReadTest, SplitAlongOuterDimension) {
+  auto store = OpenStore();
+  WriteChunk(0);
+
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({1, 3}, {6, 2}));
+  read_future.Force();
+  for (int i = 1; i <= 6; ++i) {
+    HandleReadRequest("prefix/0.0", {20 * i + 6, 20 * i + 10});
+  }
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<std::int16_t>(
+                  {1, 3}, {{13, 14},
+                           {23, 24},
+                           {33, 34},
+                           {43, 44},
+                           {53, 54},
+                           {63, 64}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+
+  // Regions that would require more than 8 byte ranges read the entire chunk.
+  read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({0, 3}, {9, 1}));
+  read_future.Force();
+  HandleReadRequest("prefix/0.0", {});
+  TENSORSTORE_EXPECT_OK(read_future.result());
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
+// Tests that byte range reads with inconsistent generations, due to a
+// concurrent modification, fall back to reading the entire chunk.
+TEST_F(PartialChunkReadTest, GenerationMismatch) {
+  auto store = OpenStore();
+  WriteChunk(0);
+
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({1, 3}, {6, 2}));
+  read_future.Force();
+  HandleReadRequest("prefix/0.0", {26, 30});
+  WriteChunk(100);
+  for (int i = 2; i <= 6; ++i) {
+    HandleReadRequest("prefix/0.0", {20 * i + 6, 20 * i + 10});
+  }
+  HandleReadRequest("prefix/0.0", {});
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<std::int16_t>(
+                  {1, 3}, {{113, 114},
+                           {123, 124},
+                           {133, 134},
+                           {143, 144},
+                           {153, 154},
+                           {163, 164}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
+// Tests that a byte range beyond the end of the stored chunk falls back to
+// reading the entire chunk, which then fails to decode.
+TEST_F(PartialChunkReadTest, OutOfRange) {
+  auto store = OpenStore();
+  WriteChunk(0, /*num_elements=*/20);
+
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({2, 3}, {2, 2}));
+  read_future.Force();
+  HandleReadRequest("prefix/0.0", {46, 70});
+  HandleReadRequest("prefix/0.0", {});
+  EXPECT_THAT(read_future.result(),
+              MatchesStatus(absl::StatusCode::kFailedPrecondition,
+                            ".*Uncompressed chunk is 40 bytes, but should be "
+                            "200 bytes.*"));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
+// Tests that a batched partial chunk read through a batching kvstore completes
+// once the caller releases the batch, and that no batch handle is retained
+// until the byte range reads complete.
+TEST(ZarrDriverTest, BatchedPartialChunkRead) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  ::nlohmann::json json_spec{
+      {"driver", "zarr"},
+      {"kvstore", {{"driver", "file"}, {"path", tempdir.path() + "/"}}},
+      {"metadata",
+       {
+           {"compressor", nullptr},
+           {"dtype", "<i2"},
+           {"shape", {10, 10}},
+           {"chunks", {10, 10}},
+       }},
+  };
+  // The default context has no cache pool, which enables partial reads.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(json_spec, tensorstore::OpenMode::create,
+                        tensorstore::ReadWriteMode::read_write)
+          .result());
+  auto data = tensorstore::AllocateArray<std::int16_t>({10, 10});
+  for (Index i = 0; i < 10; ++i) {
+    for (Index j = 0; j < 10; ++j) data(i, j) = 10 * i + j;
+  }
+  TENSORSTORE_ASSERT_OK(tensorstore::Write(data, store).result());
+
+  auto batch = tensorstore::Batch::New();
+  tensorstore::ReadIntoNewArrayOptions options;
+  options.batch = batch;
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({1, 3}, {6, 2}),
+      std::move(options));
+  batch.Release();
+  ASSERT_TRUE(read_future.WaitFor(absl::Seconds(10)))
+      << "Batched partial chunk read did not complete";
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<std::int16_t>(
+                  {1, 3}, {{13, 14},
+                           {23, 24},
+                           {33, 34},
+                           {43, 44},
+                           {53, 54},
+                           {63, 64}})));
+}
+
+// Tests that `chunk_existence_index` avoids reading chunks that are not present
+// in the listing of the kvstore.
+TEST_F(MockKeyValueStoreTest, ChunkExistenceIndex) {
+  auto store_future = tensorstore::Open(
+      {
+          {"driver", "zarr"},
+          {"kvstore",
+           {
+               {"driver", "mock_key_value_store"},
+               {"path", "prefix/"},
+           }},
+          {"metadata",
+           {
+               {"compressor", nullptr},
+               {"dtype", "<i2"},
+               {"shape", {100, 100}},
+               {"chunks", {3, 2}},
+           }},
+          {"chunk_existence_index", true},
+          {"create", true},
+      },
+      context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  // Write chunk `0.0` directly, with every element equal to 1.
+  TENSORSTORE_ASSERT_OK(
+      tensorstore::kvstore::Write(memory_store, "prefix/0.0",
+                                  absl::Cord(std::string("\1\0\1\0\1\0"
+                                                         "\1\0\1\0\1\0",
+                                                         12)))
+          .result());
+
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({0, 0}, {3, 4}));
+  read_future.Force();
+  {
+    auto list_request = mock_key_value_store->list_requests.pop();
+    EXPECT_EQ(tensorstore::KeyRange::Prefix("prefix/"),
+              list_request.options.range);
+    tensorstore::execution::submit(memory_store->List(list_request.options),
+                                   std::move(list_request.receiver));
+  }
+  // Only the existing chunk is read; chunk `0.1` is filled without a request.
+  {
+    auto read_request = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.0", read_request.key);
+    read_request(memory_store);
+  }
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeArray<std::int16_t>(
+                  {{1, 1, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+  EXPECT_TRUE(mock_key_value_store->list_requests.empty());
+}
+
 // Tests concurrently creating a zarr array with `create=true` and `open=false`,
 // using a shared cache pool.
 TEST(ZarrDriverTest, CreateMetadataConcurrentErrorSharedCachePool) {
@@ -1016,6 +1409,222 @@ TEST(ZarrDriverTest, CreateLittleEndianUnaligned) {
       }));
 }
 
+// Returns the number of chunks that `ChunkCache` has decoded directly into the
+// target array of a read.
+int64_t GetDirectDecodeCount() {
+  auto metric = tensorstore::internal_metrics::GetMetricRegistry().Collect(
+      "/tensorstore/cache/chunk_cache/direct_decodes");
+  if (!metric || metric->counters.empty()) return 0;
+  return std::get<int64_t>(metric->counters[0].value);
+}
+
+// Tests reads that decode chunks directly into the target array, which happens
+// when the cache pool does not retain decoded chunks.
+TEST(ZarrDriverTest, ReadWithoutCachePool) {
+  for (std::string order : {"C", "F"}) {
+    for (std::string dtype : {"<u2", ">u2"}) {
+      for (const ::nlohmann::json& compressor :
+           {::nlohmann::json(nullptr), ::nlohmann::json{{"id", "zlib"}}}) {
+        SCOPED_TRACE(StrCat("order=", order, ", dtype=", dtype,
+                            ", compressor=", compressor.dump()));
+        TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+            auto context,
+            Context::FromJson({{"cache_pool", {{"total_bytes_limit", 0}}}}));
+        ::nlohmann::json json_spec{
+            {"driver", "zarr"},
+            {"kvstore", {{"driver", "memory"}}},
+            {"metadata",
+             {
+                 {"order", order},
+                 {"compressor", compressor},
+                 {"dtype", dtype},
+                 {"shape", {4, 6}},
+                 {"chunks", {2, 3}},
+             }},
+        };
+        TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+            auto store, tensorstore::Open(json_spec, context,
+                                          tensorstore::OpenMode::create,
+                                          tensorstore::ReadWriteMode::read_write)
+                            .result());
+        // Only the chunks in the first row of the grid are written.
+        TENSORSTORE_ASSERT_OK(tensorstore::Write(
+            tensorstore::MakeArray<std::uint16_t>(
+                {{1, 2, 3, 4, 5, 6}, {7, 8, 9, 10, 11, 12}}),
+            store | tensorstore::Dims(0).SizedInterval(0, 2)));
+        // Each of the two chunks that are present maps onto an entire cell and
+        // is decoded directly into the target array.  Missing chunks are filled
+        // from the fill value instead.
+        int64_t direct_decodes = GetDirectDecodeCount();
+        EXPECT_THAT(tensorstore::Read(store).result(),
+                    ::testing::Optional(tensorstore::MakeArray<std::uint16_t>(
+                        {{1, 2, 3, 4, 5, 6},
+                         {7, 8, 9, 10, 11, 12},
+                         {0, 0, 0, 0, 0, 0},
+                         {0, 0, 0, 0, 0, 0}})));
+        EXPECT_EQ(direct_decodes + 2, GetDirectDecodeCount());
+        // A region that covers only part of a cell is decoded into a temporary
+        // array and copied.
+        direct_decodes = GetDirectDecodeCount();
+        EXPECT_THAT(
+            tensorstore::Read<tensorstore::zero_origin>(
+                store | tensorstore::Dims(0, 1).SizedInterval({1, 2}, {2, 3}))
+                .result(),
+            ::testing::Optional(tensorstore::MakeArray<std::uint16_t>(
+                {{8, 9, 10}, {0, 0, 0}})));
+        EXPECT_EQ(direct_decodes, GetDirectDecodeCount());
+        // Entire cells are decoded directly into a transposed target array.
+        EXPECT_THAT(
+            tensorstore::Read<tensorstore::zero_origin>(
+                store | tensorstore::Dims(0, 1).Transpose({1, 0}) |
+                tensorstore::Dims(1).SizedInterval(0, 2))
+                .result(),
+            ::testing::Optional(tensorstore::MakeArray<std::uint16_t>(
+                {{1, 7}, {2, 8}, {3, 9}, {4, 10}, {5, 11}, {6, 12}})));
+        EXPECT_EQ(direct_decodes + 2, GetDirectDecodeCount());
+      }
+    }
+  }
+}
+
+// Returns the number of writeback values staged by transactions.
+int64_t GetStagedWritebackCount() {
+  auto metric = tensorstore::internal_metrics::GetMetricRegistry().Collect(
+      "/tensorstore/kvstore/transaction_staged_writebacks");
+  if (!metric || metric->counters.empty()) return 0;
+  return std::get<int64_t>(metric->counters[0].value);
+}
+
+// Returns the number of files staged by the file kvstore under `directory`.
+size_t CountStagedFiles(const std::string& directory) {
+  size_t count = 0;
+  TENSORSTORE_CHECK_OK(tensorstore::internal::EnumeratePaths(
+      directory, [&](const std::string& name, bool is_dir) {
+        if (absl::StrContains(name, ".__stage.")) ++count;
+        return absl::OkStatus();
+      }));
+  return count;
+}
+
+// Tests that chunks fully overwritten within a transaction with a
+// `staging_limit_bytes` are staged to the file kvstore before commit.
+TEST(ZarrDriverTest, TransactionStaging) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  ::nlohmann::json json_spec{
+      {"driver", "zarr"},
+      {"kvstore", {{"driver", "file"}, {"path", tempdir.path() + "/"}}},
+      {"metadata",
+       {
+           {"compressor", nullptr},
+           {"dtype", "<u2"},
+           {"shape", {4, 6}},
+           {"chunks", {2, 3}},
+       }},
+  };
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(json_spec, tensorstore::OpenMode::create,
+                        tensorstore::ReadWriteMode::read_write)
+          .result());
+  auto data = tensorstore::MakeArray<std::uint16_t>(
+      {{1, 2, 3, 4, 5, 6}, {7, 8, 9, 10, 11, 12}});
+  auto fill = tensorstore::MakeArray<std::uint16_t>(
+      {{0, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 0}});
+  for (bool commit : {false, true}) {
+    SCOPED_TRACE(StrCat("commit=", commit));
+    tensorstore::Transaction transaction(tensorstore::isolated,
+                                         /*staging_limit_bytes=*/1);
+    const int64_t initial_staged = GetStagedWritebackCount();
+
+    // Both chunks in the first row of the grid are completely overwritten,
+    // which exceeds the staging limit.
+    TENSORSTORE_ASSERT_OK(tensorstore::Write(
+        data, store | transaction | tensorstore::Dims(0).SizedInterval(0, 2)));
+
+    // Staging completes asynchronously.
+    for (absl::Time deadline = absl::Now() + absl::Seconds(10);
+         GetStagedWritebackCount() < initial_staged + 2;) {
+      ASSERT_LT(absl::Now(), deadline) << "Timed out waiting for staging";
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+    EXPECT_EQ(2, CountStagedFiles(tempdir.path()));
+
+    // Staged writes are visible only within the transaction.
+    EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                    store | transaction |
+                    tensorstore::Dims(0).SizedInterval(0, 2))
+                    .result(),
+                ::testing::Optional(data));
+    EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                    store | tensorstore::Dims(0).SizedInterval(0, 2))
+                    .result(),
+                ::testing::Optional(fill));
+
+    if (commit) {
+      TENSORSTORE_ASSERT_OK(transaction.CommitAsync().result());
+      EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                      store | tensorstore::Dims(0).SizedInterval(0, 2))
+                      .result(),
+                  ::testing::Optional(data));
+    } else {
+      // Aborting the transaction completes once the staged writes have been
+      // removed.
+      transaction.Abort();
+      EXPECT_THAT(transaction.future().result(),
+                  MatchesStatus(absl::StatusCode::kCancelled));
+    }
+    EXPECT_EQ(0, CountStagedFiles(tempdir.path()));
+  }
+}
+
+TEST(ZarrDriverTest, WriteReferencingSourceData) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto context,
+      Context::FromJson({{"cache_pool", {{"total_bytes_limit", 1000000}}}}));
+  ::nlohmann::json json_spec{
+      {"driver", "zarr"},
+      {"kvstore", {{"driver", "memory"}}},
+      {"metadata",
+       {
+           {"compressor", nullptr},
+           {"dtype", "<u2"},
+           {"shape", {4, 6}},
+           {"chunks", {2, 3}},
+       }},
+  };
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(json_spec, context, tensorstore::OpenMode::create,
+                        tensorstore::ReadWriteMode::read_write)
+          .result());
+  // Chunk `0.0` is overwritten entirely, and may reference `source`.  Chunk
+  // `0.1` is only partially overwritten, and must be copied.
+  auto source = tensorstore::MakeArray<std::uint16_t>(
+      {{1, 2, 3, 4, 5}, {6, 7, 8, 9, 10}});
+  tensorstore::WriteOptions options;
+  options.can_reference_source_data_until_commit = true;
+  TENSORSTORE_ASSERT_OK(
+      tensorstore::Write(source,
+                         store | tensorstore::Dims(0, 1).SizedInterval(
+                                     {0, 0}, {2, 5}),
+                         std::move(options))
+          .commit_future.result());
+  // Once committed, the source array may be modified without affecting the
+  // stored or cached data.
+  tensorstore::InitializeArray(source);
+  EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                  store | tensorstore::Dims(0).SizedInterval(0, 2))
+                  .result(),
+              ::testing::Optional(tensorstore::MakeArray<std::uint16_t>(
+                  {{1, 2, 3, 4, 5, 0}, {6, 7, 8, 9, 10, 0}})));
+  EXPECT_THAT(
+      GetMap(kvstore::Open({{"driver", "memory"}}, context).value()).value(),
+      ::testing::UnorderedElementsAre(
+          Pair(".zarray", ::testing::_),
+          Pair("0.0", Bytes({1, 0, 2, 0, 3, 0, 6, 0, 7, 0, 8, 0})),
+          Pair("0.1", Bytes({4, 0, 5, 0, 0, 0, 9, 0, 10, 0, 0, 0}))));
+}
+
 TEST(ZarrDriverTest, CreateComplexWithFillValue) {
   ::nlohmann::json json_spec{
       {"driver", "zarr"},
@@ -360,6 +360,15 @@ TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(ZarrPartialMetadata,
 // Two decoding strategies:  raw decoder and custom decoder.  Initially we will
 // only support raw decoder.
 
+namespace {
+absl::Status GetUncompressedChunkSizeError(const ZarrMetadata& metadata,
+                                           size_t size) {
+  return absl::InvalidArgumentError(tensorstore::StrCat(
+      "Uncompressed chunk is ", size, " bytes, but should be ",
+      metadata.chunk_layout.bytes_per_chunk, " bytes"));
+}
+}  // namespace
+
 Result<absl::InlinedVector<SharedArrayView<const void>, 1>> DecodeChunk(
     const ZarrMetadata& metadata, absl::Cord buffer) {
   const size_t num_fields = metadata.dtype.fields.size();
@@ -372,9 +381,7 @@ Result<absl::InlinedVector<SharedArrayView<const void>, 1>> DecodeChunk(
   }
   if (static_cast<Index>(buffer.size()) !=
       metadata.chunk_layout.bytes_per_chunk) {
-    return absl::InvalidArgumentError(tensorstore::StrCat(
-        "Uncompressed chunk is ", buffer.size(), " bytes, but should be ",
-        metadata.chunk_layout.bytes_per_chunk, " bytes"));
+    return GetUncompressedChunkSizeError(metadata, buffer.size());
   }
   absl::InlinedVector<SharedArrayView<const void>, 1> field_arrays(num_fields);
 
@@ -408,6 +415,52 @@ Result<absl::InlinedVector<SharedArrayView<const void>, 1>> DecodeChunk(
   return field_arrays;
 }
 
+absl::Status DecodeChunkInto(const ZarrMetadata& metadata, absl::Cord buffer,
+                             size_t field_i, ArrayView<void> output) {
+  const auto& field = metadata.dtype.fields[field_i];
+  const auto& field_layout = metadata.chunk_layout.fields[field_i];
+  const size_t bytes_per_chunk = metadata.chunk_layout.bytes_per_chunk;
+  std::unique_ptr<riegeli::Reader> reader =
+      std::make_unique<riegeli::CordReader<absl::Cord>>(std::move(buffer));
+  if (metadata.compressor) {
+    reader = metadata.compressor->GetReader(
+        std::move(reader), metadata.dtype.bytes_per_outer_element);
+  }
+  if (metadata.dtype.fields.size() == 1 && field.endian == endian::native &&
+      internal::RangesEqual(
+          output.byte_strides(),
+          field_layout.encoded_chunk_layout.byte_strides())) {
+    // `output` has the same layout as the encoded representation, so the
+    // uncompressed chunk can be read into it directly.
+    size_t length_read = 0;
+    if (!reader->Read(bytes_per_chunk, static_cast<char*>(output.data()),
+                      &length_read)) {
+      if (!reader->ok()) return reader->status();
+      return GetUncompressedChunkSizeError(metadata, length_read);
+    }
+    absl::Cord remaining;
+    TENSORSTORE_RETURN_IF_ERROR(riegeli::ReadAll(std::move(reader), remaining));
+    if (!remaining.empty()) {
+      return GetUncompressedChunkSizeError(metadata,
+                                           bytes_per_chunk + remaining.size());
+    }
+    return absl::OkStatus();
+  }
+  absl::Cord decoded;
+  TENSORSTORE_RETURN_IF_ERROR(riegeli::ReadAll(std::move(reader), decoded));
+  if (decoded.size() != bytes_per_chunk) {
+    return GetUncompressedChunkSizeError(metadata, decoded.size());
+  }
+  auto flat_buffer = decoded.Flatten();
+  ArrayView<const void> source_array{
+      ElementPointer<const void>(
+          static_cast<const void*>(flat_buffer.data() + field.byte_offset),
+          field.dtype),
+      field_layout.encoded_chunk_layout};
+  internal::DecodeArray(source_array, field.endian, output);
+  return absl::OkStatus();
+}
+
 namespace {
 bool SingleArrayMatchesEncodedRepresentation(
     const ZarrMetadata& metadata,
@@ -243,6 +243,22 @@ Result<absl::Cord> EncodeChunk(
 Result<absl::InlinedVector<SharedArrayView<const void>, 1>> DecodeChunk(
     const ZarrMetadata& metadata, absl::Cord buffer);
 
+/// Decodes a single field of an encoded zarr chunk directly into `output`.
+///
+/// If `output` has the same layout as the encoded representation, the
+/// uncompressed chunk is read directly into `output` without an intermediate
+/// buffer.
+///
+/// \param metadata Metadata associated with the chunk.
+/// \param buffer The buffer to decode.
+/// \param field_i The field index.
+/// \param output The output array, with a shape equal to
+///     `metadata.chunk_layout.fields[field_i].decoded_chunk_layout.shape()`.
+/// \error `absl::StatusCode::kInvalidArgument` if `buffer` is not a valid
+///     encoded zarr chunk according to `metadata`.
+absl::Status DecodeChunkInto(const ZarrMetadata& metadata, absl::Cord buffer,
+                             size_t field_i, ArrayView<void> output);
+
 /// Returns `true` if `a` and `b` are compatible, meaning stored data created
 /// with `a` can be read using `b`.
 bool IsMetadataCompatible(const ZarrMetadata& a, const ZarrMetadata& b);
@@ -0,0 +1,105 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Defines the "blosc" codec for zarr v3.  Linking in this library
+/// automatically registers it.
+
+#include "tensorstore/internal/compression/blosc_compressor.h"
+
+#include <stddef.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <blosc.h>
+#include "tensorstore/driver/zarr3/codec_registry.h"
+#include "tensorstore/internal/json_binding/enum.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/json_binding/std_optional.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+namespace {
+
+class BloscCodec : public CompressorCodec<internal::BloscCompressor> {
+ public:
+  BloscCodec() {
+    compressor.codec = BLOSC_LZ4_COMPNAME;
+    compressor.level = 5;
+    compressor.shuffle = BLOSC_SHUFFLE;
+    compressor.blocksize = 0;
+  }
+
+  Result<absl::Cord> Encode(const absl::Cord& input,
+                            size_t element_bytes) const override {
+    return CompressorCodec::Encode(input, typesize.value_or(element_bytes));
+  }
+
+  /// Overrides the element size used for shuffling.
+  std::optional<size_t> typesize;
+};
+
+struct Registration {
+  Registration() {
+    namespace jb = tensorstore::internal_json_binding;
+    using internal::BloscCompressor;
+    RegisterCodec<BloscCodec>(
+        "blosc",
+        CodecConfiguration(
+            jb::Member(
+                "cname",
+                jb::Projection(
+                    [](auto& codec) -> auto& { return codec.compressor.codec; },
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](std::string* v) { *v = BLOSC_LZ4_COMPNAME; },
+                        BloscCompressor::CodecBinder()))),
+            jb::Member(
+                "clevel",
+                jb::Projection(
+                    [](auto& codec) -> auto& { return codec.compressor.level; },
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](int* v) { *v = 5; }, jb::Integer<int>(0, 9)))),
+            jb::Member(
+                "shuffle",
+                jb::Projection(
+                    [](auto& codec) -> auto& {
+                      return codec.compressor.shuffle;
+                    },
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](int* v) { *v = BLOSC_SHUFFLE; },
+                        jb::Enum<int, std::string_view>({
+                            {BLOSC_NOSHUFFLE, "noshuffle"},
+                            {BLOSC_SHUFFLE, "shuffle"},
+                            {BLOSC_BITSHUFFLE, "bitshuffle"},
+                        })))),
+            jb::Member("typesize",
+                       jb::Projection(&BloscCodec::typesize,
+                                      jb::Optional(jb::Integer<size_t>(1)))),
+            jb::Member(
+                "blocksize",
+                jb::Projection(
+                    [](auto& codec) -> auto& {
+                      return codec.compressor.blocksize;
+                    },
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](size_t* v) { *v = 0; },
+                        jb::Integer<size_t>())))));
+  }
+} registration;
+
+}  // namespace
+}  // namespace internal_zarr3
+}  // namespace tensorstore
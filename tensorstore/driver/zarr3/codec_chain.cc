@@ -0,0 +1,454 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/driver/zarr3/codec_chain.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/internal/endian.h"
+#include "absl/crc/crc32c.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/array.h"
+#include "tensorstore/chunk_layout.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/driver/zarr3/codec_registry.h"
+#include "tensorstore/internal/data_type_endian_conversion.h"
+#include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/internal/json/value_as.h"
+#include "tensorstore/internal/json_binding/dimension_indexed.h"
+#include "tensorstore/internal/json_binding/enum.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/json_binding/std_array.h"
+#include "tensorstore/internal/json_binding/std_optional.h"
+#include "tensorstore/internal/json_registry.h"
+#include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+namespace jb = tensorstore::internal_json_binding;
+
+ZarrBytesToBytesCodec::~ZarrBytesToBytesCodec() = default;
+
+ZarrBytesToBytesCodec::Registry& GetCodecRegistry() {
+  static internal::NoDestructor<ZarrBytesToBytesCodec::Registry> registry;
+  return *registry;
+}
+
+namespace {
+
+/// Appends a little-endian CRC32C checksum of the input.
+///
+/// This codec is defined here rather than in a separate library since it is
+/// part of the default shard index codecs.
+class Crc32cCodec : public ZarrBytesToBytesCodec {
+ public:
+  static uint32_t ComputeChecksum(const absl::Cord& input) {
+    absl::crc32c_t crc{0};
+    for (std::string_view chunk : input.Chunks()) {
+      crc = absl::ExtendCrc32c(crc, chunk);
+    }
+    return static_cast<uint32_t>(crc);
+  }
+
+  Result<absl::Cord> Encode(const absl::Cord& input,
+                            size_t element_bytes) const override {
+    char checksum[4];
+    absl::little_endian::Store32(checksum, ComputeChecksum(input));
+    absl::Cord output = input;
+    output.Append(std::string_view(checksum, sizeof(checksum)));
+    return output;
+  }
+
+  Result<absl::Cord> Decode(const absl::Cord& input,
+                            size_t element_bytes) const override {
+    if (input.size() < 4) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Expected at least 4 bytes for crc32c checksum, but received ",
+          input.size(), " bytes"));
+    }
+    absl::Cord output = input.Subcord(0, input.size() - 4);
+    const std::string checksum(input.Subcord(input.size() - 4, 4));
+    const uint32_t expected = absl::little_endian::Load32(checksum.data());
+    const uint32_t actual = ComputeChecksum(output);
+    if (expected != actual) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "crc32c checksum mismatch: expected ", expected, " but computed ",
+          actual));
+    }
+    return output;
+  }
+
+  std::optional<int64_t> fixed_size_overhead() const override { return 4; }
+};
+
+struct Crc32cRegistration {
+  Crc32cRegistration() {
+    // "crc32c" has no parameters; the `"configuration"` member is accepted but
+    // never written.
+    RegisterCodec<Crc32cCodec>("crc32c", jb::LoadSave(CodecConfiguration()));
+  }
+} crc32c_registration;
+
+constexpr auto EndianBinder = jb::Enum<endian, std::string_view>({
+    {endian::little, "little"},
+    {endian::big, "big"},
+});
+
+constexpr auto TransposeCodecBinder = jb::Object(
+    jb::Member("name", jb::Constant([] { return "transpose"; })),
+    jb::Member("configuration",
+               jb::Object(jb::Member(
+                   "order",
+                   jb::Projection(&TransposeCodec::order,
+                                  jb::Array(jb::Integer<DimensionIndex>(
+                                      0, kMaxRank - 1)))))));
+
+constexpr auto BytesCodecBinder = jb::Object(
+    jb::Member("name", jb::Constant([] { return "bytes"; })),
+    CodecConfiguration(jb::Member(
+        "endian",
+        jb::Projection(&BytesCodec::endianness, jb::Optional(EndianBinder)))));
+
+ZarrCodecChain GetDefaultIndexCodecs() {
+  ZarrCodecChain chain;
+  chain.bytes.endianness = endian::little;
+  chain.bytes_to_bytes.push_back(
+      internal::MakeIntrusivePtr<Crc32cCodec>());
+  return chain;
+}
+
+constexpr auto ShardingIndexedCodecBinder = jb::Object(
+    jb::Member("name", jb::Constant([] { return "sharding_indexed"; })),
+    jb::Member(
+        "configuration",
+        jb::Object(
+            jb::Member("chunk_shape",
+                       jb::Projection(&ShardingIndexedCodec::chunk_shape,
+                                      jb::ChunkShapeVector(nullptr))),
+            jb::Member("codecs", jb::Projection(&ShardingIndexedCodec::codecs)),
+            jb::Member("index_codecs",
+                       jb::Projection(
+                           &ShardingIndexedCodec::index_codecs,
+                           jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                               [](auto* obj) {
+                                 *obj = GetDefaultIndexCodecs();
+                               }))),
+            jb::Member(
+                "index_location",
+                jb::Projection(
+                    &ShardingIndexedCodec::index_location,
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](auto* obj) { *obj = ShardIndexLocation::kEnd; },
+                        jb::Enum<ShardIndexLocation, std::string_view>({
+                            {ShardIndexLocation::kStart, "start"},
+                            {ShardIndexLocation::kEnd, "end"},
+                        })))))));
+
+auto BytesToBytesCodecBinder() {
+  return jb::Object(GetCodecRegistry().MemberBinder("name"));
+}
+
+absl::Status LoadCodec(const JsonSerializationOptions& options,
+                       ZarrCodecChain& chain, bool& has_array_to_bytes,
+                       ::nlohmann::json& j) {
+  auto* j_obj = j.get_ptr<::nlohmann::json::object_t*>();
+  if (!j_obj) return internal_json::ExpectedError(j, "object");
+  auto name_it = j_obj->find("name");
+  if (name_it == j_obj->end() || !name_it->second.is_string()) {
+    return absl::InvalidArgumentError(
+        tensorstore::StrCat("Expected codec with string \"name\" member, but "
+                            "received: ",
+                            j.dump()));
+  }
+  const std::string name = name_it->second.get<std::string>();
+  const auto require_array_to_bytes = [&]() -> absl::Status {
+    if (has_array_to_bytes) {
+      return absl::InvalidArgumentError(
+          tensorstore::StrCat(QuoteString(name),
+                              " codec must precede the array -> bytes codec"));
+    }
+    return absl::OkStatus();
+  };
+  const std::true_type is_loading;
+  if (name == "transpose") {
+    TENSORSTORE_RETURN_IF_ERROR(require_array_to_bytes());
+    TransposeCodec codec;
+    TENSORSTORE_RETURN_IF_ERROR(
+        TransposeCodecBinder(is_loading, options, &codec, &j));
+    chain.array_to_array.push_back(std::move(codec));
+    return absl::OkStatus();
+  }
+  if (name == "bytes") {
+    TENSORSTORE_RETURN_IF_ERROR(require_array_to_bytes());
+    TENSORSTORE_RETURN_IF_ERROR(
+        BytesCodecBinder(is_loading, options, &chain.bytes, &j));
+    has_array_to_bytes = true;
+    return absl::OkStatus();
+  }
+  if (name == "sharding_indexed") {
+    TENSORSTORE_RETURN_IF_ERROR(require_array_to_bytes());
+    auto sharding = std::make_shared<ShardingIndexedCodec>();
+    TENSORSTORE_RETURN_IF_ERROR(
+        ShardingIndexedCodecBinder(is_loading, options, sharding.get(), &j));
+    chain.sharding = std::move(sharding);
+    has_array_to_bytes = true;
+    return absl::OkStatus();
+  }
+  ZarrBytesToBytesCodec::Ptr codec;
+  TENSORSTORE_RETURN_IF_ERROR(
+      BytesToBytesCodecBinder()(is_loading, options, &codec, &j));
+  if (!has_array_to_bytes) {
+    return absl::InvalidArgumentError(
+        tensorstore::StrCat(QuoteString(name),
+                            " codec must follow the array -> bytes codec"));
+  }
+  chain.bytes_to_bytes.push_back(std::move(codec));
+  return absl::OkStatus();
+}
+
+absl::Status LoadCodecChain(const JsonSerializationOptions& options,
+                            ZarrCodecChain& chain, ::nlohmann::json& j) {
+  auto* j_array = j.get_ptr<::nlohmann::json::array_t*>();
+  if (!j_array) return internal_json::ExpectedError(j, "array");
+  bool has_array_to_bytes = false;
+  for (size_t i = 0; i < j_array->size(); ++i) {
+    TENSORSTORE_RETURN_IF_ERROR(
+        LoadCodec(options, chain, has_array_to_bytes, (*j_array)[i]),
+        MaybeAnnotateStatus(
+            _, tensorstore::StrCat("Error parsing codec at position ", i)));
+  }
+  if (!has_array_to_bytes) {
+    return absl::InvalidArgumentError(
+        "Expected an array -> bytes codec (\"bytes\" or \"sharding_indexed\")");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SaveCodecChain(const JsonSerializationOptions& options,
+                            const ZarrCodecChain& chain, ::nlohmann::json& j) {
+  const std::false_type is_loading;
+  ::nlohmann::json::array_t codecs;
+  for (const auto& codec : chain.array_to_array) {
+    TENSORSTORE_RETURN_IF_ERROR(TransposeCodecBinder(
+        is_loading, options, &codec, &codecs.emplace_back()));
+  }
+  if (chain.sharding) {
+    TENSORSTORE_RETURN_IF_ERROR(ShardingIndexedCodecBinder(
+        is_loading, options, chain.sharding.get(), &codecs.emplace_back()));
+  } else {
+    TENSORSTORE_RETURN_IF_ERROR(BytesCodecBinder(
+        is_loading, options, &chain.bytes, &codecs.emplace_back()));
+  }
+  for (const auto& codec : chain.bytes_to_bytes) {
+    TENSORSTORE_RETURN_IF_ERROR(BytesToBytesCodecBinder()(
+        is_loading, options, &codec, &codecs.emplace_back()));
+  }
+  j = std::move(codecs);
+  return absl::OkStatus();
+}
+
+absl::Status ValidateIndexCodecs(const ZarrCodecChain& chain) {
+  if (!chain.array_to_array.empty() || chain.sharding) {
+    return absl::InvalidArgumentError(
+        "Only \"bytes\" and bytes -> bytes codecs are supported");
+  }
+  if (!chain.bytes.endianness) {
+    return absl::InvalidArgumentError("\"bytes\" codec requires \"endian\"");
+  }
+  for (const auto& codec : chain.bytes_to_bytes) {
+    if (!codec->fixed_size_overhead()) {
+      return absl::InvalidArgumentError(
+          "Only codecs with a fixed encoded size, such as \"crc32c\", are "
+          "supported");
+    }
+  }
+  return absl::OkStatus();
+}
+
+/// Computes the permutation `order` such that encoded dimension `i`
+/// corresponds to dimension `order[i]` of the decoded array.
+void GetEncodedDimensionOrder(const ZarrCodecChain& chain,
+                              span<DimensionIndex> order) {
+  std::iota(order.begin(), order.end(), DimensionIndex(0));
+  DimensionIndex temp[kMaxRank];
+  for (const auto& codec : chain.array_to_array) {
+    assert(codec.order.size() == order.size());
+    for (DimensionIndex i = 0; i < order.size(); ++i) {
+      temp[i] = order[codec.order[i]];
+    }
+    std::copy_n(temp, order.size(), order.begin());
+  }
+}
+
+}  // namespace
+
+TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(
+    ZarrCodecChain,
+    [](auto is_loading, const auto& options, auto* obj,
+       ::nlohmann::json* j) -> absl::Status {
+      if constexpr (is_loading) {
+        *obj = ZarrCodecChain{};
+        return LoadCodecChain(options, *obj, *j);
+      } else {
+        return SaveCodecChain(options, *obj, *j);
+      }
+    })
+
+absl::Status ValidateCodecChain(const ZarrCodecChain& chain, DataType dtype,
+                                span<const Index> chunk_shape) {
+  const DimensionIndex rank = chunk_shape.size();
+  for (const auto& codec : chain.array_to_array) {
+    if (static_cast<DimensionIndex>(codec.order.size()) != rank ||
+        !IsValidPermutation(codec.order)) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "\"transpose\" order ", span(codec.order),
+          " is not a permutation of the ", rank, " dimensions"));
+    }
+  }
+  if (!chain.sharding) {
+    if (dtype.size() > 1 && !chain.bytes.endianness) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "\"bytes\" codec requires \"endian\" for data type ", dtype));
+    }
+    return absl::OkStatus();
+  }
+  const auto& sharding = *chain.sharding;
+  if (!chain.array_to_array.empty()) {
+    return absl::InvalidArgumentError(
+        "\"transpose\" codec preceding \"sharding_indexed\" is not supported");
+  }
+  if (!chain.bytes_to_bytes.empty()) {
+    return absl::InvalidArgumentError(
+        "bytes -> bytes codecs following \"sharding_indexed\" are not "
+        "supported, since they prevent reading individual inner chunks");
+  }
+  if (static_cast<DimensionIndex>(sharding.chunk_shape.size()) != rank) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "\"sharding_indexed\" chunk_shape ", span(sharding.chunk_shape),
+        " does not match rank of ", rank));
+  }
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    if (chunk_shape[i] % sharding.chunk_shape[i] != 0) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Shard shape ", chunk_shape,
+          " is not a multiple of the inner chunk shape ",
+          span(sharding.chunk_shape)));
+    }
+  }
+  if (sharding.codecs.sharding) {
+    return absl::InvalidArgumentError(
+        "Nested \"sharding_indexed\" codecs are not supported");
+  }
+  TENSORSTORE_RETURN_IF_ERROR(
+      ValidateCodecChain(sharding.codecs, dtype, sharding.chunk_shape),
+      MaybeAnnotateStatus(_, "Invalid \"sharding_indexed\" codecs"));
+  TENSORSTORE_RETURN_IF_ERROR(
+      ValidateIndexCodecs(sharding.index_codecs),
+      MaybeAnnotateStatus(_, "Invalid \"sharding_indexed\" index_codecs"));
+  return absl::OkStatus();
+}
+
+StridedLayout<> GetDecodedChunkLayout(const ZarrCodecChain& chain,
+                                      DataType dtype, span<const Index> shape) {
+  assert(!chain.sharding);
+  const DimensionIndex rank = shape.size();
+  DimensionIndex order[kMaxRank];
+  GetEncodedDimensionOrder(chain, span(order, rank));
+  StridedLayout<> layout;
+  layout.set_rank(rank);
+  std::copy(shape.begin(), shape.end(), layout.shape().begin());
+  Index stride = dtype.size();
+  for (DimensionIndex i = rank - 1; i >= 0; --i) {
+    const DimensionIndex dim = order[i];
+    layout.byte_strides()[dim] = stride;
+    stride *= shape[dim];
+  }
+  return layout;
+}
+
+Result<absl::Cord> EncodeArray(const ZarrCodecChain& chain,
+                               ArrayView<const void> array) {
+  assert(!chain.sharding);
+  const DataType dtype = array.dtype();
+  const auto layout = GetDecodedChunkLayout(chain, dtype, array.shape());
+  internal::FlatCordBuilder buffer(layout.num_elements() * dtype.size());
+  internal::EncodeArray(
+      array,
+      ArrayView<void>({static_cast<void*>(buffer.data()), dtype}, layout),
+      chain.bytes.endianness.value_or(endian::native));
+  return EncodeBytes(chain, std::move(buffer).Build(), dtype.size());
+}
+
+Result<SharedArrayView<const void>> DecodeArray(const ZarrCodecChain& chain,
+                                                DataType dtype,
+                                                StridedLayoutView<> layout,
+                                                absl::Cord encoded) {
+  assert(!chain.sharding);
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto decoded, DecodeBytes(chain, std::move(encoded), dtype.size()));
+  const Index expected_size = layout.num_elements() * dtype.size();
+  if (static_cast<Index>(decoded.size()) != expected_size) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "Expected decoded chunk of ", expected_size, " bytes, but received ",
+        decoded.size(), " bytes"));
+  }
+  const endian source_endian = chain.bytes.endianness.value_or(endian::native);
+  if (auto array = internal::TryViewCordAsArray(decoded, /*offset=*/0, dtype,
+                                                source_endian, layout);
+      array.valid()) {
+    return array;
+  }
+  auto flat = decoded.Flatten();
+  return internal::CopyAndDecodeArray(
+      ArrayView<const void>({static_cast<const void*>(flat.data()), dtype},
+                            layout),
+      source_endian, layout);
+}
+
+Result<absl::Cord> EncodeBytes(const ZarrCodecChain& chain, absl::Cord input,
+                               size_t element_bytes) {
+  for (const auto& codec : chain.bytes_to_bytes) {
+    TENSORSTORE_ASSIGN_OR_RETURN(input, codec->Encode(input, element_bytes));
+  }
+  return input;
+}
+
+Result<absl::Cord> DecodeBytes(const ZarrCodecChain& chain, absl::Cord input,
+                               size_t element_bytes) {
+  for (size_t i = chain.bytes_to_bytes.size(); i--;) {
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        input, chain.bytes_to_bytes[i]->Decode(input, element_bytes));
+  }
+  return input;
+}
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
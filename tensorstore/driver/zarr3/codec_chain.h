@@ -0,0 +1,186 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_DRIVER_ZARR3_CODEC_CHAIN_H_
+#define TENSORSTORE_DRIVER_ZARR3_CODEC_CHAIN_H_
+
+/// \file
+///
+/// Representation of the zarr v3 codec pipeline.
+///
+/// A codec chain consists of zero or more array -> array codecs (only
+/// "transpose" is supported), exactly one array -> bytes codec ("bytes" or
+/// "sharding_indexed"), and zero or more bytes -> bytes codecs (e.g. "gzip",
+/// "blosc", "zstd", "crc32c").
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/array.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/index.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_registry_fwd.h"
+#include "tensorstore/json_serialization_options.h"
+#include "tensorstore/strided_layout.h"
+#include "tensorstore/util/endian.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+/// Abstract base class for codecs that transform a sequence of bytes, such as
+/// compressors and checksums.
+class ZarrBytesToBytesCodec
+    : public internal::AtomicReferenceCount<ZarrBytesToBytesCodec> {
+ public:
+  using Ptr = internal::IntrusivePtr<const ZarrBytesToBytesCodec>;
+
+  virtual ~ZarrBytesToBytesCodec();
+
+  /// Encodes `input`.
+  ///
+  /// \param element_bytes Size of the array elements, as a hint to the codec.
+  virtual Result<absl::Cord> Encode(const absl::Cord& input,
+                                    size_t element_bytes) const = 0;
+
+  /// Decodes `input`.
+  ///
+  /// \param element_bytes Size of the array elements, as a hint to the codec.
+  /// \error `absl::StatusCode::kInvalidArgument` if `input` is invalid.
+  virtual Result<absl::Cord> Decode(const absl::Cord& input,
+                                    size_t element_bytes) const = 0;
+
+  /// Returns the number of bytes added by `Encode`, or `std::nullopt` if the
+  /// encoded size depends on the input.
+  virtual std::optional<int64_t> fixed_size_overhead() const {
+    return std::nullopt;
+  }
+
+  using ToJsonOptions = JsonSerializationOptions;
+  using FromJsonOptions = JsonSerializationOptions;
+
+  using Registry =
+      internal::JsonRegistry<ZarrBytesToBytesCodec, FromJsonOptions,
+                             ToJsonOptions, Ptr>;
+};
+
+/// Parameters of the "transpose" codec.
+struct TransposeCodec {
+  /// Encoded dimension `i` corresponds to dimension `order[i]` of the input.
+  std::vector<DimensionIndex> order;
+};
+
+/// Parameters of the "bytes" codec.
+struct BytesCodec {
+  /// Byte order of the encoded elements.  Must be specified if the data type
+  /// has more than one byte.
+  std::optional<endian> endianness;
+};
+
+struct ShardingIndexedCodec;
+
+/// Parsed representation of the zarr v3 `"codecs"` metadata member.
+struct ZarrCodecChain {
+  std::vector<TransposeCodec> array_to_array;
+
+  /// Array -> bytes codec, used if `sharding` is null.
+  BytesCodec bytes;
+
+  /// Set if the array -> bytes codec is "sharding_indexed".
+  std::shared_ptr<const ShardingIndexedCodec> sharding;
+
+  std::vector<ZarrBytesToBytesCodec::Ptr> bytes_to_bytes;
+
+  TENSORSTORE_DECLARE_JSON_DEFAULT_BINDER(ZarrCodecChain,
+                                          JsonSerializationOptions,
+                                          JsonSerializationOptions)
+};
+
+enum class ShardIndexLocation {
+  kStart,
+  kEnd,
+};
+
+/// Parameters of the "sharding_indexed" codec.
+struct ShardingIndexedCodec {
+  /// Shape of the inner chunks within each shard.
+  std::vector<Index> chunk_shape;
+
+  /// Codecs used to encode each inner chunk.
+  ZarrCodecChain codecs;
+
+  /// Codecs used to encode the shard index.  Must have a fixed encoded size.
+  ZarrCodecChain index_codecs;
+
+  ShardIndexLocation index_location = ShardIndexLocation::kEnd;
+};
+
+/// Returns the registry of bytes -> bytes codecs.
+ZarrBytesToBytesCodec::Registry& GetCodecRegistry();
+
+/// Validates that `chain` may be used to encode chunks of `dtype` with the
+/// specified `chunk_shape`.
+///
+/// Nested sharding, and "transpose" codecs preceding "sharding_indexed", are
+/// not supported.
+absl::Status ValidateCodecChain(const ZarrCodecChain& chain, DataType dtype,
+                                span<const Index> chunk_shape);
+
+/// Returns the layout of a decoded chunk of the specified `shape` in which the
+/// elements are stored in the order in which they are encoded by `chain`.
+///
+/// \pre `chain.sharding == nullptr`
+StridedLayout<> GetDecodedChunkLayout(const ZarrCodecChain& chain,
+                                      DataType dtype, span<const Index> shape);
+
+/// Encodes a chunk.
+///
+/// \pre `chain.sharding == nullptr`
+Result<absl::Cord> EncodeArray(const ZarrCodecChain& chain,
+                               ArrayView<const void> array);
+
+/// Decodes a chunk.
+///
+/// \param layout Layout of the decoded chunk, as returned by
+///     `GetDecodedChunkLayout`.  The returned array references `layout`, which
+///     must remain valid.
+/// \pre `chain.sharding == nullptr`
+/// \error `absl::StatusCode::kInvalidArgument` if `encoded` is invalid.
+Result<SharedArrayView<const void>> DecodeArray(const ZarrCodecChain& chain,
+                                                DataType dtype,
+                                                StridedLayoutView<> layout,
+                                                absl::Cord encoded);
+
+/// Applies the bytes -> bytes codecs of `chain`.
+Result<absl::Cord> EncodeBytes(const ZarrCodecChain& chain, absl::Cord input,
+                               size_t element_bytes);
+
+/// Reverses the bytes -> bytes codecs of `chain`.
+Result<absl::Cord> DecodeBytes(const ZarrCodecChain& chain, absl::Cord input,
+                               size_t element_bytes);
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_DRIVER_ZARR3_CODEC_CHAIN_H_
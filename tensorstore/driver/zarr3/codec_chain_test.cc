@@ -0,0 +1,162 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "tensorstore/driver/zarr3/codec_chain.h"
+
+#include <stdint.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/array.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/internal/json_binding/gtest.h"
+#include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::dtype_v;
+using ::tensorstore::Index;
+using ::tensorstore::MatchesJson;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal_zarr3::DecodeArray;
+using ::tensorstore::internal_zarr3::EncodeArray;
+using ::tensorstore::internal_zarr3::GetDecodedChunkLayout;
+using ::tensorstore::internal_zarr3::ValidateCodecChain;
+using ::tensorstore::internal_zarr3::ZarrCodecChain;
+
+TEST(CodecChainTest, JsonRoundTrip) {
+  tensorstore::TestJsonBinderRoundTripJsonOnly<ZarrCodecChain>({
+      {{{"name", "bytes"}, {"configuration", {{"endian", "little"}}}}},
+      {
+          {{"name", "transpose"}, {"configuration", {{"order", {1, 0}}}}},
+          {{"name", "bytes"}, {"configuration", {{"endian", "big"}}}},
+          {{"name", "gzip"}, {"configuration", {{"level", 6}}}},
+          {{"name", "crc32c"}},
+      },
+      {
+          {{"name", "sharding_indexed"},
+           {"configuration",
+            {
+                {"chunk_shape", {2, 3}},
+                {"codecs",
+                 {{{"name", "bytes"},
+                   {"configuration", {{"endian", "little"}}}}}},
+                {"index_codecs",
+                 {{{"name", "bytes"},
+                   {"configuration", {{"endian", "little"}}}},
+                  {{"name", "crc32c"}}}},
+                {"index_location", "start"},
+            }}},
+      },
+  });
+}
+
+TEST(CodecChainTest, ShardingDefaults) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto chain,
+      ZarrCodecChain::FromJson(
+          {{{"name", "sharding_indexed"},
+            {"configuration",
+             {{"chunk_shape", {2, 3}},
+              {"codecs",
+               {{{"name", "bytes"},
+                 {"configuration", {{"endian", "little"}}}}}}}}}}));
+  EXPECT_THAT(
+      chain.ToJson(),
+      ::testing::Optional(MatchesJson(
+          {{{"name", "sharding_indexed"},
+            {"configuration",
+             {
+                 {"chunk_shape", {2, 3}},
+                 {"codecs",
+                  {{{"name", "bytes"},
+                    {"configuration", {{"endian", "little"}}}}}},
+                 {"index_codecs",
+                  {{{"name", "bytes"},
+                    {"configuration", {{"endian", "little"}}}},
+                   {{"name", "crc32c"}}}},
+                 {"index_location", "end"},
+             }}}})));
+}
+
+TEST(CodecChainTest, InvalidOrder) {
+  EXPECT_THAT(
+      ZarrCodecChain::FromJson({{{"name", "gzip"}}, {{"name", "bytes"}}}),
+      MatchesStatus(absl::StatusCode::kInvalidArgument,
+                    ".*\"gzip\" codec must follow the array -> bytes codec"));
+  EXPECT_THAT(
+      ZarrCodecChain::FromJson({{{"name", "bytes"}}, {{"name", "transpose"}}}),
+      MatchesStatus(absl::StatusCode::kInvalidArgument,
+                    ".*\"transpose\" codec must precede the array -> bytes "
+                    "codec"));
+  EXPECT_THAT(ZarrCodecChain::FromJson(::nlohmann::json::array_t()),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "Expected an array -> bytes codec.*"));
+  EXPECT_THAT(ZarrCodecChain::FromJson({{{"name", "bytes"}}, {{"name", "x"}}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument, ".*\"x\".*"));
+}
+
+TEST(CodecChainTest, ValidateEndianRequired) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto chain, ZarrCodecChain::FromJson({{{"name", "bytes"}}}));
+  TENSORSTORE_EXPECT_OK(ValidateCodecChain(chain, dtype_v<uint8_t>, {{2, 3}}));
+  EXPECT_THAT(ValidateCodecChain(chain, dtype_v<uint16_t>, {{2, 3}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CodecChainTest, ValidateShardingChunkShape) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto chain,
+      ZarrCodecChain::FromJson(
+          {{{"name", "sharding_indexed"},
+            {"configuration",
+             {{"chunk_shape", {2, 3}},
+              {"codecs", {{{"name", "bytes"}}}}}}}}));
+  TENSORSTORE_EXPECT_OK(ValidateCodecChain(chain, dtype_v<uint8_t>, {{4, 6}}));
+  EXPECT_THAT(ValidateCodecChain(chain, dtype_v<uint8_t>, {{4, 5}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CodecChainTest, EncodeDecodeTranspose) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto chain,
+      ZarrCodecChain::FromJson(
+          {{{"name", "transpose"}, {"configuration", {{"order", {1, 0}}}}},
+           {{"name", "bytes"}, {"configuration", {{"endian", "big"}}}},
+           {{"name", "crc32c"}}}));
+  auto array = tensorstore::MakeArray<uint16_t>({{1, 2, 3}, {4, 5, 6}});
+  TENSORSTORE_ASSERT_OK(
+      ValidateCodecChain(chain, array.dtype(), array.shape()));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto encoded, EncodeArray(chain, array));
+  // Elements are encoded in Fortran order as big endian, followed by a 4-byte
+  // checksum.
+  ASSERT_EQ(16, encoded.size());
+  EXPECT_EQ(std::string({0, 1, 0, 4, 0, 2, 0, 5, 0, 3, 0, 6}),
+            std::string(encoded.Subcord(0, 12)));
+  auto layout = GetDecodedChunkLayout(chain, array.dtype(), array.shape());
+  EXPECT_THAT(layout.byte_strides(), ::testing::ElementsAre(2, 4));
+  EXPECT_THAT(DecodeArray(chain, array.dtype(), layout, encoded),
+              ::testing::Optional(array));
+
+  // Corrupt the checksum.
+  std::string corrupt(encoded);
+  corrupt[0] ^= 1;
+  EXPECT_THAT(
+      DecodeArray(chain, array.dtype(), layout, absl::Cord(corrupt)),
+      MatchesStatus(absl::StatusCode::kInvalidArgument, ".*checksum.*"));
+}
+
+}  // namespace
@@ -0,0 +1,79 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_DRIVER_ZARR3_CODEC_REGISTRY_H_
+#define TENSORSTORE_DRIVER_ZARR3_CODEC_REGISTRY_H_
+
+#include <stddef.h>
+
+#include <string_view>
+
+#include "absl/strings/cord.h"
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/json_registry.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+/// Registers a bytes -> bytes codec.
+///
+/// \param name The codec name, as specified by the `"name"` member.
+/// \param binder Object binder for the `"configuration"` member, typically
+///     obtained from `CodecConfiguration`.
+template <typename T, typename Binder>
+void RegisterCodec(std::string_view name, Binder binder) {
+  GetCodecRegistry().Register<T>(name, binder);
+}
+
+/// Returns an object binder for the optional `"configuration"` member of a
+/// codec.
+///
+/// If the `"configuration"` member is absent, the codec retains its
+/// default-initialized parameters.
+template <typename... MemberBinder>
+constexpr auto CodecConfiguration(MemberBinder... member_binder) {
+  namespace jb = tensorstore::internal_json_binding;
+  return jb::OptionalMember("configuration", jb::Object(member_binder...));
+}
+
+/// Adapts a `JsonSpecifiedCompressor` as a bytes -> bytes codec.
+template <typename Compressor>
+class CompressorCodec : public ZarrBytesToBytesCodec {
+ public:
+  Result<absl::Cord> Encode(const absl::Cord& input,
+                            size_t element_bytes) const override {
+    absl::Cord output;
+    TENSORSTORE_RETURN_IF_ERROR(
+        compressor.Encode(input, &output, element_bytes));
+    return output;
+  }
+
+  Result<absl::Cord> Decode(const absl::Cord& input,
+                            size_t element_bytes) const override {
+    absl::Cord output;
+    TENSORSTORE_RETURN_IF_ERROR(
+        compressor.Decode(input, &output, element_bytes));
+    return output;
+  }
+
+  Compressor compressor;
+};
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_DRIVER_ZARR3_CODEC_REGISTRY_H_
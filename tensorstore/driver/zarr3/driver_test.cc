@@ -0,0 +1,411 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/// End-to-end tests of the zarr3 driver.
+
+#include <stdint.h>
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/array.h"
+#include "tensorstore/chunk_layout.h"
+#include "tensorstore/context.h"
+#include "tensorstore/driver/driver_testutil.h"
+#include "tensorstore/index.h"
+#include "tensorstore/index_space/dim_expression.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/memory/memory_key_value_store.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/open.h"
+#include "tensorstore/tensorstore.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::ChunkLayout;
+using ::tensorstore::Context;
+using ::tensorstore::Index;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::GetMap;
+using ::tensorstore::internal::TestSpecSchema;
+using ::tensorstore::internal::TestTensorStoreCreateCheckSchema;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+::nlohmann::json GetJsonSpec() {
+  return {
+      {"driver", "zarr3"},
+      {"kvstore",
+       {
+           {"driver", "memory"},
+           {"path", "prefix/"},
+       }},
+      {"metadata",
+       {
+           {"data_type", "int16"},
+           {"shape", {10, 11}},
+           {"chunk_grid",
+            {{"name", "regular"},
+             {"configuration", {{"chunk_shape", {3, 2}}}}}},
+       }},
+  };
+}
+
+TEST(ZarrDriverTest, OpenNonExisting) {
+  EXPECT_THAT(
+      tensorstore::Open(GetJsonSpec(), tensorstore::OpenMode::open,
+                        tensorstore::ReadWriteMode::read_write)
+          .result(),
+      MatchesStatus(absl::StatusCode::kNotFound,
+                    "Error opening \"zarr3\" driver: "
+                    "Metadata at \"prefix/zarr\\.json\" does not exist"));
+}
+
+TEST(ZarrDriverTest, Create) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(GetJsonSpec(), context, tensorstore::OpenMode::create,
+                        tensorstore::ReadWriteMode::read_write)
+          .result());
+  EXPECT_THAT(store.domain().shape(), ElementsAre(10, 11));
+
+  // Issue a read to be filled with the fill value.
+  EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                  store | tensorstore::Dims(0, 1).SizedInterval({9, 7}, {1, 1}))
+                  .result(),
+              ::testing::Optional(tensorstore::MakeArray<int16_t>({{0}})));
+
+  TENSORSTORE_EXPECT_OK(tensorstore::Write(
+      tensorstore::MakeArray<int16_t>({{1, 2, 3}, {4, 5, 6}}),
+      store | tensorstore::Dims(0, 1).SizedInterval({8, 8}, {2, 3})));
+
+  EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                  store | tensorstore::Dims(0, 1).SizedInterval({7, 7}, {3, 4}))
+                  .result(),
+              ::testing::Optional(tensorstore::MakeArray<int16_t>(
+                  {{0, 0, 0, 0}, {0, 1, 2, 3}, {0, 4, 5, 6}})));
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto kvs, kvstore::Open({{"driver", "memory"}}, context).result());
+  auto map = GetMap(kvs).value();
+  EXPECT_THAT(map, UnorderedElementsAre(
+                       Pair("prefix/zarr.json", ::testing::_),
+                       Pair("prefix/c/2/4", absl::Cord(std::string{
+                                                0, 0, 0, 0, 0, 0,  //
+                                                0, 0, 1, 0, 2, 0,  //
+                                            })),
+                       Pair("prefix/c/2/5", absl::Cord(std::string{
+                                                0, 0, 0, 0, 0, 0,  //
+                                                0, 0, 3, 0, 0, 0,  //
+                                            })),
+                       Pair("prefix/c/3/4", absl::Cord(std::string{
+                                                4, 0, 5, 0, 0, 0,  //
+                                                0, 0, 0, 0, 0, 0,  //
+                                            })),
+                       Pair("prefix/c/3/5", absl::Cord(std::string{
+                                                6, 0, 0, 0, 0, 0,  //
+                                                0, 0, 0, 0, 0, 0,  //
+                                            }))));
+
+  // Reopen and verify the metadata.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto reopened,
+      tensorstore::Open(GetJsonSpec(), context, tensorstore::OpenMode::open)
+          .result());
+  EXPECT_THAT(tensorstore::Read(reopened).result(),
+              ::testing::Optional(::testing::_));
+}
+
+TEST(ZarrDriverTest, FillValue) {
+  auto json_spec = GetJsonSpec();
+  json_spec["metadata"]["fill_value"] = 42;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(json_spec, tensorstore::OpenMode::create).result());
+  EXPECT_THAT(store.fill_value(),
+              ::testing::Optional(tensorstore::MakeScalarArray<int16_t>(42)));
+  EXPECT_THAT(tensorstore::Read<tensorstore::zero_origin>(
+                  store | tensorstore::Dims(0, 1).SizedInterval({0, 0}, {1, 2}))
+                  .result(),
+              ::testing::Optional(tensorstore::MakeArray<int16_t>({{42, 42}})));
+}
+
+TEST(ZarrDriverTest, V2ChunkKeyEncoding) {
+  auto json_spec = GetJsonSpec();
+  json_spec["metadata"]["chunk_key_encoding"] = {{"name", "v2"}};
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(json_spec, context, tensorstore::OpenMode::create)
+          .result());
+  TENSORSTORE_EXPECT_OK(tensorstore::Write(
+      tensorstore::MakeArray<int16_t>({{1}}),
+      store | tensorstore::Dims(0, 1).SizedInterval({3, 2}, {1, 1})));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto kvs, kvstore::Open({{"driver", "memory"}}, context).result());
+  EXPECT_THAT(GetMap(kvs).value(),
+              UnorderedElementsAre(Pair("prefix/zarr.json", ::testing::_),
+                                   Pair("prefix/1.1", ::testing::_)));
+}
+
+::nlohmann::json GetShardedJsonSpec(std::string index_location) {
+  auto json_spec = GetJsonSpec();
+  json_spec["metadata"]["chunk_grid"]["configuration"]["chunk_shape"] = {6, 4};
+  json_spec["metadata"]["codecs"] = {
+      {{"name", "sharding_indexed"},
+       {"configuration",
+        {{"chunk_shape", {3, 2}},
+         {"codecs",
+          {{{"name", "bytes"}, {"configuration", {{"endian", "little"}}}},
+           {{"name", "gzip"}}}},
+         {"index_location", index_location}}}}};
+  return json_spec;
+}
+
+class ShardedZarrDriverTest : public ::testing::TestWithParam<std::string> {};
+
+INSTANTIATE_TEST_SUITE_P(IndexLocation, ShardedZarrDriverTest,
+                         ::testing::Values("start", "end"));
+
+TEST_P(ShardedZarrDriverTest, ReadWrite) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(GetShardedJsonSpec(GetParam()), context,
+                        tensorstore::OpenMode::create,
+                        tensorstore::ReadWriteMode::read_write)
+          .result());
+  auto data = tensorstore::MakeArray<int16_t>({{1, 2, 3}, {4, 5, 6}});
+  TENSORSTORE_EXPECT_OK(tensorstore::Write(
+      data, store | tensorstore::Dims(0, 1).SizedInterval({5, 3}, {2, 3})));
+
+  // The write spans 4 shards.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto kvs, kvstore::Open({{"driver", "memory"}}, context).result());
+  EXPECT_THAT(GetMap(kvs).value(),
+              UnorderedElementsAre(Pair("prefix/zarr.json", ::testing::_),
+                                   Pair("prefix/c/0/0", ::testing::_),
+                                   Pair("prefix/c/0/1", ::testing::_),
+                                   Pair("prefix/c/1/0", ::testing::_),
+                                   Pair("prefix/c/1/1", ::testing::_)));
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto reopened, tensorstore::Open(GetShardedJsonSpec(GetParam()), context,
+                                       tensorstore::OpenMode::open)
+                         .result());
+  EXPECT_THAT(
+      tensorstore::Read<tensorstore::zero_origin>(
+          reopened | tensorstore::Dims(0, 1).SizedInterval({4, 3}, {3, 4}))
+          .result(),
+      ::testing::Optional(tensorstore::MakeArray<int16_t>(
+          {{0, 0, 0, 0}, {1, 2, 3, 0}, {4, 5, 6, 0}})));
+
+  // Overwrite an inner chunk, leaving the other chunks of the shard intact.
+  TENSORSTORE_EXPECT_OK(tensorstore::Write(
+      tensorstore::MakeArray<int16_t>({{7}}),
+      reopened | tensorstore::Dims(0, 1).SizedInterval({5, 3}, {1, 1})));
+  EXPECT_THAT(
+      tensorstore::Read<tensorstore::zero_origin>(
+          reopened | tensorstore::Dims(0, 1).SizedInterval({5, 3}, {2, 3}))
+          .result(),
+      ::testing::Optional(
+          tensorstore::MakeArray<int16_t>({{7, 2, 3}, {4, 5, 6}})));
+}
+
+TEST(ShardedZarrDriverTest, ChunkLayout) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, tensorstore::Open(GetShardedJsonSpec("end"),
+                                    tensorstore::OpenMode::create)
+                      .result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto expected_layout,
+                                   ChunkLayout::FromJson({
+                                       {"write_chunk", {{"shape", {6, 4}}}},
+                                       {"read_chunk", {{"shape", {3, 2}}}},
+                                       {"inner_order", {0, 1}},
+                                       {"grid_origin", {0, 0}},
+                                   }));
+  EXPECT_THAT(store.chunk_layout(), ::testing::Optional(expected_layout));
+}
+
+TEST(DriverTest, ChunkLayoutTranspose) {
+  auto json_spec = GetJsonSpec();
+  json_spec["metadata"]["codecs"] = {
+      {{"name", "transpose"}, {"configuration", {{"order", {1, 0}}}}},
+      {{"name", "bytes"}, {"configuration", {{"endian", "little"}}}}};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open(json_spec, tensorstore::OpenMode::create).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto expected_layout,
+                                   ChunkLayout::FromJson({
+                                       {"write_chunk", {{"shape", {3, 2}}}},
+                                       {"read_chunk", {{"shape", {3, 2}}}},
+                                       {"inner_order", {1, 0}},
+                                       {"grid_origin", {0, 0}},
+                                   }));
+  EXPECT_THAT(store.chunk_layout(), ::testing::Optional(expected_layout));
+}
+
+// Tests that reading a small region of an uncompressed chunk with a
+// `transpose` codec reads only the byte range in the encoded order.
+TEST(ZarrDriverTest, PartialChunkReadTranspose) {
+  auto context = Context::Default();
+  auto mock_key_value_store =
+      *context.GetResource<tensorstore::internal::MockKeyValueStoreResource>()
+           .value();
+  auto memory_store = tensorstore::GetMemoryKeyValueStore();
+  auto store_future = tensorstore::Open(
+      {
+          {"driver", "zarr3"},
+          {"kvstore",
+           {
+               {"driver", "mock_key_value_store"},
+               {"path", "prefix/"},
+           }},
+          {"metadata",
+           {
+               {"data_type", "int16"},
+               {"shape", {100, 100}},
+               {"chunk_grid",
+                {{"name", "regular"},
+                 {"configuration", {{"chunk_shape", {10, 10}}}}}},
+               {"codecs",
+                {{{"name", "transpose"},
+                  {"configuration", {{"order", {1, 0}}}}},
+                 {{"name", "bytes"},
+                  {"configuration", {{"endian", "little"}}}}}},
+           }},
+          {"create", true},
+      },
+      context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  // Element `(i, j)` is stored at position `i + 10 * j` in the encoded chunk
+  // and equals `10 * i + j`.
+  std::string chunk(200, '\0');
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      chunk[2 * (i + 10 * j)] = static_cast<char>(10 * i + j);
+    }
+  }
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory_store, "prefix/c/0/0", absl::Cord(chunk)));
+
+  auto read_future = tensorstore::Read(
+      store | tensorstore::Dims(0, 1).SizedInterval({2, 3}, {2, 2}));
+  read_future.Force();
+  {
+    auto read_request = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/c/0/0", read_request.key);
+    EXPECT_EQ(tensorstore::OptionalByteRangeRequest(64, 88),
+              read_request.options.byte_range);
+    read_request(memory_store);
+  }
+  EXPECT_THAT(read_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray<int16_t>(
+                  {2, 3}, {{23, 24}, {33, 34}})));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
+TEST(DriverTest, MissingDtype) {
+  EXPECT_THAT(
+      tensorstore::Open(
+          {{"driver", "zarr3"}, {"kvstore", {{"driver", "memory"}}}},
+          tensorstore::Schema::Shape({100}), tensorstore::OpenMode::create)
+          .result(),
+      MatchesStatus(absl::StatusCode::kInvalidArgument,
+                    ".*: dtype must be specified"));
+}
+
+TEST(DriverTest, DimensionNames) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      tensorstore::Open({{"driver", "zarr3"},
+                         {"kvstore", {{"driver", "memory"}}},
+                         {"schema",
+                          {{"domain", {{"labels", {"x", ""}},
+                                       {"shape", {10, 20}}}},
+                           {"dtype", "uint8"}}}},
+                        tensorstore::OpenMode::create)
+          .result());
+  EXPECT_THAT(store.domain().labels(), ElementsAre("x", ""));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto spec, store.spec());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto spec_json, spec.ToJson());
+  EXPECT_EQ(::nlohmann::json({"x", nullptr}),
+            spec_json["metadata"]["dimension_names"]);
+}
+
+TEST(SpecSchemaTest, Domain) {
+  TestSpecSchema({{"driver", "zarr3"},
+                  {"kvstore", {{"driver", "memory"}}},
+                  {"metadata", {{"shape", {3, 4}}}}},
+                 {
+                     {"domain",
+                      {{"inclusive_min", {0, 0}},
+                       {"exclusive_max", {{3}, {4}}}}},
+                     {"chunk_layout", {{"grid_origin", {0, 0}}}},
+                     {"codec", {{"driver", "zarr3"}}},
+                 });
+}
+
+TEST(DriverCreateCheckSchemaTest, Simple) {
+  TestTensorStoreCreateCheckSchema(
+      {
+          {"driver", "zarr3"},
+          {"kvstore", {{"driver", "memory"}}},
+          {"schema",
+           {
+               {"dtype", "uint16"},
+               {"domain", {{"shape", {1000, 2000, 3000}}}},
+               {"chunk_layout", {{"read_chunk", {{"shape", {30, 40, 50}}}}}},
+               {"fill_value", 5},
+           }},
+      },
+      {
+          {"dtype", "uint16"},
+          {"domain",
+           {
+               {"shape", {{1000}, {2000}, {3000}}},
+               {"inclusive_min", {0, 0, 0}},
+           }},
+          {"chunk_layout",
+           {
+               {"grid_origin", {0, 0, 0}},
+               {"inner_order", {0, 1, 2}},
+               {"read_chunk", {{"shape", {30, 40, 50}}}},
+               {"write_chunk", {{"shape", {30, 40, 50}}}},
+           }},
+          {"codec",
+           {
+               {"driver", "zarr3"},
+               {"codecs",
+                {{{"name", "bytes"},
+                  {"configuration", {{"endian", "little"}}}}}},
+           }},
+          {"fill_value", 5},
+      });
+}
+
+}  // namespace
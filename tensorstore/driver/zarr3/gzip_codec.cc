@@ -0,0 +1,52 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Defines the "gzip" codec for zarr v3.  Linking in this library
+/// automatically registers it.
+
+#include "tensorstore/internal/compression/zlib_compressor.h"
+
+#include "tensorstore/driver/zarr3/codec_registry.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+namespace {
+
+class GzipCodec : public CompressorCodec<internal::ZlibCompressor> {
+ public:
+  GzipCodec() {
+    compressor.use_gzip_header = true;
+    compressor.level = 6;
+  }
+};
+
+struct Registration {
+  Registration() {
+    namespace jb = tensorstore::internal_json_binding;
+    RegisterCodec<GzipCodec>(
+        "gzip",
+        CodecConfiguration(jb::Member(
+            "level",
+            jb::Projection(
+                [](auto& codec) -> auto& { return codec.compressor.level; },
+                jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                    [](auto* v) { *v = 6; }, jb::Integer<int>(0, 9))))));
+  }
+} registration;
+
+}  // namespace
+}  // namespace internal_zarr3
+}  // namespace tensorstore
@@ -0,0 +1,799 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "tensorstore/driver/zarr3/metadata.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_join.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/codec_spec_registry.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/index_space/index_domain_builder.h"
+#include "tensorstore/internal/json/json.h"
+#include "tensorstore/internal/json/value_as.h"
+#include "tensorstore/internal/json_binding/data_type.h"
+#include "tensorstore/internal/json_binding/dimension_indexed.h"
+#include "tensorstore/internal/json_binding/enum.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/json_binding/std_optional.h"
+#include "tensorstore/internal/json_metadata_matching.h"
+#include "tensorstore/internal/type_traits.h"
+#include "tensorstore/serialization/fwd.h"
+#include "tensorstore/serialization/json_bindable.h"
+#include "tensorstore/util/constant_vector.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+namespace jb = tensorstore::internal_json_binding;
+using ::tensorstore::internal::MetadataMismatchError;
+
+CodecSpec ZarrCodecSpec::Clone() const {
+  return internal::CodecDriverSpec::Make<ZarrCodecSpec>(*this);
+}
+
+absl::Status ZarrCodecSpec::DoMergeFrom(
+    const internal::CodecDriverSpec& other_base) {
+  if (typeid(other_base) != typeid(ZarrCodecSpec)) {
+    return absl::InvalidArgumentError("");
+  }
+  auto& other = static_cast<const ZarrCodecSpec&>(other_base);
+  if (other.codecs) {
+    if (!codecs) {
+      codecs = other.codecs;
+    } else if (!internal_json::JsonSame(::nlohmann::json(*codecs),
+                                        ::nlohmann::json(*other.codecs))) {
+      return absl::InvalidArgumentError("\"codecs\" does not match");
+    }
+  }
+  return absl::OkStatus();
+}
+
+TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(
+    ZarrCodecSpec,
+    jb::Sequence(jb::Member("codecs", jb::Projection(&ZarrCodecSpec::codecs))))
+
+TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(
+    ChunkKeyEncoding,
+    jb::Object(
+        jb::Member("name",
+                   jb::Projection<&ChunkKeyEncoding::kind>(
+                       jb::Enum<ChunkKeyEncoding::Kind, std::string_view>({
+                           {ChunkKeyEncoding::kDefault, "default"},
+                           {ChunkKeyEncoding::kV2, "v2"},
+                       }))),
+        jb::Initialize([](ChunkKeyEncoding* obj) {
+          obj->separator = obj->kind == ChunkKeyEncoding::kDefault ? '/' : '.';
+        }),
+        jb::OptionalMember(
+            "configuration",
+            jb::Object(jb::OptionalMember(
+                "separator",
+                jb::Projection<&ChunkKeyEncoding::separator>(
+                    jb::Enum<char, std::string_view>({
+                        {'/', "/"},
+                        {'.', "."},
+                    })))))))
+
+namespace {
+
+const internal::CodecSpecRegistration<ZarrCodecSpec> encoding_registration;
+
+constexpr std::array kSupportedDataTypes{
+    DataTypeId::bool_t,     DataTypeId::int8_t,      DataTypeId::int16_t,
+    DataTypeId::int32_t,    DataTypeId::int64_t,     DataTypeId::uint8_t,
+    DataTypeId::uint16_t,   DataTypeId::uint32_t,    DataTypeId::uint64_t,
+    DataTypeId::float16_t,  DataTypeId::float32_t,   DataTypeId::float64_t,
+    DataTypeId::complex64_t, DataTypeId::complex128_t,
+};
+
+std::string GetSupportedDataTypes() {
+  return absl::StrJoin(
+      kSupportedDataTypes, ", ", [](std::string* out, DataTypeId id) {
+        absl::StrAppend(out, kDataTypes[static_cast<int>(id)].name());
+      });
+}
+
+Result<double> DecodeFloat(const ::nlohmann::json& j) {
+  double value;
+  if (j == "NaN") {
+    value = std::numeric_limits<double>::quiet_NaN();
+  } else if (j == "Infinity") {
+    value = std::numeric_limits<double>::infinity();
+  } else if (j == "-Infinity") {
+    value = -std::numeric_limits<double>::infinity();
+  } else if (j.is_number()) {
+    value = j.get<double>();
+  } else {
+    return absl::InvalidArgumentError(
+        tensorstore::StrCat("Invalid floating-point value: ", j.dump()));
+  }
+  return value;
+}
+
+::nlohmann::json EncodeFloat(double value) {
+  if (std::isnan(value)) return "NaN";
+  if (value == std::numeric_limits<double>::infinity()) return "Infinity";
+  if (value == -std::numeric_limits<double>::infinity()) return "-Infinity";
+  return value;
+}
+
+template <typename T>
+SharedArray<const void> ConvertScalar(T value, DataType dtype) {
+  return MakeCopy(MakeScalarArrayView(value), c_order, dtype).value();
+}
+
+/// Parses the `"fill_value"` member for the specified `dtype`.
+Result<SharedArray<const void>> ParseFillValue(const ::nlohmann::json& j,
+                                               DataType dtype) {
+  switch (dtype.id()) {
+    case DataTypeId::bool_t: {
+      bool value;
+      TENSORSTORE_RETURN_IF_ERROR(
+          internal_json::JsonRequireValueAs(j, &value, /*strict=*/true));
+      return MakeScalarArray<bool>(value);
+    }
+    case DataTypeId::int8_t:
+    case DataTypeId::int16_t:
+    case DataTypeId::int32_t:
+    case DataTypeId::int64_t: {
+      int64_t value;
+      const size_t num_bits = 8 * dtype.size() - 1;
+      const int64_t max_value = static_cast<int64_t>(
+          (static_cast<uint64_t>(1) << num_bits) - 1);
+      const int64_t min_value = static_cast<int64_t>(-1) << num_bits;
+      TENSORSTORE_RETURN_IF_ERROR(internal_json::JsonRequireInteger(
+          j, &value, /*strict=*/true, min_value, max_value));
+      return ConvertScalar(value, dtype);
+    }
+    case DataTypeId::uint8_t:
+    case DataTypeId::uint16_t:
+    case DataTypeId::uint32_t:
+    case DataTypeId::uint64_t: {
+      uint64_t value;
+      const size_t num_bits = 8 * dtype.size();
+      const uint64_t max_value =
+          (static_cast<uint64_t>(2) << (num_bits - 1)) - 1;
+      TENSORSTORE_RETURN_IF_ERROR(internal_json::JsonRequireInteger(
+          j, &value, /*strict=*/true, uint64_t(0), max_value));
+      return ConvertScalar(value, dtype);
+    }
+    case DataTypeId::float16_t:
+    case DataTypeId::float32_t:
+    case DataTypeId::float64_t: {
+      TENSORSTORE_ASSIGN_OR_RETURN(double value, DecodeFloat(j));
+      return ConvertScalar(value, dtype);
+    }
+    case DataTypeId::complex64_t:
+    case DataTypeId::complex128_t: {
+      double values[2];
+      TENSORSTORE_RETURN_IF_ERROR(internal_json::JsonParseArray(
+          j,
+          [](std::ptrdiff_t size) {
+            return internal_json::JsonValidateArrayLength(size, 2);
+          },
+          [&](const ::nlohmann::json& v, std::ptrdiff_t i) {
+            TENSORSTORE_ASSIGN_OR_RETURN(values[i], DecodeFloat(v));
+            return absl::OkStatus();
+          }));
+      return ConvertScalar(complex128_t(values[0], values[1]), dtype);
+    }
+    default:
+      return absl::InvalidArgumentError(
+          tensorstore::StrCat("Unsupported data type: ", dtype));
+  }
+}
+
+/// Inverse of `ParseFillValue`.
+::nlohmann::json EncodeFillValue(const SharedArray<const void>& fill_value) {
+  switch (fill_value.dtype().id()) {
+    case DataTypeId::float16_t:
+    case DataTypeId::float32_t:
+    case DataTypeId::float64_t: {
+      double value;
+      TENSORSTORE_CHECK_OK(
+          CopyConvertedArray(fill_value, MakeScalarArrayView(value)));
+      return EncodeFloat(value);
+    }
+    case DataTypeId::complex64_t:
+    case DataTypeId::complex128_t: {
+      complex128_t value;
+      TENSORSTORE_CHECK_OK(
+          CopyConvertedArray(fill_value, MakeScalarArrayView(value)));
+      return ::nlohmann::json::array_t{EncodeFloat(value.real()),
+                                       EncodeFloat(value.imag())};
+    }
+    default: {
+      ::nlohmann::json value;
+      TENSORSTORE_CHECK_OK(
+          CopyConvertedArray(fill_value, MakeScalarArrayView(value)));
+      return value;
+    }
+  }
+}
+
+/// Binder for the `"fill_value"` member, which depends on the data type.
+constexpr auto FillValueBinder = [](DataType dtype) {
+  return [=](auto is_loading, const auto& options, auto* obj,
+             ::nlohmann::json* j) -> absl::Status {
+    if constexpr (is_loading) {
+      TENSORSTORE_ASSIGN_OR_RETURN(*obj, ParseFillValue(*j, dtype));
+    } else {
+      *j = EncodeFillValue(*obj);
+    }
+    return absl::OkStatus();
+  };
+};
+
+/// Binder for the `"chunk_grid"` member, which must specify a regular grid.
+constexpr auto RegularChunkGridBinder = [](DimensionIndex* rank) {
+  return jb::Object(
+      jb::Member("name", jb::Constant([] { return "regular"; })),
+      jb::Member("configuration",
+                 jb::Object(jb::Member("chunk_shape",
+                                       jb::ChunkShapeVector(rank)))));
+};
+
+constexpr auto DimensionNamesBinder = [](DimensionIndex* rank) {
+  return jb::DimensionIndexedVector(
+      rank, jb::Optional(jb::DefaultBinder<>, [] { return nullptr; }));
+};
+
+absl::Status ValidateMetadata(ZarrMetadata& metadata) {
+  TENSORSTORE_RETURN_IF_ERROR(ValidateCodecChain(
+      metadata.codecs, metadata.data_type, metadata.chunk_shape));
+  if (metadata.codecs.sharding) {
+    metadata.read_chunk_shape = metadata.codecs.sharding->chunk_shape;
+  } else {
+    metadata.read_chunk_shape = metadata.chunk_shape;
+  }
+  metadata.read_chunk_layout =
+      GetDecodedChunkLayout(metadata.read_chunk_codecs(), metadata.data_type,
+                            metadata.read_chunk_shape);
+  if (metadata.read_chunk_layout.num_elements() ==
+      std::numeric_limits<Index>::max()) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "Product of chunk dimensions ", span(metadata.read_chunk_shape),
+        " is too large"));
+  }
+  return absl::OkStatus();
+}
+
+constexpr auto MetadataJsonBinder = [](auto maybe_optional) {
+  return [=](auto is_loading, const auto& options, auto* obj, auto* j) {
+    using T = internal::remove_cvref_t<decltype(*obj)>;
+    constexpr bool kIsConstraints =
+        std::is_same_v<T, ZarrMetadataConstraints>;
+    DimensionIndex* rank = nullptr;
+    if constexpr (is_loading) {
+      rank = &obj->rank;
+    }
+    // `zarr_format` and `node_type` are implicit in the constraints.
+    auto constant_member = [](const char* name, auto get_value) {
+      if constexpr (kIsConstraints) {
+        return jb::LoadSave(jb::OptionalMember(name, jb::Constant(get_value)));
+      } else {
+        return jb::Member(name, jb::Constant(get_value));
+      }
+    };
+    return jb::Object(
+        constant_member("zarr_format", [] { return 3; }),
+        constant_member("node_type", [] { return "array"; }),
+        jb::Member("shape",
+                   jb::Projection(&T::shape,
+                                  maybe_optional(jb::ShapeVector(rank)))),
+        jb::Member("data_type",
+                   jb::Projection(&T::data_type,
+                                  maybe_optional(jb::Validate(
+                                      [](const auto& options, auto* obj) {
+                                        return ValidateDataType(*obj);
+                                      },
+                                      jb::DataTypeJsonBinder)))),
+        jb::Member(
+            "chunk_grid",
+            jb::Projection(&T::chunk_shape,
+                           maybe_optional(RegularChunkGridBinder(rank)))),
+        jb::Member("chunk_key_encoding",
+                   jb::Projection(&T::chunk_key_encoding,
+                                  maybe_optional(jb::DefaultBinder<>))),
+        jb::Member(
+            "fill_value",
+            [](auto is_loading, const auto& options, auto* obj, auto* j) {
+              if constexpr (kIsConstraints) {
+                if constexpr (is_loading) {
+                  if (j->is_discarded()) return absl::OkStatus();
+                  if (!obj->data_type) {
+                    return absl::InvalidArgumentError(
+                        "must be specified in conjunction with \"data_type\"");
+                  }
+                  return FillValueBinder(*obj->data_type)(
+                      is_loading, options, &obj->fill_value.emplace(), j);
+                } else {
+                  if (!obj->fill_value) return absl::OkStatus();
+                  return FillValueBinder(obj->fill_value->dtype())(
+                      is_loading, options, &*obj->fill_value, j);
+                }
+              } else {
+                return FillValueBinder(obj->data_type)(is_loading, options,
+                                                       &obj->fill_value, j);
+              }
+            }),
+        jb::Member("codecs",
+                   jb::Projection(&T::codecs,
+                                  maybe_optional(jb::DefaultBinder<>))),
+        jb::Member("attributes",
+                   jb::Projection(&T::attributes,
+                                  [](auto is_loading, const auto& options,
+                                     auto* obj, auto* j) {
+                                    if constexpr (kIsConstraints) {
+                                      return jb::Optional()(is_loading, options,
+                                                            obj, j);
+                                    } else {
+                                      return jb::DefaultInitializedValue()(
+                                          is_loading, options, obj, j);
+                                    }
+                                  })),
+        jb::Member("dimension_names",
+                   jb::Projection(&T::dimension_names,
+                                  [=](auto is_loading, const auto& options,
+                                      auto* obj, auto* j) {
+                                    if constexpr (kIsConstraints) {
+                                      return jb::Optional(
+                                          DimensionNamesBinder(rank))(
+                                          is_loading, options, obj, j);
+                                    } else {
+                                      return jb::DefaultInitializedValue(
+                                          DimensionNamesBinder(rank))(
+                                          is_loading, options, obj, j);
+                                    }
+                                  })),
+        // Storage transformers are not supported, but an empty list is
+        // permitted.
+        jb::LoadSave(jb::OptionalMember(
+            "storage_transformers",
+            jb::Constant([] { return ::nlohmann::json::array_t(); }))))(
+        is_loading, options, obj, j);
+  };
+};
+
+}  // namespace
+
+std::string ZarrMetadata::GetCompatibilityKey() const {
+  ::nlohmann::json::object_t obj;
+  obj.emplace("chunk_shape", chunk_shape);
+  obj.emplace("data_type", data_type.name());
+  obj.emplace("codecs", codecs);
+  obj.emplace("fill_value", EncodeFillValue(fill_value));
+  return ::nlohmann::json(obj).dump();
+}
+
+TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(
+    ZarrMetadata,
+    jb::Validate(
+        [](const auto& options, auto* obj) {
+          if (obj->dimension_names.empty()) {
+            obj->dimension_names.resize(obj->rank);
+          }
+          return ValidateMetadata(*obj);
+        },
+        MetadataJsonBinder(internal::identity{})))
+
+TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(ZarrMetadataConstraints,
+                                       MetadataJsonBinder([](auto... binder) {
+                                         return jb::Optional(binder...);
+                                       }))
+
+std::string EncodeChunkKey(const ChunkKeyEncoding& encoding,
+                           span<const Index> grid_indices) {
+  std::string key;
+  if (encoding.kind == ChunkKeyEncoding::kDefault) {
+    key = "c";
+    for (const Index i : grid_indices) {
+      tensorstore::StrAppend(&key, std::string_view(&encoding.separator, 1),
+                             i);
+    }
+    return key;
+  }
+  // Use "0" for rank 0 as a special case.
+  if (grid_indices.empty()) return "0";
+  key = tensorstore::StrCat(grid_indices[0]);
+  for (DimensionIndex i = 1; i < grid_indices.size(); ++i) {
+    tensorstore::StrAppend(&key, std::string_view(&encoding.separator, 1),
+                           grid_indices[i]);
+  }
+  return key;
+}
+
+Result<SharedArrayView<const void>> DecodeChunk(const ZarrMetadata& metadata,
+                                                absl::Cord buffer) {
+  return DecodeArray(metadata.read_chunk_codecs(), metadata.data_type,
+                     metadata.read_chunk_layout, std::move(buffer));
+}
+
+Result<absl::Cord> EncodeChunk(const ZarrMetadata& metadata,
+                               ArrayView<const void> array) {
+  return EncodeArray(metadata.read_chunk_codecs(), array);
+}
+
+absl::Status ValidateMetadata(const ZarrMetadata& metadata,
+                              const ZarrMetadataConstraints& constraints) {
+  if (constraints.shape && !absl::c_equal(metadata.shape, *constraints.shape)) {
+    return MetadataMismatchError("shape", *constraints.shape, metadata.shape);
+  }
+  if (constraints.chunk_shape &&
+      !absl::c_equal(metadata.chunk_shape, *constraints.chunk_shape)) {
+    return MetadataMismatchError("chunk_shape", *constraints.chunk_shape,
+                                 metadata.chunk_shape);
+  }
+  if (constraints.data_type && *constraints.data_type != metadata.data_type) {
+    return MetadataMismatchError("data_type", constraints.data_type->name(),
+                                 metadata.data_type.name());
+  }
+  if (constraints.chunk_key_encoding &&
+      *constraints.chunk_key_encoding != metadata.chunk_key_encoding) {
+    return MetadataMismatchError("chunk_key_encoding",
+                                 *constraints.chunk_key_encoding,
+                                 metadata.chunk_key_encoding);
+  }
+  if (constraints.fill_value &&
+      !AreArraysSameValueEqual(*constraints.fill_value,
+                                 metadata.fill_value)) {
+    return MetadataMismatchError("fill_value",
+                                 EncodeFillValue(*constraints.fill_value),
+                                 EncodeFillValue(metadata.fill_value));
+  }
+  if (constraints.codecs && ::nlohmann::json(*constraints.codecs) !=
+                                ::nlohmann::json(metadata.codecs)) {
+    return MetadataMismatchError("codecs", *constraints.codecs,
+                                 metadata.codecs);
+  }
+  if (constraints.dimension_names &&
+      *constraints.dimension_names != metadata.dimension_names) {
+    return MetadataMismatchError(
+        "dimension_names",
+        jb::ToJson(*constraints.dimension_names, DimensionNamesBinder(nullptr))
+            .value(),
+        jb::ToJson(metadata.dimension_names, DimensionNamesBinder(nullptr))
+            .value());
+  }
+  if (constraints.attributes) {
+    return internal::ValidateMetadataSubset(*constraints.attributes,
+                                            metadata.attributes);
+  }
+  return absl::OkStatus();
+}
+
+namespace {
+
+/// Returns the dimension labels corresponding to `dimension_names`.
+std::vector<std::string> GetDimensionLabels(
+    span<const std::optional<std::string>> dimension_names) {
+  std::vector<std::string> labels(dimension_names.size());
+  for (DimensionIndex i = 0; i < dimension_names.size(); ++i) {
+    if (dimension_names[i]) labels[i] = *dimension_names[i];
+  }
+  return labels;
+}
+
+Result<IndexDomain<>> GetEffectiveDomain(
+    DimensionIndex rank, std::optional<span<const Index>> shape,
+    std::optional<span<const std::optional<std::string>>> dimension_names,
+    const Schema& schema) {
+  auto domain = schema.domain();
+  if (!shape && !dimension_names && !domain.valid()) {
+    if (schema.rank() == 0) return {std::in_place, 0};
+    // No information about the domain available.
+    return {std::in_place};
+  }
+
+  // Rank is already validated by caller.
+  assert(RankConstraint::EqualOrUnspecified(schema.rank(), rank));
+  IndexDomainBuilder builder(std::max(schema.rank().rank, rank));
+  if (shape) {
+    builder.shape(*shape);
+    builder.implicit_upper_bounds(true);
+  } else {
+    builder.origin(GetConstantVector<Index, 0>(builder.rank()));
+  }
+  if (dimension_names) {
+    builder.labels(GetDimensionLabels(*dimension_names));
+  }
+
+  TENSORSTORE_ASSIGN_OR_RETURN(auto domain_from_metadata, builder.Finalize());
+  TENSORSTORE_ASSIGN_OR_RETURN(domain,
+                               MergeIndexDomains(domain, domain_from_metadata),
+                               tensorstore::MaybeAnnotateStatus(
+                                   _, "Mismatch between metadata and schema"));
+  return WithImplicitDimensions(domain, false, true);
+}
+
+absl::Status SetChunkLayoutFromMetadata(
+    DimensionIndex rank, std::optional<span<const Index>> chunk_shape,
+    const ZarrCodecChain* codecs, DataType dtype, ChunkLayout& chunk_layout) {
+  TENSORSTORE_RETURN_IF_ERROR(chunk_layout.Set(RankConstraint{rank}));
+  rank = chunk_layout.rank();
+  if (rank == dynamic_rank) return absl::OkStatus();
+
+  std::optional<span<const Index>> read_chunk_shape;
+  if (codecs) {
+    const ZarrCodecChain* read_chunk_codecs = codecs;
+    if (codecs->sharding &&
+        static_cast<DimensionIndex>(codecs->sharding->chunk_shape.size()) ==
+            rank) {
+      read_chunk_codecs = &codecs->sharding->codecs;
+      read_chunk_shape = codecs->sharding->chunk_shape;
+    }
+    if (!read_chunk_codecs->sharding &&
+        absl::c_all_of(read_chunk_codecs->array_to_array,
+                       [&](const TransposeCodec& codec) {
+                         return static_cast<DimensionIndex>(
+                                    codec.order.size()) == rank;
+                       })) {
+      // The inner order is determined by the "transpose" codecs.
+      Index shape[kMaxRank];
+      std::fill_n(shape, rank, Index(1));
+      auto layout = GetDecodedChunkLayout(*read_chunk_codecs,
+                                          dtype.valid() ? dtype : dtype_v<char>,
+                                          span(shape, rank));
+      DimensionIndex inner_order[kMaxRank];
+      SetPermutationFromStridedLayout(layout, span(inner_order, rank));
+      TENSORSTORE_RETURN_IF_ERROR(
+          chunk_layout.Set(ChunkLayout::InnerOrder(span(inner_order, rank))));
+    }
+  }
+  if (read_chunk_shape) {
+    TENSORSTORE_RETURN_IF_ERROR(
+        chunk_layout.Set(ChunkLayout::ReadChunkShape(*read_chunk_shape)));
+    if (chunk_shape) {
+      TENSORSTORE_RETURN_IF_ERROR(
+          chunk_layout.Set(ChunkLayout::WriteChunkShape(*chunk_shape)));
+    }
+  } else if (chunk_shape) {
+    assert(chunk_shape->size() == rank);
+    TENSORSTORE_RETURN_IF_ERROR(
+        chunk_layout.Set(ChunkLayout::ChunkShape(*chunk_shape)));
+  }
+  TENSORSTORE_RETURN_IF_ERROR(chunk_layout.Set(
+      ChunkLayout::GridOrigin(GetConstantVector<Index, 0>(rank))));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+Result<IndexDomain<>> GetEffectiveDomain(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema) {
+  return GetEffectiveDomain(metadata_constraints.rank,
+                            metadata_constraints.shape,
+                            metadata_constraints.dimension_names, schema);
+}
+
+absl::Status SetChunkLayoutFromMetadata(const ZarrMetadata& metadata,
+                                        ChunkLayout& chunk_layout) {
+  return SetChunkLayoutFromMetadata(metadata.rank, metadata.chunk_shape,
+                                    &metadata.codecs, metadata.data_type,
+                                    chunk_layout);
+}
+
+Result<ChunkLayout> GetEffectiveChunkLayout(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema) {
+  assert(RankConstraint::EqualOrUnspecified(metadata_constraints.rank,
+                                            schema.rank()));
+  auto chunk_layout = schema.chunk_layout();
+  TENSORSTORE_RETURN_IF_ERROR(SetChunkLayoutFromMetadata(
+      std::max(metadata_constraints.rank, schema.rank().rank),
+      metadata_constraints.chunk_shape,
+      metadata_constraints.codecs ? &*metadata_constraints.codecs : nullptr,
+      metadata_constraints.data_type.value_or(schema.dtype()), chunk_layout));
+  return chunk_layout;
+}
+
+Result<internal::CodecDriverSpec::PtrT<ZarrCodecSpec>> GetEffectiveCodec(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema) {
+  auto codec_spec = internal::CodecDriverSpec::Make<ZarrCodecSpec>();
+  if (metadata_constraints.codecs) {
+    codec_spec->codecs = *metadata_constraints.codecs;
+  }
+  TENSORSTORE_RETURN_IF_ERROR(codec_spec->MergeFrom(schema.codec()));
+  return codec_spec;
+}
+
+CodecSpec GetCodecFromMetadata(const ZarrMetadata& metadata) {
+  auto codec_spec = internal::CodecDriverSpec::Make<ZarrCodecSpec>();
+  codec_spec->codecs = metadata.codecs;
+  return CodecSpec(std::move(codec_spec));
+}
+
+Result<std::shared_ptr<const ZarrMetadata>> GetNewMetadata(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema) {
+  auto metadata = std::make_shared<ZarrMetadata>();
+
+  // Set domain
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto domain, GetEffectiveDomain(metadata_constraints, schema));
+  if (!domain.valid() || !IsFinite(domain.box())) {
+    return absl::InvalidArgumentError("domain must be specified");
+  }
+  const DimensionIndex rank = metadata->rank = domain.rank();
+  metadata->shape.assign(domain.shape().begin(), domain.shape().end());
+  metadata->dimension_names.resize(rank);
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    if (const auto& label = domain.labels()[i]; !label.empty()) {
+      metadata->dimension_names[i] = std::string(label);
+    }
+  }
+  if (metadata_constraints.dimension_names) {
+    metadata->dimension_names = *metadata_constraints.dimension_names;
+  }
+
+  // Set dtype
+  auto dtype = metadata_constraints.data_type.value_or(schema.dtype());
+  if (!dtype.valid()) {
+    return absl::InvalidArgumentError("dtype must be specified");
+  }
+  TENSORSTORE_RETURN_IF_ERROR(ValidateDataType(dtype));
+  metadata->data_type = dtype;
+
+  // Set codecs
+  TENSORSTORE_ASSIGN_OR_RETURN(auto codec_spec,
+                               GetEffectiveCodec(metadata_constraints, schema));
+  if (codec_spec->codecs) {
+    metadata->codecs = *codec_spec->codecs;
+  } else {
+    metadata->codecs.bytes.endianness = endian::little;
+  }
+
+  // Set chunk shape
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto chunk_layout, GetEffectiveChunkLayout(metadata_constraints, schema));
+  metadata->chunk_shape.resize(rank);
+  {
+    Index chunk_origin[kMaxRank];
+    MutableBoxView<> chunk_template(rank, chunk_origin,
+                                    metadata->chunk_shape.data());
+    if (metadata->codecs.sharding) {
+      // The read chunk shape is determined by the "sharding_indexed" codec;
+      // only the write chunk (shard) shape needs to be chosen.
+      TENSORSTORE_RETURN_IF_ERROR(internal::ChooseChunkGrid(
+          chunk_layout.grid_origin(), chunk_layout.write_chunk(), domain.box(),
+          chunk_template));
+    } else {
+      TENSORSTORE_RETURN_IF_ERROR(internal::ChooseReadWriteChunkGrid(
+          chunk_layout, domain.box(), chunk_template));
+    }
+  }
+
+  if (metadata_constraints.chunk_key_encoding) {
+    metadata->chunk_key_encoding = *metadata_constraints.chunk_key_encoding;
+  }
+
+  // Set fill value
+  if (metadata_constraints.fill_value) {
+    metadata->fill_value = *metadata_constraints.fill_value;
+  } else if (auto fill_value = schema.fill_value(); fill_value.valid()) {
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto broadcast_fill_value,
+        tensorstore::BroadcastArray(fill_value, span<const Index>{}),
+        tensorstore::MaybeAnnotateStatus(_, "Invalid fill_value"));
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        metadata->fill_value,
+        tensorstore::MakeCopy(std::move(broadcast_fill_value),
+                              skip_repeated_elements, dtype),
+        tensorstore::MaybeAnnotateStatus(_, "Invalid fill_value"));
+  } else {
+    metadata->fill_value = AllocateArray(span<const Index>{}, c_order,
+                                         value_init, dtype);
+  }
+
+  if (metadata_constraints.attributes) {
+    metadata->attributes = *metadata_constraints.attributes;
+  }
+
+  TENSORSTORE_RETURN_IF_ERROR(ValidateMetadata(*metadata));
+  TENSORSTORE_RETURN_IF_ERROR(ValidateMetadataSchema(*metadata, schema));
+  return metadata;
+}
+
+absl::Status ValidateMetadataSchema(const ZarrMetadata& metadata,
+                                    const Schema& schema) {
+  if (!RankConstraint::EqualOrUnspecified(metadata.rank, schema.rank())) {
+    return absl::FailedPreconditionError(tensorstore::StrCat(
+        "Rank specified by schema (", schema.rank(),
+        ") does not match rank specified by metadata (", metadata.rank, ")"));
+  }
+
+  if (schema.domain().valid()) {
+    TENSORSTORE_RETURN_IF_ERROR(GetEffectiveDomain(
+        metadata.rank, metadata.shape, metadata.dimension_names, schema));
+  }
+
+  if (auto dtype = schema.dtype();
+      !IsPossiblySameDataType(metadata.data_type, dtype)) {
+    return absl::FailedPreconditionError(tensorstore::StrCat(
+        "dtype from metadata (", metadata.data_type,
+        ") does not match dtype in schema (", dtype, ")"));
+  }
+
+  if (auto schema_codec = schema.codec(); schema_codec.valid()) {
+    auto codec = GetCodecFromMetadata(metadata);
+    TENSORSTORE_RETURN_IF_ERROR(
+        codec.MergeFrom(schema_codec),
+        internal::ConvertInvalidArgumentToFailedPrecondition(
+            tensorstore::MaybeAnnotateStatus(
+                _, "codec from metadata does not match codec in schema")));
+  }
+
+  if (schema.chunk_layout().rank() != dynamic_rank) {
+    auto chunk_layout = schema.chunk_layout();
+    TENSORSTORE_RETURN_IF_ERROR(
+        SetChunkLayoutFromMetadata(metadata, chunk_layout),
+        internal::ConvertInvalidArgumentToFailedPrecondition(_));
+    if (chunk_layout.codec_chunk_shape().hard_constraint) {
+      return absl::InvalidArgumentError("codec_chunk_shape not supported");
+    }
+  }
+
+  if (auto schema_fill_value = schema.fill_value();
+      schema_fill_value.valid()) {
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto broadcast_fill_value,
+        tensorstore::BroadcastArray(schema_fill_value, span<const Index>{}));
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto converted_fill_value,
+        tensorstore::MakeCopy(std::move(broadcast_fill_value),
+                              skip_repeated_elements, metadata.data_type));
+    if (!AreArraysSameValueEqual(converted_fill_value, metadata.fill_value)) {
+      return absl::FailedPreconditionError(tensorstore::StrCat(
+          "Invalid fill_value: schema requires fill value of ",
+          converted_fill_value, ", but metadata specifies fill value of ",
+          metadata.fill_value));
+    }
+  }
+
+  if (schema.dimension_units().valid()) {
+    return absl::InvalidArgumentError(
+        "dimension_units not supported by zarr v3 format");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ValidateDataType(DataType dtype) {
+  if (!absl::c_linear_search(kSupportedDataTypes, dtype.id())) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        dtype, " data type is not one of the supported data types: ",
+        GetSupportedDataTypes()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
+
+TENSORSTORE_DEFINE_SERIALIZER_SPECIALIZATION(
+    tensorstore::internal_zarr3::ZarrMetadataConstraints,
+    tensorstore::serialization::JsonBindableSerializer<
+        tensorstore::internal_zarr3::ZarrMetadataConstraints>())
@@ -0,0 +1,237 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TENSORSTORE_DRIVER_ZARR3_METADATA_H_
+#define TENSORSTORE_DRIVER_ZARR3_METADATA_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/array.h"
+#include "tensorstore/chunk_layout.h"
+#include "tensorstore/codec_spec.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/index.h"
+#include "tensorstore/index_space/index_domain.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/schema.h"
+#include "tensorstore/serialization/fwd.h"
+#include "tensorstore/strided_layout.h"
+#include "tensorstore/util/garbage_collection/fwd.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+/// Specifies how chunk grid cell indices are mapped to keys.
+struct ChunkKeyEncoding {
+  enum Kind {
+    /// Keys are of the form `c/0/1/2`, or `c` for rank 0.
+    kDefault,
+    /// Keys are of the form `0.1.2`, or `0` for rank 0.
+    kV2,
+  };
+  Kind kind = kDefault;
+
+  /// Separator between grid cell indices, either `'/'` or `'.'`.
+  char separator = '/';
+
+  friend bool operator==(const ChunkKeyEncoding& a, const ChunkKeyEncoding& b) {
+    return a.kind == b.kind && a.separator == b.separator;
+  }
+  friend bool operator!=(const ChunkKeyEncoding& a, const ChunkKeyEncoding& b) {
+    return !(a == b);
+  }
+
+  TENSORSTORE_DECLARE_JSON_DEFAULT_BINDER(ChunkKeyEncoding,
+                                          internal_json_binding::NoOptions,
+                                          tensorstore::IncludeDefaults)
+};
+
+/// Decoded representation of zarr v3 array metadata, stored as `zarr.json`.
+///
+/// Per the specification:
+/// https://zarr-specs.readthedocs.io/en/latest/v3/core/v3.0.html#array-metadata
+class ZarrMetadata {
+ public:
+  // The following members are common to `ZarrMetadata` and
+  // `ZarrMetadataConstraints`, except that in `ZarrMetadataConstraints` some
+  // are `std::optional`-wrapped.
+
+  /// Length of `shape`, `chunk_shape` and `dimension_names`.
+  DimensionIndex rank = dynamic_rank;
+
+  /// Specifies the current shape of the full array.
+  std::vector<Index> shape;
+
+  DataType data_type;
+
+  /// Specifies the shape of the chunks of the regular chunk grid.  If the
+  /// "sharding_indexed" codec is used, these are the shards.
+  std::vector<Index> chunk_shape;
+
+  ChunkKeyEncoding chunk_key_encoding;
+
+  /// Rank-0 fill value.
+  SharedArray<const void> fill_value;
+
+  ZarrCodecChain codecs;
+
+  ::nlohmann::json::object_t attributes;
+
+  /// Specifies the dimension names; `std::nullopt` indicates an unnamed
+  /// dimension.
+  std::vector<std::optional<std::string>> dimension_names;
+
+  // Derived members computed from `chunk_shape`, `data_type` and `codecs`:
+
+  /// Shape of the chunks that are individually encoded.  Equal to the
+  /// "sharding_indexed" inner chunk shape, if applicable, or `chunk_shape`
+  /// otherwise.
+  std::vector<Index> read_chunk_shape;
+
+  /// Layout of a decoded chunk of shape `read_chunk_shape`.
+  StridedLayout<> read_chunk_layout;
+
+  /// Returns the codec chain used to encode each chunk of shape
+  /// `read_chunk_shape`.
+  const ZarrCodecChain& read_chunk_codecs() const {
+    return codecs.sharding ? codecs.sharding->codecs : codecs;
+  }
+
+  TENSORSTORE_DECLARE_JSON_DEFAULT_BINDER(ZarrMetadata,
+                                          internal_json_binding::NoOptions,
+                                          tensorstore::IncludeDefaults)
+
+  /// Returns a key that differs whenever the chunk encoding differs.
+  std::string GetCompatibilityKey() const;
+};
+
+/// Representation of partial metadata/metadata constraints specified as the
+/// "metadata" member in the DriverSpec.
+class ZarrMetadataConstraints {
+ public:
+  /// Length of `shape`, `chunk_shape` and `dimension_names` if any are
+  /// specified.  If none are specified, equal to `dynamic_rank`.
+  DimensionIndex rank = dynamic_rank;
+
+  std::optional<std::vector<Index>> shape;
+  std::optional<DataType> data_type;
+  std::optional<std::vector<Index>> chunk_shape;
+  std::optional<ChunkKeyEncoding> chunk_key_encoding;
+  std::optional<SharedArray<const void>> fill_value;
+  std::optional<ZarrCodecChain> codecs;
+  std::optional<::nlohmann::json::object_t> attributes;
+  std::optional<std::vector<std::optional<std::string>>> dimension_names;
+
+  TENSORSTORE_DECLARE_JSON_DEFAULT_BINDER(ZarrMetadataConstraints,
+                                          internal_json_binding::NoOptions,
+                                          tensorstore::IncludeDefaults)
+};
+
+class ZarrCodecSpec : public internal::CodecDriverSpec {
+ public:
+  constexpr static char id[] = "zarr3";
+
+  CodecSpec Clone() const final;
+  absl::Status DoMergeFrom(const internal::CodecDriverSpec& other_base) final;
+
+  std::optional<ZarrCodecChain> codecs;
+
+  TENSORSTORE_DECLARE_JSON_DEFAULT_BINDER(ZarrCodecSpec, FromJsonOptions,
+                                          ToJsonOptions,
+                                          ::nlohmann::json::object_t)
+};
+
+/// Validates that `metadata` is consistent with `constraints`.
+absl::Status ValidateMetadata(const ZarrMetadata& metadata,
+                              const ZarrMetadataConstraints& constraints);
+
+/// Converts `metadata_constraints` to a full metadata object.
+///
+/// \error `absl::StatusCode::kInvalidArgument` if any required fields are
+///     unspecified.
+Result<std::shared_ptr<const ZarrMetadata>> GetNewMetadata(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema);
+
+/// Validates that `schema` is compatible with `metadata`.
+absl::Status ValidateMetadataSchema(const ZarrMetadata& metadata,
+                                    const Schema& schema);
+
+/// Returns the combined domain from `metadata_constraints` and `schema`.
+///
+/// If the domain is unspecified, returns a null domain.
+///
+/// \error `absl::StatusCode::kInvalidArgument` if `metadata_constraints` is
+///     inconsistent with `schema`.
+Result<IndexDomain<>> GetEffectiveDomain(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema);
+
+/// Returns the combined chunk layout from `metadata_constraints` and `schema`.
+///
+/// \error `absl::StatusCode::kInvalidArgument` if `metadata_constraints` is
+///     inconsistent with `schema`.
+Result<ChunkLayout> GetEffectiveChunkLayout(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema);
+
+/// Returns the combined codec spec from `metadata_constraints` and `schema`.
+///
+/// \returns Non-null pointer.
+/// \error `absl::StatusCode::kInvalidArgument` if `metadata_constraints` is
+///     inconsistent with `schema`.
+Result<internal::CodecDriverSpec::PtrT<ZarrCodecSpec>> GetEffectiveCodec(
+    const ZarrMetadataConstraints& metadata_constraints, const Schema& schema);
+
+/// Returns the codec from the specified metadata.
+CodecSpec GetCodecFromMetadata(const ZarrMetadata& metadata);
+
+/// Sets chunk layout constraints implied by `metadata`.
+absl::Status SetChunkLayoutFromMetadata(const ZarrMetadata& metadata,
+                                        ChunkLayout& chunk_layout);
+
+/// Returns the storage key, relative to the array path, of the chunk with the
+/// specified grid cell indices.
+std::string EncodeChunkKey(const ChunkKeyEncoding& encoding,
+                           span<const Index> grid_indices);
+
+/// Decodes a chunk of shape `metadata.read_chunk_shape`.
+///
+/// The layout of the returned array is only valid as long as `metadata`.
+Result<SharedArrayView<const void>> DecodeChunk(const ZarrMetadata& metadata,
+                                                absl::Cord buffer);
+
+/// Encodes a chunk of shape `metadata.read_chunk_shape`.
+Result<absl::Cord> EncodeChunk(const ZarrMetadata& metadata,
+                               ArrayView<const void> array);
+
+/// Validates that `dtype` is supported by zarr v3.
+///
+/// \dchecks `dtype.valid()`
+absl::Status ValidateDataType(DataType dtype);
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
+
+TENSORSTORE_DECLARE_SERIALIZER_SPECIALIZATION(
+    tensorstore::internal_zarr3::ZarrMetadataConstraints)
+
+TENSORSTORE_DECLARE_GARBAGE_COLLECTION_NOT_REQUIRED(
+    tensorstore::internal_zarr3::ZarrMetadataConstraints)
+
+#endif  // TENSORSTORE_DRIVER_ZARR3_METADATA_H_
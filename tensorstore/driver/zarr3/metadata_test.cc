@@ -0,0 +1,248 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "tensorstore/driver/zarr3/metadata.h"
+
+#include <stdint.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "tensorstore/array.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/index.h"
+#include "tensorstore/internal/json_binding/gtest.h"
+#include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::dtype_v;
+using ::tensorstore::Index;
+using ::tensorstore::MatchesJson;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal_zarr3::ChunkKeyEncoding;
+using ::tensorstore::internal_zarr3::DecodeChunk;
+using ::tensorstore::internal_zarr3::EncodeChunk;
+using ::tensorstore::internal_zarr3::EncodeChunkKey;
+using ::tensorstore::internal_zarr3::ZarrMetadata;
+using ::tensorstore::internal_zarr3::ZarrMetadataConstraints;
+
+::nlohmann::json GetBasicMetadata() {
+  return {
+      {"zarr_format", 3},
+      {"node_type", "array"},
+      {"shape", {10, 11, 12}},
+      {"data_type", "uint16"},
+      {"chunk_grid",
+       {{"name", "regular"}, {"configuration", {{"chunk_shape", {1, 2, 3}}}}}},
+      {"chunk_key_encoding", {{"name", "default"}}},
+      {"fill_value", 0},
+      {"codecs",
+       {{{"name", "bytes"}, {"configuration", {{"endian", "little"}}}}}},
+      {"attributes", {{"a", "b"}}},
+      {"dimension_names", {"x", nullptr, "z"}},
+  };
+}
+
+TEST(MetadataTest, ParseValid) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata,
+                                   ZarrMetadata::FromJson(GetBasicMetadata()));
+  EXPECT_EQ(3, metadata.rank);
+  EXPECT_THAT(metadata.shape, ::testing::ElementsAre(10, 11, 12));
+  EXPECT_THAT(metadata.chunk_shape, ::testing::ElementsAre(1, 2, 3));
+  EXPECT_THAT(metadata.read_chunk_shape, ::testing::ElementsAre(1, 2, 3));
+  EXPECT_EQ(dtype_v<uint16_t>, metadata.data_type);
+  EXPECT_EQ(tensorstore::MakeScalarArray<uint16_t>(0), metadata.fill_value);
+  EXPECT_THAT(metadata.dimension_names,
+              ::testing::ElementsAre("x", std::nullopt, "z"));
+  EXPECT_EQ(ChunkKeyEncoding::kDefault, metadata.chunk_key_encoding.kind);
+  EXPECT_EQ('/', metadata.chunk_key_encoding.separator);
+  EXPECT_THAT(metadata.ToJson(),
+              ::testing::Optional(MatchesJson([] {
+                auto j = GetBasicMetadata();
+                j["chunk_key_encoding"] = {
+                    {"name", "default"},
+                    {"configuration", {{"separator", "/"}}}};
+                return j;
+              }())));
+}
+
+TEST(MetadataTest, DefaultsForOptionalMembers) {
+  auto j = GetBasicMetadata();
+  j.erase("attributes");
+  j.erase("dimension_names");
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata, ZarrMetadata::FromJson(j));
+  EXPECT_TRUE(metadata.attributes.empty());
+  EXPECT_THAT(metadata.dimension_names,
+              ::testing::ElementsAre(std::nullopt, std::nullopt, std::nullopt));
+}
+
+TEST(MetadataTest, StorageTransformers) {
+  auto j = GetBasicMetadata();
+  j["storage_transformers"] = ::nlohmann::json::array_t();
+  TENSORSTORE_EXPECT_OK(ZarrMetadata::FromJson(j));
+  j["storage_transformers"] = {{{"name", "x"}}};
+  EXPECT_THAT(ZarrMetadata::FromJson(j),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            ".*\"storage_transformers\".*"));
+}
+
+TEST(MetadataTest, InvalidMembers) {
+  for (const auto& [member, value] :
+       std::vector<std::pair<std::string, ::nlohmann::json>>{
+           {"zarr_format", 2},
+           {"node_type", "group"},
+           {"data_type", "string"},
+           {"chunk_grid",
+            {{"name", "irregular"},
+             {"configuration", {{"chunk_shape", {1, 2, 3}}}}}},
+           {"chunk_grid",
+            {{"name", "regular"},
+             {"configuration", {{"chunk_shape", {1, 2}}}}}},
+           {"chunk_key_encoding", {{"name", "other"}}},
+           {"fill_value", 65536},
+           {"dimension_names", {"x"}},
+           {"extra", 1},
+       }) {
+    SCOPED_TRACE(member);
+    auto j = GetBasicMetadata();
+    j[member] = value;
+    EXPECT_THAT(ZarrMetadata::FromJson(j),
+                MatchesStatus(absl::StatusCode::kInvalidArgument));
+  }
+}
+
+TEST(MetadataTest, FillValue) {
+  const auto parse = [](std::string data_type, ::nlohmann::json fill_value) {
+    auto j = GetBasicMetadata();
+    j["data_type"] = data_type;
+    j["fill_value"] = fill_value;
+    if (data_type == "bool" || data_type == "int8" || data_type == "uint8") {
+      j["codecs"] = {{{"name", "bytes"}}};
+    }
+    return ZarrMetadata::FromJson(j);
+  };
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata, parse("bool", true));
+    EXPECT_EQ(tensorstore::MakeScalarArray<bool>(true), metadata.fill_value);
+  }
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata, parse("int8", -128));
+    EXPECT_EQ(tensorstore::MakeScalarArray<int8_t>(-128), metadata.fill_value);
+  }
+  EXPECT_THAT(parse("int8", 128),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata, parse("float32", "NaN"));
+    EXPECT_TRUE(std::isnan(
+        *static_cast<const float*>(metadata.fill_value.data())));
+    EXPECT_EQ("NaN", metadata.ToJson().value()["fill_value"]);
+  }
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata,
+                                     parse("float64", "-Infinity"));
+    EXPECT_EQ(tensorstore::MakeScalarArray<double>(
+                  -std::numeric_limits<double>::infinity()),
+              metadata.fill_value);
+  }
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata,
+                                     parse("complex64", {1.5, "Infinity"}));
+    EXPECT_EQ(tensorstore::MakeScalarArray<tensorstore::complex64_t>(
+                  {1.5, std::numeric_limits<float>::infinity()}),
+              metadata.fill_value);
+    EXPECT_EQ(::nlohmann::json({1.5, "Infinity"}),
+              metadata.ToJson().value()["fill_value"]);
+  }
+  EXPECT_THAT(parse("float32", "nan"),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(MetadataTest, Sharding) {
+  auto j = GetBasicMetadata();
+  j["chunk_grid"]["configuration"]["chunk_shape"] = {2, 4, 6};
+  j["codecs"] = {{{"name", "sharding_indexed"},
+                  {"configuration",
+                   {{"chunk_shape", {1, 2, 3}},
+                    {"codecs",
+                     {{{"name", "bytes"},
+                       {"configuration", {{"endian", "little"}}}}}}}}}};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata, ZarrMetadata::FromJson(j));
+  EXPECT_THAT(metadata.chunk_shape, ::testing::ElementsAre(2, 4, 6));
+  EXPECT_THAT(metadata.read_chunk_shape, ::testing::ElementsAre(1, 2, 3));
+
+  j["chunk_grid"]["configuration"]["chunk_shape"] = {2, 4, 5};
+  EXPECT_THAT(ZarrMetadata::FromJson(j),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            ".*not a multiple of the inner chunk shape.*"));
+}
+
+TEST(MetadataConstraintsTest, FillValueRequiresDataType) {
+  EXPECT_THAT(ZarrMetadataConstraints::FromJson({{"fill_value", 1}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            ".*\"data_type\".*"));
+  TENSORSTORE_EXPECT_OK(ZarrMetadataConstraints::FromJson(
+      {{"fill_value", 1}, {"data_type", "int32"}}));
+}
+
+TEST(MetadataConstraintsTest, JsonRoundTrip) {
+  tensorstore::TestJsonBinderRoundTripJsonOnly<ZarrMetadataConstraints>({
+      ::nlohmann::json::object_t(),
+      {{"shape", {10, 11}}},
+      {{"data_type", "uint8"}, {"fill_value", 3}},
+      {{"chunk_key_encoding",
+        {{"name", "v2"}, {"configuration", {{"separator", "."}}}}}},
+      {{"dimension_names", {"x", nullptr}}},
+  });
+}
+
+TEST(ChunkKeyEncodingTest, EncodeChunkKey) {
+  ChunkKeyEncoding encoding;
+  EXPECT_EQ("c/1/2/3", EncodeChunkKey(encoding, {{1, 2, 3}}));
+  EXPECT_EQ("c", EncodeChunkKey(encoding, {}));
+  encoding.separator = '.';
+  EXPECT_EQ("c.1.2.3", EncodeChunkKey(encoding, {{1, 2, 3}}));
+  encoding.kind = ChunkKeyEncoding::kV2;
+  EXPECT_EQ("1.2.3", EncodeChunkKey(encoding, {{1, 2, 3}}));
+  EXPECT_EQ("0", EncodeChunkKey(encoding, {}));
+}
+
+TEST(ChunkKeyEncodingTest, DefaultSeparator) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto encoding, ChunkKeyEncoding::FromJson({{"name", "v2"}}));
+  EXPECT_EQ('.', encoding.separator);
+  EXPECT_THAT(encoding.ToJson(),
+              ::testing::Optional(MatchesJson(
+                  {{"name", "v2"}, {"configuration", {{"separator", "."}}}})));
+}
+
+TEST(EncodeDecodeChunkTest, RoundTrip) {
+  auto j = GetBasicMetadata();
+  j["codecs"] = {
+      {{"name", "transpose"}, {"configuration", {{"order", {2, 1, 0}}}}},
+      {{"name", "bytes"}, {"configuration", {{"endian", "big"}}}},
+      {{"name", "gzip"}},
+  };
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto metadata, ZarrMetadata::FromJson(j));
+  auto array =
+      tensorstore::MakeArray<uint16_t>({{{1, 2, 3}, {4, 5, 6}}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto encoded, EncodeChunk(metadata, array));
+  EXPECT_THAT(DecodeChunk(metadata, encoded), ::testing::Optional(array));
+}
+
+}  // namespace
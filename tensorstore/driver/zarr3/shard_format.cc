@@ -0,0 +1,194 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "tensorstore/driver/zarr3/shard_format.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/internal/endian.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/index.h"
+#include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+namespace {
+
+void StoreIndexValue(char* dest, uint64_t value, endian e) {
+  if (e == endian::little) {
+    absl::little_endian::Store64(dest, value);
+  } else {
+    absl::big_endian::Store64(dest, value);
+  }
+}
+
+uint64_t LoadIndexValue(const char* src, endian e) {
+  return e == endian::little ? absl::little_endian::Load64(src)
+                             : absl::big_endian::Load64(src);
+}
+
+}  // namespace
+
+Index GetNumChunksPerShard(span<const Index> chunks_per_shard) {
+  Index num_chunks = 1;
+  for (const Index n : chunks_per_shard) num_chunks *= n;
+  return num_chunks;
+}
+
+uint64_t GetShardIndexEncodedSize(const ShardingIndexedCodec& sharding,
+                                  span<const Index> chunks_per_shard) {
+  uint64_t size = GetNumChunksPerShard(chunks_per_shard) * 16;
+  for (const auto& codec : sharding.index_codecs.bytes_to_bytes) {
+    size += *codec->fixed_size_overhead();
+  }
+  return size;
+}
+
+ByteRange GetShardIndexByteRange(const ShardingIndexedCodec& sharding,
+                                 span<const Index> chunks_per_shard,
+                                 uint64_t shard_size) {
+  const uint64_t index_size =
+      GetShardIndexEncodedSize(sharding, chunks_per_shard);
+  if (sharding.index_location == ShardIndexLocation::kStart) {
+    return ByteRange{0, index_size};
+  }
+  return ByteRange{shard_size - index_size, shard_size};
+}
+
+Result<absl::Cord> EncodeShardIndex(const ShardingIndexedCodec& sharding,
+                                    span<const ShardIndexEntry> entries) {
+  const endian e = *sharding.index_codecs.bytes.endianness;
+  internal::FlatCordBuilder buffer(entries.size() * 16);
+  char* p = buffer.data();
+  for (const auto& entry : entries) {
+    StoreIndexValue(p, entry.offset, e);
+    StoreIndexValue(p + 8, entry.length, e);
+    p += 16;
+  }
+  return EncodeBytes(sharding.index_codecs, std::move(buffer).Build(),
+                     /*element_bytes=*/8);
+}
+
+Result<std::vector<ShardIndexEntry>> DecodeShardIndex(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    absl::Cord encoded, std::optional<uint64_t> shard_size) {
+  const Index num_chunks = GetNumChunksPerShard(chunks_per_shard);
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto decoded,
+      DecodeBytes(sharding.index_codecs, std::move(encoded),
+                  /*element_bytes=*/8),
+      absl::DataLossError(
+          tensorstore::StrCat("Error decoding shard index: ", _.message())));
+  if (static_cast<Index>(decoded.size()) != num_chunks * 16) {
+    return absl::DataLossError(tensorstore::StrCat(
+        "Expected shard index of ", num_chunks * 16, " bytes, but received ",
+        decoded.size(), " bytes"));
+  }
+  const endian e = *sharding.index_codecs.bytes.endianness;
+  auto flat = decoded.Flatten();
+  std::vector<ShardIndexEntry> entries(num_chunks);
+  for (Index i = 0; i < num_chunks; ++i) {
+    auto& entry = entries[i];
+    entry.offset = LoadIndexValue(flat.data() + i * 16, e);
+    entry.length = LoadIndexValue(flat.data() + i * 16 + 8, e);
+    if (entry.IsMissing()) continue;
+    if (entry.offset + entry.length < entry.offset ||
+        (shard_size && entry.offset + entry.length > *shard_size)) {
+      return absl::DataLossError(tensorstore::StrCat(
+          "Shard index entry ", i, " with byte range ", entry.AsByteRange(),
+          " is invalid for shard of size ",
+          shard_size ? *shard_size : uint64_t(0)));
+    }
+  }
+  return entries;
+}
+
+Result<std::vector<ShardIndexEntry>> DecodeShardIndexFromFullShard(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    const absl::Cord& shard) {
+  const uint64_t index_size =
+      GetShardIndexEncodedSize(sharding, chunks_per_shard);
+  if (shard.size() < index_size) {
+    return absl::DataLossError(tensorstore::StrCat(
+        "Shard of ", shard.size(), " bytes is too small to contain index of ",
+        index_size, " bytes"));
+  }
+  return DecodeShardIndex(
+      sharding, chunks_per_shard,
+      internal::GetSubCord(
+          shard,
+          GetShardIndexByteRange(sharding, chunks_per_shard, shard.size())),
+      shard.size());
+}
+
+Result<std::vector<std::optional<absl::Cord>>> DecodeShard(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    const absl::Cord& shard) {
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto entries,
+      DecodeShardIndexFromFullShard(sharding, chunks_per_shard, shard));
+  std::vector<std::optional<absl::Cord>> chunks(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].IsMissing()) continue;
+    chunks[i] = internal::GetSubCord(shard, entries[i].AsByteRange());
+  }
+  return chunks;
+}
+
+Result<std::optional<absl::Cord>> EncodeShard(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    span<const std::optional<absl::Cord>> chunks) {
+  assert(static_cast<Index>(chunks.size()) ==
+         GetNumChunksPerShard(chunks_per_shard));
+  const uint64_t index_size =
+      GetShardIndexEncodedSize(sharding, chunks_per_shard);
+  uint64_t offset =
+      sharding.index_location == ShardIndexLocation::kStart ? index_size : 0;
+  std::vector<ShardIndexEntry> entries(chunks.size());
+  bool any_present = false;
+  absl::Cord data;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    if (!chunks[i]) continue;
+    any_present = true;
+    entries[i].offset = offset;
+    entries[i].length = chunks[i]->size();
+    offset += chunks[i]->size();
+    data.Append(*chunks[i]);
+  }
+  if (!any_present) return std::nullopt;
+  TENSORSTORE_ASSIGN_OR_RETURN(auto index,
+                               EncodeShardIndex(sharding, entries));
+  assert(index.size() == index_size);
+  if (sharding.index_location == ShardIndexLocation::kStart) {
+    index.Append(std::move(data));
+    return index;
+  }
+  data.Append(std::move(index));
+  return data;
+}
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
@@ -0,0 +1,115 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TENSORSTORE_DRIVER_ZARR3_SHARD_FORMAT_H_
+#define TENSORSTORE_DRIVER_ZARR3_SHARD_FORMAT_H_
+
+/// \file
+///
+/// Encoding and decoding of shards written by the "sharding_indexed" codec.
+///
+/// A shard consists of the encoded inner chunks, concatenated in an arbitrary
+/// order, and a shard index stored at either the start or end of the shard.
+/// The shard index is a `uint64` array of shape `chunks_per_shard + [2]`,
+/// where `[..., 0]` is the byte offset of the inner chunk within the shard and
+/// `[..., 1]` is its encoded length.  Missing inner chunks are indicated by
+/// both values equal to `2^64-1`.  The index array is encoded using the
+/// `index_codecs`, which are required to have a fixed encoded size.
+
+#include <stdint.h>
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "absl/strings/cord.h"
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/index.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+/// Location of an inner chunk within a shard.
+struct ShardIndexEntry {
+  constexpr static uint64_t kMissing = std::numeric_limits<uint64_t>::max();
+
+  uint64_t offset = kMissing;
+  uint64_t length = kMissing;
+
+  /// Returns `true` if the inner chunk is not present.
+  bool IsMissing() const { return offset == kMissing && length == kMissing; }
+
+  ByteRange AsByteRange() const {
+    return ByteRange{offset, offset + length};
+  }
+};
+
+/// Returns the total number of inner chunks in a shard.
+Index GetNumChunksPerShard(span<const Index> chunks_per_shard);
+
+/// Returns the encoded size in bytes of the shard index.
+///
+/// \pre `ValidateCodecChain` succeeded for the codec containing `sharding`.
+uint64_t GetShardIndexEncodedSize(const ShardingIndexedCodec& sharding,
+                                  span<const Index> chunks_per_shard);
+
+/// Returns the byte range of the shard index within a shard of the specified
+/// total size.
+ByteRange GetShardIndexByteRange(const ShardingIndexedCodec& sharding,
+                                 span<const Index> chunks_per_shard,
+                                 uint64_t shard_size);
+
+/// Encodes a shard index.
+Result<absl::Cord> EncodeShardIndex(const ShardingIndexedCodec& sharding,
+                                    span<const ShardIndexEntry> entries);
+
+/// Decodes a shard index.
+///
+/// \param shard_size If specified, the total size of the shard, used to
+///     validate the byte ranges of the entries.
+/// \error `absl::StatusCode::kDataLoss` if `encoded` is invalid.
+Result<std::vector<ShardIndexEntry>> DecodeShardIndex(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    absl::Cord encoded, std::optional<uint64_t> shard_size = std::nullopt);
+
+/// Decodes the shard index stored in a complete shard.
+///
+/// \error `absl::StatusCode::kDataLoss` if `shard` is invalid.
+Result<std::vector<ShardIndexEntry>> DecodeShardIndexFromFullShard(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    const absl::Cord& shard);
+
+/// Splits a complete shard into its encoded inner chunks, in C order over
+/// `chunks_per_shard`.
+///
+/// \error `absl::StatusCode::kDataLoss` if `shard` is invalid.
+Result<std::vector<std::optional<absl::Cord>>> DecodeShard(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    const absl::Cord& shard);
+
+/// Encodes a shard from its encoded inner chunks, specified in C order over
+/// `chunks_per_shard`.
+///
+/// \returns The encoded shard, or `std::nullopt` if all inner chunks are
+///     missing, in which case the shard should be deleted.
+Result<std::optional<absl::Cord>> EncodeShard(
+    const ShardingIndexedCodec& sharding, span<const Index> chunks_per_shard,
+    span<const std::optional<absl::Cord>> chunks);
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_DRIVER_ZARR3_SHARD_FORMAT_H_
@@ -0,0 +1,101 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "tensorstore/driver/zarr3/shard_format.h"
+
+#include <stdint.h>
+
+#include <optional>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/index.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::Index;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal_zarr3::DecodeShard;
+using ::tensorstore::internal_zarr3::DecodeShardIndexFromFullShard;
+using ::tensorstore::internal_zarr3::EncodeShard;
+using ::tensorstore::internal_zarr3::GetShardIndexEncodedSize;
+using ::tensorstore::internal_zarr3::ShardingIndexedCodec;
+using ::tensorstore::internal_zarr3::ZarrCodecChain;
+
+ShardingIndexedCodec GetSharding(std::string index_location) {
+  auto chain = ZarrCodecChain::FromJson(
+                   {{{"name", "sharding_indexed"},
+                     {"configuration",
+                      {{"chunk_shape", {1, 1}},
+                       {"codecs", {{{"name", "bytes"}}}},
+                       {"index_location", index_location}}}}})
+                   .value();
+  return *chain.sharding;
+}
+
+class ShardFormatTest : public ::testing::TestWithParam<std::string> {};
+
+INSTANTIATE_TEST_SUITE_P(IndexLocation, ShardFormatTest,
+                         ::testing::Values("start", "end"));
+
+TEST_P(ShardFormatTest, RoundTrip) {
+  auto sharding = GetSharding(GetParam());
+  const Index chunks_per_shard[] = {2, 2};
+  // 4 entries of 16 bytes, plus the 4-byte crc32c checksum.
+  EXPECT_EQ(68, GetShardIndexEncodedSize(sharding, chunks_per_shard));
+  std::vector<std::optional<absl::Cord>> chunks{
+      absl::Cord("abc"), std::nullopt, absl::Cord("de"), absl::Cord("")};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto shard, EncodeShard(sharding, chunks_per_shard, chunks));
+  ASSERT_TRUE(shard);
+  EXPECT_EQ(68 + 5, shard->size());
+  EXPECT_THAT(DecodeShard(sharding, chunks_per_shard, *shard),
+              ::testing::Optional(::testing::ElementsAreArray(chunks)));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto entries,
+      DecodeShardIndexFromFullShard(sharding, chunks_per_shard, *shard));
+  ASSERT_EQ(4, entries.size());
+  EXPECT_FALSE(entries[0].IsMissing());
+  EXPECT_TRUE(entries[1].IsMissing());
+  EXPECT_EQ("de", shard->Subcord(entries[2].offset, entries[2].length));
+}
+
+TEST_P(ShardFormatTest, AllMissing) {
+  auto sharding = GetSharding(GetParam());
+  const Index chunks_per_shard[] = {1, 2};
+  std::vector<std::optional<absl::Cord>> chunks(2);
+  EXPECT_THAT(EncodeShard(sharding, chunks_per_shard, chunks),
+              ::testing::Optional(std::nullopt));
+}
+
+TEST_P(ShardFormatTest, Corrupt) {
+  auto sharding = GetSharding(GetParam());
+  const Index chunks_per_shard[] = {1, 1};
+  std::vector<std::optional<absl::Cord>> chunks{absl::Cord("abc")};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto shard, EncodeShard(sharding, chunks_per_shard, chunks));
+  ASSERT_TRUE(shard);
+  std::string corrupt(*shard);
+  corrupt[GetParam() == "start" ? 0 : 3] ^= 1;
+  EXPECT_THAT(DecodeShard(sharding, chunks_per_shard, absl::Cord(corrupt)),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+  EXPECT_THAT(DecodeShard(sharding, chunks_per_shard, absl::Cord("abc")),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+}
+
+}  // namespace
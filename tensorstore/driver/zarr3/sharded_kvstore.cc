@@ -0,0 +1,848 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "tensorstore/driver/zarr3/sharded_kvstore.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/endian.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/driver/zarr3/shard_format.h"
+#include "tensorstore/internal/cache/async_cache.h"
+#include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/cache/kvs_backed_cache.h"
+#include "tensorstore/internal/estimate_heap_usage/estimate_heap_usage.h"
+#include "tensorstore/internal/estimate_heap_usage/std_optional.h"  // iwyu: keep
+#include "tensorstore/internal/estimate_heap_usage/std_vector.h"  // iwyu: keep
+#include "tensorstore/internal/mutex.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/transaction.h"
+#include "tensorstore/util/execution/execution.h"
+#include "tensorstore/util/execution/result_sender.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+namespace {
+
+using ::tensorstore::internal::IntrusivePtr;
+
+/// Parameters shared by `ShardIndexKeyValueStore`, `ShardIndexCache` and
+/// `ShardedKeyValueStoreWriteCache`.
+struct ShardingParameters {
+  std::shared_ptr<const ShardingIndexedCodec> sharding;
+  std::vector<Index> chunks_per_shard;
+  GetShardKeyFunction get_shard_key;
+
+  DimensionIndex rank() const { return chunks_per_shard.size(); }
+
+  /// Returns the key within the base kvstore of the shard with the specified
+  /// cache entry key, which is equal to `InnerChunkGridIndicesToKey` applied to
+  /// the shard grid cell indices.
+  std::string GetShardKey(std::string_view shard_entry_key) const {
+    Index shard_grid_indices[kMaxRank];
+    [[maybe_unused]] bool valid = KeyToInnerChunkGridIndices(
+        shard_entry_key, span(shard_grid_indices, rank()));
+    assert(valid);
+    return get_shard_key(span(shard_grid_indices, rank()));
+  }
+};
+
+/// Identifies the shard containing an inner chunk, and the position of the
+/// inner chunk within the shard in C order.
+struct ShardAndPosition {
+  std::string shard_entry_key;
+  Index position;
+};
+
+Result<ShardAndPosition> GetShardAndPosition(const ShardingParameters& params,
+                                             std::string_view key) {
+  const DimensionIndex rank = params.rank();
+  Index grid_indices[kMaxRank];
+  if (!KeyToInnerChunkGridIndices(key, span(grid_indices, rank))) {
+    return absl::InvalidArgumentError(
+        tensorstore::StrCat("Invalid key: ", tensorstore::QuoteString(key)));
+  }
+  Index shard_grid_indices[kMaxRank];
+  Index position = 0;
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    const Index n = params.chunks_per_shard[i];
+    shard_grid_indices[i] = grid_indices[i] / n;
+    position = position * n + grid_indices[i] % n;
+  }
+  return ShardAndPosition{
+      InnerChunkGridIndicesToKey(span(shard_grid_indices, rank)), position};
+}
+
+std::string PositionToKey(Index position) {
+  std::string key;
+  key.resize(sizeof(uint64_t));
+  absl::big_endian::Store64(key.data(), position);
+  return key;
+}
+
+Index KeyToPosition(std::string_view key) {
+  assert(key.size() == sizeof(uint64_t));
+  return absl::big_endian::Load64(key.data());
+}
+
+/// Read-only KeyValueStore for retrieving an encoded shard index.
+///
+/// The key is the cache entry key of the shard, as returned by
+/// `GetShardAndPosition`.
+///
+/// This is used by `ShardIndexCache`, in order to take advantage of
+/// `KvsBackedCache` to define it.
+class ShardIndexKeyValueStore : public kvstore::Driver {
+ public:
+  explicit ShardIndexKeyValueStore(
+      kvstore::DriverPtr base, Executor executor,
+      std::shared_ptr<const ShardingParameters> params)
+      : base_(std::move(base)),
+        executor_(std::move(executor)),
+        params_(std::move(params)) {}
+
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    if (key.size() != params_->rank() * sizeof(uint64_t)) {
+      return absl::InvalidArgumentError("Key does not specify a shard");
+    }
+    if (options.byte_range != OptionalByteRangeRequest()) {
+      // Byte range requests are not useful for shard indices.
+      return absl::InvalidArgumentError("Byte ranges not supported");
+    }
+    const auto& sharding = *params_->sharding;
+    const uint64_t index_size =
+        GetShardIndexEncodedSize(sharding, params_->chunks_per_shard);
+    auto shard_key = params_->GetShardKey(key);
+    if (sharding.index_location == ShardIndexLocation::kStart) {
+      options.byte_range = ByteRange{0, index_size};
+      return base_->Read(std::move(shard_key), std::move(options));
+    }
+    // Byte ranges relative to the end of the value are not supported by
+    // `kvstore::Driver`, so the entire shard must be read.
+    return MapFutureValue(
+        InlineExecutor{},
+        [index_size](kvstore::ReadResult& r) -> Result<kvstore::ReadResult> {
+          if (!r.has_value()) return std::move(r);
+          if (r.value.size() < index_size) {
+            return absl::FailedPreconditionError(tensorstore::StrCat(
+                "Shard of ", r.value.size(),
+                " bytes is too small to contain index of ", index_size,
+                " bytes"));
+          }
+          r.value = r.value.Subcord(r.value.size() - index_size, index_size);
+          return std::move(r);
+        },
+        base_->Read(std::move(shard_key), std::move(options)));
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    if (key.size() != params_->rank() * sizeof(uint64_t)) {
+      return tensorstore::StrCat("invalid key ", tensorstore::QuoteString(key));
+    }
+    return tensorstore::StrCat("shard index in ",
+                               base_->DescribeKey(params_->GetShardKey(key)));
+  }
+
+  void GarbageCollectionVisit(
+      garbage_collection::GarbageCollectionVisitor& visitor) const final {
+    // No-op
+  }
+
+  kvstore::Driver* base() { return base_.get(); }
+  const Executor& executor() const { return executor_; }
+  const std::shared_ptr<const ShardingParameters>& params() const {
+    return params_;
+  }
+
+ private:
+  kvstore::DriverPtr base_;
+  Executor executor_;
+  std::shared_ptr<const ShardingParameters> params_;
+};
+
+/// Caches decoded shard indices.
+///
+/// Each cache entry corresponds to a shard; the entry key is the shard entry
+/// key returned by `GetShardAndPosition`.
+///
+/// This cache is only used for reading.
+class ShardIndexCache
+    : public internal::KvsBackedCache<ShardIndexCache, internal::AsyncCache> {
+  using Base = internal::KvsBackedCache<ShardIndexCache, internal::AsyncCache>;
+
+ public:
+  using ReadData = std::vector<ShardIndexEntry>;
+
+  class Entry : public Base::Entry {
+   public:
+    using OwningCache = ShardIndexCache;
+
+    size_t ComputeReadDataSizeInBytes(const void* read_data) override {
+      return internal::EstimateHeapUsage(
+          *static_cast<const ReadData*>(read_data));
+    }
+
+    void DoDecode(std::optional<absl::Cord> value,
+                  DecodeReceiver receiver) override {
+      GetOwningCache(*this).executor()(
+          [this, value = std::move(value),
+           receiver = std::move(receiver)]() mutable {
+            std::shared_ptr<ReadData> read_data;
+            if (value) {
+              const auto& params = GetOwningCache(*this).params();
+              TENSORSTORE_ASSIGN_OR_RETURN(
+                  auto entries,
+                  DecodeShardIndex(*params.sharding, params.chunks_per_shard,
+                                   *std::move(value)),
+                  static_cast<void>(execution::set_error(receiver, _)));
+              read_data = std::make_shared<ReadData>(std::move(entries));
+            }
+            execution::set_value(receiver, std::move(read_data));
+          });
+    }
+  };
+
+  Entry* DoAllocateEntry() final { return new Entry; }
+  size_t DoGetSizeofEntry() final { return sizeof(Entry); }
+  TransactionNode* DoAllocateTransactionNode(AsyncCache::Entry& entry) final {
+    return new TransactionNode(static_cast<Entry&>(entry));
+  }
+
+  explicit ShardIndexCache(kvstore::DriverPtr base_kvstore, Executor executor,
+                           std::shared_ptr<const ShardingParameters> params)
+      : Base(kvstore::DriverPtr(new ShardIndexKeyValueStore(
+            std::move(base_kvstore), std::move(executor), std::move(params)))) {
+  }
+
+  ShardIndexKeyValueStore* kvstore_driver() {
+    return static_cast<ShardIndexKeyValueStore*>(this->Base::kvstore_driver());
+  }
+
+  const ShardingParameters& params() { return *kvstore_driver()->params(); }
+  kvstore::Driver* base_kvstore_driver() { return kvstore_driver()->base(); }
+  const Executor& executor() { return kvstore_driver()->executor(); }
+};
+
+/// Cache used to buffer writes to the KeyValueStore.
+///
+/// Each cache entry corresponds to a shard; the entry key is the shard entry
+/// key returned by `GetShardAndPosition`.
+///
+/// This cache is used only for writing, not for reading.  However, in order to
+/// update existing non-empty shards, it does read the full contents of the
+/// existing shard and store it within the cache entry.  This data is discarded
+/// once writeback completes.
+class ShardedKeyValueStoreWriteCache
+    : public internal::KvsBackedCache<ShardedKeyValueStoreWriteCache,
+                                      internal::AsyncCache> {
+  using Base = internal::KvsBackedCache<ShardedKeyValueStoreWriteCache,
+                                        internal::AsyncCache>;
+
+ public:
+  /// Encoded inner chunks, in C order over the chunks of the shard.
+  using ReadData = std::vector<std::optional<absl::Cord>>;
+
+  class Entry : public Base::Entry {
+   public:
+    using OwningCache = ShardedKeyValueStoreWriteCache;
+
+    size_t ComputeReadDataSizeInBytes(const void* data) override {
+      return internal::EstimateHeapUsage(*static_cast<const ReadData*>(data));
+    }
+
+    void DoDecode(std::optional<absl::Cord> value,
+                  DecodeReceiver receiver) override {
+      GetOwningCache(*this).executor()(
+          [this, value = std::move(value),
+           receiver = std::move(receiver)]() mutable {
+            const auto& params = GetOwningCache(*this).params();
+            ReadData chunks;
+            if (value) {
+              TENSORSTORE_ASSIGN_OR_RETURN(
+                  chunks,
+                  DecodeShard(*params.sharding, params.chunks_per_shard,
+                              *value),
+                  static_cast<void>(execution::set_error(receiver, _)));
+            } else {
+              chunks.resize(GetNumChunksPerShard(params.chunks_per_shard));
+            }
+            execution::set_value(receiver,
+                                 std::make_shared<ReadData>(std::move(chunks)));
+          });
+    }
+
+    void DoEncode(std::shared_ptr<const ReadData> data,
+                  EncodeReceiver receiver) override {
+      // Can call `EncodeShard` synchronously without using our executor since
+      // `DoEncode` is already guaranteed to be called from our executor.
+      const auto& params = GetOwningCache(*this).params();
+      TENSORSTORE_ASSIGN_OR_RETURN(
+          auto encoded,
+          EncodeShard(*params.sharding, params.chunks_per_shard, *data),
+          static_cast<void>(execution::set_error(receiver, _)));
+      execution::set_value(receiver, std::move(encoded));
+    }
+
+    std::string GetKeyValueStoreKey() override {
+      return GetOwningCache(*this).params().GetShardKey(key());
+    }
+  };
+
+  class TransactionNode : public Base::TransactionNode,
+                          public internal_kvstore::AtomicMultiPhaseMutation {
+   public:
+    using OwningCache = ShardedKeyValueStoreWriteCache;
+    using Base::TransactionNode::TransactionNode;
+
+    absl::Mutex& mutex() override { return this->mutex_; }
+
+    void PhaseCommitDone(size_t next_phase) override {}
+
+    internal::TransactionState::Node& GetTransactionNode() override {
+      return *this;
+    }
+
+    void Abort() override {
+      this->AbortRemainingPhases();
+      Base::TransactionNode::Abort();
+    }
+
+    std::string DescribeKey(std::string_view key) override {
+      auto& entry = GetOwningEntry(*this);
+      auto& cache = GetOwningCache(entry);
+      return tensorstore::StrCat(
+          "inner chunk ", KeyToPosition(key), " in ",
+          cache.kvstore_driver()->DescribeKey(entry.GetKeyValueStoreKey()));
+    }
+
+    void DoApply(ApplyOptions options, ApplyReceiver receiver) override;
+    void AllEntriesDone(
+        internal_kvstore::SinglePhaseMutation& single_phase_mutation) override;
+    void RecordEntryWritebackError(
+        internal_kvstore::ReadModifyWriteEntry& entry,
+        absl::Status error) override {
+      absl::MutexLock lock(&mutex_);
+      if (apply_status_.ok()) {
+        apply_status_ = std::move(error);
+      }
+    }
+
+    void Revoke() override {
+      Base::TransactionNode::Revoke();
+      { UniqueWriterLock(*this); }
+      // At this point, no new entries may be added and we can safely traverse
+      // the list of entries without a lock.
+      this->RevokeAllEntries();
+    }
+
+    void WritebackSuccess(ReadState&& read_state) override;
+    void WritebackError() override;
+
+    void InvalidateReadState() override;
+
+    bool MultiPhaseReadsCommitted() override { return this->reads_committed_; }
+
+    /// Handles transactional read requests for single inner chunks.
+    ///
+    /// Always reads the full shard, and then extracts the individual inner
+    /// chunk within it.
+    void Read(
+        internal_kvstore::ReadModifyWriteEntry& entry,
+        kvstore::ReadModifyWriteTarget::TransactionalReadOptions&& options,
+        kvstore::ReadModifyWriteTarget::ReadReceiver&& receiver) override {
+      this->AsyncCache::TransactionNode::Read(options.staleness_bound)
+          .ExecuteWhenReady(WithExecutor(
+              GetOwningCache(*this).executor(),
+              [&entry, if_not_equal = std::move(options.if_not_equal),
+               receiver = std::move(receiver)](
+                  ReadyFuture<const void> future) mutable {
+                if (!future.result().ok()) {
+                  execution::set_error(receiver, future.result().status());
+                  return;
+                }
+                execution::submit(HandleShardReadSuccess(entry, if_not_equal),
+                                  receiver);
+              }));
+    }
+
+    /// Called asynchronously from `Read` when the full shard is ready.
+    static Result<kvstore::ReadResult> HandleShardReadSuccess(
+        internal_kvstore::ReadModifyWriteEntry& entry,
+        const StorageGeneration& if_not_equal) {
+      auto& self = static_cast<TransactionNode&>(entry.multi_phase());
+      kvstore::ReadResult read_result;
+      std::shared_ptr<const ReadData> chunks;
+      {
+        AsyncCache::ReadLock<ReadData> lock{self};
+        read_result.stamp = lock.stamp();
+        chunks = lock.shared_data();
+      }
+      if (!StorageGeneration::IsUnknown(read_result.stamp.generation) &&
+          read_result.stamp.generation == if_not_equal) {
+        read_result.state = kvstore::ReadResult::kUnspecified;
+      } else {
+        const auto& chunk = (*chunks)[KeyToPosition(entry.key_)];
+        if (!chunk) {
+          read_result.state = kvstore::ReadResult::kMissing;
+        } else {
+          read_result.state = kvstore::ReadResult::kValue;
+          read_result.value = *chunk;
+        }
+        if (StorageGeneration::IsDirty(read_result.stamp.generation)) {
+          // Add layer to generation in order to make it possible to
+          // distinguish:
+          //
+          // 1. the shard being modified by a predecessor
+          //    `ReadModifyWrite` operation on the underlying
+          //    KeyValueStore.
+          //
+          // 2. the inner chunk being modified by a `ReadModifyWrite`
+          //    operation attached to this transaction node.
+          read_result.stamp.generation = StorageGeneration::AddLayer(
+              std::move(read_result.stamp.generation));
+        }
+      }
+      return read_result;
+    }
+
+    absl::Time apply_staleness_bound_;
+    ApplyReceiver apply_receiver_;
+    absl::Status apply_status_;
+  };
+
+  Entry* DoAllocateEntry() final { return new Entry; }
+  size_t DoGetSizeofEntry() final { return sizeof(Entry); }
+  TransactionNode* DoAllocateTransactionNode(AsyncCache::Entry& entry) final {
+    return new TransactionNode(static_cast<Entry&>(entry));
+  }
+
+  explicit ShardedKeyValueStoreWriteCache(
+      internal::CachePtr<ShardIndexCache> shard_index_cache)
+      : Base(kvstore::DriverPtr(shard_index_cache->base_kvstore_driver())),
+        shard_index_cache_(std::move(shard_index_cache)) {}
+
+  const ShardingParameters& params() const {
+    return shard_index_cache_->params();
+  }
+
+  const Executor& executor() const { return shard_index_cache_->executor(); }
+
+  internal::CachePtr<ShardIndexCache> shard_index_cache_;
+};
+
+void ShardedKeyValueStoreWriteCache::TransactionNode::InvalidateReadState() {
+  Base::TransactionNode::InvalidateReadState();
+  internal_kvstore::InvalidateReadState(phases_);
+}
+
+void ShardedKeyValueStoreWriteCache::TransactionNode::WritebackSuccess(
+    ReadState&& read_state) {
+  for (auto& entry : phases_.entries_) {
+    internal_kvstore::WritebackSuccess(
+        static_cast<internal_kvstore::ReadModifyWriteEntry&>(entry),
+        read_state.stamp);
+  }
+  internal_kvstore::DestroyPhaseEntries(phases_);
+  Base::TransactionNode::WritebackSuccess(std::move(read_state));
+}
+
+void ShardedKeyValueStoreWriteCache::TransactionNode::WritebackError() {
+  internal_kvstore::WritebackError(phases_);
+  internal_kvstore::DestroyPhaseEntries(phases_);
+  Base::TransactionNode::WritebackError();
+}
+
+void StartApply(ShardedKeyValueStoreWriteCache::TransactionNode& node) {
+  RetryAtomicWriteback(node.phases_, node.apply_staleness_bound_);
+}
+
+/// Attempts to compute the new shard state that merges any mutations into the
+/// existing state.
+///
+/// If all conditional mutations are based on a consistent existing state
+/// generation, sends the new state to `node.apply_receiver_`.  Otherwise, calls
+/// `StartApply` to retry with an updated existing state.
+void MergeForWriteback(ShardedKeyValueStoreWriteCache::TransactionNode& node,
+                       bool conditional) {
+  using ReadData = ShardedKeyValueStoreWriteCache::ReadData;
+  TimestampedStorageGeneration stamp;
+  ReadData chunks;
+  if (conditional) {
+    // The new shard state depends on the existing shard state.  Additionally,
+    // any conditional mutations must be consistent with `stamp.generation`.
+    auto lock = internal::AsyncCache::ReadLock<ReadData>{node};
+    stamp = lock.stamp();
+    chunks = *lock.data();
+  } else {
+    // The new shard state is guaranteed not to depend on the existing shard
+    // state.
+    stamp = TimestampedStorageGeneration::Unconditional();
+    chunks.resize(
+        GetNumChunksPerShard(GetOwningCache(node).params().chunks_per_shard));
+  }
+
+  // Indicates that the new shard state is not identical to the existing shard
+  // state.
+  bool changed = false;
+  for (auto& entry : node.phases_.entries_) {
+    auto& buffered_entry =
+        static_cast<internal_kvstore::AtomicMultiPhaseMutation::
+                        BufferedReadModifyWriteEntry&>(entry);
+    if (StorageGeneration::IsConditional(
+            buffered_entry.read_result_.stamp.generation) &&
+        StorageGeneration::Clean(
+            buffered_entry.read_result_.stamp.generation) !=
+            StorageGeneration::Clean(stamp.generation)) {
+      // This mutation is conditional, and is inconsistent with a prior
+      // conditional mutation or with the existing shard.  Retry, requesting
+      // that all mutations be based on a new up-to-date existing shard
+      // generation.
+      node.apply_staleness_bound_ = absl::Now();
+      StartApply(node);
+      return;
+    }
+    if (buffered_entry.read_result_.state ==
+            kvstore::ReadResult::kUnspecified ||
+        !StorageGeneration::IsInnerLayerDirty(
+            buffered_entry.read_result_.stamp.generation)) {
+      // This is a no-op mutation; ignore it, which has the effect of retaining
+      // the existing inner chunk, if present.
+      continue;
+    }
+    auto& chunk = chunks[KeyToPosition(buffered_entry.key_)];
+    if (buffered_entry.read_result_.state == kvstore::ReadResult::kValue) {
+      chunk = buffered_entry.read_result_.value;
+    } else {
+      chunk = std::nullopt;
+    }
+    changed = true;
+  }
+  internal::AsyncCache::ReadState update;
+  update.stamp = std::move(stamp);
+  if (changed) {
+    update.stamp.generation.MarkDirty();
+  }
+  update.data = std::make_shared<ReadData>(std::move(chunks));
+  execution::set_value(std::exchange(node.apply_receiver_, {}),
+                       std::move(update));
+}
+
+void ShardedKeyValueStoreWriteCache::TransactionNode::DoApply(
+    ApplyOptions options, ApplyReceiver receiver) {
+  apply_receiver_ = std::move(receiver);
+  apply_staleness_bound_ = options.staleness_bound;
+  apply_status_ = absl::Status();
+
+  GetOwningCache(*this).executor()([this] { StartApply(*this); });
+}
+
+void ShardedKeyValueStoreWriteCache::TransactionNode::AllEntriesDone(
+    internal_kvstore::SinglePhaseMutation& single_phase_mutation) {
+  if (!apply_status_.ok()) {
+    execution::set_error(std::exchange(apply_receiver_, {}),
+                         std::exchange(apply_status_, {}));
+    return;
+  }
+  auto& self = *this;
+  GetOwningCache(*this).executor()([&self] {
+    TimestampedStorageGeneration stamp;
+    bool mismatch = false;
+
+    Index num_chunks = 0;
+
+    // Determine if the writeback result depends on the existing shard, and if
+    // all inner chunks are conditioned on the same generation.
+    for (auto& entry : self.phases_.entries_) {
+      auto& buffered_entry =
+          static_cast<AtomicMultiPhaseMutation::BufferedReadModifyWriteEntry&>(
+              entry);
+      auto& entry_stamp = buffered_entry.read_result_.stamp;
+      ++num_chunks;
+      if (StorageGeneration::IsConditional(entry_stamp.generation)) {
+        if (!StorageGeneration::IsUnknown(stamp.generation) &&
+            StorageGeneration::Clean(stamp.generation) !=
+                StorageGeneration::Clean(entry_stamp.generation)) {
+          mismatch = true;
+          break;
+        } else {
+          stamp = entry_stamp;
+        }
+      }
+    }
+
+    if (mismatch) {
+      self.apply_staleness_bound_ = absl::Now();
+      StartApply(self);
+      return;
+    }
+    // If every inner chunk of the shard is overwritten unconditionally, the
+    // existing shard need not be read.
+    if (!StorageGeneration::IsUnknown(stamp.generation) ||
+        num_chunks != GetNumChunksPerShard(
+                          GetOwningCache(self).params().chunks_per_shard)) {
+      self.internal::AsyncCache::TransactionNode::Read(
+              self.apply_staleness_bound_)
+          .ExecuteWhenReady([&self](ReadyFuture<const void> future) {
+            if (!future.result().ok()) {
+              execution::set_error(std::exchange(self.apply_receiver_, {}),
+                                   future.result().status());
+              return;
+            }
+            GetOwningCache(self).executor()(
+                [&self] { MergeForWriteback(self, /*conditional=*/true); });
+          });
+      return;
+    }
+    MergeForWriteback(self, /*conditional=*/false);
+  });
+}
+
+/// Asynchronous callback invoked (indirectly) from `ShardedKeyValueStore::Read`
+/// when the cache entry for a given shard index is ready.
+struct ShardIndexCacheEntryReadyCallback {
+  using ReadResult = kvstore::ReadResult;
+  using ReadOptions = kvstore::ReadOptions;
+
+  internal::PinnedCacheEntry<ShardIndexCache> entry_;
+  Index position_;
+  ReadOptions options_;
+  void operator()(Promise<ReadResult> promise, ReadyFuture<const void>) {
+    std::optional<ByteRange> byte_range;
+    TimestampedStorageGeneration stamp;
+    kvstore::ReadResult::State state;
+    {
+      auto lock = internal::AsyncCache::ReadLock<ShardIndexCache::ReadData>(
+          *entry_);
+      stamp = lock.stamp();
+      if (!StorageGeneration::IsNoValue(stamp.generation) &&
+          (options_.if_not_equal == stamp.generation ||
+           (!StorageGeneration::IsUnknown(options_.if_equal) &&
+            options_.if_equal != stamp.generation))) {
+        state = kvstore::ReadResult::kUnspecified;
+      } else {
+        state = kvstore::ReadResult::kMissing;
+        if (lock.data() && !(*lock.data())[position_].IsMissing()) {
+          byte_range = (*lock.data())[position_].AsByteRange();
+        }
+      }
+    }
+    if (!byte_range) {
+      promise.SetResult(ReadResult{state, {}, std::move(stamp)});
+      return;
+    }
+    assert(!StorageGeneration::IsUnknown(stamp.generation));
+    auto& cache = GetOwningCache(*entry_);
+    ReadOptions kvs_read_options;
+    kvs_read_options.if_equal = stamp.generation;
+    kvs_read_options.staleness_bound = options_.staleness_bound;
+    // Reads of inner chunks within the same shard are coalesced by the base
+    // kvstore if it supports batching.
+    kvs_read_options.batch = std::exchange(options_.batch, no_batch);
+    // The inner chunks are stored without any additional encoding, so the
+    // requested byte range can be applied directly.
+    if (auto result = options_.byte_range.Validate(byte_range->size())) {
+      kvs_read_options.byte_range =
+          ByteRange{byte_range->inclusive_min + result->inclusive_min,
+                    byte_range->inclusive_min + result->exclusive_max};
+    } else {
+      promise.SetResult(std::move(result).status());
+      return;
+    }
+    auto shard_key = cache.params().GetShardKey(entry_->key());
+    LinkValue(
+        [entry = std::move(entry_), position = position_,
+         options = std::move(options_)](
+            Promise<ReadResult> promise,
+            ReadyFuture<ReadResult> future) mutable {
+          auto& r = future.result();
+          if (r->aborted()) {
+            // Concurrent modification.  Retry.
+            auto& cache = GetOwningCache(*entry);
+            auto shard_index_read_future =
+                entry->Read(/*staleness_bound=*/absl::InfiniteFuture());
+            LinkValue(
+                WithExecutor(cache.executor(),
+                             ShardIndexCacheEntryReadyCallback{
+                                 std::move(entry), position,
+                                 std::move(options)}),
+                std::move(promise), std::move(shard_index_read_future));
+            return;
+          }
+          // Either the read was successful, or the shard was concurrently
+          // modified but the inner chunk is not present in any case.
+          promise.SetResult(std::move(r));
+        },
+        std::move(promise),
+        cache.base_kvstore_driver()->Read(std::move(shard_key),
+                                          std::move(kvs_read_options)));
+  }
+};
+
+class ShardedKeyValueStore : public kvstore::Driver {
+ public:
+  explicit ShardedKeyValueStore(
+      kvstore::DriverPtr base_kvstore, Executor executor,
+      internal::CachePool::WeakPtr cache_pool,
+      std::shared_ptr<const ShardingParameters> params)
+      : write_cache_(
+            cache_pool->GetCache<ShardedKeyValueStoreWriteCache>("", [&] {
+              return std::make_unique<ShardedKeyValueStoreWriteCache>(
+                  cache_pool->GetCache<ShardIndexCache>("", [&] {
+                    return std::make_unique<ShardIndexCache>(
+                        std::move(base_kvstore), std::move(executor),
+                        std::move(params));
+                  }));
+            })) {}
+
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    TENSORSTORE_ASSIGN_OR_RETURN(auto shard_and_position,
+                                 GetShardAndPosition(params(), key));
+    auto shard_index_cache_entry = GetCacheEntry(
+        shard_index_cache(), shard_and_position.shard_entry_key);
+    auto shard_index_read_future =
+        shard_index_cache_entry->Read(options.staleness_bound);
+    return PromiseFuturePair<ReadResult>::LinkValue(
+               WithExecutor(executor(),
+                            ShardIndexCacheEntryReadyCallback{
+                                std::move(shard_index_cache_entry),
+                                shard_and_position.position,
+                                std::move(options)}),
+               std::move(shard_index_read_future))
+        .future;
+  }
+
+  Future<TimestampedStorageGeneration> Write(Key key,
+                                             std::optional<Value> value,
+                                             WriteOptions options) override {
+    return internal_kvstore::WriteViaTransaction(
+        this, std::move(key), std::move(value), std::move(options));
+  }
+
+  absl::Status ReadModifyWrite(internal::OpenTransactionPtr& transaction,
+                               size_t& phase, Key key,
+                               ReadModifyWriteSource& source) override {
+    TENSORSTORE_ASSIGN_OR_RETURN(auto shard_and_position,
+                                 GetShardAndPosition(params(), key));
+    auto entry =
+        GetCacheEntry(write_cache_, shard_and_position.shard_entry_key);
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto node, GetWriteLockedTransactionNode(*entry, transaction));
+    node->ReadModifyWrite(phase, PositionToKey(shard_and_position.position),
+                          source);
+    if (!transaction) {
+      transaction.reset(node.unlock()->transaction());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status TransactionalDeleteRange(
+      const internal::OpenTransactionPtr& transaction,
+      KeyRange range) override {
+    return absl::UnimplementedError("DeleteRange not supported");
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    auto shard_and_position = GetShardAndPosition(params(), key);
+    if (!shard_and_position.ok()) {
+      return tensorstore::StrCat("invalid key ", tensorstore::QuoteString(key));
+    }
+    return tensorstore::StrCat(
+        "inner chunk ", shard_and_position->position, " in ",
+        base_kvstore_driver()->DescribeKey(
+            params().GetShardKey(shard_and_position->shard_entry_key)));
+  }
+
+  void GarbageCollectionVisit(
+      garbage_collection::GarbageCollectionVisitor& visitor) const final {
+    garbage_collection::GarbageCollectionVisit(visitor,
+                                               *base_kvstore_driver());
+  }
+
+  kvstore::Driver* base_kvstore_driver() const {
+    return shard_index_cache()->base_kvstore_driver();
+  }
+  const ShardingParameters& params() const {
+    return shard_index_cache()->params();
+  }
+  const Executor& executor() const { return shard_index_cache()->executor(); }
+
+  const internal::CachePtr<ShardIndexCache>& shard_index_cache() const {
+    return write_cache_->shard_index_cache_;
+  }
+
+  internal::CachePtr<ShardedKeyValueStoreWriteCache> write_cache_;
+};
+
+}  // namespace
+
+kvstore::DriverPtr GetShardedKeyValueStore(
+    kvstore::DriverPtr base_kvstore, Executor executor,
+    internal::CachePool::WeakPtr cache_pool,
+    std::shared_ptr<const ShardingIndexedCodec> sharding,
+    std::vector<Index> chunks_per_shard, GetShardKeyFunction get_shard_key) {
+  auto params = std::make_shared<ShardingParameters>();
+  params->sharding = std::move(sharding);
+  params->chunks_per_shard = std::move(chunks_per_shard);
+  params->get_shard_key = std::move(get_shard_key);
+  return kvstore::DriverPtr(new ShardedKeyValueStore(
+      std::move(base_kvstore), std::move(executor), std::move(cache_pool),
+      std::move(params)));
+}
+
+std::string InnerChunkGridIndicesToKey(span<const Index> grid_indices) {
+  std::string key;
+  key.resize(grid_indices.size() * sizeof(uint64_t));
+  for (DimensionIndex i = 0; i < grid_indices.size(); ++i) {
+    absl::big_endian::Store64(key.data() + i * sizeof(uint64_t),
+                              grid_indices[i]);
+  }
+  return key;
+}
+
+bool KeyToInnerChunkGridIndices(std::string_view key,
+                                span<Index> grid_indices) {
+  if (key.size() != grid_indices.size() * sizeof(uint64_t)) return false;
+  for (DimensionIndex i = 0; i < grid_indices.size(); ++i) {
+    const uint64_t value =
+        absl::big_endian::Load64(key.data() + i * sizeof(uint64_t));
+    if (value > static_cast<uint64_t>(kMaxFiniteIndex)) return false;
+    grid_indices[i] = static_cast<Index>(value);
+  }
+  return true;
+}
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
@@ -0,0 +1,99 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TENSORSTORE_DRIVER_ZARR3_SHARDED_KVSTORE_H_
+#define TENSORSTORE_DRIVER_ZARR3_SHARDED_KVSTORE_H_
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tensorstore/driver/zarr3/codec_chain.h"
+#include "tensorstore/index.h"
+#include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/span.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+
+/// Returns the key within `base_kvstore` of the shard with the specified grid
+/// cell indices.
+using GetShardKeyFunction =
+    std::function<std::string(span<const Index> shard_grid_indices)>;
+
+/// Provides read/write access to the encoded inner chunks of shards written by
+/// the zarr v3 "sharding_indexed" codec.
+///
+/// The returned `KeyValueStore` requires keys obtained from
+/// `InnerChunkGridIndicesToKey`, which specify the grid cell indices of an
+/// inner chunk over the entire array.  The values are the encoded inner
+/// chunks; the caller is responsible for applying the inner codec chain.
+///
+/// Read requests require at most 2 reads of the underlying `base_kvstore`:
+///
+/// 1. Retrieve the shard index.  If the index is stored at the start of the
+///    shard, this is a byte range read of just the index.  Since
+///    `base_kvstore` does not support byte ranges relative to the end of a
+///    value, if the index is stored at the end of the shard, the entire shard
+///    must be read to obtain the index.
+///
+/// 2. Retrieve the inner chunk (if present), as a byte range read conditioned
+///    on the shard generation from which the index was obtained.
+///
+/// The decoded shard indices are cached in `cache_pool`, and therefore
+/// subsequent reads within the same shard require only a single read of the
+/// underlying `base_kvstore`.
+///
+/// Writes are performed by rewriting the entire shard.  If every inner chunk of
+/// a shard is written, the write is unconditional and the existing shard is not
+/// read.
+///
+/// Listing and `DeleteRange` are not supported.
+///
+/// \param base_kvstore The underlying `KeyValueStore` that holds the shards.
+/// \param executor Executor to use for encoding and decoding.
+/// \param cache_pool The cache pool for the shard index cache and for the
+///     shard write cache.
+/// \param sharding The sharding parameters, must have been validated by
+///     `ValidateCodecChain`.
+/// \param chunks_per_shard Number of inner chunks along each dimension of a
+///     shard.
+/// \param get_shard_key Maps shard grid cell indices to keys in
+///     `base_kvstore`.
+kvstore::DriverPtr GetShardedKeyValueStore(
+    kvstore::DriverPtr base_kvstore, Executor executor,
+    internal::CachePool::WeakPtr cache_pool,
+    std::shared_ptr<const ShardingIndexedCodec> sharding,
+    std::vector<Index> chunks_per_shard, GetShardKeyFunction get_shard_key);
+
+/// Returns a key suitable for use with a `KeyValueStore` returned from
+/// `GetShardedKeyValueStore`.
+///
+/// Each grid cell index is encoded as an 8-byte `uint64be` value.
+std::string InnerChunkGridIndicesToKey(span<const Index> grid_indices);
+
+/// Inverse of `InnerChunkGridIndicesToKey`.
+///
+/// \returns `true` if `key` is valid.
+bool KeyToInnerChunkGridIndices(std::string_view key,
+                                span<Index> grid_indices);
+
+}  // namespace internal_zarr3
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_DRIVER_ZARR3_SHARDED_KVSTORE_H_
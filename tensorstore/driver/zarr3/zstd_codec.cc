@@ -0,0 +1,61 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Defines the "zstd" codec for zarr v3.  Linking in this library
+/// automatically registers it.
+
+#include "tensorstore/internal/compression/zstd_compressor.h"
+
+#include "riegeli/zstd/zstd_writer.h"
+#include "tensorstore/driver/zarr3/codec_registry.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+
+namespace tensorstore {
+namespace internal_zarr3 {
+namespace {
+
+using ::riegeli::ZstdWriterBase;
+namespace jb = ::tensorstore::internal_json_binding;
+
+using ZstdCodec = CompressorCodec<internal::ZstdCompressor>;
+
+struct Registration {
+  Registration() {
+    RegisterCodec<ZstdCodec>(
+        "zstd",
+        CodecConfiguration(
+            jb::Member(
+                "level",
+                jb::Projection(
+                    [](auto& codec) -> auto& { return codec.compressor.level; },
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](auto* v) { *v = 0; },
+                        jb::Integer<int>(
+                            ZstdWriterBase::Options::kMinCompressionLevel,
+                            ZstdWriterBase::Options::kMaxCompressionLevel)))),
+            jb::Member(
+                "checksum",
+                jb::Projection(
+                    [](auto& codec) -> auto& {
+                      return codec.compressor.checksum;
+                    },
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](auto* v) { *v = false; })))));
+  }
+} registration;
+
+}  // namespace
+}  // namespace internal_zarr3
+}  // namespace tensorstore
@@ -86,6 +86,22 @@ AsyncWriteArray::MaskedArray::MaskedArray(DimensionIndex rank) : mask(rank) {}
 void AsyncWriteArray::MaskedArray::WriteFillValue(const Spec& spec,
                                                   span<const Index> origin) {
   data = nullptr;
+  data_is_shared = false;
+  mask.Reset();
+  mask.num_masked_elements = spec.num_elements();
+  mask.region = BoxView(origin, spec.shape());
+}
+
+void AsyncWriteArray::MaskedArray::WriteArray(
+    const Spec& spec, span<const Index> origin,
+    SharedArrayView<const void> array) {
+  assert(internal::RangesEqual(array.shape(), spec.shape()));
+  assert(array.dtype() == spec.dtype());
+  data = std::const_pointer_cast<void>(
+      std::move(array.element_pointer()).pointer());
+  data_is_shared = true;
+  shared_byte_strides.assign(array.byte_strides().begin(),
+                             array.byte_strides().end());
   mask.Reset();
   mask.num_masked_elements = spec.num_elements();
   mask.region = BoxView(origin, spec.shape());
@@ -142,13 +158,13 @@ AsyncWriteArray::MaskedArray::GetArrayForWriteback(
                             : ArrayView<const void>(spec.fill_value),
                         {data, spec.dtype()}, mask);
     }
-    writeback.array = SharedArrayView<void>(
-        SharedElementPointer<void>(data, spec.dtype()), spec.write_layout());
+    writeback.array = shared_array_view(spec);
     writeback.must_store =
         spec.store_if_equal_to_fill_value ||
         !AreArraysSameValueEqual(writeback.array, spec.fill_value);
     if (!writeback.must_store) {
       data = nullptr;
+      data_is_shared = false;
       writeback.array = spec.fill_value;
     }
   }
@@ -159,7 +175,8 @@ std::size_t AsyncWriteArray::MaskedArray::EstimateSizeInBytes(
     const Spec& spec) const {
   std::size_t total = 0;
   const Index num_elements = ProductOfExtents(spec.shape());
-  if (data) {
+  // An array supplied to `WriteArray` is owned by the caller.
+  if (data && !data_is_shared) {
     total += num_elements * spec.fill_value.dtype()->size;
   }
   if (mask.mask_array) {
@@ -172,10 +189,18 @@ void AsyncWriteArray::MaskedArray::EnsureWritable(const Spec& spec) {
   assert(data);
   auto dtype = spec.dtype();
   auto new_data = spec.AllocateAndConstructBuffer();
-  dtype->copy_assign[IterationBufferKind::kContiguous](
-      /*context=*/nullptr, spec.num_elements(),
-      IterationBufferPointer(data.get(), dtype.size()),
-      IterationBufferPointer(new_data.get(), dtype.size()), /*status=*/nullptr);
+  if (data_is_shared) {
+    CopyArray(shared_array_view(spec),
+              ArrayView<void>(ElementPointer<void>(new_data.get(), dtype),
+                              spec.write_layout()));
+    data_is_shared = false;
+  } else {
+    dtype->copy_assign[IterationBufferKind::kContiguous](
+        /*context=*/nullptr, spec.num_elements(),
+        IterationBufferPointer(data.get(), dtype.size()),
+        IterationBufferPointer(new_data.get(), dtype.size()),
+        /*status=*/nullptr);
+  }
   data = std::move(new_data);
 }
 
@@ -186,6 +211,8 @@ Result<NDIterable::Ptr> AsyncWriteArray::MaskedArray::BeginWrite(
   if (!data) {
     data = spec.AllocateAndConstructBuffer();
     allocated_data = true;
+  } else if (data_is_shared) {
+    EnsureWritable(spec);
   }
   ArrayView<void> write_array(ElementPointer<void>(data, spec.dtype()),
                               spec.write_layout());
@@ -226,6 +253,7 @@ bool AsyncWriteArray::MaskedArray::EndWrite(
 void AsyncWriteArray::MaskedArray::Clear() {
   mask.Reset();
   data = nullptr;
+  data_is_shared = false;
 }
 
 AsyncWriteArray::AsyncWriteArray(DimensionIndex rank) : write_state(rank) {}
@@ -254,15 +282,15 @@ Result<NDIterable::Ptr> AsyncWriteArray::GetReadNDIterable(
       }
     } else if (this->read_generation != read_generation) {
       assert(write_state.data);
+      // Only a fully-overwritten array may be shared.
+      assert(!write_state.data_is_shared);
       RebaseMaskedArray(BoxView<>(origin, spec.shape()), read_array,
                         ElementPointer<void>(write_state.data, spec.dtype()),
                         write_state.mask);
       this->read_generation = read_generation;
     }
     if (write_state.data) {
-      read_array = SharedArrayView<const void>(
-          SharedElementPointer<const void>(write_state.data, spec.dtype()),
-          spec.write_layout());
+      read_array = write_state.shared_array_view(spec);
     }
   }
   return spec.GetReadNDIterable(std::move(read_array), origin,
@@ -276,6 +304,11 @@ Result<NDIterable::Ptr> AsyncWriteArray::BeginWrite(
                                 arena);
 }
 
+void AsyncWriteArray::WriteArray(const Spec& spec, span<const Index> origin,
+                                 SharedArrayView<const void> array) {
+  write_state.WriteArray(spec, origin, std::move(array));
+}
+
 bool AsyncWriteArray::EndWrite(const Spec& spec, span<const Index> origin,
                                IndexTransformView<> chunk_transform,
                                NDIterable::IterationLayoutView layout,
@@ -173,17 +173,36 @@ struct AsyncWriteArray {
     /// shape given by the `dtype` and `shape`, respectively, of the `Spec`.
     /// If equal to `nullptr`, no data has been written yet, or the current
     /// value is equal to the fill value.
+    ///
+    /// If `data_is_shared` is `true`, this instead points to an array supplied
+    /// to `WriteArray`, with a layout given by `data_layout`.
     std::shared_ptr<void> data;
 
+    /// Indicates that `data` references an array supplied to `WriteArray` that
+    /// is owned by the caller and must not be modified.  It is copied to a
+    /// newly-allocated C-order array before any further modification.
+    bool data_is_shared = false;
+
+    /// Byte strides of `data` if `data_is_shared` is `true`.
+    std::vector<Index> shared_byte_strides;
+
     /// If `mask` is all `true` (`num_masked_elements` is equal to the total
     /// number of elements in the `data` array), `data == nullptr` represents
     /// the same state as `data` containing the fill value.
     MaskData mask;
 
+    /// Returns the layout of `data`.
+    StridedLayoutView<> data_layout(const Spec& spec) const {
+      if (data_is_shared) {
+        return StridedLayoutView<>(spec.shape(), shared_byte_strides);
+      }
+      return spec.write_layout();
+    }
+
     SharedArrayView<const void> shared_array_view(const Spec& spec) {
       return SharedArrayView<const void>(
           SharedElementPointer<const void>(data, spec.dtype()),
-          spec.write_layout());
+          data_layout(spec));
     }
 
     /// Returns an `NDIterable` that may be used for writing to this array using
@@ -224,6 +243,20 @@ struct AsyncWriteArray {
     /// \param origin The associated origin of the array.
     void WriteFillValue(const Spec& spec, span<const Index> origin);
 
+    /// Overwrites the entire array with `array`, which is referenced rather
+    /// than copied.
+    ///
+    /// The caller must ensure that `array` is not modified while it is
+    /// referenced, i.e. until the array is cleared or a subsequent write
+    /// causes it to be copied.
+    ///
+    /// \param spec The associated `Spec`.
+    /// \param origin The associated origin of the array.
+    /// \param array Array with a shape of `spec.shape()` and data type of
+    ///     `spec.dtype()`.  There are no constraints on the layout.
+    void WriteArray(const Spec& spec, span<const Index> origin,
+                    SharedArrayView<const void> array);
+
     /// Returns `true` if the array has been fully overwritten.
     bool IsFullyOverwritten(const Spec& spec, span<const Index> origin) const {
       return mask.num_masked_elements >= spec.chunk_num_elements(origin);
@@ -299,6 +332,15 @@ struct AsyncWriteArray {
                 NDIterable::IterationLayoutView layout,
                 span<const Index> write_end_position, Arena* arena);
 
+  /// Overwrites the entire array with `array`, without copying it.
+  ///
+  /// \param spec The associated `Spec`.
+  /// \param origin The associated origin of the array.
+  /// \param array Array with a shape of `spec.shape()` and data type of
+  ///     `spec.dtype()`.  Must not be modified while it is referenced.
+  void WriteArray(const Spec& spec, span<const Index> origin,
+                  SharedArrayView<const void> array);
+
   /// Returns an array to write back the current modifications.
   ///
   /// Moves `write_state` to `writeback_state`, which is referenced by the
@@ -327,6 +327,46 @@ TEST(MaskedArrayTest, StoreIfEqualToFillValue) {
   }
 }
 
+// Tests that `WriteArray` references the source array without copying it, and
+// copies it before any further modification.
+TEST(MaskedArrayTest, WriteArray) {
+  auto fill_value = MakeArray<int32_t>({{1, 2, 3}, {4, 5, 6}});
+  tensorstore::Box<> component_bounds({-1, -kInfIndex}, {3, kInfSize});
+  Spec spec(fill_value, component_bounds);
+  MaskedArray write_state(2);
+  std::vector<Index> origin{0, 0};
+  // Use a Fortran-order source to check that the layout is preserved.
+  auto source = tensorstore::AllocateArray<int32_t>({2, 3},
+                                                    tensorstore::fortran_order);
+  tensorstore::CopyArray(MakeArray<int32_t>({{7, 8, 9}, {10, 11, 12}}), source);
+  write_state.WriteArray(spec, origin, source);
+  EXPECT_TRUE(write_state.IsFullyOverwritten(spec, origin));
+  EXPECT_EQ(source.data(), write_state.data.get());
+  // The source array is owned by the caller.
+  EXPECT_EQ(0, write_state.EstimateSizeInBytes(spec));
+
+  {
+    auto writeback_data = write_state.GetArrayForWriteback(
+        spec, origin, /*read_array=*/{},
+        /*read_state_already_integrated=*/false);
+    EXPECT_TRUE(writeback_data.must_store);
+    EXPECT_EQ(source.data(), writeback_data.array.data());
+    EXPECT_EQ(source.layout(), writeback_data.array.layout());
+  }
+
+  // A subsequent partial write copies the source array rather than modifying
+  // it.
+  TestWrite(&write_state, spec, origin,
+            tensorstore::MakeOffsetArray<int32_t>({1, 1}, {{13}}),
+            /*expected_modified=*/true);
+  EXPECT_NE(source.data(), write_state.data.get());
+  EXPECT_FALSE(write_state.data_is_shared);
+  EXPECT_EQ(MakeArray<int32_t>({{7, 8, 9}, {10, 11, 12}}), source);
+  EXPECT_EQ(MakeArray<int32_t>({{7, 8, 9}, {10, 13, 12}}),
+            write_state.shared_array_view(spec));
+  EXPECT_EQ(2 * 3 * sizeof(int32_t), write_state.EstimateSizeInBytes(spec));
+}
+
 TEST(AsyncWriteArrayTest, Basic) {
   AsyncWriteArray async_write_array(2);
   auto fill_value = MakeArray<int32_t>({{1, 2, 3}, {4, 5, 6}});
@@ -97,7 +97,7 @@ const AsyncCache::ReadRequestState& GetEffectiveReadRequestState(
 
 template <typename EntryOrNode>
 void EntryOrNodeStartRead(EntryOrNode& entry_or_node,
-                          UniqueWriterLock<Entry> lock) {
+                          UniqueWriterLock<Entry> lock, Batch batch) {
   static_assert(std::is_same_v<EntryOrNode, Entry> ||
                 std::is_same_v<EntryOrNode, TransactionNode>);
   auto& request_state = entry_or_node.read_request_state_;
@@ -121,14 +121,20 @@ void EntryOrNodeStartRead(EntryOrNode& entry_or_node,
   AcquireReadRequestReference(entry_or_node);
   ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
       << entry_or_node << "EntryOrNodeStartRead: calling DoRead";
-  entry_or_node.DoRead(staleness_bound);
+  AsyncCacheReadRequest read_request;
+  read_request.staleness_bound = staleness_bound;
+  read_request.batch = std::move(batch);
+  entry_or_node.DoRead(std::move(read_request));
 }
 
 /// Starts a previously-requested read or writeback operation.
 ///
 /// This function is called when a read or writeback operation completes, or a
 /// new writeback is requested.
-void MaybeStartReadOrWriteback(Entry& entry, UniqueWriterLock<Entry> lock) {
+///
+/// \param batch Batch with which to associate a read, if one is issued.
+void MaybeStartReadOrWriteback(Entry& entry, UniqueWriterLock<Entry> lock,
+                               Batch batch = no_batch) {
   auto& read_request_state = entry.read_request_state_;
 
   if (TransactionNode* committing_transaction_node =
@@ -197,16 +203,18 @@ void MaybeStartReadOrWriteback(Entry& entry, UniqueWriterLock<Entry> lock) {
 
   if (read_request_state.issued.null()) {
     // Issue a read if requested.
-    EntryOrNodeStartRead(entry, std::move(lock));
+    EntryOrNodeStartRead(entry, std::move(lock), std::move(batch));
   }
 }
 
-void MaybeIssueRead(Entry& entry, UniqueWriterLock<Entry> lock) {
-  MaybeStartReadOrWriteback(entry, std::move(lock));
+void MaybeIssueRead(Entry& entry, UniqueWriterLock<Entry> lock,
+                    Batch batch = no_batch) {
+  MaybeStartReadOrWriteback(entry, std::move(lock), std::move(batch));
 }
 
-void MaybeIssueRead(TransactionNode& node, UniqueWriterLock<Entry> lock) {
-  EntryOrNodeStartRead(node, std::move(lock));
+void MaybeIssueRead(TransactionNode& node, UniqueWriterLock<Entry> lock,
+                    Batch batch = no_batch) {
+  EntryOrNodeStartRead(node, std::move(lock), std::move(batch));
 }
 
 template <typename EntryOrNode>
@@ -245,12 +253,13 @@ void SetReadState(EntryOrNode& entry_or_node, ReadState&& read_state,
 
 template <typename EntryOrNode>
 Future<const void> RequestRead(EntryOrNode& entry_or_node,
-                               absl::Time staleness_bound) {
+                               AsyncCacheReadRequest request) {
   static_assert(std::is_same_v<EntryOrNode, Entry> ||
                 std::is_same_v<EntryOrNode, TransactionNode>);
   auto& entry = GetOwningEntry(entry_or_node);
   UniqueWriterLock lock(entry);
 
+  const absl::Time staleness_bound = request.staleness_bound;
   auto& request_state = entry_or_node.read_request_state_;
   const auto existing_time =
       GetEffectiveReadRequestState(entry_or_node).read_state.stamp.time;
@@ -279,7 +288,7 @@ Future<const void> RequestRead(EntryOrNode& entry_or_node,
   } else {
     future = GetFuture(request_state.queued);
   }
-  MaybeIssueRead(entry_or_node, std::move(lock));
+  MaybeIssueRead(entry_or_node, std::move(lock), std::move(request.batch));
   return future;
 }
 
@@ -486,10 +495,10 @@ size_t AsyncCache::DoGetSizeInBytes(Cache::Entry* base_entry) {
   return this->DoGetFixedSizeInBytes(entry);
 }
 
-Future<const void> AsyncCache::Entry::Read(absl::Time staleness_bound) {
+Future<const void> AsyncCache::Entry::Read(AsyncCacheReadRequest request) {
   ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
-      << *this << "Read: staleness_bound=" << staleness_bound;
-  return RequestRead(*this, staleness_bound);
+      << *this << "Read: staleness_bound=" << request.staleness_bound;
+  return RequestRead(*this, std::move(request));
 }
 
 void AsyncCache::Entry::ReadSuccess(ReadState&& read_state) {
@@ -527,15 +536,15 @@ AsyncCache::TransactionNode::TransactionNode(Entry& entry)
       size_updated_(false) {}
 
 Future<const void> AsyncCache::TransactionNode::Read(
-    absl::Time staleness_bound) {
+    AsyncCacheReadRequest request) {
   ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
-      << *this << "Read: staleness_bound=" << staleness_bound;
+      << *this << "Read: staleness_bound=" << request.staleness_bound;
   if (reads_committed_ &&
       (prepare_for_commit_state_.load(std::memory_order_acquire) !=
        PrepareForCommitState::kReadyForCommitCalled)) {
-    return RequestRead(GetOwningEntry(*this), staleness_bound);
+    return RequestRead(GetOwningEntry(*this), std::move(request));
   }
-  return RequestRead(*this, staleness_bound);
+  return RequestRead(*this, std::move(request));
 }
 
 void AsyncCache::TransactionNode::ReadSuccess(ReadState&& read_state) {
@@ -799,7 +808,14 @@ void AsyncCache::TransactionNode::WriterUnlock() {
   const size_t change = new_size - std::exchange(write_state_size_, new_size);
   if (change == 0) return;
   this->UpdateSizeInBytes(change);
-  if (!this->transaction()->implicit_transaction()) return;
+  if (!this->transaction()->implicit_transaction()) {
+    if (this->transaction()->staging_limit_exceeded() && !IsRevoked() &&
+        !this->transaction()->commit_started() && CanStageWriteback()) {
+      lock.unlock();
+      StageWriteback();
+    }
+    return;
+  }
   auto& entry = GetOwningEntry(*this);
   UniqueWriterLock entry_lock(entry);
   lock.unlock();
@@ -816,6 +832,12 @@ bool AsyncCache::TransactionNode::try_lock() {
 
 size_t AsyncCache::TransactionNode::ComputeWriteStateSizeInBytes() { return 0; }
 
+bool AsyncCache::TransactionNode::CanStageWriteback() { return false; }
+
+void AsyncCache::TransactionNode::StageWriteback() {}
+
+void AsyncCache::TransactionNode::WritebackStaged() {}
+
 absl::Status AsyncCache::TransactionNode::DoInitialize(
     internal::OpenTransactionPtr& transaction) {
   return absl::OkStatus();
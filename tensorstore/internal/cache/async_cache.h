@@ -24,6 +24,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/intrusive_red_black_tree.h"
@@ -44,6 +45,16 @@
 namespace tensorstore {
 namespace internal {
 
+/// Parameters of a read request made to an `AsyncCache`.
+struct AsyncCacheReadRequest {
+  /// Limit on data staleness.
+  absl::Time staleness_bound = absl::InfiniteFuture();
+
+  /// Batch with which to associate any read operation issued to satisfy the
+  /// request.
+  Batch batch = no_batch;
+};
+
 /// Abstract base class that extends `Cache` with asynchronous read and
 /// read-modify-write functionality based on optimistic concurrency.
 ///
@@ -88,7 +99,7 @@ namespace internal {
 ///        public:
 ///         using OwningCache = Derived;
 ///
-///         void DoRead(absl::Time staleness_bound) override;
+///         void DoRead(AsyncCacheReadRequest request) override;
 ///         size_t ComputeReadDataSizeInBytes(const void *read_data) override;
 ///       };
 ///
@@ -97,7 +108,7 @@ namespace internal {
 ///         using OwningCache = Derived;
 ///         using Base::TransactionNode::TransactionNode;
 ///
-///         void DoRead(absl::Time staleness_bound);
+///         void DoRead(AsyncCacheReadRequest request);
 ///         void DoWriteback() override;
 ///         void DoApply(absl::Time staleness_bound,
 ///                      ApplyReceiver receiver) override;
@@ -351,13 +362,20 @@ class AsyncCache : public Cache {
     void WriterLock() ABSL_EXCLUSIVE_LOCK_FUNCTION();
     void WriterUnlock() ABSL_UNLOCK_FUNCTION();
 
-    /// Requests data no older than `staleness_bound`.
+    /// Requests data no older than `request.staleness_bound`.
+    ///
+    /// If a read operation must be issued, it is associated with
+    /// `request.batch`.
     ///
-    /// \param staleness_bound Limit on data staleness.
     /// \returns A future that resolves to a success state once data no older
-    ///     than `staleness_bound` is available, or to an error state if the
-    ///     request failed.
-    Future<const void> Read(absl::Time staleness_bound);
+    ///     than `request.staleness_bound` is available, or to an error state
+    ///     if the request failed.
+    Future<const void> Read(AsyncCacheReadRequest request);
+
+    /// Requests data no older than `staleness_bound`.
+    Future<const void> Read(absl::Time staleness_bound) {
+      return Read(AsyncCacheReadRequest{staleness_bound});
+    }
 
     /// Obtains an existing or new transaction node for the specified entry and
     /// transaction.  May also be used to obtain an implicit transaction node.
@@ -419,8 +437,9 @@ class AsyncCache : public Cache {
     ///
     /// Derived classes must implement this method, and implementations must
     /// call (either immediately or asynchronously) `ReadSuccess` or `ReadError`
-    /// to signal completion.
-    virtual void DoRead(absl::Time staleness_bound) = 0;
+    /// to signal completion.  If `request.batch` is not null, the read may be
+    /// deferred until the batch is submitted.
+    virtual void DoRead(AsyncCacheReadRequest request) = 0;
 
     /// Signals that the read request initiated by the most recent call to
     /// `DoRead` succeeded.
@@ -670,9 +689,15 @@ class AsyncCache : public Cache {
     /// actually be required.
     virtual void InvalidateReadState();
 
+    /// Requests a read state for this transaction node that is current as of
+    /// the specified `request.staleness_bound`.
+    Future<const void> Read(AsyncCacheReadRequest request);
+
     /// Requests a read state for this transaction node that is current as of
     /// the specified `staleness_bound`.
-    Future<const void> Read(absl::Time staleness_bound);
+    Future<const void> Read(absl::Time staleness_bound) {
+      return Read(AsyncCacheReadRequest{staleness_bound});
+    }
 
     /// Requests initial or updated data from persistent storage for a single
     /// `Entry`.
@@ -683,8 +708,9 @@ class AsyncCache : public Cache {
     ///
     /// Derived classes must implement this method, and implementations must
     /// call (either immediately or asynchronously) `ReadSuccess` or `ReadError`
-    /// to signal completion.
-    virtual void DoRead(absl::Time staleness_bound) = 0;
+    /// to signal completion.  If `request.batch` is not null, the read may be
+    /// deferred until the batch is submitted.
+    virtual void DoRead(AsyncCacheReadRequest request) = 0;
 
     /// Signals that the read request initiated by the most recent call to
     /// `DoRead` succeeded.
@@ -772,6 +798,32 @@ class AsyncCache : public Cache {
     /// `KvsBackedCache`.
     virtual void DoApply(ApplyOptions option, ApplyReceiver receiver);
 
+    /// Returns `true` if the writeback value of this node does not depend on
+    /// the existing read state, and therefore may be staged before commit.
+    ///
+    /// If the transaction's `staging_limit_bytes()` is exceeded when the write
+    /// lock is released, and this returns `true`, `StageWriteback` is called.
+    ///
+    /// Called with the write lock held.  The default implementation returns
+    /// `false`.
+    virtual bool CanStageWriteback();
+
+    /// Requests that the writeback value of this node be staged before commit.
+    ///
+    /// If staging proceeds, this node is revoked, and `WritebackStaged` is
+    /// called once the writeback value has been staged.
+    ///
+    /// The default implementation does nothing.  `KvsBackedCache` forwards the
+    /// request to the `kvstore::ReadModifyWriteTarget`.
+    virtual void StageWriteback();
+
+    /// Called once the writeback value of this node has been staged.  The
+    /// modifications will not be requested again, and derived classes may
+    /// release the write state.
+    ///
+    /// The default implementation does nothing.
+    virtual void WritebackStaged();
+
     /// Invoked by the `TransactionState` implementation to commit this node.
     ///
     /// Enqueues this transaction node for writeback once any previously-issued
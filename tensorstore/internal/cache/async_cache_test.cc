@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/concurrent_testutil.h"
 #include "tensorstore/internal/intrusive_ptr.h"
@@ -42,6 +43,7 @@ using ::tensorstore::StorageGeneration;
 using ::tensorstore::Transaction;
 using ::tensorstore::UniqueWriterLock;
 using ::tensorstore::internal::AsyncCache;
+using ::tensorstore::internal::AsyncCacheReadRequest;
 using ::tensorstore::internal::CacheEntryQueueState;
 using ::tensorstore::internal::CachePool;
 using ::tensorstore::internal::OpenTransactionPtr;
@@ -55,6 +57,7 @@ constexpr CachePool::Limits kSmallCacheLimits{10000000, 5000000};
 struct RequestLog {
   struct ReadRequest {
     AsyncCache::Entry* entry;
+    tensorstore::Batch batch = tensorstore::no_batch;
     void Success(absl::Time time = absl::Now(),
                  std::shared_ptr<const size_t> value = {}) {
       entry->ReadSuccess(
@@ -114,8 +117,9 @@ class TestCache : public tensorstore::internal::AsyncCache {
           ->future();
     }
 
-    void DoRead(absl::Time staleness_bound) override {
-      GetOwningCache(*this).log_->reads.push(RequestLog::ReadRequest{this});
+    void DoRead(AsyncCacheReadRequest request) override {
+      GetOwningCache(*this).log_->reads.push(
+          RequestLog::ReadRequest{this, std::move(request.batch)});
     }
 
     bool ShareImplicitTransactionNodes() override {
@@ -143,7 +147,7 @@ class TestCache : public tensorstore::internal::AsyncCache {
       SetReadsCommitted();
       return entry.do_initialize_transaction_error;
     }
-    void DoRead(absl::Time staleness_bound) override {
+    void DoRead(AsyncCacheReadRequest request) override {
       GetOwningCache(*this).log_->transaction_reads.push(
           RequestLog::TransactionReadRequest{this});
     }
@@ -437,6 +441,33 @@ TEST(AsyncCacheTest, ReadFailedAfterSuccessfulRead) {
   }
 }
 
+TEST(AsyncCacheTest, ReadBatch) {
+  auto pool = CachePool::Make(kSmallCacheLimits);
+  RequestLog log;
+  auto cache = pool->GetCache<TestCache>(
+      "", [&] { return std::make_unique<TestCache>(&log); });
+  auto entry = GetCacheEntry(cache, "a");
+
+  auto batch = tensorstore::Batch::New();
+  AsyncCacheReadRequest request;
+  request.staleness_bound = absl::Now();
+  request.batch = batch;
+  auto read_future = entry->Read(request);
+  ASSERT_FALSE(read_future.ready());
+  ASSERT_EQ(1, log.reads.size());
+  {
+    auto read_req = log.reads.pop();
+    EXPECT_EQ(batch, read_req.batch);
+    read_req.Success();
+  }
+  ASSERT_TRUE(read_future.ready());
+  TENSORSTORE_EXPECT_OK(read_future);
+
+  // A read satisfied by the cached data does not use the batch.
+  TENSORSTORE_EXPECT_OK(entry->Read(request));
+  ASSERT_EQ(0, log.reads.size());
+}
+
 TEST(AsyncCacheTest, NonTransactionalWrite) {
   auto pool = CachePool::Make(kSmallCacheLimits);
   RequestLog log;
@@ -14,8 +14,12 @@
 
 #include "tensorstore/internal/cache/cache.h"
 
+#include <stddef.h>
+
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <limits>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
@@ -29,7 +33,9 @@
 #include "absl/base/call_once.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/functional/function_ref.h"
+#include "absl/hash/hash.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorstore/internal/cache/cache_pool_limits.h"
 #include "tensorstore/internal/integer_overflow.h"
@@ -37,12 +43,28 @@
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/mutex.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
 
 // A CacheEntry owns a strong reference to the Cache that contains it only if
 // its reference count is > 0.
 //
 // A Cache owns a weak reference to the CachePool that contains it only if its
 // reference count is > 0.
+//
+// Lock ordering: `CachePoolImpl::mutex_` must be acquired before
+// `CacheEntryShard::mutex` or `CachePoolImpl::ReleaseBuffer::mutex`.  The
+// common operations of looking up an entry and releasing a reference to an
+// entry never block on `CachePoolImpl::mutex_`:
+//
+// - When the reference count of an entry that is in the eviction queue changes
+//   from 0 to 1, the entry is removed from the queue only if the pool mutex can
+//   be acquired without blocking; otherwise `MaybeEvictEntries` removes it
+//   lazily.
+//
+// - When the last reference to an entry is released and the pool mutex cannot
+//   be acquired without blocking, the release is deferred to the thread that
+//   holds the mutex (see `DeferEntryRelease` and `UnlockPool`).
 
 namespace tensorstore {
 namespace internal_cache {
@@ -53,6 +75,16 @@ auto& miss_count = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/miss_count", "Number of cache misses.");
 auto& evict_count = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/evict_count", "Number of evictions from the cache.");
+auto& policy_hit_count = internal_metrics::Counter<int64_t, std::string>::New(
+    "/tensorstore/cache/policy_hit_count", "policy",
+    "Number of cache hits by eviction policy of the cache pool.");
+auto& policy_miss_count = internal_metrics::Counter<int64_t, std::string>::New(
+    "/tensorstore/cache/policy_miss_count", "policy",
+    "Number of cache misses by eviction policy of the cache pool.");
+auto& writeback_throttle_count = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/writeback_throttle_count",
+    "Number of times writes were delayed due to the writeback high water "
+    "mark of a cache pool.");
 
 using ::tensorstore::internal::PinnedCacheEntry;
 
@@ -65,14 +97,84 @@ inline void DebugAssertMutexHeld(absl::Mutex* mutex) {}
 using LruListAccessor =
     internal::intrusive_linked_list::MemberAccessor<LruListNode>;
 
+/// Maximum number of entries in each `CachePoolImpl::ReleaseBuffer`.  If the
+/// buffer is full, the releasing thread blocks on the pool mutex instead.
+constexpr size_t kMaxDeferredReleasesPerBuffer = 32;
+
+/// Assumed average entry size used to size the frequency sketch of the
+/// `CacheEvictionPolicy::kTinyLfu` policy.
+constexpr size_t kTinyLfuEntrySizeEstimate = 16384;
+
+/// Percentage of `total_bytes_limit` used for the admission window of the
+/// `CacheEvictionPolicy::kTinyLfu` policy.
+constexpr size_t kTinyLfuWindowPercent = 1;
+
+/// Percentage of the main region of the `CacheEvictionPolicy::kTinyLfu` policy
+/// used for the protected segment.
+constexpr size_t kTinyLfuProtectedPercent = 80;
+
+/// Per-policy metric cells.
+struct PolicyMetricCells {
+  internal_metrics::CounterCell<int64_t>* hit_count;
+  internal_metrics::CounterCell<int64_t>* miss_count;
+};
+
+const PolicyMetricCells& GetPolicyMetricCells(CacheEvictionPolicy policy) {
+  static const PolicyMetricCells cells[] = {
+      {&policy_hit_count.GetCell("lru"), &policy_miss_count.GetCell("lru")},
+      {&policy_hit_count.GetCell("clock"), &policy_miss_count.GetCell("clock")},
+      {&policy_hit_count.GetCell("tinylfu"),
+       &policy_miss_count.GetCell("tinylfu")},
+  };
+  return cells[static_cast<int>(policy)];
+}
+
 CachePoolImpl::CachePoolImpl(const CachePool::Limits& limits)
     : limits_(limits),
       total_bytes_(0),
       queued_for_writeback_bytes_(0),
+      eviction_queue_bytes_{},
+      pending_writeback_bytes_(0),
+      writeback_throttled_(false),
+      num_deferred_releases_(0),
       strong_references_(1),
       weak_references_(1) {
   Initialize(LruListAccessor{}, &writeback_queue_);
   Initialize(LruListAccessor{}, &eviction_queue_);
+  Initialize(LruListAccessor{}, &probation_queue_);
+  Initialize(LruListAccessor{}, &protected_queue_);
+  if (limits_.eviction_policy == CacheEvictionPolicy::kTinyLfu) {
+    frequency_sketch_ = std::make_unique<FrequencySketch>(std::max<size_t>(
+        limits_.total_bytes_limit / kTinyLfuEntrySizeEstimate, 1024));
+  }
+  if (limits_.encoded_bytes_limit > 0) {
+    encoded_value_cache_ =
+        std::make_unique<EncodedValueCache>(limits_.encoded_bytes_limit);
+  }
+  if (limits_.writeback_encode_concurrency != 0 ||
+      limits_.writeback_io_concurrency != 0) {
+    writeback_scheduler_ = std::make_unique<WritebackScheduler>(
+        limits_.writeback_encode_concurrency, limits_.writeback_io_concurrency);
+  }
+  // Reserve the full capacity up front, since deferring a release must not
+  // throw.
+  for (auto& buffer : release_buffers_) {
+    buffer.entries.reserve(kMaxDeferredReleasesPerBuffer);
+  }
+}
+
+CacheEntryShard& CacheImpl::GetEntryShard(size_t key_hash) {
+  // Use the high bits of the hash, since the low bits are used by the hash
+  // table within the shard.
+  return entry_shards_[key_hash >>
+                       (std::numeric_limits<size_t>::digits - kCacheShardBits)];
+}
+
+bool CacheImpl::entries_empty() const {
+  for (const auto& shard : entry_shards_) {
+    if (!shard.entries.empty()) return false;
+  }
+  return true;
 }
 
 namespace {
@@ -99,6 +201,31 @@ inline CachePtr<Cache> AcquireCacheStrongPtr(CacheImpl* cache_impl) {
                          internal::adopt_object_ref);
 }
 
+/// Cache references held by entries whose reference count became zero while
+/// `CachePoolImpl::mutex_` was held, which must be released once the mutex is
+/// unlocked.
+using ReleasedCacheReferences = std::vector<CacheImpl*>;
+
+void ReleaseCacheReferences(const ReleasedCacheReferences& caches) {
+  for (auto* cache : caches) {
+    StrongPtrTraitsCache::decrement(Access::StaticCast<Cache>(cache));
+  }
+}
+
+void UnlockPool(CachePoolImpl* pool) noexcept;
+
+/// Traits for use with `UniqueLockImpl` to lock `CachePoolImpl::mutex_`.
+struct PoolLockTraits {
+  static void lock(CachePoolImpl& pool) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    pool.mutex_.Lock();
+  }
+  static void unlock(CachePoolImpl& pool) { UnlockPool(&pool); }
+};
+
+/// Unique lock on `CachePoolImpl::mutex_` that releases deferred entry
+/// references before unlocking.
+using PoolLock = internal::UniqueLockImpl<CachePoolImpl, PoolLockTraits>;
+
 void SetStateAndSize(CacheEntryImpl* entry, CacheEntryQueueState state,
                      size_t num_bytes) noexcept;
 
@@ -107,26 +234,125 @@ void UnlinkListNode(LruListNode* node) noexcept {
   Initialize(LruListAccessor{}, node);
 }
 
+LruListNode* GetEvictionQueue(CachePoolImpl* pool,
+                              EvictionSegment segment) noexcept {
+  switch (segment) {
+    case EvictionSegment::kProbation:
+      return &pool->probation_queue_;
+    case EvictionSegment::kProtected:
+      return &pool->protected_queue_;
+    default:
+      return &pool->eviction_queue_;
+  }
+}
+
+size_t& GetEvictionQueueBytes(CachePoolImpl* pool,
+                              EvictionSegment segment) noexcept {
+  return pool->eviction_queue_bytes_[static_cast<size_t>(segment)];
+}
+
+/// Returns the entry at the front of the eviction queue for `segment`, or
+/// `nullptr` if the queue is empty.
+CacheEntryImpl* GetEvictionQueueFront(CachePoolImpl* pool,
+                                      EvictionSegment segment) noexcept {
+  auto* queue = GetEvictionQueue(pool, segment);
+  if (queue->next == queue) return nullptr;
+  return static_cast<CacheEntryImpl*>(queue->next);
+}
+
+/// Links `entry` at the back of the eviction queue for `segment`.
+void LinkIntoEvictionQueue(CachePoolImpl* pool, CacheEntryImpl* entry,
+                           EvictionSegment segment) noexcept {
+  DebugAssertMutexHeld(&pool->mutex_);
+  entry->eviction_segment_ = segment;
+  InsertBefore(LruListAccessor{}, GetEvictionQueue(pool, segment), entry);
+  GetEvictionQueueBytes(pool, segment) += entry->num_bytes_;
+}
+
+/// Unlinks `entry`, which must be in state `clean_and_not_in_use`, from its
+/// eviction queue.
+void UnlinkFromEvictionQueue(CachePoolImpl* pool,
+                             CacheEntryImpl* entry) noexcept {
+  DebugAssertMutexHeld(&pool->mutex_);
+  UnlinkListNode(entry);
+  GetEvictionQueueBytes(pool, entry->eviction_segment_) -= entry->num_bytes_;
+}
+
+/// Returns `true` if entries in `state` count towards
+/// `CachePoolImpl::pending_writeback_bytes_`.
+bool IsPendingWriteback(CacheEntryQueueState state) {
+  return state == CacheEntryQueueState::dirty ||
+         state == CacheEntryQueueState::writeback_requested;
+}
+
+/// Starts or stops delaying non-transactional writes after
+/// `pool->pending_writeback_bytes_` has changed.
+///
+/// When writes resume, `pool->writeback_resume_promise_` is left set, and is
+/// marked ready by `UnlockPool`.
+void UpdateWritebackBackpressure(CachePoolImpl* pool) noexcept {
+  DebugAssertMutexHeld(&pool->mutex_);
+  const auto& limits = pool->limits_;
+  if (limits.writeback_high_water_bytes == 0) return;
+  if (pool->writeback_throttled_) {
+    if (pool->pending_writeback_bytes_ > limits.writeback_low_water_bytes) {
+      return;
+    }
+    pool->writeback_throttled_ = false;
+  } else if (pool->pending_writeback_bytes_ >
+             limits.writeback_high_water_bytes) {
+    writeback_throttle_count.Increment();
+    pool->writeback_throttled_ = true;
+    // If writes resumed since `mutex_` was locked, the existing promise has not
+    // yet become ready and can be reused.
+    if (pool->writeback_resume_promise_.null()) {
+      auto [promise, future] = PromiseFuturePair<void>::Make(MakeResult());
+      pool->writeback_resume_promise_ = std::move(promise);
+      pool->writeback_resume_future_ = std::move(future);
+    }
+  }
+}
+
 void UnregisterEntryFromPool(CacheEntryImpl* entry,
                              CachePoolImpl* pool) noexcept {
   DebugAssertMutexHeld(&pool->mutex_);
-  UnlinkListNode(entry);
+  if (entry->queue_state_ == CacheEntryQueueState::clean_and_not_in_use) {
+    UnlinkFromEvictionQueue(pool, entry);
+  } else {
+    UnlinkListNode(entry);
+  }
   pool->total_bytes_ -= entry->num_bytes_;
   if (entry->queue_state_ == CacheEntryQueueState::dirty) {
     pool->queued_for_writeback_bytes_ -= entry->num_bytes_;
   }
+  if (IsPendingWriteback(entry->queue_state_)) {
+    pool->pending_writeback_bytes_ -= entry->num_bytes_;
+    UpdateWritebackBackpressure(pool);
+  }
 }
 
+/// Removes `entry` from its cache, unless it is in use.
+///
+/// \returns `true` if `entry` was removed, in which case it must be evicted by
+///     calling `EvictEntry`.
+bool TryRemoveUnusedEntry(CacheEntryImpl* entry) noexcept {
+  DebugAssertMutexHeld(&entry->cache_->pool_->mutex_);
+  auto* shard = entry->shard_;
+  absl::MutexLock lock(&shard->mutex);
+  if (entry->reference_count_.load(std::memory_order_acquire) != 0) {
+    return false;
+  }
+  shard->entries.erase(entry);
+  return true;
+}
+
+/// Unregisters `entry`, which must already have been removed from its cache,
+/// from the pool, and destroys it.
 void EvictEntry(CacheEntryImpl* entry) noexcept ABSL_NO_THREAD_SAFETY_ANALYSIS {
   evict_count.Increment();
   auto* pool = entry->cache_->pool_;
   DebugAssertMutexHeld(&pool->mutex_);
   UnregisterEntryFromPool(entry, pool);
-  // Note: If this is being called from `GetCacheEntryInternal` because an
-  // exception was thrown while inserting `entry` into
-  // `entry->cache_->entries_`, `entry` won't be in `entry->caches_`.
-  auto& entries = entry->cache_->entries_;
-  entries.erase(entry);
   {
     // Hold a reference to `cache` before releasing the mutex to ensure `cache`
     // is not destroyed.
@@ -140,17 +366,25 @@ void EvictEntry(CacheEntryImpl* entry) noexcept ABSL_NO_THREAD_SAFETY_ANALYSIS {
 }
 
 void EnsureNotOnCleanList(CacheEntryImpl* entry) noexcept {
-  DebugAssertMutexHeld(&entry->cache_->pool_->mutex_);
+  auto* pool = entry->cache_->pool_;
+  DebugAssertMutexHeld(&pool->mutex_);
   if (entry->queue_state_ == CacheEntryQueueState::clean_and_not_in_use) {
-    UnlinkListNode(entry);
+    UnlinkFromEvictionQueue(pool, entry);
     entry->queue_state_ = CacheEntryQueueState::clean_and_in_use;
   }
 }
 
+/// Adds `entry`, which has just become not in use, to the back of its eviction
+/// queue.
 void AddToEvictionQueue(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept {
   DebugAssertMutexHeld(&pool->mutex_);
-  auto* eviction_queue = &pool->eviction_queue_;
-  InsertBefore(LruListAccessor{}, eviction_queue, entry);
+  EvictionSegment segment = entry->eviction_segment_;
+  if (segment == EvictionSegment::kProbation) {
+    // The entry has been accessed again since it was admitted to the main
+    // region.
+    segment = EvictionSegment::kProtected;
+  }
+  LinkIntoEvictionQueue(pool, entry, segment);
 }
 
 void AddToWritebackQueue(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept {
@@ -159,27 +393,120 @@ void AddToWritebackQueue(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept {
   InsertBefore(LruListAccessor{}, queue, entry);
 }
 
+/// Evicts `entry`, which must be in an eviction queue, unless it is in use.
+///
+/// In either case, `entry` is removed from the eviction queue.  Note that
+/// `pool->mutex_` may be released temporarily, in which case the eviction
+/// queues may be modified by another thread.
+void TryEvictEntry(CacheEntryImpl* entry) noexcept {
+  if (!TryRemoveUnusedEntry(entry)) {
+    // `entry` was acquired by `GetCacheEntryInternal` without being removed
+    // from the eviction queue, either because `pool->mutex_` was held by
+    // another thread at the time, or because of the eviction policy.
+    EnsureNotOnCleanList(entry);
+    return;
+  }
+  EvictEntry(entry);
+}
+
+void MaybeEvictEntriesLru(CachePoolImpl* pool) noexcept {
+  while (pool->total_bytes_ > pool->limits_.total_bytes_limit) {
+    auto* entry = GetEvictionQueueFront(pool, EvictionSegment::kWindow);
+    if (!entry) break;
+    TryEvictEntry(entry);
+  }
+}
+
+void MaybeEvictEntriesClock(CachePoolImpl* pool) noexcept {
+  while (pool->total_bytes_ > pool->limits_.total_bytes_limit) {
+    auto* entry = GetEvictionQueueFront(pool, EvictionSegment::kWindow);
+    if (!entry) break;
+    if (entry->referenced_.exchange(false, std::memory_order_relaxed)) {
+      // Give the recently-accessed entry a second chance by advancing the
+      // clock hand past it.
+      UnlinkListNode(entry);
+      InsertBefore(LruListAccessor{}, &pool->eviction_queue_, entry);
+      continue;
+    }
+    TryEvictEntry(entry);
+  }
+}
+
+/// Returns `percent` percent of `x`, without overflow.
+size_t GetPercentage(size_t x, size_t percent) {
+  return x / 100 * percent + x % 100 * percent / 100;
+}
+
+void MaybeEvictEntriesTinyLfu(CachePoolImpl* pool) noexcept {
+  const size_t total_bytes_limit = pool->limits_.total_bytes_limit;
+  const size_t window_bytes_limit =
+      GetPercentage(total_bytes_limit, kTinyLfuWindowPercent);
+  const size_t protected_bytes_limit = GetPercentage(
+      total_bytes_limit - window_bytes_limit, kTinyLfuProtectedPercent);
+  auto& sketch = *pool->frequency_sketch_;
+  while (pool->total_bytes_ > total_bytes_limit) {
+    // Entry that would be evicted from the main region.
+    auto* victim = GetEvictionQueueFront(pool, EvictionSegment::kProbation);
+    if (!victim) {
+      victim = GetEvictionQueueFront(pool, EvictionSegment::kProtected);
+    }
+    // Entry that would be admitted next from the window to the main region.
+    // While entries are being added, the window is normally full, so this is
+    // considered a candidate for admission even if it has not yet overflowed
+    // the window.
+    auto* candidate = GetEvictionQueueFront(pool, EvictionSegment::kWindow);
+    if (!victim) {
+      if (!candidate) break;
+      victim = candidate;
+    } else if (candidate && sketch.Estimate(candidate->sketch_hash_) <=
+                                sketch.Estimate(victim->sketch_hash_)) {
+      // Reject the candidate, since it is not accessed more frequently than
+      // the entry that it would replace.
+      victim = candidate;
+    }
+    TryEvictEntry(victim);
+  }
+  // Admit the entries that overflow the window to the main region.
+  while (GetEvictionQueueBytes(pool, EvictionSegment::kWindow) >
+         window_bytes_limit) {
+    auto* entry = GetEvictionQueueFront(pool, EvictionSegment::kWindow);
+    UnlinkFromEvictionQueue(pool, entry);
+    LinkIntoEvictionQueue(pool, entry, EvictionSegment::kProbation);
+  }
+  // Demote the entries that overflow the protected segment.
+  while (GetEvictionQueueBytes(pool, EvictionSegment::kProtected) >
+         protected_bytes_limit) {
+    auto* entry = GetEvictionQueueFront(pool, EvictionSegment::kProtected);
+    UnlinkFromEvictionQueue(pool, entry);
+    LinkIntoEvictionQueue(pool, entry, EvictionSegment::kProbation);
+  }
+}
+
 void MaybeEvictEntries(CachePoolImpl* pool) noexcept {
   DebugAssertMutexHeld(&pool->mutex_);
-  while (pool->total_bytes_ > pool->limits_.total_bytes_limit) {
-    auto* queue = &pool->eviction_queue_;
-    if (queue->next == queue) {
-      // Queue empty.
+  switch (pool->limits_.eviction_policy) {
+    case CacheEvictionPolicy::kLru:
+      MaybeEvictEntriesLru(pool);
+      break;
+    case CacheEvictionPolicy::kClock:
+      MaybeEvictEntriesClock(pool);
+      break;
+    case CacheEvictionPolicy::kTinyLfu:
+      MaybeEvictEntriesTinyLfu(pool);
       break;
-    }
-    auto* entry = static_cast<CacheEntryImpl*>(queue->next);
-    EvictEntry(entry);
   }
 }
 
-void InitializeNewEntry(CacheEntryImpl* entry, CacheImpl* cache) noexcept {
-  auto* pool = cache->pool_;
+void InitializeNewEntry(CacheEntryImpl* entry, CacheImpl* cache,
+                        CacheEntryShard* shard) noexcept {
+  // The entry is not added to any queue, and its size is zero, so there is no
+  // need to update the pool.
   entry->cache_ = cache;
+  entry->shard_ = shard;
   entry->reference_count_.store(1, std::memory_order_relaxed);
   entry->num_bytes_ = 0;
   entry->queue_state_ = CacheEntryQueueState::clean_and_in_use;
-  pool->total_bytes_ += entry->num_bytes_;
-  MaybeEvictEntries(pool);
+  entry->eviction_segment_ = EvictionSegment::kWindow;
   Initialize(LruListAccessor{}, entry);
 }
 
@@ -200,8 +527,11 @@ void RequestWriteback(CachePoolImpl* pool, CacheEntryImpl* entry) {
 
 void MaybeWritebackEntries(CachePoolImpl* pool) {
   DebugAssertMutexHeld(&pool->mutex_);
+  // While writes are delayed, request writeback of all dirty entries, since
+  // writes only resume once their writeback completes.
   while (pool->queued_for_writeback_bytes_ >
-         pool->limits_.queued_for_writeback_bytes_limit) {
+             pool->limits_.queued_for_writeback_bytes_limit ||
+         (pool->writeback_throttled_ && pool->queued_for_writeback_bytes_ > 0)) {
     auto* queue = &pool->writeback_queue_;
     assert(queue->next != queue);
     auto* entry = static_cast<CacheEntryImpl*>(queue->next);
@@ -225,39 +555,191 @@ void SetStateAndSize(CacheEntryImpl* entry, CacheEntryQueueState state,
   if (old_state == CacheEntryQueueState::dirty) {
     pool->queued_for_writeback_bytes_ -= old_num_bytes;
   }
+  if (IsPendingWriteback(old_state)) {
+    pool->pending_writeback_bytes_ -= old_num_bytes;
+  }
+  if (IsPendingWriteback(state)) {
+    pool->pending_writeback_bytes_ += num_bytes;
+  }
+  UpdateWritebackBackpressure(pool);
 
-  UnlinkListNode(entry);
+  if (old_state == CacheEntryQueueState::clean_and_not_in_use) {
+    UnlinkFromEvictionQueue(pool, entry);
+  } else {
+    UnlinkListNode(entry);
+  }
   entry->queue_state_ = state;
   entry->num_bytes_ = num_bytes;
 
   if (state == CacheEntryQueueState::clean_and_not_in_use) {
     AddToEvictionQueue(pool, entry);
-    if (entry->evict_when_not_in_use_) {
+    if (entry->evict_when_not_in_use_ && TryRemoveUnusedEntry(entry)) {
       EvictEntry(entry);
     }
   } else if (state == CacheEntryQueueState::dirty) {
     AddToWritebackQueue(pool, entry);
     pool->queued_for_writeback_bytes_ += num_bytes;
+  }
+  if (state == CacheEntryQueueState::dirty || pool->writeback_throttled_) {
     MaybeWritebackEntries(pool);
   }
   MaybeEvictEntries(pool);
 }
 
+/// Releases a reference to `entry` that may be the last one.
+///
+/// If the reference count becomes zero, moves `entry` to the back of the
+/// eviction queue (if it is clean), and appends the cache reference held by
+/// `entry` to `released_caches`.
+void ReleaseEntryReferenceLocked(
+    CacheEntryImpl* entry, ReleasedCacheReferences& released_caches) noexcept {
+  auto* cache = entry->cache_;
+  auto* pool = cache->pool_;
+  DebugAssertMutexHeld(&pool->mutex_);
+  {
+    absl::MutexLock lock(&entry->shard_->mutex);
+    if (entry->reference_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+  }
+  switch (entry->queue_state_) {
+    case CacheEntryQueueState::clean_and_in_use:
+      SetStateAndSize(entry, CacheEntryQueueState::clean_and_not_in_use,
+                      entry->num_bytes_);
+      // `entry` may not be valid at this point.
+      break;
+    case CacheEntryQueueState::clean_and_not_in_use:
+      // `entry` was acquired by `GetCacheEntryInternal` without being removed
+      // from the eviction queue.  With the CLOCK policy, its reference bit
+      // already records the access.  Otherwise, move it to the back, as if it
+      // had been removed.
+      if (pool->limits_.eviction_policy != CacheEvictionPolicy::kClock) {
+        UnlinkFromEvictionQueue(pool, entry);
+        AddToEvictionQueue(pool, entry);
+      }
+      if (entry->evict_when_not_in_use_ && TryRemoveUnusedEntry(entry)) {
+        EvictEntry(entry);
+      }
+      MaybeEvictEntries(pool);
+      break;
+    default:
+      break;
+  }
+  // Release the reference to `cache` held by `entry`.  If this may be the
+  // last reference, it must be released after unlocking `pool->mutex_`.
+  if (!internal::DecrementReferenceCountIfGreaterThanOne(
+          cache->reference_count_)) {
+    released_caches.push_back(cache);
+  }
+}
+
+/// Releases all deferred entry references.
+void DrainDeferredReleases(CachePoolImpl* pool,
+                           ReleasedCacheReferences& released_caches) noexcept {
+  DebugAssertMutexHeld(&pool->mutex_);
+  if (pool->num_deferred_releases_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  absl::InlinedVector<CacheEntryImpl*, kMaxDeferredReleasesPerBuffer> entries;
+  for (auto& buffer : pool->release_buffers_) {
+    {
+      absl::MutexLock lock(&buffer.mutex);
+      entries.assign(buffer.entries.begin(), buffer.entries.end());
+      buffer.entries.clear();
+      pool->num_deferred_releases_.fetch_sub(entries.size(),
+                                             std::memory_order_relaxed);
+    }
+    for (auto* entry : entries) {
+      ReleaseEntryReferenceLocked(entry, released_caches);
+    }
+  }
+}
+
+/// Returns the index of the release buffer used by the current thread.
+size_t GetReleaseBufferIndex() {
+  static std::atomic<size_t> next_index{0};
+  thread_local size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed) % kNumCacheShards;
+  return index;
+}
+
+/// Defers the release of a reference to `entry` that may be the last one, for
+/// use when `pool->mutex_` could not be acquired immediately.
+///
+/// \returns `false` if the release buffer is full, in which case the caller
+///     must release the reference itself.
+bool DeferEntryRelease(CachePoolImpl* pool,
+                       CacheEntryImpl* entry) noexcept
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  auto& buffer = pool->release_buffers_[GetReleaseBufferIndex()];
+  // Once `entry` is added to the buffer, it may be released by another thread
+  // at any time; hold a weak reference to ensure `pool` remains valid.
+  CachePoolWeakPtr weak_pool(Access::StaticCast<CachePool>(pool));
+  {
+    absl::MutexLock lock(&buffer.mutex);
+    if (buffer.entries.size() == kMaxDeferredReleasesPerBuffer) return false;
+    buffer.entries.push_back(entry);
+    pool->num_deferred_releases_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // If the thread that holds `pool->mutex_` unlocked it before the entry was
+  // added to the buffer, it will not have released the entry; try again to
+  // acquire the mutex in order to release it.  Paired with the fence in
+  // `UnlockPool`.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (pool->mutex_.TryLock()) {
+    UnlockPool(pool);
+  }
+  return true;
+}
+
+/// Unlocks `pool->mutex_`, first releasing any deferred entry references.
+void UnlockPool(CachePoolImpl* pool) noexcept ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  // Once the mutex is unlocked, the reference to `pool` held by the caller may
+  // be released by another thread.
+  AcquireWeakReference(pool);
+  ReleasedCacheReferences released_caches;
+  Promise<void> writeback_resume_promise;
+  while (true) {
+    DrainDeferredReleases(pool, released_caches);
+    if (!pool->writeback_throttled_ &&
+        !pool->writeback_resume_promise_.null()) {
+      writeback_resume_promise = std::move(pool->writeback_resume_promise_);
+      pool->writeback_resume_future_ = {};
+    }
+    pool->mutex_.Unlock();
+    // A release may have been deferred after `DrainDeferredReleases` returned
+    // but before `pool->mutex_` was unlocked, in which case the deferring
+    // thread may have failed to acquire the mutex.  Paired with the fence in
+    // `DeferEntryRelease`.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (pool->num_deferred_releases_.load(std::memory_order_relaxed) == 0 ||
+        !pool->mutex_.TryLock()) {
+      break;
+    }
+  }
+  // Resume any delayed writes.
+  if (!writeback_resume_promise.null()) writeback_resume_promise.SetReady();
+  ReleaseCacheReferences(released_caches);
+  ReleaseWeakReference(pool);
+}
+
 void DestroyCache(CacheImpl* cache) noexcept {
-  for (CacheEntryImpl* entry : cache->entries_) {
-    delete Access::StaticCast<Cache::Entry>(entry);
+  for (auto& shard : cache->entry_shards_) {
+    for (CacheEntryImpl* entry : shard.entries) {
+      delete Access::StaticCast<Cache::Entry>(entry);
+    }
   }
   delete Access::StaticCast<Cache>(cache);
 }
 
 /// Decrements `*reference_count` in such a way that it only reaches zero while
-/// `mutex` is held.
+/// `pool->mutex_` is held.
 ///
-/// If `*reference_count` was decremented to zero, returns a lock on `mutex`.
-/// Otherwise, returns an unlocked `UniqueWriterLock`.
+/// If `*reference_count` was decremented to zero, returns a lock on `pool`.
+/// Otherwise, returns an unlocked `PoolLock`.
 template <typename T>
-inline UniqueWriterLock<absl::Mutex> DecrementReferenceCountWithLock(
-    std::atomic<T>* reference_count, absl::Mutex& mutex) {
+inline PoolLock DecrementReferenceCountWithLock(std::atomic<T>* reference_count,
+                                                CachePoolImpl* pool) {
   // If the new reference count will be > 0, we can simply decrement it.
   // However, if the reference count will possibly become 0, we must lock the
   // mutex before decrementing it to ensure that another thread doesn't
@@ -268,7 +750,7 @@ inline UniqueWriterLock<absl::Mutex> DecrementReferenceCountWithLock(
 
   // Handle the case of the reference_count possibly becoming 0.
 
-  UniqueWriterLock lock(mutex);
+  PoolLock lock(*pool);
   // Reference count may have changed between the time at which we last
   // checked it and the time at which we acquired the mutex.
   if (reference_count->fetch_sub(1, std::memory_order_acq_rel) != 1) {
@@ -280,20 +762,27 @@ inline UniqueWriterLock<absl::Mutex> DecrementReferenceCountWithLock(
 
 }  // namespace
 
-void StrongPtrTraitsCacheEntry::decrement(CacheEntry* p) noexcept {
+void StrongPtrTraitsCacheEntry::decrement(CacheEntry* p) noexcept
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
   auto* entry = Access::StaticCast<CacheEntryImpl>(p);
-  auto* cache = entry->cache_;
-  {
-    auto lock = DecrementReferenceCountWithLock(&entry->reference_count_,
-                                                cache->pool_->mutex_);
-    if (!lock) return;
-    if (entry->queue_state_ == CacheEntryQueueState::clean_and_in_use) {
-      SetStateAndSize(entry, CacheEntryQueueState::clean_and_not_in_use,
-                      entry->num_bytes_);
-      // `entry` may not be valid at this point.
-    }
+  // If the new reference count will be > 0, we can simply decrement it.
+  if (internal::DecrementReferenceCountIfGreaterThanOne(
+          entry->reference_count_)) {
+    return;
+  }
+  // Releasing what may be the last reference requires `pool->mutex_` in order
+  // to update the queue state.  Rather than wait for another thread to unlock
+  // it, hand off the reference to that thread.
+  auto* pool = entry->cache_->pool_;
+  if (!pool->mutex_.TryLock()) {
+    if (DeferEntryRelease(pool, entry)) return;
+    pool->mutex_.Lock();
   }
-  StrongPtrTraitsCache::decrement(Access::StaticCast<Cache>(cache));
+  PoolLock lock(*pool, std::adopt_lock);
+  ReleasedCacheReferences released_caches;
+  ReleaseEntryReferenceLocked(entry, released_caches);
+  lock.unlock();
+  ReleaseCacheReferences(released_caches);
 }
 
 CachePtr<Cache> GetCacheInternal(
@@ -303,7 +792,7 @@ CachePtr<Cache> GetCacheInternal(
   CachePoolImpl::CacheKey key(cache_type, cache_key);
   if (!cache_key.empty()) {
     // An non-empty key indicates to look for an existing cache.
-    absl::MutexLock lock(&pool->mutex_);
+    PoolLock lock(*pool);
     auto it = pool->caches_.find(key);
     if (it != pool->caches_.end()) {
       return AcquireCacheStrongPtr(*it);
@@ -321,7 +810,7 @@ CachePtr<Cache> GetCacheInternal(
   }
   cache_impl->cache_type_ = &cache_type;
   cache_impl->cache_identifier_ = std::string(cache_key);
-  absl::MutexLock lock(&pool->mutex_);
+  PoolLock lock(*pool);
   auto insert_result = pool->caches_.insert(cache_impl);
   if (insert_result.second) {
     new_cache.release();
@@ -331,15 +820,32 @@ CachePtr<Cache> GetCacheInternal(
 }
 
 PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
-                                              std::string_view key) {
+                                              std::string_view key)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
   auto* cache_impl = Access::StaticCast<CacheImpl>(cache);
+  auto* pool = cache_impl->pool_;
+  const auto& metric_cells = GetPolicyMetricCells(pool->limits_.eviction_policy);
+  const size_t key_hash = absl::HashOf(key);
+  auto& shard = cache_impl->GetEntryShard(key_hash);
+  uint64_t sketch_hash = 0;
+  if (auto* sketch = pool->frequency_sketch_.get()) {
+    sketch_hash = absl::HashOf(key_hash, cache_impl);
+    sketch->Increment(sketch_hash);
+  }
   PinnedCacheEntry<Cache> returned_entry;
+  CacheEntryImpl* unused_entry = nullptr;
   {
-    absl::MutexLock lock(&cache_impl->pool_->mutex_);
-    auto it = cache_impl->entries_.find(key);
-    if (it != cache_impl->entries_.end()) {
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
       hit_count.Increment();
+      metric_cells.hit_count->Increment();
       auto* entry_impl = *it;
+      if (pool->limits_.eviction_policy == CacheEvictionPolicy::kClock) {
+        if (!entry_impl->referenced_.load(std::memory_order_relaxed)) {
+          entry_impl->referenced_.store(true, std::memory_order_relaxed);
+        }
+      }
       if (entry_impl->reference_count_.fetch_add(
               1, std::memory_order_acq_rel) == 0) {
         // When the first reference to an entry is acquired, also acquire a
@@ -347,7 +853,11 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
         // the Cache object is not destroyed while any of its entries are
         // referenced.
         StrongPtrTraitsCache::increment(cache);
-        EnsureNotOnCleanList(entry_impl);
+        // With the CLOCK policy, the entry remains in the eviction queue until
+        // the clock hand reaches it.
+        if (pool->limits_.eviction_policy != CacheEvictionPolicy::kClock) {
+          unused_entry = entry_impl;
+        }
       }
       // Adopt reference added via `fetch_add` above.
       returned_entry =
@@ -355,26 +865,37 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
                                   internal::adopt_object_ref);
     } else {
       miss_count.Increment();
+      metric_cells.miss_count->Increment();
       std::string temp_key(key);  // May throw, done before allocating entry.
       auto* entry_impl =
           Access::StaticCast<CacheEntryImpl>(cache->DoAllocateEntry());
-      entry_impl->key_ = std::move(temp_key);      // noexcept
-      InitializeNewEntry(entry_impl, cache_impl);  // noexcept
-      struct EvictEntryDeleter {
-        void operator()(CacheEntry* entry) const noexcept {
-          EvictEntry(Access::StaticCast<CacheEntryImpl>(entry));
-        }
-      };
-      std::unique_ptr<CacheEntry, EvictEntryDeleter> entry(
+      entry_impl->key_ = std::move(temp_key);               // noexcept
+      entry_impl->sketch_hash_ = sketch_hash;
+      InitializeNewEntry(entry_impl, cache_impl, &shard);  // noexcept
+      std::unique_ptr<CacheEntry> entry(
           Access::StaticCast<CacheEntry>(entry_impl));
-      // Add to entries table.  This may throw, in which case the entry will be
-      // cleaned up by `EvictEntry`.
-      cache_impl->entries_.insert(entry_impl);
+      // Add to entries table.  This may throw, in which case the entry, which
+      // is not yet known to the pool, is simply deleted.
+      shard.entries.insert(entry_impl);
       StrongPtrTraitsCache::increment(cache);
       returned_entry =
           PinnedCacheEntry<Cache>(entry.release(), internal::adopt_object_ref);
     }
   }
+  if (unused_entry) {
+    // Remove the entry from the eviction queue.  If `pool->mutex_` is held by
+    // another thread, leave it to `MaybeEvictEntries` to skip the entry, rather
+    // than wait.
+    if (pool->mutex_.TryLock()) {
+      PoolLock lock(*pool, std::adopt_lock);
+      // The reference may already have been released by another thread, in
+      // which case the entry must remain in the eviction queue.  The reference
+      // count cannot concurrently become zero while `pool->mutex_` is held.
+      if (unused_entry->reference_count_.load(std::memory_order_acquire) != 0) {
+        EnsureNotOnCleanList(unused_entry);
+      }
+    }
+  }
   absl::call_once(
       Access::StaticCast<CacheEntryImpl>(returned_entry.get())->initialized_,
       [&] {
@@ -395,8 +916,7 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
 void StrongPtrTraitsCache::decrement(Cache* p) noexcept {
   auto* cache = Access::StaticCast<CacheImpl>(p);
   auto* pool = cache->pool_;
-  auto lock = DecrementReferenceCountWithLock(&cache->reference_count_,
-                                              cache->pool_->mutex_);
+  auto lock = DecrementReferenceCountWithLock(&cache->reference_count_, pool);
   if (!lock) return;
   const bool owned_by_pool = !cache->cache_identifier_.empty();
 
@@ -407,8 +927,10 @@ void StrongPtrTraitsCache::decrement(Cache* p) noexcept {
     }
     // This cache has no identifier, or the CachePool has no strong references
     // currently.  Destroy it and all of its entries.
-    for (CacheEntryImpl* entry : cache->entries_) {
-      UnregisterEntryFromPool(entry, pool);
+    for (auto& shard : cache->entry_shards_) {
+      for (CacheEntryImpl* entry : shard.entries) {
+        UnregisterEntryFromPool(entry, pool);
+      }
     }
 
     lock.unlock();
@@ -417,7 +939,7 @@ void StrongPtrTraitsCache::decrement(Cache* p) noexcept {
     return;
   }
 
-  if (cache->entries_.empty()) {
+  if (cache->entries_empty()) {
     // The cache contains no entries.  Remove it from the pool's table of
     // caches, and destroy it.
     pool->caches_.erase(cache);
@@ -444,8 +966,7 @@ void StrongPtrTraitsCachePool::increment(CachePool* p) noexcept {
 
 void StrongPtrTraitsCachePool::decrement(CachePool* p) noexcept {
   auto* pool = Access::StaticCast<CachePoolImpl>(p);
-  auto lock =
-      DecrementReferenceCountWithLock(&pool->strong_references_, pool->mutex_);
+  auto lock = DecrementReferenceCountWithLock(&pool->strong_references_, pool);
   if (!lock) return;
   std::vector<CachePtr<Cache>> caches;
   caches.reserve(pool->caches_.size());
@@ -475,6 +996,14 @@ namespace internal {
 Cache::Cache() = default;
 Cache::~Cache() = default;
 
+Future<const void> Cache::WritebackBackpressure() {
+  auto* pool =
+      internal_cache::Access::StaticCast<internal_cache::CacheImpl>(this)->pool_;
+  internal_cache::PoolLock lock(*pool);
+  if (!pool->writeback_throttled_) return MakeReadyFuture();
+  return pool->writeback_resume_future_;
+}
+
 std::size_t Cache::DoGetSizeInBytes(Cache::Entry* entry) {
   return ((internal_cache::CacheEntryImpl*)entry)->key_.capacity() +
          this->DoGetSizeofEntry();
@@ -490,7 +1019,7 @@ void Cache::Entry::UpdateState(StateUpdate update) {
       internal_cache::Access::StaticCast<internal_cache::CacheImpl>(cache_);
   auto* pool = cache_impl->pool_;
   // Acquire `pool->mutex_` and then release `update.lock`.
-  UniqueWriterLock lock(pool->mutex_);
+  internal_cache::PoolLock lock(*pool);
   update.lock = nullptr;
   std::size_t old_num_bytes = num_bytes_;
   std::size_t new_num_bytes = update.new_size.value_or(old_num_bytes);
@@ -506,9 +1035,17 @@ void Cache::Entry::UpdateState(StateUpdate update) {
   std::size_t num_bytes_change =
       wrap_on_overflow::Subtract(new_num_bytes, old_num_bytes);
   pool->total_bytes_ += num_bytes_change;
+  if (queue_state_ == CacheEntryQueueState::clean_and_not_in_use) {
+    internal_cache::GetEvictionQueueBytes(pool, eviction_segment_) +=
+        num_bytes_change;
+  }
+  if (internal_cache::IsPendingWriteback(queue_state_)) {
+    pool->pending_writeback_bytes_ += num_bytes_change;
+    internal_cache::UpdateWritebackBackpressure(pool);
+  }
   if (queue_state_ == CacheEntryQueueState::dirty) {
     pool->queued_for_writeback_bytes_ += num_bytes_change;
-    if (new_num_bytes > old_num_bytes) {
+    if (new_num_bytes > old_num_bytes || pool->writeback_throttled_) {
       internal_cache::MaybeWritebackEntries(pool);
     }
   }
@@ -545,7 +1082,7 @@ CachePool::StrongPtr::StrongPtr(const CachePool::WeakPtr& ptr)
   auto* pool =
       internal_cache::Access::StaticCast<internal_cache::CachePoolImpl>(
           ptr.get());
-  absl::MutexLock lock(&pool->mutex_);
+  internal_cache::PoolLock lock(*pool);
   if (pool->strong_references_.fetch_add(1, std::memory_order_acq_rel) == 0) {
     internal_cache::AcquireWeakReference(pool);
   }
@@ -92,6 +92,7 @@
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/internal/poly/poly.h"
+#include "tensorstore/util/future.h"
 
 namespace tensorstore {
 namespace internal {
@@ -332,6 +333,33 @@ class Cache : private internal_cache::CacheImpl {
   /// pointer to this same cache.
   std::string_view cache_identifier() const { return cache_identifier_; }
 
+  /// Returns the limits of the cache pool that contains this cache.
+  const CachePoolLimits& pool_limits() const { return pool_->limits_; }
+
+  /// Returns the encoded value tier of the cache pool, or `nullptr` if the
+  /// pool does not retain encoded values (see
+  /// `CachePoolLimits::encoded_bytes_limit`).
+  internal_cache::EncodedValueCache* encoded_value_cache() const {
+    return pool_->encoded_value_cache_.get();
+  }
+
+  /// Returns a future that becomes ready once the cache pool accepts new
+  /// non-transactional writes.
+  ///
+  /// The returned future is ready unless the total size of the entries with
+  /// pending writeback has exceeded
+  /// `CachePoolLimits::writeback_high_water_bytes`, in which case it becomes
+  /// ready once the size falls to `CachePoolLimits::writeback_low_water_bytes`.
+  Future<const void> WritebackBackpressure();
+
+  /// Returns the writeback scheduler of the cache pool, or `nullptr` if the
+  /// pool does not limit writeback concurrency (see
+  /// `CachePoolLimits::writeback_encode_concurrency` and
+  /// `CachePoolLimits::writeback_io_concurrency`).
+  internal_cache::WritebackScheduler* writeback_scheduler() const {
+    return pool_->writeback_scheduler_.get();
+  }
+
   /// Allocates a new `entry` to be stored in this cache.
   ///
   /// Usually this method can be defined as:
@@ -17,6 +17,9 @@
 
 // IWYU pragma: private, include "third_party/tensorstore/internal/cache/cache.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -24,13 +27,19 @@
 #include <string_view>
 #include <typeindex>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/base/optimization.h"
 #include "absl/functional/function_ref.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorstore/internal/cache/cache_pool_limits.h"
+#include "tensorstore/internal/cache/encoded_value_cache.h"
+#include "tensorstore/internal/cache/writeback_scheduler.h"
+#include "tensorstore/internal/cache/frequency_sketch.h"
 #include "tensorstore/internal/heterogeneous_container.h"
 #include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/util/future.h"
 
 namespace tensorstore {
 namespace internal {
@@ -43,6 +52,7 @@ namespace internal_cache {
 using internal::Cache;
 using internal::CacheEntry;
 using internal::CachePool;
+using internal::CacheEvictionPolicy;
 using internal::CachePoolLimits;
 
 class Access;
@@ -56,18 +66,65 @@ struct LruListNode {
   LruListNode* prev;
 };
 
+/// The entries of each cache are divided into `kNumCacheShards` shards by key
+/// hash, and each pool divides its deferred entry releases into the same
+/// number of buffers.
+constexpr int kCacheShardBits = 4;
+constexpr size_t kNumCacheShards = size_t{1} << kCacheShardBits;
+
+struct CacheEntryShard;
+
+/// Segment of the eviction queue of a `CachePoolImpl`.
+///
+/// Only the `CacheEvictionPolicy::kTinyLfu` policy uses segments other than
+/// `kWindow`.
+enum class EvictionSegment : uint8_t {
+  /// `CachePoolImpl::eviction_queue_`.
+  kWindow,
+  /// `CachePoolImpl::probation_queue_`.
+  kProbation,
+  /// `CachePoolImpl::protected_queue_`.
+  kProtected,
+};
+
+constexpr size_t kNumEvictionSegments = 3;
+
 class CacheEntryImpl : public internal_cache::LruListNode {
  public:
   CacheImpl* cache_;
+  CacheEntryShard* shard_;
   std::string key_;
   size_t num_bytes_;
   CacheEntryQueueState queue_state_;
   bool evict_when_not_in_use_ = false;
+  // Segment of the eviction queue to which this entry belongs.  If
+  // `queue_state_ == clean_and_not_in_use`, the entry is linked into the queue
+  // for this segment.
+  EvictionSegment eviction_segment_;
+  // Set when the entry is accessed, and cleared by the
+  // `CacheEvictionPolicy::kClock` policy as it scans the eviction queue.
+  std::atomic<bool> referenced_{false};
+  // Hash identifying this entry in `CachePoolImpl::frequency_sketch_`.
+  uint64_t sketch_hash_;
+  // May only change from or to zero while `shard_->mutex` is held.
   std::atomic<std::uint32_t> reference_count_;
   // Guards calls to `DoInitializeEntry`.
   absl::once_flag initialized_;
 };
 
+/// Subset of the entries of a cache.
+///
+/// Looking up an entry, and changing the reference count of an entry from or
+/// to zero, requires only the lock on the shard containing the entry, rather
+/// than the lock on the pool.  This allows concurrent lookups of different keys
+/// to proceed without contention.
+struct ABSL_CACHELINE_ALIGNED CacheEntryShard {
+  absl::Mutex mutex;
+  internal::HeterogeneousHashSet<CacheEntryImpl*, std::string_view,
+                                 &CacheEntryImpl::key_>
+      entries;
+};
+
 class CacheImpl {
  public:
   CacheImpl();
@@ -92,7 +149,8 @@ class CacheImpl {
   ///
   /// 1. `reference_count_` becomes zero; and
   ///
-  /// 2. `entries_` becomes empty or `pool_->strong_references_` becomes zero.
+  /// 2. `entry_shards_` becomes empty or `pool_->strong_references_` becomes
+  ///    zero.
   ///
   /// If empty, this cache is not stored in the `caches_` table of the cache
   /// pool, and is destroyed as soon as `reference_count_` becomes zero.
@@ -100,9 +158,17 @@ class CacheImpl {
 
   std::atomic<std::uint32_t> reference_count_;
 
-  internal::HeterogeneousHashSet<CacheEntryImpl*, std::string_view,
-                                 &CacheEntryImpl::key_>
-      entries_;
+  /// Entries of this cache, sharded by the hash of the key.
+  CacheEntryShard entry_shards_[kNumCacheShards];
+
+  /// Returns the shard that contains the entry with the specified key hash,
+  /// if it exists.
+  ///
+  /// \param key_hash Hash of the key, computed by `absl::HashOf(key)`.
+  CacheEntryShard& GetEntryShard(size_t key_hash);
+
+  /// Returns `true` if no shard contains any entries.
+  bool entries_empty() const;
 
   // Key by which a cache may be looked up in a `CachePool`.
   using CacheKey = std::pair<std::type_index, std::string_view>;
@@ -117,8 +183,12 @@ class CachePoolImpl {
   using CacheKey = CacheImpl::CacheKey;
 
   /// Protects access to `total_bytes_`, `queued_for_writeback_bytes_`,
-  /// `writeback_queue_`, `eviction_queue_`, `caches_`, and the `entries_` hash
-  /// tables of all caches associated with this pool.
+  /// `writeback_queue_`, the eviction queues, `caches_`, the writeback
+  /// backpressure state, and the queue state of all entries of caches
+  /// associated with this pool.
+  ///
+  /// Must be acquired before `CacheEntryShard::mutex` or
+  /// `ReleaseBuffer::mutex`, if both are held.
   absl::Mutex mutex_;
   CachePoolLimits limits_;
   size_t total_bytes_;
@@ -126,11 +196,67 @@ class CachePoolImpl {
   LruListNode writeback_queue_;
 
   // next points to the front of the queue, which is the first to be evicted.
+  // With `CacheEvictionPolicy::kTinyLfu`, this is the admission window.
   LruListNode eviction_queue_;
 
+  // Main region used by `CacheEvictionPolicy::kTinyLfu`, as a segmented LRU
+  // queue: entries admitted from the window enter the probation segment, and
+  // are promoted to the protected segment when accessed again.
+  LruListNode probation_queue_;
+  LruListNode protected_queue_;
+
+  // Total `num_bytes_` of the entries in each eviction queue, indexed by
+  // `EvictionSegment`.
+  size_t eviction_queue_bytes_[kNumEvictionSegments];
+
+  // Access frequencies used by `CacheEvictionPolicy::kTinyLfu` to decide
+  // whether to admit entries from the window to the main region.  Null for
+  // other policies.
+  std::unique_ptr<FrequencySketch> frequency_sketch_;
+
+  // Encoded values of kvstore-backed cache entries, retained so that evicted
+  // entries may be decoded again without re-reading them.  Null if
+  // `limits_.encoded_bytes_limit == 0`.
+  std::unique_ptr<EncodedValueCache> encoded_value_cache_;
+
+  // Bounds the concurrency of the writeback of kvstore-backed cache entries.
+  // Null if neither `limits_.writeback_encode_concurrency` nor
+  // `limits_.writeback_io_concurrency` is specified.
+  std::unique_ptr<WritebackScheduler> writeback_scheduler_;
+
+  // Total `num_bytes_` of the entries in the `dirty` or `writeback_requested`
+  // state.
+  size_t pending_writeback_bytes_;
+
+  // Set while non-transactional writes are delayed because
+  // `pending_writeback_bytes_` exceeded `limits_.writeback_high_water_bytes`.
+  bool writeback_throttled_;
+
+  // Becomes ready when writes resume.  Non-null while `writeback_throttled_`
+  // is set, and also after writes resume until `mutex_` is unlocked, since the
+  // promise must not become ready while `mutex_` is held.
+  Promise<void> writeback_resume_promise_;
+  Future<const void> writeback_resume_future_;
+
   internal::HeterogeneousHashSet<CacheImpl*, CacheKey, &CacheImpl::cache_key>
       caches_;
 
+  /// Entries whose last reference was released by a thread that could not
+  /// immediately acquire `mutex_`.  Each buffered entry retains the reference
+  /// that was being released; the reference is actually released, and the
+  /// entry added to the eviction queue, by the next thread to unlock `mutex_`.
+  ///
+  /// This avoids blocking on `mutex_` when releasing entries, which is the
+  /// most frequent operation that requires it.
+  struct ABSL_CACHELINE_ALIGNED ReleaseBuffer {
+    absl::Mutex mutex;
+    std::vector<CacheEntryImpl*> entries;
+  };
+  ReleaseBuffer release_buffers_[kNumCacheShards];
+
+  /// Total number of entries in `release_buffers_`.
+  std::atomic<size_t> num_deferred_releases_;
+
   /// Initial strong reference returned when the cache is created.
   std::atomic<std::size_t> strong_references_;
   /// One weak reference is kept until strong_references_ becomes 0.
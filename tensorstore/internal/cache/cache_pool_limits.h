@@ -20,10 +20,44 @@
 namespace tensorstore {
 namespace internal {
 
+/// Policy for selecting the entries to evict when a cache pool exceeds its
+/// `total_bytes_limit`.
+enum class CacheEvictionPolicy {
+  /// Evicts the least-recently used entry.
+  kLru,
+  /// Approximates LRU using a reference bit per entry, which avoids updating
+  /// the eviction queue when an entry is accessed.
+  kClock,
+  /// Window TinyLFU: new entries are admitted to a small LRU window, and
+  /// entries leaving the window are admitted to the main (segmented LRU) region
+  /// only if they have been accessed more frequently than the entry that would
+  /// be evicted in their place.  This prevents a single scan from flushing the
+  /// frequently-accessed working set.
+  kTinyLfu,
+};
+
 /// Memory limit parameters for a cache pool.
 struct CachePoolLimits {
   std::size_t total_bytes_limit = 0;
   std::size_t queued_for_writeback_bytes_limit = 0;
+  CacheEvictionPolicy eviction_policy = CacheEvictionPolicy::kLru;
+  /// Limit on the total size of the encoded values retained by the pool for
+  /// re-decoding evicted entries of kvstore-backed caches, including those
+  /// held by entries that are still resident.  A value of `0` disables this
+  /// tier.  This is in addition to `total_bytes_limit`.
+  std::size_t encoded_bytes_limit = 0;
+  /// If non-zero, non-transactional writes are delayed while the total size of
+  /// the entries with pending writeback (i.e. in the `dirty` or
+  /// `writeback_requested` state) exceeds this limit, until it falls to
+  /// `writeback_low_water_bytes`.
+  std::size_t writeback_high_water_bytes = 0;
+  std::size_t writeback_low_water_bytes = 0;
+  /// If non-zero, limits the number of kvstore-backed cache entries whose
+  /// writeback value is being encoded concurrently.
+  std::size_t writeback_encode_concurrency = 0;
+  /// If non-zero, limits the number of encoded writeback values being written
+  /// to the kvstore concurrently.
+  std::size_t writeback_io_concurrency = 0;
 };
 
 }  // namespace internal
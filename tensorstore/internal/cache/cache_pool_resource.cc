@@ -20,6 +20,7 @@
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/util/result.h"
 
@@ -47,7 +48,42 @@ struct CachePoolResourceTraits
                       jb::DefaultValue(
                           [obj](auto* v) { *v = obj->total_bytes_limit / 2; },
                           jb::Integer<std::size_t>(0, obj->total_bytes_limit)));
-                })));
+                })),
+        jb::Member("eviction_policy",
+                   jb::Projection(
+                       &Spec::eviction_policy,
+                       jb::DefaultValue(
+                           [](auto* v) { *v = CacheEvictionPolicy::kLru; },
+                           jb::Enum<CacheEvictionPolicy, std::string_view>({
+                               {CacheEvictionPolicy::kLru, "lru"},
+                               {CacheEvictionPolicy::kClock, "clock"},
+                               {CacheEvictionPolicy::kTinyLfu, "tinylfu"},
+                           })))),
+        jb::Member("encoded_bytes_limit",
+                   jb::Projection(&Spec::encoded_bytes_limit,
+                                  jb::DefaultValue([](auto* v) { *v = 0; }))),
+        jb::Member("writeback_high_water_bytes",
+                   jb::Projection(&Spec::writeback_high_water_bytes,
+                                  jb::DefaultValue([](auto* v) { *v = 0; }))),
+        jb::Member(
+            "writeback_low_water_bytes",
+            jb::Dependent([](auto is_loading, const auto& options, auto* obj,
+                             auto* j) {
+              return jb::Projection(
+                  &Spec::writeback_low_water_bytes,
+                  jb::DefaultValue(
+                      [obj](auto* v) {
+                        *v = obj->writeback_high_water_bytes / 2;
+                      },
+                      jb::Integer<std::size_t>(
+                          0, obj->writeback_high_water_bytes)));
+            })),
+        jb::Member("writeback_encode_concurrency",
+                   jb::Projection(&Spec::writeback_encode_concurrency,
+                                  jb::DefaultValue([](auto* v) { *v = 0; }))),
+        jb::Member("writeback_io_concurrency",
+                   jb::Projection(&Spec::writeback_io_concurrency,
+                                  jb::DefaultValue([](auto* v) { *v = 0; }))));
   }
   static Result<Resource> Create(const Spec& limits,
                                  ContextResourceCreationContext context) {
@@ -20,6 +20,8 @@
 #include "tensorstore/context.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/json_serialization_options.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/status_testutil.h"
@@ -27,7 +29,10 @@
 namespace {
 
 using ::tensorstore::Context;
+using ::tensorstore::IncludeDefaults;
+using ::tensorstore::MatchesJson;
 using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::CacheEvictionPolicy;
 using ::tensorstore::internal::CachePoolResource;
 
 TEST(CachePoolResourceTest, Default) {
@@ -75,6 +80,79 @@ TEST(CachePoolResourceTest, BothEqual) {
   EXPECT_EQ(100u, (*cache)->limits().queued_for_writeback_bytes_limit);
 }
 
+TEST(CachePoolResourceTest, EvictionPolicy) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto resource_spec, Context::Resource<CachePoolResource>::FromJson(
+                              {{"total_bytes_limit", 100},
+                               {"eviction_policy", "tinylfu"}}));
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(CacheEvictionPolicy::kTinyLfu,
+            (*cache)->limits().eviction_policy);
+  EXPECT_THAT(resource_spec.ToJson(IncludeDefaults{true}),
+              ::testing::Optional(MatchesJson(
+                  {{"total_bytes_limit", 100},
+                   {"queued_for_writeback_bytes_limit", 50},
+                   {"eviction_policy", "tinylfu"},
+                   {"encoded_bytes_limit", 0},
+                   {"writeback_high_water_bytes", 0},
+                   {"writeback_low_water_bytes", 0},
+                   {"writeback_encode_concurrency", 0},
+                   {"writeback_io_concurrency", 0}})));
+}
+
+TEST(CachePoolResourceTest, DefaultEvictionPolicy) {
+  auto resource_spec = Context::Resource<CachePoolResource>::DefaultSpec();
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(CacheEvictionPolicy::kLru, (*cache)->limits().eviction_policy);
+}
+
+TEST(CachePoolResourceTest, InvalidEvictionPolicy) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"eviction_policy", "random"}});
+  EXPECT_THAT(resource_spec, MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CachePoolResourceTest, EncodedBytesLimit) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto resource_spec, Context::Resource<CachePoolResource>::FromJson(
+                              {{"total_bytes_limit", 100},
+                               {"encoded_bytes_limit", 1000}}));
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(1000u, (*cache)->limits().encoded_bytes_limit);
+  EXPECT_THAT(resource_spec.ToJson(),
+              ::testing::Optional(MatchesJson({{"total_bytes_limit", 100},
+                                               {"encoded_bytes_limit", 1000}})));
+}
+
+TEST(CachePoolResourceTest, WritebackWaterMarks) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto resource_spec, Context::Resource<CachePoolResource>::FromJson(
+                              {{"total_bytes_limit", 100},
+                               {"writeback_high_water_bytes", 1000}}));
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(1000u, (*cache)->limits().writeback_high_water_bytes);
+  EXPECT_EQ(500u, (*cache)->limits().writeback_low_water_bytes);
+  EXPECT_THAT(
+      Context::Resource<CachePoolResource>::FromJson(
+          {{"writeback_high_water_bytes", 1000},
+           {"writeback_low_water_bytes", 1001}}),
+      MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CachePoolResourceTest, WritebackConcurrency) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto resource_spec, Context::Resource<CachePoolResource>::FromJson(
+                              {{"writeback_encode_concurrency", 4},
+                               {"writeback_io_concurrency", 32}}));
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(4u, (*cache)->limits().writeback_encode_concurrency);
+  EXPECT_EQ(32u, (*cache)->limits().writeback_io_concurrency);
+  EXPECT_THAT(resource_spec.ToJson(),
+              ::testing::Optional(
+                  MatchesJson({{"writeback_encode_concurrency", 4},
+                               {"writeback_io_concurrency", 32}})));
+}
+
 TEST(CachePoolResourceTest, OutOfRange) {
   auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
       {{"total_bytes_limit", 100}, {"queued_for_writeback_bytes_limit", 101}});
@@ -36,6 +36,7 @@ namespace {
 using ::tensorstore::StrCat;
 using ::tensorstore::internal::Cache;
 using ::tensorstore::internal::CacheEntryQueueState;
+using ::tensorstore::internal::CacheEvictionPolicy;
 using ::tensorstore::internal::CachePool;
 using ::tensorstore::internal::CachePtr;
 using ::tensorstore::internal::PinnedCacheEntry;
@@ -48,6 +49,7 @@ using ::tensorstore::internal_cache::CachePoolImpl;
 using ::tensorstore::internal_cache::LruListNode;
 using ::testing::ElementsAre;
 using ::testing::Pair;
+using ::testing::StartsWith;
 using ::testing::UnorderedElementsAre;
 
 using QueueState = tensorstore::internal::CacheEntryQueueState;
@@ -165,12 +167,18 @@ void AssertInvariants(const CachePool::StrongPtr& pool,
                       absl::flat_hash_set<Cache*> expected_caches) {
   auto* pool_impl = GetPoolImpl(pool);
   auto eviction_queue_entries = GetEntrySet(&pool_impl->eviction_queue_);
+  for (auto* queue :
+       {&pool_impl->probation_queue_, &pool_impl->protected_queue_}) {
+    auto entries = GetEntrySet(queue);
+    eviction_queue_entries.insert(entries.begin(), entries.end());
+  }
   auto writeback_queue_entries = GetEntrySet(&pool_impl->writeback_queue_);
 
   absl::flat_hash_set<EntryIdentifier> expected_eviction_queue_entries,
       expected_writeback_queue_entries;
 
   size_t expected_total_bytes = 0, expected_pending_writeback_bytes = 0;
+  size_t expected_eviction_queue_bytes[3] = {};
 
   // Verify that every cache owned by the pool is in `expected_caches`.
   for (auto* cache : pool_impl->caches_) {
@@ -189,21 +197,27 @@ void AssertInvariants(const CachePool::StrongPtr& pool,
       EXPECT_EQ(cache_impl, *it);
     }
 
-    for (CacheEntryImpl* entry : cache_impl->entries_) {
-      EXPECT_EQ(
-          entry->num_bytes_,
-          cache->DoGetSizeInBytes(Access::StaticCast<Cache::Entry>(entry)));
-      expected_total_bytes += entry->num_bytes_;
-      switch (entry->queue_state_) {
-        case QueueState::clean_and_not_in_use:
-          expected_eviction_queue_entries.emplace(GetEntryIdentifier(entry));
-          break;
-        case QueueState::dirty:
-          expected_writeback_queue_entries.emplace(GetEntryIdentifier(entry));
-          expected_pending_writeback_bytes += entry->num_bytes_;
-          break;
-        default:
-          break;
+    for (auto& shard : cache_impl->entry_shards_) {
+      for (CacheEntryImpl* entry : shard.entries) {
+        EXPECT_EQ(
+            entry->num_bytes_,
+            cache->DoGetSizeInBytes(Access::StaticCast<Cache::Entry>(entry)));
+        expected_total_bytes += entry->num_bytes_;
+        switch (entry->queue_state_) {
+          case QueueState::clean_and_not_in_use:
+            expected_eviction_queue_entries.emplace(
+                GetEntryIdentifier(entry));
+            expected_eviction_queue_bytes[static_cast<size_t>(
+                entry->eviction_segment_)] += entry->num_bytes_;
+            break;
+          case QueueState::dirty:
+            expected_writeback_queue_entries.emplace(
+                GetEntryIdentifier(entry));
+            expected_pending_writeback_bytes += entry->num_bytes_;
+            break;
+          default:
+            break;
+        }
       }
     }
   }
@@ -213,6 +227,10 @@ void AssertInvariants(const CachePool::StrongPtr& pool,
             pool_impl->queued_for_writeback_bytes_);
 
   EXPECT_EQ(expected_eviction_queue_entries, eviction_queue_entries);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(expected_eviction_queue_bytes[i],
+              pool_impl->eviction_queue_bytes_[i]);
+  }
   EXPECT_EQ(expected_writeback_queue_entries, writeback_queue_entries);
 }
 
@@ -662,6 +680,47 @@ TEST_P(NamedOrAnonymousCacheTest, DelayedWritebackRequested) {
   TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
 }
 
+// Tests that exceeding `writeback_high_water_bytes` requests writeback of all
+// dirty entries and delays writes until `writeback_low_water_bytes` is reached.
+TEST(CacheTest, WritebackBackpressure) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 10000;
+  limits.queued_for_writeback_bytes_limit = 10000;
+  limits.writeback_high_water_bytes = 1000;
+  limits.writeback_low_water_bytes = 400;
+  auto pool = CachePool::Make(limits);
+  auto test_cache = GetTestCache(pool.get(), "", log);
+  EXPECT_TRUE(test_cache->WritebackBackpressure().ready());
+  auto entry_a = GetCacheEntry(test_cache, "a");
+  entry_a->UpdateState({{/*.lock=*/{}, /*.new_size=*/600},
+                        /*.new_state=*/CacheEntryQueueState::dirty});
+  EXPECT_EQ(0, log->writeback_requests.size());
+  EXPECT_TRUE(test_cache->WritebackBackpressure().ready());
+  auto entry_b = GetCacheEntry(test_cache, "b");
+  entry_b->UpdateState({{/*.lock=*/{}, /*.new_size=*/600},
+                        /*.new_state=*/CacheEntryQueueState::dirty});
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+  EXPECT_EQ(2, log->writeback_requests.size());
+  auto future = test_cache->WritebackBackpressure();
+  EXPECT_FALSE(future.ready());
+
+  // Simulate writeback of "a".  The bytes awaiting writeback remain above the
+  // low water mark.
+  entry_a->UpdateState({/*.SizeUpdate=*/{},
+                        /*.new_state=*/CacheEntryQueueState::clean_and_in_use});
+  EXPECT_FALSE(future.ready());
+  EXPECT_FALSE(test_cache->WritebackBackpressure().ready());
+
+  // Simulate writeback of "b".
+  entry_b->UpdateState({/*.SizeUpdate=*/{},
+                        /*.new_state=*/CacheEntryQueueState::clean_and_in_use});
+  EXPECT_TRUE(future.ready());
+  EXPECT_TRUE(test_cache->WritebackBackpressure().ready());
+  log->writeback_requests.clear();
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+}
+
 // Tests that an entry can be destroyed while dirty.
 TEST(CacheTest, DestroyWhileDirty) {
   auto log = std::make_shared<TestCache::RequestLog>();
@@ -759,6 +818,43 @@ TEST(CacheTest, ConcurrentGetCacheEntry) {
       [&] { pinned_entries[2] = GetCacheEntry(cache, "a"); });
 }
 
+// Tests that references to entries may be concurrently acquired and released,
+// including releases that are deferred because the pool mutex is held by
+// another thread, while entries are being evicted.
+class EvictionPolicyTest
+    : public ::testing::TestWithParam<CacheEvictionPolicy> {};
+
+INSTANTIATE_TEST_SUITE_P(AllPolicies, EvictionPolicyTest,
+                         ::testing::Values(CacheEvictionPolicy::kLru,
+                                           CacheEvictionPolicy::kClock,
+                                           CacheEvictionPolicy::kTinyLfu));
+
+TEST_P(EvictionPolicyTest, ConcurrentGetAndReleaseCacheEntry) {
+  auto pool = CachePool::Make(CachePool::Limits{2, 0, GetParam()});
+  auto cache = GetTestCache(pool.get(), "cache");
+  const auto get_and_release = [&] {
+    for (int i = 0; i < 100; ++i) {
+      for (std::string_view key : {"a", "b", "c", "a"}) {
+        auto entry = GetCacheEntry(cache, key);
+        EXPECT_EQ(key, entry->key());
+      }
+    }
+  };
+  TestConcurrent(
+      kDefaultIterations,
+      /*initialize=*/[] {},
+      /*finalize=*/
+      [&] {
+        TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+        EXPECT_EQ(1, cache->use_count());
+        EXPECT_EQ(2, GetPoolImpl(pool)->weak_references_.load());
+        EXPECT_EQ(0, GetPoolImpl(pool)->num_deferred_releases_.load());
+        EXPECT_LE(GetPoolImpl(pool)->total_bytes_, 2);
+      },
+      // Concurrent operations:
+      get_and_release, get_and_release, get_and_release);
+}
+
 TEST(CacheTest, ConcurrentGetCache) {
   auto pool = CachePool::Make(kSmallCacheLimits);
   CachePtr<TestCache> caches[3];
@@ -1079,4 +1175,66 @@ TEST(CacheTest, SetEvictWhenNotInUse) {
   EXPECT_THAT(log->entry_destroy_log, ElementsAre(Pair("cache_a", "entry_a")));
 }
 
+// Tests that with the CLOCK policy, accessing an entry does not move it within
+// the eviction queue, but gives it a second chance when it would be evicted.
+TEST(CacheTest, ClockSecondChance) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  auto pool = CachePool::Make(
+      CachePool::Limits{3, 0, CacheEvictionPolicy::kClock});
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  for (const char* key : {"a", "b", "c"}) {
+    GetCacheEntry(cache, key);
+  }
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre());
+  {
+    auto entry_a = GetCacheEntry(cache, "a");
+    // Entry remains at the front of the eviction queue while in use.
+    EXPECT_EQ(Access::StaticCast<CacheEntryImpl>(entry_a.get()),
+              GetPoolImpl(pool)->eviction_queue_.next);
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+  GetCacheEntry(cache, "d");
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre(Pair("cache", "b")));
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+}
+
+// Accesses a set of "hot" entries repeatedly, and then scans a larger number
+// of entries once each.
+void AccessHotEntriesThenScan(CacheEvictionPolicy policy,
+                              std::shared_ptr<TestCache::RequestLog> log) {
+  auto pool = CachePool::Make(CachePool::Limits{100, 0, policy});
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      GetCacheEntry(cache, StrCat("hot", j));
+    }
+  }
+  for (int j = 0; j < 200; ++j) {
+    GetCacheEntry(cache, StrCat("scan", j));
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+}
+
+// Tests that with the LRU policy, the scan evicts the hot entries.
+TEST(CacheTest, LruScanEvictsHotEntries) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  AccessHotEntriesThenScan(CacheEvictionPolicy::kLru, log);
+  ASSERT_GE(log->entry_destroy_log.size(), 10);
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(log->entry_destroy_log[i].second, StartsWith("hot"));
+  }
+}
+
+// Tests that with the TinyLFU policy, the scan does not evict the hot entries.
+TEST(CacheTest, TinyLfuScanResistance) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  AccessHotEntriesThenScan(CacheEvictionPolicy::kTinyLfu, log);
+  // The last 100 entries are destroyed along with the cache, rather than
+  // evicted.
+  ASSERT_EQ(210, log->entry_destroy_log.size());
+  for (size_t i = 0; i < 110; ++i) {
+    EXPECT_THAT(log->entry_destroy_log[i].second, StartsWith("scan"));
+  }
+}
+
 }  // namespace
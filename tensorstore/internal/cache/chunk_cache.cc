@@ -20,6 +20,7 @@
 #include <memory>
 #include <mutex>  // NOLINT
 #include <numeric>
+#include <optional>
 #include <string_view>
 #include <utility>
 #include <vector>
@@ -28,6 +29,8 @@
 #include "absl/container/fixed_array.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
 #include "tensorstore/array.h"
 #include "tensorstore/box.h"
 #include "tensorstore/contiguous_layout.h"
@@ -47,6 +50,7 @@
 #include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/internal/nditerable.h"
+#include "tensorstore/internal/unowned_to_shared.h"
 #include "tensorstore/rank.h"
 #include "tensorstore/staleness_bound.h"
 #include "tensorstore/strided_layout.h"
@@ -69,6 +73,10 @@ auto& num_writes = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/chunk_cache/writes", "Number of writes to ChunkCache.");
 auto& num_reads = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/chunk_cache/reads", "Number of reads from ChunkCache.");
+auto& num_direct_decodes = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/chunk_cache/direct_decodes",
+    "Number of chunks decoded directly into the target array of a read that "
+    "bypasses ChunkCache.");
 
 ChunkGridSpecification::Component::Component(SharedArray<const void> fill_value,
                                              Box<> component_bounds)
@@ -221,6 +229,158 @@ struct ReadChunkImpl {
   }
 };
 
+/// Returns the domain of component `component_index` of the cell at
+/// `cell_indices`.
+Box<> GetCellDomain(const ChunkGridSpecification& grid,
+                    std::size_t component_index,
+                    span<const Index> cell_indices) {
+  const auto& component_spec = grid.components[component_index];
+  Box<> domain(component_spec.rank());
+  grid.GetComponentOrigin(component_index, cell_indices, domain.origin());
+  std::copy(component_spec.shape().begin(), component_spec.shape().end(),
+            domain.shape().begin());
+  return domain;
+}
+
+/// Returns the inverse of `chunk_transform` if it is a one-to-one mapping onto
+/// `cell_domain`, or a null transform otherwise.
+IndexTransform<> GetEntireCellInverse(IndexTransform<> chunk_transform,
+                                      BoxView<> cell_domain) {
+  auto inverse = InverseTransform(chunk_transform);
+  if (!inverse.ok() || inverse->domain().box() != cell_domain) return {};
+  return *std::move(inverse);
+}
+
+/// Returns the region of the cell, relative to the origin of `cell_domain`,
+/// that contains the range of `chunk_transform`, or `std::nullopt` if the
+/// region is empty, covers the entire cell, or cannot be computed.
+std::optional<Box<>> GetPartialCellRegion(IndexTransformView<> chunk_transform,
+                                          BoxView<> cell_domain) {
+  Box<> region(cell_domain.rank());
+  if (!GetOutputRange(chunk_transform, region).ok()) return std::nullopt;
+  bool entire_cell = true;
+  for (DimensionIndex i = 0; i < region.rank(); ++i) {
+    const auto interval = Intersect(region[i], cell_domain[i]);
+    if (interval.empty()) return std::nullopt;
+    if (interval != cell_domain[i]) entire_cell = false;
+    region[i] = IndexInterval::UncheckedSized(
+        interval.inclusive_min() - cell_domain.origin()[i], interval.size());
+  }
+  if (entire_cell) return std::nullopt;
+  return region;
+}
+
+/// TensorStore Driver ReadChunk implementation for the chunk cache, for the
+/// case of a non-transactional read that bypasses the cache.
+///
+/// This implements the `tensorstore::internal::ReadChunk::Impl` Poly interface.
+///
+/// Holds the encoded chunk obtained from `ChunkCache::ReadEncodedChunk`.  If
+/// the chunk transform maps one-to-one onto the entire cell, the `ReadInto`
+/// operation decodes the chunk directly into the target array; otherwise,
+/// `BeginRead` decodes it into a temporary array.
+struct DirectReadChunkImpl {
+  std::size_t component_index;
+  PinnedCacheEntry<ChunkCache> entry;
+  // Encoded chunk, or `std::nullopt` if the chunk is not present.
+  std::optional<absl::Cord> encoded;
+
+  absl::Status operator()(internal::LockCollection& lock_collection) const {
+    // The encoded chunk is immutable; no locks are required.
+    return absl::OkStatus();
+  }
+
+  Result<NDIterable::Ptr> operator()(ReadChunk::BeginRead,
+                                     IndexTransform<> chunk_transform,
+                                     Arena* arena) const {
+    auto& cache = GetOwningCache(*entry);
+    const auto& component_spec = cache.grid().components[component_index];
+    absl::FixedArray<Index, kNumInlinedDims> origin(component_spec.rank());
+    cache.grid().GetComponentOrigin(component_index, entry->cell_indices(),
+                                    origin);
+    SharedArrayView<const void> read_array;
+    if (encoded) {
+      auto array = AllocateArray(component_spec.shape(), c_order, default_init,
+                                 component_spec.dtype());
+      TENSORSTORE_RETURN_IF_ERROR(cache.DecodeEncodedChunk(
+          *entry, *encoded, component_index, array));
+      read_array = std::move(array);
+    }
+    return component_spec.GetReadNDIterable(std::move(read_array), origin,
+                                            std::move(chunk_transform), arena);
+  }
+
+  Result<bool> operator()(
+      ReadChunk::ReadInto, IndexTransform<> chunk_transform,
+      TransformedArray<void, dynamic_rank, view> target) const {
+    // A missing chunk is filled from the fill value by `BeginRead`.
+    if (!encoded) return false;
+    auto& cache = GetOwningCache(*entry);
+    auto inverse = GetEntireCellInverse(
+        std::move(chunk_transform),
+        GetCellDomain(cache.grid(), component_index, entry->cell_indices()));
+    if (!inverse.valid()) return false;
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto cell_to_target,
+        ComposeTransforms(target.transform(), std::move(inverse)));
+    for (const auto map : cell_to_target.output_index_maps()) {
+      // Index arrays would require a copy.
+      if (map.method() == OutputIndexMethod::array) return false;
+    }
+    // Without index arrays, `TransformArray` returns a view of `target`.
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto output,
+        TransformArray<zero_origin>(UnownedToShared(target.base_array()),
+                                    cell_to_target));
+    TENSORSTORE_RETURN_IF_ERROR(cache.DecodeEncodedChunk(
+        *entry, *encoded, component_index,
+        ConstDataTypeCast<void>(std::move(output))));
+    num_direct_decodes.Increment();
+    return true;
+  }
+};
+
+/// TensorStore Driver ReadChunk implementation for the chunk cache, for the
+/// case of a non-transactional read of a small region of a chunk that bypasses
+/// the cache.
+///
+/// This implements the `tensorstore::internal::ReadChunk::Impl` Poly interface.
+///
+/// Holds the partial chunk obtained from `ChunkCache::ReadPartialChunk`, which
+/// contains (at least) the elements within the range of the chunk transform.
+struct PartialReadChunkImpl {
+  std::size_t component_index;
+  PinnedCacheEntry<ChunkCache> entry;
+  // Partial chunk, with indices relative to the cell origin, or a null array if
+  // the chunk is not present.
+  SharedOffsetArray<const void> array;
+
+  absl::Status operator()(internal::LockCollection& lock_collection) const {
+    // The partial chunk is immutable; no locks are required.
+    return absl::OkStatus();
+  }
+
+  Result<NDIterable::Ptr> operator()(ReadChunk::BeginRead,
+                                     IndexTransform<> chunk_transform,
+                                     Arena* arena) const {
+    auto& cache = GetOwningCache(*entry);
+    const auto& component_spec = cache.grid().components[component_index];
+    absl::FixedArray<Index, kNumInlinedDims> origin(component_spec.rank());
+    cache.grid().GetComponentOrigin(component_index, entry->cell_indices(),
+                                    origin);
+    SharedArrayView<const void> read_array;
+    if (array.valid()) {
+      // View the partial array as an array over the entire cell.  Only the
+      // elements within the range of `chunk_transform` are accessed.
+      read_array = SharedArrayView<const void>(
+          array.element_pointer(),
+          StridedLayout<>(component_spec.shape(), array.byte_strides()));
+    }
+    return component_spec.GetReadNDIterable(std::move(read_array), origin,
+                                            std::move(chunk_transform), arena);
+  }
+};
+
 /// TensorStore Driver ReadChunk implementation for the chunk cache, for the
 /// case of a transactional read.
 ///
@@ -238,6 +398,25 @@ struct ReadChunkImpl {
 /// Additionally, `Read` calls the `ChunkCache::TransactionNode::DoRead` method,
 /// rather than `ChunkCache::Entry::DoRead`.
 struct ReadChunkTransactionImpl {
+  /// Adopts the reader registered by a successful call to
+  /// `node->TryAcquireReader()`.
+  ReadChunkTransactionImpl(
+      std::size_t component_index,
+      OpenTransactionNodePtr<ChunkCache::TransactionNode> node)
+      : component_index(component_index), node(std::move(node)) {}
+  ReadChunkTransactionImpl(const ReadChunkTransactionImpl& other)
+      : component_index(other.component_index), node(other.node) {
+    node->AcquireReader();
+  }
+  ReadChunkTransactionImpl(ReadChunkTransactionImpl&& other) = default;
+  ReadChunkTransactionImpl& operator=(const ReadChunkTransactionImpl&) = delete;
+  ReadChunkTransactionImpl& operator=(ReadChunkTransactionImpl&&) = delete;
+  ~ReadChunkTransactionImpl() {
+    // The write state of a staged node may be released once no transactional
+    // reads reference it.
+    if (node) node->ReleaseReader();
+  }
+
   std::size_t component_index;
   OpenTransactionNodePtr<ChunkCache::TransactionNode> node;
 
@@ -450,6 +629,41 @@ struct WriteChunkImpl {
     }
     return {};
   }
+
+  std::optional<WriteChunk::EndWriteResult> operator()(
+      WriteChunk::WriteArray, IndexTransformView<> chunk_transform,
+      TransformedSharedArray<const void> source) const {
+    auto& entry = GetOwningEntry(*node);
+    auto& cache = GetOwningCache(entry);
+    const auto& component_spec = entry.component_specs()[component_index];
+    if (source.dtype() != component_spec.dtype()) return std::nullopt;
+    // Only a write to the entire cell can reference `source`, since a partial
+    // write must be merged with the existing data.
+    auto cell_domain =
+        GetCellDomain(cache.grid(), component_index, entry.cell_indices());
+    auto inverse =
+        GetEntireCellInverse(IndexTransform<>(chunk_transform), cell_domain);
+    if (!inverse.valid()) return std::nullopt;
+    auto cell_to_source = ComposeTransforms(source.transform(), inverse);
+    if (!cell_to_source.ok()) return std::nullopt;
+    for (const auto map : cell_to_source->output_index_maps()) {
+      // Index arrays would require a copy.
+      if (map.method() == OutputIndexMethod::array) return std::nullopt;
+    }
+    // Without index arrays, `TransformArray` returns a view of `source`.
+    auto array = TransformArray<zero_origin>(source.base_array(),
+                                             *cell_to_source);
+    if (!array.ok()) return std::nullopt;
+    node->MarkSizeUpdated();
+    node->components()[component_index].WriteArray(
+        component_spec, cell_domain.origin(), *std::move(array));
+    node->is_modified = true;
+    if (IsFullyOverwritten(*node)) {
+      node->SetUnconditional();
+    }
+    return WriteChunk::EndWriteResult{node->OnModified(),
+                                      node->transaction()->future()};
+  }
 };
 
 }  // namespace
@@ -459,12 +673,23 @@ ChunkCache::ChunkCache(ChunkGridSpecification grid, Executor executor)
 
 void ChunkCache::Read(
     OpenTransactionPtr transaction, std::size_t component_index,
-    IndexTransform<> transform, absl::Time staleness,
+    IndexTransform<> transform, absl::Time staleness, Batch batch,
     AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
   assert(component_index >= 0 && component_index < grid().components.size());
   const auto& component_spec = grid().components[component_index];
   IntrusivePtr<ReadOperationState> state(
       new ReadOperationState(std::move(receiver)));
+  // If the cache pool does not retain unused entries or encoded values,
+  // chunks that are read in their entirety are decoded directly into the target
+  // array, rather than into the cache.
+  const bool may_read_directly =
+      !transaction && grid().components.size() == 1 &&
+      pool_limits().total_bytes_limit == 0 && !encoded_value_cache();
+  // Likewise, small regions of a chunk may be read directly from storage
+  // without reading the entire chunk, if supported by the derived class.
+  const bool may_read_partially = !transaction &&
+                                  pool_limits().total_bytes_limit == 0 &&
+                                  !encoded_value_cache();
   auto status = PartitionIndexTransformOverRegularGrid(
       component_spec.chunked_to_cell_dimensions, grid().chunk_shape, transform,
       [&](span<const Index> grid_cell_indices,
@@ -483,14 +708,78 @@ void ChunkCache::Read(
         chunk.transform = std::move(cell_to_source);
         Future<const void> read_future;
         if (transaction) {
-          TENSORSTORE_ASSIGN_OR_RETURN(auto node,
-                                       GetTransactionNode(*entry, transaction));
-          read_future = node->IsUnconditional() ? MakeReadyFuture()
-                                                : node->Read(staleness);
+          OpenTransactionNodePtr<TransactionNode> node;
+          while (true) {
+            TENSORSTORE_ASSIGN_OR_RETURN(
+                node, GetTransactionNode(*entry, transaction));
+            // Register the reader before reading, so that the write state is
+            // not concurrently released by `WritebackStaged`.  A node whose
+            // write state was already released has been revoked, and is
+            // replaced by a new node on the next iteration.
+            if (node->TryAcquireReader()) break;
+          }
+          read_future = node->IsUnconditional()
+                            ? MakeReadyFuture()
+                            : node->Read({staleness, batch});
           chunk.impl =
               ReadChunkTransactionImpl{component_index, std::move(node)};
         } else {
-          read_future = entry->Read(staleness);
+          if (may_read_directly &&
+              AsyncCache::ReadLock<ReadData>(*entry).stamp().time <
+                  staleness &&
+              GetEntireCellInverse(chunk.transform,
+                                   GetCellDomain(grid(), component_index,
+                                                 entry->cell_indices()))
+                  .valid()) {
+            auto encoded_future = ReadEncodedChunk(*entry, {staleness, batch});
+            if (!encoded_future.null()) {
+              LinkValue(
+                  [state, chunk = std::move(chunk), component_index,
+                   entry = std::move(entry),
+                   cell_transform = IndexTransform<>(cell_transform)](
+                      Promise<void> promise,
+                      ReadyFuture<std::optional<absl::Cord>> future) mutable {
+                    chunk.impl = DirectReadChunkImpl{
+                        component_index, std::move(entry),
+                        std::move(future.value())};
+                    execution::set_value(state->shared_receiver->receiver,
+                                         std::move(chunk),
+                                         std::move(cell_transform));
+                  },
+                  state->promise, std::move(encoded_future));
+              return absl::OkStatus();
+            }
+          }
+          std::optional<Box<>> partial_region;
+          if (may_read_partially &&
+              AsyncCache::ReadLock<ReadData>(*entry).stamp().time <
+                  staleness &&
+              (partial_region = GetPartialCellRegion(
+                   chunk.transform, GetCellDomain(grid(), component_index,
+                                                  entry->cell_indices())))) {
+            auto partial_future =
+                ReadPartialChunk(*entry, component_index, *partial_region,
+                                 {staleness, batch});
+            if (!partial_future.null()) {
+              LinkValue(
+                  [state, chunk = std::move(chunk), component_index,
+                   entry = std::move(entry),
+                   cell_transform = IndexTransform<>(cell_transform)](
+                      Promise<void> promise,
+                      ReadyFuture<SharedOffsetArray<const void>>
+                          future) mutable {
+                    chunk.impl = PartialReadChunkImpl{
+                        component_index, std::move(entry),
+                        std::move(future.value())};
+                    execution::set_value(state->shared_receiver->receiver,
+                                         std::move(chunk),
+                                         std::move(cell_transform));
+                  },
+                  state->promise, std::move(partial_future));
+              return absl::OkStatus();
+            }
+          }
+          read_future = entry->Read({staleness, batch});
           chunk.impl = ReadChunkImpl{component_index, std::move(entry)};
         }
         LinkValue(
@@ -513,9 +802,30 @@ void ChunkCache::Write(
     IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
   assert(component_index >= 0 && component_index < grid().components.size());
-  // In this implementation, chunks are always available for writing
-  // immediately.  The entire stream of chunks is sent to the receiver before
-  // this function returns.
+  if (!transaction) {
+    // Non-transactional writes are delayed while the cache pool has exceeded
+    // its writeback high water mark.
+    auto backpressure = WritebackBackpressure();
+    if (!backpressure.ready()) {
+      std::move(backpressure)
+          .ExecuteWhenReady([self = CachePtr<ChunkCache>(this), component_index,
+                             transform = std::move(transform),
+                             receiver = std::move(receiver)](
+                                ReadyFuture<const void> future) mutable {
+            auto* cache = self.get();
+            cache->executor()([self = std::move(self), component_index,
+                               transform = std::move(transform),
+                               receiver = std::move(receiver)]() mutable {
+              self->Write({}, component_index, std::move(transform),
+                          std::move(receiver));
+            });
+          });
+      return;
+    }
+  }
+  // In this implementation, once any writeback backpressure has cleared,
+  // chunks are always available for writing immediately.  The entire stream of
+  // chunks is sent to the receiver before this function returns.
   const auto& component_spec = grid().components[component_index];
   std::atomic<bool> cancelled{false};
   execution::set_starting(receiver, [&cancelled] { cancelled = true; });
@@ -546,6 +856,24 @@ void ChunkCache::Write(
   execution::set_stopping(receiver);
 }
 
+Future<std::optional<absl::Cord>> ChunkCache::ReadEncodedChunk(
+    Entry& entry, AsyncCacheReadRequest request) {
+  return {};
+}
+
+absl::Status ChunkCache::DecodeEncodedChunk(Entry& entry,
+                                            const absl::Cord& encoded,
+                                            std::size_t component_index,
+                                            ArrayView<void> output) {
+  return absl::UnimplementedError("Direct reads not supported");
+}
+
+Future<SharedOffsetArray<const void>> ChunkCache::ReadPartialChunk(
+    Entry& entry, std::size_t component_index, BoxView<> region,
+    AsyncCacheReadRequest request) {
+  return {};
+}
+
 PinnedCacheEntry<ChunkCache> ChunkCache::GetEntryForCell(
     span<const Index> grid_cell_indices) {
   assert(static_cast<size_t>(grid_cell_indices.size()) ==
@@ -700,6 +1028,60 @@ void ChunkCache::TransactionNode::DoApply(ApplyOptions options,
   }
 }
 
+void ChunkCache::TransactionNode::WritebackSuccess(ReadState&& read_state) {
+  for (auto& component : components()) {
+    if (component.write_state.data_is_shared) {
+      // The written data references an array supplied to
+      // `WriteChunk::WriteArray`, which may be modified by the caller once the
+      // write is committed, and therefore must not be retained as the cached
+      // read state.
+      read_state.data = nullptr;
+      read_state.stamp.generation = StorageGeneration::Unknown();
+      break;
+    }
+  }
+  AsyncCache::TransactionNode::WritebackSuccess(std::move(read_state));
+}
+
+bool ChunkCache::TransactionNode::CanStageWriteback() {
+  return is_modified && IsUnconditional();
+}
+
+void ChunkCache::TransactionNode::WritebackStaged() {
+  UniqueWriterLock lock(*this);
+  release_pending_.store(true);
+  // Re-check after setting `release_pending_`, since the last reader may have
+  // been released concurrently.
+  if (readers_.load() != 0) return;
+  ReleaseWriteState();
+}
+
+bool ChunkCache::TransactionNode::TryAcquireReader() {
+  UniqueWriterLock lock(*this);
+  if (write_state_released_) return false;
+  AcquireReader();
+  return true;
+}
+
+void ChunkCache::TransactionNode::ReleaseReader() {
+  if (readers_.fetch_sub(1, std::memory_order_acq_rel) != 1 ||
+      !release_pending_.load()) {
+    return;
+  }
+  UniqueWriterLock lock(*this);
+  if (readers_.load() != 0) return;
+  ReleaseWriteState();
+}
+
+void ChunkCache::TransactionNode::ReleaseWriteState() {
+  if (!release_pending_.exchange(false)) return;
+  write_state_released_ = true;
+  for (auto& component : components()) {
+    component.write_state.Clear();
+  }
+  MarkSizeUpdated();
+}
+
 void ChunkCache::TransactionNode::InvalidateReadState() {
   AsyncCache::TransactionNode::InvalidateReadState();
   for (auto& component : components()) {
@@ -729,7 +1111,15 @@ void ChunkCacheDriver::Read(
     OpenTransactionPtr transaction, IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
   cache_->Read(std::move(transaction), component_index_, std::move(transform),
-               data_staleness_bound_.time, std::move(receiver));
+               data_staleness_bound_.time, no_batch, std::move(receiver));
+}
+
+void ChunkCacheDriver::ReadInBatch(
+    OpenTransactionPtr transaction, IndexTransform<> transform, Batch batch,
+    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
+  cache_->Read(std::move(transaction), component_index_, std::move(transform),
+               data_staleness_bound_.time, std::move(batch),
+               std::move(receiver));
 }
 
 void ChunkCacheDriver::Write(
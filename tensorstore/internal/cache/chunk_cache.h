@@ -47,12 +47,16 @@
 
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <string_view>
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
 #include "tensorstore/array.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/chunk.h"
 #include "tensorstore/driver/driver.h"
@@ -263,13 +267,55 @@ class ChunkCache : public AsyncCache {
 
     void DoApply(ApplyOptions options, ApplyReceiver receiver) override;
 
+    void WritebackSuccess(ReadState&& read_state) override;
+
     void InvalidateReadState() override;
 
+    /// Returns `true` if the node was modified and is unconditional.
+    bool CanStageWriteback() override;
+
+    /// Releases the write state, unless it is still referenced by a
+    /// transactional `ReadChunk`, in which case it is released once the last
+    /// such reference is destroyed.
+    void WritebackStaged() override;
+
+    /// Registers a transactional `ReadChunk` that may access the write state.
+    ///
+    /// Returns `false`, without registering a reader, if the write state was
+    /// already released following `WritebackStaged`.  The node has then been
+    /// revoked, and a new node must be obtained from `GetTransactionNode`.
+    bool TryAcquireReader();
+
+    /// Registers an additional reader.
+    ///
+    /// \pre At least one reader is registered.
+    void AcquireReader() { readers_.fetch_add(1, std::memory_order_acq_rel); }
+
+    /// Unregisters a reader registered by `TryAcquireReader` or
+    /// `AcquireReader`.
+    void ReleaseReader();
+
    private:
     friend class ChunkCache;
+
+    /// Clears the write state of all components.
+    ///
+    /// \pre The write lock is held.
+    void ReleaseWriteState();
+
     absl::InlinedVector<Component, 1> components_;
     std::atomic<bool> unconditional_{false};
 
+    /// Number of transactional `ReadChunk` objects referencing this node.
+    std::atomic<size_t> readers_{0};
+
+    /// Set by `WritebackStaged` if the write state could not be released due
+    /// to outstanding readers.
+    std::atomic<bool> release_pending_{false};
+
+    /// Set by `ReleaseWriteState`.  Protected by the write lock.
+    bool write_state_released_ = false;
+
    public:
     bool is_modified{false};
   };
@@ -327,10 +373,11 @@ class ChunkCache : public AsyncCache {
   /// \param transform The transform to apply.
   /// \param staleness Cached data older than `staleness` will not be returned
   ///     without being rechecked.
+  /// \param batch Batch with which to associate any reads that are issued.
   /// \param receiver Receiver for the chunks.
   void Read(
       internal::OpenTransactionPtr transaction, std::size_t component_index,
-      IndexTransform<> transform, absl::Time staleness,
+      IndexTransform<> transform, absl::Time staleness, Batch batch,
       AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver);
 
   /// Implements the behavior of `Driver::Write` for a given component array.
@@ -361,6 +408,51 @@ class ChunkCache : public AsyncCache {
   /// `ChunkGridSpecification`, but derived classes may override.
   virtual Result<ChunkLayout> GetChunkLayout(size_t component_index);
 
+  /// Reads the encoded representation of the chunk for `entry` directly from
+  /// the underlying storage, without storing the decoded chunk in the cache.
+  ///
+  /// This is used by non-transactional `Read` operations that cover an entire
+  /// chunk when the cache pool does not retain unused entries (i.e.
+  /// `total_bytes_limit` is 0), in order to decode the chunk directly into the
+  /// target array of the read.
+  ///
+  /// The default implementation returns a null `Future`, indicating that
+  /// direct reads are not supported.
+  ///
+  /// \returns A future that resolves to the encoded chunk, or `std::nullopt`
+  ///     if the chunk is not present.
+  virtual Future<std::optional<absl::Cord>> ReadEncodedChunk(
+      Entry& entry, AsyncCacheReadRequest request);
+
+  /// Decodes component `component_index` of a chunk obtained from
+  /// `ReadEncodedChunk` into `output`.
+  ///
+  /// \param output Array with a shape equal to
+  ///     `grid().components[component_index].shape()`.
+  virtual absl::Status DecodeEncodedChunk(Entry& entry,
+                                          const absl::Cord& encoded,
+                                          std::size_t component_index,
+                                          ArrayView<void> output);
+
+  /// Reads the portion of component `component_index` of the chunk for
+  /// `entry` within `region` directly from the underlying storage, without
+  /// storing it in the cache.
+  ///
+  /// This is used by non-transactional `Read` operations that cover only a
+  /// small part of a chunk, under the same conditions as `ReadEncodedChunk`.
+  ///
+  /// The default implementation returns a null `Future`, indicating that
+  /// partial reads are not supported (or not worthwhile for `region`).
+  ///
+  /// \param region Region of the component to read, relative to the origin of
+  ///     the cell, contained within `grid().components[component_index]`.
+  /// \returns A future that resolves to an array whose domain contains
+  ///     `region`, with indices relative to the origin of the cell, or to a
+  ///     null array if the chunk is not present.
+  virtual Future<SharedOffsetArray<const void>> ReadPartialChunk(
+      Entry& entry, std::size_t component_index, BoxView<> region,
+      AsyncCacheReadRequest request);
+
   const Executor& executor() const { return executor_; }
 
  private:
@@ -406,6 +498,12 @@ class ChunkCacheDriver : public Driver {
             AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
       override;
 
+  /// Simply forwards to `ChunkCache::Read`.
+  void ReadInBatch(
+      OpenTransactionPtr transaction, IndexTransform<> transform, Batch batch,
+      AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
+      override;
+
   /// Simply forwards to `ChunkCache::Write`.
   void Write(OpenTransactionPtr transaction, IndexTransform<> transform,
              AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>
@@ -17,6 +17,7 @@
 #include <memory>
 #include <new>
 #include <ostream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -68,6 +69,8 @@ using ::tensorstore::SharedArrayView;
 using ::tensorstore::span;
 using ::tensorstore::StorageGeneration;
 using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::AsyncCacheReadRequest;
+using ::tensorstore::internal::Cache;
 using ::tensorstore::internal::CachePool;
 using ::tensorstore::internal::CachePtr;
 using ::tensorstore::internal::ChunkCache;
@@ -75,7 +78,9 @@ using ::tensorstore::internal::ChunkCacheDriver;
 using ::tensorstore::internal::ChunkGridSpecification;
 using ::tensorstore::internal::Driver;
 using ::tensorstore::internal::ElementCopyFunction;
+using ::tensorstore::internal::GetCacheEntry;
 using ::tensorstore::internal::GetOwningCache;
+using ::tensorstore::internal::PinnedCacheEntry;
 
 /// Benchmark configuration for read/write benchmark.
 struct BenchmarkConfig {
@@ -134,7 +139,7 @@ class BenchmarkCache : public tensorstore::internal::ChunkCache {
   class Entry : public Base::Entry {
    public:
     using OwningCache = BenchmarkCache;
-    void DoRead(absl::Time staleness_bound) override {
+    void DoRead(AsyncCacheReadRequest request) override {
       GetOwningCache(*this).executor()([this] {
         const auto component_specs = this->component_specs();
         auto read_data = tensorstore::internal::make_shared_for_overwrite<
@@ -162,7 +167,7 @@ class BenchmarkCache : public tensorstore::internal::ChunkCache {
       this->SetReadsCommitted();
       return Base::TransactionNode::DoInitialize(transaction);
     }
-    void DoRead(absl::Time staleness_bound) override {
+    void DoRead(AsyncCacheReadRequest request) override {
       ABSL_UNREACHABLE();  // COV_NF_LINE
     }
     void Commit() override {
@@ -370,4 +375,53 @@ struct RegisterBenchmarks {
   }
 } register_benchmarks_;
 
+/// Minimal cache used to measure the overhead of entry lookup and release.
+class ContentionCache : public Cache {
+ public:
+  class Entry : public Cache::Entry {
+   public:
+    using OwningCache = ContentionCache;
+  };
+
+  Entry* DoAllocateEntry() final { return new Entry; }
+  std::size_t DoGetSizeofEntry() final { return sizeof(Entry); }
+  void DoRequestWriteback(PinnedEntry entry) final {
+    ABSL_UNREACHABLE();  // COV_NF_LINE
+  }
+};
+
+/// Measures contention on the cache pool when multiple threads concurrently
+/// acquire and release references to entries of a single cache, as occurs when
+/// many chunks are read concurrently.
+///
+/// `state.range(0)` specifies the number of distinct keys.  With a single key,
+/// all threads contend on the same entry.
+void BM_CacheEntryContention(::benchmark::State& state) {
+  // Shared by all threads.  The pool limit is large enough that no entries are
+  // evicted, so that all lookups after the first are hits.
+  static CachePool::StrongPtr pool = CachePool::Make(
+      CachePool::Limits{/*.total_bytes_limit=*/size_t{1} << 30});
+  static CachePtr<ContentionCache> cache = pool->GetCache<ContentionCache>(
+      "", [] { return std::make_unique<ContentionCache>(); });
+  const size_t num_keys = state.range(0);
+  std::vector<std::string> keys(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys[i] = tensorstore::StrCat(i);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    PinnedCacheEntry<ContentionCache> entry =
+        GetCacheEntry(cache, keys[i++ % num_keys]);
+    ::benchmark::DoNotOptimize(entry);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CacheEntryContention)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(4096)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
 }  // namespace
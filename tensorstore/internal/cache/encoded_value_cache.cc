@@ -0,0 +1,148 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/encoded_value_cache.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/intrusive_linked_list.h"
+#include "tensorstore/internal/metrics/counter.h"
+
+namespace tensorstore {
+namespace internal_cache {
+namespace {
+
+auto& encoded_hit_count = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/encoded_value_cache/hit_count",
+    "Number of hits in the encoded value tier of a cache pool.");
+auto& encoded_miss_count = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/encoded_value_cache/miss_count",
+    "Number of misses in the encoded value tier of a cache pool.");
+auto& encoded_evict_count = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/encoded_value_cache/evict_count",
+    "Number of evictions from the encoded value tier of a cache pool.");
+
+}  // namespace
+
+struct EncodedValueCache::Node : public EncodedValueCache::LruListNode {
+  std::string key;
+  Value value;
+  size_t num_bytes;
+};
+
+EncodedValueCache::EncodedValueCache(size_t total_bytes_limit)
+    : total_bytes_limit_(total_bytes_limit) {
+  internal::intrusive_linked_list::Initialize(LruListAccessor{}, &lru_queue_);
+}
+
+EncodedValueCache::~EncodedValueCache() = default;
+
+std::optional<EncodedValueCache::Value> EncodedValueCache::Find(
+    std::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    encoded_miss_count.Increment();
+    return std::nullopt;
+  }
+  encoded_hit_count.Increment();
+  Node* node = it->second.get();
+  internal::intrusive_linked_list::Remove(LruListAccessor{}, node);
+  internal::intrusive_linked_list::InsertBefore(LruListAccessor{}, &lru_queue_,
+                                                node);
+  return node->value;
+}
+
+size_t EncodedValueCache::GetSizeInBytes(std::string_view key,
+                                         const Value& value) {
+  return sizeof(Node) + key.size() + (value.value ? value.value->size() : 0);
+}
+
+void EncodedValueCache::Insert(std::string_view key, Value value) {
+  const size_t num_bytes = GetSizeInBytes(key, value);
+  absl::MutexLock lock(&mutex_);
+  if (auto it = map_.find(key); it != map_.end()) {
+    Remove(it->second.get());
+  }
+  // Reserved bytes cannot be reclaimed by evicting stored values.
+  if (num_bytes > total_bytes_limit_ - reserved_bytes_) return;
+  while (total_bytes_ + num_bytes > total_bytes_limit_) {
+    encoded_evict_count.Increment();
+    Remove(static_cast<Node*>(lru_queue_.next));
+  }
+  auto node = std::make_unique<Node>();
+  node->key = std::string(key);
+  node->value = std::move(value);
+  node->num_bytes = num_bytes;
+  internal::intrusive_linked_list::InsertBefore(LruListAccessor{}, &lru_queue_,
+                                                node.get());
+  total_bytes_ += num_bytes;
+  std::string_view node_key = node->key;
+  map_.emplace(node_key, std::move(node));
+}
+
+void EncodedValueCache::Erase(std::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  if (auto it = map_.find(key); it != map_.end()) {
+    Remove(it->second.get());
+  }
+}
+
+bool EncodedValueCache::Reserve(size_t num_bytes) {
+  absl::MutexLock lock(&mutex_);
+  if (num_bytes > total_bytes_limit_ - reserved_bytes_) return false;
+  reserved_bytes_ += num_bytes;
+  total_bytes_ += num_bytes;
+  while (total_bytes_ > total_bytes_limit_) {
+    encoded_evict_count.Increment();
+    Remove(static_cast<Node*>(lru_queue_.next));
+  }
+  return true;
+}
+
+void EncodedValueCache::Unreserve(size_t num_bytes) {
+  absl::MutexLock lock(&mutex_);
+  assert(num_bytes <= reserved_bytes_);
+  reserved_bytes_ -= num_bytes;
+  total_bytes_ -= num_bytes;
+}
+
+size_t EncodedValueCache::total_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return total_bytes_;
+}
+
+size_t EncodedValueCache::reserved_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return reserved_bytes_;
+}
+
+void EncodedValueCache::Remove(Node* node) {
+  internal::intrusive_linked_list::Remove(LruListAccessor{}, node);
+  total_bytes_ -= node->num_bytes;
+  // Erasing the map entry destroys `node`, which owns the key.
+  map_.erase(map_.find(std::string_view(node->key)));
+}
+
+}  // namespace internal_cache
+}  // namespace tensorstore
@@ -0,0 +1,126 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_CACHE_ENCODED_VALUE_CACHE_H_
+#define TENSORSTORE_INTERNAL_CACHE_ENCODED_VALUE_CACHE_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/intrusive_linked_list.h"
+#include "tensorstore/kvstore/generation.h"
+
+namespace tensorstore {
+namespace internal_cache {
+
+/// Secondary tier of a cache pool that retains the encoded representation of
+/// values read from a kvstore.
+///
+/// Decoded cache entries are typically several times larger than their encoded
+/// representation.  When a decoded entry is evicted, retaining the encoded
+/// value allows it to be decoded again without re-reading it from the kvstore.
+///
+/// Cache entries that are resident in the pool hold the encoded value from
+/// which they were decoded, and move it to this cache when they are evicted.
+/// The size of those values is charged against the byte limit by `Reserve`.
+///
+/// Stored values are evicted in least-recently-used order once the total size,
+/// including reserved bytes, exceeds the byte limit specified to the
+/// constructor.  All operations are thread-safe.
+class EncodedValueCache {
+ public:
+  struct Value {
+    /// Encoded value, or `std::nullopt` if the key was not found.
+    std::optional<absl::Cord> value;
+
+    /// Generation and time at which `value` was read.
+    TimestampedStorageGeneration stamp;
+  };
+
+  /// Constructs an empty cache that holds at most `total_bytes_limit` bytes.
+  explicit EncodedValueCache(size_t total_bytes_limit);
+
+  ~EncodedValueCache();
+
+  EncodedValueCache(const EncodedValueCache&) = delete;
+  EncodedValueCache& operator=(const EncodedValueCache&) = delete;
+
+  /// Returns the value stored for `key`, and marks it as most recently used.
+  std::optional<Value> Find(std::string_view key);
+
+  /// Stores `value` for `key`, replacing any existing value.
+  ///
+  /// Values larger than the byte limit are not stored.
+  void Insert(std::string_view key, Value value);
+
+  /// Removes the value stored for `key`, if any.
+  void Erase(std::string_view key);
+
+  /// Charges `num_bytes` against the byte limit for a value held outside this
+  /// cache, evicting stored values as needed.
+  ///
+  /// \returns `false`, without charging anything, if the reserved bytes would
+  ///     exceed the byte limit.
+  bool Reserve(size_t num_bytes);
+
+  /// Releases a charge previously made by a successful call to `Reserve`.
+  void Unreserve(size_t num_bytes);
+
+  /// Returns the number of bytes charged for storing `value` under `key`.
+  static size_t GetSizeInBytes(std::string_view key, const Value& value);
+
+  /// Returns the total size in bytes of the stored values and reservations.
+  size_t total_bytes() const;
+
+  /// Returns the total size in bytes of the reservations.
+  size_t reserved_bytes() const;
+
+  size_t total_bytes_limit() const { return total_bytes_limit_; }
+
+ private:
+  struct LruListNode {
+    LruListNode* next;
+    LruListNode* prev;
+  };
+  using LruListAccessor =
+      internal::intrusive_linked_list::MemberAccessor<LruListNode>;
+  struct Node;
+
+  void Remove(Node* node) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const size_t total_bytes_limit_;
+  mutable absl::Mutex mutex_;
+  size_t total_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t reserved_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Maps each key to its node.  The keys are owned by the nodes.
+  absl::flat_hash_map<std::string_view, std::unique_ptr<Node>> map_
+      ABSL_GUARDED_BY(mutex_);
+
+  // next points to the front of the queue, which is the first to be evicted.
+  LruListNode lru_queue_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal_cache
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_CACHE_ENCODED_VALUE_CACHE_H_
@@ -0,0 +1,133 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/encoded_value_cache.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/kvstore/generation.h"
+
+namespace {
+
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal_cache::EncodedValueCache;
+
+EncodedValueCache::Value MakeValue(std::string value) {
+  return {absl::Cord(value),
+          TimestampedStorageGeneration{StorageGeneration::FromString(value),
+                                       absl::Now()}};
+}
+
+std::optional<absl::Cord> FindValue(EncodedValueCache& cache,
+                                    std::string_view key) {
+  auto value = cache.Find(key);
+  if (!value) return std::nullopt;
+  return value->value;
+}
+
+TEST(EncodedValueCacheTest, InsertFind) {
+  EncodedValueCache cache(100000);
+  EXPECT_EQ(std::nullopt, cache.Find("a"));
+  auto value = MakeValue("abc");
+  cache.Insert("a", value);
+  auto found = cache.Find("a");
+  ASSERT_TRUE(found);
+  EXPECT_EQ(absl::Cord("abc"), found->value);
+  EXPECT_EQ(value.stamp, found->stamp);
+  EXPECT_GT(cache.total_bytes(), 3);
+}
+
+TEST(EncodedValueCacheTest, Missing) {
+  EncodedValueCache cache(100000);
+  cache.Insert("a", {std::nullopt, TimestampedStorageGeneration{
+                                       StorageGeneration::NoValue(),
+                                       absl::Now()}});
+  auto found = cache.Find("a");
+  ASSERT_TRUE(found);
+  EXPECT_EQ(std::nullopt, found->value);
+}
+
+TEST(EncodedValueCacheTest, Replace) {
+  EncodedValueCache cache(100000);
+  cache.Insert("a", MakeValue("abc"));
+  const size_t total_bytes = cache.total_bytes();
+  cache.Insert("a", MakeValue("def"));
+  EXPECT_EQ(total_bytes, cache.total_bytes());
+  EXPECT_EQ(absl::Cord("def"), FindValue(cache, "a"));
+}
+
+TEST(EncodedValueCacheTest, Erase) {
+  EncodedValueCache cache(100000);
+  cache.Insert("a", MakeValue("abc"));
+  cache.Erase("a");
+  cache.Erase("b");
+  EXPECT_EQ(std::nullopt, cache.Find("a"));
+  EXPECT_EQ(0, cache.total_bytes());
+}
+
+TEST(EncodedValueCacheTest, EvictsLeastRecentlyUsed) {
+  const std::string value(1000, 'x');
+  EncodedValueCache cache(3500);
+  cache.Insert("a", MakeValue(value));
+  cache.Insert("b", MakeValue(value));
+  cache.Insert("c", MakeValue(value));
+  // Mark "a" as recently used.
+  EXPECT_TRUE(cache.Find("a"));
+  cache.Insert("d", MakeValue(value));
+  EXPECT_TRUE(cache.Find("a"));
+  EXPECT_FALSE(cache.Find("b"));
+  EXPECT_TRUE(cache.Find("c"));
+  EXPECT_TRUE(cache.Find("d"));
+  EXPECT_LE(cache.total_bytes(), cache.total_bytes_limit());
+}
+
+TEST(EncodedValueCacheTest, ValueLargerThanLimit) {
+  EncodedValueCache cache(100);
+  cache.Insert("a", MakeValue(std::string(1000, 'x')));
+  EXPECT_FALSE(cache.Find("a"));
+  EXPECT_EQ(0, cache.total_bytes());
+}
+
+TEST(EncodedValueCacheTest, Reserve) {
+  const std::string value(1000, 'x');
+  EncodedValueCache cache(3500);
+  cache.Insert("a", MakeValue(value));
+  cache.Insert("b", MakeValue(value));
+  // Reserving space evicts the least recently used stored value.
+  EXPECT_TRUE(cache.Reserve(2000));
+  EXPECT_EQ(2000, cache.reserved_bytes());
+  EXPECT_FALSE(cache.Find("a"));
+  EXPECT_TRUE(cache.Find("b"));
+  EXPECT_LE(cache.total_bytes(), cache.total_bytes_limit());
+  // Reservations are not evicted, so reserving beyond the limit fails.
+  EXPECT_FALSE(cache.Reserve(2000));
+  EXPECT_EQ(2000, cache.reserved_bytes());
+  // Values that do not fit alongside the reservations are not stored.
+  cache.Insert("c", MakeValue(std::string(2000, 'x')));
+  EXPECT_FALSE(cache.Find("c"));
+  cache.Unreserve(2000);
+  EXPECT_EQ(0, cache.reserved_bytes());
+  cache.Insert("c", MakeValue(std::string(2000, 'x')));
+  EXPECT_TRUE(cache.Find("c"));
+}
+
+}  // namespace
@@ -0,0 +1,109 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/frequency_sketch.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "absl/numeric/bits.h"
+
+namespace tensorstore {
+namespace internal_cache {
+namespace {
+
+constexpr int kDepth = 4;
+
+// Each table word holds 16 4-bit counters, divided into one group of 4
+// counters per depth.
+constexpr uint64_t kResetMask = 0x7777777777777777;
+
+constexpr uint64_t kSeeds[kDepth] = {
+    0xc3a5c85c97cb3127,
+    0xb492b66fbe98f273,
+    0x9ae16a3b2f90404f,
+    0xcbf29ce484222325,
+};
+
+// Returns the bit offset within its word of the counter for depth `i`.
+inline int CounterShift(uint64_t hash, int i) {
+  return ((i << 2) + static_cast<int>((hash >> (i << 3)) & 3)) << 2;
+}
+
+}  // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+  // Allocate one word, or 16 counters, per item; each item uses 4 counters,
+  // and the sketch is most accurate when sparse.
+  const size_t num_words =
+      absl::bit_ceil(std::clamp<size_t>(capacity, 16, size_t{1} << 22));
+  table_.reset(new std::atomic<uint64_t>[num_words]);
+  for (size_t i = 0; i < num_words; ++i) {
+    table_[i].store(0, std::memory_order_relaxed);
+  }
+  table_mask_ = num_words - 1;
+  sample_size_ = 10 * std::max<size_t>(capacity, 1);
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+  bool added = false;
+  for (int i = 0; i < kDepth; ++i) {
+    uint64_t h = hash * kSeeds[i];
+    h += h >> 32;
+    auto& word = table_[h & table_mask_];
+    const int shift = CounterShift(hash, i);
+    const uint64_t mask = uint64_t{15} << shift;
+    uint64_t value = word.load(std::memory_order_relaxed);
+    while ((value & mask) != mask) {
+      if (word.compare_exchange_weak(value, value + (uint64_t{1} << shift),
+                                     std::memory_order_relaxed)) {
+        added = true;
+        break;
+      }
+    }
+  }
+  if (added && num_increments_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+                   sample_size_) {
+    Reset();
+  }
+}
+
+int FrequencySketch::Estimate(uint64_t hash) const {
+  int frequency = kMaxFrequency;
+  for (int i = 0; i < kDepth; ++i) {
+    uint64_t h = hash * kSeeds[i];
+    h += h >> 32;
+    const uint64_t value = table_[h & table_mask_].load(
+        std::memory_order_relaxed);
+    frequency = std::min(
+        frequency, static_cast<int>((value >> CounterShift(hash, i)) & 15));
+  }
+  return frequency;
+}
+
+void FrequencySketch::Reset() {
+  // Halve all counters.  Increments that race with the reset may be lost.
+  for (size_t i = 0; i <= table_mask_; ++i) {
+    const uint64_t value = table_[i].load(std::memory_order_relaxed);
+    table_[i].store((value >> 1) & kResetMask, std::memory_order_relaxed);
+  }
+  num_increments_.fetch_sub(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+}  // namespace internal_cache
+}  // namespace tensorstore
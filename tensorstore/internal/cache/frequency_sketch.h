@@ -0,0 +1,68 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_CACHE_FREQUENCY_SKETCH_H_
+#define TENSORSTORE_INTERNAL_CACHE_FREQUENCY_SKETCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+namespace tensorstore {
+namespace internal_cache {
+
+/// Approximate, aging access-frequency counter used by the TinyLFU eviction
+/// policy.
+///
+/// This is a count-min sketch with 4-bit saturating counters and a depth of 4.
+/// Once the number of recorded accesses reaches a sample size proportional to
+/// the capacity, all counters are halved, so that the estimates reflect recent
+/// rather than all-time popularity.
+///
+/// All operations are thread-safe and lock-free.  Concurrent updates may
+/// occasionally be lost, which only affects the accuracy of the estimates.
+class FrequencySketch {
+ public:
+  /// Maximum value of an estimate.
+  static constexpr int kMaxFrequency = 15;
+
+  /// Constructs a sketch suitable for tracking approximately `capacity`
+  /// distinct items.
+  explicit FrequencySketch(size_t capacity);
+
+  /// Records an access to the item with the specified hash.
+  void Increment(uint64_t hash);
+
+  /// Returns the estimated number of recent accesses to the item with the
+  /// specified hash, in the range `[0, kMaxFrequency]`.
+  int Estimate(uint64_t hash) const;
+
+  /// Number of accesses after which the counters are halved.
+  size_t sample_size() const { return sample_size_; }
+
+ private:
+  void Reset();
+
+  std::unique_ptr<std::atomic<uint64_t>[]> table_;
+  size_t table_mask_;
+  size_t sample_size_;
+  std::atomic<size_t> num_increments_{0};
+};
+
+}  // namespace internal_cache
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_CACHE_FREQUENCY_SKETCH_H_
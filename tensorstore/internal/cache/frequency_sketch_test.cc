@@ -0,0 +1,70 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/frequency_sketch.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/hash/hash.h"
+
+namespace {
+
+using ::tensorstore::internal_cache::FrequencySketch;
+
+uint64_t Hash(int i) { return absl::HashOf(i); }
+
+TEST(FrequencySketchTest, Empty) {
+  FrequencySketch sketch(100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(0, sketch.Estimate(Hash(i)));
+  }
+}
+
+TEST(FrequencySketchTest, Increment) {
+  FrequencySketch sketch(100);
+  for (int j = 0; j < 5; ++j) {
+    sketch.Increment(Hash(1));
+  }
+  sketch.Increment(Hash(2));
+  // Estimates are upper bounds on the true counts.
+  EXPECT_GE(sketch.Estimate(Hash(1)), 5);
+  EXPECT_GE(sketch.Estimate(Hash(2)), 1);
+  EXPECT_GT(sketch.Estimate(Hash(1)), sketch.Estimate(Hash(2)));
+}
+
+TEST(FrequencySketchTest, Saturates) {
+  FrequencySketch sketch(100);
+  for (int j = 0; j < 100; ++j) {
+    sketch.Increment(Hash(1));
+  }
+  EXPECT_EQ(FrequencySketch::kMaxFrequency, sketch.Estimate(Hash(1)));
+}
+
+TEST(FrequencySketchTest, Reset) {
+  FrequencySketch sketch(1000);
+  for (int j = 0; j < FrequencySketch::kMaxFrequency; ++j) {
+    sketch.Increment(Hash(-1));
+  }
+  const int before = sketch.Estimate(Hash(-1));
+  // Record enough accesses to other items to trigger a reset.
+  for (size_t i = 0; i < 2 * sketch.sample_size(); ++i) {
+    sketch.Increment(Hash(static_cast<int>(i % 1000)));
+  }
+  EXPECT_LT(sketch.Estimate(Hash(-1)), before);
+}
+
+}  // namespace
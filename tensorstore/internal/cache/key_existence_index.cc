@@ -0,0 +1,136 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/key_existence_index.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_log.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal {
+namespace {
+
+auto& key_existence_index_builds = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/key_existence_index/builds",
+    "Number of times a key existence index was built by listing the kvstore");
+
+}  // namespace
+
+KeyExistenceIndex::KeyExistenceIndex(kvstore::DriverPtr driver, KeyRange range)
+    : driver_(std::move(driver)), range_(std::move(range)) {}
+
+bool KeyExistenceIndex::IsValid() const {
+  return !disabled_ && build_time_ != absl::InfinitePast() &&
+         build_time_ >= required_time_;
+}
+
+void KeyExistenceIndex::Invalidate(absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  required_time_ = std::max(required_time_, time);
+}
+
+Future<const void> KeyExistenceIndex::Ready() {
+  absl::Time time;
+  Promise<void> promise;
+  Future<const void> future;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!build_future_.null()) return build_future_;
+    time = absl::Now();
+    if (disabled_ || IsValid() || required_time_ > time) {
+      return MakeReadyFuture();
+    }
+    auto pair = PromiseFuturePair<void>::Make(MakeResult());
+    promise = std::move(pair.promise);
+    future = build_future_ = std::move(pair.future);
+    pending_updates_.clear();
+  }
+  key_existence_index_builds.Increment();
+  kvstore::ListOptions options;
+  options.range = range_;
+  options.staleness_bound = time;
+  kvstore::ListFuture(driver_, std::move(options))
+      .ExecuteWhenReady(
+          [self = IntrusivePtr<KeyExistenceIndex>(this), time,
+           promise = std::move(promise)](
+              ReadyFuture<std::vector<kvstore::Key>> future) mutable {
+            self->BuildDone(time, std::move(future.result()));
+            // Marks the build future ready.
+            promise = Promise<void>();
+          });
+  return future;
+}
+
+void KeyExistenceIndex::BuildDone(absl::Time time,
+                                  Result<std::vector<kvstore::Key>> keys) {
+  absl::MutexLock lock(&mutex_);
+  if (keys.ok()) {
+    keys_.clear();
+    keys_.reserve(keys->size());
+    for (auto& key : *keys) keys_.insert(std::move(key));
+    // Apply writes that completed while listing.
+    for (auto& [key, present] : pending_updates_) {
+      if (present) {
+        keys_.insert(key);
+      } else {
+        keys_.erase(key);
+      }
+    }
+    build_time_ = time;
+  } else {
+    ABSL_LOG(WARNING) << "Disabling key existence index: " << keys.status();
+    disabled_ = true;
+    keys_.clear();
+  }
+  pending_updates_.clear();
+  build_future_ = Future<const void>();
+}
+
+std::optional<absl::Time> KeyExistenceIndex::GetMissingTime(
+    std::string_view key) {
+  if (!Contains(range_, key)) return std::nullopt;
+  absl::MutexLock lock(&mutex_);
+  if (!IsValid() || keys_.contains(key)) return std::nullopt;
+  return build_time_;
+}
+
+void KeyExistenceIndex::SetPresent(std::string_view key, bool present) {
+  if (!Contains(range_, key)) return;
+  absl::MutexLock lock(&mutex_);
+  if (disabled_) return;
+  if (!build_future_.null()) {
+    pending_updates_[std::string(key)] = present;
+  }
+  if (present) {
+    keys_.emplace(key);
+  } else {
+    keys_.erase(key);
+  }
+}
+
+}  // namespace internal
+}  // namespace tensorstore
@@ -0,0 +1,109 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_CACHE_KEY_EXISTENCE_INDEX_H_
+#define TENSORSTORE_INTERNAL_CACHE_KEY_EXISTENCE_INDEX_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+namespace internal {
+
+/// In-memory index of the keys present within a range of a `kvstore::Driver`,
+/// used to avoid reading keys that are known not to exist.
+///
+/// The index is built lazily by listing `range`, and is then kept up to date
+/// with the writes reported by `SetPresent`.  Lookups only succeed if the index
+/// was built no earlier than the time specified by the most recent call to
+/// `Invalidate`; otherwise, `Ready` starts a new build.
+///
+/// If listing fails (e.g. because the driver does not support `List`), the
+/// index is disabled and all lookups return `std::nullopt`.
+///
+/// All operations are thread-safe.
+class KeyExistenceIndex : public AtomicReferenceCount<KeyExistenceIndex> {
+ public:
+  explicit KeyExistenceIndex(kvstore::DriverPtr driver, KeyRange range);
+
+  /// Requires that lookups reflect the state of the kvstore as of at least
+  /// `time`.
+  ///
+  /// If `time` is in the future (e.g. `absl::InfiniteFuture()`), the index is
+  /// never used.
+  void Invalidate(absl::Time time);
+
+  /// Returns a future that becomes ready once the index is usable, building it
+  /// if necessary.
+  ///
+  /// The returned future is ready immediately if the index is already valid or
+  /// cannot be used.
+  Future<const void> Ready();
+
+  /// Returns the time as of which `key` is known not to exist, or
+  /// `std::nullopt` if `key` may exist.
+  std::optional<absl::Time> GetMissingTime(std::string_view key);
+
+  /// Records the result of a successful write (`present == true`) or delete
+  /// (`present == false`) of `key`.
+  void SetPresent(std::string_view key, bool present);
+
+  const KeyRange& range() const { return range_; }
+
+ private:
+  bool IsValid() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  void BuildDone(absl::Time time, Result<std::vector<kvstore::Key>> keys);
+
+  kvstore::DriverPtr driver_;
+  KeyRange range_;
+
+  absl::Mutex mutex_;
+
+  // Earliest time as of which `keys_` must reflect the kvstore.
+  absl::Time required_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+
+  // Time as of which `keys_` reflects the kvstore.  Equal to
+  // `absl::InfinitePast()` if the index has not been built.
+  absl::Time build_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+
+  // Set once listing fails.
+  bool disabled_ ABSL_GUARDED_BY(mutex_) = false;
+
+  absl::flat_hash_set<std::string> keys_ ABSL_GUARDED_BY(mutex_);
+
+  // Pending build, or null.
+  Future<const void> build_future_ ABSL_GUARDED_BY(mutex_);
+
+  // Writes recorded while `build_future_` is pending, which may not be
+  // reflected by the listing.
+  absl::flat_hash_map<std::string, bool> pending_updates_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_CACHE_KEY_EXISTENCE_INDEX_H_
@@ -0,0 +1,84 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/key_existence_index.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/memory/memory_key_value_store.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::KeyRange;
+using ::tensorstore::internal::KeyExistenceIndex;
+using ::tensorstore::internal::MakeIntrusivePtr;
+using ::testing::Optional;
+
+TEST(KeyExistenceIndexTest, Basic) {
+  auto driver = tensorstore::GetMemoryKeyValueStore();
+  TENSORSTORE_ASSERT_OK(
+      tensorstore::kvstore::Write(driver, "a/0", absl::Cord("x")).result());
+  TENSORSTORE_ASSERT_OK(
+      tensorstore::kvstore::Write(driver, "b/0", absl::Cord("x")).result());
+  auto index = MakeIntrusivePtr<KeyExistenceIndex>(driver, KeyRange::Prefix("a/"));
+
+  // Not built yet.
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("a/1"));
+
+  const absl::Time before_build = absl::Now();
+  TENSORSTORE_ASSERT_OK(index->Ready().result());
+  auto missing_time = index->GetMissingTime("a/1");
+  ASSERT_TRUE(missing_time);
+  EXPECT_GE(*missing_time, before_build);
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("a/0"));
+  // Outside the range of the index.
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("b/1"));
+
+  index->SetPresent("a/1", true);
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("a/1"));
+  index->SetPresent("a/0", false);
+  EXPECT_THAT(index->GetMissingTime("a/0"), Optional(*missing_time));
+}
+
+TEST(KeyExistenceIndexTest, Invalidate) {
+  auto driver = tensorstore::GetMemoryKeyValueStore();
+  auto index = MakeIntrusivePtr<KeyExistenceIndex>(driver, KeyRange());
+  TENSORSTORE_ASSERT_OK(index->Ready().result());
+  EXPECT_TRUE(index->GetMissingTime("a"));
+
+  // Written by another writer.
+  TENSORSTORE_ASSERT_OK(
+      tensorstore::kvstore::Write(driver, "a", absl::Cord("x")).result());
+  index->Invalidate(absl::Now());
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("a"));
+  TENSORSTORE_ASSERT_OK(index->Ready().result());
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("a"));
+  EXPECT_TRUE(index->GetMissingTime("b"));
+
+  // A bound in the future disables the index.
+  index->Invalidate(absl::InfiniteFuture());
+  auto ready = index->Ready();
+  EXPECT_TRUE(ready.ready());
+  EXPECT_EQ(std::nullopt, index->GetMissingTime("b"));
+}
+
+}  // namespace
@@ -41,5 +41,15 @@ void KvsBackedCache_IncrementReadErrorMetric() {
   cell.Increment();
 }
 
+void KvsBackedCache_IncrementReadEncodedValueCacheMetric() {
+  static auto& cell = kvs_cache_read.GetCell("encoded_value_cache");
+  cell.Increment();
+}
+
+void KvsBackedCache_IncrementReadKeyExistenceIndexMetric() {
+  static auto& cell = kvs_cache_read.GetCell("key_existence_index");
+  cell.Increment();
+}
+
 }  // namespace internal
 }  // namespace tensorstore
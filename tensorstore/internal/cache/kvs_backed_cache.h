@@ -19,6 +19,7 @@
 ///
 /// Integrates `AsyncCache` with `kvstore::Driver`.
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <string>
@@ -31,8 +32,14 @@
 #include "absl/strings/cord.h"
 #include "absl/time/time.h"
 #include "tensorstore/internal/cache/async_cache.h"
+#include "tensorstore/internal/cache/encoded_value_cache.h"
+#include "tensorstore/internal/cache/key_existence_index.h"
+#include "tensorstore/internal/cache/writeback_scheduler.h"
+#include "tensorstore/internal/cache_key/cache_key.h"
+#include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/operations.h"
 #include "tensorstore/kvstore/read_modify_write.h"
@@ -48,6 +55,8 @@ namespace internal {
 void KvsBackedCache_IncrementReadUnchangedMetric();
 void KvsBackedCache_IncrementReadChangedMetric();
 void KvsBackedCache_IncrementReadErrorMetric();
+void KvsBackedCache_IncrementReadEncodedValueCacheMetric();
+void KvsBackedCache_IncrementReadKeyExistenceIndexMetric();
 
 /// Base class that integrates an `AsyncCache` with a `kvstore::Driver`.
 ///
@@ -73,6 +82,20 @@ void KvsBackedCache_IncrementReadErrorMetric();
 /// `kvstore::Driver`, and handling the timestamps and `StorageGeneration`
 /// values.
 ///
+/// If the cache pool retains encoded values (see
+/// `CachePoolLimits::encoded_bytes_limit`), each entry holds the value read
+/// from the `kvstore::Driver` from which its data was decoded, charged against
+/// the pool's `EncodedValueCache`.  When the entry is evicted, the value is
+/// moved to the `EncodedValueCache`, keyed by the cache key of the
+/// `kvstore::Driver` and the kvstore key.  Reads of entries without cached data
+/// are then satisfied by decoding the retained value, or, if it does not
+/// satisfy the staleness bound, by a conditional read that only transfers the
+/// value if it has changed.
+///
+/// If a `KeyExistenceIndex` is enabled by `EnableKeyExistenceIndex`, reads of
+/// keys that the index reports as missing are satisfied without reading from
+/// the `kvstore::Driver`.
+///
 /// \tparam Parent Parent class, must inherit from (or equal) `AsyncCache`.
 template <typename Derived, typename Parent>
 class KvsBackedCache : public Parent {
@@ -87,8 +110,15 @@ class KvsBackedCache : public Parent {
   /// \param args Arguments to forward to the `Parent` constructor.
   template <typename... U>
   explicit KvsBackedCache(kvstore::DriverPtr kvstore_driver, U&&... args)
-      : Parent(std::forward<U>(args)...),
-        kvstore_driver_(std::move(kvstore_driver)) {}
+      : Parent(std::forward<U>(args)...) {
+    SetKvStoreDriver(std::move(kvstore_driver));
+  }
+
+  ~KvsBackedCache() {
+    if (auto* index = key_existence_index()) {
+      intrusive_ptr_decrement(index);
+    }
+  }
 
   class TransactionNode;
 
@@ -96,6 +126,17 @@ class KvsBackedCache : public Parent {
    public:
     using OwningCache = KvsBackedCache;
 
+    ~Entry() {
+      // Move the retained encoded value to the `EncodedValueCache`, so that
+      // this entry may be decoded again without reading from the kvstore.
+      std::unique_ptr<RetainedEncodedValue> retained(
+          retained_encoded_value_.load(std::memory_order_acquire));
+      if (!retained) return;
+      auto* encoded_value_cache = GetOwningCache(*this).encoded_value_cache();
+      encoded_value_cache->Unreserve(retained->num_bytes);
+      encoded_value_cache->Insert(retained->key, std::move(retained->value));
+    }
+
     /// Defines the mapping from a cache entry to a kvstore key.
     ///
     /// By default the cache entry key is used, but derived classes may override
@@ -104,6 +145,13 @@ class KvsBackedCache : public Parent {
       return std::string{this->key()};
     }
 
+    /// Returns the key of this entry in the `EncodedValueCache` of the pool.
+    std::string GetEncodedValueCacheKey() {
+      std::string key = GetOwningCache(*this).encoded_value_cache_key_prefix_;
+      internal::EncodeCacheKey(&key, this->GetKeyValueStoreKey());
+      return key;
+    }
+
     template <typename EntryOrNode>
     struct DecodeReceiverImpl {
       EntryOrNode* self_;
@@ -140,6 +188,12 @@ class KvsBackedCache : public Parent {
         ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
             << *entry_or_node_ << "DoDecode: " << read_result.stamp;
         KvsBackedCache_IncrementReadChangedMetric();
+        if constexpr (std::is_same_v<EntryOrNode, Entry>) {
+          // Reads within a transaction may observe uncommitted values, which
+          // must not be retained.
+          entry_or_node_->RetainEncodedValue(
+              {read_result.optional_value(), read_result.stamp});
+        }
         GetOwningEntry(*entry_or_node_)
             .DoDecode(std::move(read_result).optional_value(),
                       DecodeReceiverImpl<EntryOrNode>{
@@ -153,18 +207,109 @@ class KvsBackedCache : public Parent {
       void set_cancel() { ABSL_UNREACHABLE(); }  // COV_NF_LINE
     };
 
+    /// Receiver for a conditional read that revalidates a value retained by
+    /// the `EncodedValueCache`.
+    struct RevalidateReceiverImpl {
+      Entry* entry_;
+      std::optional<absl::Cord> encoded_value_;
+      void set_value(kvstore::ReadResult read_result) {
+        if (read_result.aborted()) {
+          // The retained value is still current.
+          if (encoded_value_) {
+            read_result.state = kvstore::ReadResult::kValue;
+            read_result.value = std::move(*encoded_value_);
+          } else {
+            read_result.state = kvstore::ReadResult::kMissing;
+          }
+        }
+        ReadReceiverImpl<Entry>{entry_}.set_value(std::move(read_result));
+      }
+      void set_error(absl::Status error) {
+        ReadReceiverImpl<Entry>{entry_}.set_error(std::move(error));
+      }
+      void set_cancel() { ABSL_UNREACHABLE(); }  // COV_NF_LINE
+    };
+
     /// Implements reading for the `AsyncCache` interface.
     ///
     /// Reads from the `kvstore::Driver` and invokes `DoDecode` with the result.
     ///
     /// If an error occurs, calls `ReadError` directly without invoking
     /// `DoDecode`.
-    void DoRead(absl::Time staleness_bound) final {
+    void DoRead(AsyncCacheReadRequest request) final {
+      auto* index = GetOwningCache(*this).key_existence_index();
+      if (!index) {
+        ReadFromKvstore(std::move(request));
+        return;
+      }
+      auto ready = index->Ready();
+      if (ready.ready()) {
+        ReadWithKeyExistenceIndex(*index, std::move(request));
+        return;
+      }
+      // Wait for the index to be built, rather than reading keys that may be
+      // known to be missing once it is.
+      std::move(ready).ExecuteWhenReady(
+          [this, index = IntrusivePtr<KeyExistenceIndex>(index),
+           request = std::move(request)](ReadyFuture<const void>) mutable {
+            ReadWithKeyExistenceIndex(*index, std::move(request));
+          });
+    }
+
+   private:
+    void ReadWithKeyExistenceIndex(KeyExistenceIndex& index,
+                                   AsyncCacheReadRequest request) {
+      if (auto missing_time = index.GetMissingTime(this->GetKeyValueStoreKey());
+          missing_time &&
+          *missing_time >
+              AsyncCache::ReadLock<void>(*this).read_state().stamp.time) {
+        ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
+            << *this << "DoDecode missing from key existence index: "
+            << *missing_time;
+        KvsBackedCache_IncrementReadKeyExistenceIndexMetric();
+        this->DoDecode(std::nullopt,
+                       DecodeReceiverImpl<Entry>{
+                           this, TimestampedStorageGeneration{
+                                     StorageGeneration::NoValue(),
+                                     *missing_time}});
+        return;
+      }
+      ReadFromKvstore(std::move(request));
+    }
+
+    void ReadFromKvstore(AsyncCacheReadRequest request) {
+      const absl::Time staleness_bound = request.staleness_bound;
       kvstore::ReadOptions options;
       options.staleness_bound = staleness_bound;
+      options.batch = std::move(request.batch);
       auto read_state = AsyncCache::ReadLock<void>(*this).read_state();
       options.if_not_equal = std::move(read_state.stamp.generation);
       auto& cache = GetOwningCache(*this);
+      auto* encoded_value_cache = cache.encoded_value_cache();
+      if (encoded_value_cache &&
+          StorageGeneration::IsUnknown(options.if_not_equal)) {
+        if (auto encoded = encoded_value_cache->Find(
+                this->GetEncodedValueCacheKey())) {
+          if (encoded->stamp.time >= staleness_bound) {
+            ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
+                << *this << "DoDecode from encoded value cache: "
+                << encoded->stamp;
+            KvsBackedCache_IncrementReadEncodedValueCacheMetric();
+            RetainEncodedValue(*encoded);
+            this->DoDecode(std::move(encoded->value),
+                           DecodeReceiverImpl<Entry>{
+                               this, std::move(encoded->stamp)});
+            return;
+          }
+          options.if_not_equal = std::move(encoded->stamp.generation);
+          auto future = cache.kvstore_driver_->Read(
+              this->GetKeyValueStoreKey(), std::move(options));
+          execution::submit(
+              std::move(future),
+              RevalidateReceiverImpl{this, std::move(encoded->value)});
+          return;
+        }
+      }
       auto future = cache.kvstore_driver_->Read(this->GetKeyValueStoreKey(),
                                                 std::move(options));
       execution::submit(
@@ -172,6 +317,56 @@ class KvsBackedCache : public Parent {
           ReadReceiverImpl<Entry>{this, std::move(read_state.data)});
     }
 
+    friend class TransactionNode;
+
+    /// Encoded value from which the data of this entry was decoded.
+    struct RetainedEncodedValue {
+      std::string key;
+      internal_cache::EncodedValueCache::Value value;
+      // Number of bytes reserved in the `EncodedValueCache`.
+      size_t num_bytes;
+    };
+
+    /// Retains `value`, the encoded value from which the data of this entry
+    /// is decoded, until this entry is evicted, replacing any previously
+    /// retained value.
+    ///
+    /// The value is moved out of the `EncodedValueCache`, if stored there, and
+    /// is not retained if there is insufficient space to reserve for it.
+    void RetainEncodedValue(internal_cache::EncodedValueCache::Value value) {
+      auto* encoded_value_cache = GetOwningCache(*this).encoded_value_cache();
+      if (!encoded_value_cache) return;
+      std::string key = GetEncodedValueCacheKey();
+      const size_t num_bytes =
+          internal_cache::EncodedValueCache::GetSizeInBytes(key, value);
+      encoded_value_cache->Erase(key);
+      std::unique_ptr<RetainedEncodedValue> retained;
+      if (encoded_value_cache->Reserve(num_bytes)) {
+        retained.reset(new RetainedEncodedValue{std::move(key),
+                                                std::move(value), num_bytes});
+      }
+      ReleaseEncodedValue(retained_encoded_value_.exchange(
+          retained.release(), std::memory_order_acq_rel));
+    }
+
+    /// Discards the retained encoded value, if any, after the value in the
+    /// kvstore has been overwritten.
+    void DiscardEncodedValue() {
+      ReleaseEncodedValue(retained_encoded_value_.exchange(
+          nullptr, std::memory_order_acq_rel));
+    }
+
+    void ReleaseEncodedValue(RetainedEncodedValue* retained) {
+      if (!retained) return;
+      GetOwningCache(*this).encoded_value_cache()->Unreserve(
+          retained->num_bytes);
+      delete retained;
+    }
+
+    // Owned.  Set only if the cache pool retains encoded values.
+    std::atomic<RetainedEncodedValue*> retained_encoded_value_{nullptr};
+
+   public:
     using DecodeReceiver =
         AnyReceiver<absl::Status,
                     std::shared_ptr<const typename Derived::ReadData>>;
@@ -225,10 +420,10 @@ class KvsBackedCache : public Parent {
       return absl::OkStatus();
     }
 
-    void DoRead(absl::Time staleness_bound) final {
+    void DoRead(AsyncCacheReadRequest request) final {
       auto read_state = AsyncCache::ReadLock<void>(*this).read_state();
       target_->KvsRead(
-          {std::move(read_state.stamp.generation), staleness_bound},
+          {std::move(read_state.stamp.generation), request.staleness_bound},
           typename Entry::template ReadReceiverImpl<TransactionNode>{
               this, std::move(read_state.data)});
     }
@@ -266,11 +461,30 @@ class KvsBackedCache : public Parent {
         read_result.stamp = std::move(read_state.stamp);
         return execution::set_value(receiver, std::move(read_result));
       }
+      // Writeback of this node is pipelined through the cache pool's
+      // `WritebackScheduler`, if any: the encode holds a `kEncode` slot, and
+      // the write of an encoded value that is committed independently of other
+      // nodes holds a `kIo` slot until `KvsWritebackSuccess` or
+      // `KvsWritebackError`.  A node that already holds a `kIo` slot (because
+      // the write is being retried) bypasses the scheduler, since waiting for
+      // an encode slot while holding an I/O slot could deadlock.
+      auto* scheduler = GetOwningCache(*this).writeback_scheduler();
+      if (scheduler && io_slot_held_) scheduler = nullptr;
+      const bool acquire_io_slot =
+          scheduler &&
+          options.writeback_mode == ReadModifyWriteSource::kNormalWriteback &&
+          this->transaction()->commit_started() &&
+          target_->KvsIndependentWriteback();
       struct EncodeReceiverImpl {
         TransactionNode* self_;
         AsyncCache::ReadState update_;
         ReadModifyWriteSource::WritebackReceiver receiver_;
+        internal_cache::WritebackScheduler* scheduler_;
+        bool acquire_io_slot_;
         void set_error(absl::Status error) {
+          if (scheduler_) {
+            scheduler_->Release(internal_cache::WritebackScheduler::kEncode);
+          }
           error = GetOwningEntry(*self_).AnnotateError(std::move(error),
                                                        /*reading=*/false);
           execution::set_error(receiver_, std::move(error));
@@ -289,7 +503,26 @@ class KvsBackedCache : public Parent {
           // FIXME: only save if committing, also could do this inside
           // ApplyReceiverImpl
           self_->new_data_ = std::move(update_.data);
-          execution::set_value(receiver_, std::move(read_result));
+          if (!scheduler_) {
+            execution::set_value(receiver_, std::move(read_result));
+            return;
+          }
+          if (!acquire_io_slot_) {
+            scheduler_->Release(internal_cache::WritebackScheduler::kEncode);
+            execution::set_value(receiver_, std::move(read_result));
+            return;
+          }
+          // Retain the encode slot until an I/O slot is available, to bound
+          // the number of encoded values awaiting writeback.
+          scheduler_->Acquire(
+              internal_cache::WritebackScheduler::kIo,
+              [self = self_, scheduler = scheduler_,
+               receiver = std::move(receiver_),
+               read_result = std::move(read_result)]() mutable {
+                self->io_slot_held_ = true;
+                scheduler->Release(internal_cache::WritebackScheduler::kEncode);
+                execution::set_value(receiver, std::move(read_result));
+              });
         }
       };
       struct ApplyReceiverImpl {
@@ -297,6 +530,8 @@ class KvsBackedCache : public Parent {
         StorageGeneration if_not_equal_;
         ReadModifyWriteSource::WritebackMode writeback_mode_;
         ReadModifyWriteSource::WritebackReceiver receiver_;
+        internal_cache::WritebackScheduler* scheduler_;
+        bool acquire_io_slot_;
         void set_error(absl::Status error) {
           execution::set_error(receiver_, std::move(error));
         }
@@ -319,10 +554,23 @@ class KvsBackedCache : public Parent {
           auto update_data =
               std::static_pointer_cast<const typename Derived::ReadData>(
                   update.data);
-          GetOwningEntry(*self_).DoEncode(
-              std::move(update_data),
-              EncodeReceiverImpl{self_, std::move(update),
-                                 std::move(receiver_)});
+          if (!scheduler_) {
+            GetOwningEntry(*self_).DoEncode(
+                std::move(update_data),
+                EncodeReceiverImpl{self_, std::move(update),
+                                   std::move(receiver_), nullptr, false});
+            return;
+          }
+          scheduler_->Acquire(
+              internal_cache::WritebackScheduler::kEncode,
+              [self = self_, update_data = std::move(update_data),
+               receiver =
+                   EncodeReceiverImpl{self_, std::move(update),
+                                      std::move(receiver_), scheduler_,
+                                      acquire_io_slot_}]() mutable {
+                GetOwningEntry(*self).DoEncode(std::move(update_data),
+                                               std::move(receiver));
+              });
         }
       };
       AsyncCache::TransactionNode::ApplyOptions apply_options;
@@ -332,23 +580,57 @@ class KvsBackedCache : public Parent {
       this->DoApply(
           std::move(apply_options),
           ApplyReceiverImpl{this, std::move(options.if_not_equal),
-                            options.writeback_mode, std::move(receiver)});
+                            options.writeback_mode, std::move(receiver),
+                            scheduler, acquire_io_slot});
     }
 
     void KvsWritebackSuccess(TimestampedStorageGeneration new_stamp) override {
+      if (auto* encoded_value_cache =
+              GetOwningCache(*this).encoded_value_cache()) {
+        auto& entry = GetOwningEntry(*this);
+        entry.DiscardEncodedValue();
+        encoded_value_cache->Erase(entry.GetEncodedValueCacheKey());
+      }
+      if (auto* index = GetOwningCache(*this).key_existence_index();
+          index && !StorageGeneration::IsUnknown(new_stamp.generation)) {
+        index->SetPresent(GetOwningEntry(*this).GetKeyValueStoreKey(),
+                          !StorageGeneration::IsNoValue(new_stamp.generation));
+      }
+      ReleaseIoSlot();
       return this->WritebackSuccess(
           AsyncCache::ReadState{std::move(new_data_), std::move(new_stamp)});
     }
-    void KvsWritebackError() override { this->WritebackError(); }
+    void KvsWritebackError() override {
+      ReleaseIoSlot();
+      this->WritebackError();
+    }
 
     void KvsRevoke() override { this->Revoke(); }
 
+    void KvsWritebackStaged() override {
+      new_data_ = nullptr;
+      this->WritebackStaged();
+    }
+
+    void StageWriteback() override { target_->KvsStageWriteback(); }
+
+    ~TransactionNode() { ReleaseIoSlot(); }
+
    private:
     friend class KvsBackedCache;
 
+    void ReleaseIoSlot() {
+      if (!io_slot_held_) return;
+      io_slot_held_ = false;
+      GetOwningCache(*this).writeback_scheduler()->Release(
+          internal_cache::WritebackScheduler::kIo);
+    }
+
     // Target to which this `ReadModifyWriteSource` is bound.
     ReadModifyWriteTarget* target_;
     std::shared_ptr<const void> new_data_;
+    // Indicates that this node holds a `WritebackScheduler::kIo` slot.
+    bool io_slot_held_ = false;
   };
 
   /// Returns the associated `kvstore::Driver`.
@@ -358,9 +640,42 @@ class KvsBackedCache : public Parent {
   /// are no concurrent read or write operations.
   void SetKvStoreDriver(kvstore::DriverPtr driver) {
     kvstore_driver_ = std::move(driver);
+    encoded_value_cache_key_prefix_.clear();
+    if (kvstore_driver_) {
+      internal::EncodeCacheKey(&encoded_value_cache_key_prefix_,
+                               kvstore_driver_);
+    }
+  }
+
+  /// Returns the `KeyExistenceIndex` used to avoid reading missing keys, or
+  /// `nullptr` if none has been enabled.
+  KeyExistenceIndex* key_existence_index() const {
+    return key_existence_index_.load(std::memory_order_acquire);
+  }
+
+  /// Enables a `KeyExistenceIndex` over `range` of the `kvstore::Driver`.
+  ///
+  /// If an index is already enabled, returns it and ignores `range`.  Once
+  /// enabled, the index remains in use for the lifetime of the cache.
+  KeyExistenceIndex& EnableKeyExistenceIndex(KeyRange range) {
+    auto* index = key_existence_index();
+    if (index) return *index;
+    auto new_index =
+        MakeIntrusivePtr<KeyExistenceIndex>(kvstore_driver_, std::move(range));
+    if (key_existence_index_.compare_exchange_strong(
+            index, new_index.get(), std::memory_order_acq_rel)) {
+      return *new_index.release();
+    }
+    return *index;
   }
 
   kvstore::DriverPtr kvstore_driver_;
+
+  // Owned reference to the optional `KeyExistenceIndex`.
+  std::atomic<KeyExistenceIndex*> key_existence_index_{nullptr};
+
+  // Identifies `kvstore_driver_` within the keys of the `EncodedValueCache`.
+  std::string encoded_value_cache_key_prefix_;
 };
 
 }  // namespace internal
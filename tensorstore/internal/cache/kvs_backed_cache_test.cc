@@ -132,6 +132,39 @@ TEST_F(MockStoreTest, WriteError) {
                             "Error writing \"a\": write error"));
 }
 
+TEST(KvsBackedCacheTest, WritebackIoConcurrency) {
+  CachePool::Limits limits;
+  limits.writeback_io_concurrency = 1;
+  auto pool = CachePool::Make(limits);
+  auto mock_store = MockKeyValueStore::Make();
+  auto memory_store = tensorstore::GetMemoryKeyValueStore();
+  auto cache = pool->GetCache<KvsBackedTestCache>(
+      "", [&] { return std::make_unique<KvsBackedTestCache>(mock_store); });
+  auto transaction = Transaction(tensorstore::isolated);
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto open_transaction,
+        tensorstore::internal::AcquireOpenTransactionPtrOrError(transaction));
+    TENSORSTORE_ASSERT_OK(
+        GetCacheEntry(cache, "a")->Modify(open_transaction, true, "abc"));
+    TENSORSTORE_ASSERT_OK(
+        GetCacheEntry(cache, "b")->Modify(open_transaction, true, "de"));
+  }
+  transaction.CommitAsync().IgnoreFuture();
+  std::vector<std::string> keys;
+  for (int i = 0; i < 2; ++i) {
+    // Only a single write is issued at a time.
+    auto write_req = mock_store->write_requests.pop();
+    EXPECT_TRUE(mock_store->write_requests.empty());
+    keys.push_back(write_req.key);
+    write_req(memory_store);
+  }
+  EXPECT_THAT(keys, ::testing::UnorderedElementsAre("a", "b"));
+  TENSORSTORE_EXPECT_OK(transaction.future().result());
+  EXPECT_EQ(0u, cache->writeback_scheduler()->in_flight(
+                    tensorstore::internal_cache::WritebackScheduler::kIo));
+}
+
 TEST_F(MockStoreTest, ReadErrorDuringWriteback) {
   auto entry = GetCacheEntry(cache, "a");
 
@@ -900,4 +933,126 @@ TEST(InitializeTest, Basic) {
   req(memory_store);
 }
 
+class EncodedValueCacheTest : public ::testing::Test {
+ protected:
+  CachePool::StrongPtr pool = CachePool::Make([] {
+    // Evict entries as soon as they are no longer in use.
+    CachePool::Limits limits;
+    limits.encoded_bytes_limit = 1000000;
+    return limits;
+  }());
+  MockKeyValueStore::MockPtr mock_store = MockKeyValueStore::Make();
+  kvstore::DriverPtr memory_store = tensorstore::GetMemoryKeyValueStore();
+  tensorstore::internal::CachePtr<KvsBackedTestCache> cache =
+      pool->GetCache<KvsBackedTestCache>(
+          "", [&] { return std::make_unique<KvsBackedTestCache>(mock_store); });
+};
+
+TEST_F(EncodedValueCacheTest, ReadAfterEviction) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  auto read_time = absl::Now();
+  {
+    auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, read_time);
+    mock_store->read_requests.pop()(memory_store);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(absl::Cord("abc")));
+  }
+
+  // The decoded entry has been evicted, but the encoded value is retained and
+  // satisfies the staleness bound.
+  {
+    auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, read_time);
+    EXPECT_TRUE(mock_store->read_requests.empty());
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(absl::Cord("abc")));
+  }
+
+  // A newer staleness bound requires revalidation with a conditional read.
+  {
+    auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, absl::Now());
+    auto read_req = mock_store->read_requests.pop();
+    EXPECT_FALSE(
+        StorageGeneration::IsUnknown(read_req.options.if_not_equal));
+    read_req(memory_store);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(absl::Cord("abc")));
+  }
+}
+
+TEST_F(EncodedValueCacheTest, RevalidateChangedValue) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  {
+    auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, absl::Now());
+    mock_store->read_requests.pop()(memory_store);
+    TENSORSTORE_ASSERT_OK(read_future);
+  }
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("def")).result());
+  auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, absl::Now());
+  mock_store->read_requests.pop()(memory_store);
+  EXPECT_THAT(read_future.result(), ::testing::Optional(absl::Cord("def")));
+}
+
+TEST_F(EncodedValueCacheTest, WriteInvalidatesEncodedValue) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  {
+    auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, absl::Now());
+    mock_store->read_requests.pop()(memory_store);
+    TENSORSTORE_ASSERT_OK(read_future);
+  }
+  {
+    auto entry = GetCacheEntry(cache, "a");
+    auto transaction = Transaction(tensorstore::atomic_isolated);
+    {
+      TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+          auto open_transaction,
+          tensorstore::internal::AcquireOpenTransactionPtrOrError(transaction));
+      TENSORSTORE_ASSERT_OK(entry->Modify(open_transaction, true, "def"));
+    }
+    transaction.CommitAsync().IgnoreFuture();
+    mock_store->write_requests.pop()(memory_store);
+    TENSORSTORE_ASSERT_OK(transaction.future());
+  }
+  auto read_future =
+      GetCacheEntry(cache, "a")->ReadValue({}, absl::InfinitePast());
+  mock_store->read_requests.pop()(memory_store);
+  EXPECT_THAT(read_future.result(), ::testing::Optional(absl::Cord("def")));
+}
+
+TEST(EncodedValueCacheWithDecodedLimitTest, ReadAfterEviction) {
+  auto pool = CachePool::Make([] {
+    // Decoded entries are retained, but the limit is too small to hold more
+    // than the entry currently in use.
+    CachePool::Limits limits;
+    limits.total_bytes_limit = 1;
+    limits.encoded_bytes_limit = 1000000;
+    return limits;
+  }());
+  auto mock_store = MockKeyValueStore::Make();
+  auto memory_store = tensorstore::GetMemoryKeyValueStore();
+  auto cache = pool->GetCache<KvsBackedTestCache>(
+      "", [&] { return std::make_unique<KvsBackedTestCache>(mock_store); });
+  auto* encoded_value_cache = cache->encoded_value_cache();
+  ASSERT_TRUE(encoded_value_cache);
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  auto read_time = absl::Now();
+  {
+    auto entry = GetCacheEntry(cache, "a");
+    auto read_future = entry->ReadValue({}, read_time);
+    mock_store->read_requests.pop()(memory_store);
+    EXPECT_THAT(read_future.result(), ::testing::Optional(absl::Cord("abc")));
+    // The resident entry holds its encoded value, which is charged to the
+    // encoded value tier.
+    EXPECT_LT(0, encoded_value_cache->reserved_bytes());
+  }
+
+  // Releasing the entry evicts it from the decoded pool, which moves its
+  // encoded value to the encoded value tier.
+  EXPECT_EQ(0, encoded_value_cache->reserved_bytes());
+  EXPECT_LT(0, encoded_value_cache->total_bytes());
+
+  auto read_future = GetCacheEntry(cache, "a")->ReadValue({}, read_time);
+  EXPECT_TRUE(mock_store->read_requests.empty());
+  EXPECT_THAT(read_future.result(), ::testing::Optional(absl::Cord("abc")));
+}
+
 }  // namespace
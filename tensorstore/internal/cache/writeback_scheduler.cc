@@ -0,0 +1,132 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/writeback_scheduler.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cassert>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/metrics/gauge.h"
+#include "tensorstore/internal/metrics/histogram.h"
+
+namespace tensorstore {
+namespace internal_cache {
+namespace {
+
+auto& encode_in_flight = internal_metrics::Gauge<int64_t>::New(
+    "/tensorstore/cache/writeback/encode_in_flight",
+    "Writeback encode operations in progress");
+
+auto& encode_queued = internal_metrics::Gauge<int64_t>::New(
+    "/tensorstore/cache/writeback/encode_queued",
+    "Writeback encode operations waiting for a "
+    "writeback_encode_concurrency slot");
+
+auto& encode_wait_ms =
+    internal_metrics::Histogram<internal_metrics::DefaultBucketer>::New(
+        "/tensorstore/cache/writeback/encode_wait_ms",
+        "Histogram of writeback encode delays due to "
+        "writeback_encode_concurrency (ms)");
+
+auto& io_in_flight = internal_metrics::Gauge<int64_t>::New(
+    "/tensorstore/cache/writeback/io_in_flight",
+    "Writeback kvstore writes in progress");
+
+auto& io_queued = internal_metrics::Gauge<int64_t>::New(
+    "/tensorstore/cache/writeback/io_queued",
+    "Encoded writeback values waiting for a writeback_io_concurrency slot");
+
+auto& io_wait_ms =
+    internal_metrics::Histogram<internal_metrics::DefaultBucketer>::New(
+        "/tensorstore/cache/writeback/io_wait_ms",
+        "Histogram of writeback kvstore write delays due to "
+        "writeback_io_concurrency (ms)");
+
+struct StageMetrics {
+  internal_metrics::Gauge<int64_t>& in_flight;
+  internal_metrics::Gauge<int64_t>& queued;
+  internal_metrics::Histogram<internal_metrics::DefaultBucketer>& wait_ms;
+};
+
+StageMetrics& GetStageMetrics(WritebackScheduler::Stage stage) {
+  static StageMetrics metrics[WritebackScheduler::kNumStages] = {
+      {encode_in_flight, encode_queued, encode_wait_ms},
+      {io_in_flight, io_queued, io_wait_ms},
+  };
+  return metrics[stage];
+}
+
+}  // namespace
+
+WritebackScheduler::WritebackScheduler(size_t encode_concurrency,
+                                       size_t io_concurrency)
+    : limits_{encode_concurrency, io_concurrency} {}
+
+void WritebackScheduler::Acquire(Stage stage, Task task) {
+  auto& metrics = GetStageMetrics(stage);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto& state = stages_[stage];
+    if (limits_[stage] != 0 && state.in_flight >= limits_[stage]) {
+      state.queue.push_back(QueuedTask{std::move(task), absl::Now()});
+      metrics.queued.Increment();
+      return;
+    }
+    ++state.in_flight;
+  }
+  metrics.in_flight.Increment();
+  metrics.wait_ms.Observe(0);
+  std::move(task)();
+}
+
+void WritebackScheduler::Release(Stage stage) {
+  auto& metrics = GetStageMetrics(stage);
+  QueuedTask next;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto& state = stages_[stage];
+    assert(state.in_flight > 0);
+    if (state.queue.empty()) {
+      --state.in_flight;
+      metrics.in_flight.Decrement();
+      return;
+    }
+    // Transfer the slot directly to the next queued task.
+    next = std::move(state.queue.front());
+    state.queue.pop_front();
+  }
+  metrics.queued.Decrement();
+  metrics.wait_ms.Observe(
+      absl::ToDoubleMilliseconds(absl::Now() - next.enqueue_time));
+  std::move(next.task)();
+}
+
+size_t WritebackScheduler::in_flight(Stage stage) const {
+  absl::MutexLock lock(&mutex_);
+  return stages_[stage].in_flight;
+}
+
+size_t WritebackScheduler::queued(Stage stage) const {
+  absl::MutexLock lock(&mutex_);
+  return stages_[stage].queue.size();
+}
+
+}  // namespace internal_cache
+}  // namespace tensorstore
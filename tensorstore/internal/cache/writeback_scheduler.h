@@ -0,0 +1,97 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_CACHE_WRITEBACK_SCHEDULER_H_
+#define TENSORSTORE_INTERNAL_CACHE_WRITEBACK_SCHEDULER_H_
+
+#include <stddef.h>
+
+#include <deque>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace tensorstore {
+namespace internal_cache {
+
+/// Bounds the number of concurrent encode and write operations performed by
+/// the writeback of the kvstore-backed caches of a cache pool.
+///
+/// Writeback of an entry proceeds in two pipelined stages: the modified data is
+/// encoded, and the encoded value is then written to the kvstore.  Each stage
+/// has a separate concurrency limit.  An entry acquires a `kIo` slot before
+/// releasing its `kEncode` slot, so that at most
+/// `encode_concurrency + io_concurrency` encoded values are held in memory at
+/// any time, and encoding does not run ahead of the kvstore.
+///
+/// All operations are thread-safe.
+class WritebackScheduler {
+ public:
+  enum Stage {
+    kEncode = 0,
+    kIo = 1,
+  };
+  static constexpr int kNumStages = 2;
+
+  using Task = absl::AnyInvocable<void() &&>;
+
+  /// Constructs a scheduler with the specified limits.  A limit of `0` means
+  /// unlimited.
+  explicit WritebackScheduler(size_t encode_concurrency,
+                              size_t io_concurrency);
+
+  WritebackScheduler(const WritebackScheduler&) = delete;
+  WritebackScheduler& operator=(const WritebackScheduler&) = delete;
+
+  /// Invokes `task` once a slot of `stage` is available.
+  ///
+  /// If a slot is immediately available, `task` is invoked synchronously by
+  /// the current thread.  Otherwise, it is queued and invoked by the thread
+  /// that releases a slot.  The slot is owned by `task` until released by a
+  /// matching call to `Release(stage)`.
+  void Acquire(Stage stage, Task task);
+
+  /// Releases a slot of `stage` previously acquired by `Acquire`.
+  void Release(Stage stage);
+
+  /// Returns the number of slots of `stage` currently held.
+  size_t in_flight(Stage stage) const;
+
+  /// Returns the number of tasks waiting for a slot of `stage`.
+  size_t queued(Stage stage) const;
+
+  size_t limit(Stage stage) const { return limits_[stage]; }
+
+ private:
+  struct QueuedTask {
+    Task task;
+    absl::Time enqueue_time;
+  };
+
+  struct StageState {
+    size_t in_flight = 0;
+    std::deque<QueuedTask> queue;
+  };
+
+  size_t limits_[kNumStages];
+  mutable absl::Mutex mutex_;
+  StageState stages_[kNumStages] ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal_cache
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_CACHE_WRITEBACK_SCHEDULER_H_
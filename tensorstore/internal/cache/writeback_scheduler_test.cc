@@ -0,0 +1,95 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/writeback_scheduler.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+using ::tensorstore::internal_cache::WritebackScheduler;
+
+TEST(WritebackSchedulerTest, Unlimited) {
+  WritebackScheduler scheduler(0, 0);
+  std::vector<int> log;
+  for (int i = 0; i < 10; ++i) {
+    scheduler.Acquire(WritebackScheduler::kEncode, [&, i] { log.push_back(i); });
+  }
+  EXPECT_EQ(10u, log.size());
+  EXPECT_EQ(10u, scheduler.in_flight(WritebackScheduler::kEncode));
+  EXPECT_EQ(0u, scheduler.queued(WritebackScheduler::kEncode));
+  for (int i = 0; i < 10; ++i) {
+    scheduler.Release(WritebackScheduler::kEncode);
+  }
+  EXPECT_EQ(0u, scheduler.in_flight(WritebackScheduler::kEncode));
+}
+
+TEST(WritebackSchedulerTest, QueuesInOrder) {
+  WritebackScheduler scheduler(2, 0);
+  std::vector<int> log;
+  for (int i = 0; i < 5; ++i) {
+    scheduler.Acquire(WritebackScheduler::kEncode, [&, i] { log.push_back(i); });
+  }
+  EXPECT_THAT(log, ::testing::ElementsAre(0, 1));
+  EXPECT_EQ(2u, scheduler.in_flight(WritebackScheduler::kEncode));
+  EXPECT_EQ(3u, scheduler.queued(WritebackScheduler::kEncode));
+
+  // The limit of one stage does not affect the other.
+  scheduler.Acquire(WritebackScheduler::kIo, [&] { log.push_back(100); });
+  EXPECT_THAT(log, ::testing::ElementsAre(0, 1, 100));
+
+  scheduler.Release(WritebackScheduler::kEncode);
+  EXPECT_THAT(log, ::testing::ElementsAre(0, 1, 100, 2));
+  EXPECT_EQ(2u, scheduler.in_flight(WritebackScheduler::kEncode));
+  scheduler.Release(WritebackScheduler::kEncode);
+  scheduler.Release(WritebackScheduler::kEncode);
+  EXPECT_THAT(log, ::testing::ElementsAre(0, 1, 100, 2, 3, 4));
+  EXPECT_EQ(0u, scheduler.queued(WritebackScheduler::kEncode));
+  scheduler.Release(WritebackScheduler::kEncode);
+  scheduler.Release(WritebackScheduler::kEncode);
+  EXPECT_EQ(0u, scheduler.in_flight(WritebackScheduler::kEncode));
+}
+
+TEST(WritebackSchedulerTest, Pipelined) {
+  // Each task holds its encode slot until it acquires an I/O slot.
+  WritebackScheduler scheduler(1, 1);
+  std::vector<int> log;
+  auto start = [&](int i) {
+    scheduler.Acquire(WritebackScheduler::kEncode, [&, i] {
+      log.push_back(i);
+      scheduler.Acquire(WritebackScheduler::kIo, [&, i] {
+        log.push_back(-i);
+        scheduler.Release(WritebackScheduler::kEncode);
+      });
+    });
+  };
+  start(1);
+  start(2);
+  start(3);
+  // Task 1 was encoded and is writing, task 2 was encoded and is waiting for
+  // an I/O slot, and task 3 is waiting for an encode slot.
+  EXPECT_THAT(log, ::testing::ElementsAre(1, -1, 2));
+  scheduler.Release(WritebackScheduler::kIo);
+  EXPECT_THAT(log, ::testing::ElementsAre(1, -1, 2, -2, 3));
+  scheduler.Release(WritebackScheduler::kIo);
+  EXPECT_THAT(log, ::testing::ElementsAre(1, -1, 2, -2, 3, -3));
+  scheduler.Release(WritebackScheduler::kIo);
+  EXPECT_EQ(0u, scheduler.in_flight(WritebackScheduler::kEncode));
+  EXPECT_EQ(0u, scheduler.in_flight(WritebackScheduler::kIo));
+}
+
+}  // namespace
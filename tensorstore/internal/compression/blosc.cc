@@ -14,14 +14,87 @@
 
 #include "tensorstore/internal/compression/blosc.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "absl/flags/marshalling.h"
 #include "absl/status/status.h"
 #include <blosc.h>
+#include "tensorstore/internal/env.h"
 #include "tensorstore/internal/flat_cord_builder.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/str_cat.h"
 
 namespace tensorstore {
 namespace blosc {
+namespace {
+
+/// Inputs are divided among threads only if each thread processes at least
+/// this many (uncompressed) bytes, since blosc starts new threads for each
+/// call.
+constexpr std::size_t kMinBytesPerThread = 1024 * 1024;
+
+/// Number of additional threads currently in use by `Encode` and `Decode`.
+std::atomic<int> additional_threads_in_use{0};
+
+/// Reserves threads from the process-wide budget for a single blosc call.
+class ThreadReservation {
+ public:
+  explicit ThreadReservation(int nthreads, std::size_t nbytes) {
+    const int additional_threads =
+        static_cast<int>(std::min<std::size_t>(nthreads,
+                                               nbytes / kMinBytesPerThread)) -
+        1;
+    if (additional_threads <= 0) return;
+    const int max_threads = GetMaxAdditionalThreads();
+    int in_use = additional_threads_in_use.load(std::memory_order_relaxed);
+    do {
+      reserved_ = std::min(additional_threads, max_threads - in_use);
+      if (reserved_ <= 0) {
+        reserved_ = 0;
+        return;
+      }
+    } while (!additional_threads_in_use.compare_exchange_weak(
+        in_use, in_use + reserved_, std::memory_order_relaxed));
+  }
+
+  ~ThreadReservation() {
+    if (reserved_) {
+      additional_threads_in_use.fetch_sub(reserved_,
+                                          std::memory_order_relaxed);
+    }
+  }
+
+  ThreadReservation(const ThreadReservation&) = delete;
+  ThreadReservation& operator=(const ThreadReservation&) = delete;
+
+  /// Number of threads to pass to blosc, including the calling thread.
+  int nthreads() const { return reserved_ + 1; }
+
+ private:
+  int reserved_ = 0;
+};
+
+}  // namespace
+
+int GetMaxAdditionalThreads() {
+  static const int max_threads = [] {
+    if (auto env = internal::GetEnv("TENSORSTORE_BLOSC_MAX_THREADS")) {
+      int limit;
+      std::string error;
+      if (absl::ParseFlag(*env, &limit, &error) && limit >= 0) {
+        return limit;
+      }
+    }
+    const int hardware_threads =
+        static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(0, std::min(kDefaultThreads, hardware_threads) - 1);
+  }();
+  return max_threads;
+}
 
 absl::Status Encode(const absl::Cord& input, absl::Cord* output,
                     const Options& options) {
@@ -38,11 +111,12 @@ absl::Status Encode(const absl::Cord& input, absl::Cord* output,
   if (shuffle == -1) {
     shuffle = options.element_size == 1 ? BLOSC_BITSHUFFLE : BLOSC_SHUFFLE;
   }
+  ThreadReservation threads(options.nthreads, input_flat.size());
   int n = blosc_compress_ctx(options.clevel, shuffle, options.element_size,
                              input_flat.size(), input_flat.data(),
                              output_buffer.data(), output_buffer.size(),
                              options.compressor, options.blocksize,
-                             /*numinternalthreads=*/1);
+                             /*numinternalthreads=*/threads.nthreads());
   if (n < 0) {
     return absl::InternalError(
         tensorstore::StrCat("Internal blosc error: ", n));
@@ -63,9 +137,10 @@ absl::Status Decode(const absl::Cord& input, absl::Cord* output) {
   }
   internal::FlatCordBuilder output_buffer(nbytes);
   if (nbytes == 0) return absl::OkStatus();
+  ThreadReservation threads(kDecodeThreads, nbytes);
   const int n =
       blosc_decompress_ctx(input_flat.data(), output_buffer.data(), nbytes,
-                           /*numinternalthreads=*/1);
+                           /*numinternalthreads=*/threads.nthreads());
   if (n <= 0) {
     return absl::InvalidArgumentError(tensorstore::StrCat("Blosc error: ", n));
   }
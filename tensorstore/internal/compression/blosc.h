@@ -27,6 +27,15 @@
 namespace tensorstore {
 namespace blosc {
 
+/// Default value of `Options::nthreads`.
+constexpr int kDefaultThreads = 4;
+
+/// Maximum number of threads used by `Decode`, including the calling thread.
+///
+/// The number of threads used to compress a buffer is not recorded in the
+/// compressed representation, so `Decode` uses a fixed limit.
+constexpr int kDecodeThreads = 4;
+
 /// Specifies the Blosc encode options.
 ///
 /// Refer to the blosc library `blosc_compress_ctx` function documentation for
@@ -56,8 +65,25 @@ struct Options {
   /// Specifies that `input` is a sequence of elements of `element_size` bytes.
   /// This only affects shuffling.
   std::size_t element_size;
+
+  /// Maximum number of threads used by `Encode`, including the calling
+  /// thread.  Fewer threads are used for small inputs, and when the
+  /// process-wide limit on additional blosc threads (see
+  /// `GetMaxAdditionalThreads`) is reached.  Does not affect `Decode`.
+  int nthreads = kDefaultThreads;
 };
 
+/// Returns the process-wide limit on the number of threads, in addition to the
+/// calling threads, used concurrently by `Encode` and `Decode`.
+///
+/// `Encode` and `Decode` are typically called from the `data_copy_concurrency`
+/// executor, which already uses one thread per hardware thread.  To limit
+/// oversubscription, the default is `kDefaultThreads - 1`, or one less than
+/// the number of hardware threads if that is smaller.  May be overridden by
+/// the `TENSORSTORE_BLOSC_MAX_THREADS` environment variable.  A value of `0`
+/// disables multi-threaded compression.
+int GetMaxAdditionalThreads();
+
 /// Compresses `input` and append the result to `*output`.
 ///
 /// \param input The input data to compress.
@@ -70,6 +96,9 @@ absl::Status Encode(const absl::Cord& input, absl::Cord* output,
 
 /// Decompresses `input` and append the result to `*output`.
 ///
+/// Uses up to `kDecodeThreads` threads, subject to the same process-wide limit
+/// as `Encode`.
+///
 /// \param input The input data to decompress.
 /// \param output[in,out] Output cord to which decompressed data will be
 ///     appended.
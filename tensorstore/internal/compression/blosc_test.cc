@@ -22,6 +22,7 @@
 #include "absl/strings/cord.h"
 #include "absl/strings/cord_test_helpers.h"
 #include <blosc.h>
+#include "tensorstore/internal/env.h"
 #include "tensorstore/internal/flat_cord_builder.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/status_testutil.h"
@@ -218,4 +219,35 @@ TEST(BloscCompressorTest, DecodeDataTruncated) {
               MatchesStatus(absl::StatusCode::kInvalidArgument));
 }
 
+// Tests that large inputs, which are divided among multiple threads, round
+// trip for any number of threads.
+TEST(BloscTest, EncodeDecodeMultiThreaded) {
+  std::string data(8 * 1024 * 1024, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>((i * 7) ^ (i >> 12));
+  }
+  const absl::Cord input(data);
+  for (const int nthreads : {1, 2, 4, 16}) {
+    SCOPED_TRACE(nthreads);
+    blosc::Options options{/*.compressor=*/"lz4", /*.clevel=*/5,
+                           /*.shuffle=*/-1, /*.blocksize=*/0,
+                           /*element_size=*/2};
+    options.nthreads = nthreads;
+    absl::Cord encode_result, decode_result;
+    TENSORSTORE_ASSERT_OK(blosc::Encode(input, &encode_result, options));
+    TENSORSTORE_ASSERT_OK(blosc::Decode(encode_result, &decode_result));
+    EXPECT_EQ(input, decode_result);
+  }
+}
+
+// Tests that, by default, the number of additional threads is bounded
+// independently of the number of hardware threads.
+TEST(BloscTest, DefaultMaxAdditionalThreads) {
+  if (tensorstore::internal::GetEnv("TENSORSTORE_BLOSC_MAX_THREADS")) {
+    GTEST_SKIP() << "TENSORSTORE_BLOSC_MAX_THREADS is set";
+  }
+  EXPECT_GE(blosc::GetMaxAdditionalThreads(), 0);
+  EXPECT_LE(blosc::GetMaxAdditionalThreads(), blosc::kDefaultThreads - 1);
+}
+
 }  // namespace
@@ -14,15 +14,32 @@
 
 #include "tensorstore/internal/compression/neuroglancer_compressed_segmentation.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <type_traits>
 
 #include "absl/base/internal/endian.h"
+#include "absl/base/optimization.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/notification.h"
+#include "tensorstore/util/executor.h"
 
 namespace tensorstore {
 namespace neuroglancer_compressed_segmentation {
 
 constexpr size_t kBlockHeaderSize = 2;
 
+/// Minimum number of blocks in a channel for which `EncodeChannel` splits the
+/// work across multiple tasks.
+constexpr size_t kMinBlocksForParallelEncoding = 64;
+
+/// Maximum number of additional tasks used by `EncodeChannel`.
+constexpr size_t kMaxParallelEncodingTasks = 8;
+
 void WriteBlockHeader(size_t encoded_value_base_offset,
                       size_t table_base_offset, size_t encoding_bits,
                       void* output) {
@@ -32,87 +49,221 @@ void WriteBlockHeader(size_t encoded_value_base_offset,
                                encoded_value_base_offset);
 }
 
-template <typename Label>
-void EncodeBlock(const Label* input, const std::ptrdiff_t input_shape[3],
-                 const std::ptrdiff_t input_byte_strides[3],
-                 const std::ptrdiff_t block_shape[3], size_t base_offset,
-                 size_t* encoded_bits_output, size_t* table_offset_output,
-                 EncodedValueCache<Label>* cache, std::string* output) {
-  if (input_shape[0] == 0 && input_shape[1] == 0 && input_shape[2] == 0) {
-    *encoded_bits_output = 0;
-    *table_offset_output = 0;
-    return;
+namespace {
+
+/// Calls `func(block_offset, label)` for each element of the input block, in C
+/// order, where `block_offset` is the position of the element within a block
+/// of shape `block_shape`.
+template <typename Label, typename Func>
+void ForEachBlockElement(const Label* input,
+                         const std::ptrdiff_t input_shape[3],
+                         const std::ptrdiff_t input_byte_strides[3],
+                         const std::ptrdiff_t block_shape[3], Func func) {
+  auto* input_z = reinterpret_cast<const char*>(input);
+  for (std::ptrdiff_t z = 0; z < input_shape[0]; ++z) {
+    auto* input_y = input_z;
+    for (std::ptrdiff_t y = 0; y < input_shape[1]; ++y) {
+      auto* input_x = input_y;
+      const size_t row_offset = block_shape[2] * (y + block_shape[1] * z);
+      for (std::ptrdiff_t x = 0; x < input_shape[2]; ++x) {
+        func(row_offset + x, *reinterpret_cast<const Label*>(input_x));
+        input_x += input_byte_strides[2];
+      }
+      input_y += input_byte_strides[1];
+    }
+    input_z += input_byte_strides[0];
   }
+}
 
-  constexpr size_t num_32bit_words_per_label = sizeof(Label) / 4;
+/// Returns the number of bits used to encode indices into a table of
+/// `num_values` labels.
+size_t GetEncodedBits(size_t num_values) {
+  size_t encoded_bits = 0;
+  if (num_values != 1) {
+    encoded_bits = 1;
+    while ((size_t(1) << encoded_bits) < num_values) {
+      encoded_bits *= 2;
+    }
+  }
+  return encoded_bits;
+}
 
-  // TODO(jbms): allow the memory allocated for these to be shared across
-  // multiple calls to EncodeBlock.
-  absl::flat_hash_map<Label, std::uint32_t> seen_values;
-  std::vector<Label> seen_values_inv;
-
-  // Calls `func(z, y, x, label)` for each `label` value within the block, in C
-  // order.
-  const auto ForEachElement = [&](auto func) {
-    auto* input_z = reinterpret_cast<const char*>(input);
-    for (std::ptrdiff_t z = 0; z < input_shape[0]; ++z) {
-      auto* input_y = input_z;
-      for (std::ptrdiff_t y = 0; y < input_shape[1]; ++y) {
-        auto* input_x = input_y;
-        for (std::ptrdiff_t x = 0; x < input_shape[2]; ++x) {
-          func(z, y, x, *reinterpret_cast<const Label*>(input_x));
-          input_x += input_byte_strides[2];
-        }
-        input_y += input_byte_strides[1];
-      }
-      input_z += input_byte_strides[0];
+size_t GetEncodedSize32Bits(size_t encoded_bits,
+                            const std::ptrdiff_t block_shape[3]) {
+  return (encoded_bits * block_shape[0] * block_shape[1] * block_shape[2] +
+          31) /
+         32;
+}
+
+/// Packs `num_words * (32 / Bits)` indices, each less than `2**Bits`, into
+/// `num_words` little endian 32-bit words.
+///
+/// The inner loop has a fixed trip count, which allows the compiler to
+/// vectorize it.
+template <size_t Bits>
+void PackIndices(const uint32_t* indices, size_t num_words, char* output) {
+  constexpr size_t kIndicesPerWord = 32 / Bits;
+  for (size_t word_i = 0; word_i < num_words; ++word_i) {
+    const uint32_t* word_indices = indices + word_i * kIndicesPerWord;
+    uint32_t word = 0;
+    for (size_t j = 0; j < kIndicesPerWord; ++j) {
+      word |= word_indices[j] << (j * Bits);
     }
-  };
+    absl::little_endian::Store32(output + word_i * 4, word);
+  }
+}
 
-  // First determine the distinct values.
+/// Invokes `func(std::integral_constant<size_t, Bits>{})` with `Bits` equal
+/// to `encoded_bits`, which must be one of 1, 2, 4, 8, 16, or 32.
+template <typename Func>
+void DispatchEncodedBits(size_t encoded_bits, Func func) {
+  switch (encoded_bits) {
+    case 1:
+      return func(std::integral_constant<size_t, 1>{});
+    case 2:
+      return func(std::integral_constant<size_t, 2>{});
+    case 4:
+      return func(std::integral_constant<size_t, 4>{});
+    case 8:
+      return func(std::integral_constant<size_t, 8>{});
+    case 16:
+      return func(std::integral_constant<size_t, 16>{});
+    case 32:
+      return func(std::integral_constant<size_t, 32>{});
+    default:
+      ABSL_UNREACHABLE();  // COV_NF_LINE
+  }
+}
+
+/// Scratch buffers used to encode a single block, which may be reused across
+/// blocks to avoid repeated allocation.
+template <typename Label>
+struct BlockEncodingBuffers {
+  /// Maps each distinct label to its index in `table`.
+  absl::flat_hash_map<Label, uint32_t> index_map;
+
+  /// Distinct labels in the block.  Sorted after `ComputeBlockIndices`.
+  std::vector<Label> table;
+
+  /// Index into `table` of each element of the block, in C order.  Positions
+  /// outside the input are set to 0, i.e. the lowest label.
+  std::vector<uint32_t> indices;
+
+  /// Temporary buffers used to sort `table`.
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> remap;
+  std::vector<Label> sorted_table;
+};
+
+/// Computes the sorted table of distinct labels in a block along with the
+/// index into the table of each element.
+///
+/// Each element requires at most one hash table lookup: the index assigned on
+/// first insertion is remapped to the sorted index afterwards.
+///
+/// \returns The number of bits with which to encode each index.
+template <typename Label>
+size_t ComputeBlockIndices(const Label* input,
+                           const std::ptrdiff_t input_shape[3],
+                           const std::ptrdiff_t input_byte_strides[3],
+                           const std::ptrdiff_t block_shape[3],
+                           BlockEncodingBuffers<Label>& buffers) {
+  auto& table = buffers.table;
+  auto& indices = buffers.indices;
+  buffers.index_map.clear();
+  table.clear();
+  indices.assign(block_shape[0] * block_shape[1] * block_shape[2], 0);
 
   // Initialize previous_value such that it is guaranteed not to equal to the
   // first value.
   Label previous_value = input[0] + 1;
-  ForEachElement([&](size_t z, size_t y, size_t x, Label value) {
-    // If this value matches the previous value, we can skip the more
-    // expensive hash table lookup.
-    if (value != previous_value) {
-      previous_value = value;
-      if (seen_values.emplace(value, 0).second) {
-        seen_values_inv.push_back(value);
-      }
+  uint32_t previous_index = 0;
+  ForEachBlockElement(
+      input, input_shape, input_byte_strides, block_shape,
+      [&](size_t block_offset, Label value) {
+        // If this value matches the previous value, we can skip the more
+        // expensive hash table lookup.
+        if (value != previous_value) {
+          previous_value = value;
+          auto [it, inserted] = buffers.index_map.try_emplace(
+              value, static_cast<uint32_t>(table.size()));
+          if (inserted) table.push_back(value);
+          previous_index = it->second;
+        }
+        indices[block_offset] = previous_index;
+      });
+
+  const size_t num_values = table.size();
+  if (!std::is_sorted(table.begin(), table.end())) {
+    auto& order = buffers.order;
+    auto& remap = buffers.remap;
+    auto& sorted_table = buffers.sorted_table;
+    order.resize(num_values);
+    std::iota(order.begin(), order.end(), uint32_t(0));
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return table[a] < table[b]; });
+    remap.resize(num_values);
+    sorted_table.resize(num_values);
+    for (size_t i = 0; i < num_values; ++i) {
+      remap[order[i]] = static_cast<uint32_t>(i);
+      sorted_table[i] = table[order[i]];
+    }
+    std::swap(table, sorted_table);
+    if (input_shape[0] == block_shape[0] && input_shape[1] == block_shape[1] &&
+        input_shape[2] == block_shape[2]) {
+      for (auto& index : indices) index = remap[index];
+    } else {
+      // Only remap positions within the input; padding positions must remain
+      // 0.
+      ForEachBlockElement(
+          input, input_shape, input_byte_strides, block_shape,
+          [&](size_t block_offset, Label value) {
+            indices[block_offset] = remap[indices[block_offset]];
+          });
     }
-  });
-
-  std::sort(seen_values_inv.begin(), seen_values_inv.end());
-  for (size_t i = 0; i < seen_values_inv.size(); ++i) {
-    seen_values[seen_values_inv[i]] = static_cast<uint32_t>(i);
   }
 
-  // Determine number of bits with which to encode each index.
-  size_t encoded_bits = 0;
-  if (seen_values.size() != 1) {
-    encoded_bits = 1;
-    while ((size_t(1) << encoded_bits) < seen_values.size()) {
-      encoded_bits *= 2;
-    }
+  const size_t encoded_bits = GetEncodedBits(num_values);
+  if (encoded_bits != 0) {
+    // Pad to a whole number of 32-bit words.
+    indices.resize(GetEncodedSize32Bits(encoded_bits, block_shape) *
+                   (32 / encoded_bits));
   }
-  *encoded_bits_output = encoded_bits;
-  const size_t encoded_size_32bits =
-      (encoded_bits * block_shape[0] * block_shape[1] * block_shape[2] + 31) /
-      32;
+  return encoded_bits;
+}
 
+/// Packs the indices computed by `ComputeBlockIndices` into `output`, which
+/// must have space for `GetEncodedSize32Bits(encoded_bits, block_shape)`
+/// words.
+void PackBlockIndices(size_t encoded_bits, const std::vector<uint32_t>& indices,
+                      char* output) {
+  if (encoded_bits == 0) return;
+  DispatchEncodedBits(encoded_bits, [&](auto bits) {
+    constexpr size_t kBits = decltype(bits)::value;
+    PackIndices<kBits>(indices.data(), indices.size() / (32 / kBits), output);
+  });
+}
+
+/// Appends the encoded values and, if not already present in `cache`, the
+/// value table of a block to `output`.
+///
+/// \returns Pointer to the location in `output` at which the
+///     `encoded_size_32bits` words of encoded values are to be written.
+template <typename Label>
+char* AppendBlock(size_t encoded_size_32bits, const std::vector<Label>& table,
+                  size_t base_offset, size_t* table_offset_output,
+                  EncodedValueCache<Label>* cache, std::string* output) {
+  constexpr size_t num_32bit_words_per_label = sizeof(Label) / 4;
   const size_t encoded_value_base_offset = output->size();
   assert((encoded_value_base_offset - base_offset) % 4 == 0);
   size_t elements_to_write = encoded_size_32bits;
 
   bool write_table;
   {
-    auto it = cache->find(seen_values_inv);
+    auto it = cache->find(table);
     if (it == cache->end()) {
       write_table = true;
-      elements_to_write += seen_values.size() * num_32bit_words_per_label;
+      elements_to_write += table.size() * num_32bit_words_per_label;
       *table_offset_output =
           (encoded_value_base_offset - base_offset) / 4 + encoded_size_32bits;
     } else {
@@ -123,78 +274,213 @@ void EncodeBlock(const Label* input, const std::ptrdiff_t input_shape[3],
 
   output->resize(encoded_value_base_offset + elements_to_write * 4);
   char* output_ptr = output->data() + encoded_value_base_offset;
-  // Write encoded representation.
-  ForEachElement([&](size_t z, size_t y, size_t x, Label value) {
-    uint32_t index = seen_values.at(value);
-    size_t output_offset = x + block_shape[2] * (y + block_shape[1] * z);
-    void* cur_ptr = output_ptr + output_offset * encoded_bits / 32 * 4;
-    absl::little_endian::Store32(
-        cur_ptr, absl::little_endian::Load32(cur_ptr) |
-                     (index << (output_offset * encoded_bits % 32)));
-  });
 
   // Write table
   if (write_table) {
-    output_ptr =
-        output->data() + encoded_value_base_offset + encoded_size_32bits * 4;
-    for (auto value : seen_values_inv) {
+    char* table_ptr = output_ptr + encoded_size_32bits * 4;
+    for (auto value : table) {
       for (size_t word_i = 0; word_i < num_32bit_words_per_label; ++word_i) {
         absl::little_endian::Store32(
-            output_ptr + word_i * 4,
+            table_ptr + word_i * 4,
             static_cast<uint32_t>(value >> (32 * word_i)));
       }
-      output_ptr += num_32bit_words_per_label * 4;
+      table_ptr += num_32bit_words_per_label * 4;
     }
-    cache->emplace(seen_values_inv,
-                   static_cast<std::uint32_t>(*table_offset_output));
+    cache->emplace(table, static_cast<std::uint32_t>(*table_offset_output));
   }
+  return output_ptr;
+}
+
+/// Block encoded independently of the output, used for parallel encoding.
+template <typename Label>
+struct EncodedBlock {
+  size_t encoded_bits = 0;
+  std::vector<Label> table;
+  std::string encoded_values;
+};
+
+/// Shared state of `ParallelFor`.
+struct ParallelForState {
+  explicit ParallelForState(size_t n) : n(n), remaining(n) {}
+
+  /// Runs work items until none remain to be claimed.
+  void Run(absl::FunctionRef<void(size_t)> func) {
+    size_t i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < n) {
+      func(i);
+      if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done.Notify();
+      }
+    }
+  }
+
+  const size_t n;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> remaining;
+  absl::Notification done;
+};
+
+/// Invokes `func(i)` for `0 <= i < n` using the calling thread along with up
+/// to `num_tasks` tasks submitted to `executor`.
+///
+/// The calling thread participates in the work and only waits for items
+/// claimed by other tasks, so this does not deadlock even if `executor` has no
+/// available threads.
+void ParallelFor(const Executor& executor, size_t n, size_t num_tasks,
+                 absl::FunctionRef<void(size_t)> func) {
+  auto state = std::make_shared<ParallelForState>(n);
+  // Tasks that start after all work items have been claimed return without
+  // invoking `func`, which may then no longer be valid.
+  for (size_t task_i = 0; task_i < num_tasks; ++task_i) {
+    executor([state, func] { state->Run(func); });
+  }
+  state->Run(func);
+  state->done.WaitForNotification();
+}
+
+/// Same as `EncodeBlock`, but uses the specified scratch buffers.
+template <typename Label>
+void EncodeBlockWithBuffers(const Label* input,
+                            const std::ptrdiff_t input_shape[3],
+                            const std::ptrdiff_t input_byte_strides[3],
+                            const std::ptrdiff_t block_shape[3],
+                            size_t base_offset, size_t* encoded_bits_output,
+                            size_t* table_offset_output,
+                            EncodedValueCache<Label>* cache,
+                            std::string* output,
+                            BlockEncodingBuffers<Label>& buffers) {
+  if (input_shape[0] == 0 && input_shape[1] == 0 && input_shape[2] == 0) {
+    *encoded_bits_output = 0;
+    *table_offset_output = 0;
+    return;
+  }
+  const size_t encoded_bits = ComputeBlockIndices(
+      input, input_shape, input_byte_strides, block_shape, buffers);
+  *encoded_bits_output = encoded_bits;
+  char* encoded_values = AppendBlock(
+      GetEncodedSize32Bits(encoded_bits, block_shape), buffers.table,
+      base_offset, table_offset_output, cache, output);
+  PackBlockIndices(encoded_bits, buffers.indices, encoded_values);
+}
+
+}  // namespace
+
+template <typename Label>
+void EncodeBlock(const Label* input, const std::ptrdiff_t input_shape[3],
+                 const std::ptrdiff_t input_byte_strides[3],
+                 const std::ptrdiff_t block_shape[3], size_t base_offset,
+                 size_t* encoded_bits_output, size_t* table_offset_output,
+                 EncodedValueCache<Label>* cache, std::string* output) {
+  BlockEncodingBuffers<Label> buffers;
+  EncodeBlockWithBuffers(input, input_shape, input_byte_strides, block_shape,
+                         base_offset, encoded_bits_output, table_offset_output,
+                         cache, output, buffers);
 }
 
 template <class Label>
 void EncodeChannel(const Label* input, const std::ptrdiff_t input_shape[3],
                    const std::ptrdiff_t input_byte_strides[3],
-                   const std::ptrdiff_t block_shape[3], std::string* output) {
+                   const std::ptrdiff_t block_shape[3], std::string* output,
+                   const Executor& executor) {
   EncodedValueCache<Label> cache;
   const size_t base_offset = output->size();
   ptrdiff_t grid_shape[3];
-  size_t block_index_size = kBlockHeaderSize;
+  size_t num_blocks = 1;
   for (size_t i = 0; i < 3; ++i) {
     grid_shape[i] = (input_shape[i] + block_shape[i] - 1) / block_shape[i];
-    block_index_size *= grid_shape[i];
+    num_blocks *= grid_shape[i];
   }
-  output->resize(base_offset + block_index_size * 4);
-  ptrdiff_t block[3];
-  for (block[0] = 0; block[0] < grid_shape[0]; ++block[0]) {
-    for (block[1] = 0; block[1] < grid_shape[1]; ++block[1]) {
-      for (block[2] = 0; block[2] < grid_shape[2]; ++block[2]) {
-        const size_t block_offset =
-            block[2] + grid_shape[2] * (block[1] + grid_shape[1] * block[0]);
-        ptrdiff_t input_block_shape[3];
-        ptrdiff_t input_offset = 0;
-        for (size_t i = 0; i < 3; ++i) {
-          auto pos = block[i] * block_shape[i];
-          input_block_shape[i] = std::min(block_shape[i], input_shape[i] - pos);
-          input_offset += pos * input_byte_strides[i];
-        }
-        const size_t encoded_value_base_offset =
-            (output->size() - base_offset) / 4;
-        size_t encoded_bits, table_offset;
-        EncodeBlock(reinterpret_cast<const Label*>(
-                        reinterpret_cast<const char*>(input) + input_offset),
-                    input_block_shape, input_byte_strides, block_shape,
-                    base_offset, &encoded_bits, &table_offset, &cache, output);
-        WriteBlockHeader(
-            encoded_value_base_offset, table_offset, encoded_bits,
-            output->data() + base_offset + block_offset * kBlockHeaderSize * 4);
-      }
+  output->resize(base_offset + num_blocks * kBlockHeaderSize * 4);
+
+  // Computes the input pointer and shape of the block with the specified
+  // offset.
+  const auto get_input_block = [&](size_t block_offset,
+                                   ptrdiff_t input_block_shape[3]) {
+    ptrdiff_t block[3];
+    block[2] = block_offset % grid_shape[2];
+    block[1] = block_offset / grid_shape[2] % grid_shape[1];
+    block[0] = block_offset / grid_shape[2] / grid_shape[1];
+    ptrdiff_t input_offset = 0;
+    for (size_t i = 0; i < 3; ++i) {
+      auto pos = block[i] * block_shape[i];
+      input_block_shape[i] = std::min(block_shape[i], input_shape[i] - pos);
+      input_offset += pos * input_byte_strides[i];
     }
+    return reinterpret_cast<const Label*>(
+        reinterpret_cast<const char*>(input) + input_offset);
+  };
+
+  const auto write_block_header = [&](size_t block_offset,
+                                      size_t encoded_value_base_offset,
+                                      size_t table_offset,
+                                      size_t encoded_bits) {
+    WriteBlockHeader(
+        encoded_value_base_offset, table_offset, encoded_bits,
+        output->data() + base_offset + block_offset * kBlockHeaderSize * 4);
+  };
+
+  if (executor && num_blocks >= kMinBlocksForParallelEncoding) {
+    // Compute the table and encoded values of each block in parallel, then
+    // assemble them in order.  Because table sharing is determined during
+    // assembly, the output is identical to the sequential encoding.
+    std::vector<EncodedBlock<Label>> encoded_blocks(num_blocks);
+    const size_t num_tasks =
+        std::min(num_blocks / kMinBlocksForParallelEncoding,
+                 kMaxParallelEncodingTasks);
+    ParallelFor(executor, num_blocks, num_tasks, [&](size_t block_offset) {
+      thread_local BlockEncodingBuffers<Label> buffers;
+      ptrdiff_t input_block_shape[3];
+      const Label* block_input =
+          get_input_block(block_offset, input_block_shape);
+      auto& encoded_block = encoded_blocks[block_offset];
+      const size_t encoded_bits =
+          ComputeBlockIndices(block_input, input_block_shape,
+                              input_byte_strides, block_shape, buffers);
+      encoded_block.encoded_bits = encoded_bits;
+      encoded_block.table = buffers.table;
+      encoded_block.encoded_values.resize(
+          GetEncodedSize32Bits(encoded_bits, block_shape) * 4);
+      PackBlockIndices(encoded_bits, buffers.indices,
+                       encoded_block.encoded_values.data());
+    });
+    for (size_t block_offset = 0; block_offset < num_blocks; ++block_offset) {
+      auto& encoded_block = encoded_blocks[block_offset];
+      const size_t encoded_value_base_offset =
+          (output->size() - base_offset) / 4;
+      size_t table_offset;
+      char* encoded_values =
+          AppendBlock(encoded_block.encoded_values.size() / 4,
+                      encoded_block.table, base_offset, &table_offset, &cache,
+                      output);
+      std::memcpy(encoded_values, encoded_block.encoded_values.data(),
+                  encoded_block.encoded_values.size());
+      write_block_header(block_offset, encoded_value_base_offset, table_offset,
+                         encoded_block.encoded_bits);
+      encoded_block = {};
+    }
+    return;
+  }
+
+  BlockEncodingBuffers<Label> buffers;
+  for (size_t block_offset = 0; block_offset < num_blocks; ++block_offset) {
+    ptrdiff_t input_block_shape[3];
+    const Label* block_input = get_input_block(block_offset, input_block_shape);
+    const size_t encoded_value_base_offset =
+        (output->size() - base_offset) / 4;
+    size_t encoded_bits, table_offset;
+    EncodeBlockWithBuffers(block_input, input_block_shape, input_byte_strides,
+                           block_shape, base_offset, &encoded_bits,
+                           &table_offset, &cache, output, buffers);
+    write_block_header(block_offset, encoded_value_base_offset, table_offset,
+                       encoded_bits);
   }
 }
 
 template <class Label>
 void EncodeChannels(const Label* input, const std::ptrdiff_t input_shape[3 + 1],
                     const std::ptrdiff_t input_byte_strides[3 + 1],
-                    const std::ptrdiff_t block_shape[3], std::string* output) {
+                    const std::ptrdiff_t block_shape[3], std::string* output,
+                    const Executor& executor) {
   const size_t base_offset = output->size();
   output->resize(base_offset + input_shape[0] * 4);
   for (std::ptrdiff_t channel_i = 0; channel_i < input_shape[0]; ++channel_i) {
@@ -203,7 +489,7 @@ void EncodeChannels(const Label* input, const std::ptrdiff_t input_shape[3 + 1],
     EncodeChannel(
         reinterpret_cast<const Label*>(reinterpret_cast<const char*>(input) +
                                        input_byte_strides[0] * channel_i),
-        input_shape + 1, input_byte_strides + 1, block_shape, output);
+        input_shape + 1, input_byte_strides + 1, block_shape, output, executor);
   }
 }
 
@@ -215,29 +501,65 @@ void ReadBlockHeader(const void* header, size_t* encoded_value_base_offset,
   *encoded_value_base_offset = (h >> 32) & 0xffffff;
 }
 
+namespace {
+
+/// Decodes the indices of a block encoded with `Bits` bits per index.
+///
+/// Specializing on `Bits` allows the index extraction to use constant shifts
+/// and masks.
+///
+/// \param check_bounds If `false`, every `Bits`-bit index is known to be
+///     within the table.
+template <size_t Bits, typename Label, typename ForEachPosition,
+          typename ReadLabel>
+bool DecodeBlockIndices(const char* encoded_input, size_t table_size,
+                        bool check_bounds,
+                        ForEachPosition for_each_position,
+                        ReadLabel read_label) {
+  constexpr uint32_t kMask =
+      Bits == 32 ? ~uint32_t(0) : (uint32_t(1) << (Bits % 32)) - 1;
+  const auto get_index = [&](size_t block_offset) -> uint32_t {
+    return (absl::little_endian::Load32(encoded_input +
+                                        block_offset * Bits / 32 * 4) >>
+            (block_offset * Bits % 32)) &
+           kMask;
+  };
+  if (!check_bounds) {
+    return for_each_position([&](Label& output_label, size_t block_offset) {
+      output_label = read_label(get_index(block_offset));
+      return true;
+    });
+  }
+  return for_each_position([&](Label& output_label, size_t block_offset) {
+    const uint32_t index = get_index(block_offset);
+    if (index >= table_size) return false;
+    output_label = read_label(index);
+    return true;
+  });
+}
+
+}  // namespace
+
 template <typename Label>
 bool DecodeBlock(size_t encoded_bits, const char* encoded_input,
                  const char* table_input, size_t table_size,
                  const std::ptrdiff_t block_shape[3],
                  const std::ptrdiff_t output_shape[3],
                  const std::ptrdiff_t output_byte_strides[3], Label* output) {
-  // TODO(jbms): Consider specializing this function for the value of
-  // `encoded_bits` and whether `table_size` is `< 2**encoded_bits`.  If
-  // `table_size >= 2**encoded_bits`, there is no need to check below that
-  // `index <= table_size`.
-
-  // Invokes `callback(label, z, y, x)` for each block position in C order.  If
-  // `callback` returns `false`, stops iterating and returns `false`.  Otherwise
-  // returns `true` when done.
+  // Invokes `callback(label, block_offset)` for each block position in C
+  // order, where `block_offset` is the position within a block of shape
+  // `block_shape`.  If `callback` returns `false`, stops iterating and returns
+  // `false`.  Otherwise returns `true` when done.
   const auto for_each_position = [&](auto callback) {
     auto* output_z = reinterpret_cast<char*>(output);
     for (std::ptrdiff_t z = 0; z < output_shape[0]; ++z) {
       auto* output_y = output_z;
       for (std::ptrdiff_t y = 0; y < output_shape[1]; ++y) {
         auto* output_x = output_y;
+        const size_t row_offset = block_shape[2] * (y + block_shape[1] * z);
         for (std::ptrdiff_t x = 0; x < output_shape[2]; ++x) {
           auto& label = *reinterpret_cast<Label*>(output_x);
-          if (!callback(label, z, y, x)) return false;
+          if (!callback(label, row_offset + x)) return false;
           output_x += output_byte_strides[2];
         }
         output_y += output_byte_strides[1];
@@ -260,27 +582,22 @@ bool DecodeBlock(size_t encoded_bits, const char* encoded_input,
     // There are no encoded indices to read.
     if (table_size == 0) return false;
     const Label label = read_label(0);
-    return for_each_position(
-        [&](Label& output_label, ptrdiff_t z, ptrdiff_t y, ptrdiff_t x) {
-          output_label = label;
-          return true;
-        });
+    return for_each_position([&](Label& output_label, size_t block_offset) {
+      output_label = label;
+      return true;
+    });
   }
 
-  const std::uint32_t encoded_value_mask =
-      (std::uint32_t(1) << encoded_bits) - 1;
-  return for_each_position([&](Label& output_label, ptrdiff_t z, ptrdiff_t y,
-                               ptrdiff_t x) {
-    size_t encoded_offset = x + block_shape[2] * (y + block_shape[1] * z);
-    auto index = absl::little_endian::Load32(
-                     encoded_input + encoded_offset * encoded_bits / 32 * 4) >>
-                     (encoded_offset * encoded_bits % 32) &
-                 encoded_value_mask;
-    if (index >= table_size) return false;
-    output_label = read_label(index);
-    return true;
+  // If `table_size >= 2**encoded_bits`, every index is within the table.
+  const bool check_bounds =
+      encoded_bits >= 32 || table_size < (size_t(1) << encoded_bits);
+  bool success;
+  DispatchEncodedBits(encoded_bits, [&](auto bits) {
+    success = DecodeBlockIndices<decltype(bits)::value, Label>(
+        encoded_input, table_size, check_bounds, for_each_position,
+        read_label);
   });
-  return true;
+  return success;
 }
 
 template <typename Label>
@@ -390,11 +707,13 @@ bool DecodeChannels(std::string_view input, const std::ptrdiff_t block_shape[3],
   template void EncodeChannel<Label>(                                          \
       const Label* input, const std::ptrdiff_t input_shape[3],                 \
       const std::ptrdiff_t input_byte_strides[3],                              \
-      const std::ptrdiff_t block_shape[3], std::string* output);               \
+      const std::ptrdiff_t block_shape[3], std::string* output,                \
+      const Executor& executor);                                               \
   template void EncodeChannels<Label>(                                         \
       const Label* input, const std::ptrdiff_t input_shape[3 + 1],             \
       const std::ptrdiff_t input_byte_strides[3 + 1],                          \
-      const std::ptrdiff_t block_shape[3], std::string* output);               \
+      const std::ptrdiff_t block_shape[3], std::string* output,                \
+      const Executor& executor);                                               \
   template bool DecodeBlock(                                                   \
       size_t encoded_bits, const char* encoded_input, const char* table_input, \
       size_t table_size, const std::ptrdiff_t block_shape[3],                  \
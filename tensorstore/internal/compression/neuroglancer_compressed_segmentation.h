@@ -63,6 +63,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorstore/util/executor.h"
 
 namespace tensorstore {
 namespace neuroglancer_compressed_segmentation {
@@ -107,10 +108,15 @@ void EncodeBlock(const Label* input, const std::ptrdiff_t input_shape[3],
 ///     along each dimension of the input array.
 /// \param block_shape Block shape to use for encoding.
 /// \param output[out] String to which encoded output will be appended.
+/// \param executor If non-null, used to encode blocks in parallel when the
+///     channel contains sufficiently many blocks.  The calling thread also
+///     performs encoding work, so it is safe to call this function from a task
+///     running on `executor`.  The output does not depend on `executor`.
 template <typename Label>
 void EncodeChannel(const Label* input, const std::ptrdiff_t input_shape[3],
                    const std::ptrdiff_t input_byte_strides[3],
-                   const std::ptrdiff_t block_shape[3], std::string* output);
+                   const std::ptrdiff_t block_shape[3], std::string* output,
+                   const Executor& executor = {});
 
 /// Encodes multiple channels.
 ///
@@ -128,10 +134,13 @@ void EncodeChannel(const Label* input, const std::ptrdiff_t input_shape[3],
 ///     along each dimension of the input array.
 /// \param block_shape Block shape to use for encoding.
 /// \param output[out] String to which encoded output will be appended.
+/// \param executor If non-null, used to encode blocks in parallel, as for
+///     `EncodeChannel`.
 template <typename Label>
 void EncodeChannels(const Label* input, const std::ptrdiff_t input_shape[3 + 1],
                     const std::ptrdiff_t input_byte_strides[3 + 1],
-                    const std::ptrdiff_t block_shape[3], std::string* output);
+                    const std::ptrdiff_t block_shape[3], std::string* output,
+                    const Executor& executor = {});
 
 /// Decodes a single block.
 ///
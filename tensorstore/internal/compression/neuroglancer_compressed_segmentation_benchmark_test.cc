@@ -0,0 +1,135 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include "absl/random/random.h"
+#include "tensorstore/internal/compression/neuroglancer_compressed_segmentation.h"
+#include "tensorstore/internal/thread_pool.h"
+
+namespace {
+
+using ::tensorstore::neuroglancer_compressed_segmentation::DecodeChannels;
+using ::tensorstore::neuroglancer_compressed_segmentation::EncodeChannels;
+
+/// Size of each dimension of the encoded single-channel volume.
+constexpr std::ptrdiff_t kVolumeSize = 128;
+
+/// Returns a label volume in which each block of `block_size` consists of
+/// `num_labels` labels, each occupying a contiguous run of elements, which
+/// approximates the spatial coherence of real segmentations.
+template <typename Label>
+std::vector<Label> MakeLabels(std::ptrdiff_t block_size, size_t num_labels) {
+  absl::BitGen gen;
+  std::vector<Label> labels(kVolumeSize * kVolumeSize * kVolumeSize);
+  const size_t run_length =
+      std::max<size_t>(1, block_size * block_size * block_size / num_labels);
+  Label label = 0;
+  for (size_t i = 0; i < labels.size(); ++i) {
+    if (i % run_length == 0) label = absl::Uniform<Label>(gen);
+    labels[i] = label;
+  }
+  return labels;
+}
+
+struct BenchmarkInput {
+  std::ptrdiff_t shape[4] = {1, kVolumeSize, kVolumeSize, kVolumeSize};
+  std::ptrdiff_t block_shape[3];
+  std::ptrdiff_t byte_strides[4];
+};
+
+/// Arguments are the block size and the number of distinct labels per block.
+template <typename Label>
+BenchmarkInput GetBenchmarkInput(::benchmark::State& state) {
+  BenchmarkInput input;
+  const std::ptrdiff_t block_size = state.range(0);
+  for (auto& size : input.block_shape) size = block_size;
+  constexpr std::ptrdiff_t s = sizeof(Label);
+  input.byte_strides[3] = s;
+  for (int i = 2; i >= 0; --i) {
+    input.byte_strides[i] = input.byte_strides[i + 1] * input.shape[i + 1];
+  }
+  return input;
+}
+
+template <typename Label>
+void BM_Encode(::benchmark::State& state, bool parallel) {
+  auto input = GetBenchmarkInput<Label>(state);
+  auto labels = MakeLabels<Label>(state.range(0), state.range(1));
+  tensorstore::Executor executor;
+  if (parallel) executor = tensorstore::internal::DetachedThreadPool(8);
+  for (auto _ : state) {
+    std::string output;
+    EncodeChannels(labels.data(), input.shape, input.byte_strides,
+                   input.block_shape, &output, executor);
+    ::benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(state.iterations() * labels.size() * sizeof(Label));
+}
+
+template <typename Label>
+void BM_Decode(::benchmark::State& state) {
+  auto input = GetBenchmarkInput<Label>(state);
+  auto labels = MakeLabels<Label>(state.range(0), state.range(1));
+  std::string encoded;
+  EncodeChannels(labels.data(), input.shape, input.byte_strides,
+                 input.block_shape, &encoded);
+  std::vector<Label> output(labels.size());
+  for (auto _ : state) {
+    if (!DecodeChannels(encoded, input.block_shape, input.shape,
+                        input.byte_strides, output.data())) {
+      state.SkipWithError("decoding failed");
+    }
+    ::benchmark::DoNotOptimize(output.data());
+    ::benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * labels.size() * sizeof(Label));
+}
+
+void EncodingArgs(::benchmark::internal::Benchmark* b) {
+  for (int64_t block_size : {8, 64}) {
+    for (int64_t num_labels : {1, 3, 16, 200}) {
+      b->Args({block_size, num_labels});
+    }
+  }
+}
+
+template <typename Label>
+void BM_EncodeSequential(::benchmark::State& state) {
+  BM_Encode<Label>(state, /*parallel=*/false);
+}
+
+template <typename Label>
+void BM_EncodeParallel(::benchmark::State& state) {
+  BM_Encode<Label>(state, /*parallel=*/true);
+}
+
+BENCHMARK_TEMPLATE(BM_EncodeSequential, uint32_t)->Apply(EncodingArgs);
+BENCHMARK_TEMPLATE(BM_EncodeSequential, uint64_t)->Apply(EncodingArgs);
+BENCHMARK_TEMPLATE(BM_EncodeParallel, uint32_t)
+    ->Apply(EncodingArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_EncodeParallel, uint64_t)
+    ->Apply(EncodingArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Decode, uint32_t)->Apply(EncodingArgs);
+BENCHMARK_TEMPLATE(BM_Decode, uint64_t)->Apply(EncodingArgs);
+
+}  // namespace
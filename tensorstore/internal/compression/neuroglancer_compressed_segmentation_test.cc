@@ -17,6 +17,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/random/random.h"
+#include "tensorstore/internal/thread_pool.h"
 
 namespace {
 
@@ -444,4 +445,43 @@ TEST(RoundTripTest, Random) {
                                /*num_iterations=*/100);
 }
 
+template <typename T>
+void TestParallelEncodingMatchesSequential(size_t max_distinct_ids) {
+  absl::BitGen gen;
+  const std::ptrdiff_t block_shape[3] = {8, 8, 8};
+  const std::ptrdiff_t input_shape[4] = {2, 61, 64, 67};
+  std::vector<T> input(input_shape[0] * input_shape[1] * input_shape[2] *
+                       input_shape[3]);
+  std::vector<T> labels(max_distinct_ids);
+  for (auto& label : labels) {
+    label = absl::Uniform<T>(gen);
+  }
+  for (auto& label : input) {
+    label = labels[absl::Uniform(gen, 0u, labels.size())];
+  }
+  constexpr std::ptrdiff_t s = sizeof(T);
+  const std::ptrdiff_t input_byte_strides[4] = {
+      input_shape[1] * input_shape[2] * input_shape[3] * s,
+      input_shape[2] * input_shape[3] * s, input_shape[3] * s, s};
+  std::string sequential_output;
+  EncodeChannels(input.data(), input_shape, input_byte_strides, block_shape,
+                 &sequential_output);
+  std::string parallel_output;
+  EncodeChannels(input.data(), input_shape, input_byte_strides, block_shape,
+                 &parallel_output,
+                 tensorstore::internal::DetachedThreadPool(4));
+  EXPECT_EQ(sequential_output, parallel_output);
+  std::vector<T> decoded_output(input.size());
+  EXPECT_TRUE(DecodeChannels(parallel_output, block_shape, input_shape,
+                             input_byte_strides, decoded_output.data()));
+  EXPECT_EQ(input, decoded_output);
+}
+
+TEST(EncodeChannelsTest, ParallelMatchesSequential) {
+  for (size_t max_distinct_ids : {1, 2, 5, 100, 100000}) {
+    TestParallelEncodingMatchesSequential<std::uint32_t>(max_distinct_ids);
+    TestParallelEncodingMatchesSequential<std::uint64_t>(max_distinct_ids);
+  }
+}
+
 }  // namespace
@@ -28,6 +28,7 @@ std::unique_ptr<riegeli::Writer> ZstdCompressor::GetWriter(
   using Writer = riegeli::ZstdWriter<std::unique_ptr<riegeli::Writer>>;
   Writer::Options options;
   options.set_compression_level(level);
+  options.set_store_checksum(checksum);
   return std::make_unique<Writer>(std::move(base_writer), options);
 }
 
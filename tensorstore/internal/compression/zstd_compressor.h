@@ -28,6 +28,8 @@ namespace internal {
 
 struct ZstdOptions {
   int level = 0;
+  /// Specifies whether to store a checksum of the uncompressed data.
+  bool checksum = false;
 };
 
 class ZstdCompressor : public JsonSpecifiedCompressor, public ZstdOptions {
@@ -23,6 +23,7 @@
 #include "tensorstore/internal/elementwise_function.h"
 #include "tensorstore/internal/riegeli_json_input.h"
 #include "tensorstore/internal/riegeli_json_output.h"
+#include "tensorstore/internal/swap_endian.h"
 #include "tensorstore/serialization/riegeli_delimited.h"
 #include "tensorstore/util/endian.h"
 #include "tensorstore/util/status.h"
@@ -53,8 +54,13 @@ struct SwapEndianUnalignedInplaceLoopTemplate {
         std::array<unsigned char, SubElementSize * NumSubElements>;
     static_assert(sizeof(UnalignedValue) == SubElementSize * NumSubElements);
     static_assert(alignof(UnalignedValue) == 1);
-    // TODO(jbms): check if this loop gets auto-vectorized properly, and if not,
-    // consider manually creating a vectorized implementation.
+    if constexpr (SubElementSize != 1 && ArrayAccessor::buffer_kind ==
+                                             IterationBufferKind::kContiguous) {
+      // Contiguous sub-elements are swapped using vectorized instructions.
+      SwapEndianUnalignedContiguous<SubElementSize>(
+          pointer.pointer.get(), pointer.pointer.get(), count * NumSubElements);
+      return count;
+    }
     for (Index i = 0; i < count; ++i) {
       SwapEndianUnalignedInplace<SubElementSize, NumSubElements>(
           ArrayAccessor::template GetPointerAtOffset<UnalignedValue>(pointer,
@@ -100,8 +106,13 @@ struct SwapEndianUnalignedLoopTemplate {
         std::array<unsigned char, SubElementSize * NumSubElements>;
     static_assert(sizeof(UnalignedValue) == SubElementSize * NumSubElements);
     static_assert(alignof(UnalignedValue) == 1);
-    // TODO(jbms): check if this loop gets auto-vectorized properly, and if not,
-    // consider manually creating a vectorized implementation.
+    if constexpr (SubElementSize != 1 && ArrayAccessor::buffer_kind ==
+                                             IterationBufferKind::kContiguous) {
+      // Contiguous sub-elements are swapped using vectorized instructions.
+      SwapEndianUnalignedContiguous<SubElementSize>(
+          source.pointer.get(), dest.pointer.get(), count * NumSubElements);
+      return count;
+    }
     for (Index i = 0; i < count; ++i) {
       SwapEndianUnaligned<SubElementSize, NumSubElements>(
           ArrayAccessor::template GetPointerAtOffset<UnalignedValue>(source, i),
@@ -243,6 +254,16 @@ struct WriteSwapEndianLoopTemplate {
             count, static_cast<Index>(element_i +
                                       (writer.available() / sizeof(Element))));
         char* cursor = writer.cursor();
+        if constexpr (SubElementSize != 1 &&
+                      ArrayAccessor::buffer_kind ==
+                          internal::IterationBufferKind::kContiguous) {
+          SwapEndianUnalignedContiguous<SubElementSize>(
+              ArrayAccessor::template GetPointerAtOffset<Element>(source,
+                                                                  element_i),
+              cursor, (end_element_i - element_i) * NumSubElements);
+          cursor += (end_element_i - element_i) * sizeof(Element);
+          element_i = end_element_i;
+        }
         for (; element_i < end_element_i; ++element_i) {
           SwapEndianUnaligned<SubElementSize, NumSubElements>(
               ArrayAccessor::template GetPointerAtOffset<Element>(source,
@@ -305,6 +326,17 @@ struct ReadSwapEndianLoopTemplate {
             count, static_cast<Index>(element_i +
                                       (reader.available() / sizeof(Element))));
         const char* cursor = reader.cursor();
+        if constexpr (SubElementSize != 1 &&
+                      ArrayAccessor::buffer_kind ==
+                          internal::IterationBufferKind::kContiguous) {
+          SwapEndianUnalignedContiguous<SubElementSize>(
+              cursor,
+              ArrayAccessor::template GetPointerAtOffset<Element>(source,
+                                                                  element_i),
+              (end_element_i - element_i) * NumSubElements);
+          cursor += (end_element_i - element_i) * sizeof(Element);
+          element_i = end_element_i;
+        }
         for (; element_i < end_element_i; ++element_i) {
           if constexpr (IsBool) {
             // Ensure that the result is exactly 0 or 1.
@@ -17,6 +17,7 @@
 #include <cassert>
 #include <csetjmp>
 #include <memory>
+#include <vector>
 
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
@@ -253,7 +254,14 @@ absl::Status JpegReader::Context::Decode(tensorstore::span<unsigned char> dest,
   auto info = GetJpegImageInfo(&cinfo_);
   ABSL_CHECK_EQ(dest.size(), ImageRequiredBytes(info));
 
+  // Pointers to all output rows, such that libjpeg may decode as many rows as
+  // are available with each `jpeg_read_scanlines` call.
   ImageView dest_view(info, dest);
+  std::vector<JSAMPROW> output_rows(info.height);
+  for (int32_t row = 0; row < info.height; ++row) {
+    output_rows[row] =
+        reinterpret_cast<JSAMPROW>(dest_view.data_row(row).data());
+  }
   bool ok = [&]() {
     // Setjump is problematic with C++; by convention we put it in a
     // lambda which has no variables requiring cleanup.
@@ -265,11 +273,11 @@ absl::Status JpegReader::Context::Decode(tensorstore::span<unsigned char> dest,
     ::jpeg_start_decompress(&cinfo_);
     started_ = true;
 
-    // ... then read each scanline
+    // ... then read the scanlines
     while (cinfo_.output_scanline < cinfo_.output_height) {
-      auto* output_line = reinterpret_cast<JSAMPLE*>(
-          dest_view.data_row(cinfo_.output_scanline).data());
-      if (::jpeg_read_scanlines(&cinfo_, &output_line, 1) != 1) {
+      if (::jpeg_read_scanlines(
+              &cinfo_, output_rows.data() + cinfo_.output_scanline,
+              cinfo_.output_height - cinfo_.output_scanline) == 0) {
         error_.last_error.Update(absl::DataLossError(absl::StrFormat(
             "Cannot read JPEG; data ended after %d/%d scan lines",
             cinfo_.output_scanline, cinfo_.output_height)));
@@ -27,6 +27,7 @@
 #include "tensorstore/internal/image/jpeg_writer.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/span.h"
+#include "tensorstore/util/status.h"
 #include "tensorstore/util/status_testutil.h"
 
 namespace {
@@ -34,6 +35,30 @@ namespace {
 using ::tensorstore::internal_image::ImageInfo;
 using ::tensorstore::internal_image::JpegReader;
 using ::tensorstore::internal_image::JpegWriter;
+using ::tensorstore::internal_image::JpegWriterOptions;
+
+// Returns a smooth `height` x `width` single-channel test image.
+std::vector<uint8_t> MakeGradientImage(int height, int width) {
+  std::vector<uint8_t> pixels(height * width);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      pixels[y * width + x] = static_cast<uint8_t>(4 * x + 2 * y);
+    }
+  }
+  return pixels;
+}
+
+absl::Cord EncodeGradientImage(int height, int width,
+                               const JpegWriterOptions& options) {
+  auto pixels = MakeGradientImage(height, width);
+  absl::Cord encoded;
+  JpegWriter encoder;
+  riegeli::CordWriter cord_writer(&encoded);
+  TENSORSTORE_CHECK_OK(encoder.Initialize(&cord_writer, options));
+  TENSORSTORE_CHECK_OK(encoder.Encode(ImageInfo{height, width, 1}, pixels));
+  TENSORSTORE_CHECK_OK(encoder.Done());
+  return encoded;
+}
 
 TEST(JpegTest, Decode) {
   // Started the same as the png image, but very much the worse for wear after
@@ -298,4 +323,27 @@ TEST(JpegTest, InvalidNumComponents) {
   }
 }
 
+TEST(JpegTest, EncodeDecodeRoundTrip) {
+  JpegWriterOptions writer_options;
+  writer_options.quality = 100;
+  // The height is not a multiple of the 8 or 16 row MCU height, so the final
+  // batch of scanlines is partial.
+  constexpr int kHeight = 27, kWidth = 41;
+  auto encoded = EncodeGradientImage(kHeight, kWidth, writer_options);
+  auto expected = MakeGradientImage(kHeight, kWidth);
+
+  JpegReader decoder;
+  riegeli::CordReader cord_reader(&encoded);
+  ASSERT_THAT(decoder.Initialize(&cord_reader), ::tensorstore::IsOk());
+  auto info = decoder.GetImageInfo();
+  EXPECT_EQ(kHeight, info.height);
+  EXPECT_EQ(kWidth, info.width);
+  EXPECT_EQ(1, info.num_components);
+  std::vector<uint8_t> decoded(ImageRequiredBytes(info));
+  ASSERT_THAT(decoder.Decode(decoded), ::tensorstore::IsOk());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_NEAR(expected[i], decoded[i], 2) << i;
+  }
+}
+
 }  // namespace
@@ -17,6 +17,7 @@
 #include <cassert>
 #include <csetjmp>
 #include <memory>
+#include <vector>
 
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
@@ -172,6 +173,14 @@ absl::Status JpegWriter::Encode(const ImageInfo& info,
   EncodeState state(writer_);
   ImageView source_view = MakeWriteImageView(info, source);
 
+  // Pointers to all input rows, such that libjpeg may consume as many rows as
+  // it can with each `jpeg_write_scanlines` call.
+  std::vector<JSAMPROW> input_rows(info.height);
+  for (int32_t row = 0; row < info.height; ++row) {
+    input_rows[row] =
+        reinterpret_cast<JSAMPROW>(source_view.data_row(row).data());
+  }
+
   state.cinfo_.image_width = info.width;
   state.cinfo_.image_height = info.height;
   state.cinfo_.input_components = info.num_components;
@@ -191,10 +200,10 @@ absl::Status JpegWriter::Encode(const ImageInfo& info,
     state.started_ = true;
 
     while (state.cinfo_.next_scanline < state.cinfo_.image_height) {
-      auto* input_line = reinterpret_cast<JSAMPLE*>(
-          source_view.data_row(state.cinfo_.next_scanline).data());
-      // Always returns 1 since memory destination does not suspend.
-      ::jpeg_write_scanlines(&state.cinfo_, &input_line, 1);
+      // Always consumes all rows since the destination does not suspend.
+      ::jpeg_write_scanlines(
+          &state.cinfo_, input_rows.data() + state.cinfo_.next_scanline,
+          state.cinfo_.image_height - state.cinfo_.next_scanline);
     }
     ::jpeg_finish_compress(&state.cinfo_);
     return true;
@@ -0,0 +1,183 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/swap_endian.h"
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "tensorstore/index.h"
+#include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/util/endian.h"
+#include "tensorstore/util/span.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define TENSORSTORE_INTERNAL_SWAP_ENDIAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace tensorstore {
+namespace internal {
+namespace {
+
+template <size_t ElementSize>
+void SwapEndianPortable(const void* source, void* dest, Index count) {
+  const char* source_bytes = static_cast<const char*>(source);
+  char* dest_bytes = static_cast<char*>(dest);
+  for (Index i = 0; i < count; ++i) {
+    SwapEndianUnaligned<ElementSize>(source_bytes + i * ElementSize,
+                                     dest_bytes + i * ElementSize);
+  }
+}
+
+#ifdef TENSORSTORE_INTERNAL_SWAP_ENDIAN_X86
+
+/// `pshufb` control mask that reverses the bytes of each `ElementSize`-byte
+/// element within each 16-byte lane.
+template <size_t ElementSize>
+struct ShuffleMask {
+  constexpr ShuffleMask() : bytes() {
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+      const size_t lane_i = i % 16;
+      bytes[i] = static_cast<char>(lane_i - lane_i % ElementSize +
+                                   (ElementSize - 1 - lane_i % ElementSize));
+    }
+  }
+  alignas(32) char bytes[32];
+};
+
+template <size_t ElementSize>
+constexpr ShuffleMask<ElementSize> kShuffleMask{};
+
+template <size_t ElementSize>
+__attribute__((target("ssse3"))) void SwapEndianSsse3(const void* source_ptr,
+                                                      void* dest_ptr,
+                                                      Index count) {
+  const char* source = static_cast<const char*>(source_ptr);
+  char* dest = static_cast<char*>(dest_ptr);
+  const __m128i mask = _mm_load_si128(
+      reinterpret_cast<const __m128i*>(kShuffleMask<ElementSize>.bytes));
+  const Index num_bytes = count * ElementSize;
+  Index i = 0;
+  for (; i + 16 <= num_bytes; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_shuffle_epi8(v, mask));
+  }
+  SwapEndianPortable<ElementSize>(source + i, dest + i,
+                                  (num_bytes - i) / ElementSize);
+}
+
+template <size_t ElementSize>
+__attribute__((target("avx2"))) void SwapEndianAvx2(const void* source_ptr,
+                                                    void* dest_ptr,
+                                                    Index count) {
+  const char* source = static_cast<const char*>(source_ptr);
+  char* dest = static_cast<char*>(dest_ptr);
+  // `vpshufb` shuffles within each 128-bit lane, so the same per-lane mask
+  // applies to both lanes.
+  const __m256i mask = _mm256_load_si256(
+      reinterpret_cast<const __m256i*>(kShuffleMask<ElementSize>.bytes));
+  const Index num_bytes = count * ElementSize;
+  Index i = 0;
+  for (; i + 64 <= num_bytes; i += 64) {
+    const __m256i v0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+    const __m256i v1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i),
+                        _mm256_shuffle_epi8(v0, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 32),
+                        _mm256_shuffle_epi8(v1, mask));
+  }
+  for (; i + 32 <= num_bytes; i += 32) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i),
+                        _mm256_shuffle_epi8(v, mask));
+  }
+  SwapEndianPortable<ElementSize>(source + i, dest + i,
+                                  (num_bytes - i) / ElementSize);
+}
+
+#endif  // TENSORSTORE_INTERNAL_SWAP_ENDIAN_X86
+
+constexpr SwapEndianImplementation kPortableImplementation = {
+    "portable", &SwapEndianPortable<2>, &SwapEndianPortable<4>,
+    &SwapEndianPortable<8>};
+
+#ifdef TENSORSTORE_INTERNAL_SWAP_ENDIAN_X86
+constexpr SwapEndianImplementation kSsse3Implementation = {
+    "ssse3", &SwapEndianSsse3<2>, &SwapEndianSsse3<4>, &SwapEndianSsse3<8>};
+
+constexpr SwapEndianImplementation kAvx2Implementation = {
+    "avx2", &SwapEndianAvx2<2>, &SwapEndianAvx2<4>, &SwapEndianAvx2<8>};
+#endif
+
+std::vector<SwapEndianImplementation> GetImplementations() {
+  std::vector<SwapEndianImplementation> implementations;
+#ifdef TENSORSTORE_INTERNAL_SWAP_ENDIAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    implementations.push_back(kAvx2Implementation);
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    implementations.push_back(kSsse3Implementation);
+  }
+#endif
+  implementations.push_back(kPortableImplementation);
+  return implementations;
+}
+
+const SwapEndianImplementation& GetPreferredImplementation() {
+  static const SwapEndianImplementation implementation =
+      GetSupportedSwapEndianImplementations().front();
+  return implementation;
+}
+
+}  // namespace
+
+template <>
+void SwapEndianUnalignedContiguous<2>(const void* source, void* dest,
+                                      Index count) {
+  GetPreferredImplementation().swap2(source, dest, count);
+}
+
+template <>
+void SwapEndianUnalignedContiguous<4>(const void* source, void* dest,
+                                      Index count) {
+  GetPreferredImplementation().swap4(source, dest, count);
+}
+
+template <>
+void SwapEndianUnalignedContiguous<8>(const void* source, void* dest,
+                                      Index count) {
+  GetPreferredImplementation().swap8(source, dest, count);
+}
+
+const char* GetSwapEndianImplementationName() {
+  return GetPreferredImplementation().name;
+}
+
+span<const SwapEndianImplementation> GetSupportedSwapEndianImplementations() {
+  static internal::NoDestructor<std::vector<SwapEndianImplementation>>
+      implementations(GetImplementations());
+  return *implementations;
+}
+
+}  // namespace internal
+}  // namespace tensorstore
@@ -0,0 +1,86 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_SWAP_ENDIAN_H_
+#define TENSORSTORE_INTERNAL_SWAP_ENDIAN_H_
+
+/// \file
+///
+/// Vectorized byte swapping of contiguous arrays.
+///
+/// On x86 with GCC or Clang, an AVX2 or SSSE3 implementation is selected at
+/// run time based on the capabilities of the CPU.  Otherwise, a portable
+/// implementation is used.
+
+#include <stddef.h>
+
+#include "tensorstore/index.h"
+#include "tensorstore/util/span.h"
+
+namespace tensorstore {
+namespace internal {
+
+/// Copies `count` contiguous elements of `ElementSize` bytes from `source` to
+/// `dest`, swapping the byte order of each element.
+///
+/// Neither `source` nor `dest` needs to be aligned.  `source` may equal `dest`
+/// to swap in place, but otherwise the ranges must not overlap.
+///
+/// \tparam ElementSize Must be 2, 4, or 8.
+template <size_t ElementSize>
+void SwapEndianUnalignedContiguous(const void* source, void* dest,
+                                   Index count);
+
+template <>
+void SwapEndianUnalignedContiguous<2>(const void* source, void* dest,
+                                      Index count);
+template <>
+void SwapEndianUnalignedContiguous<4>(const void* source, void* dest,
+                                      Index count);
+template <>
+void SwapEndianUnalignedContiguous<8>(const void* source, void* dest,
+                                      Index count);
+
+/// Returns the name of the implementation used by
+/// `SwapEndianUnalignedContiguous`: `"avx2"`, `"ssse3"`, or `"portable"`.
+const char* GetSwapEndianImplementationName();
+
+/// Function with the same contract as `SwapEndianUnalignedContiguous`, for a
+/// fixed element size.
+using SwapEndianContiguousFunction = void (*)(const void* source, void* dest,
+                                              Index count);
+
+/// Implementation of `SwapEndianUnalignedContiguous` for a single instruction
+/// set.
+struct SwapEndianImplementation {
+  /// `"avx2"`, `"ssse3"`, or `"portable"`.
+  const char* name;
+
+  /// Functions for element sizes of 2, 4, and 8 bytes, respectively.
+  SwapEndianContiguousFunction swap2;
+  SwapEndianContiguousFunction swap4;
+  SwapEndianContiguousFunction swap8;
+};
+
+/// Returns the implementations supported by the CPU, in order of preference.
+///
+/// The first implementation is the one used by
+/// `SwapEndianUnalignedContiguous`, and the last is always `"portable"`.  This
+/// allows tests and benchmarks to exercise every supported implementation.
+span<const SwapEndianImplementation> GetSupportedSwapEndianImplementations();
+
+}  // namespace internal
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_SWAP_ENDIAN_H_
@@ -0,0 +1,105 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include "tensorstore/array.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/index.h"
+#include "tensorstore/internal/data_type_endian_conversion.h"
+#include "tensorstore/internal/swap_endian.h"
+#include "tensorstore/strided_layout.h"
+#include "tensorstore/util/endian.h"
+
+namespace {
+
+using ::tensorstore::Index;
+using ::tensorstore::internal::SwapEndianUnaligned;
+using ::tensorstore::internal::SwapEndianUnalignedContiguous;
+
+constexpr Index kNumBytes = 1 << 20;
+
+/// Measures the scalar per-element loop previously used for all buffers.
+template <size_t ElementSize>
+void BM_SwapEndianScalar(::benchmark::State& state) {
+  std::string source(kNumBytes, '\1'), dest(kNumBytes, '\0');
+  const Index count = kNumBytes / ElementSize;
+  for (auto _ : state) {
+    for (Index i = 0; i < count; ++i) {
+      SwapEndianUnaligned<ElementSize>(source.data() + i * ElementSize,
+                                       dest.data() + i * ElementSize);
+    }
+    ::benchmark::DoNotOptimize(dest.data());
+    ::benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * kNumBytes);
+}
+
+/// Measures the vectorized implementation for contiguous buffers.
+template <size_t ElementSize>
+void BM_SwapEndianContiguous(::benchmark::State& state) {
+  std::string source(kNumBytes, '\1'), dest(kNumBytes, '\0');
+  state.SetLabel(tensorstore::internal::GetSwapEndianImplementationName());
+  for (auto _ : state) {
+    SwapEndianUnalignedContiguous<ElementSize>(source.data(), dest.data(),
+                                               kNumBytes / ElementSize);
+    ::benchmark::DoNotOptimize(dest.data());
+    ::benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * kNumBytes);
+}
+
+BENCHMARK_TEMPLATE(BM_SwapEndianScalar, 2);
+BENCHMARK_TEMPLATE(BM_SwapEndianScalar, 4);
+BENCHMARK_TEMPLATE(BM_SwapEndianScalar, 8);
+BENCHMARK_TEMPLATE(BM_SwapEndianContiguous, 2);
+BENCHMARK_TEMPLATE(BM_SwapEndianContiguous, 4);
+BENCHMARK_TEMPLATE(BM_SwapEndianContiguous, 8);
+
+/// Measures `DecodeArray` from a big endian source to a native array.
+///
+/// `state.range(0)` specifies the stride (in elements) of the innermost source
+/// dimension: `1` is contiguous, and uses the vectorized implementation, while
+/// larger values use the per-element loop.
+template <typename T>
+void BM_DecodeArray(::benchmark::State& state) {
+  const Index stride = state.range(0);
+  const Index n = kNumBytes / sizeof(T);
+  auto source = tensorstore::AllocateArray<T>({n / 256, 256 * stride});
+  auto target = tensorstore::AllocateArray<T>({n / 256, 256});
+  const Index byte_stride = stride * static_cast<Index>(sizeof(T));
+  tensorstore::ArrayView<const T, 2> strided_source(
+      source.data(), tensorstore::StridedLayout<2>(
+                         {n / 256, 256}, {256 * byte_stride, byte_stride}));
+  for (auto _ : state) {
+    tensorstore::internal::DecodeArray(strided_source, tensorstore::endian::big,
+                                       target);
+    ::benchmark::DoNotOptimize(target.data());
+    ::benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * kNumBytes);
+}
+
+BENCHMARK_TEMPLATE(BM_DecodeArray, uint16_t)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_DecodeArray, uint32_t)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_DecodeArray, uint64_t)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_DecodeArray, tensorstore::complex128_t)
+    ->Arg(1)
+    ->Arg(2);
+
+}  // namespace
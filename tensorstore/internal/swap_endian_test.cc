@@ -0,0 +1,129 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/swap_endian.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorstore/index.h"
+#include "tensorstore/util/endian.h"
+
+namespace {
+
+using ::tensorstore::Index;
+using ::tensorstore::internal::GetSupportedSwapEndianImplementations;
+using ::tensorstore::internal::GetSwapEndianImplementationName;
+using ::tensorstore::internal::SwapEndianContiguousFunction;
+using ::tensorstore::internal::SwapEndianImplementation;
+using ::tensorstore::internal::SwapEndianUnaligned;
+using ::tensorstore::internal::SwapEndianUnalignedContiguous;
+
+template <typename T>
+class SwapEndianTest : public ::testing::Test {};
+
+template <size_t N>
+struct ElementSize {
+  static constexpr size_t value = N;
+};
+
+using ElementSizes =
+    ::testing::Types<ElementSize<2>, ElementSize<4>, ElementSize<8>>;
+TYPED_TEST_SUITE(SwapEndianTest, ElementSizes);
+
+template <size_t ElementSize>
+SwapEndianContiguousFunction GetFunction(
+    const SwapEndianImplementation& implementation) {
+  if constexpr (ElementSize == 2) return implementation.swap2;
+  if constexpr (ElementSize == 4) return implementation.swap4;
+  if constexpr (ElementSize == 8) return implementation.swap8;
+}
+
+// Tests that `function` matches the scalar implementation for counts that
+// exercise both the vector loop and the remainder, and for unaligned pointers.
+template <size_t kElementSize>
+void TestMatchesScalar(SwapEndianContiguousFunction function) {
+  for (const Index count : {0, 1, 3, 7, 8, 15, 16, 17, 33, 64, 100, 1000}) {
+    for (const size_t offset : {0, 1, 3}) {
+      SCOPED_TRACE(::testing::Message() << "count=" << count
+                                        << ", offset=" << offset);
+      std::string source(count * kElementSize + offset, '\0');
+      for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<char>(i * 31 + 7);
+      }
+      std::string expected(count * kElementSize, '\0');
+      for (Index i = 0; i < count; ++i) {
+        SwapEndianUnaligned<kElementSize>(
+            source.data() + offset + i * kElementSize,
+            expected.data() + i * kElementSize);
+      }
+      std::string dest(count * kElementSize + offset, '\0');
+      function(source.data() + offset, dest.data() + offset, count);
+      EXPECT_EQ(expected, dest.substr(offset));
+
+      // In place.
+      function(source.data() + offset, source.data() + offset, count);
+      EXPECT_EQ(expected, source.substr(offset));
+    }
+  }
+}
+
+// Tests every implementation supported by the CPU, not just the one selected
+// by `SwapEndianUnalignedContiguous`.
+TYPED_TEST(SwapEndianTest, MatchesScalar) {
+  constexpr size_t kElementSize = TypeParam::value;
+  for (const auto& implementation : GetSupportedSwapEndianImplementations()) {
+    SCOPED_TRACE(implementation.name);
+    TestMatchesScalar<kElementSize>(GetFunction<kElementSize>(implementation));
+  }
+}
+
+TYPED_TEST(SwapEndianTest, SelectedMatchesScalar) {
+  constexpr size_t kElementSize = TypeParam::value;
+  SCOPED_TRACE(GetSwapEndianImplementationName());
+  TestMatchesScalar<kElementSize>(&SwapEndianUnalignedContiguous<kElementSize>);
+}
+
+TEST(SwapEndianTest, SupportedImplementations) {
+  auto implementations = GetSupportedSwapEndianImplementations();
+  ASSERT_FALSE(implementations.empty());
+  EXPECT_STREQ(GetSwapEndianImplementationName(), implementations.front().name);
+  EXPECT_STREQ("portable", implementations.back().name);
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+  std::vector<std::string> names;
+  for (const auto& implementation : implementations) {
+    names.push_back(implementation.name);
+  }
+  __builtin_cpu_init();
+  EXPECT_EQ(__builtin_cpu_supports("avx2") != 0,
+            std::find(names.begin(), names.end(), "avx2") != names.end());
+  EXPECT_EQ(__builtin_cpu_supports("ssse3") != 0,
+            std::find(names.begin(), names.end(), "ssse3") != names.end());
+#endif
+}
+
+TEST(SwapEndianTest, Uint16) {
+  const unsigned char source[6] = {1, 2, 3, 4, 5, 6};
+  unsigned char dest[6];
+  SwapEndianUnalignedContiguous<2>(source, dest, 3);
+  EXPECT_THAT(dest, ::testing::ElementsAre(2, 1, 4, 3, 6, 5));
+}
+
+}  // namespace
@@ -0,0 +1,219 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/temporary_file.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/internal/env.h"
+#include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/internal/os_error_code.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+
+// Include system headers last to reduce impact of macros.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tensorstore {
+namespace internal {
+
+#ifdef _WIN32
+
+namespace {
+HANDLE ToHandle(intptr_t handle) { return reinterpret_cast<HANDLE>(handle); }
+}  // namespace
+
+Result<TemporaryFile> TemporaryFile::Create() {
+  wchar_t directory[MAX_PATH + 1];
+  wchar_t path[MAX_PATH + 1];
+  if (::GetTempPathW(MAX_PATH + 1, directory) == 0 ||
+      ::GetTempFileNameW(directory, L"ts", 0, path) == 0) {
+    return StatusFromOsError(GetLastErrorCode(),
+                             "Error creating temporary file");
+  }
+  HANDLE handle = ::CreateFileW(
+      path,
+      /*dwDesiredAccess=*/GENERIC_READ | GENERIC_WRITE | DELETE,
+      /*dwShareMode=*/FILE_SHARE_DELETE | FILE_SHARE_READ,
+      /*lpSecurityAttributes=*/nullptr,
+      /*dwCreationDisposition=*/CREATE_ALWAYS,
+      /*dwFlagsAndAttributes=*/FILE_ATTRIBUTE_TEMPORARY |
+          FILE_FLAG_DELETE_ON_CLOSE,
+      /*hTemplateFile=*/nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return StatusFromOsError(GetLastErrorCode(),
+                             "Error creating temporary file");
+  }
+  return TemporaryFile(reinterpret_cast<intptr_t>(handle));
+}
+
+void TemporaryFile::Close() { ::CloseHandle(ToHandle(handle_)); }
+
+absl::Status TemporaryFile::Append(const absl::Cord& data) {
+  for (std::string_view chunk : data.Chunks()) {
+    while (!chunk.empty()) {
+      DWORD n;
+      if (!::WriteFile(ToHandle(handle_), chunk.data(),
+                       static_cast<DWORD>(std::min<size_t>(chunk.size(),
+                                                           1u << 30)),
+                       &n, /*lpOverlapped=*/nullptr)) {
+        return StatusFromOsError(GetLastErrorCode(),
+                                 "Error writing temporary file");
+      }
+      size_ += n;
+      chunk.remove_prefix(n);
+    }
+  }
+  return absl::OkStatus();
+}
+
+Result<absl::Cord> TemporaryFile::Read() const {
+  if (size_ == 0) return absl::Cord();
+  if (HANDLE mapping = ::CreateFileMappingW(
+          ToHandle(handle_), /*lpFileMappingAttributes=*/nullptr,
+          PAGE_READONLY, /*dwMaximumSizeHigh=*/0, /*dwMaximumSizeLow=*/0,
+          /*lpName=*/nullptr)) {
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_READ,
+                                 /*dwFileOffsetHigh=*/0,
+                                 /*dwFileOffsetLow=*/0, size_);
+    // The view keeps the mapping alive.
+    ::CloseHandle(mapping);
+    if (data) {
+      return absl::MakeCordFromExternal(
+          std::string_view(static_cast<const char*>(data), size_),
+          [data] { ::UnmapViewOfFile(data); });
+    }
+  }
+  FlatCordBuilder buffer(size_);
+  for (size_t offset = 0; offset < buffer.size();) {
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(offset & 0xffffffff);
+    overlapped.OffsetHigh =
+        static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+    DWORD n;
+    if (!::ReadFile(ToHandle(handle_), buffer.data() + offset,
+                    static_cast<DWORD>(
+                        std::min<size_t>(buffer.size() - offset, 1u << 30)),
+                    &n, &overlapped) ||
+        n == 0) {
+      return StatusFromOsError(GetLastErrorCode(),
+                               "Error reading temporary file");
+    }
+    offset += n;
+  }
+  return std::move(buffer).Build();
+}
+
+#else
+
+Result<TemporaryFile> TemporaryFile::Create() {
+  std::string directory = GetEnv("TMPDIR").value_or("");
+  if (directory.empty()) directory = "/tmp";
+  int fd = -1;
+#ifdef O_TMPFILE
+  fd = ::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+#endif
+  if (fd == -1) {
+    // `O_TMPFILE` is not supported by the platform or file system.  Create a
+    // named file and unlink it immediately instead.
+    std::string path = directory + "/tensorstore_tmp.XXXXXX";
+    fd = ::mkstemp(path.data());
+    if (fd != -1) ::unlink(path.c_str());
+  }
+  if (fd == -1) {
+    return StatusFromOsError(GetLastErrorCode(),
+                             "Error creating temporary file in ",
+                             QuoteString(directory));
+  }
+  return TemporaryFile(fd);
+}
+
+void TemporaryFile::Close() { ::close(static_cast<int>(handle_)); }
+
+absl::Status TemporaryFile::Append(const absl::Cord& data) {
+  for (std::string_view chunk : data.Chunks()) {
+    while (!chunk.empty()) {
+      ssize_t n =
+          ::write(static_cast<int>(handle_), chunk.data(), chunk.size());
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return StatusFromOsError(GetLastErrorCode(),
+                                 "Error writing temporary file");
+      }
+      size_ += n;
+      chunk.remove_prefix(n);
+    }
+  }
+  return absl::OkStatus();
+}
+
+Result<absl::Cord> TemporaryFile::Read() const {
+  if (size_ == 0) return absl::Cord();
+  const int fd = static_cast<int>(handle_);
+  const size_t size = size_;
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data != MAP_FAILED) {
+    return absl::MakeCordFromExternal(
+        std::string_view(static_cast<const char*>(data), size),
+        [data, size] { ::munmap(data, size); });
+  }
+  FlatCordBuilder buffer(size);
+  for (size_t offset = 0; offset < size;) {
+    ssize_t n = ::pread(fd, buffer.data() + offset, size - offset, offset);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      return StatusFromOsError(GetLastErrorCode(),
+                               "Error reading temporary file");
+    }
+    offset += n;
+  }
+  return std::move(buffer).Build();
+}
+
+#endif
+
+TemporaryFile::TemporaryFile(TemporaryFile&& other) noexcept
+    : handle_(std::exchange(other.handle_, kInvalidHandle)),
+      size_(std::exchange(other.size_, 0)) {}
+
+TemporaryFile& TemporaryFile::operator=(TemporaryFile&& other) noexcept {
+  if (this != &other) {
+    if (valid()) Close();
+    handle_ = std::exchange(other.handle_, kInvalidHandle);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+TemporaryFile::~TemporaryFile() {
+  if (valid()) Close();
+}
+
+}  // namespace internal
+}  // namespace tensorstore
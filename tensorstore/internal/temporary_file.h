@@ -0,0 +1,88 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_TEMPORARY_FILE_H_
+#define TENSORSTORE_INTERNAL_TEMPORARY_FILE_H_
+
+#include <stdint.h>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal {
+
+/// Anonymous temporary file that is deleted when it is closed.
+///
+/// This is intended for spilling data that would otherwise be accumulated in
+/// memory.  Data is appended with `Append`, and the entire file is returned by
+/// `Read` as a memory mapping where supported, such that it does not occupy
+/// heap memory.
+class TemporaryFile {
+ public:
+  /// Constructs an invalid file.
+  TemporaryFile() = default;
+
+  /// Creates an empty temporary file.
+  ///
+  /// The file is created in the system temporary directory (on POSIX
+  /// platforms, the directory specified by the `TMPDIR` environment variable,
+  /// or `/tmp` if it is not set).
+  static Result<TemporaryFile> Create();
+
+  TemporaryFile(TemporaryFile&& other) noexcept;
+  TemporaryFile& operator=(TemporaryFile&& other) noexcept;
+  ~TemporaryFile();
+
+  /// Appends `data` to the end of the file.
+  ///
+  /// If an error occurs, `size()` still reflects any prefix of `data` that was
+  /// written.
+  ///
+  /// \pre `valid()`
+  absl::Status Append(const absl::Cord& data);
+
+  /// Returns the contents of the file.
+  ///
+  /// The returned value references a read-only memory mapping of the file
+  /// where supported, and otherwise a copy read into memory.  It remains valid
+  /// after this object is destroyed.
+  ///
+  /// \pre `valid()`
+  Result<absl::Cord> Read() const;
+
+  /// Returns the number of bytes written.
+  uint64_t size() const { return size_; }
+
+  /// Returns `true` if this object refers to an open file.
+  bool valid() const { return handle_ != kInvalidHandle; }
+
+ private:
+  // File descriptor, or `HANDLE` on Windows.
+  using Handle = intptr_t;
+  static constexpr Handle kInvalidHandle = -1;
+
+  explicit TemporaryFile(Handle handle) : handle_(handle) {}
+
+  void Close();
+
+  Handle handle_ = kInvalidHandle;
+  uint64_t size_ = 0;
+};
+
+}  // namespace internal
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_TEMPORARY_FILE_H_
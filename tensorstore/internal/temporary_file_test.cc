@@ -0,0 +1,63 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/temporary_file.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::internal::TemporaryFile;
+
+TEST(TemporaryFileTest, Empty) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto file, TemporaryFile::Create());
+  EXPECT_TRUE(file.valid());
+  EXPECT_EQ(0, file.size());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto data, file.Read());
+  EXPECT_TRUE(data.empty());
+}
+
+TEST(TemporaryFileTest, AppendAndRead) {
+  std::optional<absl::Cord> data;
+  std::string expected;
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto file, TemporaryFile::Create());
+    absl::Cord fragmented;
+    fragmented.Append(std::string(5000, 'b'));
+    fragmented.Append(std::string(3000, 'c'));
+    for (const absl::Cord& value :
+         {absl::Cord("a"), fragmented, absl::Cord(), absl::Cord("d")}) {
+      TENSORSTORE_ASSERT_OK(file.Append(value));
+      expected += std::string(value);
+      EXPECT_EQ(expected.size(), file.size());
+    }
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(data, file.Read());
+
+    // Moving the file preserves its contents.
+    TemporaryFile other = std::move(file);
+    EXPECT_EQ(expected.size(), other.size());
+    TENSORSTORE_ASSERT_OK(other.Append(absl::Cord("e")));
+    EXPECT_EQ(expected.size() + 1, other.size());
+  }
+  // The value remains valid after the file is closed.
+  EXPECT_EQ(expected, *data);
+}
+
+}  // namespace
@@ -0,0 +1,243 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/batch_util.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_kvstore_batch {
+namespace {
+
+auto& batch_read = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/batch/read", "Batched kvstore::Read calls");
+
+auto& batch_issued_read = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/batch/issued_read",
+    "kvstore::Read calls issued after coalescing batched reads");
+
+struct PendingRead {
+  kvstore::ReadOptions options;
+  Promise<kvstore::ReadResult> promise;
+};
+
+void IssueRead(kvstore::Driver* driver, const kvstore::Key& key,
+               PendingRead& request) {
+  batch_issued_read.Increment();
+  LinkResult(std::move(request.promise),
+             driver->Read(key, std::move(request.options)));
+}
+
+/// Completes `request`, which is contained in the byte range starting at
+/// `base_offset` that was read with result `merged`.
+void ResolveFromMergedRead(PendingRead& request, uint64_t base_offset,
+                           const kvstore::ReadResult& merged) {
+  if (!merged.has_value()) {
+    request.promise.SetResult(
+        kvstore::ReadResult{merged.state, {}, merged.stamp});
+    return;
+  }
+  const auto& byte_range = request.options.byte_range;
+  assert(byte_range.inclusive_min >= base_offset);
+  OptionalByteRangeRequest relative_range(
+      byte_range.inclusive_min - base_offset,
+      byte_range.exclusive_max
+          ? std::optional<uint64_t>(*byte_range.exclusive_max - base_offset)
+          : std::nullopt);
+  auto result = relative_range.Validate(merged.value.size());
+  if (!result.ok()) {
+    request.promise.SetResult(std::move(result).status());
+    return;
+  }
+  request.promise.SetResult(
+      kvstore::ReadResult{kvstore::ReadResult::kValue,
+                          internal::GetSubCord(merged.value, *result),
+                          merged.stamp});
+}
+
+/// Issues a single read that covers the byte ranges of all of `requests`,
+/// which must have the same `if_equal` and `if_not_equal` conditions and be
+/// ordered by starting offset.
+void IssueMergedRead(kvstore::DriverPtr driver, const kvstore::Key& key,
+                     std::vector<PendingRead> requests) {
+  assert(!requests.empty());
+  if (requests.size() == 1) {
+    IssueRead(driver.get(), key, requests[0]);
+    return;
+  }
+  kvstore::ReadOptions options;
+  options.if_equal = requests[0].options.if_equal;
+  options.if_not_equal = requests[0].options.if_not_equal;
+  options.staleness_bound = absl::InfinitePast();
+  options.byte_range.inclusive_min =
+      requests[0].options.byte_range.inclusive_min;
+  options.byte_range.exclusive_max = 0;
+  for (const auto& request : requests) {
+    options.staleness_bound =
+        std::max(options.staleness_bound, request.options.staleness_bound);
+    if (!request.options.byte_range.exclusive_max) {
+      options.byte_range.exclusive_max = std::nullopt;
+    } else if (options.byte_range.exclusive_max) {
+      options.byte_range.exclusive_max =
+          std::max(*options.byte_range.exclusive_max,
+                   *request.options.byte_range.exclusive_max);
+    }
+  }
+  const uint64_t base_offset = options.byte_range.inclusive_min;
+  batch_issued_read.Increment();
+  auto future = driver->Read(key, std::move(options));
+  future.Force();
+  std::move(future).ExecuteWhenReady(
+      [driver = std::move(driver), key, requests = std::move(requests),
+       base_offset](ReadyFuture<kvstore::ReadResult> future) mutable {
+        auto& merged = future.result();
+        if (!merged.ok()) {
+          if (absl::IsOutOfRange(merged.status())) {
+            // The value is shorter than the coalesced byte range; retry the
+            // requests individually so that each fails or succeeds on its
+            // own.
+            for (auto& request : requests) {
+              IssueRead(driver.get(), key, request);
+            }
+            return;
+          }
+          for (auto& request : requests) {
+            request.promise.SetResult(merged.status());
+          }
+          return;
+        }
+        for (auto& request : requests) {
+          ResolveFromMergedRead(request, base_offset, *merged);
+        }
+      });
+}
+
+/// Batch entry that accumulates the reads of a single key.
+class DeferredReadEntry : public Batch::Entry {
+ public:
+  explicit DeferredReadEntry(kvstore::DriverPtr driver, kvstore::Key key,
+                             uint64_t max_gap_bytes)
+      : driver_(std::move(driver)),
+        key_(std::move(key)),
+        max_gap_bytes_(max_gap_bytes) {}
+
+  void Add(PendingRead request) { requests_.push_back(std::move(request)); }
+
+  void Submit() override {
+    // Drop requests whose results are no longer needed.
+    requests_.erase(std::remove_if(requests_.begin(), requests_.end(),
+                                   [](const PendingRead& request) {
+                                     return !request.promise.result_needed();
+                                   }),
+                    requests_.end());
+    // Only requests with the same conditions may be merged.  Order by
+    // condition, then by starting offset.
+    std::sort(requests_.begin(), requests_.end(),
+              [](const PendingRead& a, const PendingRead& b) {
+                const auto& ao = a.options;
+                const auto& bo = b.options;
+                if (ao.if_equal.value != bo.if_equal.value) {
+                  return ao.if_equal.value < bo.if_equal.value;
+                }
+                if (ao.if_not_equal.value != bo.if_not_equal.value) {
+                  return ao.if_not_equal.value < bo.if_not_equal.value;
+                }
+                return ao.byte_range.inclusive_min <
+                       bo.byte_range.inclusive_min;
+              });
+    std::vector<PendingRead> run;
+    // Exclusive end of the byte range covered by `run`, or `std::nullopt` if
+    // unbounded.
+    std::optional<uint64_t> run_end;
+    for (auto& request : requests_) {
+      if (!run.empty()) {
+        const auto& prev = run.back().options;
+        const auto& cur = request.options;
+        bool can_merge = prev.if_equal == cur.if_equal &&
+                         prev.if_not_equal == cur.if_not_equal &&
+                         (!run_end ||
+                          cur.byte_range.inclusive_min <= *run_end ||
+                          cur.byte_range.inclusive_min - *run_end <=
+                              max_gap_bytes_);
+        if (!can_merge) {
+          IssueMergedRead(driver_, key_, std::move(run));
+          run.clear();
+        }
+      }
+      if (run.empty()) {
+        run_end = request.options.byte_range.exclusive_max;
+      } else if (!request.options.byte_range.exclusive_max) {
+        run_end = std::nullopt;
+      } else if (run_end) {
+        run_end = std::max(*run_end, *request.options.byte_range.exclusive_max);
+      }
+      run.push_back(std::move(request));
+    }
+    if (!run.empty()) {
+      IssueMergedRead(driver_, key_, std::move(run));
+    }
+  }
+
+ private:
+  kvstore::DriverPtr driver_;
+  kvstore::Key key_;
+  uint64_t max_gap_bytes_;
+  std::vector<PendingRead> requests_;
+};
+
+}  // namespace
+
+Future<kvstore::ReadResult> DeferRead(kvstore::Driver* driver, kvstore::Key key,
+                                      kvstore::ReadOptions options,
+                                      uint64_t max_gap_bytes) {
+  assert(options.batch);
+  batch_read.Increment();
+  Batch batch = std::exchange(options.batch, no_batch);
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  batch.AddRequest(
+      driver, key,
+      [&] {
+        return std::make_unique<DeferredReadEntry>(
+            kvstore::DriverPtr(driver), key, max_gap_bytes);
+      },
+      [&](Batch::Entry& entry) {
+        static_cast<DeferredReadEntry&>(entry).Add(
+            PendingRead{std::move(options), std::move(promise)});
+      });
+  return std::move(future);
+}
+
+}  // namespace internal_kvstore_batch
+}  // namespace tensorstore
@@ -0,0 +1,70 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_BATCH_UTIL_H_
+#define TENSORSTORE_KVSTORE_BATCH_UTIL_H_
+
+/// \file
+///
+/// Helpers for implementing batched reads in kvstore drivers.
+
+#include <cstdint>
+
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+namespace internal_kvstore_batch {
+
+/// Defers a read of `key` from `driver` until `options.batch` is submitted.
+///
+/// When the batch is submitted, all deferred reads of `key` from `driver` with
+/// the same `if_equal` and `if_not_equal` conditions are merged:
+///
+/// - Requests for the same or overlapping byte ranges are served by a single
+///   request, and requests whose byte ranges are separated by no more than
+///   `max_gap_bytes` are coalesced into a single request for the enclosing
+///   byte range.
+///
+/// - The merged request uses the maximum `staleness_bound` of the requests.
+///
+/// Each merged request is issued by calling `driver->Read` with a null batch.
+/// If a merged request fails with `absl::StatusCode::kOutOfRange` (because the
+/// value is shorter than the coalesced byte range), the requests it was merged
+/// from are issued individually instead.
+///
+/// Drivers that support batching typically call this from their `Read`
+/// implementation::
+///
+///     if (options.batch) {
+///       return internal_kvstore_batch::DeferRead(this, std::move(key),
+///                                                std::move(options));
+///     }
+///
+/// \param driver The driver from which to read.  A reference is retained until
+///     the batch is submitted.
+/// \param key The key to read.
+/// \param options The read options.  `options.batch` must not be null.
+/// \param max_gap_bytes Maximum number of unrequested bytes between two byte
+///     ranges for them to be coalesced.
+Future<kvstore::ReadResult> DeferRead(kvstore::Driver* driver, kvstore::Key key,
+                                      kvstore::ReadOptions options,
+                                      uint64_t max_gap_bytes = 4096);
+
+}  // namespace internal_kvstore_batch
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_BATCH_UTIL_H_
@@ -0,0 +1,210 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/batch_util.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+
+using ::tensorstore::Batch;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::OptionalByteRangeRequest;
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal::MockKeyValueStore;
+using ::tensorstore::internal_kvstore_batch::DeferRead;
+
+auto BatchedRead(MockKeyValueStore* driver, const Batch& batch,
+                 std::string key, OptionalByteRangeRequest byte_range,
+                 uint64_t max_gap_bytes = 4096,
+                 absl::Time staleness_bound = absl::InfiniteFuture()) {
+  kvstore::ReadOptions options;
+  options.batch = batch;
+  options.byte_range = byte_range;
+  options.staleness_bound = staleness_bound;
+  return DeferRead(driver, std::move(key), std::move(options), max_gap_bytes);
+}
+
+/// Returns a value of `n` bytes starting at `offset` within "0123456789...".
+absl::Cord Digits(uint64_t offset, uint64_t n) {
+  std::string s;
+  for (uint64_t i = 0; i < n; ++i) {
+    s += static_cast<char>('0' + (offset + i) % 10);
+  }
+  return absl::Cord(s);
+}
+
+TEST(DeferReadTest, CoalescesNearbyByteRanges) {
+  auto mock_driver = MockKeyValueStore::Make();
+  auto batch = Batch::New();
+  auto t1 = absl::Now() - absl::Seconds(10);
+  auto t2 = absl::Now();
+  auto a = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(2, 5), 4096, t1);
+  auto b = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(4, 8), 4096, t2);
+  auto c = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(2, 5), 4096, t1);
+  auto d = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(10, 12), 4096, t1);
+  EXPECT_TRUE(mock_driver->read_requests.empty());
+  batch.Release();
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ("k", req.key);
+    EXPECT_EQ(OptionalByteRangeRequest(2, 12), req.options.byte_range);
+    EXPECT_EQ(t2, req.options.staleness_bound);
+    EXPECT_FALSE(req.options.batch);
+    req.promise.SetResult(kvstore::ReadResult{
+        kvstore::ReadResult::kValue, Digits(2, 10),
+        TimestampedStorageGeneration{StorageGeneration::FromString("g"),
+                                     absl::Now()}});
+  }
+  EXPECT_TRUE(mock_driver->read_requests.empty());
+  auto g = StorageGeneration::FromString("g");
+  EXPECT_THAT(a.result(), MatchesKvsReadResult(absl::Cord("234"), g));
+  EXPECT_THAT(b.result(), MatchesKvsReadResult(absl::Cord("4567"), g));
+  EXPECT_THAT(c.result(), MatchesKvsReadResult(absl::Cord("234"), g));
+  EXPECT_THAT(d.result(), MatchesKvsReadResult(absl::Cord("01"), g));
+}
+
+TEST(DeferReadTest, UnboundedByteRange) {
+  auto mock_driver = MockKeyValueStore::Make();
+  auto batch = Batch::New();
+  auto a = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(5, 7));
+  auto b = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(3));
+  auto c = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(20));
+  batch.Release();
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ(OptionalByteRangeRequest(3), req.options.byte_range);
+    req.promise.SetResult(kvstore::ReadResult{
+        kvstore::ReadResult::kValue, Digits(3, 7),
+        TimestampedStorageGeneration{StorageGeneration::FromString("g"),
+                                     absl::Now()}});
+  }
+  EXPECT_THAT(a.result(), MatchesKvsReadResult(absl::Cord("56")));
+  EXPECT_THAT(b.result(), MatchesKvsReadResult(absl::Cord("3456789")));
+  EXPECT_THAT(c.result(), MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
+TEST(DeferReadTest, DistantByteRangesAndKeys) {
+  auto mock_driver = MockKeyValueStore::Make();
+  auto batch = Batch::New();
+  auto a = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(0, 2), /*max_gap_bytes=*/2);
+  auto b = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(5, 6), /*max_gap_bytes=*/2);
+  auto c = BatchedRead(mock_driver.get(), batch, "j",
+                       OptionalByteRangeRequest(0, 2), /*max_gap_bytes=*/2);
+  batch.Release();
+  std::vector<std::pair<std::string, OptionalByteRangeRequest>> requests;
+  while (auto req = mock_driver->read_requests.pop_nonblock()) {
+    requests.emplace_back(req->key, req->options.byte_range);
+    req->promise.SetResult(kvstore::ReadResult{
+        kvstore::ReadResult::kMissing,
+        {},
+        TimestampedStorageGeneration{StorageGeneration::NoValue(),
+                                     absl::Now()}});
+  }
+  EXPECT_THAT(requests,
+              ::testing::ElementsAre(
+                  ::testing::Pair("k", OptionalByteRangeRequest(0, 2)),
+                  ::testing::Pair("k", OptionalByteRangeRequest(5, 6)),
+                  ::testing::Pair("j", OptionalByteRangeRequest(0, 2))));
+  EXPECT_THAT(a.result(), MatchesKvsReadResultNotFound());
+  EXPECT_THAT(b.result(), MatchesKvsReadResultNotFound());
+  EXPECT_THAT(c.result(), MatchesKvsReadResultNotFound());
+}
+
+TEST(DeferReadTest, OutOfRangeFallsBackToIndividualReads) {
+  auto mock_driver = MockKeyValueStore::Make();
+  auto batch = Batch::New();
+  auto a = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(0, 2));
+  auto b = BatchedRead(mock_driver.get(), batch, "k",
+                       OptionalByteRangeRequest(8, 10));
+  batch.Release();
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ(OptionalByteRangeRequest(0, 10), req.options.byte_range);
+    req.promise.SetResult(absl::OutOfRangeError("too short"));
+  }
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ(OptionalByteRangeRequest(0, 2), req.options.byte_range);
+    req.promise.SetResult(kvstore::ReadResult{
+        kvstore::ReadResult::kValue, Digits(0, 2),
+        TimestampedStorageGeneration{StorageGeneration::FromString("g"),
+                                     absl::Now()}});
+  }
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ(OptionalByteRangeRequest(8, 10), req.options.byte_range);
+    req.promise.SetResult(absl::OutOfRangeError("too short"));
+  }
+  EXPECT_THAT(a.result(), MatchesKvsReadResult(absl::Cord("01")));
+  EXPECT_THAT(b.result(), MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
+TEST(DeferReadTest, DifferentConditionsNotMerged) {
+  auto mock_driver = MockKeyValueStore::Make();
+  auto batch = Batch::New();
+  kvstore::ReadOptions options;
+  options.batch = batch;
+  options.if_not_equal = StorageGeneration::FromString("g");
+  auto a = DeferRead(mock_driver.get(), "k", options);
+  auto b = BatchedRead(mock_driver.get(), batch, "k", {});
+  options.batch = tensorstore::no_batch;
+  batch.Release();
+  ASSERT_EQ(2, mock_driver->read_requests.size());
+  for (int i = 0; i < 2; ++i) {
+    auto req = mock_driver->read_requests.pop();
+    req.promise.SetResult(kvstore::ReadResult{
+        kvstore::ReadResult::kMissing,
+        {},
+        TimestampedStorageGeneration{StorageGeneration::NoValue(),
+                                     absl::Now()}});
+  }
+  EXPECT_THAT(a.result(), MatchesKvsReadResultNotFound());
+  EXPECT_THAT(b.result(), MatchesKvsReadResultNotFound());
+}
+
+}  // namespace
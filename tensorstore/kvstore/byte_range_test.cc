@@ -146,6 +146,13 @@ TEST(OptionalByteRangeRequestTest, Validate) {
       MatchesStatus(absl::StatusCode::kOutOfRange,
                     "Requested byte range \\[15, 15\\) is not valid for "
                     "value of size 9"));
+  EXPECT_THAT(OptionalByteRangeRequest(10).Validate(10),
+              ::testing::Optional(ByteRange{10, 10}));
+  EXPECT_THAT(
+      OptionalByteRangeRequest(15).Validate(9),
+      MatchesStatus(absl::StatusCode::kOutOfRange,
+                    "Requested byte range \\[15, \\?\\) is not valid for "
+                    "value of size 9"));
 }
 
 TEST(GetSubStringTest, Basic) {
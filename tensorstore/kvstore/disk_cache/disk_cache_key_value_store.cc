@@ -0,0 +1,939 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+///
+/// Key-value store adapter that caches the values read from a base key-value
+/// store in a second, typically local, key-value store.
+///
+/// Each cached value is stored in the cache key-value store as a separate
+/// record, consisting of a header followed by the value.  The header records
+/// the key and byte range that were read, along with the generation and time
+/// at which the value was read, so that the cached value can be revalidated
+/// against the base key-value store.  Records are named by a hash of the key
+/// and byte range.
+///
+/// The set of records, and their sizes, are tracked in memory in order to
+/// enforce `total_bytes_limit`.  When the driver is opened, existing records
+/// are found by listing the cache key-value store and reading their headers.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/endian.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/escaping.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/cache/cache_pool_limits.h"
+#include "tensorstore/internal/cache/frequency_sketch.h"
+#include "tensorstore/internal/digest/sha256.h"
+#include "tensorstore/internal/intrusive_linked_list.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/path.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/registry.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/util/execution/any_receiver.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/garbage_collection/garbage_collection.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_disk_cache {
+
+namespace jb = tensorstore::internal_json_binding;
+
+using ::tensorstore::internal::CacheEvictionPolicy;
+using ::tensorstore::kvstore::ReadResult;
+
+auto& disk_cache_hit = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/hit",
+    "disk_cache driver reads satisfied by the cache without accessing the "
+    "base kvstore");
+
+auto& disk_cache_revalidate = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/revalidate",
+    "disk_cache driver reads of cached values that required a conditional "
+    "read from the base kvstore");
+
+auto& disk_cache_miss = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/miss",
+    "disk_cache driver reads of values that were not cached");
+
+auto& disk_cache_evict = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/evict",
+    "Number of records evicted by the disk_cache driver");
+
+/// Identifies the format of a cache record.
+constexpr char kRecordMagic[4] = {'T', 'S', 'D', 'C'};
+constexpr uint32_t kRecordVersion = 1;
+
+/// Size of the fixed-length portion of a record header.
+constexpr size_t kFixedHeaderSize = 4 + 4 + 1 + 8 + 8 + 8 + 8 + 4 + 4;
+
+/// Assumed average record size used to size the frequency sketch of the
+/// `CacheEvictionPolicy::kTinyLfu` policy.
+constexpr uint64_t kTinyLfuRecordSizeEstimate = 65536;
+
+/// Decoded representation of a cache record.
+struct Record {
+  /// Key (relative to the `disk_cache` driver) that was read.
+  std::string key;
+
+  /// Byte range that was read.  If the full value was read, this is
+  /// `OptionalByteRangeRequest{}`.
+  OptionalByteRangeRequest byte_range;
+
+  /// Generation and time at which `value` was read from the base kvstore.
+  TimestampedStorageGeneration stamp;
+
+  /// Value, or `std::nullopt` if the key was not found.
+  std::optional<absl::Cord> value;
+
+  /// Size of the value, which may be known even if `value` was not read.
+  uint64_t value_size = 0;
+
+  /// Total size of the encoded record.
+  uint64_t record_size = 0;
+};
+
+bool IsFullRange(const OptionalByteRangeRequest& byte_range) {
+  return byte_range.inclusive_min == 0 && !byte_range.exclusive_max;
+}
+
+/// Returns the name of the record that caches the result of reading
+/// `byte_range` of `key`.
+std::string GetRecordPath(std::string_view key,
+                          const OptionalByteRangeRequest& byte_range) {
+  internal::SHA256Digester digester;
+  char range_data[17];
+  absl::little_endian::Store64(range_data, byte_range.inclusive_min);
+  absl::little_endian::Store64(range_data + 8,
+                               byte_range.exclusive_max.value_or(0));
+  range_data[16] = byte_range.exclusive_max ? 1 : 0;
+  digester.Write(std::string_view(range_data, sizeof(range_data)));
+  digester.Write(key);
+  auto digest = digester.Digest();
+  // Use the first byte as a directory, to limit the number of records per
+  // directory.
+  std::string hex = absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest.data()), 16));
+  return tensorstore::StrCat(std::string_view(hex).substr(0, 2), "/",
+                             std::string_view(hex).substr(2));
+}
+
+absl::Cord EncodeRecord(std::string_view key,
+                        const OptionalByteRangeRequest& byte_range,
+                        const TimestampedStorageGeneration& stamp,
+                        const std::optional<absl::Cord>& value) {
+  std::string header(kFixedHeaderSize, '\0');
+  char* p = header.data();
+  std::memcpy(p, kRecordMagic, 4);
+  absl::little_endian::Store32(p + 4, kRecordVersion);
+  p[8] = value ? 1 : 0;
+  absl::little_endian::Store64(p + 9, byte_range.inclusive_min);
+  absl::little_endian::Store64(
+      p + 17, byte_range.exclusive_max ? *byte_range.exclusive_max + 1 : 0);
+  absl::little_endian::Store64(p + 25, absl::ToUnixNanos(stamp.time));
+  absl::little_endian::Store64(p + 33, value ? value->size() : 0);
+  absl::little_endian::Store32(p + 41, key.size());
+  absl::little_endian::Store32(p + 45, stamp.generation.value.size());
+  header.append(key);
+  header.append(stamp.generation.value);
+  absl::Cord record(std::move(header));
+  if (value) record.Append(*value);
+  return record;
+}
+
+/// Returns the size of the header of a record, given the first
+/// `kFixedHeaderSize` bytes of the record, or `std::nullopt` if `encoded` is
+/// not the start of a valid record.
+std::optional<uint64_t> DecodeHeaderSize(const absl::Cord& encoded) {
+  if (encoded.size() < kFixedHeaderSize) return std::nullopt;
+  const std::string fixed(encoded.Subcord(0, kFixedHeaderSize));
+  if (std::memcmp(fixed.data(), kRecordMagic, 4) != 0 ||
+      absl::little_endian::Load32(fixed.data() + 4) != kRecordVersion) {
+    return std::nullopt;
+  }
+  return uint64_t{kFixedHeaderSize} +
+         absl::little_endian::Load32(fixed.data() + 41) +
+         absl::little_endian::Load32(fixed.data() + 45);
+}
+
+/// Decodes a record.
+///
+/// \param encoded The record, or, if `header_only == true`, a prefix of the
+///     record that contains at least the header.
+/// \param header_only If `true`, `Record::value` is not set.
+/// \returns The decoded record, or `std::nullopt` if `encoded` is not a valid
+///     record.
+std::optional<Record> DecodeRecord(const absl::Cord& encoded,
+                                   bool header_only) {
+  auto header_size = DecodeHeaderSize(encoded);
+  if (!header_size || encoded.size() < *header_size) return std::nullopt;
+  const std::string fixed_str(encoded.Subcord(0, kFixedHeaderSize));
+  const char* fixed = fixed_str.data();
+  Record record;
+  const bool has_value = fixed[8] != 0;
+  record.byte_range.inclusive_min = absl::little_endian::Load64(fixed + 9);
+  if (uint64_t exclusive_max = absl::little_endian::Load64(fixed + 17)) {
+    record.byte_range.exclusive_max = exclusive_max - 1;
+  }
+  record.stamp.time =
+      absl::FromUnixNanos(absl::little_endian::Load64(fixed + 25));
+  record.value_size = absl::little_endian::Load64(fixed + 33);
+  record.record_size = *header_size + record.value_size;
+  if (!has_value && record.value_size != 0) return std::nullopt;
+  if (!header_only && encoded.size() != record.record_size) {
+    return std::nullopt;
+  }
+  const uint32_t key_size = absl::little_endian::Load32(fixed + 41);
+  record.key = std::string(encoded.Subcord(kFixedHeaderSize, key_size));
+  record.stamp.generation.value = std::string(encoded.Subcord(
+      kFixedHeaderSize + key_size, *header_size - kFixedHeaderSize - key_size));
+  if (!header_only && has_value) {
+    record.value = encoded.Subcord(*header_size, record.value_size);
+  }
+  return record;
+}
+
+struct DiskCacheDriverSpecData {
+  kvstore::Spec base;
+  kvstore::Spec cache;
+  uint64_t total_bytes_limit;
+  CacheEvictionPolicy eviction_policy = CacheEvictionPolicy::kLru;
+
+  constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+    return f(x.base, x.cache, x.total_bytes_limit, x.eviction_policy);
+  };
+
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member("base", jb::Projection<&DiskCacheDriverSpecData::base>()),
+      jb::Member("cache", jb::Projection<&DiskCacheDriverSpecData::cache>()),
+      jb::Initialize([](auto* obj) {
+        internal::EnsureDirectoryPath(obj->cache.path);
+        return absl::OkStatus();
+      }),
+      jb::Member("total_bytes_limit",
+                 jb::Projection<&DiskCacheDriverSpecData::total_bytes_limit>(
+                     jb::Integer<uint64_t>(1))),
+      jb::Member(
+          "eviction_policy",
+          jb::Projection<&DiskCacheDriverSpecData::eviction_policy>(
+              jb::DefaultValue(
+                  [](auto* v) { *v = CacheEvictionPolicy::kLru; },
+                  jb::Enum<CacheEvictionPolicy, std::string_view>({
+                      {CacheEvictionPolicy::kLru, "lru"},
+                      {CacheEvictionPolicy::kTinyLfu, "tinylfu"},
+                  })))));
+};
+
+class DiskCacheDriverSpec
+    : public internal_kvstore::RegisteredDriverSpec<DiskCacheDriverSpec,
+                                                    DiskCacheDriverSpecData> {
+ public:
+  static constexpr char id[] = "disk_cache";
+
+  Future<kvstore::DriverPtr> DoOpen() const override;
+
+  absl::Status ApplyOptions(kvstore::DriverSpecOptions&& options) override {
+    TENSORSTORE_RETURN_IF_ERROR(
+        data_.cache.driver.Set(kvstore::DriverSpecOptions(options)));
+    return data_.base.driver.Set(std::move(options));
+  }
+};
+
+class DiskCacheDriver
+    : public internal_kvstore::RegisteredDriver<DiskCacheDriver,
+                                                DiskCacheDriverSpec> {
+ public:
+  Future<ReadResult> Read(Key key, ReadOptions options) override;
+
+  Future<TimestampedStorageGeneration> Write(Key key,
+                                             std::optional<Value> value,
+                                             WriteOptions options) override;
+
+  Future<const void> DeleteRange(KeyRange range) override;
+
+  void ListImpl(ListOptions options,
+                AnyFlowReceiver<absl::Status, Key> receiver) override;
+
+  std::string DescribeKey(std::string_view key) override;
+
+  absl::Status GetBoundSpecData(DiskCacheDriverSpecData& spec) const;
+
+  struct LruListNode {
+    LruListNode* next;
+    LruListNode* prev;
+  };
+
+  using LruListAccessor =
+      internal::intrusive_linked_list::MemberAccessor<LruListNode>;
+
+  /// In-memory index entry for a record.
+  struct IndexEntry : public LruListNode {
+    std::string path;
+    std::string key;
+    uint64_t record_size;
+    // Time at which the record was last revalidated, which may be later than
+    // the time stored in the record.
+    absl::Time validated_time = absl::InfinitePast();
+  };
+
+  /// Initializes the index and starts scanning the existing records.
+  void Initialize();
+
+  /// Adds the records found by the initial scan to the index.
+  void AddScannedRecord(std::string path, const Record& record);
+
+  /// Marks the scan of existing records as complete.
+  void ScanComplete();
+
+  /// Returns `true` if the record at `path` may exist.
+  bool MayContainRecord(const std::string& path);
+
+  /// Records an access to the record at `path`, and returns the time at which
+  /// it was last revalidated.
+  absl::Time TouchRecord(const std::string& path);
+
+  /// Updates the revalidation time of the record at `path`.
+  void SetRecordValidatedTime(const std::string& path, absl::Time time);
+
+  /// Returns `true` if `key` was modified through this driver while the scan
+  /// of existing records was in progress, in which case any record found by
+  /// the scan may be out of date.
+  bool IsInvalidatedDuringScan(std::string_view key);
+
+  /// Stores a record for the result of reading `byte_range` of `key`, subject
+  /// to the eviction policy.
+  void MaybeStoreRecord(std::string_view key,
+                        const OptionalByteRangeRequest& byte_range,
+                        const ReadResult& read_result);
+
+  /// Removes the records for all keys in `range`.
+  void InvalidateRange(const KeyRange& range);
+
+  /// Removes `entry` from the index and deletes its record.
+  void RemoveEntry(IndexEntry* entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Writes the record at `path` to `cache_`.
+  ///
+  /// Writes and deletes of the same record are applied in the order in which
+  /// they are issued, since otherwise a delete that completes before an earlier
+  /// write would leave an orphaned record that is re-indexed by the next scan.
+  void IssueRecordWrite(const std::string& path, absl::Cord encoded)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Deletes the record at `path` from `cache_`, ordered with respect to other
+  /// writes and deletes of the same record as for `IssueRecordWrite`.
+  void IssueRecordDelete(const std::string& path)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Issues `op` once the operations previously issued for `path` have
+  /// completed.
+  void SequenceRecordOperation(
+      const std::string& path,
+      absl::AnyInvocable<Future<TimestampedStorageGeneration>() &&> op)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  kvstore::KvStore base_;
+  kvstore::KvStore cache_;
+  uint64_t total_bytes_limit_;
+  CacheEvictionPolicy eviction_policy_;
+
+  absl::Mutex mutex_;
+
+  // Records in the cache, keyed by path.
+  absl::flat_hash_map<std::string_view, std::unique_ptr<IndexEntry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Records in the cache, keyed by the key that was read.
+  absl::btree_multimap<std::string_view, IndexEntry*> entries_by_key_
+      ABSL_GUARDED_BY(mutex_);
+
+  // next points to the least-recently used record.
+  LruListNode lru_queue_ ABSL_GUARDED_BY(mutex_);
+
+  uint64_t total_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Set once all existing records have been added to the index.  Until then,
+  // records that are not in the index may nonetheless exist.
+  bool scan_complete_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Key ranges modified through this driver before `scan_complete_` was set.
+  std::vector<KeyRange> invalidated_during_scan_ ABSL_GUARDED_BY(mutex_);
+
+  // Access frequencies used by `CacheEvictionPolicy::kTinyLfu`.
+  std::unique_ptr<internal_cache::FrequencySketch> frequency_sketch_;
+
+  // Most recently issued write or delete of each record path.  Entries whose
+  // operation has completed are pruned lazily.
+  absl::flat_hash_map<std::string, Future<TimestampedStorageGeneration>>
+      pending_record_ops_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal_disk_cache
+
+namespace garbage_collection {
+template <>
+struct GarbageCollection<internal_disk_cache::DiskCacheDriver> {
+  static void Visit(GarbageCollectionVisitor& visitor,
+                    const internal_disk_cache::DiskCacheDriver& value) {
+    garbage_collection::GarbageCollectionVisit(visitor, value.base_);
+    garbage_collection::GarbageCollectionVisit(visitor, value.cache_);
+  }
+};
+}  // namespace garbage_collection
+
+namespace internal_disk_cache {
+namespace {
+
+using DriverPtr = internal::IntrusivePtr<DiskCacheDriver>;
+
+/// Returns the result of a read of the cached `record`, subject to the
+/// conditions in `options`.
+Result<ReadResult> ReadFromRecord(Record&& record,
+                                  const kvstore::ReadOptions& options) {
+  ReadResult result;
+  result.stamp = std::move(record.stamp);
+  if (options.if_not_equal == result.stamp.generation ||
+      (!StorageGeneration::IsUnknown(options.if_equal) &&
+       options.if_equal != result.stamp.generation)) {
+    return result;
+  }
+  if (!record.value) {
+    result.state = ReadResult::kMissing;
+    return result;
+  }
+  result.state = ReadResult::kValue;
+  if (IsFullRange(record.byte_range)) {
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto byte_range, options.byte_range.Validate(record.value->size()));
+    result.value = internal::GetSubCord(*record.value, byte_range);
+  } else {
+    result.value = std::move(*record.value);
+  }
+  return result;
+}
+
+/// State of a single `DiskCacheDriver::Read` operation.
+struct ReadOperation : public internal::AtomicReferenceCount<ReadOperation> {
+  DriverPtr driver;
+  kvstore::Key key;
+  kvstore::ReadOptions options;
+  Promise<ReadResult> promise;
+
+  // Byte ranges of the records that may satisfy the read, in order of
+  // preference.
+  std::vector<OptionalByteRangeRequest> candidate_ranges;
+  size_t next_candidate = 0;
+
+  /// Attempts to read the next candidate record, or the base kvstore if there
+  /// are no remaining candidates.
+  static void ReadNextRecord(internal::IntrusivePtr<ReadOperation> self);
+
+  /// Called when a candidate record has been read.
+  static void OnRecordRead(internal::IntrusivePtr<ReadOperation> self,
+                           std::string path, Record record);
+
+  /// Reads from the base kvstore.
+  static void ReadFromBase(internal::IntrusivePtr<ReadOperation> self);
+};
+
+void ReadOperation::ReadNextRecord(internal::IntrusivePtr<ReadOperation> self) {
+  while (self->next_candidate < self->candidate_ranges.size()) {
+    if (!self->promise.result_needed()) return;
+    auto byte_range = self->candidate_ranges[self->next_candidate++];
+    std::string path = GetRecordPath(self->key, byte_range);
+    if (!self->driver->MayContainRecord(path)) continue;
+    auto future = kvstore::Read(self->driver->cache_, path);
+    future.ExecuteWhenReady(
+        [self = std::move(self), path = std::move(path)](
+            ReadyFuture<ReadResult> future) mutable {
+          auto& r = future.result();
+          if (r.ok() && r->has_value()) {
+            if (auto record = DecodeRecord(r->value, /*header_only=*/false);
+                record && record->key == self->key &&
+                !self->driver->IsInvalidatedDuringScan(self->key)) {
+              OnRecordRead(std::move(self), std::move(path),
+                           *std::move(record));
+              return;
+            }
+          }
+          // Errors reading from the cache are treated as misses.
+          ReadNextRecord(std::move(self));
+        });
+    return;
+  }
+  disk_cache_miss.Increment();
+  ReadFromBase(std::move(self));
+}
+
+void ReadOperation::OnRecordRead(internal::IntrusivePtr<ReadOperation> self,
+                                 std::string path, Record record) {
+  auto& driver = *self->driver;
+  record.stamp.time =
+      std::max(record.stamp.time, driver.TouchRecord(path));
+  if (record.stamp.time >= self->options.staleness_bound) {
+    disk_cache_hit.Increment();
+    self->promise.SetResult(ReadFromRecord(std::move(record), self->options));
+    return;
+  }
+
+  // Revalidate the record using a conditional read.
+  disk_cache_revalidate.Increment();
+  kvstore::ReadOptions base_options;
+  base_options.if_not_equal = record.stamp.generation;
+  base_options.staleness_bound = self->options.staleness_bound;
+  base_options.byte_range = record.byte_range;
+  auto future = kvstore::Read(driver.base_, self->key, std::move(base_options));
+  auto promise = self->promise;
+  LinkValue(
+      [self = std::move(self), path = std::move(path),
+       record = std::move(record)](Promise<ReadResult> promise,
+                                   ReadyFuture<ReadResult> future) mutable {
+        auto& read_result = future.value();
+        if (read_result.aborted()) {
+          // The cached value is still current.
+          self->driver->SetRecordValidatedTime(path, read_result.stamp.time);
+          record.stamp.time = read_result.stamp.time;
+        } else {
+          self->driver->MaybeStoreRecord(
+              self->key,
+              read_result.has_value() ? record.byte_range
+                                      : OptionalByteRangeRequest{},
+              read_result);
+          record.stamp = read_result.stamp;
+          record.value = read_result.optional_value();
+        }
+        promise.SetResult(ReadFromRecord(std::move(record), self->options));
+      },
+      std::move(promise), std::move(future));
+}
+
+void ReadOperation::ReadFromBase(internal::IntrusivePtr<ReadOperation> self) {
+  auto future = kvstore::Read(self->driver->base_, self->key, self->options);
+  auto promise = self->promise;
+  LinkValue(
+      [self = std::move(self)](Promise<ReadResult> promise,
+                               ReadyFuture<ReadResult> future) {
+        auto& read_result = future.value();
+        if (!read_result.aborted()) {
+          // A missing key is recorded as a missing full value, regardless of
+          // the requested byte range.
+          self->driver->MaybeStoreRecord(
+              self->key,
+              read_result.has_value() ? self->options.byte_range
+                                      : OptionalByteRangeRequest{},
+              read_result);
+        }
+        promise.SetResult(std::move(read_result));
+      },
+      std::move(promise), std::move(future));
+}
+
+/// Receives the keys of the existing records when the driver is opened.
+struct ScanReceiver {
+  DriverPtr driver;
+  // Outstanding header reads, plus one for the list operation.
+  std::shared_ptr<std::atomic<size_t>> pending;
+
+  void Done() {
+    if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      driver->ScanComplete();
+    }
+  }
+
+  /// Reads the fixed-size portion of the header of the record at `path`, and
+  /// then the remainder of the header.
+  void ReadRecordHeader(std::string path) {
+    kvstore::ReadOptions options;
+    options.byte_range.exclusive_max = kFixedHeaderSize;
+    auto future = kvstore::Read(driver->cache_, path, std::move(options));
+    future.ExecuteWhenReady([self = *this, path = std::move(path)](
+                                ReadyFuture<ReadResult> future) mutable {
+      auto& r = future.result();
+      if (!r.ok() || !r->has_value()) {
+        // The record was concurrently deleted, or could not be read.
+        self.Done();
+        return;
+      }
+      auto header_size = DecodeHeaderSize(r->value);
+      if (!header_size) {
+        self.InvalidRecord(std::move(path));
+        return;
+      }
+      kvstore::ReadOptions options;
+      options.byte_range.exclusive_max = *header_size;
+      auto header_future =
+          kvstore::Read(self.driver->cache_, path, std::move(options));
+      header_future.ExecuteWhenReady(
+          [self = std::move(self),
+           path = std::move(path)](ReadyFuture<ReadResult> future) mutable {
+            auto& r = future.result();
+            if (!r.ok() || !r->has_value()) {
+              self.Done();
+              return;
+            }
+            auto record = DecodeRecord(r->value, /*header_only=*/true);
+            if (!record) {
+              self.InvalidRecord(std::move(path));
+              return;
+            }
+            self.driver->AddScannedRecord(std::move(path), *record);
+            self.Done();
+          });
+    });
+  }
+
+  void InvalidRecord(std::string path) {
+    {
+      absl::MutexLock lock(&driver->mutex_);
+      driver->IssueRecordDelete(path);
+    }
+    Done();
+  }
+
+  void set_starting(AnyCancelReceiver cancel) {}
+  void set_value(kvstore::Key path) {
+    pending->fetch_add(1, std::memory_order_relaxed);
+    ReadRecordHeader(std::move(path));
+  }
+  void set_done() {}
+  void set_error(absl::Status error) {}
+  void set_stopping() { Done(); }
+};
+
+}  // namespace
+
+Future<kvstore::DriverPtr> DiskCacheDriverSpec::DoOpen() const {
+  return MapFutureValue(
+      InlineExecutor{},
+      [spec = internal::IntrusivePtr<const DiskCacheDriverSpec>(this)](
+          kvstore::KvStore& base, kvstore::KvStore& cache)
+          -> Result<kvstore::DriverPtr> {
+        auto driver = internal::MakeIntrusivePtr<DiskCacheDriver>();
+        driver->base_ = std::move(base);
+        driver->cache_ = std::move(cache);
+        driver->total_bytes_limit_ = spec->data_.total_bytes_limit;
+        driver->eviction_policy_ = spec->data_.eviction_policy;
+        driver->Initialize();
+        return driver;
+      },
+      kvstore::Open(data_.base), kvstore::Open(data_.cache));
+}
+
+absl::Status DiskCacheDriver::GetBoundSpecData(
+    DiskCacheDriverSpecData& spec) const {
+  TENSORSTORE_ASSIGN_OR_RETURN(spec.base.driver, base_.driver->GetBoundSpec());
+  spec.base.path = base_.path;
+  TENSORSTORE_ASSIGN_OR_RETURN(spec.cache.driver,
+                               cache_.driver->GetBoundSpec());
+  spec.cache.path = cache_.path;
+  spec.total_bytes_limit = total_bytes_limit_;
+  spec.eviction_policy = eviction_policy_;
+  return absl::OkStatus();
+}
+
+void DiskCacheDriver::Initialize() {
+  internal::intrusive_linked_list::Initialize(LruListAccessor{}, &lru_queue_);
+  if (eviction_policy_ == CacheEvictionPolicy::kTinyLfu) {
+    frequency_sketch_ = std::make_unique<internal_cache::FrequencySketch>(
+        std::max<uint64_t>(total_bytes_limit_ / kTinyLfuRecordSizeEstimate,
+                           1024));
+  }
+  kvstore::List(cache_, {},
+                ScanReceiver{DriverPtr(this),
+                             std::make_shared<std::atomic<size_t>>(1)});
+}
+
+void DiskCacheDriver::AddScannedRecord(std::string path, const Record& record) {
+  absl::MutexLock lock(&mutex_);
+  if (entries_.contains(path)) return;
+  for (const auto& range : invalidated_during_scan_) {
+    if (Contains(range, record.key)) {
+      IssueRecordDelete(path);
+      return;
+    }
+  }
+  auto entry = std::make_unique<IndexEntry>();
+  entry->path = std::move(path);
+  entry->key = record.key;
+  entry->record_size = record.record_size;
+  internal::intrusive_linked_list::InsertBefore(LruListAccessor{}, &lru_queue_,
+                                                entry.get());
+  total_bytes_ += entry->record_size;
+  entries_by_key_.emplace(entry->key, entry.get());
+  std::string_view entry_path = entry->path;
+  entries_.emplace(entry_path, std::move(entry));
+  while (total_bytes_ > total_bytes_limit_) {
+    disk_cache_evict.Increment();
+    RemoveEntry(static_cast<IndexEntry*>(lru_queue_.next));
+  }
+}
+
+void DiskCacheDriver::ScanComplete() {
+  absl::MutexLock lock(&mutex_);
+  scan_complete_ = true;
+  invalidated_during_scan_.clear();
+}
+
+bool DiskCacheDriver::MayContainRecord(const std::string& path) {
+  absl::MutexLock lock(&mutex_);
+  return !scan_complete_ || entries_.contains(path);
+}
+
+absl::Time DiskCacheDriver::TouchRecord(const std::string& path) {
+  if (frequency_sketch_) {
+    frequency_sketch_->Increment(absl::HashOf(path));
+  }
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(path);
+  if (it == entries_.end()) return absl::InfinitePast();
+  IndexEntry* entry = it->second.get();
+  internal::intrusive_linked_list::Remove(LruListAccessor{}, entry);
+  internal::intrusive_linked_list::InsertBefore(LruListAccessor{}, &lru_queue_,
+                                                entry);
+  return entry->validated_time;
+}
+
+void DiskCacheDriver::SetRecordValidatedTime(const std::string& path,
+                                             absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(path);
+  if (it == entries_.end()) return;
+  it->second->validated_time = std::max(it->second->validated_time, time);
+}
+
+bool DiskCacheDriver::IsInvalidatedDuringScan(std::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& range : invalidated_during_scan_) {
+    if (Contains(range, key)) return true;
+  }
+  return false;
+}
+
+void DiskCacheDriver::MaybeStoreRecord(
+    std::string_view key, const OptionalByteRangeRequest& byte_range,
+    const ReadResult& read_result) {
+  if (StorageGeneration::IsUnknown(read_result.stamp.generation) ||
+      StorageGeneration::IsDirty(read_result.stamp.generation)) {
+    return;
+  }
+  std::string path = GetRecordPath(key, byte_range);
+  absl::Cord encoded = EncodeRecord(key, byte_range, read_result.stamp,
+                                    read_result.optional_value());
+  const uint64_t record_size = encoded.size();
+  if (record_size > total_bytes_limit_) return;
+  const uint64_t path_hash = absl::HashOf(path);
+  if (frequency_sketch_) {
+    frequency_sketch_->Increment(path_hash);
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = entries_.find(path); it != entries_.end()) {
+      RemoveEntry(it->second.get());
+    }
+    // Determine the records that must be evicted to make room.
+    uint64_t available = total_bytes_limit_ - total_bytes_;
+    std::vector<IndexEntry*> victims;
+    for (LruListNode* node = lru_queue_.next;
+         available < record_size && node != &lru_queue_; node = node->next) {
+      auto* victim = static_cast<IndexEntry*>(node);
+      if (frequency_sketch_ &&
+          frequency_sketch_->Estimate(path_hash) <=
+              frequency_sketch_->Estimate(absl::HashOf(victim->path))) {
+        // Not admitted, since the new record is not accessed more frequently
+        // than the record that it would replace.
+        return;
+      }
+      victims.push_back(victim);
+      available += victim->record_size;
+    }
+    for (auto* victim : victims) {
+      disk_cache_evict.Increment();
+      RemoveEntry(victim);
+    }
+    auto entry = std::make_unique<IndexEntry>();
+    entry->path = path;
+    entry->key = std::string(key);
+    entry->record_size = record_size;
+    internal::intrusive_linked_list::InsertBefore(LruListAccessor{},
+                                                  &lru_queue_, entry.get());
+    total_bytes_ += record_size;
+    entries_by_key_.emplace(entry->key, entry.get());
+    std::string_view entry_path = entry->path;
+    entries_.emplace(entry_path, std::move(entry));
+    // Errors writing to the cache are ignored; a record that was not written
+    // is treated as a cache miss.
+    IssueRecordWrite(path, std::move(encoded));
+  }
+}
+
+void DiskCacheDriver::InvalidateRange(const KeyRange& range) {
+  absl::MutexLock lock(&mutex_);
+  if (!scan_complete_) {
+    invalidated_during_scan_.push_back(range);
+  }
+  auto it = entries_by_key_.lower_bound(range.inclusive_min);
+  while (it != entries_by_key_.end() &&
+         (range.exclusive_max.empty() || it->first < range.exclusive_max)) {
+    IndexEntry* entry = (it++)->second;
+    RemoveEntry(entry);
+  }
+}
+
+void DiskCacheDriver::RemoveEntry(IndexEntry* entry) {
+  internal::intrusive_linked_list::Remove(LruListAccessor{}, entry);
+  total_bytes_ -= entry->record_size;
+  for (auto [it, end] = entries_by_key_.equal_range(entry->key); it != end;
+       ++it) {
+    if (it->second == entry) {
+      entries_by_key_.erase(it);
+      break;
+    }
+  }
+  IssueRecordDelete(entry->path);
+  // Erasing the map entry destroys `entry`, which owns the path.
+  entries_.erase(entries_.find(std::string_view(entry->path)));
+}
+
+void DiskCacheDriver::IssueRecordWrite(const std::string& path,
+                                       absl::Cord encoded) {
+  SequenceRecordOperation(
+      path, [cache = cache_, path, encoded = std::move(encoded)]() mutable {
+        return kvstore::Write(cache, path, std::move(encoded));
+      });
+}
+
+void DiskCacheDriver::IssueRecordDelete(const std::string& path) {
+  SequenceRecordOperation(path, [cache = cache_, path]() mutable {
+    return kvstore::Delete(cache, path);
+  });
+}
+
+void DiskCacheDriver::SequenceRecordOperation(
+    const std::string& path,
+    absl::AnyInvocable<Future<TimestampedStorageGeneration>() &&> op) {
+  if (pending_record_ops_.size() > 2 * entries_.size() + 64) {
+    absl::erase_if(pending_record_ops_,
+                   [](const auto& p) { return p.second.ready(); });
+  }
+  auto& pending = pending_record_ops_[path];
+  if (pending.null() || pending.ready()) {
+    pending = std::move(op)();
+    return;
+  }
+  // Errors are ignored, as for unsequenced operations: the next operation is
+  // issued once the previous one completes, whether or not it succeeded.
+  auto [promise, future] =
+      PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  pending.ExecuteWhenReady(
+      [op = std::move(op), promise = std::move(promise)](
+          ReadyFuture<TimestampedStorageGeneration>) mutable {
+        LinkResult(std::move(promise), std::move(op)());
+      });
+  pending = std::move(future);
+}
+
+Future<ReadResult> DiskCacheDriver::Read(Key key, ReadOptions options) {
+  auto op = internal::MakeIntrusivePtr<ReadOperation>();
+  op->driver = DriverPtr(this);
+  // A cached full value can satisfy any byte range.
+  op->candidate_ranges.push_back(OptionalByteRangeRequest{});
+  if (!IsFullRange(options.byte_range)) {
+    op->candidate_ranges.push_back(options.byte_range);
+  }
+  op->key = std::move(key);
+  op->options = std::move(options);
+  auto [promise, future] = PromiseFuturePair<ReadResult>::Make();
+  op->promise = std::move(promise);
+  ReadOperation::ReadNextRecord(std::move(op));
+  return std::move(future);
+}
+
+Future<TimestampedStorageGeneration> DiskCacheDriver::Write(
+    Key key, std::optional<Value> value, WriteOptions options) {
+  auto future =
+      kvstore::Write(base_, key, std::move(value), std::move(options));
+  // Invalidate any cached value both before and after the write, so that reads
+  // that complete concurrently with the write do not leave an outdated value
+  // in the cache.
+  InvalidateRange(KeyRange(key, KeyRange::Successor(key)));
+  future.ExecuteWhenReady(
+      [self = DriverPtr(this), key = std::move(key)](
+          ReadyFuture<TimestampedStorageGeneration>) {
+        self->InvalidateRange(KeyRange(key, KeyRange::Successor(key)));
+      });
+  return future;
+}
+
+Future<const void> DiskCacheDriver::DeleteRange(KeyRange range) {
+  auto future = kvstore::DeleteRange(base_, range);
+  InvalidateRange(range);
+  future.ExecuteWhenReady(
+      [self = DriverPtr(this), range = std::move(range)](
+          ReadyFuture<const void>) { self->InvalidateRange(range); });
+  return future;
+}
+
+void DiskCacheDriver::ListImpl(ListOptions options,
+                               AnyFlowReceiver<absl::Status, Key> receiver) {
+  kvstore::List(base_, std::move(options), std::move(receiver));
+}
+
+std::string DiskCacheDriver::DescribeKey(std::string_view key) {
+  return base_.driver->DescribeKey(tensorstore::StrCat(base_.path, key));
+}
+
+}  // namespace internal_disk_cache
+}  // namespace tensorstore
+
+// Registers the driver.
+namespace {
+const tensorstore::internal_kvstore::DriverRegistration<
+    tensorstore::internal_disk_cache::DiskCacheDriverSpec>
+    registration;
+}  // namespace
@@ -0,0 +1,252 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/context.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/memory/memory_key_value_store.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/execution/execution.h"
+#include "tensorstore/util/execution/sender_util.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::Context;
+using ::tensorstore::KvStore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal::MockKeyValueStoreResource;
+
+::nlohmann::json GetSpec(uint64_t total_bytes_limit = 1000000) {
+  return {{"driver", "disk_cache"},
+          {"base", "memory://base/"},
+          {"cache", "memory://cache/"},
+          {"total_bytes_limit", total_bytes_limit}};
+}
+
+/// Returns a read of `key` that is satisfied by a cached value, if any,
+/// regardless of its age.
+kvstore::ReadOptions CachedReadOptions() {
+  kvstore::ReadOptions options;
+  options.staleness_bound = absl::InfinitePast();
+  return options;
+}
+
+TEST(DiskCacheKeyValueStoreTest, Basic) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(GetSpec(), context).result());
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+}
+
+TEST(DiskCacheKeyValueStoreTest, SpecRoundtrip) {
+  tensorstore::internal::KeyValueStoreSpecRoundtripOptions options;
+  options.full_spec = {{"driver", "disk_cache"},
+                       {"base", {{"driver", "memory"}, {"path", "base/"}}},
+                       {"cache", {{"driver", "memory"}, {"path", "cache/"}}},
+                       {"total_bytes_limit", 1000000},
+                       {"eviction_policy", "tinylfu"}};
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(options);
+}
+
+TEST(DiskCacheKeyValueStoreTest, InvalidSpec) {
+  auto context = Context::Default();
+  EXPECT_THAT(kvstore::Open({{"driver", "disk_cache"},
+                             {"base", "memory://base/"},
+                             {"cache", "memory://cache/"}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+  auto spec = GetSpec();
+  spec["eviction_policy"] = "clock";
+  EXPECT_THAT(kvstore::Open(spec, context).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(DiskCacheKeyValueStoreTest, ReadFromCache) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(GetSpec(), context).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, kvstore::Open("memory://base/", context).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  EXPECT_THAT(kvstore::Read(store, "b").result(),
+              MatchesKvsReadResultNotFound());
+
+  // Modify the base kvstore directly, bypassing the cache.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("def")));
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "b", absl::Cord("ghi")));
+
+  // Cached values are returned if permitted by the staleness bound.
+  EXPECT_THAT(kvstore::Read(store, "a", CachedReadOptions()).result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  EXPECT_THAT(kvstore::Read(store, "b", CachedReadOptions()).result(),
+              MatchesKvsReadResultNotFound());
+  {
+    auto options = CachedReadOptions();
+    options.byte_range.inclusive_min = 1;
+    EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+                MatchesKvsReadResult(absl::Cord("bc")));
+  }
+
+  // Otherwise, the cached values are revalidated.
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("def")));
+  EXPECT_THAT(kvstore::Read(store, "b").result(),
+              MatchesKvsReadResult(absl::Cord("ghi")));
+  EXPECT_THAT(kvstore::Read(store, "a", CachedReadOptions()).result(),
+              MatchesKvsReadResult(absl::Cord("def")));
+}
+
+TEST(DiskCacheKeyValueStoreTest, ReadByteRange) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(GetSpec(), context).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, kvstore::Open("memory://base/", context).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abcdef")));
+  kvstore::ReadOptions options;
+  options.byte_range.inclusive_min = 1;
+  options.byte_range.exclusive_max = 3;
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("bc")));
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(base, "a"));
+  options.staleness_bound = absl::InfinitePast();
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("bc")));
+}
+
+TEST(DiskCacheKeyValueStoreTest, WriteInvalidates) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(GetSpec(), context).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a", absl::Cord("abc")));
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a", absl::Cord("def")));
+  EXPECT_THAT(kvstore::Read(store, "a", CachedReadOptions()).result(),
+              MatchesKvsReadResult(absl::Cord("def")));
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(store, "a"));
+  EXPECT_THAT(kvstore::Read(store, "a", CachedReadOptions()).result(),
+              MatchesKvsReadResultNotFound());
+}
+
+TEST(DiskCacheKeyValueStoreTest, Eviction) {
+  constexpr uint64_t kTotalBytesLimit = 1000;
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open(GetSpec(kTotalBytesLimit), context).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, kvstore::Open("memory://base/", context).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto cache, kvstore::Open("memory://cache/", context).result());
+  for (int i = 0; i < 10; ++i) {
+    std::string key = "key" + std::to_string(i);
+    TENSORSTORE_ASSERT_OK(
+        kvstore::Write(base, key, absl::Cord(std::string(300, 'x'))));
+    TENSORSTORE_ASSERT_OK(kvstore::Read(store, key).result());
+  }
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto records,
+                                   kvstore::ListFuture(cache).result());
+  EXPECT_THAT(records, ::testing::SizeIs(::testing::AllOf(::testing::Ge(1),
+                                                          ::testing::Le(3))));
+  uint64_t total_bytes = 0;
+  for (const auto& path : records) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto r,
+                                     kvstore::Read(cache, path).result());
+    total_bytes += r.value.size();
+  }
+  EXPECT_LE(total_bytes, kTotalBytesLimit);
+
+  // The most recently read key remains cached.
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(base, "key9"));
+  EXPECT_THAT(kvstore::Read(store, "key9", CachedReadOptions()).result(),
+              MatchesKvsReadResult(absl::Cord(std::string(300, 'x'))));
+}
+
+TEST(DiskCacheKeyValueStoreTest, Reopen) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, kvstore::Open("memory://base/", context).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto store, kvstore::Open(GetSpec(), context).result());
+    EXPECT_THAT(kvstore::Read(store, "a").result(),
+                MatchesKvsReadResult(absl::Cord("abc")));
+  }
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("def")));
+
+  // A driver with a different spec does not share the in-memory index, but
+  // finds the existing records.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open(GetSpec(2000000), context).result());
+  EXPECT_THAT(kvstore::Read(store, "a", CachedReadOptions()).result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+}
+
+// Tests that deleting a record waits for a pending write of the same record,
+// since otherwise the write could recreate the record after it is deleted.
+TEST(DiskCacheKeyValueStoreTest, DeleteOrderedAfterPendingWrite) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto mock_cache, context.GetResource<MockKeyValueStoreResource>());
+  auto cache_target = tensorstore::GetMemoryKeyValueStore();
+  auto spec = GetSpec();
+  spec["cache"] = {{"driver", "mock_key_value_store"}};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(spec, context).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, kvstore::Open("memory://base/", context).result());
+  {
+    // Complete the initial scan of existing records.
+    auto list_request = (*mock_cache)->list_requests.pop();
+    tensorstore::execution::submit(cache_target->List(list_request.options),
+                                   std::move(list_request.receiver));
+  }
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  auto record_write = (*mock_cache)->write_requests.pop();
+  ASSERT_TRUE(record_write.value);
+
+  // Invalidates the record while its write is still pending.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a", absl::Cord("def")));
+  EXPECT_TRUE((*mock_cache)->write_requests.empty());
+
+  record_write(cache_target);
+  auto record_delete = (*mock_cache)->write_requests.pop();
+  EXPECT_EQ(record_write.key, record_delete.key);
+  EXPECT_FALSE(record_delete.value);
+  record_delete(cache_target);
+  EXPECT_THAT(kvstore::ListFuture(cache_target.get()).result(),
+              ::testing::Optional(::testing::IsEmpty()));
+}
+
+}  // namespace
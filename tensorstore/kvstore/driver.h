@@ -15,6 +15,9 @@
 #ifndef TENSORSTORE_KVSTORE_DRIVER_H_
 #define TENSORSTORE_KVSTORE_DRIVER_H_
 
+#include <cstdint>
+#include <string>
+
 #include "absl/status/status.h"
 #include "tensorstore/internal/context_binding.h"
 #include "tensorstore/internal/intrusive_ptr.h"
@@ -107,6 +110,18 @@ class DriverSpec : public internal::AtomicReferenceCount<DriverSpec> {
   ContextBindingState context_binding_state_ = ContextBindingState::unknown;
 };
 
+/// Handle to a value written by `Driver::StageWrite` that has not yet been
+/// committed.
+///
+/// The interpretation of the members is driver-specific.
+struct StagedWrite {
+  /// Identifies the temporary storage holding the staged value.
+  std::string location;
+
+  /// Size of the staged value in bytes.
+  uint64_t size = 0;
+};
+
 /// Abstract base class representing a key-value store.
 ///
 /// Support for different storage systems is provided by individual key-value
@@ -213,6 +228,45 @@ class Driver {
   ///     either successfully or with an error.
   virtual Future<const void> DeleteRange(KeyRange range);
 
+  /// Writes `value` to temporary storage without modifying the value stored
+  /// for `key`.
+  ///
+  /// This is used by `internal_kvstore::NonAtomicTransactionNode` to release
+  /// the memory held by large transactions before they are committed.  The
+  /// staged value must subsequently be either committed by
+  /// `CommitStagedWrite` or released by `DiscardStagedWrite`.  Staged values
+  /// are not visible to `Read` or `List`.
+  ///
+  /// The default implementation fails with `absl::StatusCode::kUnimplemented`,
+  /// which indicates that staging is not supported.  Currently only the file
+  /// driver implements staging.
+  ///
+  /// \param key The key to which the value will be committed.
+  /// \param value The value to stage.
+  virtual Future<StagedWrite> StageWrite(Key key, Value value);
+
+  /// Reads back a value written by `StageWrite`.
+  ///
+  /// The returned `ReadResult::stamp` is unspecified.
+  virtual Future<ReadResult> ReadStagedWrite(const StagedWrite& staged);
+
+  /// Makes a value written by `StageWrite` the value of `key`, subject to the
+  /// conditions in `options`.
+  ///
+  /// If the condition is not satisfied, the staged value remains valid and
+  /// the returned future resolves to `StorageGeneration::Unknown()`, as for
+  /// `Write`.  On success, the staged value is consumed and must not be
+  /// discarded.
+  virtual Future<TimestampedStorageGeneration> CommitStagedWrite(
+      Key key, const StagedWrite& staged, WriteOptions options = {});
+
+  /// Releases a value written by `StageWrite` that was not committed.
+  ///
+  /// \returns A future that becomes ready once the staged value has been
+  ///     released, or with an error if it could not be released.  Discarding
+  ///     a staged value that no longer exists succeeds.
+  virtual Future<const void> DiscardStagedWrite(const StagedWrite& staged);
+
   /// Implementation of `List` that driver implementations must define.
   virtual void ListImpl(ListOptions options,
                         AnyFlowReceiver<absl::Status, Key> receiver);
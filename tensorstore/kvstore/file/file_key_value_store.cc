@@ -80,10 +80,26 @@
 /// 8. `fsync` the parent directory of the file (to ensure the `unlink` or
 ///    `rename` operations are durable).  This step is skipped on MS Windows,
 ///    where `fsync` is not supported for directories.
+///
+/// If the `file_io_engine` context resource selects io_uring (Linux only),
+/// steps 6b, 6c and 8 of normal writes, as well as the data transfer of reads,
+/// are submitted to an `IoUringEngine` rather than performed synchronously on
+/// a `file_io_concurrency` thread.  The lock is still held until step 8
+/// completes.
+///
+/// The `file_io_sync` context resource controls steps 6b and 8.  In
+/// `"group_commit"` mode, concurrent writes to the same directory share a single
+/// `syncfs` (Linux only; elsewhere each lock file is still `fsync`ed
+/// individually) in place of step 6b, and a single directory `fsync` in step 8.
+/// Since `syncfs` flushes every lock file in the batch before any of them is
+/// renamed, a crash can never expose a partially-written value.  In `"none"`
+/// mode, steps 6b and 8 are skipped.  io_uring is not used for writes in
+/// `"group_commit"` mode, since waiting for a batch blocks the thread anyway.
 
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
@@ -95,10 +111,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/functional/function_ref.h"
+#include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include <nlohmann/json.hpp>
 #include "tensorstore/context.h"
@@ -111,7 +131,11 @@
 #include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/os_error_code.h"
 #include "tensorstore/internal/path.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/file/file_resource.h"
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+#include "tensorstore/kvstore/file/sync_batcher.h"
 #include "tensorstore/kvstore/file/unique_handle.h"
 #include "tensorstore/kvstore/file/util.h"
 #include "tensorstore/kvstore/generation.h"
@@ -163,7 +187,10 @@ using ::tensorstore::internal::OsErrorCode;
 using ::tensorstore::internal::StatusFromOsError;
 using ::tensorstore::internal_file_util::FileDescriptor;
 using ::tensorstore::internal_file_util::FileInfo;
+using ::tensorstore::internal_file_util::FileIoEngineResource;
+using ::tensorstore::internal_file_util::FileIoSyncResource;
 using ::tensorstore::internal_file_util::GetFileInfo;
+using ::tensorstore::internal_file_util::IoUringEngine;
 using ::tensorstore::internal_file_util::IsKeyValid;
 using ::tensorstore::internal_file_util::kLockSuffix;
 using ::tensorstore::internal_file_util::LongestDirectoryPrefix;
@@ -174,6 +201,10 @@ auto& file_bytes_read = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/file/bytes_read",
     "Bytes read by the file kvstore driver");
 
+auto& file_bytes_mapped = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/bytes_mapped",
+    "Bytes memory-mapped rather than read by the file kvstore driver");
+
 auto& file_bytes_written = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/file/bytes_written",
     "Bytes written by the file kvstore driver");
@@ -197,9 +228,11 @@ auto& file_lock_contention = internal_metrics::Counter<int64_t>::New(
 
 struct FileKeyValueStoreSpecData {
   Context::Resource<internal::FileIoConcurrencyResource> file_io_concurrency;
+  Context::Resource<FileIoEngineResource> file_io_engine;
+  Context::Resource<FileIoSyncResource> file_io_sync;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(x.file_io_concurrency);
+    return f(x.file_io_concurrency, x.file_io_engine, x.file_io_sync);
   };
 
   // TODO(jbms): Storing a UNIX path as a JSON string presents a challenge
@@ -217,9 +250,15 @@ struct FileKeyValueStoreSpecData {
   // including base64-encoding, or using NUL as an escape sequence (taking
   // advantage of the fact that valid paths on all operating systems
   // cannot contain NUL characters).
-  constexpr static auto default_json_binder = jb::Object(jb::Member(
-      internal::FileIoConcurrencyResource::id,
-      jb::Projection<&FileKeyValueStoreSpecData::file_io_concurrency>()));
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member(
+          internal::FileIoConcurrencyResource::id,
+          jb::Projection<&FileKeyValueStoreSpecData::file_io_concurrency>()),
+      jb::Member(
+          FileIoEngineResource::id,
+          jb::Projection<&FileKeyValueStoreSpecData::file_io_engine>()),
+      jb::Member(FileIoSyncResource::id,
+                 jb::Projection<&FileKeyValueStoreSpecData::file_io_sync>()));
 };
 
 class FileKeyValueStoreSpec
@@ -247,11 +286,30 @@ class FileKeyValueStore
 
   Future<const void> DeleteRange(KeyRange range) override;
 
+  Future<kvstore::StagedWrite> StageWrite(Key key, Value value) override;
+
+  Future<ReadResult> ReadStagedWrite(
+      const kvstore::StagedWrite& staged) override;
+
+  Future<TimestampedStorageGeneration> CommitStagedWrite(
+      Key key, const kvstore::StagedWrite& staged,
+      WriteOptions options) override;
+
+  Future<const void> DiscardStagedWrite(
+      const kvstore::StagedWrite& staged) override;
+
   void ListImpl(ListOptions options,
                 AnyFlowReceiver<absl::Status, Key> receiver) override;
 
   const Executor& executor() { return spec_.file_io_concurrency->executor; }
 
+  /// Returns the io_uring engine, or `nullptr` if blocking I/O is used.
+  const std::shared_ptr<IoUringEngine>& io_uring() {
+    return spec_.file_io_engine->io_uring;
+  }
+
+  const FileIoSyncResource::Resource& sync() { return *spec_.file_io_sync; }
+
   std::string DescribeKey(std::string_view key) override {
     return tensorstore::StrCat("local file ", tensorstore::QuoteString(key));
   }
@@ -292,6 +350,61 @@ absl::Status StatusFromErrno(std::string_view a = {}, std::string_view b = {},
   return StatusFromOsError(GetLastErrorCode(), a, b, c, d);
 }
 
+/// Makes the contents of the (not yet renamed) lock file durable, as
+/// specified by the `file_io_sync` resource.
+absl::Status SyncLockFile(const FileIoSyncResource::Resource& sync,
+                          FileDescriptor fd, const std::string& lock_path) {
+  switch (sync.spec.mode) {
+    case FileIoSyncResource::Mode::kNone:
+      return absl::OkStatus();
+    case FileIoSyncResource::Mode::kGroupCommit:
+      if constexpr (internal_file_util::kSyncFileSystemSyncsAllFiles) {
+        // All lock files in the same directory are on the same filesystem,
+        // and are therefore all synced by a single `syncfs`.
+        return sync.data_sync->Sync(
+            internal::PathDirnameBasename(lock_path).first,
+            [&]() -> absl::Status {
+              if (!internal_file_util::SyncFileSystem(fd)) {
+                return StatusFromErrno("Error calling syncfs on file: ",
+                                       lock_path);
+              }
+              return absl::OkStatus();
+            });
+      }
+      [[fallthrough]];
+    case FileIoSyncResource::Mode::kPerWrite:
+      break;
+  }
+  if (!internal_file_util::FsyncFile(fd)) {
+    return StatusFromErrno("Error calling fsync on file: ", lock_path);
+  }
+  return absl::OkStatus();
+}
+
+/// Makes a `rename` or `unlink` within the parent directory of `full_path`
+/// durable, as specified by the `file_io_sync` resource.
+absl::Status SyncParentDirectory(const FileIoSyncResource::Resource& sync,
+                                 FileDescriptor dir_fd,
+                                 const std::string& full_path) {
+  const auto fsync_directory = [&]() -> absl::Status {
+    if (!internal_file_util::FsyncDirectory(dir_fd)) {
+      return StatusFromErrno("Error calling fsync on parent directory of: ",
+                             full_path);
+    }
+    return absl::OkStatus();
+  };
+  switch (sync.spec.mode) {
+    case FileIoSyncResource::Mode::kNone:
+      return absl::OkStatus();
+    case FileIoSyncResource::Mode::kGroupCommit:
+      return sync.directory_sync->Sync(
+          internal::PathDirnameBasename(full_path).first, fsync_directory);
+    case FileIoSyncResource::Mode::kPerWrite:
+      break;
+  }
+  return fsync_directory();
+}
+
 /// RAII lock on an open file.
 struct FileLock {
  public:
@@ -580,9 +693,15 @@ struct PathRangeVisitor {
 struct ReadTask {
   std::string full_path;
   kvstore::ReadOptions options;
+  std::optional<std::size_t> mmap_threshold;
 
-  Result<ReadResult> operator()() const {
-    ReadResult read_result;
+  /// Opens the value file and checks the read conditions.
+  ///
+  /// If the returned file descriptor is valid, `read_result.state` has been set
+  /// to `kValue` and the caller must read `byte_range` into
+  /// `read_result.value`.
+  Result<UniqueFileDescriptor> Open(ReadResult& read_result,
+                                    ByteRange& byte_range) const {
     read_result.stamp.time = absl::Now();
     std::int64_t size;
     TENSORSTORE_ASSIGN_OR_RETURN(
@@ -590,16 +709,49 @@ struct ReadTask {
         OpenValueFile(full_path.c_str(), &read_result.stamp.generation, &size));
     if (!fd.valid()) {
       read_result.state = ReadResult::kMissing;
-      return read_result;
+      return fd;
     }
     if (read_result.stamp.generation == options.if_not_equal ||
         (!StorageGeneration::IsUnknown(options.if_equal) &&
          read_result.stamp.generation != options.if_equal)) {
-      return read_result;
+      return UniqueFileDescriptor();
     }
-    TENSORSTORE_ASSIGN_OR_RETURN(auto byte_range,
-                                 options.byte_range.Validate(size));
+    TENSORSTORE_ASSIGN_OR_RETURN(byte_range, options.byte_range.Validate(size));
     read_result.state = ReadResult::kValue;
+    return fd;
+  }
+
+  /// Attempts to satisfy the read by memory-mapping `byte_range` rather than
+  /// copying it.
+  ///
+  /// \returns `true` if `read_result.value` has been set.
+  bool TryMemoryMap(FileDescriptor fd, const ByteRange& byte_range,
+                    ReadResult& read_result) const {
+    if (!mmap_threshold || byte_range.size() == 0 ||
+        static_cast<std::size_t>(byte_range.size()) < *mmap_threshold) {
+      return false;
+    }
+    // Value files are never modified in place, only replaced via `rename`, so
+    // the mapping remains consistent with `read_result.stamp.generation`.  If
+    // the file cannot be mapped, e.g. because the filesystem does not support
+    // it or the file was truncated in place by another process, fall back to
+    // copying.
+    if (!internal_file_util::MemoryMapFile(fd, byte_range.inclusive_min,
+                                           byte_range.size(),
+                                           &read_result.value)) {
+      return false;
+    }
+    file_bytes_mapped.IncrementBy(byte_range.size());
+    return true;
+  }
+
+  Result<ReadResult> operator()() const {
+    ReadResult read_result;
+    ByteRange byte_range;
+    TENSORSTORE_ASSIGN_OR_RETURN(auto fd, Open(read_result, byte_range));
+    if (!fd.valid() || TryMemoryMap(fd.get(), byte_range, read_result)) {
+      return read_result;
+    }
     internal::FlatCordBuilder buffer(byte_range.size());
     std::size_t offset = 0;
     while (offset < buffer.size()) {
@@ -622,10 +774,134 @@ struct ReadTask {
   }
 };
 
+/// Maximum number of bytes transferred by a single io_uring read.
+constexpr std::size_t kMaxIoUringReadSize = std::size_t(1) << 30;
+
+/// State of a read whose data transfer is performed by the `IoUringEngine`.
+///
+/// Read completions are delivered on the engine's completion thread, but the
+/// promise is always resolved on the executor so that user continuations do
+/// not run on the completion thread.
+struct IoUringReadState {
+  std::shared_ptr<IoUringEngine> engine;
+  Executor executor;
+  std::string full_path;
+  Promise<ReadResult> promise;
+  UniqueFileDescriptor fd;
+  ReadResult read_result;
+  std::int64_t file_offset;
+  internal::FlatCordBuilder buffer;
+  std::size_t offset = 0;
+
+  /// Submits the next read, or completes `promise` if all data has been read.
+  static void Continue(std::unique_ptr<IoUringReadState> state) {
+    if (!state->promise.result_needed()) return;
+    auto* s = state.get();
+    if (s->offset == s->buffer.size()) {
+      Finish(std::move(state), absl::OkStatus());
+      return;
+    }
+    const std::size_t count =
+        std::min(s->buffer.size() - s->offset, kMaxIoUringReadSize);
+    s->engine->Read(
+        s->fd.get(), s->buffer.data() + s->offset, static_cast<uint32_t>(count),
+        s->file_offset + s->offset,
+        [state = std::move(state)](int32_t result) mutable {
+          if (result > 0) {
+            file_bytes_read.IncrementBy(result);
+            state->offset += result;
+            Continue(std::move(state));
+          } else if (result == 0) {
+            auto status = absl::UnavailableError(tensorstore::StrCat(
+                "Length changed while reading: ", state->full_path));
+            Finish(std::move(state), std::move(status));
+          } else {
+            auto status = StatusFromOsError(-result, "Error reading file: ",
+                                            state->full_path);
+            Finish(std::move(state), std::move(status));
+          }
+        });
+  }
+
+  /// Completes the read on the executor.
+  static void Finish(std::unique_ptr<IoUringReadState> state,
+                     absl::Status status) {
+    auto executor = state->executor;
+    executor([state = std::move(state), status = std::move(status)]() mutable {
+      if (!status.ok()) {
+        state->promise.SetResult(std::move(status));
+        return;
+      }
+      state->read_result.value = std::move(state->buffer).Build();
+      state->promise.SetResult(std::move(state->read_result));
+    });
+  }
+};
+
+/// Implements `FileKeyValueStore::Read` using io_uring.
+///
+/// The file is opened and its generation checked on the `file_io_concurrency`
+/// executor, but the data itself is read asynchronously by the engine.
+struct IoUringReadTask {
+  std::shared_ptr<IoUringEngine> engine;
+  Executor executor;
+  ReadTask task;
+
+  void operator()(Promise<ReadResult> promise) {
+    auto state = std::make_unique<IoUringReadState>();
+    ByteRange byte_range;
+    auto fd = task.Open(state->read_result, byte_range);
+    if (!fd.ok()) {
+      promise.SetResult(std::move(fd).status());
+      return;
+    }
+    if (!fd->valid() ||
+        task.TryMemoryMap(fd->get(), byte_range, state->read_result)) {
+      promise.SetResult(std::move(state->read_result));
+      return;
+    }
+    state->engine = std::move(engine);
+    state->executor = std::move(executor);
+    state->full_path = std::move(task.full_path);
+    state->promise = std::move(promise);
+    state->fd = std::move(*fd);
+    state->file_offset = byte_range.inclusive_min;
+    state->buffer = internal::FlatCordBuilder(byte_range.size());
+    IoUringReadState::Continue(std::move(state));
+  }
+};
+
 Future<ReadResult> FileKeyValueStore::Read(Key key, ReadOptions options) {
+  if (options.batch) {
+    return internal_kvstore_batch::DeferRead(this, std::move(key),
+                                             std::move(options));
+  }
   file_read.Increment();
   TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
-  return MapFuture(executor(), ReadTask{std::move(key), std::move(options)});
+  ReadTask task{std::move(key), std::move(options),
+                spec_.file_io_engine->spec.mmap_threshold};
+  if (const auto& engine = io_uring()) {
+    return PromiseFuturePair<ReadResult>::Link(
+               WithExecutor(executor(), IoUringReadTask{engine, executor(),
+                                                        std::move(task)}))
+        .future;
+  }
+  return MapFuture(executor(), std::move(task));
+}
+
+/// Writes all of `value` to `fd`, starting at the current file offset.
+absl::Status WriteValue(FileDescriptor fd, absl::Cord value,
+                        const std::string& path) {
+  for (; !value.empty();) {
+    std::ptrdiff_t n = internal_file_util::WriteCordToFile(fd, value);
+    if (n <= 0) {
+      return StatusFromErrno("Error writing to file: ", path);
+    }
+    file_bytes_written.IncrementBy(n);
+    if (n == value.size()) break;
+    value.RemovePrefix(n);
+  }
+  return absl::OkStatus();
 }
 
 /// Implements `FileKeyValueStore::Write`.
@@ -633,6 +909,35 @@ struct WriteTask {
   std::string full_path;
   absl::Cord value;
   kvstore::WriteOptions options;
+  FileIoSyncResource::Resource sync;
+
+  /// Checks the condition and, if it is satisfied, writes `value` to the lock
+  /// file, which must already be locked.
+  ///
+  /// \returns `false` if the condition is not satisfied.
+  Result<bool> WriteLockFile(WriteLockHelper& lock_helper) const {
+    FileDescriptor fd = lock_helper.lock_fd.get();
+    const std::string& lock_path = lock_helper.lock_path;
+    // Check condition.
+    if (!StorageGeneration::IsUnknown(options.if_equal)) {
+      StorageGeneration generation;
+      TENSORSTORE_ASSIGN_OR_RETURN(
+          UniqueFileDescriptor value_fd,
+          OpenValueFile(full_path.c_str(), &generation));
+      if (generation != options.if_equal) {
+        return false;
+      }
+    }
+    if (internal_file_util::GetSize(lock_helper.info) > value.size()) {
+      // Only truncate when the file is larger. In the common path, the lock
+      // file is newly created, so truncate is useless.
+      if (!internal_file_util::TruncateFile(fd)) {
+        return StatusFromErrno("Failed to truncate file: ", lock_path);
+      }
+    }
+    TENSORSTORE_RETURN_IF_ERROR(WriteValue(fd, value, lock_path));
+    return true;
+  }
 
   Result<TimestampedStorageGeneration> operator()() const {
     TimestampedStorageGeneration r;
@@ -646,48 +951,20 @@ struct WriteTask {
     auto generation_result = [&]() -> Result<StorageGeneration> {
       FileDescriptor fd = lock_helper.lock_fd.get();
       const std::string& lock_path = lock_helper.lock_path;
-      // Check condition.
-      if (!StorageGeneration::IsUnknown(options.if_equal)) {
-        StorageGeneration generation;
-        TENSORSTORE_ASSIGN_OR_RETURN(
-            UniqueFileDescriptor value_fd,
-            OpenValueFile(full_path.c_str(), &generation));
-        if (generation != options.if_equal) {
-          return StorageGeneration::Unknown();
-        }
-      }
-      if (internal_file_util::GetSize(lock_helper.info) > value.size()) {
-        // Only truncate when the file is larger. In the common path, the lock
-        // file is newly created, so truncate is useless.
-        if (!internal_file_util::TruncateFile(fd)) {
-          return StatusFromErrno("Failed to truncate file: ", lock_path);
-        }
-      }
-      absl::Cord value_for_write = value;
-      for (; !value_for_write.empty();) {
-        std::ptrdiff_t n =
-            internal_file_util::WriteCordToFile(fd, value_for_write);
-        if (n <= 0) {
-          return StatusFromErrno("Error writing to file: ", lock_path);
-        }
-        file_bytes_written.IncrementBy(n);
-        if (n == value_for_write.size()) break;
-        value_for_write.RemovePrefix(n);
+      TENSORSTORE_ASSIGN_OR_RETURN(bool written, WriteLockFile(lock_helper));
+      if (!written) {
+        return StorageGeneration::Unknown();
       }
 
-      if (!internal_file_util::FsyncFile(fd)) {
-        return StatusFromErrno("Error calling fsync on file: ", lock_path);
-      }
+      TENSORSTORE_RETURN_IF_ERROR(SyncLockFile(sync, fd, lock_path));
       if (!internal_file_util::RenameOpenFile(fd, lock_path, full_path)) {
         return StatusFromErrno("Error renaming: ", lock_path, " -> ",
                                full_path);
       }
       delete_lock_file = false;
       // fsync the parent directory to ensure the `rename` is durable.
-      if (!internal_file_util::FsyncDirectory(dir_fd.get())) {
-        return StatusFromErrno("Error calling fsync on parent directory of: ",
-                               full_path);
-      }
+      TENSORSTORE_RETURN_IF_ERROR(
+          SyncParentDirectory(sync, dir_fd.get(), full_path));
       lock_helper.lock = FileLock{};
 
       // Retrieve `FileInfo` after the fsync and rename to ensure the
@@ -710,10 +987,168 @@ struct WriteTask {
   }
 };
 
+/// State of a write whose `fsync` and `rename` steps are performed by the
+/// `IoUringEngine`.
+///
+/// The steps are chained through completion callbacks in the same order as
+/// `WriteTask`, and the lock is held until the final step completes.  The
+/// remaining (inexpensive) bookkeeping is done on the executor rather than the
+/// completion thread.
+struct IoUringWriteState {
+  IoUringWriteState(const std::string& full_path)
+      : full_path(full_path), lock_helper(full_path) {}
+
+  std::shared_ptr<IoUringEngine> engine;
+  Executor executor;
+  std::string full_path;
+  Promise<TimestampedStorageGeneration> promise;
+  TimestampedStorageGeneration r;
+  UniqueFileDescriptor dir_fd;
+  WriteLockHelper lock_helper;
+  bool delete_lock_file = true;
+  // Set to `false` in `"none"` durability mode to skip the `fsync` steps.
+  bool sync = true;
+
+  static void SyncLockFile(std::unique_ptr<IoUringWriteState> state) {
+    auto* s = state.get();
+    if (!s->sync) {
+      RenameLockFile(std::move(state));
+      return;
+    }
+    s->engine->Fsync(s->lock_helper.lock_fd.get(),
+                     [state = std::move(state)](int32_t result) mutable {
+                       if (result < 0) {
+                         auto status = StatusFromOsError(
+                             -result, "Error calling fsync on file: ",
+                             state->lock_helper.lock_path);
+                         Finish(std::move(state), std::move(status));
+                         return;
+                       }
+                       RenameLockFile(std::move(state));
+                     });
+  }
+
+  static void RenameLockFile(std::unique_ptr<IoUringWriteState> state) {
+    auto* s = state.get();
+    s->engine->Rename(s->lock_helper.lock_path.c_str(), s->full_path.c_str(),
+                      [state = std::move(state)](int32_t result) mutable {
+                        if (result < 0) {
+                          auto status = StatusFromOsError(
+                              -result, "Error renaming: ",
+                              state->lock_helper.lock_path, " -> ",
+                              state->full_path);
+                          Finish(std::move(state), std::move(status));
+                          return;
+                        }
+                        state->delete_lock_file = false;
+                        SyncDirectory(std::move(state));
+                      });
+  }
+
+  static void SyncDirectory(std::unique_ptr<IoUringWriteState> state) {
+    auto* s = state.get();
+    if (!s->sync) {
+      Finish(std::move(state), absl::OkStatus());
+      return;
+    }
+    // fsync the parent directory to ensure the `rename` is durable.
+    s->engine->Fsync(
+        s->dir_fd.get(), [state = std::move(state)](int32_t result) mutable {
+          absl::Status status;
+          if (result < 0) {
+            status = StatusFromOsError(
+                -result, "Error calling fsync on parent directory of: ",
+                state->full_path);
+          }
+          Finish(std::move(state), std::move(status));
+        });
+  }
+
+  /// Completes the write on the executor.
+  static void Finish(std::unique_ptr<IoUringWriteState> state,
+                     absl::Status status) {
+    auto executor = state->executor;
+    executor([state = std::move(state), status = std::move(status)]() mutable {
+      if (!status.ok()) {
+        state->Complete(std::move(status));
+        return;
+      }
+      state->lock_helper.lock = FileLock{};
+
+      // Retrieve `FileInfo` after the fsync and rename to ensure the
+      // modification time doesn't change afterwards.
+      FileInfo info;
+      if (!GetFileInfo(state->lock_helper.lock_fd.get(), &info)) {
+        state->Complete(StatusFromErrno("Error getting file info: ",
+                                        state->lock_helper.lock_path));
+        return;
+      }
+      state->Complete(GetFileGeneration(info));
+    });
+  }
+
+  void Complete(Result<StorageGeneration> generation_result) {
+    if (delete_lock_file) {
+      if (auto status = lock_helper.Delete(); !status.ok()) {
+        promise.SetResult(std::move(status));
+        return;
+      }
+    }
+    if (!generation_result) {
+      promise.SetResult(std::move(generation_result).status());
+      return;
+    }
+    r.generation = std::move(*generation_result);
+    promise.SetResult(std::move(r));
+  }
+};
+
+/// Implements `FileKeyValueStore::Write` using io_uring.
+///
+/// The lock is acquired and the new value is written to the lock file on the
+/// `file_io_concurrency` executor, but the `fsync` and `rename` steps, which
+/// dominate the latency of a write, are performed asynchronously.
+struct IoUringWriteTask {
+  std::shared_ptr<IoUringEngine> engine;
+  Executor executor;
+  WriteTask task;
+
+  void operator()(Promise<TimestampedStorageGeneration> promise) {
+    auto state = std::make_unique<IoUringWriteState>(task.full_path);
+    state->engine = std::move(engine);
+    state->executor = std::move(executor);
+    state->promise = std::move(promise);
+    state->sync = task.sync.spec.mode != FileIoSyncResource::Mode::kNone;
+    state->r.time = absl::Now();
+
+    auto dir_fd = OpenParentDirectory(task.full_path);
+    if (!dir_fd.ok()) {
+      state->promise.SetResult(std::move(dir_fd).status());
+      return;
+    }
+    state->dir_fd = std::move(*dir_fd);
+    if (auto status = state->lock_helper.CreateAndAcquire(); !status.ok()) {
+      state->promise.SetResult(std::move(status));
+      return;
+    }
+    auto written = task.WriteLockFile(state->lock_helper);
+    if (!written.ok()) {
+      state->Complete(std::move(written).status());
+      return;
+    }
+    if (!*written) {
+      state->Complete(StorageGeneration::Unknown());
+      return;
+    }
+    IoUringWriteState::SyncLockFile(std::move(state));
+  }
+};
+
 /// Implements `FileKeyValueStore::Delete`.
 struct DeleteTask {
   std::string full_path;
   kvstore::WriteOptions options;
+  FileIoSyncResource::Resource sync;
 
   Result<TimestampedStorageGeneration> operator()() const {
     TimestampedStorageGeneration r;
@@ -748,9 +1183,126 @@ struct DeleteTask {
     TENSORSTORE_RETURN_IF_ERROR(lock_helper.Delete());
 
     // fsync the parent directory to ensure the `rename` is durable.
-    if (fsync_directory && !internal_file_util::FsyncDirectory(dir_fd.get())) {
-      return StatusFromErrno("Error calling fsync on parent directory of: ",
-                             full_path);
+    if (fsync_directory) {
+      TENSORSTORE_RETURN_IF_ERROR(
+          SyncParentDirectory(sync, dir_fd.get(), full_path));
+    }
+    if (!generation_result) {
+      return std::move(generation_result).status();
+    }
+    r.generation = std::move(*generation_result);
+    return r;
+  }
+};
+
+/// Returns a unique path, in the same directory as `full_path`, to which a
+/// staged write of `full_path` may be written.
+///
+/// The path ends with `kLockSuffix`, so that it is never listed or accessible
+/// as a key.
+std::string GetStagedWritePath(std::string_view full_path) {
+  struct RandomState {
+    absl::Mutex mutex;
+    absl::BitGen gen ABSL_GUARDED_BY(mutex);
+  };
+  static RandomState random_state;
+  uint64_t uuid[2];
+  {
+    absl::MutexLock lock(&random_state.mutex);
+    for (auto& x : uuid) {
+      x = absl::Uniform<uint64_t>(random_state.gen);
+    }
+  }
+  return tensorstore::StrCat(full_path, ".__stage.",
+                             absl::Hex(uuid[0], absl::kZeroPad16),
+                             absl::Hex(uuid[1], absl::kZeroPad16), kLockSuffix);
+}
+
+/// Implements `FileKeyValueStore::StageWrite`.
+///
+/// Writes the value to a new file that is later renamed over the key by
+/// `CommitStagedTask`.
+struct StageWriteTask {
+  std::string full_path;
+  absl::Cord value;
+  FileIoSyncResource::Resource sync;
+
+  Result<kvstore::StagedWrite> operator()() const {
+    // Ensures the parent directory exists.
+    TENSORSTORE_ASSIGN_OR_RETURN(auto dir_fd, OpenParentDirectory(full_path));
+    std::string staged_path = GetStagedWritePath(full_path);
+    UniqueFileDescriptor fd =
+        internal_file_util::OpenFileForWriting(staged_path);
+    if (!fd.valid()) {
+      return StatusFromErrno("Failed to open file: ", staged_path);
+    }
+    auto status = WriteValue(fd.get(), value, staged_path);
+    if (status.ok()) status = SyncLockFile(sync, fd.get(), staged_path);
+    if (!status.ok()) {
+      internal_file_util::DeleteOpenFile(fd.get(), staged_path);
+      return status;
+    }
+    return kvstore::StagedWrite{std::move(staged_path), value.size()};
+  }
+};
+
+/// Implements `FileKeyValueStore::CommitStagedWrite`.
+struct CommitStagedTask {
+  std::string full_path;
+  std::string staged_path;
+  kvstore::WriteOptions options;
+  FileIoSyncResource::Resource sync;
+
+  Result<TimestampedStorageGeneration> operator()() const {
+    TimestampedStorageGeneration r;
+    r.time = absl::Now();
+
+    WriteLockHelper lock_helper(full_path);
+    TENSORSTORE_ASSIGN_OR_RETURN(auto dir_fd, OpenParentDirectory(full_path));
+    TENSORSTORE_RETURN_IF_ERROR(lock_helper.CreateAndAcquire());
+
+    bool fsync_directory = false;
+    auto generation_result = [&]() -> Result<StorageGeneration> {
+      // Check condition.
+      if (!StorageGeneration::IsUnknown(options.if_equal)) {
+        StorageGeneration generation;
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            UniqueFileDescriptor value_fd,
+            OpenValueFile(full_path.c_str(), &generation));
+        if (generation != options.if_equal) {
+          return StorageGeneration::Unknown();
+        }
+      }
+      // Open the staged file without creating it, to detect a staged write
+      // that was already committed or discarded.
+      StorageGeneration staged_generation;
+      TENSORSTORE_ASSIGN_OR_RETURN(
+          UniqueFileDescriptor fd,
+          OpenValueFile(staged_path.c_str(), &staged_generation));
+      if (!fd.valid()) {
+        return absl::FailedPreconditionError(tensorstore::StrCat(
+            "Staged write no longer exists: ", staged_path));
+      }
+      if (!internal_file_util::RenameOpenFile(fd.get(), staged_path,
+                                              full_path)) {
+        return StatusFromErrno("Error renaming: ", staged_path, " -> ",
+                               full_path);
+      }
+      fsync_directory = true;
+      FileInfo info;
+      if (!GetFileInfo(fd.get(), &info)) {
+        return StatusFromErrno("Error getting file info: ", full_path);
+      }
+      return GetFileGeneration(info);
+    }();
+
+    // Delete the lock file.
+    TENSORSTORE_RETURN_IF_ERROR(lock_helper.Delete());
+
+    // fsync the parent directory to ensure the `rename` is durable.
+    if (fsync_directory) {
+      TENSORSTORE_RETURN_IF_ERROR(
+          SyncParentDirectory(sync, dir_fd.get(), full_path));
     }
     if (!generation_result) {
       return std::move(generation_result).status();
@@ -765,14 +1317,67 @@ Future<TimestampedStorageGeneration> FileKeyValueStore::Write(
   file_write.Increment();
   TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
   if (value) {
-    return MapFuture(executor(), WriteTask{std::move(key), std::move(*value),
-                                           std::move(options)});
+    WriteTask task{std::move(key), std::move(*value), std::move(options),
+                   sync()};
+    const auto& engine = io_uring();
+    if (engine &&
+        task.sync.spec.mode != FileIoSyncResource::Mode::kGroupCommit) {
+      return PromiseFuturePair<TimestampedStorageGeneration>::Link(
+                 WithExecutor(executor(), IoUringWriteTask{engine, executor(),
+                                                           std::move(task)}))
+          .future;
+    }
+    return MapFuture(executor(), std::move(task));
   } else {
     return MapFuture(executor(),
-                     DeleteTask{std::move(key), std::move(options)});
+                     DeleteTask{std::move(key), std::move(options), sync()});
   }
 }
 
+Future<kvstore::StagedWrite> FileKeyValueStore::StageWrite(Key key,
+                                                           Value value) {
+  TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
+  return MapFuture(executor(),
+                   StageWriteTask{std::move(key), std::move(value), sync()});
+}
+
+Future<ReadResult> FileKeyValueStore::ReadStagedWrite(
+    const kvstore::StagedWrite& staged) {
+  return MapFuture(
+      executor(),
+      [task = ReadTask{staged.location, {},
+                       spec_.file_io_engine->spec.mmap_threshold}]()
+          -> Result<ReadResult> {
+        TENSORSTORE_ASSIGN_OR_RETURN(auto read_result, task());
+        if (!read_result.has_value()) {
+          return absl::DataLossError(tensorstore::StrCat(
+              "Staged write no longer exists: ", task.full_path));
+        }
+        return read_result;
+      });
+}
+
+Future<TimestampedStorageGeneration> FileKeyValueStore::CommitStagedWrite(
+    Key key, const kvstore::StagedWrite& staged, WriteOptions options) {
+  file_write.Increment();
+  TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
+  return MapFuture(executor(),
+                   CommitStagedTask{std::move(key), staged.location,
+                                    std::move(options), sync()});
+}
+
+Future<const void> FileKeyValueStore::DiscardStagedWrite(
+    const kvstore::StagedWrite& staged) {
+  return MapFuture(executor(), [path = staged.location]() -> Result<void> {
+    if (!internal_file_util::DeleteFile(path) &&
+        GetOsErrorStatusCode(GetLastErrorCode()) !=
+            absl::StatusCode::kNotFound) {
+      return StatusFromErrno("Failed to remove staged write: ", path);
+    }
+    return absl::OkStatus();
+  });
+}
+
 /// Implements `FileKeyValueStore::DeleteRange`.
 struct DeleteRangeTask {
   KeyRange range;
@@ -886,6 +1491,10 @@ Result<kvstore::Spec> ParseFileUrl(std::string_view url) {
   auto driver_spec = internal::MakeIntrusivePtr<FileKeyValueStoreSpec>();
   driver_spec->data_.file_io_concurrency =
       Context::Resource<internal::FileIoConcurrencyResource>::DefaultSpec();
+  driver_spec->data_.file_io_engine =
+      Context::Resource<FileIoEngineResource>::DefaultSpec();
+  driver_spec->data_.file_io_sync =
+      Context::Resource<FileIoSyncResource>::DefaultSpec();
   auto parsed = internal::ParseGenericUri(url);
   assert(parsed.scheme == tensorstore::FileKeyValueStoreSpec::id);
   if (!parsed.query.empty()) {
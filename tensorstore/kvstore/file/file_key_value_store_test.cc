@@ -32,6 +32,7 @@
 #include "tensorstore/context.h"
 #include "tensorstore/internal/test_util.h"
 #include "tensorstore/internal/thread.h"
+#include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/generation_testutil.h"
 #include "tensorstore/kvstore/key_range.h"
@@ -44,6 +45,7 @@
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/status_testutil.h"
+#include "tensorstore/util/str_cat.h"
 
 // Include system headers last to reduce impact of macros.
 #ifndef _WIN32
@@ -59,6 +61,7 @@ using ::tensorstore::KeyRange;
 using ::tensorstore::KvStore;
 using ::tensorstore::MatchesStatus;
 using ::tensorstore::StorageGeneration;
+using ::tensorstore::internal::MatchesKvsReadResult;
 using ::tensorstore::internal::MatchesKvsReadResultNotFound;
 using ::tensorstore::internal::MatchesTimestampedStorageGeneration;
 using ::testing::HasSubstr;
@@ -67,6 +70,14 @@ KvStore GetStore(std::string root) {
   return kvstore::Open({{"driver", "file"}, {"path", root + "/"}}).value();
 }
 
+KvStore GetIoUringStore(std::string root) {
+  auto context = tensorstore::Context::FromJson(
+                     {{"file_io_engine", {{"mode", "io_uring"}}}})
+                     .value();
+  return kvstore::Open({{"driver", "file"}, {"path", root + "/"}}, context)
+      .value();
+}
+
 TEST(FileKeyValueStoreTest, Basic) {
   tensorstore::internal::ScopedTemporaryDirectory tempdir;
   std::string root = tempdir.path() + "/root";
@@ -179,6 +190,53 @@ TEST(FileKeyValueStoreTest, LockFiles) {
   EXPECT_THAT(GetDirectoryContents(root), ::testing::UnorderedElementsAre());
 }
 
+TEST(FileKeyValueStoreTest, StagedWrite) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetStore(root);
+  auto& driver = *store.driver;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto staged, driver.StageWrite("a/foo", absl::Cord("xyz")).result());
+  EXPECT_EQ(3, staged.size);
+
+  // The staged write is neither visible as a key nor listed.
+  EXPECT_THAT(kvstore::Read(store, "a/foo").result(),
+              MatchesKvsReadResultNotFound());
+  EXPECT_THAT(ListFuture(store).result(),
+              ::testing::Optional(::testing::UnorderedElementsAre()));
+  EXPECT_THAT(driver.ReadStagedWrite(staged).result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+
+  // A condition that is not satisfied leaves the staged write in place.
+  EXPECT_THAT(driver
+                  .CommitStagedWrite("a/foo", staged,
+                                     {StorageGeneration::FromString("x")})
+                  .result(),
+              MatchesTimestampedStorageGeneration(StorageGeneration::Unknown()));
+  TENSORSTORE_ASSERT_OK(driver.CommitStagedWrite("a/foo", staged).result());
+  EXPECT_THAT(kvstore::Read(store, "a/foo").result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+  EXPECT_THAT(GetDirectoryContents(root),
+              ::testing::UnorderedElementsAre("a", "a/foo"));
+
+  // A staged write may only be committed once.
+  EXPECT_THAT(driver.CommitStagedWrite("a/foo", staged).result(),
+              MatchesStatus(absl::StatusCode::kFailedPrecondition));
+
+  // Discarded staged writes are removed.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      staged, driver.StageWrite("a/foo", absl::Cord("abc")).result());
+  EXPECT_THAT(GetDirectoryContents(root), ::testing::SizeIs(3));
+  TENSORSTORE_ASSERT_OK(driver.DiscardStagedWrite(staged).result());
+  EXPECT_THAT(GetDirectoryContents(root),
+              ::testing::UnorderedElementsAre("a", "a/foo"));
+  EXPECT_THAT(kvstore::Read(store, "a/foo").result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+
+  // Discarding a staged write that no longer exists succeeds.
+  TENSORSTORE_EXPECT_OK(driver.DiscardStagedWrite(staged).result());
+}
+
 TEST(FileKeyValueStoreTest, NestedDirectories) {
   tensorstore::internal::ScopedTemporaryDirectory tempdir;
   std::string root = tempdir.path() + "/root";
@@ -195,14 +253,11 @@ TEST(FileKeyValueStoreTest, NestedDirectories) {
                        MatchesStatus(absl::StatusCode::kFailedPrecondition)));
 }
 
-TEST(FileKeyValueStoreTest, ConcurrentWrites) {
+void TestConcurrentWrites(KvStore store) {
   constexpr std::size_t num_threads = 4;
   std::vector<tensorstore::internal::Thread> threads;
   threads.reserve(num_threads);
 
-  tensorstore::internal::ScopedTemporaryDirectory tempdir;
-  std::string root = tempdir.path() + "/root";
-  auto store = GetStore(root);
   std::string key = "test";
   std::string initial_value;
   initial_value.resize(sizeof(std::size_t) * num_threads);
@@ -258,6 +313,120 @@ TEST(FileKeyValueStoreTest, ConcurrentWrites) {
   }
 }
 
+TEST(FileKeyValueStoreTest, ConcurrentWrites) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TestConcurrentWrites(GetStore(root));
+}
+
+// If io_uring is not available, the blocking engine is used instead, so these
+// tests pass on all platforms.
+TEST(FileKeyValueStoreTest, IoUringBasic) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetIoUringStore(root);
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+}
+
+TEST(FileKeyValueStoreTest, IoUringConcurrentWrites) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TestConcurrentWrites(GetIoUringStore(root));
+}
+
+KvStore GetMemoryMapStore(std::string root, std::string_view mode) {
+  auto context =
+      tensorstore::Context::FromJson(
+          {{"file_io_engine", {{"mode", mode}, {"mmap_threshold", 1}}}})
+          .value();
+  return kvstore::Open({{"driver", "file"}, {"path", root + "/"}}, context)
+      .value();
+}
+
+TEST(FileKeyValueStoreTest, MemoryMapBasic) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetMemoryMapStore(root, "blocking");
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+}
+
+TEST(FileKeyValueStoreTest, MemoryMapByteRange) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  std::string value(100000, '\0');
+  for (std::size_t i = 0; i < value.size(); ++i) value[i] = i % 251;
+  for (std::string_view mode : {"blocking", "io_uring"}) {
+    auto store = GetMemoryMapStore(root, mode);
+    TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a", absl::Cord(value)));
+    kvstore::ReadOptions options;
+    options.byte_range = {5000, 90000};
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto read_result, kvstore::Read(store, "a", options).result());
+    ASSERT_TRUE(read_result.has_value());
+    EXPECT_TRUE(read_result.value.TryFlat());
+    EXPECT_EQ(value.substr(5000, 85000), read_result.value);
+
+    // Values remain valid after the key is overwritten.
+    TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a", absl::Cord("abc")));
+    EXPECT_EQ(value.substr(5000, 85000), read_result.value);
+  }
+}
+
+KvStore GetSyncStore(std::string root, std::string_view mode,
+                     std::string_view engine = "blocking") {
+  auto context = tensorstore::Context::FromJson(
+                     {{"file_io_sync", {{"mode", mode}}},
+                      {"file_io_engine", {{"mode", engine}}}})
+                     .value();
+  return kvstore::Open({{"driver", "file"}, {"path", root + "/"}}, context)
+      .value();
+}
+
+TEST(FileKeyValueStoreTest, GroupCommitBasic) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetSyncStore(root, "group_commit");
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+}
+
+TEST(FileKeyValueStoreTest, GroupCommitConcurrentWrites) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TestConcurrentWrites(GetSyncStore(root, "group_commit"));
+}
+
+// Concurrent writes to distinct keys in the same directory share syncs.
+TEST(FileKeyValueStoreTest, GroupCommitManyKeys) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetSyncStore(root, "group_commit");
+  constexpr size_t kNumKeys = 100;
+  std::vector<tensorstore::Future<tensorstore::TimestampedStorageGeneration>>
+      futures;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    futures.push_back(kvstore::Write(store, tensorstore::StrCat("dir/", i),
+                                     absl::Cord(tensorstore::StrCat(i))));
+  }
+  for (auto& future : futures) {
+    TENSORSTORE_EXPECT_OK(future.result());
+  }
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto read_result,
+        kvstore::Read(store, tensorstore::StrCat("dir/", i)).result());
+    EXPECT_EQ(tensorstore::StrCat(i), read_result.value);
+  }
+}
+
+TEST(FileKeyValueStoreTest, NoSyncBasic) {
+  for (std::string_view engine : {"blocking", "io_uring"}) {
+    tensorstore::internal::ScopedTemporaryDirectory tempdir;
+    std::string root = tempdir.path() + "/root";
+    auto store = GetSyncStore(root, "none", engine);
+    tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+  }
+}
+
 // Tests `FileKeyValueStore` on a directory without write or read/write
 // permissions.
 #ifndef _WIN32
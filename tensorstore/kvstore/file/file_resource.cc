@@ -0,0 +1,65 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/file_resource.h"
+
+#include <memory>
+
+#include "absl/log/absl_log.h"
+#include "tensorstore/context_resource_provider.h"
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+#include "tensorstore/kvstore/file/sync_batcher.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+namespace {
+
+const internal::ContextResourceRegistration<FileIoEngineResource>
+    file_io_engine_registration;
+
+const internal::ContextResourceRegistration<FileIoSyncResource>
+    file_io_sync_registration;
+
+}  // namespace
+
+Result<FileIoEngineResource::Resource> FileIoEngineResource::Create(
+    const Spec& spec, internal::ContextResourceCreationContext context) {
+  Resource value;
+  value.spec = spec;
+  if (spec.mode == Mode::kIoUring) {
+    auto engine = IoUringEngine::Create(spec.queue_depth);
+    if (engine.ok()) {
+      value.io_uring = std::move(*engine);
+    } else {
+      ABSL_LOG(WARNING) << "Falling back to blocking file I/O: "
+                        << engine.status();
+    }
+  }
+  return value;
+}
+
+Result<FileIoSyncResource::Resource> FileIoSyncResource::Create(
+    const Spec& spec, internal::ContextResourceCreationContext context) {
+  Resource value;
+  value.spec = spec;
+  if (spec.mode == Mode::kGroupCommit) {
+    value.data_sync = std::make_shared<SyncBatcher>();
+    value.directory_sync = std::make_shared<SyncBatcher>();
+  }
+  return value;
+}
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
@@ -0,0 +1,155 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_FILE_RESOURCE_H_
+#define TENSORSTORE_KVSTORE_FILE_FILE_RESOURCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+
+#include "tensorstore/context_resource_provider.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/json_binding/std_optional.h"
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+#include "tensorstore/kvstore/file/sync_batcher.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+/// Specifies the I/O engine used by the "file" driver.
+///
+/// With the default `"blocking"` engine, each read and write blocks a thread
+/// of the `file_io_concurrency` executor for its entire duration.  With the
+/// `"io_uring"` engine, the data transfer of reads and the `fsync`/`rename`
+/// steps of writes are instead submitted to a shared io_uring instance, and
+/// the executor thread is released as soon as the request is submitted.
+///
+/// Independent of the engine, if `mmap_threshold` is specified, reads of at
+/// least that many bytes are satisfied by memory-mapping the file: the
+/// returned `absl::Cord` directly references the mapped region (which remains
+/// mapped as long as the Cord is referenced) rather than a copy of the data.
+struct FileIoEngineResource
+    : public internal::ContextResourceTraits<FileIoEngineResource> {
+  static constexpr char id[] = "file_io_engine";
+
+  enum class Mode {
+    kBlocking,
+    kIoUring,
+  };
+
+  struct Spec {
+    Mode mode = Mode::kBlocking;
+    uint32_t queue_depth = 256;
+    std::optional<size_t> mmap_threshold;
+  };
+
+  struct Resource {
+    Spec spec;
+    // Null if `spec.mode == Mode::kBlocking`, or if io_uring is unavailable,
+    // in which case the blocking engine is used.
+    std::shared_ptr<IoUringEngine> io_uring;
+  };
+
+  static Spec Default() { return {}; }
+
+  static constexpr auto JsonBinder() {
+    namespace jb = tensorstore::internal_json_binding;
+    return jb::Object(
+        jb::Member("mode",
+                   jb::Projection<&Spec::mode>(jb::DefaultValue(
+                       [](auto* v) { *v = Mode::kBlocking; },
+                       jb::Enum<Mode, std::string_view>({
+                           {Mode::kBlocking, "blocking"},
+                           {Mode::kIoUring, "io_uring"},
+                       })))),
+        jb::Member("queue_depth",
+                   jb::Projection<&Spec::queue_depth>(jb::DefaultValue(
+                       [](auto* v) { *v = 256; },
+                       jb::Integer<uint32_t>(1, 32768)))),
+        jb::Member("mmap_threshold", jb::Projection<&Spec::mmap_threshold>()));
+  }
+
+  static Result<Resource> Create(
+      const Spec& spec, internal::ContextResourceCreationContext context);
+
+  static Spec GetSpec(const Resource& resource,
+                      const internal::ContextSpecBuilder& builder) {
+    return resource.spec;
+  }
+};
+
+/// Specifies how the "file" driver makes writes durable.
+///
+/// With `"per_write"` (the default), each write `fsync`s the new file before
+/// renaming it into place, and `fsync`s the parent directory afterwards.  With
+/// `"group_commit"`, writes that are concurrently waiting to sync within the
+/// same directory share a single `syncfs` (on Linux) and a single `fsync` of
+/// the directory; the futures of all writes in the batch become ready
+/// together.  With `"none"`, no syncs are performed at all, and writes may be
+/// lost (but are never torn) if the system crashes.
+struct FileIoSyncResource
+    : public internal::ContextResourceTraits<FileIoSyncResource> {
+  static constexpr char id[] = "file_io_sync";
+
+  enum class Mode {
+    kPerWrite,
+    kGroupCommit,
+    kNone,
+  };
+
+  struct Spec {
+    Mode mode = Mode::kPerWrite;
+  };
+
+  struct Resource {
+    Spec spec;
+    // Used only if `spec.mode == Mode::kGroupCommit`.  Both are keyed by the
+    // parent directory path.
+    std::shared_ptr<SyncBatcher> data_sync;
+    std::shared_ptr<SyncBatcher> directory_sync;
+  };
+
+  static Spec Default() { return {}; }
+
+  static constexpr auto JsonBinder() {
+    namespace jb = tensorstore::internal_json_binding;
+    return jb::Object(jb::Member(
+        "mode", jb::Projection<&Spec::mode>(jb::DefaultValue(
+                    [](auto* v) { *v = Mode::kPerWrite; },
+                    jb::Enum<Mode, std::string_view>({
+                        {Mode::kPerWrite, "per_write"},
+                        {Mode::kGroupCommit, "group_commit"},
+                        {Mode::kNone, "none"},
+                    })))));
+  }
+
+  static Result<Resource> Create(
+      const Spec& spec, internal::ContextResourceCreationContext context);
+
+  static Spec GetSpec(const Resource& resource,
+                      const internal::ContextSpecBuilder& builder) {
+    return resource.spec;
+  }
+};
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_FILE_RESOURCE_H_
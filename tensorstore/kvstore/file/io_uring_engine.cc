@@ -0,0 +1,450 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/metrics/gauge.h"
+#include "tensorstore/internal/os_error_code.h"
+#include "tensorstore/internal/thread.h"
+#include "tensorstore/util/result.h"
+
+// Include system headers last to reduce impact of macros.
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tensorstore {
+namespace internal_file_util {
+namespace {
+
+auto& io_uring_submitted = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/io_uring/submitted",
+    "Operations submitted to the file driver io_uring engine");
+
+auto& io_uring_outstanding = internal_metrics::Gauge<int64_t>::New(
+    "/tensorstore/kvstore/file/io_uring/outstanding",
+    "Operations in flight on the file driver io_uring engine");
+
+}  // namespace
+
+#ifdef __linux__
+
+namespace {
+
+int IoUringSetup(unsigned entries, ::io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+/// Set on the completion thread, which must not wait for completions to be
+/// reaped.
+thread_local bool is_completion_thread = false;
+
+/// Delay before retrying a submission that the kernel could not accept.
+constexpr absl::Duration kSubmitBackoff = absl::Microseconds(100);
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int ring_fd, unsigned opcode, void* arg,
+                    unsigned nr_args) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+/// Operations used by the engine; all must be reported as supported by the
+/// kernel for `Create` to succeed.
+constexpr uint8_t kRequiredOps[] = {IORING_OP_NOP, IORING_OP_READ,
+                                    IORING_OP_FSYNC, IORING_OP_RENAMEAT};
+
+/// Memory region shared with the kernel, unmapped on destruction.
+struct MappedRegion {
+  MappedRegion() = default;
+  MappedRegion(const MappedRegion&) = delete;
+  MappedRegion& operator=(const MappedRegion&) = delete;
+  ~MappedRegion() {
+    if (data != MAP_FAILED) ::munmap(data, size);
+  }
+
+  bool Map(int ring_fd, size_t map_size, off_t offset) {
+    size = map_size;
+    data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+    return data != MAP_FAILED;
+  }
+
+  template <typename T>
+  T* at(uint32_t offset) const {
+    return reinterpret_cast<T*>(static_cast<char*>(data) + offset);
+  }
+
+  void* data = MAP_FAILED;
+  size_t size = 0;
+};
+
+/// Submitted operation.  The address is used as the `user_data` of the
+/// submission queue entry; a `user_data` of 0 identifies a wakeup request.
+struct Operation {
+  ::io_uring_sqe sqe;
+  IoUringEngine::Callback callback;
+};
+
+std::unique_ptr<Operation> MakeOperation(uint8_t opcode,
+                                         IoUringEngine::Callback callback) {
+  auto op = std::make_unique<Operation>();
+  std::memset(&op->sqe, 0, sizeof(op->sqe));
+  op->sqe.opcode = opcode;
+  op->callback = std::move(callback);
+  return op;
+}
+
+}  // namespace
+
+class IoUringEngine::Impl {
+ public:
+  ~Impl() {
+    if (ring_fd_ != -1) ::close(ring_fd_);
+  }
+
+  absl::Status Init(uint32_t queue_depth);
+
+  /// Queues `op` for submission.  Never blocks: if the ring is full, the
+  /// operation is deferred until completions free up space.
+  void Submit(std::unique_ptr<Operation> op);
+
+  /// Requests that the completion thread exit once no operations remain.
+  void RequestStop();
+
+  /// Body of the completion thread.
+  void Run();
+
+ private:
+  /// Copies `op` (or a wakeup request, if `op == nullptr`) into the next free
+  /// submission queue entry.
+  void PushSqe(Operation* op) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Notifies the kernel of any entries added by `PushSqe`.
+  ///
+  /// If the kernel is temporarily unable to accept them, the entries remain
+  /// queued: they are submitted by `Run` after its next reap, or, on threads
+  /// other than the completion thread, after backing off.
+  void Flush();
+
+  int ring_fd_ = -1;
+  MappedRegion sq_ring_;
+  MappedRegion cq_ring_;
+  MappedRegion sqes_;
+
+  unsigned* sq_tail_;
+  unsigned sq_mask_;
+  unsigned* sq_array_;
+  ::io_uring_sqe* sqe_array_;
+
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned cq_mask_;
+  ::io_uring_cqe* cqes_;
+
+  /// Maximum number of operations submitted to the kernel at once.  Bounded
+  /// by the submission queue size, which also guarantees that the completion
+  /// queue (twice as large) never overflows.
+  size_t capacity_;
+
+  absl::Mutex mutex_;
+
+  /// Number of operations (and wakeup requests) currently owned by the kernel.
+  size_t in_kernel_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// Number of operations whose callbacks have not yet returned, including
+  /// deferred operations.
+  size_t outstanding_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// Operations waiting for space in the submission queue.
+  std::deque<std::unique_ptr<Operation>> deferred_ ABSL_GUARDED_BY(mutex_);
+
+  bool stop_requested_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+absl::Status IoUringEngine::Impl::Init(uint32_t queue_depth) {
+  ::io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(std::max(queue_depth, uint32_t(1)), &params);
+  if (ring_fd_ < 0) {
+    ring_fd_ = -1;
+    return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                       "io_uring_setup failed");
+  }
+
+  {
+    // Verify that all required operations are supported.
+    constexpr unsigned kMaxProbeOps = 256;
+    std::vector<char> probe_buffer(sizeof(::io_uring_probe) +
+                                   kMaxProbeOps * sizeof(::io_uring_probe_op));
+    auto* probe = reinterpret_cast<::io_uring_probe*>(probe_buffer.data());
+    if (IoUringRegister(ring_fd_, IORING_REGISTER_PROBE, probe,
+                        kMaxProbeOps) < 0) {
+      return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                         "io_uring probe failed");
+    }
+    for (uint8_t op : kRequiredOps) {
+      if (op > probe->last_op ||
+          !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+        return absl::UnimplementedError(
+            "io_uring does not support required operations");
+      }
+    }
+  }
+
+  size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  size_t cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+  if (!sq_ring_.Map(ring_fd_, sq_size, IORING_OFF_SQ_RING) ||
+      !cq_ring_.Map(ring_fd_, cq_size, IORING_OFF_CQ_RING) ||
+      !sqes_.Map(ring_fd_, params.sq_entries * sizeof(::io_uring_sqe),
+                 IORING_OFF_SQES)) {
+    return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                       "Failed to map io_uring");
+  }
+
+  sq_tail_ = sq_ring_.at<unsigned>(params.sq_off.tail);
+  sq_mask_ = *sq_ring_.at<unsigned>(params.sq_off.ring_mask);
+  sq_array_ = sq_ring_.at<unsigned>(params.sq_off.array);
+  sqe_array_ = static_cast<::io_uring_sqe*>(sqes_.data);
+
+  cq_head_ = cq_ring_.at<unsigned>(params.cq_off.head);
+  cq_tail_ = cq_ring_.at<unsigned>(params.cq_off.tail);
+  cq_mask_ = *cq_ring_.at<unsigned>(params.cq_off.ring_mask);
+  cqes_ = cq_ring_.at<::io_uring_cqe>(params.cq_off.cqes);
+
+  // Reserve one entry for wakeup requests.
+  capacity_ = std::max(std::min(params.sq_entries, params.cq_entries),
+                       unsigned(2)) -
+              1;
+  return absl::OkStatus();
+}
+
+void IoUringEngine::Impl::PushSqe(Operation* op) {
+  // Only one thread pushes at a time (`mutex_` is held), so the tail may be
+  // read without synchronization.
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & sq_mask_;
+  ::io_uring_sqe& sqe = sqe_array_[index];
+  if (op) {
+    sqe = op->sqe;
+    sqe.user_data = reinterpret_cast<uint64_t>(op);
+  } else {
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_NOP;
+  }
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++in_kernel_;
+}
+
+void IoUringEngine::Impl::Flush() {
+  // Submits all entries pushed so far.  Concurrent calls are harmless: the
+  // kernel submits whatever entries are available, possibly none.
+  while (IoUringEnter(ring_fd_, capacity_ + 1, 0, 0) < 0) {
+    if (errno == EINTR) continue;
+    if (errno != EAGAIN && errno != EBUSY) {
+      ABSL_LOG(ERROR) << "io_uring_enter failed: "
+                      << internal::GetOsErrorMessage(errno);
+      return;
+    }
+    // The kernel is out of resources, or completions must be reaped first.
+    // Only the completion thread reaps completions, so it must not wait here;
+    // `Run` submits the queued entries after its next reap.
+    if (is_completion_thread) return;
+    absl::SleepFor(kSubmitBackoff);
+  }
+}
+
+void IoUringEngine::Impl::Submit(std::unique_ptr<Operation> op) {
+  io_uring_submitted.Increment();
+  io_uring_outstanding.Increment();
+  {
+    absl::MutexLock lock(&mutex_);
+    ++outstanding_;
+    if (in_kernel_ >= capacity_ || !deferred_.empty()) {
+      deferred_.push_back(std::move(op));
+      return;
+    }
+    PushSqe(op.release());
+  }
+  Flush();
+}
+
+void IoUringEngine::Impl::RequestStop() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stop_requested_ = true;
+    // Wake up the completion thread so that it notices the request.
+    PushSqe(nullptr);
+  }
+  Flush();
+}
+
+void IoUringEngine::Impl::Run() {
+  is_completion_thread = true;
+  std::vector<std::pair<std::unique_ptr<Operation>, int32_t>> completed;
+  while (true) {
+    // Submit any entries that `Flush` left queued, and wait for a completion.
+    bool backoff = false;
+    if (IoUringEnter(ring_fd_, capacity_ + 1, 1, IORING_ENTER_GETEVENTS) < 0) {
+      if (errno == EAGAIN || errno == EBUSY) {
+        backoff = true;
+      } else if (errno != EINTR) {
+        ABSL_LOG(FATAL) << "io_uring_enter failed: "
+                        << internal::GetOsErrorMessage(errno);
+      }
+    }
+
+    // Only this thread consumes completions, so the head may be read without
+    // synchronization.
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    size_t num_reaped = tail - head;
+    for (; head != tail; ++head) {
+      const ::io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      if (cqe.user_data == 0) continue;
+      completed.emplace_back(reinterpret_cast<Operation*>(cqe.user_data),
+                             cqe.res);
+    }
+    __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+    // If nothing could be reaped, avoid spinning while the kernel is out of
+    // resources.
+    if (backoff && num_reaped == 0) absl::SleepFor(kSubmitBackoff);
+
+    bool submitted_deferred = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      in_kernel_ -= num_reaped;
+      while (in_kernel_ < capacity_ && !deferred_.empty()) {
+        PushSqe(deferred_.front().release());
+        deferred_.pop_front();
+        submitted_deferred = true;
+      }
+    }
+    if (submitted_deferred) Flush();
+
+    for (auto& [op, result] : completed) {
+      std::move(op->callback)(result);
+    }
+    size_t num_completed = completed.size();
+    completed.clear();
+    io_uring_outstanding.DecrementBy(num_completed);
+
+    absl::MutexLock lock(&mutex_);
+    // Callbacks may have submitted additional operations, which are accounted
+    // for before the callbacks return.
+    outstanding_ -= num_completed;
+    if (stop_requested_ && outstanding_ == 0 && in_kernel_ == 0) return;
+  }
+}
+
+Result<std::unique_ptr<IoUringEngine>> IoUringEngine::Create(
+    uint32_t queue_depth) {
+  auto impl = std::make_shared<Impl>();
+  TENSORSTORE_RETURN_IF_ERROR(impl->Init(queue_depth));
+  internal::Thread::StartDetached({"tensorstore_io_uring"},
+                                  [impl] { impl->Run(); });
+  return std::unique_ptr<IoUringEngine>(new IoUringEngine(std::move(impl)));
+}
+
+IoUringEngine::~IoUringEngine() { impl_->RequestStop(); }
+
+void IoUringEngine::Read(int fd, void* buf, uint32_t count, uint64_t offset,
+                         Callback callback) {
+  auto op = MakeOperation(IORING_OP_READ, std::move(callback));
+  op->sqe.fd = fd;
+  op->sqe.addr = reinterpret_cast<uint64_t>(buf);
+  op->sqe.len = count;
+  op->sqe.off = offset;
+  impl_->Submit(std::move(op));
+}
+
+void IoUringEngine::Fsync(int fd, Callback callback) {
+  auto op = MakeOperation(IORING_OP_FSYNC, std::move(callback));
+  op->sqe.fd = fd;
+  impl_->Submit(std::move(op));
+}
+
+void IoUringEngine::Rename(const char* old_path, const char* new_path,
+                           Callback callback) {
+  auto op = MakeOperation(IORING_OP_RENAMEAT, std::move(callback));
+  op->sqe.fd = AT_FDCWD;
+  op->sqe.addr = reinterpret_cast<uint64_t>(old_path);
+  // The new directory file descriptor is specified by the `len` field.
+  op->sqe.len = static_cast<uint32_t>(AT_FDCWD);
+  op->sqe.addr2 = reinterpret_cast<uint64_t>(new_path);
+  impl_->Submit(std::move(op));
+}
+
+#else  // !defined(__linux__)
+
+class IoUringEngine::Impl {};
+
+Result<std::unique_ptr<IoUringEngine>> IoUringEngine::Create(
+    uint32_t queue_depth) {
+  return absl::UnimplementedError("io_uring is only supported on Linux");
+}
+
+IoUringEngine::~IoUringEngine() = default;
+
+void IoUringEngine::Read(int fd, void* buf, uint32_t count, uint64_t offset,
+                         Callback callback) {
+  ABSL_UNREACHABLE();  // COV_NF_LINE
+}
+
+void IoUringEngine::Fsync(int fd, Callback callback) {
+  ABSL_UNREACHABLE();  // COV_NF_LINE
+}
+
+void IoUringEngine::Rename(const char* old_path, const char* new_path,
+                           Callback callback) {
+  ABSL_UNREACHABLE();  // COV_NF_LINE
+}
+
+#endif  // !defined(__linux__)
+
+IoUringEngine::IoUringEngine(std::shared_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
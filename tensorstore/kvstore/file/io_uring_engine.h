@@ -0,0 +1,80 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_IO_URING_ENGINE_H_
+#define TENSORSTORE_KVSTORE_FILE_IO_URING_ENGINE_H_
+
+/// \file Minimal io_uring-based asynchronous I/O engine used by the "file"
+/// driver on Linux.
+///
+/// All operations share a single submission queue.  Completions are reaped by
+/// a dedicated thread, which also invokes the completion callbacks.  Callbacks
+/// must therefore be inexpensive; any substantial work should be handed off to
+/// an executor.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "absl/functional/any_invocable.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+class IoUringEngine {
+ public:
+  /// Invoked on the completion thread with the result of the operation: a
+  /// non-negative value on success, or the negated `errno` value on failure.
+  using Callback = absl::AnyInvocable<void(int32_t result) &&>;
+
+  class Impl;
+
+  /// Creates a new engine with the specified submission queue depth.
+  ///
+  /// Returns an error if io_uring is not supported on this platform, or if the
+  /// kernel does not support all of the operations required by the engine.
+  static Result<std::unique_ptr<IoUringEngine>> Create(uint32_t queue_depth);
+
+  /// Requests that the completion thread stop once all outstanding operations
+  /// have completed.  Does not block.
+  ~IoUringEngine();
+
+  /// Reads up to `count` bytes from `fd` at `offset` into `buf`.
+  ///
+  /// The result is the number of bytes read, which may be less than `count`.
+  void Read(int fd, void* buf, uint32_t count, uint64_t offset,
+            Callback callback);
+
+  /// Equivalent to `fsync(fd)`.
+  void Fsync(int fd, Callback callback);
+
+  /// Equivalent to `rename(old_path, new_path)`.
+  ///
+  /// The path strings must remain valid until `callback` is invoked.
+  void Rename(const char* old_path, const char* new_path, Callback callback);
+
+ private:
+  explicit IoUringEngine(std::shared_ptr<Impl> impl);
+
+  // Shared with the completion thread, which outlives `this` until all
+  // outstanding operations have completed.
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_IO_URING_ENGINE_H_
@@ -0,0 +1,153 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+
+#include <stdint.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "tensorstore/internal/test_util.h"
+
+// Include system headers last to reduce impact of macros.
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+
+using ::tensorstore::internal_file_util::IoUringEngine;
+
+std::unique_ptr<IoUringEngine> CreateEngineOrSkip(uint32_t queue_depth) {
+  auto engine = IoUringEngine::Create(queue_depth);
+  if (!engine.ok()) return nullptr;
+  return std::move(*engine);
+}
+
+std::string WriteTestFile(const std::string& path, size_t size) {
+  std::string contents(size, '\0');
+  for (size_t i = 0; i < size; ++i) contents[i] = static_cast<char>(i % 251);
+  std::ofstream(path, std::ios::binary) << contents;
+  return contents;
+}
+
+TEST(IoUringEngineTest, Read) {
+  auto engine = CreateEngineOrSkip(8);
+  if (!engine) GTEST_SKIP() << "io_uring not supported";
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string path = tempdir.path() + "/a";
+  auto contents = WriteTestFile(path, 1000);
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  ASSERT_NE(-1, fd);
+
+  std::string buffer(500, '\0');
+  absl::Notification done;
+  int32_t read_result;
+  engine->Read(fd, buffer.data(), buffer.size(), 100, [&](int32_t result) {
+    read_result = result;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_EQ(500, read_result);
+  EXPECT_EQ(contents.substr(100, 500), buffer);
+  ::close(fd);
+}
+
+// Submits more operations than the queue depth, which requires deferring
+// submission until earlier operations complete.
+TEST(IoUringEngineTest, ManyReads) {
+  auto engine = CreateEngineOrSkip(2);
+  if (!engine) GTEST_SKIP() << "io_uring not supported";
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string path = tempdir.path() + "/a";
+  constexpr size_t kNumReads = 100;
+  constexpr size_t kReadSize = 100;
+  auto contents = WriteTestFile(path, kNumReads * kReadSize);
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  ASSERT_NE(-1, fd);
+
+  std::string buffer(contents.size(), '\0');
+  std::vector<int32_t> results(kNumReads);
+  absl::BlockingCounter remaining(kNumReads);
+  for (size_t i = 0; i < kNumReads; ++i) {
+    engine->Read(fd, buffer.data() + i * kReadSize, kReadSize, i * kReadSize,
+                 [&, i](int32_t result) {
+                   results[i] = result;
+                   remaining.DecrementCount();
+                 });
+  }
+  remaining.Wait();
+  EXPECT_THAT(results, ::testing::Each(kReadSize));
+  EXPECT_EQ(contents, buffer);
+  ::close(fd);
+}
+
+TEST(IoUringEngineTest, FsyncAndRename) {
+  auto engine = CreateEngineOrSkip(8);
+  if (!engine) GTEST_SKIP() << "io_uring not supported";
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string old_path = tempdir.path() + "/a";
+  std::string new_path = tempdir.path() + "/b";
+  WriteTestFile(old_path, 10);
+  int fd = ::open(old_path.c_str(), O_RDWR | O_CLOEXEC);
+  ASSERT_NE(-1, fd);
+
+  // Chain the rename after the fsync, as the file driver does.
+  absl::Notification done;
+  int32_t fsync_result, rename_result;
+  engine->Fsync(fd, [&](int32_t result) {
+    fsync_result = result;
+    engine->Rename(old_path.c_str(), new_path.c_str(), [&](int32_t result) {
+      rename_result = result;
+      done.Notify();
+    });
+  });
+  done.WaitForNotification();
+  EXPECT_EQ(0, fsync_result);
+  EXPECT_EQ(0, rename_result);
+  EXPECT_NE(0, ::access(old_path.c_str(), F_OK));
+  EXPECT_EQ(0, ::access(new_path.c_str(), F_OK));
+  ::close(fd);
+}
+
+TEST(IoUringEngineTest, Error) {
+  auto engine = CreateEngineOrSkip(8);
+  if (!engine) GTEST_SKIP() << "io_uring not supported";
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string old_path = tempdir.path() + "/missing";
+  std::string new_path = tempdir.path() + "/b";
+  absl::Notification done;
+  int32_t rename_result;
+  engine->Rename(old_path.c_str(), new_path.c_str(), [&](int32_t result) {
+    rename_result = result;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_EQ(-ENOENT, rename_result);
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
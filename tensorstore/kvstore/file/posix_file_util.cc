@@ -17,6 +17,7 @@
 #include "tensorstore/kvstore/file/posix_file_util.h"
 
 // More system headers
+#include <sys/mman.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
@@ -61,6 +62,37 @@ UniqueFileDescriptor OpenFileForWriting(const std::string& path) {
   return fd;
 }
 
+bool MemoryMapFile(FileDescriptor fd, std::int64_t offset, std::size_t size,
+                   absl::Cord* value) {
+  static const std::int64_t page_size = ::sysconf(_SC_PAGESIZE);
+  // `mmap` requires the offset to be a multiple of the page size.
+  const std::size_t page_offset = offset % page_size;
+  const std::size_t map_size = size + page_offset;
+  void* data;
+  {
+    PotentiallyBlockingRegion region;
+    data = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd,
+                  offset - page_offset);
+  }
+  if (data == MAP_FAILED) return false;
+  // Accessing a mapped page beyond the end of the file raises `SIGBUS` rather
+  // than returning an error.  If the file was truncated (by another process)
+  // since its size was checked by the caller, unmap it and let the caller fall
+  // back to `pread`, which reports the change in length as an error.
+  FileInfo info;
+  if (!GetFileInfo(fd, &info) ||
+      GetSize(info) < static_cast<std::uint64_t>(offset) + size) {
+    ::munmap(data, map_size);
+    return false;
+  }
+  // The caller is expected to consume the entire range.
+  ::madvise(data, map_size, MADV_WILLNEED);
+  *value = absl::MakeCordFromExternal(
+      absl::string_view(static_cast<const char*>(data) + page_offset, size),
+      [data, map_size] { ::munmap(data, map_size); });
+  return true;
+}
+
 std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value) {
   absl::InlinedVector<iovec, 16> iovs;
 
@@ -178,6 +178,25 @@ inline std::ptrdiff_t WriteToFile(FileDescriptor fd, const void* buf,
   return n;
 }
 
+/// Memory maps a range of an open file.
+///
+/// The file must not be truncated or modified in place while the mapping is
+/// referenced.  This holds for value files of the "file" driver, which are
+/// only ever replaced via `rename`.  The size of the file is re-checked after
+/// mapping, and `false` is returned if the range is no longer within the file,
+/// but truncation by another process after that point causes subsequent
+/// accesses to the mapped memory to raise `SIGBUS`.
+///
+/// \param fd Open file descriptor.
+/// \param offset Byte offset within file of the start of the range.
+/// \param size Non-zero size in bytes of the range.
+/// \param value[out] Set on success to a flat Cord referencing the mapped
+///     memory.  The mapping is released once the Cord is no longer referenced.
+/// \returns `true` on success, or `false` in case of an error (in which case
+///     `GetLastErrorCode()` retrieves the error).
+bool MemoryMapFile(FileDescriptor fd, std::int64_t offset, std::size_t size,
+                   absl::Cord* value);
+
 /// Writes an absl::Cord to an open file.
 ///
 /// \param fd Open file descriptor.
@@ -254,6 +273,27 @@ inline bool FsyncFile(FileDescriptor fd) { return ::fsync(fd) == 0; }
 ///     retrieve the error).
 inline bool FsyncDirectory(FileDescriptor fd) { return ::fsync(fd) == 0; }
 
+/// Indicates whether `SyncFileSystem` syncs all files on the filesystem, rather
+/// than just the specified file.
+#ifdef __linux__
+inline constexpr bool kSyncFileSystemSyncsAllFiles = true;
+#else
+inline constexpr bool kSyncFileSystemSyncsAllFiles = false;
+#endif
+
+/// Syncs the filesystem containing an open file descriptor, or, if
+/// `!kSyncFileSystemSyncsAllFiles`, just the file itself.
+///
+/// \returns `true` on success, `false` on error (call `GetLastErrorCode()` to
+///     retrieve the error).
+inline bool SyncFileSystem(FileDescriptor fd) {
+#ifdef __linux__
+  return ::syncfs(fd) == 0;
+#else
+  return ::fsync(fd) == 0;
+#endif
+}
+
 struct DirectoryDeleter {
   void operator()(::DIR* d) { ::closedir(d); }
 };
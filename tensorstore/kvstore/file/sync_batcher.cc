@@ -0,0 +1,77 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/sync_batcher.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/metrics/counter.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+namespace {
+
+auto& group_commit_requests = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/group_commit/requests",
+    "Sync requests made in group_commit mode by the file kvstore driver");
+
+auto& group_commit_syncs = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/group_commit/syncs",
+    "Syncs performed in group_commit mode by the file kvstore driver");
+
+}  // namespace
+
+absl::Status SyncBatcher::Sync(std::string_view key,
+                               absl::FunctionRef<absl::Status()> sync) {
+  group_commit_requests.Increment();
+  absl::MutexLock lock(&mutex_);
+  auto& entry_ptr = entries_[key];
+  if (!entry_ptr) entry_ptr = std::make_unique<Entry>();
+  Entry& entry = *entry_ptr;
+  ++entry.num_callers;
+  if (!entry.pending) entry.pending = std::make_shared<Batch>();
+  std::shared_ptr<Batch> batch = entry.pending;
+
+  // Wait until either another caller has completed the sync for `batch`, or no
+  // sync is in progress, in which case this caller performs the sync.
+  const auto can_proceed = [&] { return batch->done || !entry.syncing; };
+  mutex_.Await(absl::Condition(&can_proceed));
+  if (!batch->done) {
+    // Close the batch; later callers must wait for the next sync.
+    entry.syncing = true;
+    entry.pending = nullptr;
+    mutex_.Unlock();
+    group_commit_syncs.Increment();
+    absl::Status status = sync();
+    mutex_.Lock();
+    batch->status = std::move(status);
+    batch->done = true;
+    entry.syncing = false;
+  }
+  absl::Status status = batch->status;
+  if (--entry.num_callers == 0) {
+    entries_.erase(key);
+  }
+  return status;
+}
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
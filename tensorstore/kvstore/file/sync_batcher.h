@@ -0,0 +1,81 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_SYNC_BATCHER_H_
+#define TENSORSTORE_KVSTORE_FILE_SYNC_BATCHER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+/// Coalesces concurrent sync operations ("group commit").
+///
+/// Each call to `Sync` must be satisfied by a sync that starts after the call.
+/// While a sync for a given key is in progress, subsequent callers with the
+/// same key join a single pending batch; once the in-progress sync completes,
+/// one of the waiting callers performs the sync on behalf of the entire batch,
+/// and all callers in the batch receive its status.
+///
+/// The sync function supplied by each caller must therefore be
+/// interchangeable with that of any other caller using the same key, e.g. an
+/// `fsync` of the same directory.
+class SyncBatcher {
+ public:
+  /// Blocks until a sync for `key`, started after this call, has completed.
+  ///
+  /// \param key Identifies the set of interchangeable sync operations.
+  /// \param sync Function that performs the sync.  Invoked on the calling
+  ///     thread, without any lock held, if this caller is chosen to perform the
+  ///     sync for its batch.
+  /// \returns The status returned by the sync function that was invoked for
+  ///     the batch.
+  absl::Status Sync(std::string_view key,
+                    absl::FunctionRef<absl::Status()> sync);
+
+ private:
+  struct Batch {
+    bool done = false;
+    absl::Status status;
+  };
+
+  struct Entry {
+    // Indicates that a sync is in progress for this key.
+    bool syncing = false;
+    // Batch that will be covered by the next sync, or `nullptr` if there are
+    // no callers waiting for the next sync.
+    std::shared_ptr<Batch> pending;
+    // Number of callers of `Sync` that reference this entry.
+    size_t num_callers = 0;
+  };
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_SYNC_BATCHER_H_
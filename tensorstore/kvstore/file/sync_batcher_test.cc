@@ -0,0 +1,117 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/sync_batcher.h"
+
+#include <stddef.h>
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "tensorstore/internal/thread.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::Thread;
+using ::tensorstore::internal_file_util::SyncBatcher;
+
+TEST(SyncBatcherTest, Single) {
+  SyncBatcher batcher;
+  int num_syncs = 0;
+  TENSORSTORE_EXPECT_OK(batcher.Sync("a", [&] {
+    ++num_syncs;
+    return absl::OkStatus();
+  }));
+  TENSORSTORE_EXPECT_OK(batcher.Sync("a", [&] {
+    ++num_syncs;
+    return absl::OkStatus();
+  }));
+  EXPECT_EQ(2, num_syncs);
+}
+
+// While a sync is blocked, later callers join a single batch, which is synced
+// once the blocked sync completes.
+TEST(SyncBatcherTest, Batching) {
+  constexpr size_t kNumWaiters = 8;
+  SyncBatcher batcher;
+  std::atomic<size_t> num_syncs{0};
+  std::atomic<size_t> num_started{0};
+  absl::Notification first_sync_started, release_first_sync;
+
+  std::vector<Thread> threads;
+  threads.emplace_back(Thread({"sync_batcher_test"}, [&] {
+    TENSORSTORE_EXPECT_OK(batcher.Sync("a", [&] {
+      ++num_syncs;
+      first_sync_started.Notify();
+      release_first_sync.WaitForNotification();
+      return absl::OkStatus();
+    }));
+  }));
+  first_sync_started.WaitForNotification();
+  for (size_t i = 0; i < kNumWaiters; ++i) {
+    threads.emplace_back(Thread({"sync_batcher_test"}, [&] {
+      ++num_started;
+      TENSORSTORE_EXPECT_OK(batcher.Sync("a", [&] {
+        ++num_syncs;
+        return absl::OkStatus();
+      }));
+    }));
+  }
+  // Wait for all waiters to at least start; some may not have joined the
+  // batch yet, in which case they require an additional sync.
+  while (num_started != kNumWaiters) {
+  }
+  release_first_sync.Notify();
+  for (auto& thread : threads) thread.Join();
+  EXPECT_GE(num_syncs, 2);
+  EXPECT_LE(num_syncs, kNumWaiters + 1);
+}
+
+TEST(SyncBatcherTest, DistinctKeys) {
+  SyncBatcher batcher;
+  absl::Notification a_started, release_a;
+  Thread thread({"sync_batcher_test"}, [&] {
+    TENSORSTORE_EXPECT_OK(batcher.Sync("a", [&] {
+      a_started.Notify();
+      release_a.WaitForNotification();
+      return absl::OkStatus();
+    }));
+  });
+  a_started.WaitForNotification();
+  // A sync for a different key does not wait for the in-progress sync.
+  bool b_synced = false;
+  TENSORSTORE_EXPECT_OK(batcher.Sync("b", [&] {
+    b_synced = true;
+    return absl::OkStatus();
+  }));
+  EXPECT_TRUE(b_synced);
+  release_a.Notify();
+  thread.Join();
+}
+
+TEST(SyncBatcherTest, Error) {
+  SyncBatcher batcher;
+  EXPECT_THAT(
+      batcher.Sync("a", [] { return absl::UnknownError("sync failed"); }),
+      MatchesStatus(absl::StatusCode::kUnknown, "sync failed"));
+  TENSORSTORE_EXPECT_OK(batcher.Sync("a", [] { return absl::OkStatus(); }));
+}
+
+}  // namespace
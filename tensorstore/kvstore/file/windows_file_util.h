@@ -94,6 +94,14 @@ std::ptrdiff_t ReadFromFile(FileDescriptor fd, void* buf, std::size_t count,
 std::ptrdiff_t WriteToFile(FileDescriptor fd, const void* buf,
                            std::size_t count);
 
+// Memory mapping is not supported, since a file with a mapped view cannot be
+// replaced by `RenameOpenFile`.
+inline bool MemoryMapFile(FileDescriptor fd, std::int64_t offset,
+                          std::size_t size, absl::Cord* value) {
+  ::SetLastError(ERROR_NOT_SUPPORTED);
+  return false;
+}
+
 std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value);
 
 inline bool TruncateFile(FileDescriptor fd) {
@@ -114,6 +122,11 @@ bool FsyncFile(FileDescriptor fd);
 // Windows does not support fsync on directories.
 inline bool FsyncDirectory(FileDescriptor fd) { return true; }
 
+// Windows does not support syncing an entire volume without administrator
+// privileges.
+inline constexpr bool kSyncFileSystemSyncsAllFiles = false;
+inline bool SyncFileSystem(FileDescriptor fd) { return FsyncFile(fd); }
+
 struct FindHandleTraits {
   static const HANDLE Invalid() { return INVALID_HANDLE_VALUE; }
   static void Close(HANDLE handle) { ::FindClose(handle); }
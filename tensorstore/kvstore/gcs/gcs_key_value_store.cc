@@ -51,6 +51,7 @@
 #include "tensorstore/internal/retries_context_resource.h"
 #include "tensorstore/internal/retry.h"
 #include "tensorstore/internal/schedule_at.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/gcs/admission_queue.h"
@@ -642,6 +643,12 @@ struct ReadTask : public RateLimiterNode,
 
 Future<kvstore::ReadResult> GcsKeyValueStore::Read(Key key,
                                                    ReadOptions options) {
+  if (options.batch) {
+    // Requests to GCS have high latency, so larger gaps are worth reading.
+    return internal_kvstore_batch::DeferRead(this, std::move(key),
+                                             std::move(options),
+                                             /*max_gap_bytes=*/256 * 1024);
+  }
   gcs_read.Increment();
   if (!IsValidObjectName(key)) {
     return absl::InvalidArgumentError("Invalid GCS object name");
@@ -44,6 +44,7 @@
 #include "tensorstore/internal/path.h"
 #include "tensorstore/internal/retries_context_resource.h"
 #include "tensorstore/internal/retry.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/kvstore.h"
@@ -387,6 +388,11 @@ struct ReadTask {
 
 Future<kvstore::ReadResult> HttpKeyValueStore::Read(Key key,
                                                     ReadOptions options) {
+  if (options.batch) {
+    return internal_kvstore_batch::DeferRead(this, std::move(key),
+                                             std::move(options),
+                                             /*max_gap_bytes=*/256 * 1024);
+  }
   std::string url = spec_.GetUrl(key);
   return MapFuture(executor(), ReadTask{IntrusivePtr<HttpKeyValueStore>(this),
                                         std::move(url), std::move(options)});
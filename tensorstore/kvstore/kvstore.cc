@@ -215,6 +215,26 @@ Future<const void> Driver::DeleteRange(KeyRange range) {
       "KeyValueStore does not support deleting by range");
 }
 
+Future<StagedWrite> Driver::StageWrite(Key key, Value value) {
+  return absl::UnimplementedError(
+      "KeyValueStore does not support staged writes");
+}
+
+Future<ReadResult> Driver::ReadStagedWrite(const StagedWrite& staged) {
+  return absl::UnimplementedError(
+      "KeyValueStore does not support staged writes");
+}
+
+Future<TimestampedStorageGeneration> Driver::CommitStagedWrite(
+    Key key, const StagedWrite& staged, WriteOptions options) {
+  return absl::UnimplementedError(
+      "KeyValueStore does not support staged writes");
+}
+
+Future<const void> Driver::DiscardStagedWrite(const StagedWrite& staged) {
+  return absl::OkStatus();
+}
+
 void Driver::ListImpl(ListOptions options,
                       AnyFlowReceiver<absl::Status, Key> receiver) {
   execution::submit(FlowSingleSender{ErrorSender{absl::UnimplementedError(
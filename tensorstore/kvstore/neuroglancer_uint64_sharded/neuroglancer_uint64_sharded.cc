@@ -14,14 +14,19 @@
 
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/neuroglancer_uint64_sharded.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/algorithm/container.h"
 #include "absl/base/internal/endian.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/cache/async_cache.h"
 #include "tensorstore/internal/cache/cache_pool_resource.h"
 #include "tensorstore/internal/cache/kvs_backed_cache.h"
@@ -53,6 +58,151 @@ namespace {
 using ::tensorstore::internal::ConvertInvalidArgumentToFailedPrecondition;
 using ::tensorstore::internal::IntrusivePtr;
 
+/// Maximum number of shard index entries (16 bytes each) retrieved by a single
+/// read of the shard index.
+///
+/// If the index cache pool retains entries, shard indices with at most this
+/// many minishards are read in their entirety by a single request, which makes
+/// subsequent minishard index lookups within the same shard require only a
+/// single additional request.  Larger shard indices are read in blocks of this
+/// many entries.
+///
+/// If the index cache pool does not retain entries, the block would be
+/// discarded immediately, and only the single required entry is read.
+constexpr std::uint64_t kMaxShardIndexEntriesPerRead = 4096;
+
+/// Returns the number of shard index entries per `ShardIndexBlock` for shard
+/// indices cached in `cache_pool`.
+std::uint64_t GetShardIndexEntriesPerBlock(
+    const internal::CachePool& cache_pool) {
+  return cache_pool.limits().total_bytes_limit > 0
+             ? kMaxShardIndexEntriesPerRead
+             : 1;
+}
+
+/// Identifies a block of consecutive shard index entries.
+///
+/// Used (in native memory layout) as the key of `ShardIndexKeyValueStore` and
+/// `ShardIndexCache`.
+struct ShardIndexBlock {
+  std::uint64_t shard;
+  std::uint64_t block;
+};
+
+/// Returns the range of minishards whose shard index entries are contained in
+/// `block`, where each block contains `entries_per_block` entries.
+std::pair<std::uint64_t, std::uint64_t> GetShardIndexBlockMinishards(
+    const ShardingSpec& sharding_spec, std::uint64_t entries_per_block,
+    std::uint64_t block) {
+  const std::uint64_t begin = block * entries_per_block;
+  return {begin, std::min(begin + entries_per_block,
+                          sharding_spec.num_minishards())};
+}
+
+/// Read-only KeyValueStore for retrieving a block of a shard index.
+///
+/// The key is a `ShardIndexBlock` (in native memory layout).  The value is the
+/// encoded shard index entries for the block.
+///
+/// This is used by `ShardIndexCache`, analogous to how
+/// `MinishardIndexKeyValueStore` is used by `MinishardIndexCache`.
+class ShardIndexKeyValueStore : public kvstore::Driver {
+ public:
+  explicit ShardIndexKeyValueStore(kvstore::DriverPtr base,
+                                   std::string key_prefix,
+                                   const ShardingSpec& sharding_spec,
+                                   std::uint64_t entries_per_block)
+      : base_(std::move(base)),
+        key_prefix_(std::move(key_prefix)),
+        sharding_spec_(sharding_spec),
+        entries_per_block_(entries_per_block) {}
+
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    ShardIndexBlock block;
+    if (key.size() != sizeof(block)) {
+      return absl::InvalidArgumentError("Key does not specify a shard");
+    }
+    std::memcpy(&block, key.data(), sizeof(block));
+    if (options.byte_range != OptionalByteRangeRequest()) {
+      // Byte range requests are not useful for shard indices.
+      return absl::InvalidArgumentError("Byte ranges not supported");
+    }
+    const auto [begin, end] = GetShardIndexBlockMinishards(
+        sharding_spec_, entries_per_block_, block.block);
+    options.byte_range = ByteRange{static_cast<int64_t>(begin * 16),
+                                   static_cast<int64_t>(end * 16)};
+    return base_->Read(GetShardKey(sharding_spec_, key_prefix_, block.shard),
+                       std::move(options));
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    ShardIndexBlock block;
+    if (key.size() != sizeof(block)) {
+      return tensorstore::StrCat("invalid key ", tensorstore::QuoteString(key));
+    }
+    std::memcpy(&block, key.data(), sizeof(block));
+    return tensorstore::StrCat(
+        "shard index in ",
+        base_->DescribeKey(
+            GetShardKey(sharding_spec_, key_prefix_, block.shard)));
+  }
+
+  void GarbageCollectionVisit(
+      garbage_collection::GarbageCollectionVisitor& visitor) const final {
+    // No-op
+  }
+
+ private:
+  kvstore::DriverPtr base_;
+  std::string key_prefix_;
+  ShardingSpec sharding_spec_;
+  std::uint64_t entries_per_block_;
+};
+
+/// Caches blocks of shard indices.
+///
+/// Each cache entry corresponds to a `ShardIndexBlock`.  The cached data is
+/// the encoded shard index entries, which are decoded individually as needed.
+///
+/// This cache is only used for reading.
+class ShardIndexCache
+    : public internal::KvsBackedCache<ShardIndexCache, internal::AsyncCache> {
+  using Base = internal::KvsBackedCache<ShardIndexCache, internal::AsyncCache>;
+
+ public:
+  using ReadData = absl::Cord;
+
+  class Entry : public Base::Entry {
+   public:
+    using OwningCache = ShardIndexCache;
+
+    std::size_t ComputeReadDataSizeInBytes(const void* read_data) override {
+      return static_cast<const ReadData*>(read_data)->size();
+    }
+
+    void DoDecode(std::optional<absl::Cord> value,
+                  DecodeReceiver receiver) override {
+      std::shared_ptr<ReadData> read_data;
+      if (value) read_data = std::make_shared<ReadData>(std::move(*value));
+      execution::set_value(receiver, std::move(read_data));
+    }
+  };
+
+  Entry* DoAllocateEntry() final { return new Entry; }
+  std::size_t DoGetSizeofEntry() final { return sizeof(Entry); }
+  TransactionNode* DoAllocateTransactionNode(AsyncCache::Entry& entry) final {
+    return new TransactionNode(static_cast<Entry&>(entry));
+  }
+
+  explicit ShardIndexCache(kvstore::DriverPtr base_kvstore,
+                           std::string key_prefix,
+                           const ShardingSpec& sharding_spec,
+                           std::uint64_t entries_per_block)
+      : Base(kvstore::DriverPtr(new ShardIndexKeyValueStore(
+            std::move(base_kvstore), std::move(key_prefix), sharding_spec,
+            entries_per_block))) {}
+};
+
 /// Read-only KeyValueStore for retrieving a minishard index
 ///
 /// The key is a `ChunkCombinedShardInfo` (in native memory layout).  The value
@@ -67,11 +217,19 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
   explicit MinishardIndexKeyValueStore(kvstore::DriverPtr base,
                                        Executor executor,
                                        std::string key_prefix,
-                                       const ShardingSpec& sharding_spec)
+                                       const ShardingSpec& sharding_spec,
+                                       internal::CachePool::WeakPtr cache_pool)
       : base_(std::move(base)),
         executor_(std::move(executor)),
         key_prefix_(key_prefix),
-        sharding_spec_(sharding_spec) {}
+        sharding_spec_(sharding_spec),
+        shard_index_entries_per_block_(
+            GetShardIndexEntriesPerBlock(*cache_pool)),
+        shard_index_cache_(cache_pool->GetCache<ShardIndexCache>("", [&] {
+          return std::make_unique<ShardIndexCache>(
+              base_, key_prefix_, sharding_spec_,
+              shard_index_entries_per_block_);
+        })) {}
 
   Future<ReadResult> Read(Key key, ReadOptions options) override {
     ChunkCombinedShardInfo combined_info;
@@ -120,7 +278,12 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
               ReadOptions options) {
     // Reading a minishard index proceeds as follows:
     //
-    // 1. Request the shard index.
+    // 1. Request the block of the shard index containing the entry for the
+    //    minishard from `shard_index_cache_`.  If the index cache pool retains
+    //    entries, the entire shard index (or a large block of it) is read at
+    //    once and cached, such that reading the indices of other minishards in
+    //    the same shard does not require reading the shard index again.
+    //    Otherwise, only the single entry is read.
     //
     //    a. If not found, the minishard is empty.  Done.
     //
@@ -172,8 +335,9 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
 
     struct ShardIndexReadyCallback {
       IntrusivePtr<MinishardIndexKeyValueStore> self;
+      internal::PinnedCacheEntry<ShardIndexCache> entry;
       ChunkSplitShardInfo split_info;
-      absl::Time staleness_bound;
+      ReadOptions options;
       static void SetError(const Promise<kvstore::ReadResult>& promise,
                            absl::Status error) {
         promise.SetResult(MaybeAnnotateStatus(
@@ -182,21 +346,49 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
       }
 
       void operator()(Promise<kvstore::ReadResult> promise,
-                      ReadyFuture<kvstore::ReadResult> future) {
-        auto& r = future.result();
-        if (!r) {
-          return SetError(promise, r.status());
+                      ReadyFuture<const void> future) {
+        if (!future.status().ok()) {
+          // Error is already annotated by `ShardIndexCache`.
+          promise.SetResult(
+              ConvertInvalidArgumentToFailedPrecondition(future.status()));
+          return;
         }
-        if (  // Shard is empty (case 1a above)
-            r->aborted() ||
-            // Existing data is up to date (case 1b above).
-            r->not_found()) {
-          promise.SetResult(std::move(r));
+        TimestampedStorageGeneration stamp;
+        std::shared_ptr<const absl::Cord> shard_index;
+        {
+          internal::AsyncCache::ReadLock<ShardIndexCache::ReadData> lock(
+              *entry);
+          stamp = lock.stamp();
+          shard_index = lock.shared_data();
+        }
+        if (!shard_index) {
+          // Shard is empty (case 1a above).
+          promise.SetResult(
+              kvstore::ReadResult{kvstore::ReadResult::kMissing, {}, stamp});
+          return;
+        }
+        if (options.if_not_equal == stamp.generation ||
+            (!StorageGeneration::IsUnknown(options.if_equal) &&
+             options.if_equal != stamp.generation)) {
+          // Existing data is up to date (case 1b above).
+          promise.SetResult(kvstore::ReadResult{
+              kvstore::ReadResult::kUnspecified, {}, std::move(stamp)});
           return;
         }
         // Read was successful (case 1c above).
+        const std::uint64_t entries_per_block =
+            self->shard_index_entries_per_block_;
+        const std::uint64_t block_begin =
+            GetShardIndexBlockMinishards(self->sharding_spec_,
+                                         entries_per_block,
+                                         split_info.minishard /
+                                             entries_per_block)
+                .first;
+        const std::uint64_t entry_offset =
+            (split_info.minishard - block_begin) * 16;
         ByteRange byte_range;
-        if (auto byte_range_result = DecodeShardIndexEntry(r->value.Flatten());
+        if (auto byte_range_result = DecodeShardIndexEntry(
+                shard_index->Subcord(entry_offset, 16).Flatten());
             byte_range_result.ok()) {
           byte_range = *byte_range_result;
         } else {
@@ -213,16 +405,15 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
         }
         if (byte_range.size() == 0) {
           // Minishard index is 0 bytes, which means the minishard is empty.
-          r->value.Clear();
-          r->state = kvstore::ReadResult::kMissing;
-          promise.SetResult(std::move(r));
+          promise.SetResult(kvstore::ReadResult{
+              kvstore::ReadResult::kMissing, {}, std::move(stamp)});
           return;
         }
         kvstore::ReadOptions kvs_read_options;
         // The `if_equal` condition ensure that an "aborted" `ReadResult` is
         // returned in the case of a concurrent modification (case 2a above).
-        kvs_read_options.if_equal = std::move(r->stamp.generation);
-        kvs_read_options.staleness_bound = staleness_bound;
+        kvs_read_options.if_equal = std::move(stamp.generation);
+        kvs_read_options.staleness_bound = options.staleness_bound;
         kvs_read_options.byte_range = byte_range;
         auto read_future =
             self->base_->Read(GetShardKey(self->sharding_spec_,
@@ -233,22 +424,28 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
              std::move(promise), std::move(read_future));
       }
     };
-    options.byte_range = {split_info.minishard * 16,
-                          (split_info.minishard + 1) * 16};
-    const auto staleness_bound = options.staleness_bound;
+    const ShardIndexBlock block{
+        split_info.shard,
+        split_info.minishard / shard_index_entries_per_block_};
+    auto entry = GetCacheEntry(
+        shard_index_cache_,
+        std::string_view(reinterpret_cast<const char*>(&block), sizeof(block)));
+    auto shard_index_read_future = entry->Read(options.staleness_bound);
     Link(WithExecutor(executor_,
                       ShardIndexReadyCallback{
                           IntrusivePtr<MinishardIndexKeyValueStore>(this),
-                          split_info, staleness_bound}),
-         std::move(promise),
-         base_->Read(GetShardKey(sharding_spec_, key_prefix_, split_info.shard),
-                     std::move(options)));
+                          std::move(entry), split_info, std::move(options)}),
+         std::move(promise), std::move(shard_index_read_future));
   }
 
   kvstore::DriverPtr base_;
   Executor executor_;
   std::string key_prefix_;
   ShardingSpec sharding_spec_;
+  /// Number of shard index entries per `ShardIndexBlock`, as determined by
+  /// `GetShardIndexEntriesPerBlock`.
+  std::uint64_t shard_index_entries_per_block_;
+  internal::CachePtr<ShardIndexCache> shard_index_cache_;
 };
 
 /// Caches minishard indexes.
@@ -315,10 +512,11 @@ class MinishardIndexCache
 
   explicit MinishardIndexCache(kvstore::DriverPtr base_kvstore,
                                Executor executor, std::string key_prefix,
-                               const ShardingSpec& sharding_spec)
+                               const ShardingSpec& sharding_spec,
+                               internal::CachePool::WeakPtr cache_pool)
       : Base(kvstore::DriverPtr(new MinishardIndexKeyValueStore(
             std::move(base_kvstore), executor, std::move(key_prefix),
-            sharding_spec))) {}
+            sharding_spec, std::move(cache_pool)))) {}
 
   MinishardIndexKeyValueStore* kvstore_driver() {
     return static_cast<MinishardIndexKeyValueStore*>(
@@ -850,6 +1048,10 @@ struct MinishardIndexCacheEntryReadyCallback {
     ReadOptions kvs_read_options;
     kvs_read_options.if_equal = stamp.generation;
     kvs_read_options.staleness_bound = options_.staleness_bound;
+    // Reads of chunks within the same shard are coalesced by the base kvstore
+    // if it supports batching.  The minishard index read is not batched, since
+    // this callback holds a reference to the batch until it has been read.
+    kvs_read_options.batch = std::exchange(options_.batch, no_batch);
     assert(options_.byte_range.SatisfiesInvariants());
     OptionalByteRangeRequest post_decode_byte_range;
     const auto data_encoding = cache.sharding_spec().data_encoding;
@@ -923,6 +1125,7 @@ struct MinishardIndexCacheEntryReadyCallback {
 
 struct ShardedKeyValueStoreSpecData {
   Context::Resource<internal::CachePoolResource> cache_pool;
+  Context::Resource<internal::CachePoolResource> index_cache_pool;
   Context::Resource<internal::DataCopyConcurrencyResource>
       data_copy_concurrency;
   kvstore::Spec base;
@@ -933,7 +1136,8 @@ struct ShardedKeyValueStoreSpecData {
                                           ::nlohmann::json::object_t)
 
   constexpr static auto ApplyMembers = [](auto&& x, auto f) {
-    return f(x.cache_pool, x.data_copy_concurrency, x.base, x.metadata);
+    return f(x.cache_pool, x.index_cache_pool, x.data_copy_concurrency, x.base,
+             x.metadata);
   };
 };
 
@@ -953,6 +1157,9 @@ TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(
                        jb::DefaultInitializedValue())),
         jb::Member(internal::CachePoolResource::id,
                    jb::Projection<&ShardedKeyValueStoreSpecData::cache_pool>()),
+        jb::Member(
+            "index_cache_pool",
+            jb::Projection<&ShardedKeyValueStoreSpecData::index_cache_pool>()),
         jb::Member(
             internal::DataCopyConcurrencyResource::id,
             jb::Projection<
@@ -974,16 +1181,19 @@ class ShardedKeyValueStore
       kvstore::DriverPtr base_kvstore, Executor executor,
       std::string key_prefix, const ShardingSpec& sharding_spec,
       internal::CachePool::WeakPtr cache_pool,
-      GetMaxChunksPerShardFunction get_max_chunks_per_shard = {})
+      GetMaxChunksPerShardFunction get_max_chunks_per_shard = {},
+      internal::CachePool::WeakPtr index_cache_pool = {})
       : write_cache_(
             cache_pool->GetCache<ShardedKeyValueStoreWriteCache>("", [&] {
+              if (!index_cache_pool) index_cache_pool = cache_pool;
               return std::make_unique<ShardedKeyValueStoreWriteCache>(
-                  cache_pool->GetCache<MinishardIndexCache>(
+                  index_cache_pool->GetCache<MinishardIndexCache>(
                       "",
                       [&] {
                         return std::make_unique<MinishardIndexCache>(
                             std::move(base_kvstore), std::move(executor),
-                            std::move(key_prefix), sharding_spec);
+                            std::move(key_prefix), sharding_spec,
+                            index_cache_pool);
                       }),
                   std::move(get_max_chunks_per_shard));
             })) {}
@@ -1132,6 +1342,7 @@ class ShardedKeyValueStore
 
   internal::CachePtr<ShardedKeyValueStoreWriteCache> write_cache_;
   Context::Resource<internal::CachePoolResource> cache_pool_resource_;
+  Context::Resource<internal::CachePoolResource> index_cache_pool_resource_;
   Context::Resource<internal::DataCopyConcurrencyResource>
       data_copy_concurrency_resource_;
 };
@@ -1157,11 +1368,13 @@ absl::Status ShardedKeyValueStore::GetBoundSpecData(
                                base_kvstore_driver()->GetBoundSpec());
   spec.base.path = key_prefix();
   if (!data_copy_concurrency_resource_.has_resource() ||
-      !cache_pool_resource_.has_resource()) {
+      !cache_pool_resource_.has_resource() ||
+      !index_cache_pool_resource_.has_resource()) {
     return absl::InternalError("JSON representation not supported");
   }
   spec.data_copy_concurrency = data_copy_concurrency_resource_;
   spec.cache_pool = cache_pool_resource_;
+  spec.index_cache_pool = index_cache_pool_resource_;
   spec.metadata = sharding_spec();
   return absl::Status();
 }
@@ -1175,10 +1388,12 @@ Future<kvstore::DriverPtr> ShardedKeyValueStoreSpec::DoOpen() const {
             std::move(base_kvstore.driver),
             spec->data_.data_copy_concurrency->executor,
             std::move(base_kvstore.path), spec->data_.metadata,
-            *spec->data_.cache_pool);
+            *spec->data_.cache_pool, GetMaxChunksPerShardFunction{},
+            *spec->data_.index_cache_pool);
         driver->data_copy_concurrency_resource_ =
             spec->data_.data_copy_concurrency;
         driver->cache_pool_resource_ = spec->data_.cache_pool;
+        driver->index_cache_pool_resource_ = spec->data_.index_cache_pool;
         return driver;
       },
       kvstore::Open(data_.base));
@@ -1187,11 +1402,23 @@ Future<kvstore::DriverPtr> ShardedKeyValueStoreSpec::DoOpen() const {
 kvstore::DriverPtr GetShardedKeyValueStore(
     kvstore::DriverPtr base_kvstore, Executor executor, std::string key_prefix,
     const ShardingSpec& sharding_spec, internal::CachePool::WeakPtr cache_pool,
-    GetMaxChunksPerShardFunction get_max_chunks_per_shard) {
+    GetMaxChunksPerShardFunction get_max_chunks_per_shard,
+    internal::CachePool::WeakPtr index_cache_pool) {
   return kvstore::DriverPtr(new ShardedKeyValueStore(
       std::move(base_kvstore), std::move(executor), std::move(key_prefix),
       sharding_spec, std::move(cache_pool),
-      std::move(get_max_chunks_per_shard)));
+      std::move(get_max_chunks_per_shard), std::move(index_cache_pool)));
+}
+
+Future<TimestampedStorageGeneration> WriteShard(
+    const kvstore::DriverPtr& base_kvstore, std::string_view key_prefix,
+    UnorderedShardEncoder& shard_encoder) {
+  TENSORSTORE_ASSIGN_OR_RETURN(auto encoded_shard, shard_encoder.Finalize());
+  std::optional<absl::Cord> value;
+  if (!encoded_shard.empty()) value = std::move(encoded_shard);
+  return base_kvstore->Write(GetShardKey(shard_encoder.sharding_spec(),
+                                         key_prefix, shard_encoder.shard()),
+                             std::move(value));
 }
 
 std::string ChunkIdToKey(ChunkId chunk_id) {
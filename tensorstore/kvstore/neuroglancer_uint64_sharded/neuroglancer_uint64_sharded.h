@@ -19,11 +19,15 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded_encoder.h"
 #include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
 
 namespace tensorstore {
 namespace neuroglancer_uint64_sharded {
@@ -51,16 +55,21 @@ using GetMaxChunksPerShardFunction =
 /// Read requests require a maximum of 3 reads to the underlying `base_kvstore`:
 ///
 /// 1. Retrieve the shard index entry.  Specifies the byte range of the
-///    minishard index, if present.
+///    minishard index, if present.  The entire shard index (or, for shards with
+///    more than 4096 minishards, a block of 4096 consecutive entries) is read
+///    by a single request and cached.
 ///
 /// 2. Retrieve the minishard index (if present) Specifies the byte range of the
 ///    chunk data, if present.
 ///
 /// 3. Retrieve the chunk data (if present).
 ///
-/// However, the minshard indexes are cached in the specified `cache_pool`, and
-/// therefore subsequent reads within the same minishard require only a single
-/// read to the underlying `base_kvstore`.
+/// However, the shard and minishard indexes are cached in the specified
+/// `index_cache_pool`, and therefore subsequent reads within the same shard
+/// require at most 2 reads, and subsequent reads within the same minishard
+/// require only a single read, to the underlying `base_kvstore`.  Concurrent
+/// reads that require the same shard or minishard index share a single
+/// request.
 ///
 /// Writing is supported, and concurrent writes from multiple machines are
 /// safely handled provided that the underlying `KeyValueStore` supports
@@ -83,8 +92,8 @@ using GetMaxChunksPerShardFunction =
 ///     on I/O).
 /// \param key_prefix Prefix of the sharded database within `base_kvstore`.
 /// \param sharding_spec Sharding specification.
-/// \param cache_pool The cache pool for the minishard index cache and for the
-///     shard write cache.
+/// \param cache_pool The cache pool for the shard write cache, and for the
+///     index caches if `index_cache_pool` is not specified.
 /// \param get_max_chunks_per_shard Optional.  Specifies function that computes
 ///     the maximum number of chunks that may be assigned to the shard.  When
 ///     writing a shard where the number of new chunks is equal to the maximum
@@ -94,10 +103,41 @@ using GetMaxChunksPerShardFunction =
 ///     by the `neuroglancer_precomputed` volume driver to allow shard-aligned
 ///     writes to be performed unconditionally, in the case where a shard
 ///     corresponds to a rectangular region.
+/// \param index_cache_pool Optional.  The cache pool for the shard index and
+///     minishard index caches.  Specifying a separate pool allows the decoded
+///     indices to be retained with their own byte budget, independent of
+///     cached chunk data.  If not specified, `cache_pool` is used.  Shard
+///     indices are read in large blocks only if this pool has a non-zero
+///     `total_bytes_limit`; otherwise each read retrieves a single entry.
 kvstore::DriverPtr GetShardedKeyValueStore(
     kvstore::DriverPtr base_kvstore, Executor executor, std::string key_prefix,
     const ShardingSpec& sharding_spec, internal::CachePool::WeakPtr cache_pool,
-    GetMaxChunksPerShardFunction get_max_chunks_per_shard = {});
+    GetMaxChunksPerShardFunction get_max_chunks_per_shard = {},
+    internal::CachePool::WeakPtr index_cache_pool = {});
+
+/// Writes a complete shard assembled by `shard_encoder` to `base_kvstore`.
+///
+/// Exactly one unconditional write (or, if no chunks were written to
+/// `shard_encoder`, one unconditional delete) of the shard is issued, and the
+/// existing shard, if any, is not read.  Any existing chunks of the shard not
+/// written to `shard_encoder` are therefore removed.
+///
+/// This is more efficient than writing each chunk through the `KeyValueStore`
+/// returned by `GetShardedKeyValueStore` when all chunks of a shard are
+/// available, since that requires the existing shard to be read and re-encoded
+/// unless the chunks of the shard are written in a single transaction.
+///
+/// Note that a `KeyValueStore` returned by `GetShardedKeyValueStore` for the
+/// same shards may retain cached data from before the write.
+///
+/// \param base_kvstore The underlying `KeyValueStore` that holds the shard
+///     files.
+/// \param key_prefix Prefix of the sharded database within `base_kvstore`.
+/// \param shard_encoder The encoder for the shard.  `Finalize` is called by
+///     this function.
+Future<TimestampedStorageGeneration> WriteShard(
+    const kvstore::DriverPtr& base_kvstore, std::string_view key_prefix,
+    UnorderedShardEncoder& shard_encoder);
 
 /// Returns a key suitable for use with a `KeyValueStore` returned from
 /// `GetShardedKeyValueStore`.
@@ -60,6 +60,8 @@ using ::tensorstore::kvstore::ReadResult;
 using ::tensorstore::neuroglancer_uint64_sharded::ChunkIdToKey;
 using ::tensorstore::neuroglancer_uint64_sharded::GetShardedKeyValueStore;
 using ::tensorstore::neuroglancer_uint64_sharded::ShardingSpec;
+using ::tensorstore::neuroglancer_uint64_sharded::UnorderedShardEncoder;
+using ::tensorstore::neuroglancer_uint64_sharded::WriteShard;
 
 constexpr CachePool::Limits kSmallCacheLimits{10000000, 5000000};
 
@@ -405,7 +407,7 @@ TEST_F(RawEncodingTest, ShardIndexTooShort) {
       MatchesStatus(
           absl::StatusCode::kFailedPrecondition,
           "Error reading minishard 0 in \"prefix/0\\.shard\": "
-          "Error retrieving shard index entry: "
+          "Error reading shard index in \"prefix/0\\.shard\": "
           "Requested byte range \\[0, 16\\) is not valid for value of size 3"));
   EXPECT_THAT(
       store->Write(GetChunkKey(10), absl::Cord("abc")).result(),
@@ -653,13 +655,15 @@ TEST_F(UnderlyingKeyValueStoreTest, Read) {
       EXPECT_EQ("prefix/0.shard", req.key);
       EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_not_equal);
       EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
-      EXPECT_EQ(OptionalByteRangeRequest(0, 16), req.options.byte_range);
+      EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
       EXPECT_THAT(req.options.staleness_bound, ::testing::Gt(init_time));
       req.promise.SetResult(
           ReadResult{ReadResult::kValue,
                      Bytes({
                          5, 0, 0, 0, 0, 0, 0, 0,   //
                          31, 0, 0, 0, 0, 0, 0, 0,  //
+                         0, 0, 0, 0, 0, 0, 0, 0,   //
+                         0, 0, 0, 0, 0, 0, 0, 0,   //
                      }),
                      {StorageGeneration::FromString("g0"), absl::Now()}});
     }
@@ -724,7 +728,7 @@ TEST_F(UnderlyingKeyValueStoreTest, Read) {
       EXPECT_EQ("prefix/0.shard", req.key);
       EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_not_equal);
       EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
-      EXPECT_EQ(OptionalByteRangeRequest(0, 16), req.options.byte_range);
+      EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
       EXPECT_THAT(req.options.staleness_bound, ::testing::Gt(req_time));
       minishard_index_time = absl::Now();
       req.promise.SetResult(ReadResult{
@@ -790,13 +794,15 @@ TEST_F(UnderlyingKeyValueStoreTest, Read) {
       EXPECT_EQ("prefix/0.shard", req.key);
       EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_not_equal);
       EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
-      EXPECT_EQ(OptionalByteRangeRequest(0, 16), req.options.byte_range);
+      EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
       EXPECT_THAT(req.options.staleness_bound, ::testing::Ge(abort_time));
       req.promise.SetResult(
           ReadResult{ReadResult::kValue,
                      Bytes({
                          6, 0, 0, 0, 0, 0, 0, 0,   //
                          32, 0, 0, 0, 0, 0, 0, 0,  //
+                         0, 0, 0, 0, 0, 0, 0, 0,   //
+                         0, 0, 0, 0, 0, 0, 0, 0,   //
                      }),
                      {StorageGeneration::FromString("g1"), absl::Now()}});
     }
@@ -859,10 +865,12 @@ TEST_F(UnderlyingKeyValueStoreTest,
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_not_equal);
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
     EXPECT_EQ(init_time, req.options.staleness_bound);
-    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(
         ReadResult{ReadResult::kValue,
                    Bytes({
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
                        6, 0, 0, 0, 0, 0, 0, 0,   //
                        32, 0, 0, 0, 0, 0, 0, 0,  //
                    }),
@@ -880,18 +888,20 @@ TEST_F(UnderlyingKeyValueStoreTest,
     req.promise.SetResult(
         ReadResult{{StorageGeneration::FromString("g2"), abort_time}});
   }
-  // Request for updated shard index.
+  // Request for updated shard index.  The cached shard index is revalidated.
   {
     auto req = mock_store->read_requests.pop_nonblock().value();
     ASSERT_EQ(0, mock_store->read_requests.size());
     EXPECT_EQ("prefix/0.shard", req.key);
-    EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_not_equal);
+    EXPECT_EQ(StorageGeneration::FromString("g2"), req.options.if_not_equal);
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
     EXPECT_THAT(req.options.staleness_bound, ::testing::Ge(abort_time));
-    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(
         ReadResult{ReadResult::kValue,
                    Bytes({
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
                        7, 0, 0, 0, 0, 0, 0, 0,   //
                        33, 0, 0, 0, 0, 0, 0, 0,  //
                    }),
@@ -937,6 +947,192 @@ TEST_F(UnderlyingKeyValueStoreTest,
                            StorageGeneration::FromString("g3"), read_time));
 }
 
+// Tests that reading a chunk in a second minishard of a shard uses the cached
+// shard index, which was read in its entirety along with the first minishard.
+TEST_F(UnderlyingKeyValueStoreTest, ReadSecondMinishardUsesCachedShardIndex) {
+  absl::Time init_time = UniqueNow();
+  {
+    auto future = store->Read(GetChunkKey(0x50), {});
+    // Request for entire shard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({
+                         5, 0, 0, 0, 0, 0, 0, 0,   //
+                         5, 0, 0, 0, 0, 0, 0, 0,   //
+                         5, 0, 0, 0, 0, 0, 0, 0,   //
+                         29, 0, 0, 0, 0, 0, 0, 0,  //
+                     }),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    // Minishard 0 is empty; no further requests are required.
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    ASSERT_TRUE(future.ready());
+    EXPECT_THAT(future.result(), MatchesKvsReadResultNotFound());
+  }
+
+  {
+    kvstore::ReadOptions options;
+    options.staleness_bound = init_time;
+    auto future = store->Read(GetChunkKey(0x1), options);
+    // Request for minishard index, based on cached shard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+      EXPECT_EQ(OptionalByteRangeRequest(37, 61), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({
+                         0x1, 0, 0, 0, 0, 0, 0, 0,  //
+                         0,   0, 0, 0, 0, 0, 0, 0,  //
+                         5,   0, 0, 0, 0, 0, 0, 0,  //
+                     }),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    // Request for value.
+    absl::Time read_time;
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(OptionalByteRangeRequest(32, 37), req.options.byte_range);
+      read_time = absl::Now();
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({5, 6, 7, 8, 9}),
+                     {StorageGeneration::FromString("g0"), read_time}});
+    }
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    ASSERT_TRUE(future.ready());
+    EXPECT_THAT(
+        future.result(),
+        MatchesKvsReadResult(Bytes({5, 6, 7, 8, 9}),
+                             StorageGeneration::FromString("g0"), read_time));
+  }
+}
+
+// Tests that the shard index is cached in a separate `index_cache_pool` even
+// if `cache_pool` does not retain any entries.
+TEST_F(UnderlyingKeyValueStoreTest, ReadWithSeparateIndexCachePool) {
+  auto data_cache_pool = CachePool::Make(CachePool::Limits{});
+  store = GetShardedKeyValueStore(
+      mock_store, tensorstore::InlineExecutor{}, "prefix", sharding_spec,
+      CachePool::WeakPtr(data_cache_pool), {}, CachePool::WeakPtr(cache_pool));
+  absl::Time init_time = UniqueNow();
+  {
+    auto future = store->Read(GetChunkKey(0x50), {});
+    // Request for entire shard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({
+                         5, 0, 0, 0, 0, 0, 0, 0,   //
+                         5, 0, 0, 0, 0, 0, 0, 0,   //
+                         5, 0, 0, 0, 0, 0, 0, 0,   //
+                         29, 0, 0, 0, 0, 0, 0, 0,  //
+                     }),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    ASSERT_TRUE(future.ready());
+    EXPECT_THAT(future.result(), MatchesKvsReadResultNotFound());
+  }
+
+  {
+    kvstore::ReadOptions options;
+    options.staleness_bound = init_time;
+    auto future = store->Read(GetChunkKey(0x1), options);
+    // Request for minishard index, based on cached shard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ(OptionalByteRangeRequest(37, 61), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({
+                         0x1, 0, 0, 0, 0, 0, 0, 0,  //
+                         0,   0, 0, 0, 0, 0, 0, 0,  //
+                         5,   0, 0, 0, 0, 0, 0, 0,  //
+                     }),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    // Request for value.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ(OptionalByteRangeRequest(32, 37), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({5, 6, 7, 8, 9}),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    ASSERT_TRUE(future.ready());
+    EXPECT_THAT(future.result(),
+                MatchesKvsReadResult(Bytes({5, 6, 7, 8, 9}),
+                                     StorageGeneration::FromString("g0")));
+  }
+}
+
+// Tests that only the required shard index entry is read if the index cache
+// pool does not retain any entries.
+TEST_F(UnderlyingKeyValueStoreTest, ReadWithoutIndexCacheReadsSingleEntry) {
+  auto uncached_pool = CachePool::Make(CachePool::Limits{});
+  store = GetShardedKeyValueStore(mock_store, tensorstore::InlineExecutor{},
+                                  "prefix", sharding_spec,
+                                  CachePool::WeakPtr(uncached_pool));
+  auto future = store->Read(GetChunkKey(0x1), {});
+  {
+    auto req = mock_store->read_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    EXPECT_EQ("prefix/0.shard", req.key);
+    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    req.promise.SetResult(
+        ReadResult{ReadResult::kValue,
+                   Bytes({
+                       5, 0, 0, 0, 0, 0, 0, 0,   //
+                       29, 0, 0, 0, 0, 0, 0, 0,  //
+                   }),
+                   {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  {
+    auto req = mock_store->read_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    EXPECT_EQ(OptionalByteRangeRequest(37, 61), req.options.byte_range);
+    req.promise.SetResult(
+        ReadResult{ReadResult::kValue,
+                   Bytes({
+                       0x1, 0, 0, 0, 0, 0, 0, 0,  //
+                       0,   0, 0, 0, 0, 0, 0, 0,  //
+                       5,   0, 0, 0, 0, 0, 0, 0,  //
+                   }),
+                   {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  {
+    auto req = mock_store->read_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    EXPECT_EQ(OptionalByteRangeRequest(32, 37), req.options.byte_range);
+    req.promise.SetResult(
+        ReadResult{ReadResult::kValue,
+                   Bytes({5, 6, 7, 8, 9}),
+                   {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  ASSERT_TRUE(future.ready());
+  EXPECT_THAT(future.result(),
+              MatchesKvsReadResult(Bytes({5, 6, 7, 8, 9}),
+                                   StorageGeneration::FromString("g0")));
+}
+
 // Tests issuing read for chunk in uncached minishard index while the shard is
 // concurrently deleted (before the minishard index can be read).
 TEST_F(UnderlyingKeyValueStoreTest,
@@ -951,10 +1147,12 @@ TEST_F(UnderlyingKeyValueStoreTest,
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_not_equal);
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
     EXPECT_THAT(req.options.staleness_bound, ::testing::Gt(req_time));
-    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(
         ReadResult{ReadResult::kValue,
                    Bytes({
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
                        6, 0, 0, 0, 0, 0, 0, 0,   //
                        32, 0, 0, 0, 0, 0, 0, 0,  //
                    }),
@@ -992,10 +1190,12 @@ TEST_F(UnderlyingKeyValueStoreTest,
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_not_equal);
     EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
     EXPECT_THAT(req.options.staleness_bound, ::testing::Gt(req_time));
-    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(
         ReadResult{ReadResult::kValue,
                    Bytes({
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
                        6, 0, 0, 0, 0, 0, 0, 0,   //
                        32, 0, 0, 0, 0, 0, 0, 0,  //
                    }),
@@ -1042,7 +1242,7 @@ TEST_F(UnderlyingKeyValueStoreTest, ReadErrorReadingShardIndex) {
     auto req = mock_store->read_requests.pop_nonblock().value();
     ASSERT_EQ(0, mock_store->read_requests.size());
     EXPECT_EQ("prefix/0.shard", req.key);
-    EXPECT_EQ(OptionalByteRangeRequest(0, 16), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(absl::UnknownError("Read error"));
   }
   ASSERT_TRUE(future.ready());
@@ -1050,7 +1250,7 @@ TEST_F(UnderlyingKeyValueStoreTest, ReadErrorReadingShardIndex) {
       future.result(),
       MatchesStatus(absl::StatusCode::kUnknown,
                     "Error reading minishard 0 in \"prefix/0\\.shard\": "
-                    "Error retrieving shard index entry: "
+                    "Error reading shard index in \"prefix/0\\.shard\": "
                     "Read error"));
 }
 
@@ -1061,10 +1261,12 @@ TEST_F(UnderlyingKeyValueStoreTest, ReadErrorReadingMinishardShardIndex) {
     auto req = mock_store->read_requests.pop_nonblock().value();
     ASSERT_EQ(0, mock_store->read_requests.size());
     EXPECT_EQ("prefix/0.shard", req.key);
-    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(
         ReadResult{ReadResult::kValue,
                    Bytes({
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
                        6, 0, 0, 0, 0, 0, 0, 0,   //
                        32, 0, 0, 0, 0, 0, 0, 0,  //
                    }),
@@ -1093,10 +1295,12 @@ TEST_F(UnderlyingKeyValueStoreTest, ReadErrorReadingData) {
     auto req = mock_store->read_requests.pop_nonblock().value();
     ASSERT_EQ(0, mock_store->read_requests.size());
     EXPECT_EQ("prefix/0.shard", req.key);
-    EXPECT_EQ(OptionalByteRangeRequest(16, 32), req.options.byte_range);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
     req.promise.SetResult(
         ReadResult{ReadResult::kValue,
                    Bytes({
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
+                       0, 0, 0, 0, 0, 0, 0, 0,   //
                        6, 0, 0, 0, 0, 0, 0, 0,   //
                        32, 0, 0, 0, 0, 0, 0, 0,  //
                    }),
@@ -1251,6 +1455,65 @@ TEST_F(UnderlyingKeyValueStoreTest, UnconditionalWrite) {
                   StorageGeneration::FromString("g0"), write_time));
 }
 
+// Tests that `WriteShard` issues a single unconditional write, with no prior
+// read, and produces the same shard as writing through the sharded store.
+TEST_F(UnderlyingKeyValueStoreTest, WriteShard) {
+  UnorderedShardEncoder shard_encoder(sharding_spec, 0);
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry(
+      {0x54}, Bytes({4, 5, 6}), /*compress=*/true));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry(
+      {0x50}, Bytes({1, 2, 3}), /*compress=*/true));
+  auto future = WriteShard(mock_store, "prefix", shard_encoder);
+  ASSERT_EQ(0, mock_store->read_requests.size());
+  absl::Time write_time;
+  {
+    auto req = mock_store->write_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->write_requests.size());
+    EXPECT_EQ("prefix/0.shard", req.key);
+    EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
+    EXPECT_THAT(req.value, ::testing::Optional(Bytes({
+                               6,    0, 0, 0, 0, 0, 0, 0,  //
+                               54,   0, 0, 0, 0, 0, 0, 0,  //
+                               0,    0, 0, 0, 0, 0, 0, 0,  //
+                               0,    0, 0, 0, 0, 0, 0, 0,  //
+                               1,    2, 3,                 //
+                               4,    5, 6,                 //
+                               0x50, 0, 0, 0, 0, 0, 0, 0,  //
+                               0x04, 0, 0, 0, 0, 0, 0, 0,  //
+                               0,    0, 0, 0, 0, 0, 0, 0,  //
+                               0,    0, 0, 0, 0, 0, 0, 0,  //
+                               3,    0, 0, 0, 0, 0, 0, 0,  //
+                               3,    0, 0, 0, 0, 0, 0, 0,  //
+                           })));
+    write_time = absl::Now();
+    req.promise.SetResult(std::in_place, StorageGeneration::FromString("g0"),
+                          write_time);
+  }
+  ASSERT_TRUE(future.ready());
+  EXPECT_THAT(future.result(),
+              MatchesTimestampedStorageGeneration(
+                  StorageGeneration::FromString("g0"), write_time));
+  ASSERT_EQ(0, mock_store->read_requests.size());
+}
+
+// Tests that `WriteShard` deletes the shard if no chunks were written.
+TEST_F(UnderlyingKeyValueStoreTest, WriteShardEmpty) {
+  UnorderedShardEncoder shard_encoder(sharding_spec, 1);
+  auto future = WriteShard(mock_store, "prefix", shard_encoder);
+  ASSERT_EQ(0, mock_store->read_requests.size());
+  {
+    auto req = mock_store->write_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->write_requests.size());
+    EXPECT_EQ("prefix/1.shard", req.key);
+    EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
+    EXPECT_EQ(std::nullopt, req.value);
+    req.promise.SetResult(std::in_place, StorageGeneration::NoValue(),
+                          absl::Now());
+  }
+  ASSERT_TRUE(future.ready());
+  TENSORSTORE_EXPECT_OK(future.result());
+}
+
 TEST_F(UnderlyingKeyValueStoreTest, ConditionalWriteDespiteMaxChunks) {
   store = GetStore(
       /*get_max_chunks_per_shard=*/[](std::uint64_t shard) -> std::uint64_t {
@@ -14,8 +14,12 @@
 
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded_encoder.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/strings/cord.h"
 #include "tensorstore/internal/compression/zlib.h"
 #include "tensorstore/internal/flat_cord_builder.h"
 #include "tensorstore/util/str_cat.h"
@@ -135,6 +139,67 @@ absl::Status ShardEncoder::WriteIndexedEntry(std::uint64_t minishard,
 
 ShardEncoder::~ShardEncoder() = default;
 
+UnorderedShardEncoder::UnorderedShardEncoder(const ShardingSpec& sharding_spec,
+                                             std::uint64_t shard)
+    : sharding_spec_(sharding_spec), shard_(shard) {}
+
+absl::Status UnorderedShardEncoder::WriteIndexedEntry(ChunkId chunk_id,
+                                                      const absl::Cord& data,
+                                                      bool compress) {
+  const auto split_info = GetSplitShardInfo(
+      sharding_spec_, GetChunkShardInfo(sharding_spec_, chunk_id));
+  if (split_info.shard != shard_) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "Chunk ", chunk_id.value, " is in shard ", split_info.shard,
+        " rather than shard ", shard_));
+  }
+  if (!spill_file_) {
+    TENSORSTORE_ASSIGN_OR_RETURN(spill_file_,
+                                 internal::TemporaryFile::Create());
+  }
+  const std::uint64_t start_offset = spill_file_->size();
+  TENSORSTORE_RETURN_IF_ERROR(spill_file_->Append(
+      EncodeData(data, compress ? sharding_spec_.data_encoding
+                                : ShardingSpec::DataEncoding::raw)));
+  entries_.push_back(
+      {{split_info.minishard, chunk_id}, {start_offset, spill_file_->size()}});
+  return absl::OkStatus();
+}
+
+Result<absl::Cord> UnorderedShardEncoder::Finalize() {
+  std::sort(entries_.begin(), entries_.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.minishard_and_chunk_id < b.minishard_and_chunk_id;
+            });
+  absl::Cord data;
+  if (spill_file_) {
+    TENSORSTORE_ASSIGN_OR_RETURN(data, spill_file_->Read());
+  }
+  absl::Cord shard_data;
+  ShardEncoder encoder(sharding_spec_, shard_data);
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    const auto& entry = entries_[i];
+    if (i != 0 && entries_[i - 1].minishard_and_chunk_id ==
+                      entry.minishard_and_chunk_id) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Chunk ", entry.minishard_and_chunk_id.chunk_id.value,
+          " was written more than once"));
+    }
+    // The chunk data was already encoded by `WriteIndexedEntry`.
+    TENSORSTORE_RETURN_IF_ERROR(encoder.WriteIndexedEntry(
+        entry.minishard_and_chunk_id.minishard,
+        entry.minishard_and_chunk_id.chunk_id,
+        data.Subcord(entry.byte_range.inclusive_min, entry.byte_range.size()),
+        /*compress=*/false));
+  }
+  TENSORSTORE_ASSIGN_OR_RETURN(auto shard_index, encoder.Finalize());
+  entries_.clear();
+  spill_file_.reset();
+  if (shard_data.empty()) return absl::Cord();
+  shard_index.Append(std::move(shard_data));
+  return shard_index;
+}
+
 std::optional<absl::Cord> EncodeShard(const ShardingSpec& spec,
                                       span<const EncodedChunk> chunks) {
   absl::Cord shard_data;
@@ -25,10 +25,13 @@
 /// https://github.com/google/neuroglancer/tree/master/src/neuroglancer/datasource/precomputed#sharded-format
 
 #include <cstdint>
+#include <functional>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "tensorstore/internal/temporary_file.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
 #include "tensorstore/util/result.h"
@@ -162,6 +165,98 @@ class ShardEncoder {
   std::uint64_t data_file_offset_;
 };
 
+/// Class that may be used to encode a single shard from chunks supplied in
+/// arbitrary order.
+///
+/// Each chunk is encoded as it is written and appended to an anonymous
+/// temporary file; only the chunk id and location of each chunk are retained
+/// in memory.  When `Finalize` is called, the temporary file is memory mapped,
+/// the minishard indices and shard index are built, and the chunk data is
+/// arranged in minishard order, producing the same output as `EncodeShard`
+/// applied to the sorted chunks.  Arranging the data only splices ranges of the
+/// mapping and does not copy the encoded chunk data, so heap usage is bounded
+/// by the size of the index rather than the chunk data.  Where memory mapping
+/// fails, the temporary file is read into memory instead.
+///
+/// This is intended for bulk writers that produce every chunk of a shard: the
+/// result may be written with a single unconditional write (see
+/// `WriteShard`), without reading or re-encoding the existing shard.
+///
+/// Example usage:
+///
+///     UnorderedShardEncoder shard_encoder(sharding_spec, shard);
+///     for (const auto &[chunk_id, data] : chunks) {
+///       TENSORSTORE_RETURN_IF_ERROR(shard_encoder.WriteIndexedEntry(
+///           chunk_id, data, /*compress=*/true));
+///     }
+///     TENSORSTORE_ASSIGN_OR_RETURN(auto encoded_shard,
+///                                  shard_encoder.Finalize());
+class UnorderedShardEncoder {
+ public:
+  /// Constructs an encoder for the specified shard.
+  ///
+  /// \param sharding_spec The sharding specification.
+  /// \param shard The shard number.
+  explicit UnorderedShardEncoder(const ShardingSpec& sharding_spec,
+                                 std::uint64_t shard);
+
+  /// Writes a single chunk.
+  ///
+  /// \param chunk_id The chunk id, must map to `shard()` and must be distinct
+  ///     from any previous `chunk_id` supplied to `WriteIndexedEntry`.
+  /// \param data The chunk data to write.
+  /// \param compress Specifies whether to honor the `data_compression`
+  ///     specified in `sharding_spec`.
+  /// \error `absl::StatusCode::kInvalidArgument` if `chunk_id` does not map to
+  ///     `shard()`.
+  /// \error If the temporary file cannot be created or written.
+  /// \pre `Finalize()` was not called previously.
+  absl::Status WriteIndexedEntry(ChunkId chunk_id, const absl::Cord& data,
+                                 bool compress);
+
+  /// Returns the complete encoded shard, consisting of the shard index followed
+  /// by the shard data file.
+  ///
+  /// If no chunks were written, returns an empty `absl::Cord`, indicating that
+  /// the shard should not exist.
+  ///
+  /// The returned value may reference a memory mapping of the temporary file,
+  /// which is deleted once the value is no longer referenced.
+  ///
+  /// \error `absl::StatusCode::kInvalidArgument` if the same chunk id was
+  ///     written more than once.
+  /// \error If the temporary file cannot be read.
+  /// \pre `Finalize()` was not called previously.
+  Result<absl::Cord> Finalize();
+
+  /// Returns the number of chunks written.
+  std::size_t num_chunks() const { return entries_.size(); }
+
+  /// Returns the sharding specification.
+  const ShardingSpec& sharding_spec() const { return sharding_spec_; }
+
+  /// Returns the shard number.
+  std::uint64_t shard() const { return shard_; }
+
+ private:
+  struct Entry {
+    MinishardAndChunkId minishard_and_chunk_id;
+
+    /// Location of the encoded chunk within the temporary file.
+    ByteRange byte_range;
+  };
+
+  ShardingSpec sharding_spec_;
+  std::uint64_t shard_;
+
+  /// Entries in the order they were written.
+  std::vector<Entry> entries_;
+
+  /// Concatenation of the encoded chunks, in the order they were written.
+  /// Created by the first call to `WriteIndexedEntry`.
+  std::optional<internal::TemporaryFile> spill_file_;
+};
+
 /// Encodes a full shard from a list of chunks.
 ///
 /// \param chunks The chunks to include, must be ordered by minishard index and
@@ -14,6 +14,9 @@
 
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded_encoder.h"
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -27,12 +30,16 @@
 namespace {
 
 namespace zlib = tensorstore::zlib;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::neuroglancer_uint64_sharded::EncodedChunk;
+using ::tensorstore::neuroglancer_uint64_sharded::EncodeShard;
 using ::tensorstore::neuroglancer_uint64_sharded::EncodeMinishardIndex;
 using ::tensorstore::neuroglancer_uint64_sharded::EncodeShardIndex;
 using ::tensorstore::neuroglancer_uint64_sharded::MinishardIndexEntry;
 using ::tensorstore::neuroglancer_uint64_sharded::ShardEncoder;
 using ::tensorstore::neuroglancer_uint64_sharded::ShardIndexEntry;
 using ::tensorstore::neuroglancer_uint64_sharded::ShardingSpec;
+using ::tensorstore::neuroglancer_uint64_sharded::UnorderedShardEncoder;
 
 absl::Cord Bytes(std::vector<unsigned char> bytes) {
   return absl::Cord(std::string_view(
@@ -184,4 +191,100 @@ TEST(ShardEncoderTest, Gzip) {
   EXPECT_EQ(expected_shard_index, encoded_shard_index);
 }
 
+// Returns a sharding spec with 2 shards of 2 minishards each, in which chunk
+// `i` maps to shard `i % 2` and minishard `(i / 2) % 2`.
+ShardingSpec GetUnorderedShardingSpec(std::string data_encoding) {
+  return ShardingSpec::FromJson(
+             {{"@type", "neuroglancer_uint64_sharded_v1"},
+              {"hash", "identity"},
+              {"preshift_bits", 0},
+              {"minishard_bits", 1},
+              {"shard_bits", 1},
+              {"data_encoding", data_encoding},
+              {"minishard_index_encoding", data_encoding}})
+      .value();
+}
+
+TEST(UnorderedShardEncoderTest, MatchesEncodeShard) {
+  ShardingSpec sharding_spec = GetUnorderedShardingSpec("gzip");
+  // Chunks 1, 4, 5, 8 map to shard 0; chunks 1 and 5 map to minishard 1.
+  UnorderedShardEncoder shard_encoder(sharding_spec, 0);
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({5}, Bytes({5, 5}),
+                                                        /*compress=*/true));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({8}, Bytes({8}),
+                                                        /*compress=*/true));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({1}, Bytes({1, 1, 1}),
+                                                        /*compress=*/false));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({4}, Bytes({4, 4, 4}),
+                                                        /*compress=*/true));
+  EXPECT_EQ(4, shard_encoder.num_chunks());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto encoded_shard,
+                                   shard_encoder.Finalize());
+
+  zlib::Options options{/*.level=*/9, /*.use_gzip_header=*/true};
+  auto compress = [&](absl::Cord input) {
+    absl::Cord output;
+    zlib::Encode(input, &output, options);
+    return output;
+  };
+  std::vector<EncodedChunk> chunks{
+      {{0, {4}}, compress(Bytes({4, 4, 4}))},
+      {{0, {8}}, compress(Bytes({8}))},
+      {{1, {1}}, Bytes({1, 1, 1})},
+      {{1, {5}}, compress(Bytes({5, 5}))},
+  };
+  EXPECT_EQ(EncodeShard(sharding_spec, chunks), encoded_shard);
+}
+
+TEST(UnorderedShardEncoderTest, Empty) {
+  ShardingSpec sharding_spec = GetUnorderedShardingSpec("raw");
+  UnorderedShardEncoder shard_encoder(sharding_spec, 0);
+  EXPECT_THAT(shard_encoder.Finalize(), ::testing::Optional(absl::Cord()));
+}
+
+TEST(UnorderedShardEncoderTest, WrongShard) {
+  ShardingSpec sharding_spec = GetUnorderedShardingSpec("raw");
+  UnorderedShardEncoder shard_encoder(sharding_spec, 0);
+  EXPECT_THAT(
+      shard_encoder.WriteIndexedEntry({2}, Bytes({1}), /*compress=*/false),
+      MatchesStatus(absl::StatusCode::kInvalidArgument,
+                    "Chunk 2 is in shard 1 rather than shard 0"));
+}
+
+TEST(UnorderedShardEncoderTest, DuplicateChunk) {
+  ShardingSpec sharding_spec = GetUnorderedShardingSpec("raw");
+  UnorderedShardEncoder shard_encoder(sharding_spec, 0);
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({4}, Bytes({1}),
+                                                        /*compress=*/false));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({1}, Bytes({2}),
+                                                        /*compress=*/false));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry({4}, Bytes({3}),
+                                                        /*compress=*/false));
+  EXPECT_THAT(shard_encoder.Finalize(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "Chunk 4 was written more than once"));
+}
+
+TEST(UnorderedShardEncoderTest, LargeChunksMatchEncodeShard) {
+  ShardingSpec sharding_spec = GetUnorderedShardingSpec("raw");
+  UnorderedShardEncoder shard_encoder(sharding_spec, 0);
+  std::vector<EncodedChunk> chunks;
+  // Write in descending order so that `Finalize` must reorder chunks that are
+  // not contiguous in the spill file.
+  for (uint64_t i = 64; i-- > 0;) {
+    const uint64_t chunk_id = 2 * i;
+    absl::Cord data(std::string(100000 + i, static_cast<char>(i)));
+    TENSORSTORE_ASSERT_OK(
+        shard_encoder.WriteIndexedEntry({chunk_id}, data, /*compress=*/false));
+    chunks.push_back({{(chunk_id >> 1) & 1, {chunk_id}}, data});
+  }
+  std::sort(chunks.begin(), chunks.end(),
+            [](const EncodedChunk& a, const EncodedChunk& b) {
+              return a.minishard_and_chunk_id < b.minishard_and_chunk_id;
+            });
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto encoded_shard,
+                                   shard_encoder.Finalize());
+  EXPECT_EQ(EncodeShard(sharding_spec, chunks), encoded_shard);
+}
+
 }  // namespace
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
@@ -69,6 +70,11 @@ struct ReadOptions {
 
   /// Specifies the byte range.
   OptionalByteRangeRequest byte_range;
+
+  /// Optional batch with which to associate the read.  Drivers that support
+  /// batching defer the request until the batch is submitted, and may coalesce
+  /// it with other requests for the same key.
+  Batch batch{no_batch};
 };
 
 /// Read options for transactional reads.
@@ -66,6 +66,30 @@ class ReadModifyWriteTarget {
   /// may lead to unnecessary reads of cached data.
   virtual bool KvsReadsCommitted() = 0;
 
+  /// Requests that the writeback value of the bound `ReadModifyWriteSource` be
+  /// staged to storage before commit, so that the source may release its
+  /// in-memory state.
+  ///
+  /// If staging is started, the source is revoked (via `KvsRevoke`), its
+  /// writeback value is requested with a mode of `kNormalWriteback`, and once
+  /// the value has been staged, `ReadModifyWriteSource::KvsWritebackStaged` is
+  /// called.  Staging is abandoned if the writeback value is conditional on
+  /// the existing value.
+  ///
+  /// Returns `true` if staging was started.  The default implementation
+  /// returns `false`, indicating that staging is not supported.
+  virtual bool KvsStageWriteback() { return false; }
+
+  /// Returns `true` if a writeback value requested with a mode of
+  /// `kNormalWriteback` during commit is written to storage on its own, such
+  /// that `ReadModifyWriteSource::KvsWritebackSuccess` or
+  /// `ReadModifyWriteSource::KvsWritebackError` is called once that write
+  /// completes, independent of the writeback of any other source.
+  ///
+  /// Sources may use this to bound the number of concurrent writes without
+  /// risk of deadlock.  The default implementation returns `false`.
+  virtual bool KvsIndependentWriteback() { return false; }
+
  protected:
   ~ReadModifyWriteTarget() = default;
 };
@@ -175,6 +199,18 @@ class ReadModifyWriteSource {
   /// started.
   virtual void KvsRevoke() = 0;
 
+  /// Indicates that the writeback value requested by
+  /// `ReadModifyWriteTarget::KvsStageWriteback` has been staged, and that
+  /// `KvsWriteback` will not be called again.  The source may release any
+  /// state needed only to compute the writeback value.
+  ///
+  /// `KvsWritebackSuccess` is still called once the staged value is
+  /// committed, but always with a `new_stamp.generation` of
+  /// `StorageGeneration::Unknown()`.
+  ///
+  /// The default implementation does nothing.
+  virtual void KvsWritebackStaged() {}
+
  protected:
   ~ReadModifyWriteSource() = default;
 };
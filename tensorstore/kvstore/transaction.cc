@@ -14,6 +14,11 @@
 
 #include "tensorstore/kvstore/transaction.h"
 
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "absl/base/optimization.h"
 #include "absl/container/btree_map.h"
 #include "absl/functional/function_ref.h"
@@ -30,6 +35,11 @@ auto& kvstore_transaction_retries = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/transaction_retries",
     "Count of kvstore transaction retries");
 
+auto& kvstore_transaction_staged_writebacks =
+    internal_metrics::Counter<int64_t>::New(
+        "/tensorstore/kvstore/transaction_staged_writebacks",
+        "Count of kvstore transaction writeback values staged before commit");
+
 template <typename Controller>
 void ReportWritebackError(Controller controller, std::string_view action,
                           const absl::Status& error) {
@@ -402,6 +412,11 @@ void StartWriteback(ReadModifyWriteEntry& entry, absl::Time staleness_bound) {
       (entry.flags_ & ReadModifyWriteEntry::kDeleted)
           ? ReadModifyWriteSource::kValidateOnly
           : ReadModifyWriteSource::kNormalWriteback;
+  if (!(entry.flags_ & ReadModifyWriteEntry::kDeleted) &&
+      entry.multi_phase().CommitStaged(entry)) {
+    // The writeback value was staged before commit.
+    return;
+  }
   if (!entry.prev_ && !(entry.flags_ & ReadModifyWriteEntry::kDeleted)) {
     // Fast path: This entry sequence consists of just a single entry, and is
     // not a deleted entry superseded by a `DeleteRange` operation.  We don't
@@ -420,8 +435,8 @@ void StartWriteback(ReadModifyWriteEntry& entry, absl::Time staleness_bound) {
         entry_->multi_phase().Writeback(*entry_, std::move(read_result));
       }
     };
-    entry.source_->KvsWriteback(std::move(writeback_options),
-                                WritebackReceiverImpl{&entry});
+    entry.multi_phase().RequestWriteback(entry, std::move(writeback_options),
+                                         WritebackReceiverImpl{&entry});
     return;
   }
 
@@ -563,8 +578,8 @@ void StartWriteback(ReadModifyWriteEntry& entry, absl::Time staleness_bound) {
           writeback_options.staleness_bound = state_->staleness_bound;
           writeback_options.writeback_mode =
               ReadModifyWriteSource::kValidateOnly;
-          prev->source_->KvsWriteback(std::move(writeback_options),
-                                      std::move(*this));
+          prev->multi_phase().RequestWriteback(
+              *prev, std::move(writeback_options), std::move(*this));
           return;
         }
       }
@@ -575,8 +590,8 @@ void StartWriteback(ReadModifyWriteEntry& entry, absl::Time staleness_bound) {
                                           std::move(state_->read_result));
     }
   };
-  entry.source_->KvsWriteback(
-      std::move(writeback_options),
+  entry.multi_phase().RequestWriteback(
+      entry, std::move(writeback_options),
       SequenceWritebackReceiverImpl{
           std::unique_ptr<SequenceWritebackReceiverImpl::State>(
               new SequenceWritebackReceiverImpl::State{&entry,
@@ -657,8 +672,8 @@ void ReadModifyWriteEntry::KvsRead(
     writeback_options.staleness_bound = options.staleness_bound;
     writeback_options.writeback_mode =
         ReadModifyWriteSource::kSpecifyUnchangedWriteback;
-    this->prev_->source_->KvsWriteback(
-        std::move(writeback_options),
+    this->prev_->multi_phase().RequestWriteback(
+        *this->prev_, std::move(writeback_options),
         ReadReceiverImpl{this, std::move(receiver)});
   } else {
     multi_phase().Read(*this, std::move(options), std::move(receiver));
@@ -670,6 +685,14 @@ bool ReadModifyWriteEntry::KvsReadsCommitted() {
          multi_phase().MultiPhaseReadsCommitted();
 }
 
+bool ReadModifyWriteEntry::KvsStageWriteback() {
+  return multi_phase().StageWriteback(*this);
+}
+
+bool ReadModifyWriteEntry::KvsIndependentWriteback() {
+  return multi_phase().IndependentWriteback();
+}
+
 void DestroyPhaseEntries(SinglePhaseMutation& single_phase_mutation) {
   auto& multi_phase = *single_phase_mutation.multi_phase_;
   for (MutationEntryTree::iterator
@@ -729,7 +752,13 @@ void WritebackSuccess(ReadModifyWriteEntry& entry,
                       TimestampedStorageGeneration new_stamp) {
   assert(!entry.next_read_modify_write());
   for (ReadModifyWriteEntry* e = &entry;;) {
-    e->source_->KvsWritebackSuccess(new_stamp);
+    if (e->flags_ & ReadModifyWriteEntry::kStaged) {
+      // The source of a staged entry no longer retains its writeback value.
+      e->source_->KvsWritebackSuccess(TimestampedStorageGeneration{
+          StorageGeneration::Unknown(), absl::InfiniteFuture()});
+    } else {
+      e->source_->KvsWritebackSuccess(new_stamp);
+    }
     bool dirty = static_cast<bool>(e->flags_ & ReadModifyWriteEntry::kDirty);
     e = e->prev_;
     if (!e) break;
@@ -1150,6 +1179,14 @@ ReadModifyWriteEntry* MultiPhaseMutation::AllocateReadModifyWriteEntry() {
 void MultiPhaseMutation::FreeReadModifyWriteEntry(ReadModifyWriteEntry* entry) {
   delete entry;
 }
+
+void MultiPhaseMutation::RequestWriteback(
+    ReadModifyWriteEntry& entry,
+    ReadModifyWriteSource::WritebackOptions options,
+    ReadModifyWriteSource::WritebackReceiver receiver) {
+  entry.source_->KvsWriteback(std::move(options), std::move(receiver));
+}
+
 void ReadDirectly(Driver* driver, ReadModifyWriteEntry& entry,
                   ReadModifyWriteTarget::TransactionalReadOptions&& options,
                   ReadModifyWriteTarget::ReadReceiver&& receiver) {
@@ -1253,6 +1290,324 @@ void AtomicMultiPhaseMutation::RevokeAllEntries() {
   }
 }
 
+ReadModifyWriteEntry* NonAtomicTransactionNode::AllocateReadModifyWriteEntry() {
+  return new StagingReadModifyWriteEntry;
+}
+
+void NonAtomicTransactionNode::FreeReadModifyWriteEntry(
+    ReadModifyWriteEntry* entry) {
+  auto* staging_entry = static_cast<StagingReadModifyWriteEntry*>(entry);
+  if (staging_entry->staged_value_) {
+    // Staged but never committed, e.g. because the transaction was aborted or
+    // the key was subsequently overwritten.
+    auto future = driver()->DiscardStagedWrite(*staging_entry->staged_value_);
+    future.Force();
+    if (!future.ready()) {
+      absl::MutexLock lock(&discard_mutex_);
+      // Drop discards that have already completed.
+      pending_discards_.erase(
+          std::remove_if(pending_discards_.begin(), pending_discards_.end(),
+                         [](const auto& f) { return f.ready(); }),
+          pending_discards_.end());
+      pending_discards_.push_back(std::move(future));
+    }
+  }
+  delete staging_entry;
+}
+
+namespace {
+
+using StagingReadModifyWriteEntry =
+    NonAtomicTransactionNode::StagingReadModifyWriteEntry;
+
+/// Wraps the receiver of a writeback request issued to the source of a
+/// `StagingReadModifyWriteEntry`, in order to defer
+/// `ReadModifyWriteSource::KvsWritebackStaged` until the request completes.
+struct PendingWritebackReceiver {
+  StagingReadModifyWriteEntry* entry_;
+  ReadModifyWriteSource::WritebackReceiver receiver_;
+
+  void Done() {
+    bool release;
+    {
+      absl::MutexLock lock(&entry_->mutex());
+      release = --entry_->pending_writebacks_ == 0 &&
+                (entry_->flags_ & ReadModifyWriteEntry::kStaged);
+    }
+    if (release) entry_->source_->KvsWritebackStaged();
+  }
+  void set_value(ReadResult read_result) {
+    Done();
+    execution::set_value(receiver_, std::move(read_result));
+  }
+  void set_error(absl::Status error) {
+    Done();
+    execution::set_error(receiver_, std::move(error));
+  }
+  void set_cancel() {
+    Done();
+    execution::set_cancel(receiver_);
+  }
+};
+
+void AbandonStaging(NonAtomicTransactionNode& node,
+                    StagingReadModifyWriteEntry& entry) {
+  TENSORSTORE_KVSTORE_DEBUG_LOG(entry, "AbandonStaging");
+  {
+    absl::MutexLock lock(&node.mutex_);
+    entry.flags_ &= ~ReadModifyWriteEntry::kStaging;
+  }
+  node.StagingDone();
+}
+
+void FinishStaging(NonAtomicTransactionNode& node,
+                   StagingReadModifyWriteEntry& entry,
+                   TimestampedStorageGeneration stamp,
+                   std::optional<kvstore::StagedWrite> staged_value) {
+  TENSORSTORE_KVSTORE_DEBUG_LOG(entry, "FinishStaging: stamp=", stamp);
+  kvstore_transaction_staged_writebacks.Increment();
+  bool release;
+  {
+    absl::MutexLock lock(&node.mutex_);
+    StorageGeneration generation = stamp.generation;
+    ReceiveWritebackCommon(entry, generation);
+    entry.staged_stamp_ = std::move(stamp);
+    entry.staged_value_ = std::move(staged_value);
+    entry.flags_ = (entry.flags_ & ~ReadModifyWriteEntry::kStaging) |
+                   ReadModifyWriteEntry::kStaged;
+    release = entry.pending_writebacks_ == 0;
+  }
+  if (release) entry.source_->KvsWritebackStaged();
+  node.StagingDone();
+}
+
+struct StageWritebackReceiver {
+  NonAtomicTransactionNode* node_;
+  StagingReadModifyWriteEntry* entry_;
+
+  void set_value(ReadResult read_result) {
+    if (read_result.aborted() ||
+        !StorageGeneration::IsDirty(read_result.stamp.generation) ||
+        StorageGeneration::IsConditional(read_result.stamp.generation)) {
+      // Only values that do not depend on the existing value can be staged.
+      AbandonStaging(*node_, *entry_);
+      return;
+    }
+    if (!read_result.has_value()) {
+      FinishStaging(*node_, *entry_, std::move(read_result.stamp),
+                    std::nullopt);
+      return;
+    }
+    auto future = node_->driver()->StageWrite(entry_->key_,
+                                              std::move(read_result.value));
+    future.Force();
+    std::move(future).ExecuteWhenReady(
+        [node = node_, entry = entry_, stamp = std::move(read_result.stamp)](
+            ReadyFuture<kvstore::StagedWrite> future) mutable {
+          auto& r = future.result();
+          if (!r.ok()) {
+            // Writeback will be performed normally at commit.
+            AbandonStaging(*node, *entry);
+            return;
+          }
+          FinishStaging(*node, *entry, std::move(stamp), std::move(*r));
+        });
+  }
+  void set_error(absl::Status error) {
+    // The error will be reported again if it recurs at commit.
+    AbandonStaging(*node_, *entry_);
+  }
+  void set_cancel() { AbandonStaging(*node_, *entry_); }
+};
+
+}  // namespace
+
+bool NonAtomicTransactionNode::StageWriteback(ReadModifyWriteEntry& entry) {
+  auto& staging_entry = static_cast<StagingReadModifyWriteEntry&>(entry);
+  {
+    absl::MutexLock lock(&mutex_);
+    if (transaction()->commit_started() || transaction()->aborted() ||
+        entry.next_ ||
+        (entry.flags_ &
+         (ReadModifyWriteEntry::kStaging | ReadModifyWriteEntry::kStaged |
+          ReadModifyWriteEntry::kDeleted))) {
+      return false;
+    }
+    entry.flags_ |= ReadModifyWriteEntry::kStaging;
+    ++staging_in_flight_;
+  }
+  TENSORSTORE_KVSTORE_DEBUG_LOG(entry, "StageWriteback");
+  // Revoke the source so that further modifications are made to a new
+  // source, and the writeback value requested below remains final.
+  entry.source_->KvsRevoke();
+  ReadModifyWriteSource::WritebackOptions writeback_options;
+  writeback_options.writeback_mode = ReadModifyWriteSource::kNormalWriteback;
+  writeback_options.staleness_bound = absl::InfinitePast();
+  entry.source_->KvsWriteback(std::move(writeback_options),
+                              StageWritebackReceiver{this, &staging_entry});
+  return true;
+}
+
+void NonAtomicTransactionNode::RequestWriteback(
+    ReadModifyWriteEntry& entry,
+    ReadModifyWriteSource::WritebackOptions options,
+    ReadModifyWriteSource::WritebackReceiver receiver) {
+  auto& staging_entry = static_cast<StagingReadModifyWriteEntry&>(entry);
+  bool staged;
+  std::optional<kvstore::StagedWrite> staged_value;
+  TimestampedStorageGeneration staged_stamp;
+  {
+    absl::MutexLock lock(&mutex_);
+    staged = entry.flags_ & ReadModifyWriteEntry::kStaged;
+    if (staged) {
+      staged_value = staging_entry.staged_value_;
+      staged_stamp = staging_entry.staged_stamp_;
+    } else if (transaction()->staging_limit_bytes() != 0) {
+      ++staging_entry.pending_writebacks_;
+      receiver = PendingWritebackReceiver{&staging_entry, std::move(receiver)};
+    }
+  }
+  if (!staged) {
+    entry.source_->KvsWriteback(std::move(options), std::move(receiver));
+    return;
+  }
+  if (options.writeback_mode == ReadModifyWriteSource::kValidateOnly) {
+    // The staged value is unconditional, and therefore always valid.
+    execution::set_value(
+        receiver, ReadResult(TimestampedStorageGeneration::Unconditional()));
+    return;
+  }
+  if (!StorageGeneration::IsUnknown(options.if_not_equal)) {
+    StorageGeneration generation = staged_stamp.generation;
+    generation.ClearNewlyDirty();
+    if (generation == options.if_not_equal) {
+      execution::set_value(receiver, ReadResult(std::move(staged_stamp)));
+      return;
+    }
+  }
+  if (!staged_value) {
+    execution::set_value(
+        receiver, ReadResult{ReadResult::kMissing, {}, std::move(staged_stamp)});
+    return;
+  }
+  auto future = driver()->ReadStagedWrite(*staged_value);
+  future.Force();
+  std::move(future).ExecuteWhenReady(
+      [receiver = std::move(receiver), staged_stamp = std::move(staged_stamp)](
+          ReadyFuture<ReadResult> future) mutable {
+        auto& r = future.result();
+        if (!r.ok()) {
+          execution::set_error(receiver, r.status());
+          return;
+        }
+        execution::set_value(receiver,
+                             ReadResult{r->state, std::move(r->value),
+                                        std::move(staged_stamp)});
+      });
+}
+
+bool NonAtomicTransactionNode::CommitStaged(ReadModifyWriteEntry& entry) {
+  auto& staging_entry = static_cast<StagingReadModifyWriteEntry&>(entry);
+  std::optional<kvstore::StagedWrite> staged_value;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!(entry.flags_ & ReadModifyWriteEntry::kStaged)) return false;
+    staged_value = staging_entry.staged_value_;
+  }
+  if (!staged_value) return false;
+  // Superseded entries that may be conditional must still be validated by the
+  // normal writeback path.
+  for (auto* prev = entry.prev_; prev; prev = prev->prev_) {
+    if (!(prev->flags_ & ReadModifyWriteEntry::kTransitivelyUnconditional)) {
+      return false;
+    }
+  }
+  TENSORSTORE_KVSTORE_DEBUG_LOG(entry, "CommitStaged");
+  auto future =
+      driver()->CommitStagedWrite(entry.key_, *staged_value, WriteOptions{});
+  future.Force();
+  std::move(future).ExecuteWhenReady(
+      [this,
+       &staging_entry](ReadyFuture<TimestampedStorageGeneration> future) {
+        auto& r = future.result();
+        Controller controller{&staging_entry};
+        if (!r.ok()) {
+          ReportWritebackError(controller, "writing", r.status());
+          return;
+        }
+        {
+          // The staged value has been consumed.  `RequestWriteback` may
+          // concurrently read `staged_value_`.
+          absl::MutexLock lock(&mutex_);
+          staging_entry.staged_value_ = std::nullopt;
+        }
+        controller.Success(std::move(*r));
+      });
+  return true;
+}
+
+void NonAtomicTransactionNode::Commit() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (staging_in_flight_ != 0) {
+      commit_deferred_ = true;
+      return;
+    }
+  }
+  this->CommitNextPhase();
+}
+
+void NonAtomicTransactionNode::Abort() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (staging_in_flight_ != 0) {
+      abort_deferred_ = true;
+      return;
+    }
+  }
+  AbortAfterStaging();
+}
+
+void NonAtomicTransactionNode::AbortAfterStaging() {
+  // Destroying the remaining entries discards any staged writes.
+  this->AbortRemainingPhases();
+  std::vector<Future<const void>> discards;
+  {
+    absl::MutexLock lock(&discard_mutex_);
+    discards.swap(pending_discards_);
+  }
+  if (discards.empty()) {
+    this->AbortDone();
+    return;
+  }
+  // Abort completes once all discards have completed.  Errors are ignored,
+  // since the staged writes are never visible as keys.
+  auto pair = PromiseFuturePair<void>::Make(MakeResult());
+  for (auto& discard : discards) {
+    std::move(discard).ExecuteWhenReady(
+        [promise = pair.promise](ReadyFuture<const void>) {});
+  }
+  pair.promise = Promise<void>();
+  std::move(pair.future).ExecuteWhenReady(
+      [this](ReadyFuture<void>) { this->AbortDone(); });
+}
+
+void NonAtomicTransactionNode::StagingDone() {
+  bool commit = false, abort = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (--staging_in_flight_ == 0) {
+      commit = std::exchange(commit_deferred_, false);
+      abort = std::exchange(abort_deferred_, false);
+    }
+  }
+  if (commit) {
+    this->CommitNextPhase();
+  } else if (abort) {
+    AbortAfterStaging();
+  }
+}
+
 namespace {
 absl::Status GetNonAtomicReadModifyWriteError(
     NonAtomicTransactionNode& node,
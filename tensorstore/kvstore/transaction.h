@@ -85,18 +85,23 @@
 /// operations to efficiently take into account the current modified state.
 
 #include <atomic>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "tensorstore/internal/intrusive_red_black_tree.h"
 #include "tensorstore/internal/source_location.h"
 #include "tensorstore/internal/tagged_ptr.h"
+#include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/read_modify_write.h"
 #include "tensorstore/kvstore/read_result.h"
 #include "tensorstore/kvstore/spec.h"
 #include "tensorstore/transaction.h"
+#include "tensorstore/util/future.h"
 #include "tensorstore/util/quote_string.h"  // IWYU pragma: keep
 
 namespace tensorstore {
@@ -309,6 +314,15 @@ class ReadModifyWriteEntry : public MutationEntry,
   /// repeatedly due to splits and merges.
   constexpr static Flags kDeleted = 32;
 
+  /// Indicates that `MultiPhaseMutation::StageWriteback` has started staging
+  /// the writeback value of `source_`, but staging has not yet completed.
+  constexpr static Flags kStaging = 64;
+
+  /// Indicates that the writeback value of `source_` has been staged by
+  /// `MultiPhaseMutation::StageWriteback`.  Further writeback requests are
+  /// satisfied from the staged value rather than `source_`.
+  constexpr static Flags kStaged = 128;
+
   // Implementation of `ReadModifyWriteTarget` interface:
 
   /// Satisfies a read request by requesting a writeback of `prev_`, or by
@@ -321,6 +335,12 @@ class ReadModifyWriteEntry : public MutationEntry,
   /// Otherwise, returns `true`.
   bool KvsReadsCommitted() override;
 
+  /// Forwards to `MultiPhaseMutation::StageWriteback`.
+  bool KvsStageWriteback() override;
+
+  /// Forwards to `MultiPhaseMutation::IndependentWriteback`.
+  bool KvsIndependentWriteback() override;
+
   virtual ~ReadModifyWriteEntry() = default;
 };
 
@@ -426,6 +446,39 @@ class MultiPhaseMutation {
                          ReadResult&& read_result) = 0;
 
   virtual void Writeback(DeleteRangeEntry& entry) = 0;
+
+  /// Requests the writeback value of `entry.source_`.
+  ///
+  /// All writeback requests made on behalf of a `ReadModifyWriteEntry` go
+  /// through this method.  By default simply calls
+  /// `entry.source_->KvsWriteback`, but derived classes that stage writeback
+  /// values may instead satisfy the request from the staged value.
+  virtual void RequestWriteback(
+      ReadModifyWriteEntry& entry,
+      ReadModifyWriteSource::WritebackOptions options,
+      ReadModifyWriteSource::WritebackReceiver receiver);
+
+  /// Starts staging the writeback value of `entry`, in response to a call to
+  /// `ReadModifyWriteTarget::KvsStageWriteback`.
+  ///
+  /// Returns `true` if staging was started.  The default implementation
+  /// returns `false`.
+  virtual bool StageWriteback(ReadModifyWriteEntry& entry) { return false; }
+
+  /// Commits the staged writeback value of `entry`, which is the last entry of
+  /// its sequence and is not deleted.
+  ///
+  /// Returns `false` if `entry` does not have a staged value that can be
+  /// committed directly, in which case the normal writeback path is used.  The
+  /// default implementation returns `false`.
+  virtual bool CommitStaged(ReadModifyWriteEntry& entry) { return false; }
+
+  /// Returns `true` if the writeback of each entry completes independently of
+  /// other entries, as described by
+  /// `ReadModifyWriteTarget::KvsIndependentWriteback`.  The default
+  /// implementation returns `false`.
+  virtual bool IndependentWriteback() { return false; }
+
   virtual bool MultiPhaseReadsCommitted() { return true; }
   virtual void PhaseCommitDone(size_t next_phase) = 0;
 
@@ -583,11 +636,37 @@ class TransactionNodeBase : public internal::TransactionState::Node,
   absl::Mutex mutex_;
 };
 
+/// Transaction node for drivers that do not support atomic multi-key
+/// transactions; each key is written back independently by calling
+/// `Driver::Write`.
+///
+/// If the transaction specifies a non-zero `staging_limit_bytes`, writeback
+/// values that are not conditional on the existing value may be staged before
+/// commit using `Driver::StageWrite`, and are then committed using
+/// `Driver::CommitStagedWrite`.
 class NonAtomicTransactionNode
     : public TransactionNodeBase<MultiPhaseMutation> {
  public:
   using TransactionNodeBase<MultiPhaseMutation>::TransactionNodeBase;
 
+  class StagingReadModifyWriteEntry : public ReadModifyWriteEntry {
+   public:
+    /// Staged value, valid if `kStaged` is set and the writeback value was not
+    /// a deletion.  Reset once committed.
+    std::optional<kvstore::StagedWrite> staged_value_;
+
+    /// Stamp returned by the writeback request that produced the staged value.
+    TimestampedStorageGeneration staged_stamp_;
+
+    /// Number of writeback requests issued to `source_` that have not yet
+    /// completed.  `ReadModifyWriteSource::KvsWritebackStaged` is deferred
+    /// until this reaches 0.
+    size_t pending_writebacks_ = 0;
+  };
+
+  ReadModifyWriteEntry* AllocateReadModifyWriteEntry() override;
+  void FreeReadModifyWriteEntry(ReadModifyWriteEntry* entry) override;
+
   void Writeback(ReadModifyWriteEntry& entry,
                  ReadResult&& read_result) override {
     internal_kvstore::WritebackDirectly(this->driver(), entry,
@@ -597,6 +676,41 @@ class NonAtomicTransactionNode
   void Writeback(DeleteRangeEntry& entry) override {
     internal_kvstore::WritebackDirectly(driver(), entry);
   }
+
+  void RequestWriteback(
+      ReadModifyWriteEntry& entry,
+      ReadModifyWriteSource::WritebackOptions options,
+      ReadModifyWriteSource::WritebackReceiver receiver) override;
+  bool StageWriteback(ReadModifyWriteEntry& entry) override;
+  bool CommitStaged(ReadModifyWriteEntry& entry) override;
+
+  /// Each entry is written by a separate `kvstore::Driver::Write` call.
+  bool IndependentWriteback() override { return true; }
+
+  /// Commit and abort are deferred until any in-progress staging completes.
+  void Commit() override;
+  void Abort() override;
+
+  /// Called when staging of an entry completes or is abandoned.
+  void StagingDone();
+
+  /// Aborts the remaining phases, and calls `AbortDone` once the staged
+  /// writes of the destroyed entries have been discarded.
+  void AbortAfterStaging();
+
+  /// Number of entries for which staging is in progress.
+  size_t staging_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// Set if `Commit` or `Abort` was called while `staging_in_flight_ != 0`.
+  bool commit_deferred_ ABSL_GUARDED_BY(mutex_) = false;
+  bool abort_deferred_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /// Discards of staged writes, started by `FreeReadModifyWriteEntry`, that
+  /// may not have completed.  Guarded by a separate mutex since entries may be
+  /// freed while `mutex_` is held.
+  absl::Mutex discard_mutex_;
+  std::vector<Future<const void>> pending_discards_
+      ABSL_GUARDED_BY(discard_mutex_);
 };
 
 using AtomicTransactionNode = TransactionNodeBase<AtomicMultiPhaseMutation>;
@@ -15,6 +15,9 @@
 #ifndef TENSORSTORE_READ_WRITE_OPTIONS_H_
 #define TENSORSTORE_READ_WRITE_OPTIONS_H_
 
+#include <cstddef>
+
+#include "tensorstore/batch.h"
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/index_space/alignment.h"
 #include "tensorstore/progress.h"
@@ -39,6 +42,11 @@ struct ReadOptions {
 
   /// Optional progress callback.
   ReadProgressFunction progress_function;
+
+  /// Optional batch.  Reads issued with the same batch are deferred until the
+  /// last copy of the batch handle is released, and may then be coalesced
+  /// into fewer, larger kvstore requests.
+  Batch batch{no_batch};
 };
 
 /// Options for `tensorstore::Read` into new array.
@@ -59,6 +67,47 @@ struct ReadIntoNewArrayOptions {
 
   /// Optional progress callback.
   ReadProgressFunction progress_function;
+
+  /// Optional batch.  Reads issued with the same batch are deferred until the
+  /// last copy of the batch handle is released, and may then be coalesced
+  /// into fewer, larger kvstore requests.
+  Batch batch{no_batch};
+};
+
+/// Options for `tensorstore::Prefetch`.
+///
+/// \relates Prefetch
+struct PrefetchOptions {
+  /// Constructs the options.
+  PrefetchOptions(ReadProgressFunction progress_function = {})
+      : progress_function(std::move(progress_function)) {}
+
+  /// Optional progress callback.  The `ReadProgress::copied_elements` member
+  /// indicates the number of elements that have been read into the cache.
+  ReadProgressFunction progress_function;
+
+  /// Optional batch.  Reads issued with the same batch are deferred until the
+  /// last copy of the batch handle is released, and may then be coalesced
+  /// into fewer, larger kvstore requests.
+  Batch batch{no_batch};
+};
+
+/// Options for `tensorstore::ReadChunks`.
+///
+/// \relates ReadChunks
+struct ReadChunksOptions {
+  /// Constructs the options.
+  ReadChunksOptions(ContiguousLayoutOrder layout_order = c_order)
+      : layout_order(layout_order) {}
+
+  /// Specifies the layout order of the newly-allocated array for each chunk.
+  /// Defaults to `c_order`.
+  ContiguousLayoutOrder layout_order = c_order;
+
+  /// Maximum number of chunks that are being read or have been read but not
+  /// yet consumed.  Bounds the memory used by the stream to approximately this
+  /// many decoded chunks.  Must be at least 1.
+  size_t max_in_flight_chunks = 16;
 };
 
 /// Options for `tensorstore::Write`.
@@ -79,6 +128,18 @@ struct WriteOptions {
 
   /// Optional progress callback.
   WriteProgressFunction progress_function;
+
+  /// Indicates that the caller will not modify the source array until the
+  /// write is committed.
+  ///
+  /// If `true`, chunks that are overwritten in their entirety may reference
+  /// the source array directly, rather than a copy of it, until they are
+  /// encoded during writeback.  This avoids an additional copy of the data
+  /// when writing large arrays, but the source array must remain unmodified
+  /// until `WriteFutures::commit_future` (or the commit of the transaction)
+  /// becomes ready, rather than just until `WriteFutures::copy_future`
+  /// becomes ready.
+  bool can_reference_source_data_until_commit = false;
 };
 
 /// Options for `tensorstore::Copy`.
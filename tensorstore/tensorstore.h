@@ -33,6 +33,7 @@
 #include "tensorstore/serialization/fwd.h"
 #include "tensorstore/spec.h"
 #include "tensorstore/tensorstore_impl.h"  // IWYU pragma: export
+#include "tensorstore/util/execution/any_sender.h"
 #include "tensorstore/util/future.h"
 
 namespace tensorstore {
@@ -604,6 +605,78 @@ Read(Source&& source, ReadIntoNewArrayOptions options = {}) {
       std::forward<Source>(source));
 }
 
+/// Reads the data within the domain of `source` into the cache, without
+/// returning it.
+///
+/// This may be used to reduce the latency of a subsequent `Read` of the same
+/// region, for example to read the next region to be processed while
+/// processing the current one.  For drivers that use a cache, the data remains
+/// cached subject to the limits of the `Context.cache_pool`; if the cache pool
+/// has a ``total_bytes_limit`` of 0 (the default), prefetching has no effect
+/// other than validating that the data can be read.
+///
+/// Example::
+///
+///     TensorReader<std::int32_t, 3> store = ...;
+///     auto future = Prefetch(
+///         store | AllDims().SizedInterval({100, 200}, {25, 30}));
+///
+/// \param source Source TensorStore object that supports reading.  May be
+///     `Result`-wrapped.
+/// \param options Additional prefetch options.
+/// \returns A future that becomes ready when all chunks intersecting the
+///     domain of `source` have been read, or an error occurs.
+/// \relates TensorStore
+/// \membergroup I/O
+template <typename Source>
+std::enable_if_t<
+    internal::IsTensorStore<UnwrapResultType<internal::remove_cvref_t<Source>>>,
+    Future<void>>
+Prefetch(Source&& source, PrefetchOptions options = {}) {
+  return MapResult(
+      [&](UnwrapQualifiedResultType<Source&&> unwrapped_source) {
+        return internal::DriverPrefetch(
+            internal::TensorStoreAccess::handle(
+                std::forward<decltype(unwrapped_source)>(unwrapped_source)),
+            std::move(options));
+      },
+      std::forward<Source>(source));
+}
+
+/// Streams the data within the domain of `source` one chunk at a time.
+///
+/// The domain of `source` is partitioned according to its read chunk grid, as
+/// determined by `TensorStore::chunk_layout`, and each grid cell is read into
+/// a newly-allocated array.  Dimensions without a hard read chunk constraint
+/// are not partitioned.  The returned flow sender delivers
+/// ``(transform, array)`` pairs, where ``transform`` is an identity transform
+/// over the domain of the cell (with the dimension labels of `source`) and
+/// ``array`` has the same domain.
+///
+/// Chunks are delivered in the order in which their reads complete.  Calls to
+/// ``set_value`` are never concurrent, and at most
+/// `ReadChunksOptions::max_in_flight_chunks` chunks are being read or have
+/// been read but not yet delivered, which bounds the memory used regardless of
+/// the size of the domain.
+///
+/// Example::
+///
+///     TensorReader<std::uint8_t, 3> store = ...;
+///     auto sender = ReadChunks(store);
+///     execution::submit(sender, receiver);
+///
+/// \param source Source TensorStore object that supports reading.
+/// \param options Additional options.
+/// \relates TensorStore
+/// \membergroup I/O
+template <typename Element, DimensionIndex Rank, ReadWriteMode Mode>
+AnyFlowSender<absl::Status, IndexTransform<>, SharedOffsetArray<void>>
+ReadChunks(const TensorStore<Element, Rank, Mode>& source,
+           ReadChunksOptions options = {}) {
+  return internal::DriverReadChunksSender(
+      internal::TensorStoreAccess::handle(source), std::move(options));
+}
+
 /// Copies from a `source` array to `target` TensorStore.
 ///
 /// The domain of `target` is resolved via `ResolveBounds` and then the domain
@@ -622,7 +695,9 @@ Read(Source&& source, ReadIntoNewArrayOptions options = {}) {
 ///
 /// \param source The source `Array` or `TransformedArray`.  May be
 ///     `Result`-wrapped.  This array must remain valid until the returned
-///     `WriteFutures::copy_future` becomes ready.
+///     `WriteFutures::copy_future` becomes ready.  If
+///     `options.can_reference_source_data_until_commit` is `true`, it must
+///     additionally not be modified until the write is committed.
 /// \param target The target `TensorStore`.  May be `Result`-wrapped.
 /// \param options Additional write options.
 /// \relates TensorStore
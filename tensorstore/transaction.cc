@@ -573,6 +573,11 @@ Transaction::Transaction(TransactionMode mode) {
                internal::adopt_object_ref);
 }
 
+Transaction::Transaction(TransactionMode mode, std::size_t staging_limit_bytes)
+    : Transaction(mode) {
+  if (state_) state_->staging_limit_bytes_ = staging_limit_bytes;
+}
+
 std::ostream& operator<<(std::ostream& os, TransactionMode mode) {
   switch (mode) {
     case TransactionMode::no_transaction_mode:
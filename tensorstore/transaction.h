@@ -141,6 +141,26 @@ class Transaction {
   /// \id mode
   explicit Transaction(TransactionMode mode);
 
+  /// Creates a new transaction with the specified mode that stages writeback
+  /// of modified chunks before commit.
+  ///
+  /// Once `total_bytes()` exceeds `staging_limit_bytes`, modified chunks that
+  /// do not depend on the existing stored value (e.g. because they were
+  /// completely overwritten) are encoded and written to temporary storage by
+  /// the underlying key-value store, and their in-memory state is released.
+  /// The staged values are only made visible when the transaction is
+  /// committed, and are discarded if it is aborted.
+  ///
+  /// Currently, only the file key-value store supports staging.  With other
+  /// key-value stores, including OCDBT and GCS, modified chunks remain in
+  /// memory until commit, as with `Transaction(mode)`.
+  ///
+  /// A `staging_limit_bytes` of `0` disables staging, which is equivalent to
+  /// `Transaction(mode)`.
+  ///
+  /// \id mode, staging_limit_bytes
+  explicit Transaction(TransactionMode mode, std::size_t staging_limit_bytes);
+
   /// Returns the transaction mode.
   TransactionMode mode() const {
     return state_ ? state_->mode_ : TransactionMode::no_transaction_mode;
@@ -233,6 +253,13 @@ class Transaction {
     return 0;
   }
 
+  /// Returns the memory limit above which writeback is staged, or `0` if
+  /// staging is disabled.
+  std::size_t staging_limit_bytes() const {
+    if (state_) return state_->staging_limit_bytes();
+    return 0;
+  }
+
   /// Checks if `a` and `b` refer to the same transaction state, or are both
   /// null.
   friend bool operator==(const Transaction& a, const Transaction& b) {
@@ -573,6 +573,17 @@ class TransactionState {
     return total_bytes_.load(std::memory_order_relaxed);
   }
 
+  /// Returns the value of `total_bytes()` above which transaction nodes that
+  /// support it should stage their writeback before commit, or `0` if staging
+  /// is disabled.
+  std::size_t staging_limit_bytes() const { return staging_limit_bytes_; }
+
+  /// Returns `true` if `total_bytes()` exceeds a non-zero
+  /// `staging_limit_bytes()`.
+  bool staging_limit_exceeded() const {
+    return staging_limit_bytes_ != 0 && total_bytes() > staging_limit_bytes_;
+  }
+
   /// Requests that the transaction be committed.  Has no effect if commit or
   /// abort has already been requested.
   void RequestCommit();
@@ -877,6 +888,9 @@ class TransactionState {
 
   /// Set to `true` if this is an implicit transaction.
   bool implicit_transaction_;
+
+  /// Limit on `total_bytes_` above which writeback is staged, or `0`.
+  std::size_t staging_limit_bytes_ = 0;
 };
 
 /// Smart pointer that prevents a transaction from being committed and keeps it